@@ -0,0 +1,262 @@
+/// \file BenchSceneUpdate.cpp
+/// \brief A benchmark that times the CPU side of a frame (animation, world
+///   transforms, occluder rasterization, frustum and occlusion culling, and
+///   sort-key generation) on a large synthetic scene, with different numbers
+///   of JobSystem workers.
+/// \author Ryan Ganzke
+/// \version A09
+///
+/// Usage: BenchSceneUpdate.out [frames [systems]]
+///
+/// The scene is a grid of star systems, each made of a star, 9 planets, and
+///   10 moons per planet (100 objects), so the default 1000 systems give
+///   100,000 objects.  The stars of the three rows of systems nearest the
+///   camera are occluders.  No OpenGL is used, so it runs anywhere.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "TransformHierarchy.hpp"
+#include "TransformStore.hpp"
+#include "Transform.hpp"
+#include "Matrix4.hpp"
+#include "Vector3.hpp"
+#include "Frustum.hpp"
+#include "SortKey.hpp"
+#include "OcclusionBuffer.hpp"
+#include "Geometry.hpp"
+
+namespace
+{
+  /// The number of objects handed to each job.
+  const unsigned int GRAIN = 1024;
+
+  /// The radius of each star, which is also the radius of its occluder.
+  const float STAR_RADIUS = 3.0f;
+
+  /// \brief The per-object data that culling and sorting need.
+  struct Object
+  {
+    /// The object's node in the hierarchy.
+    unsigned int node;
+    /// The object's shader program.
+    unsigned int program;
+    /// The object's material.
+    unsigned int material;
+    /// The radius of the object's bounding sphere.
+    float radius;
+  };
+
+  /// \brief Milliseconds spent in each stage, summed over the timed frames.
+  struct Timings
+  {
+    /// Applying the per-object animation.
+    double animate = 0.0;
+    /// Bringing the world matrices up to date.
+    double transforms = 0.0;
+    /// Rasterizing the occluders and building the depth pyramid.
+    double occluders = 0.0;
+    /// Frustum and occlusion culling and building sort keys.
+    double cull = 0.0;
+    /// Gathering and sorting the visible objects.
+    double sort = 0.0;
+  };
+
+  /// \brief Gets the time since some fixed point, in milliseconds.
+  /// \return The current time.
+  double
+  now ()
+  {
+    using namespace std::chrono;
+    return duration<double, std::milli> (steady_clock::now ().time_since_epoch ()).count ();
+  }
+
+  /// \brief Builds the synthetic scene and times a number of frames.
+  /// \param[in] workers The number of JobSystem workers.
+  /// \param[in] systems The number of star systems.
+  /// \param[in] frames The number of frames to time (after a short warm-up).
+  /// \param[out] visible The number of objects that survived culling in the
+  ///   last frame.
+  /// \param[out] testTime The milliseconds taken by 10,000 occlusion tests
+  ///   on one thread, after the last frame.
+  /// \param[out] testsHidden How many of those tests found the object hidden.
+  /// \return The total time spent in each stage.
+  Timings
+  run (unsigned int workers, unsigned int systems, unsigned int frames,
+       unsigned int* visible, double* testTime, unsigned int* testsHidden)
+  {
+    JobSystem jobs (workers);
+    TransformHierarchy hierarchy;
+    std::vector<Object> objects;
+    std::vector<unsigned int> occluders;
+    std::vector<float> spins;
+    unsigned int side = 1;
+    while (side * side < systems)
+      ++side;
+    for (unsigned int s = 0; s < systems; ++s)
+    {
+      Transform starLocal;
+      starLocal.moveRight (30.0f * (s % side) - 15.0f * side);
+      starLocal.moveBack (-30.0f * (s / side));
+      unsigned int star = hierarchy.add (starLocal);
+      objects.push_back ({ star, s % 4, s % 16, STAR_RADIUS });
+      if (s / side < 3)
+        occluders.push_back (star);
+      for (unsigned int p = 0; p < 9; ++p)
+      {
+        Transform planetLocal;
+        planetLocal.yaw (40.0f * p);
+        planetLocal.moveRight (2.0f + p);
+        unsigned int planet = hierarchy.add (planetLocal, star);
+        objects.push_back ({ planet, (s + p) % 4, (s + p) % 16, 1.0f });
+        for (unsigned int m = 0; m < 10; ++m)
+        {
+          Transform moonLocal;
+          moonLocal.yaw (36.0f * m);
+          moonLocal.moveRight (0.5f);
+          moonLocal.scaleLocal (0.2f);
+          unsigned int moon = hierarchy.add (moonLocal, planet);
+          objects.push_back ({ moon, (s + m) % 4, (s + p + m) % 16, 1.0f });
+        }
+      }
+    }
+    TransformStore& locals = hierarchy.getLocals ();
+    spins.resize (locals.getCapacity ());
+    for (unsigned int i = 0; i < spins.size (); ++i)
+      spins[i] = 0.1f + 0.01f * (i % 50);
+
+    Transform view;
+    view.moveUp (-20.0f);
+    view.moveBack (-50.0f);
+    Matrix4 projection;
+    projection.setToPerspectiveProjection (60.0, 16.0 / 9.0, 0.1, 1000.0);
+    Matrix4 viewMatrix = view.getTransform ();
+    Frustum frustum (projection * viewMatrix);
+    const float* v = viewMatrix.data ();
+
+    OcclusionBuffer occlusion;
+    std::vector<float> sphere;
+    std::vector<unsigned int> sphereIndices;
+    for (const Triangle& triangle : buildSphere (6, 8))
+      for (const Vector3& corner : triangle)
+      {
+        sphereIndices.push_back (sphereIndices.size ());
+        sphere.insert (sphere.end (), { STAR_RADIUS * corner.m_x,
+                                        STAR_RADIUS * corner.m_y,
+                                        STAR_RADIUS * corner.m_z });
+      }
+
+    std::vector<unsigned char> inside (objects.size ());
+    std::vector<uint64_t> keys (objects.size ());
+    std::vector<std::pair<uint64_t, unsigned int>> order;
+
+    const unsigned int WARM_UP = 3;
+    Timings total;
+    for (unsigned int frame = 0; frame < WARM_UP + frames; ++frame)
+    {
+      double start = now ();
+      jobs.parallelFor (0, locals.getCapacity (), GRAIN,
+                        [&] (unsigned int first, unsigned int last)
+                        { locals.yawAll (spins.data (), first, last); });
+      double animated = now ();
+
+      hierarchy.update (&jobs);
+      double updated = now ();
+
+      const float* worlds = hierarchy.getWorldMatrices ();
+      occlusion.begin (projection * viewMatrix);
+      for (unsigned int node : occluders)
+        occlusion.addOccluder (worlds + 16 * node, sphere.data (), 3,
+                               sphereIndices.data (), sphereIndices.size ());
+      occlusion.rasterize (&jobs);
+      double rasterized = now ();
+      jobs.parallelFor (0, objects.size (), GRAIN,
+                        [&] (unsigned int first, unsigned int last)
+                        {
+                          for (unsigned int i = first; i < last; ++i)
+                          {
+                            const float* world = worlds + 16 * objects[i].node;
+                            float radius = objects[i].radius;
+                            inside[i] = frustum.intersectsSphere (world, Vector3 (), radius)
+                              && occlusion.isVisible (world, Vector3 (), radius);
+                            if (!inside[i])
+                              continue;
+                            float depth = -(v[2] * world[12] + v[6] * world[13]
+                                            + v[10] * world[14] + v[14]);
+                            keys[i] = makeSortKey (objects[i].program,
+                                                   objects[i].material, depth);
+                          }
+                        });
+      double culled = now ();
+
+      order.clear ();
+      for (unsigned int i = 0; i < objects.size (); ++i)
+        if (inside[i])
+          order.emplace_back (keys[i], i);
+      std::sort (order.begin (), order.end ());
+      double sorted = now ();
+
+      if (frame >= WARM_UP)
+      {
+        total.animate += animated - start;
+        total.transforms += updated - animated;
+        total.occluders += rasterized - updated;
+        total.cull += culled - rasterized;
+        total.sort += sorted - culled;
+      }
+    }
+    *visible = order.size ();
+
+    const float* worlds = hierarchy.getWorldMatrices ();
+    unsigned int tests = std::min (10000u, static_cast<unsigned int> (objects.size ()));
+    unsigned int passed = 0;
+    double start = now ();
+    for (unsigned int i = 0; i < tests; ++i)
+      passed += occlusion.isVisible (worlds + 16 * objects[i].node, Vector3 (),
+                                     objects[i].radius);
+    *testTime = (now () - start) * 10000.0 / std::max (1u, tests);
+    *testsHidden = tests - passed;
+    return total;
+  }
+}
+
+/// \brief Runs the benchmark with 1, 2, 4, 8, and 16 workers.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The optional frame and star-system counts.
+int
+main (int argc, char* argv[])
+{
+  unsigned int frames = (argc > 1) ? std::atoi (argv[1]) : 50;
+  unsigned int systems = (argc > 2) ? std::atoi (argv[2]) : 1000;
+  printf ("%u objects, %u frames, %u hardware threads\n", systems * 100,
+          frames, std::thread::hardware_concurrency ());
+  printf ("%8s %10s %10s %10s %10s %10s %10s %8s %8s\n", "workers", "animate",
+          "transforms", "occluders", "cull+key", "sort", "total ms", "speedup",
+          "visible");
+
+  double baseline = 0.0;
+  double testTime = 0.0;
+  unsigned int testsHidden = 0;
+  for (unsigned int workers : { 1u, 2u, 4u, 8u, 16u })
+  {
+    unsigned int visible = 0;
+    Timings t = run (workers, systems, frames, &visible, &testTime, &testsHidden);
+    double perFrame = (t.animate + t.transforms + t.occluders + t.cull + t.sort) / frames;
+    if (workers == 1)
+      baseline = perFrame;
+    printf ("%8u %10.3f %10.3f %10.3f %10.3f %10.3f %10.3f %7.2fx %8u\n", workers,
+            t.animate / frames, t.transforms / frames, t.occluders / frames,
+            t.cull / frames, t.sort / frames, perFrame, baseline / perFrame,
+            visible);
+  }
+  printf ("%.3f ms per 10,000 occlusion tests on one thread (%u hidden)\n",
+          testTime, testsHidden);
+  return EXIT_SUCCESS;
+}
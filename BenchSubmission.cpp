@@ -0,0 +1,259 @@
+/// \file BenchSubmission.cpp
+/// \brief A benchmark that times the CPU cost of submitting a frame
+///   (everything Scene::draw does: uniforms, lights, culling, sorting, and
+///   the OpenGL calls themselves) without a GPU, by drawing through a
+///   NullOpenGLContext, alone and wrapped in the caching and recording
+///   contexts, and the cost of rendering it on the CPU with a
+///   SoftwareOpenGLContext.
+/// \author Ryan Ganzke
+/// \version A09
+///
+/// Usage: BenchSubmission.out [frames [meshes [image.ppm]]]
+///
+/// The scene is a grid of spheres (2,000 by default) in 16 Materials, lit by
+///   a directional light and 64 point lights, with the camera turning slowly
+///   above it so culling changes from frame to frame.  It is drawn with the
+///   real shaders from shaders/, so it must be run from the directory that
+///   holds them.  No window or OpenGL driver is needed.  The software
+///   backend only draws forward shading (see SoftwareOpenGLContext), and its
+///   time includes rasterizing; its last frame is saved to image.ppm, if
+///   given.  Every configuration is run again with multi-draws ("+mdi"), and
+///   again with the spheres culled on the GPU ("+gpu"), whose "visible"
+///   column counts only the Meshes culled on the CPU.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "NullOpenGLContext.hpp"
+#include "CachingOpenGLContext.hpp"
+#include "RecordingOpenGLContext.hpp"
+#include "SoftwareOpenGLContext.hpp"
+#include "JobSystem.hpp"
+#include "ShaderProgram.hpp"
+#include "ShaderPermutations.hpp"
+#include "Scene.hpp"
+#include "Camera.hpp"
+#include "NormalsMesh.hpp"
+#include "Material.hpp"
+#include "Geometry.hpp"
+
+namespace
+{
+  /// The size of the (imaginary) window.
+  const GLsizei WIDTH = 1280;
+
+  /// The size of the (imaginary) window.
+  const GLsizei HEIGHT = 720;
+
+  /// The number of Materials the meshes cycle through.
+  const unsigned int MATERIALS = 16;
+
+  /// The number of point lights.
+  const unsigned int POINT_LIGHTS = 64;
+
+  /// \brief Which contexts to draw through, outermost first.
+  enum Backend
+  {
+    /// A NullOpenGLContext.
+    NULL_BACKEND,
+    /// A CachingOpenGLContext around a NullOpenGLContext.
+    CACHING_BACKEND,
+    /// A RecordingOpenGLContext around a NullOpenGLContext.
+    RECORDING_BACKEND,
+    /// A CachingOpenGLContext around a RecordingOpenGLContext around a
+    ///   NullOpenGLContext, to count the calls that get past the cache.
+    CACHING_RECORDING_BACKEND,
+    /// A CachingOpenGLContext around a SoftwareOpenGLContext, which
+    ///   rasterizes each frame.
+    SOFTWARE_BACKEND
+  };
+
+  /// \brief How the spheres' draw calls are made.
+  enum Submission
+  {
+    /// One draw call per sphere.
+    PER_MESH,
+    /// One multi-draw per material, of the spheres culled on the CPU.
+    MULTI_DRAW,
+    /// One multi-draw per material, of the spheres culled on the GPU.
+    GPU_CULLED
+  };
+
+  /// \brief What one run measured, per frame.
+  struct Result
+  {
+    /// Microseconds spent in Scene::draw.
+    double micros;
+    /// OpenGL calls recorded, or 0 if nothing was recorded.
+    double calls;
+    /// Bytes recorded, or 0 if nothing was recorded.
+    double bytes;
+    /// Meshes drawn in the last frame.
+    unsigned int visible;
+  };
+
+  /// \brief Gets the time since some fixed point, in microseconds.
+  /// \return The current time.
+  double
+  now ()
+  {
+    using namespace std::chrono;
+    return duration<double, std::micro> (steady_clock::now ().time_since_epoch ()).count ();
+  }
+
+  /// \brief Builds the scene, draws it, and times the frames.
+  /// \param[in] backend The contexts to draw through.
+  /// \param[in] path Forward or deferred shading.
+  /// \param[in] submission How the spheres' draw calls are made.
+  /// \param[in] frames The number of frames to time (after a short warm-up).
+  /// \param[in] meshes The number of spheres.
+  /// \param[in] jobs The workers the software backend rasterizes on.
+  /// \param[in] image Where to save the software backend's last frame, or
+  ///   nullptr.
+  /// \return What was measured.
+  Result
+  run (Backend backend, Scene::ShadingPath path, Submission submission, unsigned int frames,
+       unsigned int meshes, JobSystem* jobs, const char* image)
+  {
+    NullOpenGLContext null;
+    RecordingOpenGLContext recording (&null);
+    SoftwareOpenGLContext software (WIDTH, HEIGHT, jobs);
+    OpenGLContext* inner = (backend == RECORDING_BACKEND
+                            || backend == CACHING_RECORDING_BACKEND)
+      ? static_cast<OpenGLContext*> (&recording)
+      : (backend == SOFTWARE_BACKEND) ? static_cast<OpenGLContext*> (&software) : &null;
+    CachingOpenGLContext caching (inner);
+    OpenGLContext* context = (backend == CACHING_BACKEND
+                              || backend == CACHING_RECORDING_BACKEND
+                              || backend == SOFTWARE_BACKEND)
+      ? static_cast<OpenGLContext*> (&caching) : inner;
+    context->viewport (0, 0, WIDTH, HEIGHT);
+    context->enable (GL_DEPTH_TEST);
+    context->enable (GL_CULL_FACE);
+
+    ShaderProgram phong (context);
+    phong.build ("shaders/PhongShader.vert", "shaders/PhongShader.frag");
+    ShaderPermutations permutations (context, "shaders/PhongShader.vert",
+                                     "shaders/PhongShader.frag", nullptr);
+    ShaderProgram cull (context);
+    cull.buildCompute ("shaders/CullDraws.comp");
+    Camera camera (Vector3 (0, 30.0f, 60.0f), Vector3 (0, 0, 1), 0.1f, 1000.0f,
+                   static_cast<float> (WIDTH) / HEIGHT, 60.0f);
+    camera.pitch (-25.0f);
+
+    Scene* scene = new Scene (context, &phong, &camera);
+    scene->setLightingPermutations (&permutations);
+    scene->setClusteredLighting (true);
+    scene->setShadingPath (path);
+    scene->setMultiDrawIndirect (submission != PER_MESH);
+    scene->setGpuCulling (submission == GPU_CULLED ? &cull : nullptr);
+
+    std::vector<Material*> materials;
+    for (unsigned int m = 0; m < MATERIALS; ++m)
+    {
+      float shade = (m + 1.0f) / MATERIALS;
+      materials.push_back (new Material (Vector3 (0.1f, 0.1f, 0.1f),
+                                         Vector3 (shade, 0.5f, 1.0f - shade),
+                                         Vector3 (0.5f, 0.5f, 0.5f),
+                                         Vector3 (0.0f, 0.0f, 0.0f), 32.0f));
+    }
+
+    const std::vector<Triangle> sphere = buildSphere (16, 24);
+    std::vector<float> data;
+    std::vector<unsigned int> indices;
+    indexData (dataWithVertexNormals (sphere, computeVertexNormals (sphere, computeFaceNormals (sphere))),
+               6, data, indices);
+    unsigned int side = 1;
+    while (side * side < meshes)
+      ++side;
+    for (unsigned int i = 0; i < meshes; ++i)
+    {
+      NormalsMesh* mesh = new NormalsMesh (context, &phong, materials[i % MATERIALS]);
+      mesh->addGeometry (data);
+      mesh->addIndices (indices);
+      mesh->setArena (&scene->getGeometryArena ());
+      mesh->prepareVao ();
+      mesh->moveRight (4.0f * (i % side) - 2.0f * side);
+      mesh->moveBack (-4.0f * (i / side));
+      scene->add ("sphere" + std::to_string (i), mesh);
+    }
+
+    scene->addDirectionalLightSource (Vector3 (0.3f, 0.3f, 0.3f), Vector3 (0.3f, 0.3f, 0.3f),
+                                      Vector3 (0.0f, -1.0f, -1.0f));
+    for (unsigned int l = 0; l < POINT_LIGHTS; ++l)
+      scene->addPointLightSource (Vector3 (1.0f, 0.8f, 0.6f), Vector3 (1.0f, 1.0f, 1.0f),
+                                  Vector3 (8.0f * (l % 8) - 2.0f * side, 2.0f,
+                                           -8.0f * (l / 8) * side / 8.0f),
+                                  Vector3 (1.0f, 0.1f, 0.05f));
+
+    const unsigned int WARM_UP = 3;
+    Result result { 0.0, 0.0, 0.0, 0 };
+    for (unsigned int frame = 0; frame < WARM_UP + frames; ++frame)
+    {
+      camera.yaw (0.2f);
+      recording.clear ();
+      double start = now ();
+      context->clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      scene->draw (camera.getViewMatrix (), camera.getProjectionMatrix ());
+      if (backend == SOFTWARE_BACKEND)
+        software.flush ();
+      double elapsed = now () - start;
+      if (frame < WARM_UP)
+        continue;
+      result.micros += elapsed;
+      result.calls += recording.getCallCount ();
+      result.bytes += recording.getLog ().size ();
+    }
+    result.micros /= frames;
+    result.calls /= frames;
+    result.bytes /= frames;
+    result.visible = scene->getVisibleCount ();
+    if (backend == SOFTWARE_BACKEND && image != nullptr && software.savePPM (image))
+      printf ("Saved the last software frame to %s\n", image);
+
+    delete scene;
+    for (Material* material : materials)
+      delete material;
+    return result;
+  }
+}
+
+/// \brief Runs the benchmark with every backend and both shading paths.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The optional frame and mesh counts and image path.
+int
+main (int argc, char* argv[])
+{
+  unsigned int frames = (argc > 1) ? std::atoi (argv[1]) : 100;
+  unsigned int meshes = (argc > 2) ? std::atoi (argv[2]) : 2000;
+  const char* image = (argc > 3) ? argv[3] : nullptr;
+  JobSystem jobs;
+  printf ("%u meshes, %u lights, %u frames\n", meshes, POINT_LIGHTS + 1, frames);
+  printf ("%-18s %-12s %12s %12s %12s %8s\n", "context", "shading", "us/frame",
+          "calls/frame", "KiB/frame", "visible");
+
+  const char* const BACKEND_NAMES[] = { "null", "caching", "recording",
+                                        "caching+recording", "software" };
+  for (Submission submission : { PER_MESH, MULTI_DRAW, GPU_CULLED })
+    for (Scene::ShadingPath path : { Scene::FORWARD_SHADING, Scene::DEFERRED_SHADING })
+      for (Backend backend : { NULL_BACKEND, CACHING_BACKEND, RECORDING_BACKEND,
+                               CACHING_RECORDING_BACKEND, SOFTWARE_BACKEND })
+      {
+        if (backend == SOFTWARE_BACKEND && path != Scene::FORWARD_SHADING)
+          continue;
+        Result r = run (backend, path, submission, frames, meshes, &jobs, image);
+        std::string shading = (path == Scene::FORWARD_SHADING) ? "forward" : "deferred";
+        if (submission != PER_MESH)
+          shading += (submission == MULTI_DRAW) ? "+mdi" : "+gpu";
+        printf ("%-18s %-12s %12.1f", BACKEND_NAMES[backend], shading.c_str (), r.micros);
+        if (r.calls > 0.0)
+          printf (" %12.0f %12.1f", r.calls, r.bytes / 1024.0);
+        else
+          printf (" %12s %12s", "-", "-");
+        printf (" %8u\n", r.visible);
+      }
+  return EXIT_SUCCESS;
+}
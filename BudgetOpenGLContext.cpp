@@ -0,0 +1,771 @@
+/// \file BudgetOpenGLContext.cpp
+/// \brief Definitions of BudgetOpenGLContext member and associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <cstdio>
+
+#include "BudgetOpenGLContext.hpp"
+
+namespace
+{
+  /// The bytes in a mebibyte, for warnings.
+  const double MEBIBYTE = 1024.0 * 1024.0;
+}
+
+BudgetOpenGLContext::BudgetOpenGLContext (OpenGLContext* context)
+  : m_context (context), m_budget (0), m_overBudget (false), m_warnings (0),
+    m_live (), m_peak (0), m_buffers (), m_boundBuffers (), m_textures (),
+    m_activeTexture (GL_TEXTURE0), m_boundTextures (), m_vertexArrays ()
+{
+}
+
+BudgetOpenGLContext::~BudgetOpenGLContext ()
+{
+}
+
+const char*
+BudgetOpenGLContext::getCategoryName (MemoryCategory category)
+{
+  static const char* const NAMES[MEMORY_CATEGORY_COUNT] =
+    { "vertex", "index", "uniform", "texture", "other" };
+  return NAMES[category];
+}
+
+void
+BudgetOpenGLContext::setBudget (std::size_t bytes)
+{
+  m_budget = bytes;
+  m_overBudget = false;
+  checkBudget ();
+}
+
+std::size_t
+BudgetOpenGLContext::getBudget () const
+{
+  return m_budget;
+}
+
+std::size_t
+BudgetOpenGLContext::getLiveBytes (MemoryCategory category) const
+{
+  return m_live[category];
+}
+
+std::size_t
+BudgetOpenGLContext::getTotalBytes () const
+{
+  std::size_t total = 0;
+  for (std::size_t bytes : m_live)
+    total += bytes;
+  return total;
+}
+
+std::size_t
+BudgetOpenGLContext::getPeakBytes () const
+{
+  return m_peak;
+}
+
+unsigned int
+BudgetOpenGLContext::getWarningCount () const
+{
+  return m_warnings;
+}
+
+std::size_t
+BudgetOpenGLContext::getBufferCount () const
+{
+  return m_buffers.size ();
+}
+
+std::size_t
+BudgetOpenGLContext::getTextureCount () const
+{
+  return m_textures.size ();
+}
+
+std::size_t
+BudgetOpenGLContext::getVertexArrayCount () const
+{
+  return m_vertexArrays.size ();
+}
+
+void
+BudgetOpenGLContext::activeTexture (GLenum texture)
+{
+  m_activeTexture = texture;
+  m_context->activeTexture (texture);
+}
+
+void
+BudgetOpenGLContext::attachShader (GLuint program, GLuint shader)
+{
+  m_context->attachShader (program, shader);
+}
+
+void
+BudgetOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+  m_boundBuffers[target] = buffer;
+  classify (buffer, getTargetCategory (target));
+  m_context->bindBuffer (target, buffer);
+}
+
+void
+BudgetOpenGLContext::bindBufferBase (GLenum target, GLuint index, GLuint buffer)
+{
+  m_boundBuffers[target] = buffer;
+  classify (buffer, getTargetCategory (target));
+  m_context->bindBufferBase (target, index, buffer);
+}
+
+void
+BudgetOpenGLContext::bindFramebuffer (GLenum target, GLuint framebuffer)
+{
+  m_context->bindFramebuffer (target, framebuffer);
+}
+
+void
+BudgetOpenGLContext::bindTexture (GLenum target, GLuint texture)
+{
+  m_boundTextures[std::make_pair (m_activeTexture, target)] = texture;
+  m_context->bindTexture (target, texture);
+}
+
+void
+BudgetOpenGLContext::bindVertexArray (GLuint array)
+{
+  m_context->bindVertexArray (array);
+}
+
+void
+BudgetOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+  setBufferSize (m_boundBuffers[target], size);
+  m_context->bufferData (target, size, data, usage);
+}
+
+void
+BudgetOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  m_context->bufferSubData (target, offset, size, data);
+}
+
+GLenum
+BudgetOpenGLContext::checkFramebufferStatus (GLenum target)
+{
+  return m_context->checkFramebufferStatus (target);
+}
+
+void
+BudgetOpenGLContext::clear (GLbitfield mask)
+{
+  m_context->clear (mask);
+}
+
+void
+BudgetOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  m_context->clearColor (red, green, blue, alpha);
+}
+
+GLenum
+BudgetOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  return m_context->clientWaitSync (sync, flags, timeout);
+}
+
+void
+BudgetOpenGLContext::compileShader (GLuint shader)
+{
+  m_context->compileShader (shader);
+}
+
+void
+BudgetOpenGLContext::createBuffers (GLsizei n, GLuint* buffers)
+{
+  m_context->createBuffers (n, buffers);
+  for (GLsizei i = 0; i < n; ++i)
+    m_buffers[buffers[i]] = BufferMemory { 0, OTHER_MEMORY };
+}
+
+GLuint
+BudgetOpenGLContext::createProgram ()
+{
+  return m_context->createProgram ();
+}
+
+GLuint
+BudgetOpenGLContext::createShader (GLenum shaderType)
+{
+  return m_context->createShader (shaderType);
+}
+
+void
+BudgetOpenGLContext::createVertexArrays (GLsizei n, GLuint* arrays)
+{
+  m_context->createVertexArrays (n, arrays);
+  m_vertexArrays.insert (arrays, arrays + n);
+}
+
+void
+BudgetOpenGLContext::cullFace (GLenum mode)
+{
+  m_context->cullFace (mode);
+}
+
+void
+BudgetOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    setBufferSize (buffers[i], 0);
+    m_buffers.erase (buffers[i]);
+    // Deleting a bound buffer unbinds it.
+    for (std::pair<const GLenum, GLuint>& binding : m_boundBuffers)
+      if (binding.second == buffers[i])
+        binding.second = 0;
+  }
+  m_context->deleteBuffers (n, buffers);
+}
+
+void
+BudgetOpenGLContext::deleteFramebuffers (GLsizei n, const GLuint* framebuffers)
+{
+  m_context->deleteFramebuffers (n, framebuffers);
+}
+
+void
+BudgetOpenGLContext::deleteProgram (GLuint program)
+{
+  m_context->deleteProgram (program);
+}
+
+void
+BudgetOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+  m_context->deleteQueries (n, ids);
+}
+
+void
+BudgetOpenGLContext::deleteShader (GLuint shader)
+{
+  m_context->deleteShader (shader);
+}
+
+void
+BudgetOpenGLContext::deleteSync (GLsync sync)
+{
+  m_context->deleteSync (sync);
+}
+
+void
+BudgetOpenGLContext::deleteTextures (GLsizei n, const GLuint* textures)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    auto found = m_textures.find (textures[i]);
+    if (found == m_textures.end ())
+      continue;
+    for (const std::pair<const std::pair<GLenum, GLint>, std::size_t>& image : found->second)
+      change (TEXTURE_MEMORY, image.second, 0);
+    m_textures.erase (found);
+    for (std::pair<const std::pair<GLenum, GLenum>, GLuint>& binding : m_boundTextures)
+      if (binding.second == textures[i])
+        binding.second = 0;
+  }
+  m_context->deleteTextures (n, textures);
+}
+
+void
+BudgetOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    m_vertexArrays.erase (arrays[i]);
+  m_context->deleteVertexArrays (n, arrays);
+}
+
+void
+BudgetOpenGLContext::depthFunc (GLenum func)
+{
+  m_context->depthFunc (func);
+}
+
+void
+BudgetOpenGLContext::detachShader (GLuint program, GLuint shader)
+{
+  m_context->detachShader (program, shader);
+}
+
+void
+BudgetOpenGLContext::dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+  m_context->dispatchCompute (num_groups_x, num_groups_y, num_groups_z);
+}
+
+void
+BudgetOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+  m_context->drawArrays (mode, first, count);
+}
+
+void
+BudgetOpenGLContext::drawBuffers (GLsizei n, const GLenum* bufs)
+{
+  m_context->drawBuffers (n, bufs);
+}
+
+void
+BudgetOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+  m_context->drawElements (mode, count, type, indices);
+}
+
+void
+BudgetOpenGLContext::enable (GLenum cap)
+{
+  m_context->enable (cap);
+}
+
+void
+BudgetOpenGLContext::enableVertexArrayAttrib (GLuint vaobj, GLuint index)
+{
+  m_context->enableVertexArrayAttrib (vaobj, index);
+}
+
+void
+BudgetOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+  m_context->enableVertexAttribArray (index);
+}
+
+GLsync
+BudgetOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return m_context->fenceSync (condition, flags);
+}
+
+void
+BudgetOpenGLContext::framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+  m_context->framebufferTexture2D (target, attachment, textarget, texture, level);
+}
+
+void
+BudgetOpenGLContext::frontFace (GLenum mode)
+{
+  m_context->frontFace (mode);
+}
+
+void
+BudgetOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
+{
+  m_context->genBuffers (n, buffers);
+  for (GLsizei i = 0; i < n; ++i)
+    m_buffers[buffers[i]] = BufferMemory { 0, OTHER_MEMORY };
+}
+
+void
+BudgetOpenGLContext::genFramebuffers (GLsizei n, GLuint* framebuffers)
+{
+  m_context->genFramebuffers (n, framebuffers);
+}
+
+void
+BudgetOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  m_context->genQueries (n, ids);
+}
+
+void
+BudgetOpenGLContext::genTextures (GLsizei n, GLuint* textures)
+{
+  m_context->genTextures (n, textures);
+  for (GLsizei i = 0; i < n; ++i)
+    m_textures[textures[i]];
+}
+
+void
+BudgetOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
+{
+  m_context->genVertexArrays (n, arrays);
+  m_vertexArrays.insert (arrays, arrays + n);
+}
+
+void
+BudgetOpenGLContext::getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+  m_context->getActiveUniform (program, index, bufSize, length, size, type, name);
+}
+
+GLint
+BudgetOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
+{
+  return m_context->getAttribLocation (program, name);
+}
+
+void
+BudgetOpenGLContext::getIntegerv (GLenum pname, GLint* data)
+{
+  m_context->getIntegerv (pname, data);
+}
+
+void
+BudgetOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  m_context->getProgramBinary (program, bufSize, length, binaryFormat, binary);
+}
+
+void
+BudgetOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  m_context->getProgramInfoLog (program, maxLength, length, infoLog);
+}
+
+void
+BudgetOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+  m_context->getProgramiv (program, pname, params);
+}
+
+void
+BudgetOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  m_context->getQueryObjectiv (id, pname, params);
+}
+
+void
+BudgetOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  m_context->getQueryObjectui64v (id, pname, params);
+}
+
+void
+BudgetOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  m_context->getShaderInfoLog (shader, maxLength, length, infoLog);
+}
+
+void
+BudgetOpenGLContext::getShaderiv (GLuint shader, GLenum pname, GLint* params)
+{
+  m_context->getShaderiv (shader, pname, params);
+}
+
+const GLubyte*
+BudgetOpenGLContext::getString (GLenum name)
+{
+  return m_context->getString (name);
+}
+
+GLuint
+BudgetOpenGLContext::getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName)
+{
+  return m_context->getUniformBlockIndex (program, uniformBlockName);
+}
+
+GLint
+BudgetOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
+{
+  return m_context->getUniformLocation (program, name);
+}
+
+void
+BudgetOpenGLContext::linkProgram (GLuint program)
+{
+  m_context->linkProgram (program);
+}
+
+void*
+BudgetOpenGLContext::mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+  return m_context->mapNamedBufferRange (buffer, offset, length, access);
+}
+
+void
+BudgetOpenGLContext::maxShaderCompilerThreadsKHR (GLuint count)
+{
+  m_context->maxShaderCompilerThreadsKHR (count);
+}
+
+void
+BudgetOpenGLContext::memoryBarrier (GLbitfield barriers)
+{
+  m_context->memoryBarrier (barriers);
+}
+
+void
+BudgetOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  m_context->multiDrawElementsIndirect (mode, type, indirect, drawcount, stride);
+}
+
+void
+BudgetOpenGLContext::multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+  m_context->multiDrawElementsIndirectCount (mode, type, indirect, drawcount, maxdrawcount, stride);
+}
+
+void
+BudgetOpenGLContext::namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+  setBufferSize (buffer, size);
+  m_context->namedBufferData (buffer, size, data, usage);
+}
+
+void
+BudgetOpenGLContext::namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+  setBufferSize (buffer, size);
+  m_context->namedBufferStorage (buffer, size, data, flags);
+}
+
+void
+BudgetOpenGLContext::namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+  m_context->namedBufferSubData (buffer, offset, size, data);
+}
+
+void
+BudgetOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+  m_context->programBinary (program, binaryFormat, binary, length);
+}
+
+void
+BudgetOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+  m_context->programParameteri (program, pname, value);
+}
+
+void
+BudgetOpenGLContext::queryCounter (GLuint id, GLenum target)
+{
+  m_context->queryCounter (id, target);
+}
+
+void
+BudgetOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{
+  m_context->shaderSource (shader, count, string, length);
+}
+
+void
+BudgetOpenGLContext::texBuffer (GLenum target, GLenum internalformat, GLuint buffer)
+{
+  classify (buffer, TEXTURE_MEMORY);
+  m_context->texBuffer (target, internalformat, buffer);
+}
+
+void
+BudgetOpenGLContext::texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data)
+{
+  GLenum bindingTarget = target;
+  if (target >= GL_TEXTURE_CUBE_MAP_POSITIVE_X && target <= GL_TEXTURE_CUBE_MAP_NEGATIVE_Z)
+    bindingTarget = GL_TEXTURE_CUBE_MAP;
+  GLuint texture = m_boundTextures[std::make_pair (m_activeTexture, bindingTarget)];
+  if (texture != 0)
+  {
+    std::size_t& bytes = m_textures[texture][std::make_pair (target, level)];
+    std::size_t size = std::size_t (std::max (width, 0)) * std::max (height, 0)
+      * getTexelSize (internalformat);
+    change (TEXTURE_MEMORY, bytes, size);
+    bytes = size;
+  }
+  m_context->texImage2D (target, level, internalformat, width, height, border, format,
+                         type, data);
+}
+
+void
+BudgetOpenGLContext::texParameteri (GLenum target, GLenum pname, GLint param)
+{
+  m_context->texParameteri (target, pname, param);
+}
+
+void
+BudgetOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  m_context->uniform1f (location, v0);
+}
+
+void
+BudgetOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  m_context->uniform1i (location, v0);
+}
+
+void
+BudgetOpenGLContext::uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+  m_context->uniform3f (location, v0, v1, v2);
+}
+
+void
+BudgetOpenGLContext::uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+  m_context->uniformBlockBinding (program, uniformBlockIndex, uniformBlockBinding);
+}
+
+void
+BudgetOpenGLContext::uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  m_context->uniformMatrix3fv (location, count, transpose, value);
+}
+
+void
+BudgetOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  m_context->uniformMatrix4fv (location, count, transpose, value);
+}
+
+GLboolean
+BudgetOpenGLContext::unmapNamedBuffer (GLuint buffer)
+{
+  return m_context->unmapNamedBuffer (buffer);
+}
+
+void
+BudgetOpenGLContext::useProgram (GLuint program)
+{
+  m_context->useProgram (program);
+}
+
+void
+BudgetOpenGLContext::vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+  m_context->vertexArrayAttribBinding (vaobj, attribindex, bindingindex);
+}
+
+void
+BudgetOpenGLContext::vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+  m_context->vertexArrayAttribFormat (vaobj, attribindex, size, type, normalized, relativeoffset);
+}
+
+void
+BudgetOpenGLContext::vertexArrayElementBuffer (GLuint vaobj, GLuint buffer)
+{
+  classify (buffer, INDEX_MEMORY);
+  m_context->vertexArrayElementBuffer (vaobj, buffer);
+}
+
+void
+BudgetOpenGLContext::vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+{
+  classify (buffer, VERTEX_MEMORY);
+  m_context->vertexArrayVertexBuffer (vaobj, bindingindex, buffer, offset, stride);
+}
+
+void
+BudgetOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+  m_context->vertexAttribPointer (index, size, type, normalized, stride, pointer);
+}
+
+void
+BudgetOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  m_context->viewport (x, y, width, height);
+}
+
+BudgetOpenGLContext::MemoryCategory
+BudgetOpenGLContext::getTargetCategory (GLenum target)
+{
+  switch (target)
+  {
+  case GL_ARRAY_BUFFER:
+    return VERTEX_MEMORY;
+  case GL_ELEMENT_ARRAY_BUFFER:
+    return INDEX_MEMORY;
+  case GL_UNIFORM_BUFFER:
+    return UNIFORM_MEMORY;
+  case GL_TEXTURE_BUFFER:
+    return TEXTURE_MEMORY;
+  default:
+    return OTHER_MEMORY;
+  }
+}
+
+std::size_t
+BudgetOpenGLContext::getTexelSize (GLint internalformat)
+{
+  switch (internalformat)
+  {
+  case GL_R8:
+  case GL_RED:
+    return 1;
+  case GL_RG8:
+  case GL_DEPTH_COMPONENT16:
+    return 2;
+  case GL_RGB8:
+  case GL_RGB:
+    return 3;
+  case GL_RGBA16F:
+  case GL_RG32F:
+  case GL_RG32UI:
+    return 8;
+  case GL_RGB32F:
+    return 12;
+  case GL_RGBA32F:
+  case GL_RGBA32UI:
+    return 16;
+  default:
+    // RGBA8, R32F, R32UI, and the 24- and 32-bit depth formats, which
+    //   drivers store in four bytes.
+    return 4;
+  }
+}
+
+void
+BudgetOpenGLContext::setBufferSize (GLuint buffer, std::size_t bytes)
+{
+  if (buffer == 0)
+    return;
+  auto found = m_buffers.emplace (buffer, BufferMemory { 0, OTHER_MEMORY }).first;
+  std::size_t old = found->second.bytes;
+  found->second.bytes = bytes;
+  change (found->second.category, old, bytes);
+}
+
+void
+BudgetOpenGLContext::classify (GLuint buffer, MemoryCategory category)
+{
+  if (buffer == 0 || category == OTHER_MEMORY)
+    return;
+  auto found = m_buffers.emplace (buffer, BufferMemory { 0, OTHER_MEMORY }).first;
+  if (found->second.category != OTHER_MEMORY)
+    return;
+  // Moving bytes between categories leaves the total as it was.
+  found->second.category = category;
+  m_live[OTHER_MEMORY] -= found->second.bytes;
+  m_live[category] += found->second.bytes;
+}
+
+void
+BudgetOpenGLContext::change (MemoryCategory category, std::size_t removed, std::size_t added)
+{
+  m_live[category] = m_live[category] - removed + added;
+  m_peak = std::max (m_peak, getTotalBytes ());
+  checkBudget ();
+}
+
+void
+BudgetOpenGLContext::checkBudget ()
+{
+  std::size_t total = getTotalBytes ();
+  bool over = (m_budget != 0 && total > m_budget);
+  if (over && !m_overBudget)
+  {
+    ++m_warnings;
+    fprintf (stderr, "GPU memory over budget: %.1f of %.1f MiB (", total / MEBIBYTE,
+             m_budget / MEBIBYTE);
+    for (int category = 0; category < MEMORY_CATEGORY_COUNT; ++category)
+      fprintf (stderr, "%s%s %.1f", category == 0 ? "" : ", ",
+               getCategoryName (MemoryCategory (category)), m_live[category] / MEBIBYTE);
+    fprintf (stderr, ")\n");
+  }
+  m_overBudget = over;
+}
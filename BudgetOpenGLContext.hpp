@@ -0,0 +1,467 @@
+/// \file BudgetOpenGLContext.hpp
+/// \brief Declaration of BudgetOpenGLContext and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef BUDGET_OPENGL_CONTEXT_HPP
+#define BUDGET_OPENGL_CONTEXT_HPP
+
+#include <cstddef>
+#include <map>
+#include <set>
+#include <utility>
+
+#include "OpenGLContext.hpp"
+
+/// \brief A subclass of OpenGLContext that keeps count of the GPU memory
+///   the engine has allocated, by what it holds, passing every call on to
+///   another OpenGLContext.
+///
+/// A buffer's size is what was last given to bufferData, namedBufferData,
+///   or namedBufferStorage for it.  What it holds is taken from the first
+///   role it is given that says:
+///   - vertices, if it is bound to GL_ARRAY_BUFFER or to a vertex array's
+///     vertex binding;
+///   - indices, if it is bound to GL_ELEMENT_ARRAY_BUFFER or as a vertex
+///     array's element buffer;
+///   - uniforms, if it is bound to GL_UNIFORM_BUFFER;
+///   - texels, if it is bound to GL_TEXTURE_BUFFER or read by a buffer
+///     texture.
+///   Until then (and for buffers that only ever hold indirect commands, or
+///   are only copied through) it counts as other memory.  A texture's size
+///   is the sum of the images given to texImage2D for it, at the size of its
+///   internal format's texels.  Memory is counted until it is deleted.
+///
+/// Every buffer and texture call must go through this context for the
+///   counts to be right.  Drivers pad and align what they allocate, so the
+///   counts are what was asked for, a lower bound on what is used.
+///
+/// With a budget set, a warning is printed each time the total goes over
+///   it (not again until it has come back under).
+class BudgetOpenGLContext : public OpenGLContext
+{
+public:
+
+  /// \brief What memory holds.
+  enum MemoryCategory
+  {
+    VERTEX_MEMORY,
+    INDEX_MEMORY,
+    UNIFORM_MEMORY,
+    TEXTURE_MEMORY,
+    OTHER_MEMORY,
+    /// The number of categories, not a category.
+    MEMORY_CATEGORY_COUNT
+  };
+
+  /// \brief Constructs a BudgetOpenGLContext with nothing allocated and no
+  ///   budget.
+  /// \param[in] context The context to pass calls on to, which must outlive
+  ///   this one.
+  explicit
+  BudgetOpenGLContext (OpenGLContext* context);
+
+  /// Destructs a BudgetOpenGLContext.
+  virtual
+  ~BudgetOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   BudgetOpenGLContexts.
+  BudgetOpenGLContext (const BudgetOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   BudgetOpenGLContexts.
+  BudgetOpenGLContext&
+  operator= (const BudgetOpenGLContext&) = delete;
+
+  /// \brief Gets the name of a category, for reports.
+  /// \param[in] category The category.
+  /// \return Its name, in lower case.
+  static const char*
+  getCategoryName (MemoryCategory category);
+
+  /// \brief Sets how many bytes may be allocated before warning.
+  /// \param[in] bytes The budget, or 0 for none.
+  /// \post If the total is already over it, that has been warned of.
+  void
+  setBudget (std::size_t bytes);
+
+  /// \brief Gets how many bytes may be allocated before warning.
+  /// \return The budget, or 0 if there is none.
+  std::size_t
+  getBudget () const;
+
+  /// \brief Gets the bytes allocated for one category.
+  /// \param[in] category The category.
+  /// \return The bytes of every buffer or texture in it not yet deleted.
+  std::size_t
+  getLiveBytes (MemoryCategory category) const;
+
+  /// \brief Gets the bytes allocated for every category.
+  /// \return The sum of getLiveBytes over every category.
+  std::size_t
+  getTotalBytes () const;
+
+  /// \brief Gets the most bytes that were ever allocated at once.
+  /// \return The highest getTotalBytes () has been.
+  std::size_t
+  getPeakBytes () const;
+
+  /// \brief Gets the number of times the budget was gone over.
+  /// \return The number of warnings printed.
+  unsigned int
+  getWarningCount () const;
+
+  /// \brief Gets the number of buffers not yet deleted.
+  /// \return The count.
+  std::size_t
+  getBufferCount () const;
+
+  /// \brief Gets the number of textures not yet deleted.
+  /// \return The count.
+  std::size_t
+  getTextureCount () const;
+
+  /// \brief Gets the number of vertex arrays not yet deleted.
+  /// \return The count.
+  std::size_t
+  getVertexArrayCount () const;
+
+  virtual void
+  activeTexture (GLenum texture);
+
+  virtual void
+  attachShader (GLuint program, GLuint shader);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindBufferBase (GLenum target, GLuint index, GLuint buffer);
+
+  virtual void
+  bindFramebuffer (GLenum target, GLuint framebuffer);
+
+  virtual void
+  bindTexture (GLenum target, GLuint texture);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual GLenum
+  checkFramebufferStatus (GLenum target);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+  virtual void
+  compileShader (GLuint shader);
+
+  virtual void
+  createBuffers (GLsizei n, GLuint* buffers);
+
+  virtual GLuint
+  createProgram ();
+
+  virtual GLuint
+  createShader (GLenum shaderType);
+
+  virtual void
+  createVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteFramebuffers (GLsizei n, const GLuint* framebuffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
+  virtual void
+  deleteShader (GLuint shader);
+
+  virtual void
+  deleteSync (GLsync sync);
+
+  virtual void
+  deleteTextures (GLsizei n, const GLuint* textures);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  depthFunc (GLenum func);
+
+  virtual void
+  detachShader (GLuint program, GLuint shader);
+
+  virtual void
+  dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawBuffers (GLsizei n, const GLenum* bufs);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexArrayAttrib (GLuint vaobj, GLuint index);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual void
+  genBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  genFramebuffers (GLsizei n, GLuint* framebuffers);
+
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
+  virtual void
+  genTextures (GLsizei n, GLuint* textures);
+
+  virtual void
+  genVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+
+  virtual GLint
+  getAttribLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  getIntegerv (GLenum pname, GLint* data);
+
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
+  virtual void
+  getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getProgramiv (GLuint program, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
+  virtual void
+  getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getShaderiv (GLuint shader, GLenum pname, GLint* params);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual GLuint
+  getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName);
+
+  virtual GLint
+  getUniformLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void*
+  mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+  virtual void
+  maxShaderCompilerThreadsKHR (GLuint count);
+
+  virtual void
+  memoryBarrier (GLbitfield barriers);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+  virtual void
+  namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+
+  virtual void
+  namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+
+  virtual void
+  namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
+  virtual void
+  queryCounter (GLuint id, GLenum target);
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+
+  virtual void
+  texBuffer (GLenum target, GLenum internalformat, GLuint buffer);
+
+  virtual void
+  texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data);
+
+  virtual void
+  texParameteri (GLenum target, GLenum pname, GLint param);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+
+  virtual void
+  uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+
+  virtual void
+  uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual GLboolean
+  unmapNamedBuffer (GLuint buffer);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+
+  virtual void
+  vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+
+  virtual void
+  vertexArrayElementBuffer (GLuint vaobj, GLuint buffer);
+
+  virtual void
+  vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+
+  /// \brief The memory of one buffer.
+  struct BufferMemory
+  {
+    /// Its size, in bytes.
+    std::size_t bytes;
+    /// What it holds.
+    MemoryCategory category;
+  };
+
+  /// \brief Finds what a buffer bound to a target holds.
+  /// \param[in] target The target.
+  /// \return The category, or OTHER_MEMORY if the target doesn't say.
+  static MemoryCategory
+  getTargetCategory (GLenum target);
+
+  /// \brief Finds the size of one texel of an internal format.
+  /// \param[in] internalformat The format.
+  /// \return Its bytes, or 4 for a format not known here.
+  static std::size_t
+  getTexelSize (GLint internalformat);
+
+  /// \brief Changes the size of a buffer.
+  /// \param[in] buffer The buffer, or 0 for none.
+  /// \param[in] bytes Its new size.
+  void
+  setBufferSize (GLuint buffer, std::size_t bytes);
+
+  /// \brief Says what a buffer holds, if that isn't known yet.
+  /// \param[in] buffer The buffer, or 0 for none.
+  /// \param[in] category What it holds, or OTHER_MEMORY if that isn't said.
+  void
+  classify (GLuint buffer, MemoryCategory category);
+
+  /// \brief Changes the bytes allocated for one category, and warns if that
+  ///   takes the total over the budget.
+  /// \param[in] category The category.
+  /// \param[in] removed The bytes freed.
+  /// \param[in] added The bytes allocated.
+  void
+  change (MemoryCategory category, std::size_t removed, std::size_t added);
+
+  /// \brief Warns if the total has gone over the budget since it was last
+  ///   under it.
+  void
+  checkBudget ();
+
+  /// The context to pass calls on to.
+  OpenGLContext* m_context;
+  /// The budget, or 0.
+  std::size_t m_budget;
+  /// Whether or not the total was over the budget when last checked.
+  bool m_overBudget;
+  /// The number of warnings printed.
+  unsigned int m_warnings;
+  /// The bytes allocated, by category.
+  std::size_t m_live[MEMORY_CATEGORY_COUNT];
+  /// The most bytes ever allocated at once.
+  std::size_t m_peak;
+  /// Every buffer not yet deleted.
+  std::map<GLuint, BufferMemory> m_buffers;
+  /// The buffer bound to each target.
+  std::map<GLenum, GLuint> m_boundBuffers;
+  /// Every texture not yet deleted, with the bytes of each of its images,
+  ///   by target (the face, for cube maps) and level.
+  std::map<GLuint, std::map<std::pair<GLenum, GLint>, std::size_t>> m_textures;
+  /// The active texture unit.
+  GLenum m_activeTexture;
+  /// The texture bound to each target of each unit.
+  std::map<std::pair<GLenum, GLenum>, GLuint> m_boundTextures;
+  /// Every vertex array not yet deleted.
+  std::set<GLuint> m_vertexArrays;
+};
+
+#endif//BUDGET_OPENGL_CONTEXT_HPP
@@ -0,0 +1,248 @@
+/// \file BufferAllocator.cpp
+/// \brief Definition of BufferAllocator class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <iterator>
+
+#include "BufferAllocator.hpp"
+
+namespace
+{
+  /// The number of first levels: one for every size below
+  ///   2^SECOND_LEVEL_BITS, and then one per highest bit.
+  const unsigned int FIRST_LEVELS = 64 - BufferAllocator::SECOND_LEVEL_BITS + 1;
+
+  /// The number of lists per first level.
+  const unsigned int SECOND_LEVELS = 1u << BufferAllocator::SECOND_LEVEL_BITS;
+
+  /// \brief Finds the highest bit set.
+  /// \param[in] bits The bits, which aren't all 0.
+  /// \return The bit's position, from 0 for the lowest.
+  unsigned int
+  highestBit (std::uint64_t bits)
+  {
+    unsigned int bit = 0;
+    while (bits >>= 1)
+      ++bit;
+    return bit;
+  }
+
+  /// \brief Finds the lowest bit set.
+  /// \param[in] bits The bits, which aren't all 0.
+  /// \return The bit's position, from 0 for the lowest.
+  unsigned int
+  lowestBit (std::uint64_t bits)
+  {
+    unsigned int bit = 0;
+    while ((bits & 1) == 0)
+    {
+      bits >>= 1;
+      ++bit;
+    }
+    return bit;
+  }
+}
+
+const std::size_t BufferAllocator::NONE;
+
+const unsigned int BufferAllocator::SECOND_LEVEL_BITS;
+
+BufferAllocator::BufferAllocator (std::size_t capacity)
+  : m_capacity (capacity), m_used (0), m_ranges (),
+    m_lists (FIRST_LEVELS * SECOND_LEVELS, NONE), m_firstLevels (0),
+    m_secondLevels (FIRST_LEVELS, 0)
+{
+  clear ();
+}
+
+BufferAllocator::~BufferAllocator ()
+{
+}
+
+std::size_t
+BufferAllocator::allocate (std::size_t size)
+{
+  size = std::max<std::size_t> (size, 1);
+  // Rounding up to the next list's smallest size means any range in the
+  //   list found is big enough, without searching it.
+  std::size_t rounded = size;
+  if (size >= SECOND_LEVELS)
+    rounded += (std::size_t (1) << (highestBit (size) - SECOND_LEVEL_BITS)) - 1;
+  unsigned int list = getList (rounded);
+  unsigned int first = list / SECOND_LEVELS;
+  std::uint32_t seconds = m_secondLevels[first] & (~0u << (list % SECOND_LEVELS));
+  std::size_t offset = NONE;
+  if (seconds != 0)
+    offset = m_lists[first * SECOND_LEVELS + lowestBit (seconds)];
+  else
+  {
+    std::uint64_t firsts = (first + 1 < 64) ? m_firstLevels & (~std::uint64_t (0) << (first + 1)) : 0;
+    if (firsts != 0)
+    {
+      first = lowestBit (firsts);
+      offset = m_lists[first * SECOND_LEVELS + lowestBit (m_secondLevels[first])];
+    }
+  }
+  // The only ranges that big may be in the list of the size itself.
+  if (offset == NONE)
+    for (std::size_t at = m_lists[getList (size)]; at != NONE; at = m_ranges[at].nextFree)
+      if (m_ranges[at].size >= size)
+      {
+        offset = at;
+        break;
+      }
+  if (offset == NONE)
+    return NONE;
+
+  auto range = m_ranges.find (offset);
+  unlink (range);
+  range->second.free = false;
+  if (range->second.size > size)
+  {
+    // What is past it can't be free, or the two would have been merged.
+    auto rest = m_ranges.emplace (offset + size, Range { range->second.size - size, true,
+                                                          NONE, NONE }).first;
+    link (rest);
+    range->second.size = size;
+  }
+  m_used += size;
+  return offset;
+}
+
+void
+BufferAllocator::release (std::size_t offset)
+{
+  auto range = m_ranges.find (offset);
+  if (range == m_ranges.end () || range->second.free)
+    return;
+  std::size_t size = range->second.size;
+  m_used -= size;
+  m_ranges.erase (range);
+  addFree (offset, size);
+}
+
+void
+BufferAllocator::grow (std::size_t capacity)
+{
+  if (capacity <= m_capacity)
+    return;
+  addFree (m_capacity, capacity - m_capacity);
+  m_capacity = capacity;
+}
+
+void
+BufferAllocator::clear ()
+{
+  m_ranges.clear ();
+  std::fill (m_lists.begin (), m_lists.end (), NONE);
+  m_firstLevels = 0;
+  std::fill (m_secondLevels.begin (), m_secondLevels.end (), 0);
+  m_used = 0;
+  if (m_capacity > 0)
+    addFree (0, m_capacity);
+}
+
+std::size_t
+BufferAllocator::getCapacity () const
+{
+  return m_capacity;
+}
+
+std::size_t
+BufferAllocator::getUsed () const
+{
+  return m_used;
+}
+
+std::size_t
+BufferAllocator::getFreeRangeCount () const
+{
+  std::size_t count = 0;
+  for (const std::pair<const std::size_t, Range>& range : m_ranges)
+    if (range.second.free)
+      ++count;
+  return count;
+}
+
+std::size_t
+BufferAllocator::getLargestFree () const
+{
+  if (m_firstLevels == 0)
+    return 0;
+  unsigned int first = highestBit (m_firstLevels);
+  unsigned int list = first * SECOND_LEVELS + highestBit (m_secondLevels[first]);
+  std::size_t largest = 0;
+  for (std::size_t at = m_lists[list]; at != NONE; at = m_ranges.at (at).nextFree)
+    largest = std::max (largest, m_ranges.at (at).size);
+  return largest;
+}
+
+unsigned int
+BufferAllocator::getList (std::size_t size)
+{
+  if (size < SECOND_LEVELS)
+    return size;
+  unsigned int bit = highestBit (size);
+  unsigned int second = (size >> (bit - SECOND_LEVEL_BITS)) & (SECOND_LEVELS - 1);
+  return (bit - SECOND_LEVEL_BITS + 1) * SECOND_LEVELS + second;
+}
+
+void
+BufferAllocator::link (std::map<std::size_t, Range>::iterator range)
+{
+  unsigned int list = getList (range->second.size);
+  std::size_t head = m_lists[list];
+  range->second.previousFree = NONE;
+  range->second.nextFree = head;
+  if (head != NONE)
+    m_ranges[head].previousFree = range->first;
+  m_lists[list] = range->first;
+  m_firstLevels |= std::uint64_t (1) << (list / SECOND_LEVELS);
+  m_secondLevels[list / SECOND_LEVELS] |= 1u << (list % SECOND_LEVELS);
+}
+
+void
+BufferAllocator::unlink (std::map<std::size_t, Range>::iterator range)
+{
+  unsigned int list = getList (range->second.size);
+  Range& removed = range->second;
+  if (removed.previousFree != NONE)
+    m_ranges[removed.previousFree].nextFree = removed.nextFree;
+  else
+    m_lists[list] = removed.nextFree;
+  if (removed.nextFree != NONE)
+    m_ranges[removed.nextFree].previousFree = removed.previousFree;
+  if (m_lists[list] == NONE)
+  {
+    m_secondLevels[list / SECOND_LEVELS] &= ~(1u << (list % SECOND_LEVELS));
+    if (m_secondLevels[list / SECOND_LEVELS] == 0)
+      m_firstLevels &= ~(std::uint64_t (1) << (list / SECOND_LEVELS));
+  }
+}
+
+void
+BufferAllocator::addFree (std::size_t offset, std::size_t size)
+{
+  auto next = m_ranges.lower_bound (offset);
+  if (next != m_ranges.end () && next->second.free && next->first == offset + size)
+  {
+    size += next->second.size;
+    unlink (next);
+    next = m_ranges.erase (next);
+  }
+  if (next != m_ranges.begin ())
+  {
+    auto previous = std::prev (next);
+    if (previous->second.free && previous->first + previous->second.size == offset)
+    {
+      offset = previous->first;
+      size += previous->second.size;
+      unlink (previous);
+      m_ranges.erase (previous);
+    }
+  }
+  link (m_ranges.emplace (offset, Range { size, true, NONE, NONE }).first);
+}
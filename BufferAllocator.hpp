@@ -0,0 +1,145 @@
+/// \file BufferAllocator.hpp
+/// \brief Declaration of BufferAllocator class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef BUFFER_ALLOCATOR_HPP
+#define BUFFER_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/// \brief Hands out ranges of a buffer (of any unit: bytes, vertices,
+///   indices, ...) and takes them back, keeping no memory of its own but
+///   the bookkeeping, so it can carve up storage that lives on the GPU.
+///
+/// It is a two-level segregated fit (TLSF) allocator.  Free ranges are kept
+///   in lists by size: the first level by the position of the size's
+///   highest bit, the second by the next SECOND_LEVEL_BITS bits.  A bitmap
+///   of which lists are non-empty finds a free range at least as big as any
+///   request in constant time, with at most 1/16 of it left over as slack
+///   before it is split.  Released ranges are merged with the free ranges
+///   on either side, so free space never stays split up between two ranges
+///   that are both free.
+///
+/// Ranges are never moved, so a buffer whose ranges come and go in
+///   different sizes fragments; its owner can copy them together and
+///   allocate them again after clear () (see GeometryArena::defragment).
+class BufferAllocator
+{
+public:
+
+  /// What allocate returns when no free range is big enough.
+  static const std::size_t NONE = SIZE_MAX;
+
+  /// The number of bits of a size past its highest that pick its list.
+  static const unsigned int SECOND_LEVEL_BITS = 4;
+
+  /// \brief Constructs a BufferAllocator with everything free.
+  /// \param[in] capacity The size of the buffer.
+  explicit
+  BufferAllocator (std::size_t capacity = 0);
+
+  /// \brief Destructs a BufferAllocator.
+  ~BufferAllocator ();
+
+  /// \brief Takes a free range.
+  /// \param[in] size The range's size; 0 is taken as 1, so that every range
+  ///   has an offset of its own.
+  /// \return The offset of the range, or NONE if no free range is that big.
+  std::size_t
+  allocate (std::size_t size);
+
+  /// \brief Gives a range back.
+  /// \param[in] offset The offset allocate returned for it.
+  /// \post The range is free, merged with any free neighbours.
+  void
+  release (std::size_t offset);
+
+  /// \brief Makes the buffer bigger.
+  /// \param[in] capacity The new size, which is no smaller than the old.
+  /// \post The space added at the end is free.
+  void
+  grow (std::size_t capacity);
+
+  /// \brief Frees every range at once.
+  /// \post The whole buffer is one free range.
+  void
+  clear ();
+
+  /// \brief Gets the size of the buffer.
+  /// \return The capacity.
+  std::size_t
+  getCapacity () const;
+
+  /// \brief Gets the size of the ranges in use.
+  /// \return The sum of their sizes.
+  std::size_t
+  getUsed () const;
+
+  /// \brief Gets the number of separate free ranges.
+  /// \return The count, which is 1 or less when nothing is fragmented.
+  std::size_t
+  getFreeRangeCount () const;
+
+  /// \brief Gets the size of the biggest free range.
+  /// \return Its size, which is the biggest that allocate can surely give.
+  std::size_t
+  getLargestFree () const;
+
+private:
+
+  /// \brief One range, free or not.
+  struct Range
+  {
+    /// The size.
+    std::size_t size;
+    /// Whether or not it is free.
+    bool free;
+    /// The offset of the free range before it in its list, or NONE.
+    std::size_t previousFree;
+    /// The offset of the free range after it in its list, or NONE.
+    std::size_t nextFree;
+  };
+
+  /// \brief Finds the list a free range of a size goes in.
+  /// \param[in] size The size, which is at least 1.
+  /// \return The list's index.
+  static unsigned int
+  getList (std::size_t size);
+
+  /// \brief Adds a range, which must be free, to the front of its list.
+  /// \param[in] range The range, in m_ranges.
+  void
+  link (std::map<std::size_t, Range>::iterator range);
+
+  /// \brief Removes a free range from its list.
+  /// \param[in] range The range, in m_ranges.
+  void
+  unlink (std::map<std::size_t, Range>::iterator range);
+
+  /// \brief Adds a free range, merging it with the free ranges beside it.
+  /// \param[in] offset The range's offset.
+  /// \param[in] size The range's size.
+  void
+  addFree (std::size_t offset, std::size_t size);
+
+  /// The size of the buffer.
+  std::size_t m_capacity;
+  /// The size of the ranges in use.
+  std::size_t m_used;
+  /// Every range, free or not, by offset, so each has its neighbours beside
+  ///   it.
+  std::map<std::size_t, Range> m_ranges;
+  /// The offset of the first free range in each list, or NONE.
+  std::vector<std::size_t> m_lists;
+  /// Bit i is set if any list of first level i is non-empty.
+  std::uint64_t m_firstLevels;
+  /// Bit j of element i is set if list j of first level i is non-empty.
+  std::vector<std::uint32_t> m_secondLevels;
+};
+
+#endif//BUFFER_ALLOCATOR_HPP
@@ -0,0 +1,760 @@
+/// \file CachingOpenGLContext.cpp
+/// \brief Definitions of CachingOpenGLContext member and associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+
+#include "CachingOpenGLContext.hpp"
+
+CachingOpenGLContext::CachingOpenGLContext (OpenGLContext* context)
+  : m_context (context), m_program { 0, false }, m_unbindProgram (false),
+    m_vertexArray { 0, false }, m_unbindVertexArray (false), m_buffers (),
+    m_activeTexture { 0, false }, m_textures (), m_enabled (),
+    m_cullFace { 0, false }, m_frontFace { 0, false }, m_depthFunc { 0, false },
+    m_framebuffer { 0, false }, m_viewport { 0, 0, 0, 0 },
+    m_viewportKnown (false), m_counts ()
+{
+}
+
+CachingOpenGLContext::~CachingOpenGLContext ()
+{
+}
+
+void
+CachingOpenGLContext::invalidate ()
+{
+  flushUnbinds ();
+  m_program.known = false;
+  m_vertexArray.known = false;
+  m_buffers.clear ();
+  m_bufferBases.clear ();
+  m_activeTexture.known = false;
+  m_textures.clear ();
+  m_enabled.clear ();
+  m_cullFace.known = false;
+  m_frontFace.known = false;
+  m_depthFunc.known = false;
+  m_framebuffer.known = false;
+  m_viewportKnown = false;
+}
+
+ContextCallCounts
+CachingOpenGLContext::getCallCounts (CachedCall call) const
+{
+  return m_counts[call];
+}
+
+void
+CachingOpenGLContext::resetCallCounts ()
+{
+  std::fill (m_counts, m_counts + CACHED_CALL_COUNT, ContextCallCounts { 0, 0 });
+}
+
+const char*
+CachingOpenGLContext::getCallName (CachedCall call)
+{
+  static const char* const NAMES[CACHED_CALL_COUNT] = {
+    "glActiveTexture", "glBindBuffer", "glBindBufferBase",
+    "glBindFramebuffer", "glBindTexture", "glBindVertexArray", "glCullFace",
+    "glDepthFunc", "glEnable", "glFrontFace", "glUseProgram", "glViewport"
+  };
+  return NAMES[call];
+}
+
+void
+CachingOpenGLContext::activeTexture (GLenum texture)
+{
+  if (change (ACTIVE_TEXTURE, m_activeTexture, texture))
+    m_context->activeTexture (texture);
+}
+
+void
+CachingOpenGLContext::attachShader (GLuint program, GLuint shader)
+{
+  m_context->attachShader (program, shader);
+}
+
+void
+CachingOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+  if (target == GL_ELEMENT_ARRAY_BUFFER)
+    flushVertexArray ();
+  if (change (BIND_BUFFER, m_buffers[target], buffer))
+    m_context->bindBuffer (target, buffer);
+}
+
+void
+CachingOpenGLContext::bindBufferBase (GLenum target, GLuint index, GLuint buffer)
+{
+  if (!change (BIND_BUFFER_BASE, m_bufferBases[std::make_pair (target, index)], buffer))
+    return;
+  // This binds the general target too.
+  m_buffers[target] = CachedValue { buffer, true };
+  m_context->bindBufferBase (target, index, buffer);
+}
+
+void
+CachingOpenGLContext::bindFramebuffer (GLenum target, GLuint framebuffer)
+{
+  if (target != GL_FRAMEBUFFER)
+  {
+    // Only one of the read and draw bindings changes.
+    m_framebuffer.known = false;
+    ++m_counts[BIND_FRAMEBUFFER].passed;
+    m_context->bindFramebuffer (target, framebuffer);
+  }
+  else if (change (BIND_FRAMEBUFFER, m_framebuffer, framebuffer))
+    m_context->bindFramebuffer (target, framebuffer);
+}
+
+void
+CachingOpenGLContext::bindTexture (GLenum target, GLuint texture)
+{
+  if (!m_activeTexture.known)
+  {
+    ++m_counts[BIND_TEXTURE].passed;
+    m_context->bindTexture (target, texture);
+    return;
+  }
+  CachedValue& cached = m_textures[std::make_pair (m_activeTexture.value, target)];
+  if (change (BIND_TEXTURE, cached, texture))
+    m_context->bindTexture (target, texture);
+}
+
+void
+CachingOpenGLContext::bindVertexArray (GLuint array)
+{
+  if (array == 0)
+  {
+    if (!m_vertexArray.known || m_vertexArray.value != 0)
+    {
+      if (m_unbindVertexArray)
+        ++m_counts[BIND_VERTEX_ARRAY].elided;
+      m_unbindVertexArray = true;
+    }
+    else
+      ++m_counts[BIND_VERTEX_ARRAY].elided;
+    return;
+  }
+  if (m_unbindVertexArray)
+  {
+    // The put-off unbind is never needed.
+    ++m_counts[BIND_VERTEX_ARRAY].elided;
+    m_unbindVertexArray = false;
+  }
+  if (change (BIND_VERTEX_ARRAY, m_vertexArray, array))
+  {
+    m_buffers.erase (GL_ELEMENT_ARRAY_BUFFER);
+    m_context->bindVertexArray (array);
+  }
+}
+
+void
+CachingOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+  if (target == GL_ELEMENT_ARRAY_BUFFER)
+    flushVertexArray ();
+  m_context->bufferData (target, size, data, usage);
+}
+
+void
+CachingOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  if (target == GL_ELEMENT_ARRAY_BUFFER)
+    flushVertexArray ();
+  m_context->bufferSubData (target, offset, size, data);
+}
+
+GLenum
+CachingOpenGLContext::checkFramebufferStatus (GLenum target)
+{
+  return m_context->checkFramebufferStatus (target);
+}
+
+void
+CachingOpenGLContext::clear (GLbitfield mask)
+{
+  m_context->clear (mask);
+}
+
+void
+CachingOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  m_context->clearColor (red, green, blue, alpha);
+}
+
+GLenum
+CachingOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  return m_context->clientWaitSync (sync, flags, timeout);
+}
+
+void
+CachingOpenGLContext::compileShader (GLuint shader)
+{
+  m_context->compileShader (shader);
+}
+
+void
+CachingOpenGLContext::createBuffers (GLsizei n, GLuint* buffers)
+{
+  m_context->createBuffers (n, buffers);
+}
+
+GLuint
+CachingOpenGLContext::createProgram ()
+{
+  return m_context->createProgram ();
+}
+
+GLuint
+CachingOpenGLContext::createShader (GLenum shaderType)
+{
+  return m_context->createShader (shaderType);
+}
+
+void
+CachingOpenGLContext::createVertexArrays (GLsizei n, GLuint* arrays)
+{
+  m_context->createVertexArrays (n, arrays);
+}
+
+void
+CachingOpenGLContext::cullFace (GLenum mode)
+{
+  if (change (CULL_FACE, m_cullFace, mode))
+    m_context->cullFace (mode);
+}
+
+void
+CachingOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+  // Deleting a buffer unbinds it from the vertex array that is really bound.
+  flushVertexArray ();
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    for (auto& binding : m_buffers)
+      if (binding.second.value == buffers[i])
+        binding.second.value = 0;
+    for (auto& binding : m_bufferBases)
+      if (binding.second.value == buffers[i])
+        binding.second.value = 0;
+  }
+  m_context->deleteBuffers (n, buffers);
+}
+
+void
+CachingOpenGLContext::deleteFramebuffers (GLsizei n, const GLuint* framebuffers)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    if (m_framebuffer.value == framebuffers[i])
+      m_framebuffer.value = 0;
+  m_context->deleteFramebuffers (n, framebuffers);
+}
+
+void
+CachingOpenGLContext::deleteProgram (GLuint program)
+{
+  // A program in use isn't deleted until it is no longer used.
+  flushProgram ();
+  m_context->deleteProgram (program);
+}
+
+void
+CachingOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+  m_context->deleteQueries (n, ids);
+}
+
+void
+CachingOpenGLContext::deleteShader (GLuint shader)
+{
+  m_context->deleteShader (shader);
+}
+
+void
+CachingOpenGLContext::deleteSync (GLsync sync)
+{
+  m_context->deleteSync (sync);
+}
+
+void
+CachingOpenGLContext::deleteTextures (GLsizei n, const GLuint* textures)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    for (auto& binding : m_textures)
+      if (binding.second.value == textures[i])
+        binding.second.value = 0;
+  m_context->deleteTextures (n, textures);
+}
+
+void
+CachingOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+  flushVertexArray ();
+  for (GLsizei i = 0; i < n; ++i)
+    if (m_vertexArray.value == arrays[i])
+    {
+      m_vertexArray.value = 0;
+      m_buffers.erase (GL_ELEMENT_ARRAY_BUFFER);
+    }
+  m_context->deleteVertexArrays (n, arrays);
+}
+
+void
+CachingOpenGLContext::depthFunc (GLenum func)
+{
+  if (change (DEPTH_FUNC, m_depthFunc, func))
+    m_context->depthFunc (func);
+}
+
+void
+CachingOpenGLContext::detachShader (GLuint program, GLuint shader)
+{
+  m_context->detachShader (program, shader);
+}
+
+void
+CachingOpenGLContext::dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+  flushUnbinds ();
+  m_context->dispatchCompute (num_groups_x, num_groups_y, num_groups_z);
+}
+
+void
+CachingOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+  flushUnbinds ();
+  m_context->drawArrays (mode, first, count);
+}
+
+void
+CachingOpenGLContext::drawBuffers (GLsizei n, const GLenum* bufs)
+{
+  m_context->drawBuffers (n, bufs);
+}
+
+void
+CachingOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+  flushUnbinds ();
+  m_context->drawElements (mode, count, type, indices);
+}
+
+void
+CachingOpenGLContext::enable (GLenum cap)
+{
+  if (!m_enabled.insert (cap).second)
+  {
+    ++m_counts[ENABLE].elided;
+    return;
+  }
+  ++m_counts[ENABLE].passed;
+  m_context->enable (cap);
+}
+
+void
+CachingOpenGLContext::enableVertexArrayAttrib (GLuint vaobj, GLuint index)
+{
+  m_context->enableVertexArrayAttrib (vaobj, index);
+}
+
+void
+CachingOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+  flushVertexArray ();
+  m_context->enableVertexAttribArray (index);
+}
+
+GLsync
+CachingOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return m_context->fenceSync (condition, flags);
+}
+
+void
+CachingOpenGLContext::framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+  m_context->framebufferTexture2D (target, attachment, textarget, texture, level);
+}
+
+void
+CachingOpenGLContext::frontFace (GLenum mode)
+{
+  if (change (FRONT_FACE, m_frontFace, mode))
+    m_context->frontFace (mode);
+}
+
+void
+CachingOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
+{
+  m_context->genBuffers (n, buffers);
+}
+
+void
+CachingOpenGLContext::genFramebuffers (GLsizei n, GLuint* framebuffers)
+{
+  m_context->genFramebuffers (n, framebuffers);
+}
+
+void
+CachingOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  m_context->genQueries (n, ids);
+}
+
+void
+CachingOpenGLContext::genTextures (GLsizei n, GLuint* textures)
+{
+  m_context->genTextures (n, textures);
+}
+
+void
+CachingOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
+{
+  m_context->genVertexArrays (n, arrays);
+}
+
+void
+CachingOpenGLContext::getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+  m_context->getActiveUniform (program, index, bufSize, length, size, type, name);
+}
+
+GLint
+CachingOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
+{
+  return m_context->getAttribLocation (program, name);
+}
+
+void
+CachingOpenGLContext::getIntegerv (GLenum pname, GLint* data)
+{
+  // The query may be for a binding.
+  flushUnbinds ();
+  m_context->getIntegerv (pname, data);
+}
+
+void
+CachingOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  m_context->getProgramBinary (program, bufSize, length, binaryFormat, binary);
+}
+
+void
+CachingOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  m_context->getProgramInfoLog (program, maxLength, length, infoLog);
+}
+
+void
+CachingOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+  m_context->getProgramiv (program, pname, params);
+}
+
+void
+CachingOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  m_context->getQueryObjectiv (id, pname, params);
+}
+
+void
+CachingOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  m_context->getQueryObjectui64v (id, pname, params);
+}
+
+void
+CachingOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  m_context->getShaderInfoLog (shader, maxLength, length, infoLog);
+}
+
+void
+CachingOpenGLContext::getShaderiv (GLuint shader, GLenum pname, GLint* params)
+{
+  m_context->getShaderiv (shader, pname, params);
+}
+
+const GLubyte*
+CachingOpenGLContext::getString (GLenum name)
+{
+  return m_context->getString (name);
+}
+
+GLuint
+CachingOpenGLContext::getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName)
+{
+  return m_context->getUniformBlockIndex (program, uniformBlockName);
+}
+
+GLint
+CachingOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
+{
+  return m_context->getUniformLocation (program, name);
+}
+
+void
+CachingOpenGLContext::linkProgram (GLuint program)
+{
+  m_context->linkProgram (program);
+}
+
+void*
+CachingOpenGLContext::mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+  return m_context->mapNamedBufferRange (buffer, offset, length, access);
+}
+
+void
+CachingOpenGLContext::maxShaderCompilerThreadsKHR (GLuint count)
+{
+  m_context->maxShaderCompilerThreadsKHR (count);
+}
+
+void
+CachingOpenGLContext::memoryBarrier (GLbitfield barriers)
+{
+  m_context->memoryBarrier (barriers);
+}
+
+void
+CachingOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  flushUnbinds ();
+  m_context->multiDrawElementsIndirect (mode, type, indirect, drawcount, stride);
+}
+
+void
+CachingOpenGLContext::multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+  flushUnbinds ();
+  m_context->multiDrawElementsIndirectCount (mode, type, indirect, drawcount, maxdrawcount, stride);
+}
+
+void
+CachingOpenGLContext::namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+  m_context->namedBufferData (buffer, size, data, usage);
+}
+
+void
+CachingOpenGLContext::namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+  m_context->namedBufferStorage (buffer, size, data, flags);
+}
+
+void
+CachingOpenGLContext::namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+  m_context->namedBufferSubData (buffer, offset, size, data);
+}
+
+void
+CachingOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+  m_context->programBinary (program, binaryFormat, binary, length);
+}
+
+void
+CachingOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+  m_context->programParameteri (program, pname, value);
+}
+
+void
+CachingOpenGLContext::queryCounter (GLuint id, GLenum target)
+{
+  m_context->queryCounter (id, target);
+}
+
+void
+CachingOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{
+  m_context->shaderSource (shader, count, string, length);
+}
+
+void
+CachingOpenGLContext::texBuffer (GLenum target, GLenum internalformat, GLuint buffer)
+{
+  m_context->texBuffer (target, internalformat, buffer);
+}
+
+void
+CachingOpenGLContext::texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data)
+{
+  m_context->texImage2D (target, level, internalformat, width, height, border, format, type, data);
+}
+
+void
+CachingOpenGLContext::texParameteri (GLenum target, GLenum pname, GLint param)
+{
+  m_context->texParameteri (target, pname, param);
+}
+
+void
+CachingOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  flushProgram ();
+  m_context->uniform1f (location, v0);
+}
+
+void
+CachingOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  flushProgram ();
+  m_context->uniform1i (location, v0);
+}
+
+void
+CachingOpenGLContext::uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+  flushProgram ();
+  m_context->uniform3f (location, v0, v1, v2);
+}
+
+void
+CachingOpenGLContext::uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+  m_context->uniformBlockBinding (program, uniformBlockIndex, uniformBlockBinding);
+}
+
+void
+CachingOpenGLContext::uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  flushProgram ();
+  m_context->uniformMatrix3fv (location, count, transpose, value);
+}
+
+void
+CachingOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  flushProgram ();
+  m_context->uniformMatrix4fv (location, count, transpose, value);
+}
+
+GLboolean
+CachingOpenGLContext::unmapNamedBuffer (GLuint buffer)
+{
+  return m_context->unmapNamedBuffer (buffer);
+}
+
+void
+CachingOpenGLContext::useProgram (GLuint program)
+{
+  if (program == 0)
+  {
+    if (!m_program.known || m_program.value != 0)
+    {
+      if (m_unbindProgram)
+        ++m_counts[USE_PROGRAM].elided;
+      m_unbindProgram = true;
+    }
+    else
+      ++m_counts[USE_PROGRAM].elided;
+    return;
+  }
+  if (m_unbindProgram)
+  {
+    // The put-off unbind is never needed.
+    ++m_counts[USE_PROGRAM].elided;
+    m_unbindProgram = false;
+  }
+  if (change (USE_PROGRAM, m_program, program))
+    m_context->useProgram (program);
+}
+
+void
+CachingOpenGLContext::vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+  m_context->vertexArrayAttribBinding (vaobj, attribindex, bindingindex);
+}
+
+void
+CachingOpenGLContext::vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+  m_context->vertexArrayAttribFormat (vaobj, attribindex, size, type, normalized, relativeoffset);
+}
+
+void
+CachingOpenGLContext::vertexArrayElementBuffer (GLuint vaobj, GLuint buffer)
+{
+  // This is the element buffer binding whenever vaobj is the array bound.
+  if (!m_vertexArray.known || m_vertexArray.value == vaobj)
+    m_buffers.erase (GL_ELEMENT_ARRAY_BUFFER);
+  m_context->vertexArrayElementBuffer (vaobj, buffer);
+}
+
+void
+CachingOpenGLContext::vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+{
+  m_context->vertexArrayVertexBuffer (vaobj, bindingindex, buffer, offset, stride);
+}
+
+void
+CachingOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+  flushVertexArray ();
+  m_context->vertexAttribPointer (index, size, type, normalized, stride, pointer);
+}
+
+void
+CachingOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  const GLint viewport[4] = { x, y, width, height };
+  if (m_viewportKnown && std::equal (viewport, viewport + 4, m_viewport))
+  {
+    ++m_counts[VIEWPORT].elided;
+    return;
+  }
+  ++m_counts[VIEWPORT].passed;
+  std::copy (viewport, viewport + 4, m_viewport);
+  m_viewportKnown = true;
+  m_context->viewport (x, y, width, height);
+}
+
+bool
+CachingOpenGLContext::change (CachedCall call, CachedValue& cached, GLuint value)
+{
+  if (cached.known && cached.value == value)
+  {
+    ++m_counts[call].elided;
+    return false;
+  }
+  ++m_counts[call].passed;
+  cached = CachedValue { value, true };
+  return true;
+}
+
+void
+CachingOpenGLContext::flushProgram ()
+{
+  if (!m_unbindProgram)
+    return;
+  m_unbindProgram = false;
+  if (change (USE_PROGRAM, m_program, 0))
+    m_context->useProgram (0);
+}
+
+void
+CachingOpenGLContext::flushVertexArray ()
+{
+  if (!m_unbindVertexArray)
+    return;
+  m_unbindVertexArray = false;
+  if (change (BIND_VERTEX_ARRAY, m_vertexArray, 0))
+  {
+    m_buffers.erase (GL_ELEMENT_ARRAY_BUFFER);
+    m_context->bindVertexArray (0);
+  }
+}
+
+void
+CachingOpenGLContext::flushUnbinds ()
+{
+  flushProgram ();
+  flushVertexArray ();
+}
@@ -0,0 +1,445 @@
+/// \file CachingOpenGLContext.hpp
+/// \brief Declaration of CachingOpenGLContext and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef CACHING_OPENGL_CONTEXT_HPP
+#define CACHING_OPENGL_CONTEXT_HPP
+
+#include <map>
+#include <set>
+#include <utility>
+
+#include "OpenGLContext.hpp"
+
+/// \brief How many calls of one kind a CachingOpenGLContext has passed on
+///   and how many it dropped because they would have changed nothing.
+struct ContextCallCounts
+{
+  /// The number of calls passed on to the wrapped context.
+  unsigned long passed;
+  /// The number of calls dropped.
+  unsigned long elided;
+};
+
+/// \brief A subclass of OpenGLContext that remembers the state set through
+///   it and drops calls that would set it to what it already is, passing
+///   every other call to another OpenGLContext.
+///
+/// It tracks the program in use, the vertex array, the buffer bound to each
+///   target and to each indexed binding point, the texture bound to each unit and target, the active texture
+///   unit, the enabled capabilities, the cull face, front face, depth
+///   function, framebuffer, and viewport.  State it hasn't seen set is
+///   unknown, so the first call always passes.
+///
+/// Unbinding the program or vertex array is also put off until something
+///   could notice (a draw, a uniform, a vertex attribute, a query, ...), so
+///   the common "enable, draw, disable, enable the same one again" costs a
+///   single bind.
+///
+/// Every OpenGL call must go through this context once it is in use, or
+///   invalidate () must be called after, since otherwise its idea of the
+///   state may be wrong.
+class CachingOpenGLContext : public OpenGLContext
+{
+public:
+
+  /// \brief The kinds of call that can be dropped, named after their
+  ///   OpenGL functions.
+  enum CachedCall
+  {
+    ACTIVE_TEXTURE,
+    BIND_BUFFER,
+    BIND_BUFFER_BASE,
+    BIND_FRAMEBUFFER,
+    BIND_TEXTURE,
+    BIND_VERTEX_ARRAY,
+    CULL_FACE,
+    DEPTH_FUNC,
+    ENABLE,
+    FRONT_FACE,
+    USE_PROGRAM,
+    VIEWPORT,
+    /// The number of kinds, not a kind.
+    CACHED_CALL_COUNT
+  };
+
+  /// \brief Constructs a CachingOpenGLContext with all state unknown.
+  /// \param[in] context The context to pass calls on to, which must outlive
+  ///   this one.
+  explicit
+  CachingOpenGLContext (OpenGLContext* context);
+
+  /// Destructs a CachingOpenGLContext.
+  virtual
+  ~CachingOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   CachingOpenGLContexts.
+  CachingOpenGLContext (const CachingOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   CachingOpenGLContexts.
+  CachingOpenGLContext&
+  operator= (const CachingOpenGLContext&) = delete;
+
+  /// \brief Forgets all state, for use after OpenGL calls that didn't go
+  ///   through this context.
+  /// \post Any put-off unbinds have been made, and the next call of every
+  ///   kind will pass.
+  void
+  invalidate ();
+
+  /// \brief Gets how many calls of one kind were passed and dropped.
+  /// \param[in] call The kind of call.
+  /// \return The counts since construction or the last resetCallCounts ().
+  ///   A put-off unbind is counted once it is made or dropped.
+  ContextCallCounts
+  getCallCounts (CachedCall call) const;
+
+  /// \brief Sets every count back to zero, e.g., once per frame.
+  void
+  resetCallCounts ();
+
+  /// \brief Gets the name of a kind of call, for reports.
+  /// \param[in] call The kind of call.
+  /// \return The name of its OpenGL function (e.g., "glUseProgram").
+  static const char*
+  getCallName (CachedCall call);
+
+  virtual void
+  activeTexture (GLenum texture);
+
+  virtual void
+  attachShader (GLuint program, GLuint shader);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindBufferBase (GLenum target, GLuint index, GLuint buffer);
+
+  virtual void
+  bindFramebuffer (GLenum target, GLuint framebuffer);
+
+  virtual void
+  bindTexture (GLenum target, GLuint texture);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual GLenum
+  checkFramebufferStatus (GLenum target);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+  virtual void
+  compileShader (GLuint shader);
+
+  virtual void
+  createBuffers (GLsizei n, GLuint* buffers);
+
+  virtual GLuint
+  createProgram ();
+
+  virtual GLuint
+  createShader (GLenum shaderType);
+
+  virtual void
+  createVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteFramebuffers (GLsizei n, const GLuint* framebuffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
+  virtual void
+  deleteShader (GLuint shader);
+
+  virtual void
+  deleteSync (GLsync sync);
+
+  virtual void
+  deleteTextures (GLsizei n, const GLuint* textures);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  depthFunc (GLenum func);
+
+  virtual void
+  detachShader (GLuint program, GLuint shader);
+
+  virtual void
+  dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawBuffers (GLsizei n, const GLenum* bufs);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexArrayAttrib (GLuint vaobj, GLuint index);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual void
+  genBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  genFramebuffers (GLsizei n, GLuint* framebuffers);
+
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
+  virtual void
+  genTextures (GLsizei n, GLuint* textures);
+
+  virtual void
+  genVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+
+  virtual GLint
+  getAttribLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  getIntegerv (GLenum pname, GLint* data);
+
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
+  virtual void
+  getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getProgramiv (GLuint program, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
+  virtual void
+  getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getShaderiv (GLuint shader, GLenum pname, GLint* params);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual GLuint
+  getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName);
+
+  virtual GLint
+  getUniformLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void*
+  mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+  virtual void
+  maxShaderCompilerThreadsKHR (GLuint count);
+
+  virtual void
+  memoryBarrier (GLbitfield barriers);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+  virtual void
+  namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+
+  virtual void
+  namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+
+  virtual void
+  namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
+  virtual void
+  queryCounter (GLuint id, GLenum target);
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+
+  virtual void
+  texBuffer (GLenum target, GLenum internalformat, GLuint buffer);
+
+  virtual void
+  texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data);
+
+  virtual void
+  texParameteri (GLenum target, GLenum pname, GLint param);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+
+  virtual void
+  uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+
+  virtual void
+  uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual GLboolean
+  unmapNamedBuffer (GLuint buffer);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+
+  virtual void
+  vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+
+  virtual void
+  vertexArrayElementBuffer (GLuint vaobj, GLuint buffer);
+
+  virtual void
+  vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+
+  /// \brief A piece of state that has or hasn't been set through this
+  ///   context.
+  struct CachedValue
+  {
+    /// The value it was set to.
+    GLuint value;
+    /// Whether or not value is right.
+    bool known;
+  };
+
+  /// \brief Records a call that sets one piece of state, and decides
+  ///   whether it has to be made.
+  /// \param[in] call The kind of call, to count.
+  /// \param[in,out] cached The state.
+  /// \param[in] value The value the call sets.
+  /// \return Whether or not the call changes the state.
+  bool
+  change (CachedCall call, CachedValue& cached, GLuint value);
+
+  /// \brief Makes a put-off useProgram (0), if there is one.
+  void
+  flushProgram ();
+
+  /// \brief Makes a put-off bindVertexArray (0), if there is one.
+  void
+  flushVertexArray ();
+
+  /// \brief Makes both kinds of put-off unbind.
+  void
+  flushUnbinds ();
+
+  /// The context calls are passed on to.
+  OpenGLContext* m_context;
+  /// The program in use.
+  CachedValue m_program;
+  /// Whether or not the program should be 0, but hasn't been set to it yet.
+  bool m_unbindProgram;
+  /// The vertex array bound.
+  CachedValue m_vertexArray;
+  /// Whether or not the vertex array should be 0, but hasn't been set to it
+  ///   yet.
+  bool m_unbindVertexArray;
+  /// The buffers bound, by target.  GL_ELEMENT_ARRAY_BUFFER is forgotten
+  ///   whenever the vertex array changes, since it belongs to the array.
+  std::map<GLenum, CachedValue> m_buffers;
+  /// The buffers bound, by target and binding point index.  A dropped
+  ///   bindBufferBase leaves the general target as it was, which nothing
+  ///   that binds buffers to indices looks at.
+  std::map<std::pair<GLenum, GLuint>, CachedValue> m_bufferBases;
+  /// The active texture unit.
+  CachedValue m_activeTexture;
+  /// The textures bound, by texture unit and target.
+  std::map<std::pair<GLenum, GLenum>, CachedValue> m_textures;
+  /// The capabilities that are known to be enabled.
+  std::set<GLenum> m_enabled;
+  /// The cull face mode.
+  CachedValue m_cullFace;
+  /// The front face mode.
+  CachedValue m_frontFace;
+  /// The depth function.
+  CachedValue m_depthFunc;
+  /// The framebuffer bound to GL_FRAMEBUFFER.
+  CachedValue m_framebuffer;
+  /// The viewport.
+  GLint m_viewport[4];
+  /// Whether or not m_viewport is right.
+  bool m_viewportKnown;
+  /// The counts of each CachedCall.
+  ContextCallCounts m_counts[CACHED_CALL_COUNT];
+};
+
+#endif//CACHING_OPENGL_CONTEXT_HPP
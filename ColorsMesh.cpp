@@ -25,8 +25,8 @@ ColorsMesh::enableAttributes ()
     
     const GLint COLOR_ATTRIB_INDEX = 1;
     
-    m_context->enableVertexAttribArray (COLOR_ATTRIB_INDEX);
-    m_context->vertexAttribPointer (COLOR_ATTRIB_INDEX, 3, GL_FLOAT, GL_FALSE,
-            (6 * sizeof(float)), reinterpret_cast<void*> (3 * sizeof(float)));
-    m_context->bindVertexArray (0);
+    m_context->enableVertexArrayAttrib (m_vao, COLOR_ATTRIB_INDEX);
+    m_context->vertexArrayAttribFormat (m_vao, COLOR_ATTRIB_INDEX, 3, GL_FLOAT, GL_FALSE,
+            3 * sizeof(float));
+    m_context->vertexArrayAttribBinding (m_vao, COLOR_ATTRIB_INDEX, 0);
 }
\ No newline at end of file
@@ -0,0 +1,698 @@
+/// \file DirectStateOpenGLContext.cpp
+/// \brief Definitions of DirectStateOpenGLContext member and associated
+///   global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include "DirectStateOpenGLContext.hpp"
+
+const GLuint DirectStateOpenGLContext::MAX_VERTEX_ATTRIBS;
+
+DirectStateOpenGLContext::DirectStateOpenGLContext (OpenGLContext* context, bool native)
+  : m_context (context), m_native (native), m_vertexArray (0), m_arrayBuffer (0),
+    m_layouts ()
+{
+}
+
+DirectStateOpenGLContext::~DirectStateOpenGLContext ()
+{
+}
+
+void
+DirectStateOpenGLContext::setNative (bool native)
+{
+  m_native = native;
+}
+
+bool
+DirectStateOpenGLContext::isNative () const
+{
+  return m_native;
+}
+
+void
+DirectStateOpenGLContext::activeTexture (GLenum texture)
+{
+  m_context->activeTexture (texture);
+}
+
+void
+DirectStateOpenGLContext::attachShader (GLuint program, GLuint shader)
+{
+  m_context->attachShader (program, shader);
+}
+
+void
+DirectStateOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+  if (target == GL_ARRAY_BUFFER)
+    m_arrayBuffer = buffer;
+  m_context->bindBuffer (target, buffer);
+}
+
+void
+DirectStateOpenGLContext::bindBufferBase (GLenum target, GLuint index, GLuint buffer)
+{
+  m_context->bindBufferBase (target, index, buffer);
+}
+
+void
+DirectStateOpenGLContext::bindFramebuffer (GLenum target, GLuint framebuffer)
+{
+  m_context->bindFramebuffer (target, framebuffer);
+}
+
+void
+DirectStateOpenGLContext::bindTexture (GLenum target, GLuint texture)
+{
+  m_context->bindTexture (target, texture);
+}
+
+void
+DirectStateOpenGLContext::bindVertexArray (GLuint array)
+{
+  m_vertexArray = array;
+  m_context->bindVertexArray (array);
+}
+
+void
+DirectStateOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+  m_context->bufferData (target, size, data, usage);
+}
+
+void
+DirectStateOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  m_context->bufferSubData (target, offset, size, data);
+}
+
+GLenum
+DirectStateOpenGLContext::checkFramebufferStatus (GLenum target)
+{
+  return m_context->checkFramebufferStatus (target);
+}
+
+void
+DirectStateOpenGLContext::clear (GLbitfield mask)
+{
+  m_context->clear (mask);
+}
+
+void
+DirectStateOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  m_context->clearColor (red, green, blue, alpha);
+}
+
+GLenum
+DirectStateOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  return m_context->clientWaitSync (sync, flags, timeout);
+}
+
+void
+DirectStateOpenGLContext::compileShader (GLuint shader)
+{
+  m_context->compileShader (shader);
+}
+
+void
+DirectStateOpenGLContext::createBuffers (GLsizei n, GLuint* buffers)
+{
+  if (m_native)
+    m_context->createBuffers (n, buffers);
+  else
+    m_context->genBuffers (n, buffers);
+}
+
+GLuint
+DirectStateOpenGLContext::createProgram ()
+{
+  return m_context->createProgram ();
+}
+
+GLuint
+DirectStateOpenGLContext::createShader (GLenum shaderType)
+{
+  return m_context->createShader (shaderType);
+}
+
+void
+DirectStateOpenGLContext::createVertexArrays (GLsizei n, GLuint* arrays)
+{
+  if (m_native)
+  {
+    m_context->createVertexArrays (n, arrays);
+    return;
+  }
+  m_context->genVertexArrays (n, arrays);
+  for (GLsizei i = 0; i < n; ++i)
+    m_layouts[arrays[i]] = VertexArrayLayout ();
+}
+
+void
+DirectStateOpenGLContext::cullFace (GLenum mode)
+{
+  m_context->cullFace (mode);
+}
+
+void
+DirectStateOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    if (m_arrayBuffer == buffers[i])
+      m_arrayBuffer = 0;
+  m_context->deleteBuffers (n, buffers);
+}
+
+void
+DirectStateOpenGLContext::deleteFramebuffers (GLsizei n, const GLuint* framebuffers)
+{
+  m_context->deleteFramebuffers (n, framebuffers);
+}
+
+void
+DirectStateOpenGLContext::deleteProgram (GLuint program)
+{
+  m_context->deleteProgram (program);
+}
+
+void
+DirectStateOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+  m_context->deleteQueries (n, ids);
+}
+
+void
+DirectStateOpenGLContext::deleteShader (GLuint shader)
+{
+  m_context->deleteShader (shader);
+}
+
+void
+DirectStateOpenGLContext::deleteSync (GLsync sync)
+{
+  m_context->deleteSync (sync);
+}
+
+void
+DirectStateOpenGLContext::deleteTextures (GLsizei n, const GLuint* textures)
+{
+  m_context->deleteTextures (n, textures);
+}
+
+void
+DirectStateOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    if (m_vertexArray == arrays[i])
+      m_vertexArray = 0;
+    m_layouts.erase (arrays[i]);
+  }
+  m_context->deleteVertexArrays (n, arrays);
+}
+
+void
+DirectStateOpenGLContext::depthFunc (GLenum func)
+{
+  m_context->depthFunc (func);
+}
+
+void
+DirectStateOpenGLContext::detachShader (GLuint program, GLuint shader)
+{
+  m_context->detachShader (program, shader);
+}
+
+void
+DirectStateOpenGLContext::dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+  m_context->dispatchCompute (num_groups_x, num_groups_y, num_groups_z);
+}
+
+void
+DirectStateOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+  m_context->drawArrays (mode, first, count);
+}
+
+void
+DirectStateOpenGLContext::drawBuffers (GLsizei n, const GLenum* bufs)
+{
+  m_context->drawBuffers (n, bufs);
+}
+
+void
+DirectStateOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+  m_context->drawElements (mode, count, type, indices);
+}
+
+void
+DirectStateOpenGLContext::enable (GLenum cap)
+{
+  m_context->enable (cap);
+}
+
+void
+DirectStateOpenGLContext::enableVertexArrayAttrib (GLuint vaobj, GLuint index)
+{
+  if (m_native)
+  {
+    m_context->enableVertexArrayAttrib (vaobj, index);
+    return;
+  }
+  beginEdit (vaobj);
+  m_context->enableVertexAttribArray (index);
+  endEdit (vaobj);
+}
+
+void
+DirectStateOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+  m_context->enableVertexAttribArray (index);
+}
+
+GLsync
+DirectStateOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return m_context->fenceSync (condition, flags);
+}
+
+void
+DirectStateOpenGLContext::framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+  m_context->framebufferTexture2D (target, attachment, textarget, texture, level);
+}
+
+void
+DirectStateOpenGLContext::frontFace (GLenum mode)
+{
+  m_context->frontFace (mode);
+}
+
+void
+DirectStateOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
+{
+  m_context->genBuffers (n, buffers);
+}
+
+void
+DirectStateOpenGLContext::genFramebuffers (GLsizei n, GLuint* framebuffers)
+{
+  m_context->genFramebuffers (n, framebuffers);
+}
+
+void
+DirectStateOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  m_context->genQueries (n, ids);
+}
+
+void
+DirectStateOpenGLContext::genTextures (GLsizei n, GLuint* textures)
+{
+  m_context->genTextures (n, textures);
+}
+
+void
+DirectStateOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
+{
+  m_context->genVertexArrays (n, arrays);
+}
+
+void
+DirectStateOpenGLContext::getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+  m_context->getActiveUniform (program, index, bufSize, length, size, type, name);
+}
+
+GLint
+DirectStateOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
+{
+  return m_context->getAttribLocation (program, name);
+}
+
+void
+DirectStateOpenGLContext::getIntegerv (GLenum pname, GLint* data)
+{
+  m_context->getIntegerv (pname, data);
+}
+
+void
+DirectStateOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  m_context->getProgramBinary (program, bufSize, length, binaryFormat, binary);
+}
+
+void
+DirectStateOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  m_context->getProgramInfoLog (program, maxLength, length, infoLog);
+}
+
+void
+DirectStateOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+  m_context->getProgramiv (program, pname, params);
+}
+
+void
+DirectStateOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  m_context->getQueryObjectiv (id, pname, params);
+}
+
+void
+DirectStateOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  m_context->getQueryObjectui64v (id, pname, params);
+}
+
+void
+DirectStateOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  m_context->getShaderInfoLog (shader, maxLength, length, infoLog);
+}
+
+void
+DirectStateOpenGLContext::getShaderiv (GLuint shader, GLenum pname, GLint* params)
+{
+  m_context->getShaderiv (shader, pname, params);
+}
+
+const GLubyte*
+DirectStateOpenGLContext::getString (GLenum name)
+{
+  return m_context->getString (name);
+}
+
+GLuint
+DirectStateOpenGLContext::getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName)
+{
+  return m_context->getUniformBlockIndex (program, uniformBlockName);
+}
+
+GLint
+DirectStateOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
+{
+  return m_context->getUniformLocation (program, name);
+}
+
+void
+DirectStateOpenGLContext::linkProgram (GLuint program)
+{
+  m_context->linkProgram (program);
+}
+
+void*
+DirectStateOpenGLContext::mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+  return m_native ? m_context->mapNamedBufferRange (buffer, offset, length, access) : nullptr;
+}
+
+void
+DirectStateOpenGLContext::maxShaderCompilerThreadsKHR (GLuint count)
+{
+  m_context->maxShaderCompilerThreadsKHR (count);
+}
+
+void
+DirectStateOpenGLContext::memoryBarrier (GLbitfield barriers)
+{
+  m_context->memoryBarrier (barriers);
+}
+
+void
+DirectStateOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  m_context->multiDrawElementsIndirect (mode, type, indirect, drawcount, stride);
+}
+
+void
+DirectStateOpenGLContext::multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+  m_context->multiDrawElementsIndirectCount (mode, type, indirect, drawcount, maxdrawcount, stride);
+}
+
+void
+DirectStateOpenGLContext::namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+  if (m_native)
+  {
+    m_context->namedBufferData (buffer, size, data, usage);
+    return;
+  }
+  m_context->bindBuffer (GL_COPY_WRITE_BUFFER, buffer);
+  m_context->bufferData (GL_COPY_WRITE_BUFFER, size, data, usage);
+}
+
+void
+DirectStateOpenGLContext::namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+  if (m_native)
+  {
+    m_context->namedBufferStorage (buffer, size, data, flags);
+    return;
+  }
+  // Mutable storage can do anything immutable storage can; the flags only
+  //   hint at how it will be used.
+  GLenum usage = (flags & GL_DYNAMIC_STORAGE_BIT) ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW;
+  m_context->bindBuffer (GL_COPY_WRITE_BUFFER, buffer);
+  m_context->bufferData (GL_COPY_WRITE_BUFFER, size, data, usage);
+}
+
+void
+DirectStateOpenGLContext::namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+  if (m_native)
+  {
+    m_context->namedBufferSubData (buffer, offset, size, data);
+    return;
+  }
+  m_context->bindBuffer (GL_COPY_WRITE_BUFFER, buffer);
+  m_context->bufferSubData (GL_COPY_WRITE_BUFFER, offset, size, data);
+}
+
+void
+DirectStateOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+  m_context->programBinary (program, binaryFormat, binary, length);
+}
+
+void
+DirectStateOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+  m_context->programParameteri (program, pname, value);
+}
+
+void
+DirectStateOpenGLContext::queryCounter (GLuint id, GLenum target)
+{
+  m_context->queryCounter (id, target);
+}
+
+void
+DirectStateOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{
+  m_context->shaderSource (shader, count, string, length);
+}
+
+void
+DirectStateOpenGLContext::texBuffer (GLenum target, GLenum internalformat, GLuint buffer)
+{
+  m_context->texBuffer (target, internalformat, buffer);
+}
+
+void
+DirectStateOpenGLContext::texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data)
+{
+  m_context->texImage2D (target, level, internalformat, width, height, border, format, type, data);
+}
+
+void
+DirectStateOpenGLContext::texParameteri (GLenum target, GLenum pname, GLint param)
+{
+  m_context->texParameteri (target, pname, param);
+}
+
+void
+DirectStateOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  m_context->uniform1f (location, v0);
+}
+
+void
+DirectStateOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  m_context->uniform1i (location, v0);
+}
+
+void
+DirectStateOpenGLContext::uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+  m_context->uniform3f (location, v0, v1, v2);
+}
+
+void
+DirectStateOpenGLContext::uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+  m_context->uniformBlockBinding (program, uniformBlockIndex, uniformBlockBinding);
+}
+
+void
+DirectStateOpenGLContext::uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  m_context->uniformMatrix3fv (location, count, transpose, value);
+}
+
+void
+DirectStateOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  m_context->uniformMatrix4fv (location, count, transpose, value);
+}
+
+GLboolean
+DirectStateOpenGLContext::unmapNamedBuffer (GLuint buffer)
+{
+  return m_native ? m_context->unmapNamedBuffer (buffer) : GL_FALSE;
+}
+
+void
+DirectStateOpenGLContext::useProgram (GLuint program)
+{
+  m_context->useProgram (program);
+}
+
+void
+DirectStateOpenGLContext::vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+  if (m_native)
+  {
+    m_context->vertexArrayAttribBinding (vaobj, attribindex, bindingindex);
+    return;
+  }
+  if (attribindex >= MAX_VERTEX_ATTRIBS || bindingindex >= MAX_VERTEX_ATTRIBS)
+    return;
+  m_layouts[vaobj].attribs[attribindex].binding = bindingindex;
+  beginEdit (vaobj);
+  applyAttrib (m_layouts[vaobj], attribindex);
+  endEdit (vaobj);
+}
+
+void
+DirectStateOpenGLContext::vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+  if (m_native)
+  {
+    m_context->vertexArrayAttribFormat (vaobj, attribindex, size, type, normalized, relativeoffset);
+    return;
+  }
+  if (attribindex >= MAX_VERTEX_ATTRIBS)
+    return;
+  VertexArrayLayout& layout = m_layouts[vaobj];
+  AttribFormat& attrib = layout.attribs[attribindex];
+  attrib.size = size;
+  attrib.type = type;
+  attrib.normalized = normalized;
+  attrib.relativeOffset = relativeoffset;
+  attrib.specified = true;
+  beginEdit (vaobj);
+  applyAttrib (layout, attribindex);
+  endEdit (vaobj);
+}
+
+void
+DirectStateOpenGLContext::vertexArrayElementBuffer (GLuint vaobj, GLuint buffer)
+{
+  if (m_native)
+  {
+    m_context->vertexArrayElementBuffer (vaobj, buffer);
+    return;
+  }
+  // The element array buffer binding belongs to the vertex array, so
+  //   binding the array back restores the one that was there.
+  beginEdit (vaobj);
+  m_context->bindBuffer (GL_ELEMENT_ARRAY_BUFFER, buffer);
+  endEdit (vaobj);
+}
+
+void
+DirectStateOpenGLContext::vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+{
+  if (m_native)
+  {
+    m_context->vertexArrayVertexBuffer (vaobj, bindingindex, buffer, offset, stride);
+    return;
+  }
+  if (bindingindex >= MAX_VERTEX_ATTRIBS)
+    return;
+  VertexArrayLayout& layout = m_layouts[vaobj];
+  layout.bindings[bindingindex] = VertexBinding { buffer, offset, stride };
+  beginEdit (vaobj);
+  for (GLuint index = 0; index < MAX_VERTEX_ATTRIBS; ++index)
+    if (layout.attribs[index].binding == bindingindex)
+      applyAttrib (layout, index);
+  endEdit (vaobj);
+}
+
+void
+DirectStateOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+  m_context->vertexAttribPointer (index, size, type, normalized, stride, pointer);
+}
+
+void
+DirectStateOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  m_context->viewport (x, y, width, height);
+}
+
+DirectStateOpenGLContext::AttribFormat::AttribFormat ()
+  : specified (false), size (4), type (GL_FLOAT), normalized (GL_FALSE),
+    relativeOffset (0), binding (0)
+{
+}
+
+DirectStateOpenGLContext::VertexArrayLayout::VertexArrayLayout ()
+  : attribs (), bindings ()
+{
+  for (GLuint index = 0; index < MAX_VERTEX_ATTRIBS; ++index)
+  {
+    attribs[index].binding = index;
+    bindings[index] = VertexBinding { 0, 0, 0 };
+  }
+}
+
+void
+DirectStateOpenGLContext::beginEdit (GLuint vaobj)
+{
+  if (vaobj != m_vertexArray)
+    m_context->bindVertexArray (vaobj);
+}
+
+void
+DirectStateOpenGLContext::endEdit (GLuint vaobj)
+{
+  if (vaobj != m_vertexArray)
+    m_context->bindVertexArray (m_vertexArray);
+}
+
+void
+DirectStateOpenGLContext::applyAttrib (const VertexArrayLayout& layout, GLuint index)
+{
+  const AttribFormat& attrib = layout.attribs[index];
+  const VertexBinding& binding = layout.bindings[attrib.binding];
+  // Until both halves are known there is nothing to point the attribute at.
+  if (!attrib.specified || binding.buffer == 0)
+    return;
+  if (binding.buffer != m_arrayBuffer)
+    m_context->bindBuffer (GL_ARRAY_BUFFER, binding.buffer);
+  GLintptr offset = binding.offset + attrib.relativeOffset;
+  m_context->vertexAttribPointer (index, attrib.size, attrib.type, attrib.normalized,
+                                  binding.stride, reinterpret_cast<const GLvoid*> (offset));
+  if (binding.buffer != m_arrayBuffer)
+    m_context->bindBuffer (GL_ARRAY_BUFFER, m_arrayBuffer);
+}
@@ -0,0 +1,417 @@
+/// \file DirectStateOpenGLContext.hpp
+/// \brief Declaration of DirectStateOpenGLContext and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef DIRECT_STATE_OPENGL_CONTEXT_HPP
+#define DIRECT_STATE_OPENGL_CONTEXT_HPP
+
+#include <map>
+
+#include "OpenGLContext.hpp"
+
+/// \brief A subclass of OpenGLContext that makes the direct state access
+///   calls (createBuffers, namedBufferStorage, vertexArrayVertexBuffer,
+///   vertexArrayAttribFormat, ...) work whether or not the driver has them,
+///   passing every call on to another OpenGLContext.
+///
+/// With OpenGL 4.5 or ARB_direct_state_access they are passed on as they
+///   are, so editing a buffer or vertex array binds nothing.  Without, each
+///   is emulated with the calls that bind to edit:
+///   - create* gen the names instead;
+///   - buffer uploads go through GL_COPY_WRITE_BUFFER, which the engine
+///     binds nothing else to, and immutable storage becomes mutable storage
+///     (which is why mapNamedBufferRange returns null);
+///   - vertex array edits bind the array, and then bind back the one that
+///     was bound.  Each array's attribute formats and buffer bindings are
+///     kept here, so that once an attribute has both it can be pointed at
+///     its buffer with vertexAttribPointer (binding the buffer to
+///     GL_ARRAY_BUFFER, and then back).
+///   Either way the bindings the rest of the engine sees are unchanged.
+///
+/// Every vertex array call must go through this context for it to know the
+///   bindings to restore, and an array edited by direct state access should
+///   not also be set up with vertexAttribPointer, since the two would not
+///   know about each other without a driver that has both.
+class DirectStateOpenGLContext : public OpenGLContext
+{
+public:
+
+  /// The number of vertex attributes, and buffer bindings, emulated per
+  ///   vertex array: the fewest OpenGL allows.
+  static const GLuint MAX_VERTEX_ATTRIBS = 16;
+
+  /// \brief Constructs a DirectStateOpenGLContext.
+  /// \param[in] context The context to pass calls on to, which must outlive
+  ///   this one.
+  /// \param[in] native Whether or not context has the direct state access
+  ///   calls.
+  explicit
+  DirectStateOpenGLContext (OpenGLContext* context, bool native = false);
+
+  /// Destructs a DirectStateOpenGLContext.
+  virtual
+  ~DirectStateOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   DirectStateOpenGLContexts.
+  DirectStateOpenGLContext (const DirectStateOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   DirectStateOpenGLContexts.
+  DirectStateOpenGLContext&
+  operator= (const DirectStateOpenGLContext&) = delete;
+
+  /// \brief Chooses whether the direct state access calls are passed on or
+  ///   emulated, once it is known what the driver has.
+  /// \param[in] native Whether or not the wrapped context has them (e.g.,
+  ///   GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access, after glewInit (),
+  ///   for a RealOpenGLContext).
+  /// \pre No buffer or vertex array has been made through this context.
+  void
+  setNative (bool native);
+
+  /// \brief Tests whether or not the direct state access calls are passed
+  ///   on, rather than emulated.
+  /// \return Whether or not they are.
+  bool
+  isNative () const;
+
+  virtual void
+  activeTexture (GLenum texture);
+
+  virtual void
+  attachShader (GLuint program, GLuint shader);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindBufferBase (GLenum target, GLuint index, GLuint buffer);
+
+  virtual void
+  bindFramebuffer (GLenum target, GLuint framebuffer);
+
+  virtual void
+  bindTexture (GLenum target, GLuint texture);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual GLenum
+  checkFramebufferStatus (GLenum target);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+  virtual void
+  compileShader (GLuint shader);
+
+  virtual void
+  createBuffers (GLsizei n, GLuint* buffers);
+
+  virtual GLuint
+  createProgram ();
+
+  virtual GLuint
+  createShader (GLenum shaderType);
+
+  virtual void
+  createVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteFramebuffers (GLsizei n, const GLuint* framebuffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
+  virtual void
+  deleteShader (GLuint shader);
+
+  virtual void
+  deleteSync (GLsync sync);
+
+  virtual void
+  deleteTextures (GLsizei n, const GLuint* textures);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  depthFunc (GLenum func);
+
+  virtual void
+  detachShader (GLuint program, GLuint shader);
+
+  virtual void
+  dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawBuffers (GLsizei n, const GLenum* bufs);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexArrayAttrib (GLuint vaobj, GLuint index);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual void
+  genBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  genFramebuffers (GLsizei n, GLuint* framebuffers);
+
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
+  virtual void
+  genTextures (GLsizei n, GLuint* textures);
+
+  virtual void
+  genVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+
+  virtual GLint
+  getAttribLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  getIntegerv (GLenum pname, GLint* data);
+
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
+  virtual void
+  getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getProgramiv (GLuint program, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
+  virtual void
+  getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getShaderiv (GLuint shader, GLenum pname, GLint* params);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual GLuint
+  getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName);
+
+  virtual GLint
+  getUniformLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void*
+  mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+  virtual void
+  maxShaderCompilerThreadsKHR (GLuint count);
+
+  virtual void
+  memoryBarrier (GLbitfield barriers);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+  virtual void
+  namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+
+  virtual void
+  namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+
+  virtual void
+  namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
+  virtual void
+  queryCounter (GLuint id, GLenum target);
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+
+  virtual void
+  texBuffer (GLenum target, GLenum internalformat, GLuint buffer);
+
+  virtual void
+  texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data);
+
+  virtual void
+  texParameteri (GLenum target, GLenum pname, GLint param);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+
+  virtual void
+  uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+
+  virtual void
+  uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual GLboolean
+  unmapNamedBuffer (GLuint buffer);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+
+  virtual void
+  vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+
+  virtual void
+  vertexArrayElementBuffer (GLuint vaobj, GLuint buffer);
+
+  virtual void
+  vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+
+  /// \brief The format of one vertex attribute of a vertex array.
+  struct AttribFormat
+  {
+    /// \brief Constructs an AttribFormat that hasn't been specified.
+    AttribFormat ();
+
+    /// Whether or not vertexArrayAttribFormat has been called for it.
+    bool specified;
+    /// The number of components.
+    GLint size;
+    /// The type of each component.
+    GLenum type;
+    /// Whether or not integer components are normalized.
+    GLboolean normalized;
+    /// Its offset within a vertex of its binding, in bytes.
+    GLuint relativeOffset;
+    /// The buffer binding it reads through.
+    GLuint binding;
+  };
+
+  /// \brief One buffer binding of a vertex array.
+  struct VertexBinding
+  {
+    /// The buffer, or 0.
+    GLuint buffer;
+    /// The offset of the first vertex, in bytes.
+    GLintptr offset;
+    /// The bytes from one vertex to the next.
+    GLsizei stride;
+  };
+
+  /// \brief Everything set on a vertex array by direct state access.
+  struct VertexArrayLayout
+  {
+    /// \brief Constructs a VertexArrayLayout with every attribute
+    ///   unspecified and reading through the binding of the same index.
+    VertexArrayLayout ();
+
+    /// Its attributes, by index.
+    AttribFormat attribs[MAX_VERTEX_ATTRIBS];
+    /// Its buffer bindings, by index.
+    VertexBinding bindings[MAX_VERTEX_ATTRIBS];
+  };
+
+  /// \brief Binds a vertex array to edit it, unless it is already bound.
+  /// \param[in] vaobj The vertex array.
+  void
+  beginEdit (GLuint vaobj);
+
+  /// \brief Binds back the vertex array that was bound before beginEdit ().
+  /// \param[in] vaobj The vertex array that was edited.
+  void
+  endEdit (GLuint vaobj);
+
+  /// \brief Points an attribute of the bound vertex array at its binding's
+  ///   buffer, if it has both a format and a buffer.
+  /// \param[in] layout The vertex array's layout.
+  /// \param[in] index The attribute's index.
+  void
+  applyAttrib (const VertexArrayLayout& layout, GLuint index);
+
+  /// The context calls are passed on to.
+  OpenGLContext* m_context;
+  /// Whether or not m_context has the direct state access calls.
+  bool m_native;
+  /// The vertex array bound.
+  GLuint m_vertexArray;
+  /// The buffer bound to GL_ARRAY_BUFFER.
+  GLuint m_arrayBuffer;
+  /// The layout of each vertex array edited while emulating, by name.
+  std::map<GLuint, VertexArrayLayout> m_layouts;
+};
+
+#endif//DIRECT_STATE_OPENGL_CONTEXT_HPP
@@ -0,0 +1,72 @@
+/// \file Frustum.cpp
+/// \brief Definition of Frustum class and any associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cmath>
+#include <algorithm>
+
+#include "Frustum.hpp"
+
+Frustum::Frustum ()
+{
+  for (Vector4& plane : m_planes)
+    plane.set (0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Frustum::Frustum (const Matrix4& viewProjection)
+{
+  set (viewProjection);
+}
+
+void
+Frustum::set (const Matrix4& viewProjection)
+{
+  // Each plane is the last row of the matrix plus or minus one of the others
+  //   (Gribb and Hartmann).
+  const float* m = viewProjection.data ();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    for (int side = 0; side < 2; ++side)
+    {
+      float sign = (side == 0) ? 1.0f : -1.0f;
+      Vector4& plane = m_planes[2 * axis + side];
+      plane.set (m[3] + sign * m[axis], m[7] + sign * m[4 + axis],
+                 m[11] + sign * m[8 + axis], m[15] + sign * m[12 + axis]);
+      float length = std::sqrt (plane.m_x * plane.m_x + plane.m_y * plane.m_y
+                                + plane.m_z * plane.m_z);
+      if (length > 0.0f)
+        plane /= length;
+    }
+  }
+}
+
+bool
+Frustum::intersectsSphere (const Vector3& center, float radius) const
+{
+  for (const Vector4& plane : m_planes)
+  {
+    float distance = plane.m_x * center.m_x + plane.m_y * center.m_y
+      + plane.m_z * center.m_z + plane.m_w;
+    if (distance < -radius)
+      return false;
+  }
+  return true;
+}
+
+bool
+Frustum::intersectsSphere (const float world[16], const Vector3& center,
+                           float radius) const
+{
+  Vector3 worldCenter (
+    world[0] * center.m_x + world[4] * center.m_y + world[8] * center.m_z + world[12],
+    world[1] * center.m_x + world[5] * center.m_y + world[9] * center.m_z + world[13],
+    world[2] * center.m_x + world[6] * center.m_y + world[10] * center.m_z + world[14]);
+  float scaleSquared = 0.0f;
+  for (int col = 0; col < 3; ++col)
+  {
+    const float* c = world + 4 * col;
+    scaleSquared = std::max (scaleSquared, c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+  }
+  return intersectsSphere (worldCenter, radius * std::sqrt (scaleSquared));
+}
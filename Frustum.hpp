@@ -0,0 +1,63 @@
+/// \file Frustum.hpp
+/// \brief Declaration of Frustum class and any associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include "Vector3.hpp"
+#include "Vector4.hpp"
+#include "Matrix4.hpp"
+
+/// \brief The region of the world that a camera can see, bounded by six
+///   planes, used to skip objects that are entirely off-screen.
+class Frustum
+{
+public:
+
+  /// \brief Constructs a Frustum that contains everything.
+  Frustum ();
+
+  /// \brief Constructs the Frustum of a camera.
+  /// \param[in] viewProjection The camera's projection matrix times its view
+  ///   matrix.
+  explicit
+  Frustum (const Matrix4& viewProjection);
+
+  /// \brief Recomputes the planes from a camera's matrices.
+  /// \param[in] viewProjection The camera's projection matrix times its view
+  ///   matrix.
+  /// \post Each plane faces inward and has a unit-length normal.
+  void
+  set (const Matrix4& viewProjection);
+
+  /// \brief Tests whether or not a sphere might be visible.
+  /// \param[in] center The center of the sphere, in world coordinates.
+  /// \param[in] radius The radius of the sphere.
+  /// \return False if the sphere is entirely outside one of the planes, and
+  ///   true otherwise.
+  bool
+  intersectsSphere (const Vector3& center, float radius) const;
+
+  /// \brief Tests whether or not an object's bounding sphere might be
+  ///   visible.
+  /// \param[in] world The object's column-major 4x4 world matrix.
+  /// \param[in] center The center of the sphere, in the object's local
+  ///   coordinates.
+  /// \param[in] radius The radius of the sphere, in the object's local
+  ///   coordinates.
+  /// \return Whether or not the sphere, moved into the world and grown by the
+  ///   largest scale in the world matrix, intersects this Frustum.
+  bool
+  intersectsSphere (const float world[16], const Vector3& center,
+                    float radius) const;
+
+private:
+
+  /// The left, right, bottom, top, near, and far planes, as (a, b, c, d) with
+  ///   ax + by + cz + d >= 0 inside.
+  Vector4 m_planes[6];
+};
+
+#endif//FRUSTUM_HPP
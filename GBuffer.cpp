@@ -0,0 +1,114 @@
+/// \file GBuffer.cpp
+/// \brief Definition of GBuffer class and any associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstdio>
+
+#include "GBuffer.hpp"
+
+GBuffer::GBuffer (OpenGLContext* context)
+  : m_context (context), m_framebuffer (0), m_screenArray (0), m_width (0),
+    m_height (0), m_complete (false)
+{
+  m_context->genFramebuffers (1, &m_framebuffer);
+  m_context->genTextures (3, m_textures);
+  m_context->genVertexArrays (1, &m_screenArray);
+}
+
+GBuffer::~GBuffer ()
+{
+  m_context->deleteVertexArrays (1, &m_screenArray);
+  m_context->deleteTextures (3, m_textures);
+  m_context->deleteFramebuffers (1, &m_framebuffer);
+}
+
+bool
+GBuffer::begin ()
+{
+  GLint viewport[4];
+  m_context->getIntegerv (GL_VIEWPORT, viewport);
+  if (viewport[2] != m_width || viewport[3] != m_height)
+    m_complete = resize (viewport[2], viewport[3]);
+  if (!m_complete)
+    return false;
+  m_context->bindFramebuffer (GL_FRAMEBUFFER, m_framebuffer);
+  m_context->clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  return true;
+}
+
+void
+GBuffer::end ()
+{
+  m_context->bindFramebuffer (GL_FRAMEBUFFER, 0);
+}
+
+void
+GBuffer::bind () const
+{
+  const GLuint units[3] = { GBUFFER_COLOR_UNIT, GBUFFER_NORMAL_UNIT, GBUFFER_DEPTH_UNIT };
+  for (int i = 0; i < 3; ++i)
+  {
+    m_context->activeTexture (GL_TEXTURE0 + units[i]);
+    m_context->bindTexture (GL_TEXTURE_2D, m_textures[i]);
+  }
+  m_context->activeTexture (GL_TEXTURE0);
+}
+
+void
+GBuffer::drawScreen () const
+{
+  m_context->bindVertexArray (m_screenArray);
+  m_context->drawArrays (GL_TRIANGLES, 0, 3);
+  m_context->bindVertexArray (0);
+}
+
+GLsizei
+GBuffer::getWidth () const
+{
+  return m_width;
+}
+
+GLsizei
+GBuffer::getHeight () const
+{
+  return m_height;
+}
+
+bool
+GBuffer::resize (GLsizei width, GLsizei height)
+{
+  m_width = width;
+  m_height = height;
+  if (width <= 0 || height <= 0)
+    return false;
+
+  const GLint internalFormats[3] = { GL_RGBA8, GL_RGBA16F, GL_DEPTH_COMPONENT24 };
+  const GLenum formats[3] = { GL_RGBA, GL_RGBA, GL_DEPTH_COMPONENT };
+  const GLenum types[3] = { GL_UNSIGNED_BYTE, GL_FLOAT, GL_UNSIGNED_INT };
+  const GLenum attachments[3] = { GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1,
+                                  GL_DEPTH_ATTACHMENT };
+  m_context->bindFramebuffer (GL_FRAMEBUFFER, m_framebuffer);
+  for (int i = 0; i < 3; ++i)
+  {
+    m_context->bindTexture (GL_TEXTURE_2D, m_textures[i]);
+    m_context->texImage2D (GL_TEXTURE_2D, 0, internalFormats[i], width, height,
+                           0, formats[i], types[i], nullptr);
+    // The lighting pass reads exactly one texel per pixel, so there are no
+    //   mipmaps to sample.
+    m_context->texParameteri (GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    m_context->texParameteri (GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    m_context->framebufferTexture2D (GL_FRAMEBUFFER, attachments[i], GL_TEXTURE_2D,
+                                     m_textures[i], 0);
+  }
+  m_context->bindTexture (GL_TEXTURE_2D, 0);
+  m_context->drawBuffers (2, attachments);
+  GLenum status = m_context->checkFramebufferStatus (GL_FRAMEBUFFER);
+  m_context->bindFramebuffer (GL_FRAMEBUFFER, 0);
+  if (status != GL_FRAMEBUFFER_COMPLETE)
+  {
+    fprintf (stderr, "G-buffer is incomplete (status 0x%x)\n", status);
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,110 @@
+/// \file GBuffer.hpp
+/// \brief Declaration of GBuffer class and any associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef GBUFFER_HPP
+#define GBUFFER_HPP
+
+#include "OpenGLContext.hpp"
+
+/// The texture unit of the G-buffer's color texture ("uGBufferColor").
+const GLuint GBUFFER_COLOR_UNIT = 1;
+
+/// The texture unit of the G-buffer's normal texture ("uGBufferNormal").
+const GLuint GBUFFER_NORMAL_UNIT = 2;
+
+/// The texture unit of the G-buffer's depth texture ("uGBufferDepth").
+const GLuint GBUFFER_DEPTH_UNIT = 3;
+
+/// \brief The off-screen framebuffer that the geometry pass of deferred
+///   shading draws into, so that lighting can be done once per pixel
+///   afterward instead of once per fragment of every Mesh.
+///
+/// It holds three textures, each the size of the viewport:
+///   - color (RGBA8): the ambient and emissive light, which need no lights;
+///   - normal (RGBA16F): the eye-space normal in xyz, and in w the index of
+///     the Material in the material uniform block;
+///   - depth (DEPTH_COMPONENT24): the depth, from which the lighting pass
+///     recovers the eye-space position.
+class GBuffer
+{
+public:
+
+  /// \brief Constructs a GBuffer, whose textures get their storage on the
+  ///   first begin ().
+  /// \param[in] context The context to make OpenGL calls through.
+  GBuffer (OpenGLContext* context);
+
+  /// \brief Destructs a GBuffer, deleting its framebuffer and textures.
+  ~GBuffer ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   GBuffers.
+  GBuffer (const GBuffer&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   GBuffers.
+  GBuffer&
+  operator= (const GBuffer&) = delete;
+
+  /// \brief Starts the geometry pass.
+  /// \return Whether or not the framebuffer could be used.  If not, the
+  ///   default framebuffer is still bound.
+  /// \post If the viewport changed size, the textures have been resized.
+  /// \post The framebuffer is bound and cleared.
+  bool
+  begin ();
+
+  /// \brief Ends the geometry pass.
+  /// \post The default framebuffer is bound.
+  void
+  end ();
+
+  /// \brief Binds the three textures to their texture units, for the
+  ///   lighting pass.
+  /// \post GL_TEXTURE0 is the active texture unit.
+  void
+  bind () const;
+
+  /// \brief Draws one triangle that covers the whole viewport, with no
+  ///   vertex attributes; the vertex shader places it by gl_VertexID.
+  void
+  drawScreen () const;
+
+  /// \brief Gets the width of the textures.
+  /// \return The width, in pixels.
+  GLsizei
+  getWidth () const;
+
+  /// \brief Gets the height of the textures.
+  /// \return The height, in pixels.
+  GLsizei
+  getHeight () const;
+
+private:
+
+  /// \brief Gives the textures storage of the viewport's size.
+  /// \param[in] width The new width.
+  /// \param[in] height The new height.
+  /// \return Whether or not the framebuffer is complete.
+  bool
+  resize (GLsizei width, GLsizei height);
+
+  /// The context to make OpenGL calls through.
+  OpenGLContext* m_context;
+  /// The framebuffer object.
+  GLuint m_framebuffer;
+  /// The color, normal, and depth textures.
+  GLuint m_textures[3];
+  /// An empty vertex array, for drawScreen ().
+  GLuint m_screenArray;
+  /// The size of the textures.
+  GLsizei m_width;
+  /// The size of the textures.
+  GLsizei m_height;
+  /// Whether or not the framebuffer was complete at its current size.
+  bool m_complete;
+};
+
+#endif//GBUFFER_HPP
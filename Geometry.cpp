@@ -3,9 +3,12 @@
 /// \author Chad Hogg
 /// \version A08
 
+#include <cmath>
 #include <random>
 #include <cassert>
 #include <iostream>
+#include <map>
+#include <tuple>
 
 #include "Geometry.hpp"
 
@@ -51,6 +54,33 @@ indexData (const std::vector<float>& geometry, unsigned int floatsPerVertex,
   }
 }
 
+std::vector<unsigned int>
+simplifyIndices (const std::vector<float>& data, unsigned int floatsPerVertex,
+		 const std::vector<unsigned int>& indices, float cellSize)
+{
+  std::map<std::tuple<long, long, long>, unsigned int> cells;
+  std::vector<unsigned int> representative (data.size () / floatsPerVertex);
+  for (unsigned int vertex = 0; vertex < representative.size (); ++vertex)
+  {
+    const float* position = &data[vertex * floatsPerVertex];
+    std::tuple<long, long, long> cell (std::lround (std::floor (position[0] / cellSize)),
+                                       std::lround (std::floor (position[1] / cellSize)),
+                                       std::lround (std::floor (position[2] / cellSize)));
+    // The first vertex found in a cell stands for all of them.
+    representative[vertex] = cells.emplace (cell, vertex).first->second;
+  }
+  std::vector<unsigned int> simplified;
+  for (unsigned int i = 0; i + 2 < indices.size (); i += 3)
+  {
+    unsigned int a = representative[indices[i]];
+    unsigned int b = representative[indices[i + 1]];
+    unsigned int c = representative[indices[i + 2]];
+    if (a != b && b != c && a != c)
+      simplified.insert (simplified.end (), { a, b, c });
+  }
+  return simplified;
+}
+
 std::vector<Vector3>
 computeFaceNormals (const std::vector<Triangle>& faces)
 {
@@ -265,3 +295,33 @@ buildCube ()
   triangles.push_back ((Triangle){Vector3 (0.5f, -0.5f, -0.5f), Vector3 (0.5f, -0.5f, 0.5f), Vector3 (-0.5f, -0.5f, -0.5f)});
   return triangles;
 }
+
+std::vector<Triangle>
+buildSphere (unsigned int rings, unsigned int segments)
+{
+  const float PI = 3.14159265358979f;
+  auto point = [=] (unsigned int ring, unsigned int segment)
+  {
+    float polar = PI * ring / rings;
+    float azimuth = 2.0f * PI * segment / segments;
+    return Vector3 (std::sin (polar) * std::cos (azimuth), std::cos (polar),
+                    -std::sin (polar) * std::sin (azimuth));
+  };
+  std::vector<Triangle> triangles;
+  for (unsigned int ring = 0; ring < rings; ++ring)
+  {
+    for (unsigned int segment = 0; segment < segments; ++segment)
+    {
+      Vector3 upperLeft = point (ring, segment);
+      Vector3 upperRight = point (ring, segment + 1);
+      Vector3 lowerLeft = point (ring + 1, segment);
+      Vector3 lowerRight = point (ring + 1, segment + 1);
+      // The bands that touch a pole only need one triangle per slice.
+      if (ring != 0)
+        triangles.push_back ((Triangle){upperLeft, lowerLeft, upperRight});
+      if (ring + 1 != rings)
+        triangles.push_back ((Triangle){upperRight, lowerLeft, lowerRight});
+    }
+  }
+  return triangles;
+}
@@ -25,6 +25,21 @@ void
 indexData (const std::vector<float>& geometry, unsigned int floatsPerVertex,
 	   std::vector<float>& data, std::vector<unsigned int>& indices);
 
+/// \brief Builds a coarser set of triangles over the same vertices, for a
+///   farther level of detail (see Mesh::addLevelOfDetail), by clustering:
+///   each vertex is replaced by the first vertex in its cell of a grid, and
+///   the triangles that collapse are dropped.
+/// \param[in] data Indexed vertex data, each vertex starting with its
+///   position.
+/// \param[in] floatsPerVertex The number of floats used for each vertex.
+/// \param[in] indices Three indices into data per triangle.
+/// \param[in] cellSize The width of the grid's cells; the larger it is, the
+///   fewer triangles are left.
+/// \return Three indices into data per remaining triangle.
+std::vector<unsigned int>
+simplifyIndices (const std::vector<float>& data, unsigned int floatsPerVertex,
+		 const std::vector<unsigned int>& indices, float cellSize);
+
 /// \brief Computes a normal vector for each face of a mesh.
 /// \param[in] faces A collection of faces that are part of the mesh.
 /// \return A collection containing one normal vector per face.
@@ -105,3 +120,11 @@ dataWithVertexNormals (const std::vector<Triangle>& faces,
 /// \return A collection of triangles in a unit cube, centered on the origin.
 std::vector<Triangle>
 buildCube ();
+
+/// \brief Creates a collection of triangles approximating a unit sphere.
+/// \param[in] rings The number of bands from pole to pole (at least 2).
+/// \param[in] segments The number of slices around the Y axis (at least 3).
+/// \return A collection of triangles whose vertices all lie on the sphere of
+///   radius 1 centered on the origin, so every triangle is inside it.
+std::vector<Triangle>
+buildSphere (unsigned int rings, unsigned int segments);
@@ -0,0 +1,217 @@
+/// \file GeometryArena.cpp
+/// \brief Definition of GeometryRange and GeometryArena classes and any
+///   associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+#include "GeometryArena.hpp"
+
+GeometryArena::GeometryArena (OpenGLContext* context)
+  : m_context (context), m_formats (), m_indices { 0, sizeof (GLuint), BufferAllocator (), {} },
+    m_ranges (), m_defragmentCount (0)
+{
+  m_context->createBuffers (1, &m_indices.buffer);
+}
+
+GeometryArena::~GeometryArena ()
+{
+  for (GeometryRange* range : m_ranges)
+    delete range;
+  for (const std::pair<const std::string, Format>& format : m_formats)
+  {
+    m_context->deleteVertexArrays (1, &format.second.vao);
+    m_context->deleteBuffers (1, &format.second.vertices.buffer);
+  }
+  m_context->deleteBuffers (1, &m_indices.buffer);
+}
+
+GLuint
+GeometryArena::getVertexArray (const std::string& format, GLsizei stride, bool& created)
+{
+  auto found = m_formats.find (format);
+  created = (found == m_formats.end ());
+  if (!created)
+    return found->second.vao;
+
+  Format& added = m_formats[format];
+  added.vertices.unit = stride;
+  m_context->createVertexArrays (1, &added.vao);
+  m_context->createBuffers (1, &added.vertices.buffer);
+  m_context->vertexArrayVertexBuffer (added.vao, 0, added.vertices.buffer, 0, stride);
+  m_context->vertexArrayElementBuffer (added.vao, m_indices.buffer);
+  return added.vao;
+}
+
+const GeometryRange*
+GeometryArena::allocate (const std::string& format, const std::vector<float>& vertices,
+                         const std::vector<unsigned int>& indices)
+{
+  Format& buffers = m_formats.at (format);
+  GeometryRange* range = new GeometryRange;
+  range->vao = buffers.vao;
+  range->vertexCount = vertices.size () * sizeof (float) / buffers.vertices.unit;
+  range->firstVertex = store (buffers.vertices, vertices.data (), range->vertexCount);
+  range->indexCount = indices.size ();
+
+  std::vector<GLuint> shifted (indices.size ());
+  std::transform (indices.begin (), indices.end (), shifted.begin (),
+                  [range] (unsigned int index) { return index + range->firstVertex; });
+  range->firstIndex = store (m_indices, shifted.data (), range->indexCount);
+  m_ranges.insert (range);
+  return range;
+}
+
+void
+GeometryArena::release (const GeometryRange* range)
+{
+  auto found = m_ranges.find (const_cast<GeometryRange*> (range));
+  if (found == m_ranges.end ())
+    return;
+  for (std::pair<const std::string, Format>& format : m_formats)
+    if (format.second.vao == range->vao)
+      format.second.vertices.allocator.release (range->firstVertex);
+  // The storage keeps its contents, so there is nothing to upload.
+  m_indices.allocator.release (range->firstIndex);
+  m_ranges.erase (found);
+  delete range;
+}
+
+void
+GeometryArena::defragment ()
+{
+  std::vector<GeometryRange*> ranges (m_ranges.begin (), m_ranges.end ());
+  for (std::pair<const std::string, Format>& format : m_formats)
+  {
+    std::vector<GeometryRange*> inFormat;
+    std::vector<GLuint*> firsts;
+    std::vector<GLuint> counts;
+    for (GeometryRange* range : ranges)
+      if (range->vao == format.second.vao)
+      {
+        inFormat.push_back (range);
+        firsts.push_back (&range->firstVertex);
+        counts.push_back (range->vertexCount);
+      }
+    std::vector<long> moves = compact (format.second.vertices, firsts, counts);
+    // Each range's indices point at its vertices, so they move with them.
+    for (std::size_t i = 0; i < inFormat.size (); ++i)
+    {
+      if (moves[i] == 0)
+        continue;
+      GLuint* indices = reinterpret_cast<GLuint*> (m_indices.data.data ()) + inFormat[i]->firstIndex;
+      for (GLuint j = 0; j < inFormat[i]->indexCount; ++j)
+        indices[j] += moves[i];
+    }
+  }
+
+  std::vector<GLuint*> firsts;
+  std::vector<GLuint> counts;
+  for (GeometryRange* range : ranges)
+  {
+    firsts.push_back (&range->firstIndex);
+    counts.push_back (range->indexCount);
+  }
+  compact (m_indices, firsts, counts);
+  ++m_defragmentCount;
+}
+
+GLuint
+GeometryArena::getIndexBuffer () const
+{
+  return m_indices.buffer;
+}
+
+unsigned int
+GeometryArena::getFormatCount () const
+{
+  return m_formats.size ();
+}
+
+std::size_t
+GeometryArena::getSize () const
+{
+  std::size_t size = m_indices.allocator.getUsed () * m_indices.unit;
+  for (const std::pair<const std::string, Format>& format : m_formats)
+    size += format.second.vertices.allocator.getUsed () * format.second.vertices.unit;
+  return size;
+}
+
+std::size_t
+GeometryArena::getCapacity () const
+{
+  std::size_t capacity = m_indices.data.size ();
+  for (const std::pair<const std::string, Format>& format : m_formats)
+    capacity += format.second.vertices.data.size ();
+  return capacity;
+}
+
+std::size_t
+GeometryArena::getFreeRangeCount () const
+{
+  std::size_t count = m_indices.allocator.getFreeRangeCount ();
+  for (const std::pair<const std::string, Format>& format : m_formats)
+    count += format.second.vertices.allocator.getFreeRangeCount ();
+  return count;
+}
+
+unsigned int
+GeometryArena::getDefragmentCount () const
+{
+  return m_defragmentCount;
+}
+
+GLuint
+GeometryArena::store (Pool& pool, const void* bytes, std::size_t count)
+{
+  std::size_t first = pool.allocator.allocate (count);
+  bool grown = (first == BufferAllocator::NONE);
+  if (grown)
+  {
+    // Doubling keeps the total copied over many allocations proportional to
+    //   the final size.
+    std::size_t capacity = pool.allocator.getCapacity ();
+    pool.allocator.grow (std::max (2 * capacity, capacity + std::max<std::size_t> (count, 1)));
+    pool.data.resize (pool.allocator.getCapacity () * pool.unit);
+    first = pool.allocator.allocate (count);
+  }
+  std::size_t size = count * pool.unit;
+  if (size > 0)
+    std::memcpy (pool.data.data () + first * pool.unit, bytes, size);
+  if (grown)
+    m_context->namedBufferData (pool.buffer, pool.data.size (), pool.data.data (),
+                                GL_STATIC_DRAW);
+  else if (size > 0)
+    m_context->namedBufferSubData (pool.buffer, first * pool.unit, size, bytes);
+  return first;
+}
+
+std::vector<long>
+GeometryArena::compact (Pool& pool, const std::vector<GLuint*>& firsts,
+                        const std::vector<GLuint>& counts)
+{
+  std::vector<std::size_t> order (firsts.size ());
+  std::iota (order.begin (), order.end (), 0);
+  std::sort (order.begin (), order.end (),
+             [&firsts] (std::size_t a, std::size_t b) { return *firsts[a] < *firsts[b]; });
+
+  // Allocating from a cleared allocator in order packs the ranges from its
+  //   start, and moving each down never overwrites one not yet moved.
+  std::vector<long> moves (firsts.size (), 0);
+  pool.allocator.clear ();
+  for (std::size_t i : order)
+  {
+    GLuint first = pool.allocator.allocate (counts[i]);
+    moves[i] = long (first) - long (*firsts[i]);
+    if (moves[i] != 0 && counts[i] > 0)
+      std::memmove (pool.data.data () + first * pool.unit,
+                    pool.data.data () + *firsts[i] * pool.unit, counts[i] * pool.unit);
+    *firsts[i] = first;
+  }
+  if (!pool.data.empty ())
+    m_context->namedBufferSubData (pool.buffer, 0, pool.data.size (), pool.data.data ());
+  return moves;
+}
@@ -0,0 +1,196 @@
+/// \file GeometryArena.hpp
+/// \brief Declaration of GeometryRange and GeometryArena classes and any
+///   associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef GEOMETRY_ARENA_HPP
+#define GEOMETRY_ARENA_HPP
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "BufferAllocator.hpp"
+#include "OpenGLContext.hpp"
+
+/// \brief Where one Mesh's geometry lives in a GeometryArena, which moves it
+///   when it defragments.
+struct GeometryRange
+{
+  /// The vertex array of the geometry's vertex format.
+  GLuint vao;
+  /// The first vertex, counted from the start of the format's vertex buffer.
+  GLuint firstVertex;
+  /// The number of vertices.
+  GLuint vertexCount;
+  /// The first index, counted from the start of the index buffer.
+  GLuint firstIndex;
+  /// The number of indices.
+  GLuint indexCount;
+};
+
+/// \brief One large vertex buffer (and vertex array) per vertex format and
+///   one index buffer, shared by many Meshes, so that every Mesh of a format
+///   can be drawn without binding another vertex array, and with a single
+///   glMultiDrawElementsIndirect call (see RenderQueue).
+///
+/// Each buffer is carved up by a BufferAllocator: vertex buffers in whole
+///   vertices, the index buffer in indices.  The indices are stored with
+///   the Mesh's first vertex added to them, so each range can be drawn with
+///   a plain glDrawElements from its first index.  A buffer that runs out of
+///   room is reallocated at twice the size and filled from the arena's own
+///   copy of its contents, which keeps its name (and so every vertex array
+///   that reads it) the same.
+///
+/// Released ranges go back to their allocators, to be reused by Meshes
+///   added later.  Meshes that come and go in different sizes leave the
+///   free space in pieces, which defragment () gathers back together at the
+///   end of each buffer by moving the ranges in use down.
+class GeometryArena
+{
+public:
+
+  /// \brief Constructs an empty GeometryArena.
+  /// \param[in] context The context to make OpenGL calls through.
+  /// \post The index buffer has been created, with no storage yet.
+  explicit
+  GeometryArena (OpenGLContext* context);
+
+  /// \brief Destructs a GeometryArena.
+  /// \post Every buffer and vertex array it made has been deleted.
+  ~GeometryArena ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   GeometryArenas.
+  GeometryArena (const GeometryArena&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   GeometryArenas.
+  GeometryArena&
+  operator= (const GeometryArena&) = delete;
+
+  /// \brief Gets the vertex array of a vertex format, making it the first
+  ///   time the format is asked for.
+  /// \param[in] format The format's name (see Mesh::getVertexFormat).
+  /// \param[in] stride The number of bytes from one vertex to the next.
+  /// \param[out] created Whether or not the vertex array was just made, in
+  ///   which case the caller must enable and format its attributes.
+  /// \return The vertex array, whose binding 0 reads the format's vertex
+  ///   buffer and whose element buffer is the index buffer.
+  GLuint
+  getVertexArray (const std::string& format, GLsizei stride, bool& created);
+
+  /// \brief Copies geometry into the buffers of its format.
+  /// \param[in] format The format's name.
+  /// \param[in] vertices Whole vertices, of the format's stride.
+  /// \param[in] indices Indices into vertices.
+  /// \return Where the geometry went, which this arena keeps up to date
+  ///   until the range is released.
+  /// \pre getVertexArray has been called for format.
+  const GeometryRange*
+  allocate (const std::string& format, const std::vector<float>& vertices,
+            const std::vector<unsigned int>& indices);
+
+  /// \brief Gives a range back, for later allocations to reuse.
+  /// \param[in] range A range returned by allocate, which is no longer drawn.
+  /// \post range has been deleted.
+  void
+  release (const GeometryRange* range);
+
+  /// \brief Moves every range in use to the start of its buffers, so the
+  ///   free space in each is in one piece, at the end.
+  /// \post Every range returned by allocate and not released has been
+  ///   updated, and the buffers have been uploaded again.
+  void
+  defragment ();
+
+  /// \brief Gets the shared index buffer.
+  /// \return The buffer's name.
+  GLuint
+  getIndexBuffer () const;
+
+  /// \brief Gets the number of vertex formats.
+  /// \return How many vertex arrays have been made.
+  unsigned int
+  getFormatCount () const;
+
+  /// \brief Gets the number of bytes of geometry held.
+  /// \return The bytes of every vertex and index in use.
+  std::size_t
+  getSize () const;
+
+  /// \brief Gets the number of bytes of storage.
+  /// \return The size of every buffer, used or not.
+  std::size_t
+  getCapacity () const;
+
+  /// \brief Gets the number of separate free ranges, over every buffer.
+  /// \return The count, which is at most one per buffer right after
+  ///   defragment ().
+  std::size_t
+  getFreeRangeCount () const;
+
+  /// \brief Gets the number of times defragment () has been called, so that
+  ///   copies of ranges made elsewhere (e.g., on the GPU, by GpuCuller) can
+  ///   tell when they are stale.
+  /// \return The count.
+  unsigned int
+  getDefragmentCount () const;
+
+private:
+
+  /// \brief One buffer, carved up in units of a fixed size.
+  struct Pool
+  {
+    /// The buffer.
+    GLuint buffer;
+    /// The number of bytes in a unit (a vertex, or an index).
+    std::size_t unit;
+    /// Which units are in use.
+    BufferAllocator allocator;
+    /// A copy of the buffer's contents, all of its capacity.
+    std::vector<unsigned char> data;
+  };
+
+  /// \brief One vertex format's buffer and vertex array.
+  struct Format
+  {
+    /// The vertex array.
+    GLuint vao;
+    /// The vertex buffer, in whole vertices.
+    Pool vertices;
+  };
+
+  /// \brief Takes units from a pool, growing its buffer if they don't fit,
+  ///   and writes them.
+  /// \param[in,out] pool The pool.
+  /// \param[in] bytes What to write.
+  /// \param[in] count The number of units.
+  /// \return The first unit.
+  GLuint
+  store (Pool& pool, const void* bytes, std::size_t count);
+
+  /// \brief Moves the ranges in a pool to its start, in order.
+  /// \param[in,out] pool The pool.
+  /// \param[in] firsts Each range's first unit, which is updated.
+  /// \param[in] counts Each range's number of units.
+  /// \return How far each range moved.
+  std::vector<long>
+  compact (Pool& pool, const std::vector<GLuint*>& firsts,
+           const std::vector<GLuint>& counts);
+
+  /// The context to make OpenGL calls through.
+  OpenGLContext* m_context;
+  /// Every vertex format, by name.
+  std::map<std::string, Format> m_formats;
+  /// The index buffer, in indices.
+  Pool m_indices;
+  /// Every range allocated and not released.
+  std::set<GeometryRange*> m_ranges;
+  /// The number of calls to defragment ().
+  unsigned int m_defragmentCount;
+};
+
+#endif//GEOMETRY_ARENA_HPP
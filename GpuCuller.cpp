@@ -0,0 +1,210 @@
+/// \file GpuCuller.cpp
+/// \brief Definition of GpuCullObject and GpuCuller classes and any
+///   associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+#include "GpuCuller.hpp"
+#include "RenderQueue.hpp"
+
+namespace
+{
+  /// The number of objects in each work group of shaders/CullDraws.comp.
+  const GLuint CULL_GROUP_SIZE = 64;
+
+  /// The shader storage binding points of shaders/CullDraws.comp.
+  enum CullBinding
+  {
+    OBJECT_BINDING,
+    WORLD_BINDING,
+    COUNT_BINDING,
+    COMMAND_BINDING,
+    DRAW_DATA_BINDING
+  };
+}
+
+GpuCuller::GpuCuller (OpenGLContext* context, ShaderProgram* cullProgram)
+  : m_context (context), m_program (cullProgram),
+    m_objectCountUniform (cullProgram->getUniformHandle ("uObjectCount")), m_batches (),
+    m_objectCount (0), m_objectBuffer (0), m_worldBuffer (0), m_worldBytes (0),
+    m_countBuffer (0), m_commandBuffer (0), m_drawDataBuffer (0), m_drawDataTexture (0),
+    m_zeroCounts ()
+{
+  GLuint buffers[5];
+  m_context->createBuffers (5, buffers);
+  m_objectBuffer = buffers[0];
+  m_worldBuffer = buffers[1];
+  m_countBuffer = buffers[2];
+  m_commandBuffer = buffers[3];
+  m_drawDataBuffer = buffers[4];
+  m_context->genTextures (1, &m_drawDataTexture);
+}
+
+GpuCuller::~GpuCuller ()
+{
+  m_context->deleteTextures (1, &m_drawDataTexture);
+  GLuint buffers[5] = { m_objectBuffer, m_worldBuffer, m_countBuffer, m_commandBuffer,
+                        m_drawDataBuffer };
+  m_context->deleteBuffers (5, buffers);
+}
+
+void
+GpuCuller::setObjects (const std::vector<Mesh*>& meshes)
+{
+  // Batches are ordered by Material, so consecutive multi-draws rarely
+  //   switch vertex arrays, and each batch's Meshes are kept in the order
+  //   given.
+  std::map<std::tuple<int, Material*, GLuint>, std::vector<const Mesh*>> groups;
+  for (const Mesh* mesh : meshes)
+  {
+    Material* material = mesh->getMaterial ();
+    groups[std::make_tuple (material == nullptr ? -1 : material->getTableIndex (), material,
+                            mesh->getRange ()->vao)].push_back (mesh);
+  }
+
+  m_batches.clear ();
+  std::vector<GpuCullObject> objects;
+  objects.reserve (meshes.size ());
+  for (const auto& group : groups)
+  {
+    Batch batch { std::get<1> (group.first), std::get<2> (group.first),
+                  static_cast<GLuint> (objects.size ()),
+                  static_cast<GLuint> (group.second.size ()) };
+    for (const Mesh* mesh : group.second)
+    {
+      GpuCullObject object = {};
+      Vector3 center = mesh->getBoundsCenter ();
+      object.sphere[0] = center.m_x;
+      object.sphere[1] = center.m_y;
+      object.sphere[2] = center.m_z;
+      object.sphere[3] = mesh->getBoundsRadius ();
+      object.node = mesh->getNode ();
+      object.batch = m_batches.size ();
+      object.batchBase = batch.base;
+      object.levelCount = std::min (mesh->getLevelOfDetailCount (), GPU_CULL_MAX_LEVELS);
+      for (GLuint level = 0; level < object.levelCount; ++level)
+      {
+        const LevelOfDetail& detail = mesh->getLevelOfDetail (level);
+        object.firstIndex[level] = mesh->getRange ()->firstIndex + detail.firstIndex;
+        object.indexCount[level] = detail.indexCount;
+        object.distance[level] = detail.distance;
+      }
+      objects.push_back (object);
+    }
+    m_batches.push_back (batch);
+  }
+  m_objectCount = objects.size ();
+  m_zeroCounts.assign (m_batches.size (), 0);
+
+  m_context->namedBufferData (m_objectBuffer, objects.size () * sizeof (GpuCullObject),
+                              objects.data (), GL_STATIC_DRAW);
+  m_context->namedBufferData (m_countBuffer, m_zeroCounts.size () * sizeof (GLuint),
+                              m_zeroCounts.data (), GL_DYNAMIC_DRAW);
+  m_context->namedBufferData (m_commandBuffer,
+                              m_objectCount * sizeof (DrawElementsIndirectCommand),
+                              nullptr, GL_DYNAMIC_DRAW);
+  m_context->namedBufferData (m_drawDataBuffer, m_objectCount * sizeof (DrawData),
+                              nullptr, GL_DYNAMIC_DRAW);
+  m_context->bindTexture (GL_TEXTURE_BUFFER, m_drawDataTexture);
+  m_context->texBuffer (GL_TEXTURE_BUFFER, GL_RGBA32F, m_drawDataBuffer);
+  m_context->bindTexture (GL_TEXTURE_BUFFER, 0);
+}
+
+void
+GpuCuller::setWorldMatrices (const float* worlds, unsigned int nodeCount)
+{
+  GLsizeiptr bytes = nodeCount * 16 * sizeof (float);
+  if (bytes > m_worldBytes)
+  {
+    m_worldBytes = bytes;
+    m_context->namedBufferData (m_worldBuffer, bytes, worlds, GL_DYNAMIC_DRAW);
+  }
+  else if (bytes > 0)
+    m_context->namedBufferSubData (m_worldBuffer, 0, bytes, worlds);
+}
+
+void
+GpuCuller::cull ()
+{
+  if (m_objectCount == 0)
+    return;
+  m_context->namedBufferSubData (m_countBuffer, 0, m_zeroCounts.size () * sizeof (GLuint),
+                                 m_zeroCounts.data ());
+  m_context->bindBufferBase (GL_SHADER_STORAGE_BUFFER, OBJECT_BINDING, m_objectBuffer);
+  m_context->bindBufferBase (GL_SHADER_STORAGE_BUFFER, WORLD_BINDING, m_worldBuffer);
+  m_context->bindBufferBase (GL_SHADER_STORAGE_BUFFER, COUNT_BINDING, m_countBuffer);
+  m_context->bindBufferBase (GL_SHADER_STORAGE_BUFFER, COMMAND_BINDING, m_commandBuffer);
+  m_context->bindBufferBase (GL_SHADER_STORAGE_BUFFER, DRAW_DATA_BINDING, m_drawDataBuffer);
+  m_program->enable ();
+  m_program->setUniformInt (m_objectCountUniform, m_objectCount);
+  m_context->dispatchCompute ((m_objectCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+  m_program->disable ();
+  // The commands and counts are read as indirect arguments, and the DrawData
+  //   through a buffer texture, each of which needs its own barrier bit.
+  m_context->memoryBarrier (GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT
+                            | GL_TEXTURE_FETCH_BARRIER_BIT);
+}
+
+void
+GpuCuller::submit (ShaderProgram* program) const
+{
+  if (m_objectCount == 0)
+    return;
+  program->enable ();
+  program->setUniformInt (program->getUniformHandle ("uDrawData"), DRAW_DATA_UNIT);
+  UniformHandle drawBase = program->getUniformHandle ("uDrawBase");
+  m_context->bindBuffer (GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+  m_context->bindBuffer (GL_PARAMETER_BUFFER, m_countBuffer);
+  m_context->activeTexture (GL_TEXTURE0 + DRAW_DATA_UNIT);
+  m_context->bindTexture (GL_TEXTURE_BUFFER, m_drawDataTexture);
+  m_context->activeTexture (GL_TEXTURE0);
+  GLuint vao = 0;
+  for (unsigned int i = 0; i < m_batches.size (); ++i)
+  {
+    const Batch& batch = m_batches[i];
+    if (batch.material != nullptr)
+      batch.material->setUniforms (program);
+    if (batch.vao != vao)
+    {
+      vao = batch.vao;
+      m_context->bindVertexArray (vao);
+    }
+    program->setUniformInt (drawBase, batch.base);
+    GLintptr indirect = batch.base * sizeof (DrawElementsIndirectCommand);
+    m_context->multiDrawElementsIndirectCount (GL_TRIANGLES, GL_UNSIGNED_INT,
+                                               reinterpret_cast<void*> (indirect),
+                                               i * sizeof (GLuint), batch.size, 0);
+  }
+  m_context->bindVertexArray (0);
+  program->disable ();
+  m_context->bindBuffer (GL_PARAMETER_BUFFER, 0);
+  m_context->bindBuffer (GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+unsigned int
+GpuCuller::getObjectCount () const
+{
+  return m_objectCount;
+}
+
+unsigned int
+GpuCuller::getBatchCount () const
+{
+  return m_batches.size ();
+}
+
+GLuint
+GpuCuller::getCountBuffer () const
+{
+  return m_countBuffer;
+}
+
+GLuint
+GpuCuller::getCommandBuffer () const
+{
+  return m_commandBuffer;
+}
@@ -0,0 +1,184 @@
+/// \file GpuCuller.hpp
+/// \brief Declaration of GpuCullObject and GpuCuller classes and any
+///   associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef GPU_CULLER_HPP
+#define GPU_CULLER_HPP
+
+#include <vector>
+
+#include "OpenGLContext.hpp"
+#include "ShaderProgram.hpp"
+#include "Material.hpp"
+#include "Mesh.hpp"
+
+/// The most levels of detail a GpuCullObject can have (see MAX_LEVELS in
+///   shaders/CullDraws.comp).  A Mesh's farther levels are left out.
+const unsigned int GPU_CULL_MAX_LEVELS = 4;
+
+/// \brief One Mesh, as the culling compute shader reads it from its object
+///   buffer (std430, so each array is packed).
+struct GpuCullObject
+{
+  /// The center (in local coordinates) and radius of the bounding sphere.
+  float sphere[4];
+  /// The Mesh's node in the TransformHierarchy.
+  GLuint node;
+  /// The batch the Mesh is drawn in.
+  GLuint batch;
+  /// The first command (and DrawData) of that batch.
+  GLuint batchBase;
+  /// The number of levels of detail used.
+  GLuint levelCount;
+  /// Each level's first index in the GeometryArena's element buffer.
+  GLuint firstIndex[GPU_CULL_MAX_LEVELS];
+  /// Each level's number of indices.
+  GLuint indexCount[GPU_CULL_MAX_LEVELS];
+  /// How far away each level starts, in bounding radii.
+  float distance[GPU_CULL_MAX_LEVELS];
+};
+
+static_assert (sizeof (GpuCullObject) == 80, "GpuCullObject is padded");
+
+/// \brief Culls Meshes and builds their draw calls on the GPU, so the CPU
+///   cost of a frame doesn't grow with the number of Meshes.
+///
+/// setObjects () uploads each Mesh's bounding sphere, node, and levels of
+///   detail once, grouped into batches of Meshes that share a Material and
+///   a vertex array, and setWorldMatrices () uploads the TransformHierarchy's
+///   world matrices whenever they change.  Each frame, cull () dispatches
+///   shaders/CullDraws.comp, which tests every Mesh against the view
+///   frustum in the CameraBlock, picks its level of detail, and appends a
+///   DrawElementsIndirectCommand and a DrawData for it to its batch,
+///   counting them with an atomic add.  submit () then draws each batch with
+///   one glMultiDrawElementsIndirectCount call, which reads the number of
+///   draws from that count, so nothing is read back to the CPU.
+///
+/// The buffers are laid out for the lit shader's multi-draw variants:
+///   commands and DrawData have one slot per Mesh, each batch's slots are
+///   contiguous, and "uDrawBase" is the batch's first slot.
+class GpuCuller
+{
+public:
+
+  /// \brief Constructs a GpuCuller with no objects.
+  /// \param[in] context The context to make OpenGL calls through, which
+  ///   needs compute shaders, shader storage buffers,
+  ///   glMultiDrawElementsIndirectCount, and gl_DrawID (OpenGL 4.6, or 4.3
+  ///   with ARB_indirect_parameters and ARB_shader_draw_parameters).
+  /// \param[in] cullProgram The program built from shaders/CullDraws.comp
+  ///   (see ShaderProgram::buildCompute), which must outlive this GpuCuller.
+  GpuCuller (OpenGLContext* context, ShaderProgram* cullProgram);
+
+  /// \brief Destructs a GpuCuller, deleting its buffers.
+  ~GpuCuller ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   GpuCullers.
+  GpuCuller (const GpuCuller&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   GpuCullers.
+  GpuCuller&
+  operator= (const GpuCuller&) = delete;
+
+  /// \brief Replaces the objects to cull.
+  /// \param[in] meshes The Meshes, which must be prepared, attached to the
+  ///   TransformHierarchy whose matrices are passed to setWorldMatrices, and
+  ///   drawn from one GeometryArena.  Their Materials must already have
+  ///   table indexes.
+  /// \post The objects and batches are uploaded, and their ranges are
+  ///   copied, so this must be called again if the Meshes change or the
+  ///   arena is defragmented.
+  void
+  setObjects (const std::vector<Mesh*>& meshes);
+
+  /// \brief Uploads the world matrices that objects' nodes index.
+  /// \param[in] worlds The column-major matrices, one per node.
+  /// \param[in] nodeCount The number of matrices.
+  void
+  setWorldMatrices (const float* worlds, unsigned int nodeCount);
+
+  /// \brief Culls every object and writes the draws of the visible ones.
+  /// \pre The CameraBlock holds this frame's camera, and the world matrices
+  ///   are up to date.
+  /// \post The commands, DrawData, and counts are written, and visible to
+  ///   indirect draws and to "uDrawData".
+  void
+  cull ();
+
+  /// \brief Draws what the last cull () kept, one multi-draw per batch.
+  /// \param[in] program The multi-draw variant of the lit shader program to
+  ///   draw with.
+  /// \pre cull () has been called this frame.
+  /// \post No vertex array is bound, and no program is in use.
+  void
+  submit (ShaderProgram* program) const;
+
+  /// \brief Gets the number of objects.
+  /// \return The number of Meshes last passed to setObjects ().
+  unsigned int
+  getObjectCount () const;
+
+  /// \brief Gets the number of batches.
+  /// \return How many multi-draws submit () issues.
+  unsigned int
+  getBatchCount () const;
+
+  /// \brief Gets the buffer of each batch's number of visible objects.
+  /// \return The buffer, which holds one GLuint per batch.
+  GLuint
+  getCountBuffer () const;
+
+  /// \brief Gets the buffer of draw commands.
+  /// \return The buffer, which holds one DrawElementsIndirectCommand per
+  ///   object, of which each batch's first counts are written.
+  GLuint
+  getCommandBuffer () const;
+
+private:
+
+  /// \brief The Meshes drawn by one multi-draw.
+  struct Batch
+  {
+    /// The Material they share, or nullptr.
+    Material* material;
+    /// The vertex array they share.
+    GLuint vao;
+    /// Their first command.
+    GLuint base;
+    /// Their number.
+    GLuint size;
+  };
+
+  /// The context to make OpenGL calls through.
+  OpenGLContext* m_context;
+  /// The culling compute program.
+  ShaderProgram* m_program;
+  /// The handle of "uObjectCount".
+  UniformHandle m_objectCountUniform;
+  /// Every batch, in the order its commands are laid out.
+  std::vector<Batch> m_batches;
+  /// The number of objects.
+  unsigned int m_objectCount;
+  /// The GpuCullObjects.
+  GLuint m_objectBuffer;
+  /// The world matrices.
+  GLuint m_worldBuffer;
+  /// The size of m_worldBuffer, in bytes.
+  GLsizeiptr m_worldBytes;
+  /// Each batch's number of visible objects.
+  GLuint m_countBuffer;
+  /// The draw commands.
+  GLuint m_commandBuffer;
+  /// The DrawData.
+  GLuint m_drawDataBuffer;
+  /// The buffer texture that reads m_drawDataBuffer ("uDrawData").
+  GLuint m_drawDataTexture;
+  /// A zero count per batch, to clear m_countBuffer with.
+  std::vector<GLuint> m_zeroCounts;
+};
+
+#endif//GPU_CULLER_HPP
@@ -0,0 +1,209 @@
+/// \file GpuProfiler.cpp
+/// \brief Definition of GpuProfiler class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <numeric>
+
+#include "GpuProfiler.hpp"
+
+namespace
+{
+  /// The fewest queries a frame makes at a time.
+  const std::size_t MIN_NEW_QUERIES = 16;
+
+  /// The number of nanoseconds (the unit of a timestamp) per millisecond.
+  const double NANOS_PER_MILLI = 1.0e6;
+}
+
+const unsigned int GpuProfiler::FRAME_LATENCY;
+
+GpuProfiler::GpuProfiler (OpenGLContext* context, std::size_t history)
+  : m_context (context), m_history (std::max<std::size_t> (history, 1)),
+    m_detailed (false), m_nextDetailed (false), m_frames (),
+    m_frame (FRAME_LATENCY - 1), m_inFrame (false), m_open (), m_scopeIndices (),
+    m_scopes (), m_timestamps (), m_totals (), m_resolved (0), m_dropped (0)
+{
+}
+
+GpuProfiler::~GpuProfiler ()
+{
+  for (Frame& frame : m_frames)
+    if (!frame.queries.empty ())
+      m_context->deleteQueries (frame.queries.size (), frame.queries.data ());
+}
+
+void
+GpuProfiler::setDetailed (bool detailed)
+{
+  m_nextDetailed = detailed;
+}
+
+bool
+GpuProfiler::isDetailed () const
+{
+  return m_detailed;
+}
+
+void
+GpuProfiler::beginFrame ()
+{
+  if (m_inFrame)
+    endFrame ();
+  m_frame = (m_frame + 1) % FRAME_LATENCY;
+  resolve (m_frames[m_frame]);
+  m_detailed = m_nextDetailed;
+  m_inFrame = true;
+  beginScope ("frame");
+}
+
+void
+GpuProfiler::endFrame ()
+{
+  if (!m_inFrame)
+    return;
+  Frame& frame = m_frames[m_frame];
+  while (!m_open.empty ())
+  {
+    frame.entries[m_open.back ()].end = writeTimestamp ();
+    m_open.pop_back ();
+  }
+  m_inFrame = false;
+}
+
+void
+GpuProfiler::beginScope (const char* name, bool detailed)
+{
+  if (!m_inFrame || (detailed && !m_detailed))
+    return;
+  Frame& frame = m_frames[m_frame];
+  unsigned int scope = getScope (name);
+  frame.entries.push_back (ScopeEntry { scope, writeTimestamp (), 0 });
+  m_open.push_back (frame.entries.size () - 1);
+}
+
+void
+GpuProfiler::endScope (bool detailed)
+{
+  // The frame's own scope is only ended by endFrame ().
+  if (!m_inFrame || (detailed && !m_detailed) || m_open.size () < 2)
+    return;
+  m_frames[m_frame].entries[m_open.back ()].end = writeTimestamp ();
+  m_open.pop_back ();
+}
+
+std::vector<GpuScopeStats>
+GpuProfiler::getStats () const
+{
+  std::vector<GpuScopeStats> stats;
+  std::vector<float> sorted;
+  for (const ScopeHistory& scope : m_scopes)
+  {
+    if (scope.millis.empty ())
+      continue;
+    sorted = scope.millis;
+    std::sort (sorted.begin (), sorted.end ());
+    std::size_t count = sorted.size ();
+    double sum = std::accumulate (sorted.begin (), sorted.end (), 0.0);
+    // The smallest time at least 99% of the frames are at or under.
+    std::size_t p99 = (99 * count + 99) / 100 - 1;
+    stats.push_back (GpuScopeStats { scope.name, count, sorted.front (), sum / count,
+                                     sorted[p99], sorted.back () });
+  }
+  return stats;
+}
+
+std::size_t
+GpuProfiler::getResolvedFrameCount () const
+{
+  return m_resolved;
+}
+
+std::size_t
+GpuProfiler::getDroppedFrameCount () const
+{
+  return m_dropped;
+}
+
+void
+GpuProfiler::reset ()
+{
+  for (ScopeHistory& scope : m_scopes)
+  {
+    scope.millis.clear ();
+    scope.next = 0;
+  }
+  m_resolved = 0;
+  m_dropped = 0;
+}
+
+unsigned int
+GpuProfiler::writeTimestamp ()
+{
+  Frame& frame = m_frames[m_frame];
+  if (frame.used == frame.queries.size ())
+  {
+    std::size_t count = std::max (frame.queries.size (), MIN_NEW_QUERIES);
+    frame.queries.resize (frame.used + count);
+    m_context->genQueries (count, &frame.queries[frame.used]);
+  }
+  m_context->queryCounter (frame.queries[frame.used], GL_TIMESTAMP);
+  return frame.used++;
+}
+
+void
+GpuProfiler::resolve (Frame& frame)
+{
+  if (frame.used > 0)
+  {
+    // The GPU writes timestamps in the order they were issued, so the last
+    //   being available means they all are.  Reading one that isn't would
+    //   stall until it is.
+    GLint available = GL_FALSE;
+    m_context->getQueryObjectiv (frame.queries[frame.used - 1], GL_QUERY_RESULT_AVAILABLE,
+                                 &available);
+    if (available == GL_FALSE)
+      ++m_dropped;
+    else
+    {
+      m_timestamps.resize (frame.used);
+      for (unsigned int i = 0; i < frame.used; ++i)
+        m_context->getQueryObjectui64v (frame.queries[i], GL_QUERY_RESULT, &m_timestamps[i]);
+      m_totals.assign (m_scopes.size (), -1.0);
+      for (const ScopeEntry& entry : frame.entries)
+      {
+        GLint64 nanos = static_cast<GLint64> (m_timestamps[entry.end] - m_timestamps[entry.begin]);
+        double& total = m_totals[entry.scope];
+        total = std::max (total, 0.0) + nanos / NANOS_PER_MILLI;
+      }
+      for (std::size_t i = 0; i < m_scopes.size (); ++i)
+      {
+        if (m_totals[i] < 0.0)
+          continue;
+        ScopeHistory& scope = m_scopes[i];
+        if (scope.millis.size () < m_history)
+          scope.millis.push_back (m_totals[i]);
+        else
+          scope.millis[scope.next] = m_totals[i];
+        scope.next = (scope.next + 1) % m_history;
+      }
+      ++m_resolved;
+    }
+  }
+  frame.used = 0;
+  frame.entries.clear ();
+}
+
+unsigned int
+GpuProfiler::getScope (const char* name)
+{
+  auto found = m_scopeIndices.find (name);
+  if (found != m_scopeIndices.end ())
+    return found->second;
+  unsigned int index = m_scopes.size ();
+  m_scopeIndices.emplace (name, index);
+  m_scopes.push_back (ScopeHistory { name, std::vector<float> (), 0 });
+  return index;
+}
@@ -0,0 +1,223 @@
+/// \file GpuProfiler.hpp
+/// \brief Declaration of GpuProfiler class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef GPU_PROFILER_HPP
+#define GPU_PROFILER_HPP
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+
+/// \brief The GPU time taken by a named scope, over the frames a GpuProfiler
+///   still remembers.
+struct GpuScopeStats
+{
+  /// The scope's name.
+  std::string name;
+  /// The number of frames the scope was timed in.
+  std::size_t frames;
+  /// The shortest time the scope took in a frame, in milliseconds.
+  double minMillis;
+  /// The mean time the scope took per frame, in milliseconds.
+  double averageMillis;
+  /// The time that 99% of those frames took no longer than, in milliseconds.
+  double p99Millis;
+  /// The longest time the scope took in a frame, in milliseconds.
+  double maxMillis;
+};
+
+/// \brief Times named scopes of GPU work (a clear, a render pass, one draw)
+///   with GL_TIMESTAMP queries, without ever waiting for the GPU.
+///
+/// Each frame's queries are only read back FRAME_LATENCY frames later, when
+///   beginFrame () comes around to reuse them.  By then the GPU has almost
+///   always finished with them; if it hasn't, that frame's times are dropped
+///   instead of waiting.  A scope's time in a frame is the sum over every
+///   time it was entered that frame, and the last so many of those sums are
+///   kept for each scope to compute its statistics from.
+///
+/// Timestamps are written as the GPU reaches them, so scopes may nest (the
+///   whole frame is always a scope, "frame").  Scopes marked as detailed,
+///   such as one per draw, cost two queries each, so they are only timed
+///   while setDetailed (true).  Code that draws through an OpenGLContext
+///   reaches its profiler with OpenGLContext::beginScope and
+///   OpenGLContext::endScope.
+class GpuProfiler
+{
+public:
+
+  /// The number of frames of queries in flight, and so how many frames late
+  ///   the times are.
+  static const unsigned int FRAME_LATENCY = 4;
+
+  /// \brief Constructs a GpuProfiler that has timed nothing.
+  /// \param[in] context The context to make queries through, which must
+  ///   outlive this.
+  /// \param[in] history The number of frames each scope's statistics are
+  ///   taken over.
+  explicit
+  GpuProfiler (OpenGLContext* context, std::size_t history = 300);
+
+  /// \brief Destructs a GpuProfiler, deleting its queries.
+  ~GpuProfiler ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   GpuProfilers.
+  GpuProfiler (const GpuProfiler&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   GpuProfilers.
+  GpuProfiler&
+  operator= (const GpuProfiler&) = delete;
+
+  /// \brief Chooses whether or not detailed scopes are timed.
+  /// \param[in] detailed Whether or not to time them, starting with the next
+  ///   frame.
+  void
+  setDetailed (bool detailed);
+
+  /// \brief Tests whether or not detailed scopes are being timed.
+  /// \return Whether or not this frame times them.
+  bool
+  isDetailed () const;
+
+  /// \brief Reads back the frame that was begun FRAME_LATENCY frames ago,
+  ///   if the GPU is done with it, and starts timing a new frame.
+  /// \pre This is the thread that owns the OpenGL context.
+  void
+  beginFrame ();
+
+  /// \brief Ends the frame begun by beginFrame (), along with any scope
+  ///   still open in it.
+  void
+  endFrame ();
+
+  /// \brief Starts timing a scope of the current frame.  Outside of a frame
+  ///   this does nothing.
+  /// \param[in] name The scope's name.  Every scope with the same name is
+  ///   counted together.
+  /// \param[in] detailed Whether or not the scope is only timed while
+  ///   isDetailed ().
+  void
+  beginScope (const char* name, bool detailed = false);
+
+  /// \brief Stops timing the scope begun most recently.
+  /// \param[in] detailed The value passed to the matching beginScope ().
+  void
+  endScope (bool detailed = false);
+
+  /// \brief Gets the statistics of every scope timed so far.
+  /// \return One entry per scope name, in the order they were first timed.
+  std::vector<GpuScopeStats>
+  getStats () const;
+
+  /// \brief Gets the number of frames whose times have been read back.
+  /// \return The count, since construction or the last reset ().
+  std::size_t
+  getResolvedFrameCount () const;
+
+  /// \brief Gets the number of frames whose times were dropped because the
+  ///   GPU hadn't finished them in time.
+  /// \return The count, since construction or the last reset ().
+  std::size_t
+  getDroppedFrameCount () const;
+
+  /// \brief Forgets every time read back so far.  Frames still in flight
+  ///   are kept.
+  void
+  reset ();
+
+private:
+
+  /// \brief One entry into a scope, as the positions of its two timestamps
+  ///   in its frame's queries.
+  struct ScopeEntry
+  {
+    /// The scope's index in m_scopes.
+    unsigned int scope;
+    /// The query written when the scope began.
+    unsigned int begin;
+    /// The query written when it ended.
+    unsigned int end;
+  };
+
+  /// \brief The queries of one frame in flight.
+  struct Frame
+  {
+    /// Every query this frame has used, kept to be reused.
+    std::vector<GLuint> queries;
+    /// The number of queries written this time around.
+    unsigned int used;
+    /// Every scope entered, in the order they began.
+    std::vector<ScopeEntry> entries;
+  };
+
+  /// \brief The times one scope took, per frame.
+  struct ScopeHistory
+  {
+    /// The scope's name.
+    std::string name;
+    /// The last (up to) m_history times, in milliseconds, as a ring.
+    std::vector<float> millis;
+    /// The position in millis that the next time goes.
+    std::size_t next;
+  };
+
+  /// \brief Writes a timestamp into the next query of the current frame,
+  ///   making more queries as needed.
+  /// \return The query's position in the frame's queries.
+  unsigned int
+  writeTimestamp ();
+
+  /// \brief Reads the times out of a frame's queries, unless the GPU
+  ///   hasn't written all of them yet, and empties the frame.
+  /// \param[in,out] frame The frame.
+  void
+  resolve (Frame& frame);
+
+  /// \brief Gets the index in m_scopes of a scope, adding it if needed.
+  /// \param[in] name The scope's name.
+  /// \return The index.
+  unsigned int
+  getScope (const char* name);
+
+  /// The context queries are made through.
+  OpenGLContext* m_context;
+  /// The number of times kept for each scope.
+  std::size_t m_history;
+  /// Whether or not detailed scopes are timed in the current frame.
+  bool m_detailed;
+  /// The value of m_detailed for the next frame.
+  bool m_nextDetailed;
+  /// The frames in flight, as a ring.
+  Frame m_frames[FRAME_LATENCY];
+  /// The position in m_frames of the current frame.
+  unsigned int m_frame;
+  /// Whether or not a frame has been begun but not ended.
+  bool m_inFrame;
+  /// The positions in the current frame's entries of the scopes still
+  ///   open, innermost last.
+  std::vector<unsigned int> m_open;
+  /// The index in m_scopes of each scope, by name.
+  std::map<std::string, unsigned int, std::less<>> m_scopeIndices;
+  /// Each scope's times, in the order they were first timed.
+  std::vector<ScopeHistory> m_scopes;
+  /// A scratch list of the timestamps of the frame being read back.
+  std::vector<GLuint64> m_timestamps;
+  /// A scratch list of each scope's total for the frame being read back,
+  ///   negative for scopes that weren't entered.
+  std::vector<double> m_totals;
+  /// The number of frames read back.
+  std::size_t m_resolved;
+  /// The number of frames dropped.
+  std::size_t m_dropped;
+};
+
+#endif//GPU_PROFILER_HPP
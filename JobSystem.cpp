@@ -0,0 +1,211 @@
+/// \file JobSystem.cpp
+/// \brief Definition of JobSystem and JobCounter classes and any associated
+///   global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+
+#include "JobSystem.hpp"
+
+namespace
+{
+  /// The JobSystem whose worker thread this is, if any.
+  thread_local const JobSystem* t_system = nullptr;
+  /// This thread's worker index within t_system.
+  thread_local unsigned int t_worker = 0;
+}
+
+JobCounter::JobCounter ()
+  : m_pending (0)
+{
+}
+
+JobCounter::~JobCounter ()
+{
+  // A job's finish () may still be inside m_mutex after the count it set to
+  //   zero was seen, so wait for it to leave.
+  std::lock_guard<std::mutex> lock (m_mutex);
+}
+
+bool
+JobCounter::isDone () const
+{
+  return m_pending.load () == 0;
+}
+
+JobSystem::JobSystem (unsigned int workerCount)
+  : m_queued (0), m_stopping (false)
+{
+  if (workerCount == 0)
+    workerCount = std::max (1u, std::thread::hardware_concurrency ());
+  for (unsigned int i = 0; i < workerCount; ++i)
+    m_workers.emplace_back (new Worker ());
+  for (unsigned int i = 1; i < workerCount; ++i)
+    m_threads.emplace_back (&JobSystem::workerLoop, this, i);
+}
+
+JobSystem::~JobSystem ()
+{
+  {
+    std::lock_guard<std::mutex> lock (m_sleepMutex);
+    m_stopping = true;
+  }
+  m_wake.notify_all ();
+  for (std::thread& thread : m_threads)
+    thread.join ();
+}
+
+unsigned int
+JobSystem::getWorkerCount () const
+{
+  return m_workers.size ();
+}
+
+unsigned int
+JobSystem::getCurrentWorker () const
+{
+  return (t_system == this) ? t_worker : 0;
+}
+
+void
+JobSystem::run (const Job& job, JobCounter* counter)
+{
+  if (counter != nullptr)
+    ++counter->m_pending;
+  push (getCurrentWorker (), Task { job, counter });
+}
+
+void
+JobSystem::runAfter (JobCounter& dependency, const Job& job,
+                     JobCounter* counter)
+{
+  if (counter != nullptr)
+    ++counter->m_pending;
+  {
+    // finish () reaches zero and drains the continuations under this lock,
+    //   so either it sees our continuation or we see zero.
+    std::lock_guard<std::mutex> lock (dependency.m_mutex);
+    if (dependency.m_pending.load () != 0)
+    {
+      dependency.m_continuations.emplace_back (job, counter);
+      return;
+    }
+  }
+  push (getCurrentWorker (), Task { job, counter });
+}
+
+void
+JobSystem::wait (JobCounter& counter)
+{
+  unsigned int self = getCurrentWorker ();
+  while (!counter.isDone ())
+  {
+    if (!runOne (self))
+      std::this_thread::yield ();
+  }
+}
+
+void
+JobSystem::parallelFor (unsigned int begin, unsigned int end,
+                        unsigned int grainSize, const RangeJob& body)
+{
+  if (begin >= end)
+    return;
+  grainSize = std::max (1u, grainSize);
+  if (end - begin <= grainSize || m_workers.size () == 1)
+  {
+    body (begin, end);
+    return;
+  }
+  JobCounter counter;
+  for (unsigned int first = begin; first < end; first += grainSize)
+  {
+    unsigned int last = std::min (end, first + grainSize);
+    run ([&body, first, last] () { body (first, last); }, &counter);
+  }
+  wait (counter);
+}
+
+void
+JobSystem::push (unsigned int worker, Task task)
+{
+  {
+    std::lock_guard<std::mutex> lock (m_workers[worker]->mutex);
+    m_workers[worker]->tasks.push_back (std::move (task));
+  }
+  ++m_queued;
+  {
+    // Taking the lock orders this wake-up after any worker that has just
+    //   decided to sleep, so the notification cannot be lost.
+    std::lock_guard<std::mutex> lock (m_sleepMutex);
+  }
+  m_wake.notify_one ();
+}
+
+bool
+JobSystem::runOne (unsigned int self)
+{
+  Task task;
+  bool found = false;
+  {
+    Worker& own = *m_workers[self];
+    std::lock_guard<std::mutex> lock (own.mutex);
+    if (!own.tasks.empty ())
+    {
+      task = std::move (own.tasks.back ());
+      own.tasks.pop_back ();
+      found = true;
+    }
+  }
+  for (unsigned int i = 1; !found && i < m_workers.size (); ++i)
+  {
+    Worker& victim = *m_workers[(self + i) % m_workers.size ()];
+    std::lock_guard<std::mutex> lock (victim.mutex);
+    if (!victim.tasks.empty ())
+    {
+      task = std::move (victim.tasks.front ());
+      victim.tasks.pop_front ();
+      found = true;
+    }
+  }
+  if (!found)
+    return false;
+
+  --m_queued;
+  task.job ();
+  finish (task.counter);
+  return true;
+}
+
+void
+JobSystem::finish (JobCounter* counter)
+{
+  if (counter == nullptr)
+    return;
+  std::vector<std::pair<Job, JobCounter*>> ready;
+  {
+    // Once the count reaches zero the counter may be destroyed, so it must
+    //   not be touched after this lock is released.
+    std::lock_guard<std::mutex> lock (counter->m_mutex);
+    if (--counter->m_pending != 0)
+      return;
+    ready.swap (counter->m_continuations);
+  }
+  for (std::pair<Job, JobCounter*>& next : ready)
+    push (getCurrentWorker (), Task { std::move (next.first), next.second });
+}
+
+void
+JobSystem::workerLoop (unsigned int self)
+{
+  t_system = this;
+  t_worker = self;
+  while (!m_stopping)
+  {
+    if (runOne (self))
+      continue;
+    std::unique_lock<std::mutex> lock (m_sleepMutex);
+    m_wake.wait (lock, [this] () { return m_stopping || m_queued > 0; });
+  }
+}
@@ -0,0 +1,214 @@
+/// \file JobSystem.hpp
+/// \brief Declaration of JobSystem and JobCounter classes and any associated
+///   global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef JOB_SYSTEM_HPP
+#define JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/// \brief A count of jobs that have not finished yet.
+///
+/// Every job started with a counter increments it, and decrements it when the
+///   job finishes.  Other jobs can be made to depend on a counter (see
+///   JobSystem::runAfter), and threads can wait for it to reach zero (see
+///   JobSystem::wait).
+class JobCounter
+{
+public:
+
+  /// \brief Constructs a counter with no pending jobs.
+  JobCounter ();
+
+  /// \brief Destructs a counter.
+  /// \pre No jobs are pending on or waiting for this counter.
+  ~JobCounter ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   JobCounters.
+  JobCounter (const JobCounter&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   JobCounters.
+  JobCounter&
+  operator= (const JobCounter&) = delete;
+
+  /// \brief Tests whether or not every job counted by this has finished.
+  /// \return Whether or not the count is zero.
+  bool
+  isDone () const;
+
+private:
+
+  friend class JobSystem;
+
+  /// The number of jobs that have been started but have not finished.
+  std::atomic<int> m_pending;
+  /// Protects m_continuations.
+  std::mutex m_mutex;
+  /// Jobs (and their own counters) to start once m_pending reaches zero.
+  std::vector<std::pair<std::function<void ()>, JobCounter*>> m_continuations;
+};
+
+/// \brief A pool of worker threads that run small jobs, balancing the load
+///   by work stealing.
+///
+/// Each worker has its own double-ended queue of jobs.  A worker pushes and
+///   pops jobs at the back of its own queue (so that the work it just created,
+///   whose data is still in its cache, runs next) and, when its queue is
+///   empty, steals from the front of another worker's queue.  The thread that
+///   creates the JobSystem is worker 0 and only runs jobs while it is inside
+///   wait () or parallelFor (); the other workers are threads owned by the
+///   JobSystem.  With a single worker, no threads are created and every job
+///   runs on the calling thread inside wait ().
+///
+/// Jobs must not make OpenGL calls, which are only legal on the thread that
+///   owns the context.
+class JobSystem
+{
+public:
+
+  /// A unit of work.
+  typedef std::function<void ()> Job;
+
+  /// \brief A loop body that handles the indexes [first, last).
+  typedef std::function<void (unsigned int first, unsigned int last)> RangeJob;
+
+  /// \brief Constructs a JobSystem.
+  /// \param[in] workerCount The number of workers, including the calling
+  ///   thread.  0 means one per hardware thread.
+  /// \post workerCount - 1 worker threads are running.
+  explicit
+  JobSystem (unsigned int workerCount = 0);
+
+  /// \brief Destructs a JobSystem.
+  /// \pre Every started job has been waited for.
+  /// \post The worker threads have been joined.
+  ~JobSystem ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   JobSystems.
+  JobSystem (const JobSystem&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   JobSystems.
+  JobSystem&
+  operator= (const JobSystem&) = delete;
+
+  /// \brief Gets the number of workers.
+  /// \return The number of threads (including the creating thread) that run
+  ///   jobs.
+  unsigned int
+  getWorkerCount () const;
+
+  /// \brief Gets the index of the worker running the calling thread.
+  /// \return A number less than getWorkerCount (), which is unique among the
+  ///   threads currently running jobs.  Threads that are not workers of this
+  ///   JobSystem get 0, the index of the creating thread.
+  unsigned int
+  getCurrentWorker () const;
+
+  /// \brief Starts a job.
+  /// \param[in] job The work to do.
+  /// \param[in] counter A counter to increment now and decrement when the job
+  ///   finishes, or nullptr.
+  /// \post The job is queued on the calling worker's queue.
+  void
+  run (const Job& job, JobCounter* counter = nullptr);
+
+  /// \brief Starts a job once every job counted by a dependency finishes.
+  /// \param[in] dependency The jobs that must finish first.
+  /// \param[in] job The work to do.
+  /// \param[in] counter A counter to increment now and decrement when the job
+  ///   finishes, or nullptr.
+  /// \post The job is queued now if dependency is done, and otherwise will be
+  ///   queued by whichever job brings dependency to zero.
+  void
+  runAfter (JobCounter& dependency, const Job& job,
+            JobCounter* counter = nullptr);
+
+  /// \brief Runs jobs until every job counted by a counter has finished.
+  /// \param[in] counter The jobs to wait for.
+  /// \post counter is done.
+  void
+  wait (JobCounter& counter);
+
+  /// \brief Splits a loop into jobs and runs them on every worker.
+  /// \param[in] begin The first index of the loop.
+  /// \param[in] end One past the last index of the loop.
+  /// \param[in] grainSize The largest number of indexes given to one job.
+  /// \param[in] body The loop body, which is called on disjoint ranges that
+  ///   together cover [begin, end), possibly at the same time.
+  /// \post Every index has been handled.
+  void
+  parallelFor (unsigned int begin, unsigned int end, unsigned int grainSize,
+               const RangeJob& body);
+
+private:
+
+  /// \brief A queued job and the counter it should decrement.
+  struct Task
+  {
+    /// The work to do.
+    Job job;
+    /// The counter to decrement afterwards, or nullptr.
+    JobCounter* counter;
+  };
+
+  /// \brief The queue belonging to a single worker.
+  struct Worker
+  {
+    /// Protects tasks.
+    std::mutex mutex;
+    /// Jobs waiting to run.  The owner uses the back and thieves the front.
+    std::deque<Task> tasks;
+  };
+
+  /// \brief Queues a task on a worker and wakes a sleeping worker.
+  /// \param[in] worker The worker whose queue gets the task.
+  /// \param[in] task The task to queue.
+  void
+  push (unsigned int worker, Task task);
+
+  /// \brief Runs one queued job, preferring the calling worker's own queue.
+  /// \param[in] self The index of the calling worker.
+  /// \return Whether or not a job was found.
+  bool
+  runOne (unsigned int self);
+
+  /// \brief Records that a job has finished.
+  /// \param[in] counter The job's counter, or nullptr.
+  /// \post If the counter reached zero, its continuations have been queued.
+  void
+  finish (JobCounter* counter);
+
+  /// \brief The body of each worker thread.
+  /// \param[in] self The index of the worker.
+  void
+  workerLoop (unsigned int self);
+
+  /// One queue per worker.
+  std::vector<std::unique_ptr<Worker>> m_workers;
+  /// The threads of workers 1 and up.
+  std::vector<std::thread> m_threads;
+  /// The number of jobs waiting in all queues.
+  std::atomic<int> m_queued;
+  /// Whether or not the workers should exit.
+  std::atomic<bool> m_stopping;
+  /// Protects sleeping, together with m_wake.
+  std::mutex m_sleepMutex;
+  /// Signalled whenever a job is queued or the workers should exit.
+  std::condition_variable m_wake;
+};
+
+#endif//JOB_SYSTEM_HPP
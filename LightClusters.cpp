@@ -0,0 +1,314 @@
+/// \file LightClusters.cpp
+/// \brief Definition of LightClusters class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#include "LightClusters.hpp"
+#include "LightSource.hpp"
+
+namespace
+{
+  /// The total number of clusters.
+  const unsigned int CLUSTER_COUNT = CLUSTER_GRID_X * CLUSTER_GRID_Y * CLUSTER_GRID_Z;
+
+  /// The smallest near plane distance used for slicing, since the slices are
+  ///   spaced by the log of the depth.
+  const float MIN_NEAR = 0.01f;
+
+  /// \brief Tests whether or not a sphere touches a box.
+  /// \param[in] center The sphere's center.
+  /// \param[in] radius The sphere's radius.
+  /// \param[in] min The box's smallest corner.
+  /// \param[in] max The box's largest corner.
+  /// \return Whether or not they overlap.
+  bool
+  sphereTouchesBox (const float center[3], float radius, const float min[3],
+                    const float max[3])
+  {
+    float distanceSquared = 0.0f;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+      float nearest = std::max (min[axis], std::min (center[axis], max[axis]));
+      float offset = center[axis] - nearest;
+      distanceSquared += offset * offset;
+    }
+    return distanceSquared <= radius * radius;
+  }
+}
+
+LightClusters::LightClusters (OpenGLContext* context)
+  : m_context (context), m_projection (), m_hasGrid (false),
+    m_perspective (true), m_near (MIN_NEAR), m_far (1.0f),
+    m_bounds (CLUSTER_COUNT), m_lists (CLUSTER_COUNT), m_grid (),
+    m_indices (), m_lights (), m_blockData (),
+    m_block (context, sizeof (ClusterBlock), CLUSTER_BLOCK_BINDING)
+{
+  const GLenum formats[3] = { GL_RG32UI, GL_R32UI, GL_RGBA32F };
+  m_context->createBuffers (3, m_buffers);
+  m_context->genTextures (3, m_textures);
+  for (int i = 0; i < 3; ++i)
+  {
+    // Give each buffer some storage, so the textures are complete before
+    //   the first update ().
+    m_context->namedBufferData (m_buffers[i], 16, nullptr, GL_STREAM_DRAW);
+    m_context->bindTexture (GL_TEXTURE_BUFFER, m_textures[i]);
+    m_context->texBuffer (GL_TEXTURE_BUFFER, formats[i], m_buffers[i]);
+  }
+  m_context->bindTexture (GL_TEXTURE_BUFFER, 0);
+}
+
+LightClusters::~LightClusters ()
+{
+  m_context->deleteTextures (3, m_textures);
+  m_context->deleteBuffers (3, m_buffers);
+}
+
+void
+LightClusters::update (const Matrix4& projectionMatrix,
+                       const std::vector<LightBlockEntry>& lights)
+{
+  updateGrid (projectionMatrix);
+
+  m_lights.clear ();
+  for (std::vector<GLuint>& list : m_lists)
+    list.clear ();
+  for (const LightBlockEntry& light : lights)
+  {
+    if (light.type == DIRECTIONAL)
+      continue;
+    if (m_lights.size () == MAX_CLUSTERED_LIGHTS)
+      break;
+    assign (light, m_lights.size ());
+    m_lights.push_back (light);
+  }
+
+  m_grid.clear ();
+  m_indices.clear ();
+  for (const std::vector<GLuint>& list : m_lists)
+  {
+    m_grid.push_back (m_indices.size ());
+    m_grid.push_back (list.size ());
+    m_indices.insert (m_indices.end (), list.begin (), list.end ());
+  }
+
+  upload (m_buffers[0], m_grid.data (), m_grid.size () * sizeof (GLuint));
+  upload (m_buffers[1], m_indices.data (), m_indices.size () * sizeof (GLuint));
+  upload (m_buffers[2], m_lights.data (), m_lights.size () * sizeof (LightBlockEntry));
+}
+
+void
+LightClusters::bind () const
+{
+  const GLuint units[3] = { CLUSTER_GRID_UNIT, CLUSTER_INDEX_UNIT, CLUSTER_LIGHT_UNIT };
+  for (int i = 0; i < 3; ++i)
+  {
+    m_context->activeTexture (GL_TEXTURE0 + units[i]);
+    m_context->bindTexture (GL_TEXTURE_BUFFER, m_textures[i]);
+  }
+  m_context->activeTexture (GL_TEXTURE0);
+  m_block.bind ();
+}
+
+unsigned int
+LightClusters::getLightCount () const
+{
+  return m_lights.size ();
+}
+
+unsigned int
+LightClusters::getIndexCount () const
+{
+  return m_indices.size ();
+}
+
+float
+LightClusters::getRange (const LightBlockEntry& light)
+{
+  float brightest = 0.0f;
+  for (int i = 0; i < 3; ++i)
+    brightest = std::max ({ brightest, light.diffuseIntensity[i],
+                            light.specularIntensity[i] });
+  // Solve brightest / (c + l d + q d^2) = LIGHT_CUTOFF for d.
+  float constant = light.attenuationCoefficients[0] - brightest / LIGHT_CUTOFF;
+  float linear = light.attenuationCoefficients[1];
+  float quadratic = light.attenuationCoefficients[2];
+  if (constant >= 0.0f)
+    return 0.0f;
+  if (quadratic > 0.0f)
+    return (-linear + std::sqrt (linear * linear - 4.0f * quadratic * constant))
+      / (2.0f * quadratic);
+  if (linear > 0.0f)
+    return -constant / linear;
+  return std::numeric_limits<float>::infinity ();
+}
+
+void
+LightClusters::updateGrid (const Matrix4& projectionMatrix)
+{
+  const float* p = projectionMatrix.data ();
+  if (m_hasGrid && std::memcmp (p, m_projection, sizeof (m_projection)) == 0)
+    return;
+  std::memcpy (m_projection, p, sizeof (m_projection));
+  m_hasGrid = true;
+
+  // A perspective projection copies -z into w.
+  m_perspective = p[11] != 0.0f;
+  if (m_perspective)
+  {
+    m_near = p[14] / (p[10] - 1.0f);
+    m_far = p[14] / (p[10] + 1.0f);
+  }
+  else
+  {
+    m_near = (p[14] + 1.0f) / p[10];
+    m_far = (p[14] - 1.0f) / p[10];
+  }
+  m_near = std::max (m_near, MIN_NEAR);
+  m_far = std::max (m_far, m_near * 2.0f);
+
+  float logRatio = std::log (m_far / m_near);
+  m_blockData.gridSize[0] = CLUSTER_GRID_X;
+  m_blockData.gridSize[1] = CLUSTER_GRID_Y;
+  m_blockData.gridSize[2] = CLUSTER_GRID_Z;
+  m_blockData.sliceScale = CLUSTER_GRID_Z / logRatio;
+  m_blockData.sliceBias = -std::log (m_near) * m_blockData.sliceScale;
+  m_block.update (&m_blockData);
+
+  for (unsigned int z = 0; z < CLUSTER_GRID_Z; ++z)
+  {
+    float depths[2] = { getSliceDepth (z), getSliceDepth (z + 1) };
+    for (unsigned int y = 0; y < CLUSTER_GRID_Y; ++y)
+    {
+      float ndcY[2] = { -1.0f + 2.0f * y / CLUSTER_GRID_Y,
+                        -1.0f + 2.0f * (y + 1) / CLUSTER_GRID_Y };
+      for (unsigned int x = 0; x < CLUSTER_GRID_X; ++x)
+      {
+        float ndcX[2] = { -1.0f + 2.0f * x / CLUSTER_GRID_X,
+                          -1.0f + 2.0f * (x + 1) / CLUSTER_GRID_X };
+        Bounds& bounds = m_bounds[x + CLUSTER_GRID_X * (y + CLUSTER_GRID_Y * z)];
+        bounds.min[0] = bounds.min[1] = std::numeric_limits<float>::max ();
+        bounds.max[0] = bounds.max[1] = -std::numeric_limits<float>::max ();
+        // Unproject the corners of the cluster's front and back faces.
+        for (float depth : depths)
+          for (int i = 0; i < 2; ++i)
+          {
+            float eyeX = m_perspective ? depth * (ndcX[i] + p[8]) / p[0]
+                                       : (ndcX[i] - p[12]) / p[0];
+            float eyeY = m_perspective ? depth * (ndcY[i] + p[9]) / p[5]
+                                       : (ndcY[i] - p[13]) / p[5];
+            bounds.min[0] = std::min (bounds.min[0], eyeX);
+            bounds.max[0] = std::max (bounds.max[0], eyeX);
+            bounds.min[1] = std::min (bounds.min[1], eyeY);
+            bounds.max[1] = std::max (bounds.max[1], eyeY);
+          }
+        // The camera looks down -z.
+        bounds.min[2] = -depths[1];
+        bounds.max[2] = -depths[0];
+      }
+    }
+  }
+}
+
+float
+LightClusters::getSliceDepth (unsigned int slice) const
+{
+  return m_near * std::pow (m_far / m_near, static_cast<float> (slice) / CLUSTER_GRID_Z);
+}
+
+unsigned int
+LightClusters::getSlice (float depth) const
+{
+  float slice = std::log (std::max (depth, m_near)) * m_blockData.sliceScale
+    + m_blockData.sliceBias;
+  // Clamp before converting, since the depth may be infinite.
+  return static_cast<unsigned int> (std::min (std::max (slice, 0.0f),
+                                              CLUSTER_GRID_Z - 1.0f));
+}
+
+unsigned int
+LightClusters::getTile (float ndc, unsigned int count)
+{
+  float tile = (ndc + 1.0f) * 0.5f * count;
+  return static_cast<unsigned int> (std::min (std::max (tile, 0.0f), count - 1.0f));
+}
+
+void
+LightClusters::assign (const LightBlockEntry& light, GLuint index)
+{
+  float radius = getRange (light);
+  if (radius <= 0.0f)
+    return;
+  const float* center = light.position;
+  float nearest = -center[2] - radius;
+  float farthest = -center[2] + radius;
+  if (farthest < m_near || nearest > m_far)
+    return;
+  // Widen the ranges by one, since rounding can land a sphere that only
+  //   grazes a boundary on the wrong side; the box test below trims them.
+  unsigned int firstZ = std::max (getSlice (nearest), 1u) - 1;
+  unsigned int lastZ = std::min (getSlice (farthest) + 1, CLUSTER_GRID_Z - 1);
+
+  // Find the tiles the sphere's eye-space box covers, at the depth where it
+  //   looks widest.
+  const float* p = m_projection;
+  float ndcMin[2];
+  float ndcMax[2];
+  for (int axis = 0; axis < 2; ++axis)
+  {
+    float scale = p[5 * axis];
+    float low = center[axis] - radius;
+    float high = center[axis] + radius;
+    if (!m_perspective)
+    {
+      ndcMin[axis] = scale * low + p[12 + axis];
+      ndcMax[axis] = scale * high + p[12 + axis];
+    }
+    else if (nearest <= m_near || std::isinf (radius))
+    {
+      // The sphere reaches the camera, so it may cover the whole view.
+      ndcMin[axis] = -1.0f;
+      ndcMax[axis] = 1.0f;
+    }
+    else
+    {
+      ndcMin[axis] = scale * std::min (low / nearest, low / farthest) - p[8 + axis];
+      ndcMax[axis] = scale * std::max (high / nearest, high / farthest) - p[8 + axis];
+    }
+  }
+  unsigned int firstX = std::max (getTile (ndcMin[0], CLUSTER_GRID_X), 1u) - 1;
+  unsigned int lastX = std::min (getTile (ndcMax[0], CLUSTER_GRID_X) + 1,
+                                 CLUSTER_GRID_X - 1);
+  unsigned int firstY = std::max (getTile (ndcMin[1], CLUSTER_GRID_Y), 1u) - 1;
+  unsigned int lastY = std::min (getTile (ndcMax[1], CLUSTER_GRID_Y) + 1,
+                                 CLUSTER_GRID_Y - 1);
+
+  for (unsigned int z = firstZ; z <= lastZ; ++z)
+    for (unsigned int y = firstY; y <= lastY; ++y)
+      for (unsigned int x = firstX; x <= lastX; ++x)
+      {
+        unsigned int cluster = x + CLUSTER_GRID_X * (y + CLUSTER_GRID_Y * z);
+        const Bounds& bounds = m_bounds[cluster];
+        if (sphereTouchesBox (center, radius, bounds.min, bounds.max))
+          m_lists[cluster].push_back (index);
+      }
+}
+
+void
+LightClusters::upload (GLuint buffer, const void* data, std::size_t size)
+{
+  // Buffer textures may not be empty, and replacing the whole store lets the
+  //   driver hand us fresh memory instead of waiting on last frame's.
+  const GLuint empty[4] = { 0, 0, 0, 0 };
+  if (size == 0)
+  {
+    data = empty;
+    size = sizeof (empty);
+  }
+  m_context->namedBufferData (buffer, size, data, GL_STREAM_DRAW);
+}
@@ -0,0 +1,195 @@
+/// \file LightClusters.hpp
+/// \brief Declaration of LightClusters class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef LIGHT_CLUSTERS_HPP
+#define LIGHT_CLUSTERS_HPP
+
+#include <vector>
+
+#include "OpenGLContext.hpp"
+#include "Matrix4.hpp"
+#include "UniformBuffer.hpp"
+
+/// The number of clusters across the view.
+const unsigned int CLUSTER_GRID_X = 16;
+
+/// The number of clusters down the view.
+const unsigned int CLUSTER_GRID_Y = 9;
+
+/// The number of depth slices between the near and far planes.
+const unsigned int CLUSTER_GRID_Z = 24;
+
+/// The largest number of point and spot lights that are clustered.
+const unsigned int MAX_CLUSTERED_LIGHTS = 1024;
+
+/// The texture unit of the cluster grid buffer texture ("uClusterGrid").
+const GLuint CLUSTER_GRID_UNIT = 4;
+
+/// The texture unit of the light index buffer texture
+///   ("uClusterLightIndices").
+const GLuint CLUSTER_INDEX_UNIT = 5;
+
+/// The texture unit of the light buffer texture ("uClusterLights").
+const GLuint CLUSTER_LIGHT_UNIT = 6;
+
+/// The intensity below which a light is considered to have no effect, which
+///   sets how far each light reaches.
+const float LIGHT_CUTOFF = 1.0f / 256.0f;
+
+/// \brief Divides the view frustum into a grid of clusters and lists the
+///   point and spot lights that can reach each one, so that a fragment only
+///   has to light itself with the lights of its own cluster.
+///
+/// Clusters are evenly spaced in normalized device coordinates across and
+///   down, and exponentially spaced in depth, so they stay roughly cube
+///   shaped.  Each light is treated as a sphere whose radius is the distance
+///   at which its attenuation brings it below LIGHT_CUTOFF.
+///
+/// The results live in three buffer textures that the clustered shader
+///   variant reads:
+///   - "uClusterGrid" (RG32UI): the first index and the number of lights of
+///     each cluster, for cluster x + X * (y + Y * z);
+///   - "uClusterLightIndices" (R32UI): the lists of light indices;
+///   - "uClusterLights" (RGBA32F): the lights, five texels each, laid out
+///     like LightBlockEntry.
+///   The grid's shape goes in the ClusterBlock, at CLUSTER_BLOCK_BINDING.
+class LightClusters
+{
+public:
+
+  /// \brief Constructs a LightClusters with no lights.
+  /// \param[in] context The context to make OpenGL calls through.
+  LightClusters (OpenGLContext* context);
+
+  /// \brief Destructs a LightClusters, deleting its buffers and textures.
+  ~LightClusters ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   LightClusters.
+  LightClusters (const LightClusters&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   LightClusters.
+  LightClusters&
+  operator= (const LightClusters&) = delete;
+
+  /// \brief Assigns lights to clusters and uploads the results.
+  /// \param[in] projectionMatrix The camera's projection matrix (perspective
+  ///   or orthographic).
+  /// \param[in] lights Lights in eye space.  Directional lights are skipped,
+  ///   as they reach every cluster; only the first MAX_CLUSTERED_LIGHTS of
+  ///   the rest are used.
+  /// \post The buffer textures and the ClusterBlock hold this frame's data.
+  void
+  update (const Matrix4& projectionMatrix,
+          const std::vector<LightBlockEntry>& lights);
+
+  /// \brief Binds the three buffer textures to their texture units, and the
+  ///   ClusterBlock to its binding point.
+  /// \post GL_TEXTURE0 is the active texture unit.
+  void
+  bind () const;
+
+  /// \brief Gets the number of lights clustered by the last update ().
+  /// \return The number of point and spot lights.
+  unsigned int
+  getLightCount () const;
+
+  /// \brief Gets the number of light indices written by the last update ().
+  /// \return The total length of every cluster's list.
+  unsigned int
+  getIndexCount () const;
+
+  /// \brief Computes how far a light reaches.
+  /// \param[in] light A point or spot light.
+  /// \return The distance at which the light's brightest color falls below
+  ///   LIGHT_CUTOFF, which may be infinite if it never does.
+  static float
+  getRange (const LightBlockEntry& light);
+
+private:
+
+  /// \brief An eye-space axis-aligned box.
+  struct Bounds
+  {
+    /// The smallest x, y, and z.
+    float min[3];
+    /// The largest x, y, and z.
+    float max[3];
+  };
+
+  /// \brief Recomputes the bounds of every cluster and the ClusterBlock, if
+  ///   the projection changed.
+  /// \param[in] projectionMatrix The camera's projection matrix.
+  void
+  updateGrid (const Matrix4& projectionMatrix);
+
+  /// \brief Gets the eye-space depth at which a slice begins.
+  /// \param[in] slice A slice, from 0 through CLUSTER_GRID_Z.
+  /// \return The depth, from m_near through m_far.
+  float
+  getSliceDepth (unsigned int slice) const;
+
+  /// \brief Gets the slice that holds an eye-space depth.
+  /// \param[in] depth A positive depth.
+  /// \return The slice, clamped to the grid.
+  unsigned int
+  getSlice (float depth) const;
+
+  /// \brief Gets the column or row that holds a normalized device
+  ///   coordinate.
+  /// \param[in] ndc The coordinate.
+  /// \param[in] count The number of columns or rows.
+  /// \return The column or row, clamped to the grid.
+  static unsigned int
+  getTile (float ndc, unsigned int count);
+
+  /// \brief Adds one light to the lists of every cluster it reaches.
+  /// \param[in] light The light.
+  /// \param[in] index The light's index in m_lights.
+  void
+  assign (const LightBlockEntry& light, GLuint index);
+
+  /// \brief Replaces the contents of a buffer.
+  /// \param[in] buffer The buffer.
+  /// \param[in] data The new contents.
+  /// \param[in] size The size of the new contents, in bytes.
+  void
+  upload (GLuint buffer, const void* data, std::size_t size);
+
+  /// The context to make OpenGL calls through.
+  OpenGLContext* m_context;
+  /// The projection the cluster bounds were computed for.
+  float m_projection[16];
+  /// Whether or not m_bounds have been computed.
+  bool m_hasGrid;
+  /// Whether or not the projection is a perspective one.
+  bool m_perspective;
+  /// The near plane's distance.
+  float m_near;
+  /// The far plane's distance.
+  float m_far;
+  /// The eye-space bounds of every cluster.
+  std::vector<Bounds> m_bounds;
+  /// The lights reaching each cluster, rebuilt by every update ().
+  std::vector<std::vector<GLuint>> m_lists;
+  /// The first index and light count of every cluster.
+  std::vector<GLuint> m_grid;
+  /// Every cluster's list, one after another.
+  std::vector<GLuint> m_indices;
+  /// The lights that were clustered.
+  std::vector<LightBlockEntry> m_lights;
+  /// The CPU copy of the ClusterBlock.
+  ClusterBlock m_blockData;
+  /// The ClusterBlock, at CLUSTER_BLOCK_BINDING.
+  UniformBuffer m_block;
+  /// The buffers behind the grid, index, and light textures.
+  GLuint m_buffers[3];
+  /// The grid, index, and light buffer textures.
+  GLuint m_textures[3];
+};
+
+#endif//LIGHT_CLUSTERS_HPP
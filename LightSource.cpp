@@ -5,6 +5,20 @@
 
 #include "LightSource.hpp"
 
+namespace
+{
+  /// \brief Copies a Vector3 into a vec3 of a uniform block.
+  /// \param[in] source The vector.
+  /// \param[out] destination The block's three floats.
+  void
+  copyVector (const Vector3& source, float destination[3])
+  {
+    destination[0] = source.m_x;
+    destination[1] = source.m_y;
+    destination[2] = source.m_z;
+  }
+}
+
 LightSource::LightSource (const Vector3& diffuseIntensity, const Vector3& specularIntensity)
   : m_diffuseIntensity (diffuseIntensity), m_specularIntensity (specularIntensity)
 {
@@ -17,10 +31,10 @@ LightSource::~LightSource ()
 }
 
 void
-LightSource::setUniforms (ShaderProgram* program, int lightNum)
+LightSource::writeBlock (LightBlockEntry& entry) const
 {
-    program->setUniformVector ("uLights[" + std::to_string(lightNum) + "].diffuseIntensity", m_diffuseIntensity);
-    program->setUniformVector ("uLights[" + std::to_string(lightNum) + "].specularIntensity", m_specularIntensity);
+    copyVector (m_diffuseIntensity, entry.diffuseIntensity);
+    copyVector (m_specularIntensity, entry.specularIntensity);
 }
 
 DirectionalLightSource::DirectionalLightSource (const Vector3& diffuseIntensity,
@@ -36,11 +50,11 @@ DirectionalLightSource::~DirectionalLightSource ()
 }
 
 void
-DirectionalLightSource::setUniforms (ShaderProgram* program, int lightNum)
+DirectionalLightSource::writeBlock (LightBlockEntry& entry) const
 {
-    LightSource::setUniforms (program, lightNum);
-    program->setUniformVector ("uLights[" + std::to_string(lightNum) + "].direction", m_direction);
-    program->setUniformInt ("uLights[" + std::to_string(lightNum) + "].type", LightType(DIRECTIONAL));
+    LightSource::writeBlock (entry);
+    copyVector (m_direction, entry.direction);
+    entry.type = LightType(DIRECTIONAL);
 }
 
 LocationLightSource::LocationLightSource (const Vector3& diffuseIntensity,
@@ -57,11 +71,11 @@ LocationLightSource::~LocationLightSource ()
 }
 
 void
-LocationLightSource::setUniforms (ShaderProgram* program, int lightNum)
+LocationLightSource::writeBlock (LightBlockEntry& entry) const
 {
-    LightSource::setUniforms (program, lightNum);
-    program->setUniformVector ("uLights[" + std::to_string(lightNum) + "].position", m_position);
-    program->setUniformVector ("uLights[" + std::to_string(lightNum) + "].attenuationCoefficients", m_attenuationCoefficients);
+    LightSource::writeBlock (entry);
+    copyVector (m_position, entry.position);
+    copyVector (m_attenuationCoefficients, entry.attenuationCoefficients);
 }
 
 PointLightSource::PointLightSource (const Vector3& diffuseIntensity,
@@ -77,10 +91,10 @@ PointLightSource::~PointLightSource ()
 }
 
 void
-PointLightSource::setUniforms (ShaderProgram* program, int lightNum)
+PointLightSource::writeBlock (LightBlockEntry& entry) const
 {
-    LocationLightSource::setUniforms (program, lightNum);
-    program->setUniformInt ("uLights[" + std::to_string(lightNum) + "].type", LightType(POINT));
+    LocationLightSource::writeBlock (entry);
+    entry.type = LightType(POINT);
 
 }
 
@@ -99,12 +113,12 @@ SpotLightSource::~SpotLightSource ()
 }
 
 void
-SpotLightSource::setUniforms (ShaderProgram* program, int lightNum)
+SpotLightSource::writeBlock (LightBlockEntry& entry) const
 {
-    LocationLightSource::setUniforms (program, lightNum);
-    program->setUniformVector ("uLights[" + std::to_string(lightNum) + "].direction", m_direction);
-    program->setUniformFloat ("uLights[" + std::to_string(lightNum) + "].cutoffCosAngle", m_cutoffCosAngle);
-    program->setUniformFloat ("uLights[" + std::to_string(lightNum) + "].falloff", m_falloff);
-    program->setUniformInt ("uLights[" + std::to_string(lightNum) + "].type", LightType(SPOT));
+    LocationLightSource::writeBlock (entry);
+    copyVector (m_direction, entry.direction);
+    entry.cutoffCosAngle = m_cutoffCosAngle;
+    entry.falloff = m_falloff;
+    entry.type = LightType(SPOT);
 
 }
\ No newline at end of file
@@ -9,14 +9,24 @@
 
 /******************************************************************/
 // System includes
+#include <cctype>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <string>
 #include <vector>
 
 /******************************************************************/
 // Local includes
 #include "RealOpenGLContext.hpp"
+#include "CachingOpenGLContext.hpp"
+#include "BudgetOpenGLContext.hpp"
+#include "DirectStateOpenGLContext.hpp"
+#include "RecordingOpenGLContext.hpp"
+#include "GpuProfiler.hpp"
 #include "ShaderProgram.hpp"
+#include "ProgramBinaryCache.hpp"
+#include "ShaderPermutations.hpp"
 #include "Mesh.hpp"
 #include "Scene.hpp"
 #include "MyScene.hpp"
@@ -25,6 +35,8 @@
 #include "Vector3.hpp"
 #include "KeyBuffer.hpp"
 #include "Transform.hpp"
+#include "TransformStore.hpp"
+#include "JobSystem.hpp"
 #include "MouseBuffer.hpp"
 
 /******************************************************************/
@@ -51,8 +63,51 @@
 
 /// \brief The OpenGLContext through which all OpenGL calls will be made.
 ///
+/// It drops calls that would not change any state, passing the rest on to
+///   ::g_budget.
 /// This should be allocated in ::init and deallocated in ::releaseGlResources.
-OpenGLContext* g_context;
+CachingOpenGLContext* g_context;
+
+/// \brief The OpenGLContext that makes the calls ::g_context passes on.
+///
+/// This should be allocated in ::init and deallocated in ::releaseGlResources.
+OpenGLContext* g_realContext;
+
+/// \brief The context that counts the GPU memory allocated by the calls
+///   ::g_context passes on, by what it holds, before passing them on to
+///   ::g_directState.
+///
+/// This should be allocated in ::init and deallocated in ::releaseGlResources.
+BudgetOpenGLContext* g_budget;
+
+/// \brief The context that passes the direct state access calls
+///   ::g_budget passes on to the driver, or emulates them if it hasn't
+///   got them.
+///
+/// This should be allocated in ::init and deallocated in ::releaseGlResources.
+DirectStateOpenGLContext* g_directState;
+
+/// \brief The context that records the calls ::g_directState passes on,
+///   between it and ::g_realContext, or null if no trace was asked for.
+///
+/// This should be allocated in ::init and deallocated in ::releaseGlResources.
+RecordingOpenGLContext* g_recorder = nullptr;
+
+/// \brief The profiler that times each frame's clear and render passes (and,
+///   in its detailed mode, each draw) on the GPU, attached to ::g_context.
+///
+/// This should be allocated in ::init and deallocated in ::releaseGlResources.
+GpuProfiler* g_profiler;
+
+/// \brief The file the trace is saved to, if one was asked for.
+std::string g_traceFile;
+
+/// \brief The number of frames to trace.
+unsigned int g_traceFrames = 300;
+
+/// \brief The GPU memory, in MiB, over which ::g_budget warns, or 0 for no
+///   limit.
+double g_budgetMebibytes = 0.0;
 
 // We use one VAO for each object we draw
 /// \brief A collection of the VAOs for each of the objects we want to draw.
@@ -63,6 +118,13 @@ OpenGLContext* g_context;
 
 SolarScene* g_scene; //scene used for project
 
+/// \brief The workers that do the Scene's per-frame CPU work (transforms,
+///   culling, and sorting) while this thread keeps the OpenGL context.
+///
+/// This should be allocated in ::initScene and deallocated in
+///   ::releaseGlResources, after the Scene.
+JobSystem* g_jobs;
+
 //MyScene* g_scene; use for default my scene
 
 /// \brief The ShaderProgram that transforms and lights the primitives.
@@ -73,10 +135,36 @@ ShaderProgram* g_shaderColorProgram;
 
 ShaderProgram* g_shaderNormProgram;
 
+/// \brief The ShaderProgram for GeneralShader, which no Scene currently uses,
+///   so it is only compiled if something enables it.
 ShaderProgram* g_shaderGenProgram;
 
 ShaderProgram* g_shaderPhongProgram;
 
+/// \brief The compute program that culls the Scene's lit Meshes on the GPU,
+///   or nullptr if the driver can't run it.
+///
+/// This should be allocated in ::initShaders and deallocated in
+///   ::releaseGlResources, after the Scene.
+ShaderProgram* g_cullProgram;
+
+/// \brief The variants of PhongShader specialized for the Scene's lights.
+///
+/// This should be allocated in ::initShaders and deallocated in
+///   ::releaseGlResources, after the Scene.
+ShaderPermutations* g_phongPermutations;
+
+/// \brief The cache that linked shader programs are loaded from and stored
+///   into, kept for as long as a program may still be built lazily.
+///
+/// This should be allocated in ::initShaders and deallocated in
+///   ::releaseGlResources.
+ProgramBinaryCache* g_shaderCache;
+
+/// \brief The time at which ::initShaders started, for ::finishShaders to
+///   report how long building the programs took.
+double g_shaderStartTime;
+
 /// \brief The Camera that views the Scene.
 ///
 /// This should be allocated in ::initCamera and deallocated in
@@ -99,6 +187,10 @@ float nearZ = 0.01f;
 // Far plane
 float farZ = 40.0f;
 
+/// \brief The directory, relative to where the program is run, that linked
+///   shader programs are cached in.
+const char* SHADER_CACHE_DIRECTORY = ".shadercache";
+
 /******************************************************************/
 // Function prototypes
 
@@ -135,10 +227,16 @@ resetViewport (GLFWwindow* window, int width, int height);
 void
 initScene ();
 
-/// \brief Creates the ShaderProgram.  Should only be called by ::init.
+/// \brief Starts building the ShaderPrograms.  Should only be called by
+///   ::init.
 void
 initShaders ();
 
+/// \brief Waits for the ShaderPrograms started by ::initShaders to finish
+///   building.  Should only be called by ::init.
+void
+finishShaders ();
+
 /// \brief Initializes the Camera.  Should only be called by ::init.
 void
 initCamera ();
@@ -181,6 +279,36 @@ processMouse (GLFWwindow* window);
 
 void processScroll (GLFWwindow* window, double xOff, double yOff);
 
+/// \brief Prints how many uniform uploads a program issued and how many its
+///   shadow state made unnecessary.
+/// \param[in] name A name for the program.
+/// \param[in] program The program.
+void
+reportUniformUploads (const char* name, const ShaderProgram* program);
+
+/// \brief Prints how many calls of each kind ::g_context passed on and how
+///   many it dropped.
+void
+reportContextCalls ();
+
+/// \brief Prints the GPU time each scope ::g_profiler timed took per frame.
+void
+reportGpuTimes ();
+
+/// \brief Prints how often the Scene's stream buffer waited for the GPU,
+///   if it has one.
+void
+reportStreamWaits ();
+
+/// \brief Prints the GPU memory ::g_budget counts, by category, and how
+///   full and how fragmented the Scene's geometry arena is.
+void
+reportMemory ();
+
+/// \brief Saves the trace and stops recording, if a trace is being made.
+void
+finishTrace ();
+
 /// \brief Cleans up all resources as program exits.
 void
 releaseGlResources ();
@@ -200,11 +328,38 @@ int g_resetSolar = 0;
 /******************************************************************/
 
 /// \brief Runs our program.
-/// \param[in] argc The number of command-line arguments, which we ignore.
-/// \param[in] argv The array of command-line-arguments, which we ignore.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The array of command-line-arguments, any of:
+///   - "--trace file [frames]" to save every OpenGL call from startup
+///     through that many frames (300 by default), for ReplayTrace.out;
+///   - "--budget MiB" to warn whenever more GPU memory than that is
+///     allocated.
 int
 main (int argc, char* argv[])
 {
+  for (int arg = 1; arg < argc; ++arg)
+  {
+    bool isTrace = std::strcmp (argv[arg], "--trace") == 0;
+    bool isBudget = std::strcmp (argv[arg], "--budget") == 0;
+    if (!isTrace && !isBudget)
+    {
+      fprintf (stderr, "Unrecognized argument \"%s\" -- exiting\n", argv[arg]);
+      exit (EXIT_FAILURE);
+    }
+    if (arg + 1 == argc)
+    {
+      fprintf (stderr, "%s needs a value -- exiting\n", argv[arg]);
+      exit (EXIT_FAILURE);
+    }
+    if (isTrace)
+    {
+      g_traceFile = argv[++arg];
+      if (arg + 1 < argc && std::isdigit (argv[arg + 1][0]))
+        g_traceFrames = std::atoi (argv[++arg]);
+    }
+    else
+      g_budgetMebibytes = std::atof (argv[++arg]);
+  }
   GLFWwindow* window;
   init (window);
 
@@ -240,14 +395,30 @@ main (int argc, char* argv[])
 void
 init (GLFWwindow*& window)
 {
-  g_context = new RealOpenGLContext ();
+  g_realContext = new RealOpenGLContext ();
+  // The trace holds the calls that reach the driver, after caching.
+  if (!g_traceFile.empty ())
+    g_recorder = new RecordingOpenGLContext (g_realContext);
+  g_directState = new DirectStateOpenGLContext (g_recorder != nullptr ? g_recorder
+                                                : g_realContext);
+  // The budget sees only the calls that reach the driver, so the bindings
+  //   it follows are the driver's.
+  g_budget = new BudgetOpenGLContext (g_directState);
+  g_budget->setBudget (static_cast<std::size_t> (g_budgetMebibytes * 1024 * 1024));
+  g_context = new CachingOpenGLContext (g_budget);
+  // The profiler's own queries go straight to the driver, so they are
+  //   neither cached nor traced.
+  g_profiler = new GpuProfiler (g_realContext);
+  g_context->setProfiler (g_profiler);
   // Always initialize GLFW before GLEW
   initGlfw ();
   initWindow (window);
   initGlew ();
   initShaders ();
   initCamera ();
+  // The driver keeps compiling while the Scene is built.
   initScene ();
+  finishShaders ();
 }
 
 /******************************************************************/
@@ -326,6 +497,9 @@ initGlew ()
   fprintf (stderr, "Using GLEW version %s.\n", version);
   version = g_context->getString (GL_VERSION);
   fprintf (stderr, "Using OpenGL version %s\n", version);
+  g_directState->setNative (GLEW_VERSION_4_5 || GLEW_ARB_direct_state_access);
+  if (!g_directState->isNative ())
+    fprintf (stderr, "Emulating direct state access.\n");
 }
 
 /******************************************************************/
@@ -345,6 +519,14 @@ void
 initScene ()
 {
   g_scene = new SolarScene (g_context, g_shaderColorProgram, g_shaderNormProgram, g_shaderPhongProgram, g_camera);
+  g_jobs = new JobSystem ();
+  g_scene->setJobSystem (g_jobs);
+  g_scene->setLightingPermutations (g_phongPermutations);
+  g_scene->setClusteredLighting (true);
+  // Drawing each material with one call needs gl_DrawID too.
+  g_scene->setMultiDrawIndirect ((GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect)
+                                 && GLEW_ARB_shader_draw_parameters);
+  g_scene->setGpuCulling (g_cullProgram);
 }
 
 /******************************************************************/
@@ -354,25 +536,58 @@ initShaders ()
 {
   // Create shader programs, which consist of linked shaders.
   // No need to use the program until we draw or set uniform variables.
+  // Linked programs are kept in a binary cache, so only the first run (or
+  //   the first after a shader or driver changes) has to compile them.
+  // The rest are all submitted before any is checked, so that a driver with
+  //   GL_KHR_parallel_shader_compile can compile them at the same time.
+  g_shaderStartTime = glfwGetTime ();
+  g_shaderCache = new ProgramBinaryCache (g_context, SHADER_CACHE_DIRECTORY);
+  if (GLEW_KHR_parallel_shader_compile)
+  {
+    // Let the driver pick how many threads to use.
+    g_context->maxShaderCompilerThreadsKHR (0xFFFFFFFF);
+    ShaderProgram::setParallelCompile (true);
+  }
+
   g_shaderColorProgram = new ShaderProgram (g_context);
-  g_shaderColorProgram->createVertexShader ("shaders/Vec3.vert");
-  g_shaderColorProgram->createFragmentShader ("shaders/Vec3.frag");
-  g_shaderColorProgram->link ();
+  g_shaderColorProgram->submit ("shaders/Vec3.vert", "shaders/Vec3.frag", g_shaderCache);
 
   g_shaderNormProgram = new ShaderProgram (g_context);
-  g_shaderNormProgram->createVertexShader ("shaders/Vec3Norm.vert");
-  g_shaderNormProgram->createFragmentShader ("shaders/Vec3.frag");
-  g_shaderNormProgram->link ();
+  g_shaderNormProgram->submit ("shaders/Vec3Norm.vert", "shaders/Vec3.frag", g_shaderCache);
 
   g_shaderGenProgram = new ShaderProgram (g_context);
-  g_shaderGenProgram->createVertexShader ("shaders/GeneralShader.vert");
-  g_shaderGenProgram->createFragmentShader ("shaders/GeneralShader.frag");
-  g_shaderGenProgram->link ();
+  g_shaderGenProgram->defer ("shaders/GeneralShader.vert", "shaders/GeneralShader.frag", g_shaderCache);
 
   g_shaderPhongProgram = new ShaderProgram (g_context);
-  g_shaderPhongProgram->createVertexShader ("shaders/PhongShader.vert");
-  g_shaderPhongProgram->createFragmentShader ("shaders/PhongShader.frag");
-  g_shaderPhongProgram->link ();
+  g_shaderPhongProgram->submit ("shaders/PhongShader.vert", "shaders/PhongShader.frag", g_shaderCache);
+  g_phongPermutations = new ShaderPermutations (g_context, "shaders/PhongShader.vert",
+                                                "shaders/PhongShader.frag", g_shaderCache);
+
+  // Culling on the GPU needs compute shaders, storage buffers, and the draw
+  //   count to come from a buffer, all of which llvmpipe has too.  It is
+  //   small, so it is built right away instead of through the cache.
+  g_cullProgram = nullptr;
+  if ((GLEW_VERSION_4_6 || GLEW_ARB_indirect_parameters) && GLEW_VERSION_4_3
+      && GLEW_ARB_shader_draw_parameters)
+  {
+    g_cullProgram = new ShaderProgram (g_context);
+    g_cullProgram->buildCompute ("shaders/CullDraws.comp");
+  }
+}
+
+/******************************************************************/
+
+void
+finishShaders ()
+{
+  g_shaderColorProgram->finish ();
+  g_shaderNormProgram->finish ();
+  g_shaderPhongProgram->finish ();
+
+  fprintf (stderr, "Built shader programs in %.1f ms (%u from the binary cache, %u compiled%s)\n",
+           1000.0 * (glfwGetTime () - g_shaderStartTime), g_shaderCache->getHits (),
+           g_shaderCache->getMisses (),
+           g_shaderCache->isEnabled () ? "" : "; program binaries are not supported");
 }
 
 /******************************************************************/
@@ -396,10 +611,20 @@ updateScene (double time)
 void
 drawScene (GLFWwindow* window)
 {
+  g_profiler->beginFrame ();
+  g_context->beginScope ("clear");
   g_context->clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+  g_context->endScope ();
   g_scene->draw(g_camera->getViewMatrix(), g_camera->getProjectionMatrix());
+  g_profiler->endFrame ();
 
   glfwSwapBuffers (window);
+  if (g_recorder != nullptr && g_recorder->isRecording ())
+  {
+    g_recorder->markFrame ();
+    if (g_recorder->getFrameCount () >= g_traceFrames)
+      finishTrace ();
+  }
 }
 
 
@@ -413,31 +638,47 @@ SolarMove(){
   g_camera->yaw(0.04);
   
   g_camera->moveRight(0.01);
-  g_scene->getMesh("earth")->yaw(0.80);
-  g_scene->getMesh("earth")->roll(0.20);
-  g_scene->getMesh("earth")->pitch(0.40);
-  g_scene->getMesh("mars")->roll(1.0);
-  g_scene->getMesh("mars")->moveUp(0.1);
-  g_scene->getMesh("asteroid2")->roll(0.90);
-  g_scene->getMesh("asteroid3")->roll(0.50);
-  g_scene->getMesh("asteroid1")->roll(-0.50);
-  g_scene->getMesh("asteroid4")->roll(-0.50);
-  g_scene->getMesh("asteroid5")->roll(-0.50);
-  g_scene->getMesh("asteroid5")->yaw(-0.50);
-   g_scene->getMesh("asteroid6")->roll(-0.50);
-  g_scene->getMesh("asteroid6")->yaw(-0.50);
-  g_scene->getMesh("asteroid1")->moveRight(-0.2);
-  g_scene->getMesh("asteroid2")->moveRight(-0.5);
-  g_scene->getMesh("asteroid3")->moveRight(0.1);
-  g_scene->getMesh("asteroid4")->moveRight(0.9);
-  g_scene->getMesh("asteroid5")->moveRight(0.5);
-  g_scene->getMesh("venus")->yaw(0.90);
-  g_scene->getMesh("venus")->roll(0.90);
-  g_scene->getMesh("jupiter")->roll(0.50);
-  g_scene->getMesh("jupiter")->pitch(0.30);
-  g_scene->getMesh("mercury")->yaw(0.50);
-  g_scene->getMesh("mercury")->roll(0.80);
-  g_scene->getMesh("mercury")->pitch(0.40);
+
+  // Each body's motion for this frame goes into one array per operation,
+  //   indexed by the body's transform node, so that every body is moved in
+  //   a single bulk pass per operation.
+  TransformStore& bodies = g_scene->getHierarchy ().getLocals ();
+  static std::vector<float> yaws, rolls, pitches, ups, rights;
+  for (std::vector<float>* amounts : { &yaws, &rolls, &pitches, &ups, &rights })
+    amounts->assign (bodies.getCapacity (), 0.0f);
+  auto node = [] (const char* name) { return g_scene->getMesh (name)->getNode (); };
+
+  yaws[node ("earth")] = 0.80f;
+  rolls[node ("earth")] = 0.20f;
+  pitches[node ("earth")] = 0.40f;
+  rolls[node ("mars")] = 1.0f;
+  ups[node ("mars")] = 0.1f;
+  rolls[node ("asteroid2")] = 0.90f;
+  rolls[node ("asteroid3")] = 0.50f;
+  rolls[node ("asteroid1")] = -0.50f;
+  rolls[node ("asteroid4")] = -0.50f;
+  rolls[node ("asteroid5")] = -0.50f;
+  yaws[node ("asteroid5")] = -0.50f;
+  rolls[node ("asteroid6")] = -0.50f;
+  yaws[node ("asteroid6")] = -0.50f;
+  rights[node ("asteroid1")] = -0.2f;
+  rights[node ("asteroid2")] = -0.5f;
+  rights[node ("asteroid3")] = 0.1f;
+  rights[node ("asteroid4")] = 0.9f;
+  rights[node ("asteroid5")] = 0.5f;
+  yaws[node ("venus")] = 0.90f;
+  rolls[node ("venus")] = 0.90f;
+  rolls[node ("jupiter")] = 0.50f;
+  pitches[node ("jupiter")] = 0.30f;
+  yaws[node ("mercury")] = 0.50f;
+  rolls[node ("mercury")] = 0.80f;
+  pitches[node ("mercury")] = 0.40f;
+
+  bodies.yawAll (yaws.data ());
+  bodies.rollAll (rolls.data ());
+  bodies.pitchAll (pitches.data ());
+  bodies.moveUpAll (ups.data ());
+  bodies.moveRightAll (rights.data ());
   ++g_resetSolar;
   if(g_resetSolar == 1200){
     g_camera->resetPose();
@@ -468,6 +709,39 @@ recordKeys (GLFWwindow* window, int key, int scanCode, int action,
     g_camera->setProjectionAsymmetricPerspective (-4.0f, 6.0f, -6.0f, 5.0f, 2.0, 20.0);
   else if (key == GLFW_KEY_O && action == GLFW_PRESS)
     g_camera->setProjectionOrthographic (-4.0f, 6.0f, -6.0f, 5.0f, 2.0f, 30.0f);
+  else if (key == GLFW_KEY_G && action == GLFW_PRESS)
+  {
+    g_scene->setClusteredLighting (!g_scene->isClusteredLighting ());
+    fprintf (stderr, "Clustered lighting %s\n",
+             g_scene->isClusteredLighting () ? "on" : "off");
+  }
+  else if (key == GLFW_KEY_H && action == GLFW_PRESS)
+  {
+    bool deferred = g_scene->getShadingPath () == Scene::DEFERRED_SHADING;
+    g_scene->setShadingPath (deferred ? Scene::FORWARD_SHADING : Scene::DEFERRED_SHADING);
+    fprintf (stderr, "%s shading\n", deferred ? "Forward" : "Deferred");
+  }
+  else if (key == GLFW_KEY_T && action == GLFW_PRESS)
+  {
+    // Reports the times so far, since per-draw scopes change them.
+    reportGpuTimes ();
+    g_profiler->reset ();
+    bool detailed = !g_profiler->isDetailed ();
+    g_profiler->setDetailed (detailed);
+    fprintf (stderr, "Per-draw GPU timing %s\n", detailed ? "on" : "off");
+  }
+  else if (key == GLFW_KEY_B && action == GLFW_PRESS)
+    reportMemory ();
+  else if (key == GLFW_KEY_V && action == GLFW_PRESS)
+  {
+    g_scene->getGeometryArena ().defragment ();
+    reportMemory ();
+  }
+  else if (key == GLFW_KEY_U && action == GLFW_PRESS && g_cullProgram != nullptr)
+  {
+    g_scene->setGpuCulling (g_scene->isGpuCulling () ? nullptr : g_cullProgram);
+    fprintf (stderr, "GPU culling %s\n", g_scene->isGpuCulling () ? "on" : "off");
+  }
 
 
   // Record keyboard input in regards to movement
@@ -590,18 +864,118 @@ processScroll (GLFWwindow* window, double xOff, double yOff)
 
 /******************************************************************/
 
+void
+reportUniformUploads (const char* name, const ShaderProgram* program)
+{
+  UniformUploadCounts counts = program->getUploadCounts ();
+  fprintf (stderr, "%s uniform uploads: %lu issued, %lu skipped\n", name,
+           counts.issued, counts.skipped);
+}
+
+void
+reportContextCalls ()
+{
+  for (int call = 0; call < CachingOpenGLContext::CACHED_CALL_COUNT; ++call)
+  {
+    auto kind = static_cast<CachingOpenGLContext::CachedCall> (call);
+    ContextCallCounts counts = g_context->getCallCounts (kind);
+    fprintf (stderr, "%s calls: %lu passed, %lu elided\n",
+             CachingOpenGLContext::getCallName (kind), counts.passed, counts.elided);
+  }
+}
+
+void
+reportGpuTimes ()
+{
+  fprintf (stderr, "GPU times over %zu frames (%zu dropped), in ms:\n",
+           g_profiler->getResolvedFrameCount (), g_profiler->getDroppedFrameCount ());
+  for (const GpuScopeStats& scope : g_profiler->getStats ())
+    fprintf (stderr, "  %-20s min %7.3f  avg %7.3f  p99 %7.3f\n", scope.name.c_str (),
+             scope.minMillis, scope.averageMillis, scope.p99Millis);
+}
+
+void
+reportStreamWaits ()
+{
+  const StreamBuffer* stream = g_scene->getStreamBuffer ();
+  if (stream == nullptr)
+    return;
+  StreamWaitStats waits = stream->getWaitStats ();
+  fprintf (stderr, "Stream buffer (%s): %lu fences, %lu stalls, %.3f ms stalled (max %.3f)\n",
+           stream->isMapped () ? "mapped" : "copied", waits.fences, waits.stalls,
+           waits.totalMillis, waits.maxMillis);
+}
+
+void
+reportMemory ()
+{
+  const double MEBIBYTE = 1024.0 * 1024.0;
+  fprintf (stderr, "GPU memory: %.2f MiB (peak %.2f", g_budget->getTotalBytes () / MEBIBYTE,
+           g_budget->getPeakBytes () / MEBIBYTE);
+  if (g_budget->getBudget () != 0)
+    fprintf (stderr, ", budget %.2f", g_budget->getBudget () / MEBIBYTE);
+  fprintf (stderr, ") in %zu buffers, %zu textures, and %zu vertex arrays\n",
+           g_budget->getBufferCount (), g_budget->getTextureCount (),
+           g_budget->getVertexArrayCount ());
+  for (int category = 0; category < BudgetOpenGLContext::MEMORY_CATEGORY_COUNT; ++category)
+  {
+    auto kind = static_cast<BudgetOpenGLContext::MemoryCategory> (category);
+    fprintf (stderr, "  %-8s %8.2f MiB\n", BudgetOpenGLContext::getCategoryName (kind),
+             g_budget->getLiveBytes (kind) / MEBIBYTE);
+  }
+  const GeometryArena& arena = g_scene->getGeometryArena ();
+  fprintf (stderr, "Geometry arena: %.2f of %.2f MiB used, %zu free ranges\n",
+           arena.getSize () / MEBIBYTE, arena.getCapacity () / MEBIBYTE,
+           arena.getFreeRangeCount ());
+}
+
 void
 releaseGlResources ()
 {
+  reportUniformUploads ("Vec3", g_shaderColorProgram);
+  reportUniformUploads ("Vec3Norm", g_shaderNormProgram);
+  reportUniformUploads ("GeneralShader", g_shaderGenProgram);
+  reportUniformUploads ("PhongShader", g_shaderPhongProgram);
+  reportContextCalls ();
+  reportGpuTimes ();
+  reportStreamWaits ();
+  reportMemory ();
+  finishTrace ();
+
   // Delete OpenGL resources, particularly important if program will
   //   continue running
   //g_context->deleteVertexArrays (g_vaos.size (), g_vaos.data ());
   delete g_scene;
+  delete g_jobs;
   delete g_camera;
   delete g_shaderColorProgram;
   delete g_shaderNormProgram;
   delete g_shaderGenProgram;
+  delete g_phongPermutations;
+  delete g_cullProgram;
+  delete g_shaderCache;
+  delete g_profiler;
   delete g_context;
+  delete g_budget;
+  delete g_directState;
+  delete g_recorder;
+  delete g_realContext;
+}
+
+/******************************************************************/
+
+void
+finishTrace ()
+{
+  if (g_recorder == nullptr || !g_recorder->isRecording ())
+    return;
+  g_recorder->setRecording (false);
+  if (g_recorder->save (g_traceFile))
+    fprintf (stderr, "Traced %zu calls in %zu frames (%.1f MiB) to %s\n",
+             g_recorder->getCallCount (), g_recorder->getFrameCount (),
+             g_recorder->getLog ().size () / (1024.0 * 1024.0), g_traceFile.c_str ());
+  // Nothing more will be recorded.
+  g_recorder->clear ();
 }
 
 /******************************************************************/
@@ -11,7 +11,8 @@
 Material::Material (Vector3 ambientReflection, Vector3 diffuseReflection,
     Vector3 specularReflection, Vector3 emissiveIntensity, float shininess)
   : m_ambient (ambientReflection), m_diffuse (diffuseReflection),
-    m_specular (specularReflection), m_emissive (emissiveIntensity), m_shininess (shininess)
+    m_specular (specularReflection), m_emissive (emissiveIntensity), m_shininess (shininess),
+    m_table (nullptr), m_tableIndex (-1), m_uniformProgram (nullptr), m_indexUniform { -1, 0, 0 }
 {
 
 }
@@ -24,9 +25,18 @@ Material::~Material ()
 void
 Material::setUniforms (ShaderProgram* shader)
 {
-  shader->setUniformVector ("uAmbientReflection", m_ambient);
-  shader->setUniformVector ("uDiffuseReflection", m_diffuse);
-  shader->setUniformVector ("uSpecularReflection", m_specular);
-  shader->setUniformFloat ("uSpecularPower", m_shininess);
-  shader->setUniformVector ("uEmmissiveIntensity", m_emissive);
-}
\ No newline at end of file
+  // Materials are nearly always used with a single program, so only look the
+  //   uniform up again when it changes.
+  if (shader != m_uniformProgram)
+  {
+    m_uniformProgram = shader;
+    m_indexUniform = shader->getUniformHandle ("uMaterialIndex");
+  }
+  shader->setUniformInt (m_indexUniform, m_tableIndex);
+}
+
+int
+Material::getTableIndex () const
+{
+  return m_tableIndex;
+}
@@ -9,6 +9,8 @@
 #include "Vector3.hpp"
 #include "ShaderProgram.hpp"
 
+class MaterialTable;
+
 class Material
 {
 public:
@@ -17,13 +19,36 @@ public:
 
     ~Material ();
 
+    /// \brief Selects this material in the MaterialBlock for the next draws.
+    /// \param[in] shader The enabled shader program.
+    /// \pre This material has been added to the Scene's MaterialTable.
+    /// \post "uMaterialIndex" is this material's index in the table.
     void
     setUniforms (ShaderProgram* shader);
 
+    /// \brief Gets this material's index in its MaterialTable.
+    /// \return The index, or -1 if it is not in a table.  A material that
+    ///   did not fit in a full table is drawn with index 0.
+    int
+    getTableIndex () const;
+
     Vector3 m_ambient;
     Vector3 m_diffuse;
     Vector3 m_specular;
     Vector3 m_emissive;
     float m_shininess;
+
+private:
+    friend class MaterialTable;
+
+    /// The MaterialTable this material is registered with, if any.
+    const MaterialTable* m_table;
+    /// The index of this material in m_table, 0 if it did not fit in a full
+    ///   table, or -1.
+    int m_tableIndex;
+    /// The program whose uniform handle is cached below, if any.
+    const ShaderProgram* m_uniformProgram;
+    /// The handle for uMaterialIndex in m_uniformProgram.
+    UniformHandle m_indexUniform;
 };
 #endif //MATERIAL_HPP
\ No newline at end of file
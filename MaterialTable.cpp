@@ -0,0 +1,107 @@
+/// \file MaterialTable.cpp
+/// \brief Definition of MaterialTable class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstdio>
+
+#include "MaterialTable.hpp"
+
+namespace
+{
+  /// \brief Copies a Vector3 into a vec3 of a uniform block.
+  /// \param[in] source The vector.
+  /// \param[out] destination The block's three floats.
+  void
+  copyVector (const Vector3& source, float destination[3])
+  {
+    destination[0] = source.m_x;
+    destination[1] = source.m_y;
+    destination[2] = source.m_z;
+  }
+}
+
+MaterialTable::MaterialTable (OpenGLContext* context)
+  : m_materials (), m_users (), m_free (), m_data (),
+    m_buffer (context, sizeof (MaterialBlock), MATERIAL_BLOCK_BINDING)
+{
+}
+
+MaterialTable::~MaterialTable ()
+{
+}
+
+unsigned int
+MaterialTable::add (Material* material)
+{
+  if (material->m_table == this)
+  {
+    ++m_users[material->m_tableIndex];
+    return material->m_tableIndex;
+  }
+  unsigned int index;
+  if (!m_free.empty ())
+  {
+    index = m_free.back ();
+    m_free.pop_back ();
+  }
+  else if (m_materials.size () < MAX_MATERIALS)
+  {
+    index = m_materials.size ();
+    m_materials.push_back (nullptr);
+    m_users.push_back (0);
+  }
+  else
+  {
+    fprintf (stderr, "Too many materials (at most %u); using material 0\n",
+             MAX_MATERIALS);
+    material->m_tableIndex = 0;
+    return 0;
+  }
+  m_materials[index] = material;
+  m_users[index] = 1;
+  material->m_table = this;
+  material->m_tableIndex = index;
+  return index;
+}
+
+void
+MaterialTable::remove (Material* material)
+{
+  if (material->m_table != this)
+    return;
+  unsigned int index = material->m_tableIndex;
+  if (--m_users[index] > 0)
+    return;
+  m_materials[index] = nullptr;
+  m_free.push_back (index);
+  material->m_table = nullptr;
+  material->m_tableIndex = -1;
+}
+
+unsigned int
+MaterialTable::size () const
+{
+  return m_materials.size () - m_free.size ();
+}
+
+void
+MaterialTable::update ()
+{
+  for (unsigned int i = 0; i < m_materials.size (); ++i)
+  {
+    // A freed entry keeps its last values; nothing draws with it.
+    if (m_materials[i] == nullptr)
+      continue;
+    const Material& material = *m_materials[i];
+    MaterialBlockEntry& entry = m_data.materials[i];
+    copyVector (material.m_ambient, entry.ambientReflection);
+    copyVector (material.m_diffuse, entry.diffuseReflection);
+    copyVector (material.m_specular, entry.specularReflection);
+    copyVector (material.m_emissive, entry.emissiveIntensity);
+    entry.specularPower = material.m_shininess;
+  }
+  m_buffer.update (&m_data);
+  m_buffer.bind ();
+}
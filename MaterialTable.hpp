@@ -0,0 +1,94 @@
+/// \file MaterialTable.hpp
+/// \brief Declaration of MaterialTable class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef MATERIAL_TABLE_HPP
+#define MATERIAL_TABLE_HPP
+
+#include <vector>
+
+#include "OpenGLContext.hpp"
+#include "Material.hpp"
+#include "UniformBuffer.hpp"
+
+/// \brief Every Material a Scene draws with, kept in one uniform buffer that
+///   all shader programs read (the MaterialBlock, at MATERIAL_BLOCK_BINDING).
+///
+/// Each registered Material gets a small index, and a draw only has to set
+///   "uMaterialIndex" (see Material::setUniforms) instead of every property
+///   of the material.  update () copies the Materials into the block and
+///   uploads only the entries that changed, so unchanged Materials cost
+///   nothing after their first frame.
+///
+/// The table does not own its Materials, and only holds on to one while it
+///   has users: each add () must be matched by a remove () before the
+///   Material is destroyed.  A Mesh in a Scene does this for its Material
+///   (see Mesh::attachToMaterialTable).  A Material belongs to at most one
+///   table at a time; once its last user has removed it, its index may be
+///   given to another Material, and it may be added to another table.
+class MaterialTable
+{
+public:
+
+  /// \brief Constructs an empty MaterialTable.
+  /// \param[in] context The context to make OpenGL calls through.
+  MaterialTable (OpenGLContext* context);
+
+  /// \brief Destructs a MaterialTable.  The Materials are not freed.
+  ~MaterialTable ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   MaterialTables.
+  MaterialTable (const MaterialTable&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   MaterialTables.
+  MaterialTable&
+  operator= (const MaterialTable&) = delete;
+
+  /// \brief Registers one more user of a Material.
+  /// \param[in] material The Material, which must not be destroyed before
+  ///   every add () of it has been matched by a remove (), and must not be
+  ///   registered with any other table.
+  /// \return The Material's index, which is also stored in the Material.
+  ///   If the table is full, an error is printed, the Material is not
+  ///   registered, and it is drawn with (and returns) index 0.
+  unsigned int
+  add (Material* material);
+
+  /// \brief Unregisters one user of a Material.  Once the last user is
+  ///   gone, the table lets go of the Material and its index may be reused.
+  /// \param[in] material The Material, which is ignored if it is not
+  ///   registered with this table.
+  /// \post If this was its last user, the Material's index is -1.
+  void
+  remove (Material* material);
+
+  /// \brief Gets the number of registered Materials.
+  /// \return The number of entries in use.
+  unsigned int
+  size () const;
+
+  /// \brief Copies every registered Material into the uniform buffer.
+  /// \post The MaterialBlock matches the Materials' current properties, and
+  ///   is bound to MATERIAL_BLOCK_BINDING.
+  void
+  update ();
+
+private:
+
+  /// The registered Materials, by index, with nullptr for a free index.
+  std::vector<Material*> m_materials;
+  /// The number of users of each registered Material, by index.
+  std::vector<unsigned int> m_users;
+  /// The indexes that have been freed by remove (), for add () to reuse.
+  std::vector<unsigned int> m_free;
+  /// The CPU copy of the MaterialBlock.
+  MaterialBlock m_data;
+  /// The MaterialBlock.
+  UniformBuffer m_buffer;
+};
+
+#endif//MATERIAL_TABLE_HPP
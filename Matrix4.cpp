@@ -119,6 +119,20 @@ Matrix4::setToOrthographicProjection (double left, double right,
     m_translation.m_z = (nearPlaneZ + farPlaneZ) / (nearPlaneZ - farPlaneZ);
 }
 
+Matrix4
+operator* (const Matrix4& m1, const Matrix4& m2)
+{
+    return Matrix4 (m1 * m2.getRight (), m1 * m2.getUp (),
+                    m1 * m2.getBack (), m1 * m2.getTranslation ());
+}
+
+Vector4
+operator* (const Matrix4& m, const Vector4& v)
+{
+    return m.getRight () * v.m_x + m.getUp () * v.m_y
+        + m.getBack () * v.m_z + m.getTranslation () * v.m_w;
+}
+
 std::ostream&
 operator<< (std::ostream& out, const Matrix4& m)
 {
@@ -135,4 +149,20 @@ bool
 operator== (const Matrix4& m1, const Matrix4& m2)
 {
     return m1.getRight () == m2.getRight () && m1.getUp () == m2.getUp () && m1.getBack () == m2.getBack () && m1.getTranslation () == m2.getTranslation ();
-}
\ No newline at end of file
+}
+
+Matrix3
+getNormalMatrix (const Matrix4& m)
+{
+  const float* data = m.data ();
+  Vector3 right (data[0], data[1], data[2]);
+  Vector3 up (data[4], data[5], data[6]);
+  Vector3 back (data[8], data[9], data[10]);
+  // The rows of the inverse, and so the columns of its transpose, are the
+  //   cross products of pairs of columns over the determinant.
+  Vector3 upCrossBack = up.cross (back);
+  float determinant = right.dot (upCrossBack);
+  float scale = (determinant == 0.0f) ? 0.0f : 1.0f / determinant;
+  return Matrix3 (scale * upCrossBack, scale * back.cross (right),
+                  scale * right.cross (up));
+}
@@ -11,6 +11,7 @@
 
 // Local includes.
 #include "Vector4.hpp"
+#include "Matrix3.hpp"
 
 /// \brief A 4x4 matrix of floats.
 /// Basis vectors (right, up, back, and translate) are stored in Vector4s and
@@ -124,6 +125,20 @@ private:
   Vector4 m_translation;
 };
 
+/// \brief Multiplies two matrices.
+/// \param[in] m1 The matrix on the left.
+/// \param[in] m2 The matrix on the right.
+/// \return The product m1 * m2.
+Matrix4
+operator* (const Matrix4& m1, const Matrix4& m2);
+
+/// \brief Multiplies a matrix by a column vector.
+/// \param[in] m A matrix.
+/// \param[in] v A column vector.
+/// \return The product m * v.
+Vector4
+operator* (const Matrix4& m, const Vector4& v);
+
 /// \brief Inserts a matrix into an output stream.
 /// Each element of the matrix should have 2 digits of precision and a field
 ///   width of 10.  Elements should be in this order:
@@ -147,4 +162,11 @@ operator<< (std::ostream& out, const Matrix4& m);
 bool
 operator== (const Matrix4& m1, const Matrix4& m2);
 
+/// \brief Computes the matrix that transforms normals the way a matrix
+///   transforms points: the inverse transpose of its upper-left 3x3.
+/// \param[in] m A matrix, usually a model-view matrix.
+/// \return The normal matrix, or the zero matrix if m is singular.
+Matrix3
+getNormalMatrix (const Matrix4& m);
+
 #endif//MATRIX4_HPP
@@ -3,29 +3,38 @@
 /// \author Ryan Ganzke
 /// \version A02
 
+#include <algorithm>
+#include <cmath>
+
 #include "Mesh.hpp"
 
+const unsigned int Mesh::VERTEX_STRIDE = 6;
+
 Mesh::Mesh (OpenGLContext* context, ShaderProgram* shader)
-  : m_context (context), m_world (), m_shader (shader)
+  : m_shader (shader), m_vao (0), m_range (nullptr),
+    m_levels (1, LevelOfDetail { 0.0f, 0, 0 }), m_lodIndices (),
+    m_arena (nullptr), m_ownArena (nullptr), m_world (), m_context (context),
+    m_mat (nullptr), m_materialTable (nullptr), m_hierarchy (nullptr), m_node (TransformHierarchy::NO_PARENT),
+    m_boundsCenter (), m_boundsRadius (0.0f), m_name ("mesh")
 {
-  m_context->genVertexArrays (1, &m_vao);
-  m_context->genBuffers (1, &m_vbo);
-  m_context->genBuffers (1, &m_ibo);
 }
 
 Mesh::Mesh (OpenGLContext* context, ShaderProgram* shader, Material* material)
-  : m_context (context), m_world (), m_shader (shader), m_mat (material)
+  : m_shader (shader), m_vao (0), m_range (nullptr),
+    m_levels (1, LevelOfDetail { 0.0f, 0, 0 }), m_lodIndices (),
+    m_arena (nullptr), m_ownArena (nullptr), m_world (), m_context (context),
+    m_mat (material), m_materialTable (nullptr), m_hierarchy (nullptr), m_node (TransformHierarchy::NO_PARENT),
+    m_boundsCenter (), m_boundsRadius (0.0f), m_name ("mesh")
 {
-  m_context->genVertexArrays (1, &m_vao);
-  m_context->genBuffers (1, &m_vbo);
-  m_context->genBuffers (1, &m_ibo);
 }
 
 Mesh::~Mesh ()
 {
-  m_context->deleteVertexArrays (1, &m_vao);
-  m_context->deleteBuffers (1, &m_vbo);
-  m_context->deleteBuffers (1, &m_ibo);
+  detachFromHierarchy ();
+  detachFromMaterialTable ();
+  if (m_range != nullptr)
+    m_arena->release (m_range);
+  delete m_ownArena;
 }
 
 void
@@ -37,17 +46,57 @@ Mesh::addGeometry (const std::vector<float>& geometry)
 void
 Mesh::prepareVao ()
 {
-  m_context->bindVertexArray (m_vao);
-
-  m_context->bindBuffer (GL_ARRAY_BUFFER, m_vbo);
-  m_context->bufferData (GL_ARRAY_BUFFER, m_data.size () * sizeof(float),
-			 m_data.data (), GL_STATIC_DRAW);
-
-  m_context->bindBuffer (GL_ELEMENT_ARRAY_BUFFER, m_ibo);
-  m_context->bufferData (GL_ELEMENT_ARRAY_BUFFER, m_indices.size () * sizeof(unsigned int),
-			 m_indices.data (), GL_STATIC_DRAW);
-
-  enableAttributes ();
+  if (m_arena == nullptr)
+  {
+    m_ownArena = new GeometryArena (m_context);
+    m_arena = m_ownArena;
+  }
+  // Every Mesh of a format shares the arena's VAO, so only the first one
+  //   sets it up.
+  bool created;
+  m_vao = m_arena->getVertexArray (getVertexFormat (), VERTEX_STRIDE * sizeof(float),
+                                   created);
+  if (created)
+    enableAttributes ();
+  // The coarser levels' indices follow the full ones, in the same range.
+  m_levels[0].indexCount = m_indices.size ();
+  GLuint first = 0;
+  for (LevelOfDetail& level : m_levels)
+  {
+    level.firstIndex = first;
+    first += level.indexCount;
+  }
+  if (m_lodIndices.empty ())
+    m_range = m_arena->allocate (getVertexFormat (), m_data, m_indices);
+  else
+  {
+    std::vector<unsigned int> indices (m_indices);
+    indices.insert (indices.end (), m_lodIndices.begin (), m_lodIndices.end ());
+    m_range = m_arena->allocate (getVertexFormat (), m_data, indices);
+    m_lodIndices.clear ();
+  }
+
+  if (m_data.size () < VERTEX_STRIDE)
+    return;
+  Vector3 low (m_data[0], m_data[1], m_data[2]);
+  Vector3 high = low;
+  for (unsigned int i = 0; i + 2 < m_data.size (); i += VERTEX_STRIDE)
+  {
+    low.m_x = std::min (low.m_x, m_data[i]);
+    low.m_y = std::min (low.m_y, m_data[i + 1]);
+    low.m_z = std::min (low.m_z, m_data[i + 2]);
+    high.m_x = std::max (high.m_x, m_data[i]);
+    high.m_y = std::max (high.m_y, m_data[i + 1]);
+    high.m_z = std::max (high.m_z, m_data[i + 2]);
+  }
+  m_boundsCenter = (low + high) / 2.0f;
+  m_boundsRadius = 0.0f;
+  for (unsigned int i = 0; i + 2 < m_data.size (); i += VERTEX_STRIDE)
+  {
+    Vector3 offset (m_data[i], m_data[i + 1], m_data[i + 2]);
+    offset -= m_boundsCenter;
+    m_boundsRadius = std::max (m_boundsRadius, offset.length ());
+  }
 }
 
 void
@@ -55,128 +104,370 @@ Mesh::draw (const Transform &viewMatrix, const Matrix4& projectionMatrix)
 {
   m_shader->enable ();
 
-  m_shader->setUniformMatrix ("uProjection", projectionMatrix);
-  m_shader->setUniformMatrix ("uModelView", (viewMatrix * m_world).getTransform ());
-  m_shader->setUniformMatrix ("uWorld", m_world.getTransform ());
-  m_shader->setUniformMatrix ("uView", viewMatrix.getTransform ());
+  // The projection and view matrices come from the camera uniform block.
+  // The world transform was already cached by the hierarchy this frame.
+  Matrix4 world = (m_hierarchy != nullptr) ? m_hierarchy->getWorldMatrix (m_node)
+                                           : m_world.getTransform ();
+  Matrix4 modelView = viewMatrix.getTransform () * world;
+  m_shader->setUniformMatrix ("uModelView", modelView);
+  m_shader->setUniformMatrix ("uWorld", world);
+  m_shader->setUniformMatrix ("uModelViewProjection", projectionMatrix * modelView);
+  m_shader->setUniformMatrix ("uNormalMatrix", getNormalMatrix (modelView));
 
-  m_shader->setUniformVector ("uAmbientIntensity", Vector3 (0.5f, 0.5f, 0.5f));
-
-  m_mat->setUniforms (m_shader);
+  if (m_mat != nullptr)
+    m_mat->setUniforms (m_shader);
 
+  const LevelOfDetail& level = m_levels[selectLevelOfDetail (modelView)];
   m_context->bindVertexArray (m_vao);
-  m_context->drawElements (GL_TRIANGLES, m_indices.size (), GL_UNSIGNED_INT, reinterpret_cast<void*> (0));
+  m_context->beginScope (m_name.c_str (), true);
+  m_context->drawElements (GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT,
+                           reinterpret_cast<void*> ((m_range->firstIndex + level.firstIndex)
+                                                    * sizeof (GLuint)));
+  m_context->endScope (true);
   m_context->bindVertexArray (0);
 
   m_shader->disable ();
 }
 
+void
+Mesh::record (const Matrix4& viewMatrix, const Matrix4& projectionMatrix,
+              ShaderProgram* program, uint64_t sortKey,
+              RenderCommandBuffer& buffer) const
+{
+  DrawPacket packet;
+  packet.sortKey = sortKey;
+  packet.name = m_name.c_str ();
+  packet.program = program;
+  packet.material = m_mat;
+  packet.vao = m_vao;
+  Matrix4 world = (m_hierarchy != nullptr) ? m_hierarchy->getWorldMatrix (m_node)
+                                           : m_world.getTransform ();
+  Matrix4 modelView = viewMatrix * world;
+  const LevelOfDetail& level = m_levels[selectLevelOfDetail (modelView)];
+  packet.indexCount = level.indexCount;
+  packet.firstIndex = m_range->firstIndex + level.firstIndex;
+  // Computed here, once per draw, so no shader has to multiply or invert
+  //   matrices per vertex.
+  Matrix4 modelViewProjection = projectionMatrix * modelView;
+  Matrix3 normalMatrix = getNormalMatrix (modelView);
+  std::copy (world.data (), world.data () + 16, packet.world);
+  std::copy (modelView.data (), modelView.data () + 16, packet.modelView);
+  std::copy (modelViewProjection.data (), modelViewProjection.data () + 16,
+             packet.modelViewProjection);
+  std::copy (normalMatrix.data (), normalMatrix.data () + 9, packet.normalMatrix);
+  buffer.record (packet);
+}
+
+void
+Mesh::setArena (GeometryArena* arena)
+{
+  m_arena = arena;
+}
+
+GeometryArena*
+Mesh::getArena () const
+{
+  return m_arena;
+}
+
+bool
+Mesh::isPrepared () const
+{
+  return m_vao != 0;
+}
+
+void
+Mesh::setName (const std::string& name)
+{
+  m_name = name;
+}
+
+const std::string&
+Mesh::getName () const
+{
+  return m_name;
+}
+
 Transform
 Mesh::getWorld () const
 {
+  if (m_hierarchy != nullptr)
+    return m_hierarchy->getWorld (m_node);
   return m_world;
 }
 
+void
+Mesh::attachToHierarchy (TransformHierarchy* hierarchy)
+{
+  detachFromHierarchy ();
+  m_hierarchy = hierarchy;
+  m_node = m_hierarchy->add (m_world);
+}
+
+void
+Mesh::detachFromHierarchy ()
+{
+  if (m_hierarchy == nullptr)
+    return;
+  m_world = m_hierarchy->getLocal (m_node);
+  m_hierarchy->remove (m_node);
+  m_hierarchy = nullptr;
+  m_node = TransformHierarchy::NO_PARENT;
+}
+
+TransformHierarchy*
+Mesh::getHierarchy () const
+{
+  return m_hierarchy;
+}
+
+unsigned int
+Mesh::getNode () const
+{
+  return m_node;
+}
+
+void
+Mesh::setMaterial (Material* mat)
+{
+  // Add the new material first, so that setting the same one again doesn't
+  //   free its index.
+  if (m_materialTable != nullptr && mat != nullptr)
+    m_materialTable->add (mat);
+  if (m_materialTable != nullptr && m_mat != nullptr)
+    m_materialTable->remove (m_mat);
+  m_mat = mat;
+}
+
+void
+Mesh::attachToMaterialTable (MaterialTable* table)
+{
+  detachFromMaterialTable ();
+  m_materialTable = table;
+  if (m_mat != nullptr)
+    m_materialTable->add (m_mat);
+}
+
+void
+Mesh::detachFromMaterialTable ()
+{
+  if (m_materialTable == nullptr)
+    return;
+  if (m_mat != nullptr)
+    m_materialTable->remove (m_mat);
+  m_materialTable = nullptr;
+}
+
+Material*
+Mesh::getMaterial () const
+{
+  return m_mat;
+}
+
+ShaderProgram*
+Mesh::getShader () const
+{
+  return m_shader;
+}
+
+Vector3
+Mesh::getBoundsCenter () const
+{
+  return m_boundsCenter;
+}
+
+const std::vector<float>&
+Mesh::getVertexData () const
+{
+  return m_data;
+}
+
+const std::vector<unsigned int>&
+Mesh::getIndices () const
+{
+  return m_indices;
+}
+
+void
+Mesh::setOccluderShape (const std::vector<Triangle>& triangles)
+{
+  m_occluderData.clear ();
+  m_occluderIndices.clear ();
+  for (const Triangle& triangle : triangles)
+  {
+    for (const Vector3& corner : triangle)
+    {
+      m_occluderIndices.push_back (m_occluderIndices.size ());
+      m_occluderData.insert (m_occluderData.end (), { corner.m_x, corner.m_y, corner.m_z });
+    }
+  }
+}
+
+const std::vector<float>&
+Mesh::getOccluderVertices () const
+{
+  return m_occluderIndices.empty () ? m_data : m_occluderData;
+}
+
+unsigned int
+Mesh::getOccluderStride () const
+{
+  return m_occluderIndices.empty () ? VERTEX_STRIDE : 3;
+}
+
+const std::vector<unsigned int>&
+Mesh::getOccluderIndices () const
+{
+  return m_occluderIndices.empty () ? m_indices : m_occluderIndices;
+}
+
+float
+Mesh::getBoundsRadius () const
+{
+  return m_boundsRadius;
+}
+
 void
 Mesh::moveRight (float distance)
 {
-  m_world.moveRight (distance);
+  if (m_hierarchy != nullptr)
+    m_hierarchy->getLocals ().moveRight (m_node, distance);
+  else
+    m_world.moveRight (distance);
 }
 
 void
 Mesh::moveUp (float distance)
 {
-  m_world.moveUp (distance);
+  if (m_hierarchy != nullptr)
+    m_hierarchy->getLocals ().moveUp (m_node, distance);
+  else
+    m_world.moveUp (distance);
 }
 
 void
 Mesh::moveBack (float distance)
 {
-  m_world.moveBack (distance);
+  if (m_hierarchy != nullptr)
+    m_hierarchy->getLocals ().moveBack (m_node, distance);
+  else
+    m_world.moveBack (distance);
 }
 
 void
 Mesh::moveLocal (float distance, const Vector3& localDirection)
 {
-  m_world.moveLocal (distance, localDirection);
+  Transform t = getLocal ();
+  t.moveLocal (distance, localDirection);
+  setLocal (t);
 }
 
 void
 Mesh::moveWorld (float distance, const Vector3& worldDirection)
 {
-  m_world.moveWorld (distance, worldDirection);
+  Transform t = getLocal ();
+  t.moveWorld (distance, worldDirection);
+  setLocal (t);
 }
 
 void
 Mesh::pitch (float angleDegrees)
 {
-  m_world.pitch (angleDegrees);
+  if (m_hierarchy != nullptr)
+    m_hierarchy->getLocals ().pitch (m_node, angleDegrees);
+  else
+    m_world.pitch (angleDegrees);
 }
 
 void
 Mesh::yaw (float angleDegrees)
 {
-  m_world.yaw (angleDegrees);
+  if (m_hierarchy != nullptr)
+    m_hierarchy->getLocals ().yaw (m_node, angleDegrees);
+  else
+    m_world.yaw (angleDegrees);
 }
 
 void
 Mesh::roll (float angleDegrees)
 {
-  m_world.roll (angleDegrees);
+  if (m_hierarchy != nullptr)
+    m_hierarchy->getLocals ().roll (m_node, angleDegrees);
+  else
+    m_world.roll (angleDegrees);
 }
 
 void
 Mesh::rotateLocal (float angleDegrees, const Vector3& axis)
 {
-  m_world.rotateLocal (angleDegrees, axis);
+  Transform t = getLocal ();
+  t.rotateLocal (angleDegrees, axis);
+  setLocal (t);
 }
 
 void
 Mesh::alignWithWorldY ()
 {
-  m_world.alignWithWorldY ();
+  Transform t = getLocal ();
+  t.alignWithWorldY ();
+  setLocal (t);
 }
 
 void
 Mesh::scaleLocal (float scale)
 {
-  m_world.scaleLocal (scale);
+  if (m_hierarchy != nullptr)
+    m_hierarchy->getLocals ().scaleLocal (m_node, scale);
+  else
+    m_world.scaleLocal (scale);
 }
 
 void
 Mesh::scaleLocal (float scaleX, float scaleY, float scaleZ)
 {
-  m_world.scaleLocal (scaleX, scaleY, scaleZ);
+  Transform t = getLocal ();
+  t.scaleLocal (scaleX, scaleY, scaleZ);
+  setLocal (t);
 }
 
 void
 Mesh::scaleWorld (float scale)
 {
-  m_world.scaleWorld (scale);
+  Transform t = getLocal ();
+  t.scaleWorld (scale);
+  setLocal (t);
 }
 
 void
 Mesh::scaleWorld (float scaleX, float scaleY, float scaleZ)
 {
-  m_world.scaleWorld (scaleX, scaleY, scaleZ);
+  Transform t = getLocal ();
+  t.scaleWorld (scaleX, scaleY, scaleZ);
+  setLocal (t);
 }
 
 void
 Mesh::shearLocalXByYz (float shearY, float shearZ)
 {
-  m_world.shearLocalXByYz (shearY, shearZ);
+  Transform t = getLocal ();
+  t.shearLocalXByYz (shearY, shearZ);
+  setLocal (t);
 }
 
 void
 Mesh::shearLocalYByXz (float shearX, float shearZ)
 {
-  m_world.shearLocalYByXz (shearX, shearZ);
+  Transform t = getLocal ();
+  t.shearLocalYByXz (shearX, shearZ);
+  setLocal (t);
 }
 
 void
 Mesh::shearLocalZByXy (float shearX, float shearY)
 {
-  m_world.shearLocalZByXy (shearX, shearY);
+  Transform t = getLocal ();
+  t.shearLocalZByXy (shearX, shearY);
+  setLocal (t);
 }
 
 void
@@ -185,12 +476,82 @@ Mesh::addIndices (const std::vector<unsigned int>& indices)
   m_indices.insert (m_indices.end (), indices.begin (), indices.end ());
 }
 
+void
+Mesh::addLevelOfDetail (const std::vector<unsigned int>& indices, float distance)
+{
+  m_levels.push_back (LevelOfDetail { distance, 0, static_cast<GLuint> (indices.size ()) });
+  m_lodIndices.insert (m_lodIndices.end (), indices.begin (), indices.end ());
+}
+
+unsigned int
+Mesh::getLevelOfDetailCount () const
+{
+  return m_levels.size ();
+}
+
+const LevelOfDetail&
+Mesh::getLevelOfDetail (unsigned int level) const
+{
+  return m_levels[level];
+}
+
+unsigned int
+Mesh::selectLevelOfDetail (const Matrix4& modelView) const
+{
+  if (m_levels.size () == 1)
+    return 0;
+  // As CullDraws.comp chooses, so both paths draw the same triangles.
+  const float* m = modelView.data ();
+  float scaleSquared = 0.0f;
+  for (int col = 0; col < 3; ++col)
+    scaleSquared = std::max (scaleSquared, m[4 * col] * m[4 * col]
+                             + m[4 * col + 1] * m[4 * col + 1] + m[4 * col + 2] * m[4 * col + 2]);
+  Vector4 center = modelView * Vector4 (m_boundsCenter.m_x, m_boundsCenter.m_y,
+                                        m_boundsCenter.m_z, 1.0f);
+  float distance = Vector3 (center.m_x, center.m_y, center.m_z).length ()
+    / std::max (m_boundsRadius * std::sqrt (scaleSquared), 1e-6f);
+  unsigned int level = 0;
+  for (unsigned int i = 1; i < m_levels.size (); ++i)
+    if (distance >= m_levels[i].distance)
+      level = i;
+  return level;
+}
+
+const GeometryRange*
+Mesh::getRange () const
+{
+  return m_range;
+}
+
+Transform
+Mesh::getLocal () const
+{
+  if (m_hierarchy != nullptr)
+    return m_hierarchy->getLocal (m_node);
+  return m_world;
+}
+
+void
+Mesh::setLocal (const Transform& local)
+{
+  if (m_hierarchy != nullptr)
+    m_hierarchy->setLocal (m_node, local);
+  else
+    m_world = local;
+}
+
 unsigned int
 Mesh::getFloatsPerVertex () const
 {
   return 3;
 }
 
+const char*
+Mesh::getVertexFormat () const
+{
+  return "position color";
+}
+
 void
 Mesh::enableAttributes ()
 {
@@ -198,11 +559,11 @@ Mesh::enableAttributes ()
   const GLint POSITION_ATTRIB_INDEX = 0;
   const GLint COLOR_ATTRIB_INDEX = 1;
   
-  m_context->enableVertexAttribArray (POSITION_ATTRIB_INDEX);
-  m_context->vertexAttribPointer (POSITION_ATTRIB_INDEX, 3, GL_FLOAT, GL_FALSE,
-          (6 * sizeof(float)), reinterpret_cast<void*> (0));
-  m_context->enableVertexAttribArray (COLOR_ATTRIB_INDEX);
-  m_context->vertexAttribPointer (COLOR_ATTRIB_INDEX, 3, GL_FLOAT, GL_FALSE,
-          (6 * sizeof(float)), reinterpret_cast<void*> (3 * sizeof(float)));
-  m_context->bindVertexArray (0);
+  m_context->enableVertexArrayAttrib (m_vao, POSITION_ATTRIB_INDEX);
+  m_context->vertexArrayAttribFormat (m_vao, POSITION_ATTRIB_INDEX, 3, GL_FLOAT, GL_FALSE, 0);
+  m_context->vertexArrayAttribBinding (m_vao, POSITION_ATTRIB_INDEX, 0);
+  m_context->enableVertexArrayAttrib (m_vao, COLOR_ATTRIB_INDEX);
+  m_context->vertexArrayAttribFormat (m_vao, COLOR_ATTRIB_INDEX, 3, GL_FLOAT, GL_FALSE,
+          3 * sizeof(float));
+  m_context->vertexArrayAttribBinding (m_vao, COLOR_ATTRIB_INDEX, 0);
 }
\ No newline at end of file
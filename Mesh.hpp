@@ -6,13 +6,34 @@
 #ifndef MESH_HPP
 #define MESH_HPP
 
+#include <cstdint>
+#include <string>
 #include <vector>
 
 #include "OpenGLContext.hpp"
 #include "ShaderProgram.hpp"
 #include "Transform.hpp"
+#include "TransformHierarchy.hpp"
 #include "Matrix4.hpp"
 #include "Material.hpp"
+#include "MaterialTable.hpp"
+#include "RenderQueue.hpp"
+#include "Geometry.hpp"
+#include "GeometryArena.hpp"
+
+/// \brief One level of detail of a Mesh: a range of its indices, drawn over
+///   the same vertices as its other levels.
+struct LevelOfDetail
+{
+  /// How far away the level starts to be drawn, in bounding radii: the
+  ///   distance from the eye to the center of the Mesh's bounding sphere,
+  ///   divided by the sphere's (world) radius.
+  float distance;
+  /// The level's first index, counted from the Mesh's first.
+  GLuint firstIndex;
+  /// The number of indices.
+  GLuint indexCount;
+};
 
 /// \brief An object that exists in the world, which consists of one or more
 ///   3-D triangles.
@@ -20,19 +41,24 @@ class Mesh
 {
 public:
 
+  /// \brief The number of floats from one vertex to the next in every vertex
+  ///   format (each of which starts with the 3-D position).
+  static const unsigned int VERTEX_STRIDE;
+
   /// \brief Constructs an empty Mesh with no triangles.
   /// \param context A pointer to an object through which the Mesh will be able
   ///   to make OpenGL calls.
   /// \param shader A pointer to the intende shader program to use for color
   ///   data.
-  /// \post A unique VAO and VBO have been generated for this Mesh and stored
-  ///   for later use.
+  /// \post No OpenGL calls have been made: the geometry goes in a
+  ///   GeometryArena when this Mesh is prepared.
   Mesh (OpenGLContext* context, ShaderProgram* shader);
 
   Mesh (OpenGLContext* context, ShaderProgram* shader, Material* material);
 
   /// \brief Destructs this Mesh.
-  /// \post The VAO and VBO associated with this Mesh have been deleted.
+  /// \post This Mesh's geometry has been given back to its GeometryArena
+  ///   (and the arena deleted, if this Mesh made its own).
   virtual
   ~Mesh ();
 
@@ -55,29 +81,109 @@ public:
   void
   addGeometry (const std::vector<float>& geometry);
 
-  /// \brief Copies this Mesh's geometry into this Mesh's VBO and sets up its
-  ///   VAO.
+  /// \brief Copies this Mesh's geometry into its GeometryArena and gets
+  ///   the arena's VAO for its vertex format, by direct state access, so no
+  ///   binding changes.
   /// \pre This Mesh has not yet been prepared.
-  /// \post The first two vertex attributes have been enabled, with
-  ///   interleaved 3-part positions and 3-part colors.
-  /// \post This Mesh's geometry has been copied to its VBO.
+  /// \post If no arena was set, this Mesh has made one of its own, which
+  ///   holds only its geometry.
+  /// \post If that VAO is new, its attributes have been enabled (see
+  ///   enableAttributes).
+  /// \post This Mesh's geometry has been copied to the arena's buffers.
+  /// \post This Mesh's bounding sphere encloses every vertex position.
   void
   prepareVao ();
 
   /// \brief Draws this Mesh in OpenGL.
   /// \param[in] viewMatrix The view matrix that should be used by itself as
   ///   the model-view matrix (there is not yet any model part).
+  /// \param[in] projectionMatrix Unused; the projection matrix (like the view
+  ///   matrix) is read from the camera uniform block.
   /// \pre This Mesh has been prepared.
+  /// \pre The camera uniform block holds this frame's data (see Scene::draw).
   /// \post While the ShaderProgram was enabled, the viewMatrix has been set as
   ///   the "uModelView" uniform matrix and the geometry has been drawn.
   void
   draw (const Transform& viewMatrix, const Matrix4& projectionMatrix);
 
+  /// \brief Records the draw call for this Mesh instead of making it.
+  /// \param[in] viewMatrix The camera's view matrix.
+  /// \param[in] projectionMatrix The camera's projection matrix.
+  /// \param[in] program The shader program to draw with: this Mesh's own, or
+  ///   a specialized variant of it chosen by the Scene.
+  /// \param[in] sortKey Where this Mesh belongs in the draw order.
+  /// \param[out] buffer The buffer to append a DrawPacket to.
+  /// \pre This Mesh has been prepared, and its hierarchy (if any) is up to
+  ///   date.
+  /// \post No OpenGL calls have been made, so any thread may record as long
+  ///   as each uses its own buffer.
+  void
+  record (const Matrix4& viewMatrix, const Matrix4& projectionMatrix,
+          ShaderProgram* program, uint64_t sortKey,
+          RenderCommandBuffer& buffer) const;
+
+  /// \brief Chooses the GeometryArena this Mesh's geometry goes in, so that
+  ///   it can be drawn along with every other Mesh of its vertex format.
+  /// \param[in] arena The arena, which must outlive this Mesh.
+  /// \pre This Mesh has not yet been prepared.
+  void
+  setArena (GeometryArena* arena);
+
+  /// \brief Gets the GeometryArena this Mesh's geometry goes in.
+  /// \return The arena, or nullptr if none was set and this Mesh has not
+  ///   yet been prepared.
+  GeometryArena*
+  getArena () const;
+
+  /// \brief Tests whether or not this Mesh has been prepared.
+  /// \return Whether or not prepareVao () has been called.
+  bool
+  isPrepared () const;
+
+  /// \brief Names this Mesh, for reports such as GPU timings.
+  /// \param[in] name The name.
+  void
+  setName (const std::string& name);
+
+  /// \brief Gets this Mesh's name.
+  /// \return The name last passed to setName (), or "mesh".
+  const std::string&
+  getName () const;
+
   /// \brief Gets the mesh's world matrix.
-  /// \return The world matrix.
+  /// \return The world matrix.  If this Mesh belongs to a
+  ///   TransformHierarchy, this is the world matrix as of that hierarchy's
+  ///   last update.
   Transform
   getWorld () const;
 
+  /// \brief Moves this Mesh's transform into a TransformHierarchy, so that it
+  ///   can be parented to (or be the parent of) other transforms.
+  /// \param[in] hierarchy The hierarchy to join.  It must outlive this Mesh
+  ///   or this Mesh must be detached first.
+  /// \post This Mesh's transform is a root node of hierarchy.  All of the
+  ///   move, rotate, scale, and shear functions now act on this Mesh's
+  ///   transform relative to its parent.
+  void
+  attachToHierarchy (TransformHierarchy* hierarchy);
+
+  /// \brief Takes this Mesh's transform back out of its TransformHierarchy.
+  /// \post This Mesh owns its transform again, which keeps the value it had
+  ///   relative to its former parent.
+  void
+  detachFromHierarchy ();
+
+  /// \brief Gets the TransformHierarchy this Mesh belongs to.
+  /// \return The hierarchy, or nullptr if this Mesh owns its own transform.
+  TransformHierarchy*
+  getHierarchy () const;
+
+  /// \brief Gets the node that holds this Mesh's transform.
+  /// \return The node in getHierarchy (), or TransformHierarchy::NO_PARENT if
+  ///   this Mesh does not belong to a hierarchy.
+  unsigned int
+  getNode () const;
+
   /// \brief Moves the mesh right (locally).
   /// \param[in] distance The distance to move the mesh.
   /// \post The mesh has been moved.
@@ -200,35 +306,196 @@ public:
   void
   addIndices (const std::vector<unsigned int>& indices);
 
+  /// \brief Adds a coarser version of this Mesh's triangles, which is drawn
+  ///   instead of the finer ones once this Mesh is far enough away.
+  /// \param[in] indices Three indices into this Mesh's vertices per triangle
+  ///   (see simplifyIndices).
+  /// \param[in] distance How far away the level starts, in bounding radii
+  ///   (see LevelOfDetail).  Levels must be added from nearest to farthest.
+  /// \pre This Mesh has not yet been prepared.
+  /// \post The level is the last of getLevelOfDetailCount () levels.
+  void
+  addLevelOfDetail (const std::vector<unsigned int>& indices, float distance);
+
+  /// \brief Gets the number of levels of detail, counting the full one.
+  /// \return 1 plus the number of calls to addLevelOfDetail ().
+  unsigned int
+  getLevelOfDetailCount () const;
+
+  /// \brief Gets one level of detail.
+  /// \param[in] level The level, from 0 for the full geometry.
+  /// \return The level, whose range is only known once this Mesh has been
+  ///   prepared.
+  /// \pre level is less than getLevelOfDetailCount ().
+  const LevelOfDetail&
+  getLevelOfDetail (unsigned int level) const;
+
+  /// \brief Chooses the level of detail to draw this Mesh at.
+  /// \param[in] modelView This Mesh's model-view matrix.
+  /// \return The farthest level whose distance has been reached.
+  /// \pre This Mesh has been prepared.
+  unsigned int
+  selectLevelOfDetail (const Matrix4& modelView) const;
+
+  /// \brief Gets where this Mesh's geometry is in its GeometryArena.
+  /// \return The range, which the arena keeps up to date, or nullptr if this
+  ///   Mesh has not yet been prepared.
+  const GeometryRange*
+  getRange () const;
+
   /// \brief Gets the number of floats used to represent each vertex.
   /// \return The number of floats used for each vertex.
   virtual unsigned int
   getFloatsPerVertex () const;  
 
+  /// \brief Sets the material this Mesh is drawn with.
+  /// \param[in] mat The material, or nullptr for none.
+  /// \post If this Mesh is attached to a MaterialTable, mat is registered
+  ///   with it in place of the old material.
   void
   setMaterial (Material* mat);
 
+  /// \brief Registers this Mesh's material, now and whenever it is set, with
+  ///   the MaterialTable of the Scene it is drawn in.
+  /// \param[in] table The table.  It must outlive this Mesh or this Mesh
+  ///   must be detached first.
+  /// \post This Mesh is one of its material's users in table.
+  void
+  attachToMaterialTable (MaterialTable* table);
+
+  /// \brief Unregisters this Mesh's material from its MaterialTable.
+  /// \post This Mesh is no longer one of its material's users.
+  void
+  detachFromMaterialTable ();
+
+  /// \brief Gets the material this Mesh is drawn with.
+  /// \return The material, or nullptr if none has been set.
+  Material*
+  getMaterial () const;
+
+  /// \brief Gets the shader program this Mesh is drawn with.
+  /// \return The shader program.
+  ShaderProgram*
+  getShader () const;
+
+  /// \brief Gets the center of a sphere that encloses this Mesh's geometry.
+  /// \return The center, in this Mesh's local coordinates.
+  /// \pre This Mesh has been prepared.
+  Vector3
+  getBoundsCenter () const;
+
+  /// \brief Gets the vertex data this Mesh was built from.
+  /// \return Interleaved vertices, VERTEX_STRIDE floats apart, each starting
+  ///   with its position.
+  const std::vector<float>&
+  getVertexData () const;
+
+  /// \brief Gets the triangle indices this Mesh was built from.
+  /// \return Three indices per triangle.
+  const std::vector<unsigned int>&
+  getIndices () const;
+
+  /// \brief Gives this Mesh a simplified shape to draw into the occlusion
+  ///   buffer instead of its full geometry.
+  /// \param[in] triangles The simplified shape, in this Mesh's local
+  ///   coordinates.  It should fit inside the full geometry, or it will hide
+  ///   things that are really visible.
+  void
+  setOccluderShape (const std::vector<Triangle>& triangles);
+
+  /// \brief Gets the vertices to draw into the occlusion buffer.
+  /// \return The simplified shape's vertices if one was set, or else the
+  ///   full vertex data.
+  const std::vector<float>&
+  getOccluderVertices () const;
+
+  /// \brief Gets the distance between vertices in getOccluderVertices ().
+  /// \return The number of floats from one vertex to the next.
+  unsigned int
+  getOccluderStride () const;
+
+  /// \brief Gets the triangles to draw into the occlusion buffer.
+  /// \return Three indices into getOccluderVertices () per triangle.
+  const std::vector<unsigned int>&
+  getOccluderIndices () const;
+
+  /// \brief Gets the radius of a sphere that encloses this Mesh's geometry.
+  /// \return The radius, in this Mesh's local coordinates.
+  /// \pre This Mesh has been prepared.
+  float
+  getBoundsRadius () const;
+
   // TODO: Add the other data members you think you will need here.
 
 protected:
+  /// \brief Names the layout of this Mesh's vertices, which every Mesh that
+  ///   shares a GeometryArena VAO must have.
+  /// \return The names of the attributes that enableAttributes enables.
+  virtual const char*
+  getVertexFormat () const;
+
   /// \brief Enables VAO attributes.
-  /// \pre This Mesh's VAO has been bound.
+  /// \pre The arena's vertex buffer for this Mesh's format is attached to
+  ///   buffer binding 0 of m_vao.
   /// \post Any attributes (positions, colors, normals, texture coordinates)
-  ///   have been enabled and configured.
+  ///   have been enabled and configured to read through binding 0, without
+  ///   binding anything.
   /// This should only be called from the middle of prepareVao().
   virtual void
   enableAttributes();
 
+  /// \brief Gets this Mesh's transform relative to its parent.
+  /// \return This Mesh's own transform, or a copy of its local transform in
+  ///   its TransformHierarchy.
+  Transform
+  getLocal () const;
+
+  /// \brief Replaces this Mesh's transform relative to its parent.
+  /// \param[in] local The new transform.
+  /// \post This Mesh's own transform, or its local transform in its
+  ///   TransformHierarchy (which is then marked dirty), is local.
+  void
+  setLocal (const Transform& local);
+
   /// A pointer to the object through which this Mesh will make OpenGL calls.
   ShaderProgram* m_shader;
   std::vector<float> m_data;
   std::vector<unsigned int> m_indices;
+  /// The vertex array of this Mesh's format in m_arena, or 0 until this
+  ///   Mesh is prepared.
   GLuint m_vao;
-  GLuint m_vbo;
-  GLuint m_ibo;
+  /// Where this Mesh's geometry is in m_arena, which m_arena keeps up to
+  ///   date, or nullptr until this Mesh is prepared.
+  const GeometryRange* m_range;
+  /// Every level of detail, from the full geometry (m_indices) out.
+  std::vector<LevelOfDetail> m_levels;
+  /// The indices of every level but the first, one after another, until
+  ///   this Mesh is prepared.
+  std::vector<unsigned int> m_lodIndices;
+  /// The arena that holds this Mesh's geometry.
+  GeometryArena* m_arena;
+  /// The arena this Mesh made for itself, if it was prepared without one.
+  GeometryArena* m_ownArena;
   Transform m_world;
   OpenGLContext* m_context;
   Material* m_mat;
+  /// The table m_mat is registered with on this Mesh's behalf, if any.
+  MaterialTable* m_materialTable;
+  /// The hierarchy that holds this Mesh's transform instead of m_world, if
+  ///   any.
+  TransformHierarchy* m_hierarchy;
+  /// This Mesh's node in m_hierarchy.
+  unsigned int m_node;
+  /// The center of this Mesh's local bounding sphere.
+  Vector3 m_boundsCenter;
+  /// The radius of this Mesh's local bounding sphere.
+  float m_boundsRadius;
+  /// The positions of the simplified occluder shape, if any.
+  std::vector<float> m_occluderData;
+  /// The indices of the simplified occluder shape, if any.
+  std::vector<unsigned int> m_occluderIndices;
+  /// The name reported for this Mesh.
+  std::string m_name;
 
 };
 
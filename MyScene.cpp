@@ -9,7 +9,7 @@
 
 MyScene::MyScene (OpenGLContext* context, ShaderProgram* colorInfo, ShaderProgram* normInfo,
   ShaderProgram* genPhongInfo, Camera* camera)
-  : Scene::Scene (genPhongInfo, camera)
+  : Scene::Scene (context, genPhongInfo, camera)
 {
   // 3 3D points, followed by 3 RGB colors
   std::vector<float> decaVertices {
@@ -99,20 +99,22 @@ NormalsMesh::draw (const Transform& viewMatrix, const Matrix4& projectionMatrix,
   //   make that assumption in general.
   m_shader->enable ();
 
-  m_shader->setUniformMatrix ("uWorld", m_world.getTransform());
-  m_shader->setUniformMatrix ("uView", viewMatrix.getTransform());
-  m_shader->setUniformMatrix ("uProjection", projectionMatrix);
-
-  //m_shaderProgram->setUniformVector ("uEyePosition", cameraPosition);
-  m_shader->setUniformVector ("uEyePosition", Vector3(0.0f, 0.0f, 0.0f));
+  Matrix4 world = getWorld ().getTransform ();
+  Matrix4 modelView = viewMatrix.getTransform () * world;
+  m_shader->setUniformMatrix ("uWorld", world);
+  m_shader->setUniformMatrix ("uModelView", modelView);
+  m_shader->setUniformMatrix ("uModelViewProjection", projectionMatrix * modelView);
+  m_shader->setUniformMatrix ("uNormalMatrix", getNormalMatrix (modelView));
+  // uView, uProjection, and uEyePosition come from the camera uniform block.
   m_shader->setUniformInt("uHasTexture", 0);
 
   m_mat->setUniforms(m_shader);
 
   // Draw geometry
+  const LevelOfDetail& level = getLevelOfDetail (selectLevelOfDetail (modelView));
   m_context->bindVertexArray (m_vao);
-  glDrawElements (GL_TRIANGLES, m_indices.size (), GL_UNSIGNED_INT,
-    reinterpret_cast<void*> (0));
+  m_context->drawElements (GL_TRIANGLES, level.indexCount, GL_UNSIGNED_INT,
+    reinterpret_cast<void*> ((m_range->firstIndex + level.firstIndex) * sizeof (GLuint)));
   m_context->bindVertexArray (0);
 
   m_shader->disable ();
@@ -124,15 +126,22 @@ NormalsMesh::getFloatsPerVertex () const
     return 2 * Mesh::getFloatsPerVertex ();
 }
 
+const char*
+NormalsMesh::getVertexFormat () const
+{
+    return "position color normal";
+}
+
 void
 NormalsMesh::enableAttributes ()
 {
 
     const GLint NORM_ATTRIB_INDEX = 2;
     
-    m_context->enableVertexAttribArray (NORM_ATTRIB_INDEX);
-    m_context->vertexAttribPointer (NORM_ATTRIB_INDEX, 3, GL_FLOAT, GL_FALSE,
-            (6 * sizeof(float)), reinterpret_cast<void*> (3 * sizeof(float)));
+    m_context->enableVertexArrayAttrib (m_vao, NORM_ATTRIB_INDEX);
+    m_context->vertexArrayAttribFormat (m_vao, NORM_ATTRIB_INDEX, 3, GL_FLOAT, GL_FALSE,
+            3 * sizeof(float));
+    m_context->vertexArrayAttribBinding (m_vao, NORM_ATTRIB_INDEX, 0);
     
     Mesh::enableAttributes ();
 }
\ No newline at end of file
@@ -20,8 +20,6 @@ public:
   ///   read from.
   /// \param[in] meshNum The 0-based index of which mesh from that file should
   ///   be used.
-  /// \post A unique VAO, VBO, and IBO have been generated for this Mesh and
-  ///   stored for later use.
   /// \post If that file exists and contains a mesh of that number, the indexes
   ///   and geometry from it have been pre-populated into this Mesh.  Otherwise
   ///   this Mesh is empty and an error message has been printed.
@@ -37,6 +35,9 @@ public:
   getFloatsPerVertex () const;
     
 protected:
+  virtual const char*
+  getVertexFormat () const;
+
   virtual void
   enableAttributes ();
 };
\ No newline at end of file
@@ -0,0 +1,659 @@
+/// \file NullOpenGLContext.cpp
+/// \brief Definitions of NullOpenGLContext member and associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <sstream>
+
+#include "NullOpenGLContext.hpp"
+
+NullOpenGLContext::NullOpenGLContext ()
+  : m_nextName (1), m_shaderSources (), m_programs (),
+    m_viewport { 0, 0, 0, 0 }
+{
+}
+
+NullOpenGLContext::~NullOpenGLContext ()
+{
+}
+
+void
+NullOpenGLContext::activeTexture (GLenum texture)
+{
+}
+
+void
+NullOpenGLContext::attachShader (GLuint program, GLuint shader)
+{
+  m_programs[program].shaders.push_back (shader);
+}
+
+void
+NullOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+}
+
+void
+NullOpenGLContext::bindBufferBase (GLenum target, GLuint index, GLuint buffer)
+{
+}
+
+void
+NullOpenGLContext::bindFramebuffer (GLenum target, GLuint framebuffer)
+{
+}
+
+void
+NullOpenGLContext::bindTexture (GLenum target, GLuint texture)
+{
+}
+
+void
+NullOpenGLContext::bindVertexArray (GLuint array)
+{
+}
+
+void
+NullOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+}
+
+void
+NullOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+}
+
+GLenum
+NullOpenGLContext::checkFramebufferStatus (GLenum target)
+{
+  return GL_FRAMEBUFFER_COMPLETE;
+}
+
+void
+NullOpenGLContext::clear (GLbitfield mask)
+{
+}
+
+void
+NullOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+}
+
+GLenum
+NullOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  return GL_ALREADY_SIGNALED;
+}
+
+void
+NullOpenGLContext::compileShader (GLuint shader)
+{
+}
+
+void
+NullOpenGLContext::createBuffers (GLsizei n, GLuint* buffers)
+{
+  generate (n, buffers);
+}
+
+GLuint
+NullOpenGLContext::createProgram ()
+{
+  GLuint program;
+  generate (1, &program);
+  m_programs[program] = ProgramInfo ();
+  return program;
+}
+
+GLuint
+NullOpenGLContext::createShader (GLenum shaderType)
+{
+  GLuint shader;
+  generate (1, &shader);
+  m_shaderSources[shader] = "";
+  return shader;
+}
+
+void
+NullOpenGLContext::createVertexArrays (GLsizei n, GLuint* arrays)
+{
+  generate (n, arrays);
+}
+
+void
+NullOpenGLContext::cullFace (GLenum mode)
+{
+}
+
+void
+NullOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+}
+
+void
+NullOpenGLContext::deleteFramebuffers (GLsizei n, const GLuint* framebuffers)
+{
+}
+
+void
+NullOpenGLContext::deleteProgram (GLuint program)
+{
+  m_programs.erase (program);
+}
+
+void
+NullOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+}
+
+void
+NullOpenGLContext::deleteShader (GLuint shader)
+{
+  m_shaderSources.erase (shader);
+}
+
+void
+NullOpenGLContext::deleteSync (GLsync sync)
+{
+}
+
+void
+NullOpenGLContext::deleteTextures (GLsizei n, const GLuint* textures)
+{
+}
+
+void
+NullOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+}
+
+void
+NullOpenGLContext::depthFunc (GLenum func)
+{
+}
+
+void
+NullOpenGLContext::detachShader (GLuint program, GLuint shader)
+{
+  std::vector<GLuint>& shaders = m_programs[program].shaders;
+  shaders.erase (std::remove (shaders.begin (), shaders.end (), shader), shaders.end ());
+}
+
+void
+NullOpenGLContext::dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+}
+
+void
+NullOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+}
+
+void
+NullOpenGLContext::drawBuffers (GLsizei n, const GLenum* bufs)
+{
+}
+
+void
+NullOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+}
+
+void
+NullOpenGLContext::enable (GLenum cap)
+{
+}
+
+void
+NullOpenGLContext::enableVertexArrayAttrib (GLuint vaobj, GLuint index)
+{
+}
+
+void
+NullOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+}
+
+GLsync
+NullOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return nullptr;
+}
+
+void
+NullOpenGLContext::framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+}
+
+void
+NullOpenGLContext::frontFace (GLenum mode)
+{
+}
+
+void
+NullOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
+{
+  generate (n, buffers);
+}
+
+void
+NullOpenGLContext::genFramebuffers (GLsizei n, GLuint* framebuffers)
+{
+  generate (n, framebuffers);
+}
+
+void
+NullOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  generate (n, ids);
+}
+
+void
+NullOpenGLContext::genTextures (GLsizei n, GLuint* textures)
+{
+  generate (n, textures);
+}
+
+void
+NullOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
+{
+  generate (n, arrays);
+}
+
+void
+NullOpenGLContext::getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+  const UniformDeclaration& uniform = m_programs[program].uniforms.at (index);
+  GLsizei copied = std::min<GLsizei> (uniform.name.size (), std::max (bufSize - 1, 0));
+  std::copy (uniform.name.begin (), uniform.name.begin () + copied, name);
+  if (bufSize > 0)
+    name[copied] = '\0';
+  if (length != nullptr)
+    *length = copied;
+  *size = uniform.size;
+  *type = uniform.type;
+}
+
+GLint
+NullOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
+{
+  return -1;
+}
+
+void
+NullOpenGLContext::getIntegerv (GLenum pname, GLint* data)
+{
+  if (pname == GL_VIEWPORT)
+    std::copy (m_viewport, m_viewport + 4, data);
+  else
+    *data = 0;
+}
+
+void
+NullOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+}
+
+void
+NullOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  if (maxLength > 0)
+    infoLog[0] = '\0';
+  if (length != nullptr)
+    *length = 0;
+}
+
+void
+NullOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+  const ProgramInfo& info = m_programs[program];
+  switch (pname)
+  {
+  case GL_LINK_STATUS:
+  case GL_COMPLETION_STATUS_KHR:
+    *params = GL_TRUE;
+    break;
+  case GL_ACTIVE_UNIFORMS:
+    *params = info.uniforms.size ();
+    break;
+  case GL_ACTIVE_UNIFORM_MAX_LENGTH:
+    *params = 0;
+    for (const UniformDeclaration& uniform : info.uniforms)
+      *params = std::max<GLint> (*params, uniform.name.size () + 1);
+    break;
+  default:
+    *params = 0;
+    break;
+  }
+}
+
+void
+NullOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  // Every query is answered as soon as it is made.
+  *params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+void
+NullOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  *params = 0;
+}
+
+void
+NullOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  if (maxLength > 0)
+    infoLog[0] = '\0';
+  if (length != nullptr)
+    *length = 0;
+}
+
+void
+NullOpenGLContext::getShaderiv (GLuint shader, GLenum pname, GLint* params)
+{
+  switch (pname)
+  {
+  case GL_COMPILE_STATUS:
+  case GL_COMPLETION_STATUS_KHR:
+    *params = GL_TRUE;
+    break;
+  default:
+    *params = 0;
+    break;
+  }
+}
+
+const GLubyte*
+NullOpenGLContext::getString (GLenum name)
+{
+  static const GLubyte NAME[] = "Null";
+  return NAME;
+}
+
+GLuint
+NullOpenGLContext::getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName)
+{
+  const std::vector<std::string>& blocks = m_programs[program].blocks;
+  auto found = std::find (blocks.begin (), blocks.end (), uniformBlockName);
+  return found == blocks.end () ? GL_INVALID_INDEX : found - blocks.begin ();
+}
+
+GLint
+NullOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
+{
+  const std::map<std::string, GLint>& locations = m_programs[program].locations;
+  auto found = locations.find (name);
+  return found == locations.end () ? -1 : found->second;
+}
+
+void
+NullOpenGLContext::linkProgram (GLuint program)
+{
+  ProgramInfo& info = m_programs[program];
+  info.uniforms.clear ();
+  info.locations.clear ();
+  info.blocks.clear ();
+  for (GLuint shader : info.shaders)
+    scanUniforms (m_shaderSources[shader], info);
+}
+
+void*
+NullOpenGLContext::mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+  return nullptr;
+}
+
+void
+NullOpenGLContext::maxShaderCompilerThreadsKHR (GLuint count)
+{
+}
+
+void
+NullOpenGLContext::memoryBarrier (GLbitfield barriers)
+{
+}
+
+void
+NullOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+}
+
+void
+NullOpenGLContext::multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+}
+
+void
+NullOpenGLContext::namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+}
+
+void
+NullOpenGLContext::namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+}
+
+void
+NullOpenGLContext::namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+}
+
+void
+NullOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+}
+
+void
+NullOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+}
+
+void
+NullOpenGLContext::queryCounter (GLuint id, GLenum target)
+{
+}
+
+void
+NullOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{
+  std::string& source = m_shaderSources[shader];
+  source.clear ();
+  for (GLsizei i = 0; i < count; ++i)
+  {
+    if (length == nullptr || length[i] < 0)
+      source += string[i];
+    else
+      source.append (string[i], length[i]);
+  }
+}
+
+void
+NullOpenGLContext::texBuffer (GLenum target, GLenum internalformat, GLuint buffer)
+{
+}
+
+void
+NullOpenGLContext::texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data)
+{
+}
+
+void
+NullOpenGLContext::texParameteri (GLenum target, GLenum pname, GLint param)
+{
+}
+
+void
+NullOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+}
+
+void
+NullOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+}
+
+void
+NullOpenGLContext::uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+}
+
+void
+NullOpenGLContext::uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+}
+
+void
+NullOpenGLContext::uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+}
+
+void
+NullOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+}
+
+GLboolean
+NullOpenGLContext::unmapNamedBuffer (GLuint buffer)
+{
+  return GL_FALSE;
+}
+
+void
+NullOpenGLContext::useProgram (GLuint program)
+{
+}
+
+void
+NullOpenGLContext::vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+}
+
+void
+NullOpenGLContext::vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+}
+
+void
+NullOpenGLContext::vertexArrayElementBuffer (GLuint vaobj, GLuint buffer)
+{
+}
+
+void
+NullOpenGLContext::vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+{
+}
+
+void
+NullOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+}
+
+void
+NullOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  m_viewport[0] = x;
+  m_viewport[1] = y;
+  m_viewport[2] = width;
+  m_viewport[3] = height;
+}
+
+std::string
+NullOpenGLContext::getProgramSource (GLuint program) const
+{
+  std::string source;
+  auto found = m_programs.find (program);
+  if (found == m_programs.end ())
+    return source;
+  for (GLuint shader : found->second.shaders)
+  {
+    auto text = m_shaderSources.find (shader);
+    if (text != m_shaderSources.end ())
+      source += text->second;
+  }
+  return source;
+}
+
+void
+NullOpenGLContext::scanUniforms (const std::string& source, ProgramInfo& program)
+{
+  std::istringstream lines (source);
+  std::string line;
+  while (std::getline (lines, line))
+  {
+    line = line.substr (0, line.find ("//"));
+    // Split on spaces and punctuation, keeping "[", "]", and ";".
+    std::vector<std::string> tokens;
+    std::string token;
+    for (char c : line + " ")
+    {
+      if (std::isalnum (static_cast<unsigned char> (c)) || c == '_')
+      {
+        token += c;
+        continue;
+      }
+      if (!token.empty ())
+        tokens.push_back (token);
+      token.clear ();
+      if (c == '[' || c == ']' || c == ';' || c == '{')
+        tokens.push_back (std::string (1, c));
+    }
+    auto uniform = std::find (tokens.begin (), tokens.end (), "uniform");
+    if (uniform == tokens.end () || tokens.end () - uniform < 2)
+      continue;
+    if (tokens.end () - uniform == 2 || uniform[2] == "{")
+    {
+      // "uniform BlockName", with the members on the following lines.
+      if (std::find (program.blocks.begin (), program.blocks.end (), uniform[1])
+          == program.blocks.end ())
+        program.blocks.push_back (uniform[1]);
+      continue;
+    }
+    std::string name = uniform[2];
+    GLint size = 1;
+    if (tokens.end () - uniform >= 5 && uniform[3] == "[")
+    {
+      // A size that isn't a literal (e.g., a constant) is taken as one.
+      size = std::max (1, std::atoi (uniform[4].c_str ()));
+      name += "[0]";
+    }
+    std::string base = name.substr (0, name.find ('['));
+    if (program.locations.count (base) != 0)
+      continue;
+    GLint location = 0;
+    for (const UniformDeclaration& declared : program.uniforms)
+      location += declared.size;
+    program.uniforms.push_back (UniformDeclaration { name, getUniformType (uniform[1]),
+                                                     size, location });
+    program.locations[base] = location;
+    if (size > 1 || name != base)
+      for (GLint element = 0; element < size; ++element)
+        program.locations[base + "[" + std::to_string (element) + "]"] = location + element;
+  }
+}
+
+GLenum
+NullOpenGLContext::getUniformType (const std::string& glslType)
+{
+  static const std::map<std::string, GLenum> TYPES = {
+    { "bool", GL_BOOL }, { "int", GL_INT }, { "uint", GL_UNSIGNED_INT },
+    { "float", GL_FLOAT }, { "vec2", GL_FLOAT_VEC2 }, { "vec3", GL_FLOAT_VEC3 },
+    { "vec4", GL_FLOAT_VEC4 }, { "ivec2", GL_INT_VEC2 }, { "ivec3", GL_INT_VEC3 },
+    { "ivec4", GL_INT_VEC4 }, { "mat3", GL_FLOAT_MAT3 }, { "mat4", GL_FLOAT_MAT4 },
+    { "sampler2D", GL_SAMPLER_2D }, { "samplerBuffer", GL_SAMPLER_BUFFER },
+    { "usamplerBuffer", GL_UNSIGNED_INT_SAMPLER_BUFFER }
+  };
+  auto found = TYPES.find (glslType);
+  return found == TYPES.end () ? GL_FLOAT : found->second;
+}
+
+void
+NullOpenGLContext::generate (GLsizei n, GLuint* names)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    names[i] = m_nextName++;
+}
@@ -0,0 +1,378 @@
+/// \file NullOpenGLContext.hpp
+/// \brief Declaration of NullOpenGLContext and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef NULL_OPENGL_CONTEXT_HPP
+#define NULL_OPENGL_CONTEXT_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+
+/// \brief A subclass of OpenGLContext that does no rendering at all, so
+///   that the CPU cost of the code calling OpenGL can be measured (or tested)
+///   on a machine without a GPU or a window.
+///
+/// It hands out a new name for every object created, reports that every
+///   shader compiles and every program links, and answers queries for the
+///   viewport and framebuffer status.  Timer queries are always available,
+///   and always 0.  Just enough of each program is kept
+///   to introspect it: the uniforms and uniform blocks declared in its
+///   shaders' sources (whether or not the preprocessor would keep them), in
+///   declaration order.  Attributes aren't tracked, so getAttribLocation ()
+///   always returns -1.  Buffers can't be mapped (mapNamedBufferRange ()
+///   returns null) and no fences are made (fenceSync () returns null, and
+///   every wait is already signaled).  Every other call is ignored.
+class NullOpenGLContext : public OpenGLContext
+{
+public:
+
+  /// Constructs a NullOpenGLContext.
+  NullOpenGLContext ();
+
+  /// Destructs a NullOpenGLContext.
+  virtual
+  ~NullOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   NullOpenGLContexts.
+  NullOpenGLContext (const NullOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   NullOpenGLContexts.
+  NullOpenGLContext&
+  operator= (const NullOpenGLContext&) = delete;
+
+  virtual void
+  activeTexture (GLenum texture);
+
+  virtual void
+  attachShader (GLuint program, GLuint shader);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindBufferBase (GLenum target, GLuint index, GLuint buffer);
+
+  virtual void
+  bindFramebuffer (GLenum target, GLuint framebuffer);
+
+  virtual void
+  bindTexture (GLenum target, GLuint texture);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual GLenum
+  checkFramebufferStatus (GLenum target);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+  virtual void
+  compileShader (GLuint shader);
+
+  virtual void
+  createBuffers (GLsizei n, GLuint* buffers);
+
+  virtual GLuint
+  createProgram ();
+
+  virtual GLuint
+  createShader (GLenum shaderType);
+
+  virtual void
+  createVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteFramebuffers (GLsizei n, const GLuint* framebuffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
+  virtual void
+  deleteShader (GLuint shader);
+
+  virtual void
+  deleteSync (GLsync sync);
+
+  virtual void
+  deleteTextures (GLsizei n, const GLuint* textures);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  depthFunc (GLenum func);
+
+  virtual void
+  detachShader (GLuint program, GLuint shader);
+
+  virtual void
+  dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawBuffers (GLsizei n, const GLenum* bufs);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexArrayAttrib (GLuint vaobj, GLuint index);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual void
+  genBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  genFramebuffers (GLsizei n, GLuint* framebuffers);
+
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
+  virtual void
+  genTextures (GLsizei n, GLuint* textures);
+
+  virtual void
+  genVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+
+  virtual GLint
+  getAttribLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  getIntegerv (GLenum pname, GLint* data);
+
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
+  virtual void
+  getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getProgramiv (GLuint program, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
+  virtual void
+  getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getShaderiv (GLuint shader, GLenum pname, GLint* params);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual GLuint
+  getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName);
+
+  virtual GLint
+  getUniformLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void*
+  mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+  virtual void
+  maxShaderCompilerThreadsKHR (GLuint count);
+
+  virtual void
+  memoryBarrier (GLbitfield barriers);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+  virtual void
+  namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+
+  virtual void
+  namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+
+  virtual void
+  namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
+  virtual void
+  queryCounter (GLuint id, GLenum target);
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+
+  virtual void
+  texBuffer (GLenum target, GLenum internalformat, GLuint buffer);
+
+  virtual void
+  texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data);
+
+  virtual void
+  texParameteri (GLenum target, GLenum pname, GLint param);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+
+  virtual void
+  uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+
+  virtual void
+  uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual GLboolean
+  unmapNamedBuffer (GLuint buffer);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+
+  virtual void
+  vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+
+  virtual void
+  vertexArrayElementBuffer (GLuint vaobj, GLuint buffer);
+
+  virtual void
+  vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+protected:
+
+  /// \brief Gets the sources of the shaders attached to a program, one
+  ///   after another.
+  /// \param[in] program The program.
+  /// \return The sources, or an empty string if it has no shaders.
+  std::string
+  getProgramSource (GLuint program) const;
+
+private:
+
+  /// \brief One uniform declared by a program's shaders.
+  struct UniformDeclaration
+  {
+    /// Its name, with "[0]" appended if it is an array.
+    std::string name;
+    /// Its OpenGL type.
+    GLenum type;
+    /// Its number of elements.
+    GLint size;
+    /// The location of its first element.
+    GLint location;
+  };
+
+  /// \brief What introspecting a linked program can find out.
+  struct ProgramInfo
+  {
+    /// The shaders attached.
+    std::vector<GLuint> shaders;
+    /// The uniforms outside of blocks.
+    std::vector<UniformDeclaration> uniforms;
+    /// The location of every uniform and uniform array element, by name.
+    std::map<std::string, GLint> locations;
+    /// The uniform blocks, in order.
+    std::vector<std::string> blocks;
+  };
+
+  /// \brief Finds the uniforms and uniform blocks declared in a shader.
+  /// \param[in] source The shader's source.
+  /// \param[in,out] program The program to add them to; one already there
+  ///   (declared by another of its shaders) isn't added again.
+  static void
+  scanUniforms (const std::string& source, ProgramInfo& program);
+
+  /// \brief Gets the OpenGL type of a GLSL type name.
+  /// \param[in] glslType The name, e.g., "vec3".
+  /// \return The type, e.g., GL_FLOAT_VEC3.  Unknown names are GL_FLOAT.
+  static GLenum
+  getUniformType (const std::string& glslType);
+
+  /// \brief Hands out names for new objects.
+  /// \param[in] n The number of names.
+  /// \param[out] names Where to write them.
+  void
+  generate (GLsizei n, GLuint* names);
+
+  /// The next name handed out.  Names are unique across every kind of
+  ///   object.
+  GLuint m_nextName;
+  /// The source of every shader, by name.
+  std::map<GLuint, std::string> m_shaderSources;
+  /// Every program, by name.
+  std::map<GLuint, ProgramInfo> m_programs;
+  /// The viewport.
+  GLint m_viewport[4];
+};
+
+#endif//NULL_OPENGL_CONTEXT_HPP
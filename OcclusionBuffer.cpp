@@ -0,0 +1,322 @@
+/// \file OcclusionBuffer.cpp
+/// \brief Definition of OcclusionBuffer class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cmath>
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "OcclusionBuffer.hpp"
+#include "JobSystem.hpp"
+
+namespace
+{
+  /// The number of rows handed to each job by OcclusionBuffer::rasterize.
+  const unsigned int ROWS_PER_JOB = 16;
+
+  /// Points with a clip-space w at or below this are treated as behind the
+  ///   camera.
+  const float MIN_W = 1.0e-5f;
+
+  /// \brief Multiplies two column-major 4x4 matrices.
+  /// \param[in] a The matrix on the left.
+  /// \param[in] b The matrix on the right.
+  /// \param[out] out The product a * b, which must not overlap a or b.
+  void
+  multiply (const float* a, const float* b, float* out)
+  {
+    for (int col = 0; col < 4; ++col)
+      for (int row = 0; row < 4; ++row)
+        out[4 * col + row] = a[row] * b[4 * col]
+          + a[4 + row] * b[4 * col + 1]
+          + a[8 + row] * b[4 * col + 2]
+          + a[12 + row] * b[4 * col + 3];
+  }
+
+  /// \brief Transforms a point by a column-major 4x4 matrix.
+  /// \param[in] m The matrix.
+  /// \param[in] x The point's x coordinate.
+  /// \param[in] y The point's y coordinate.
+  /// \param[in] z The point's z coordinate.
+  /// \param[out] out The transformed (x, y, z, w).
+  void
+  transformPoint (const float* m, float x, float y, float z, float out[4])
+  {
+    for (int row = 0; row < 4; ++row)
+      out[row] = m[row] * x + m[4 + row] * y + m[8 + row] * z + m[12 + row];
+  }
+}
+
+OcclusionBuffer::OcclusionBuffer (unsigned int width, unsigned int height)
+  : m_width (width), m_height (height)
+{
+  std::fill (m_viewProjection, m_viewProjection + 16, 0.0f);
+  unsigned int w = width;
+  unsigned int h = height;
+  while (true)
+  {
+    m_levels.emplace_back (w * h, 1.0f);
+    if (w == 1 && h == 1)
+      break;
+    w = std::max (1u, w / 2);
+    h = std::max (1u, h / 2);
+  }
+}
+
+OcclusionBuffer::~OcclusionBuffer ()
+{
+}
+
+void
+OcclusionBuffer::begin (const Matrix4& viewProjection)
+{
+  std::copy (viewProjection.data (), viewProjection.data () + 16,
+             m_viewProjection);
+  m_triangles.clear ();
+  for (std::vector<float>& level : m_levels)
+    std::fill (level.begin (), level.end (), 1.0f);
+}
+
+void
+OcclusionBuffer::addOccluder (const float world[16], const float* vertices,
+                              unsigned int stride, const unsigned int* indices,
+                              unsigned int indexCount)
+{
+  float toClip[16];
+  multiply (m_viewProjection, world, toClip);
+  for (unsigned int i = 0; i + 2 < indexCount; i += 3)
+  {
+    float screen[9];
+    bool keep = true;
+    for (int corner = 0; corner < 3 && keep; ++corner)
+    {
+      const float* p = vertices + stride * indices[i + corner];
+      float clip[4];
+      transformPoint (toClip, p[0], p[1], p[2], clip);
+      // Geometry in front of the near plane is clipped away by OpenGL, so it
+      //   must not hide anything here either.
+      keep = clip[3] > MIN_W && clip[2] >= -clip[3];
+      screen[3 * corner + 0] = (clip[0] / clip[3] * 0.5f + 0.5f) * m_width;
+      screen[3 * corner + 1] = (clip[1] / clip[3] * 0.5f + 0.5f) * m_height;
+      screen[3 * corner + 2] = clip[2] / clip[3] * 0.5f + 0.5f;
+    }
+    if (!keep)
+      continue;
+
+    float area = (screen[3] - screen[0]) * (screen[7] - screen[1])
+      - (screen[6] - screen[0]) * (screen[4] - screen[1]);
+    if (area == 0.0f)
+      continue;
+    // Store every triangle counter-clockwise so that the inside is where all
+    //   three edge functions are non-negative.
+    if (area < 0.0f)
+      for (int c = 0; c < 3; ++c)
+        std::swap (screen[3 + c], screen[6 + c]);
+
+    float lowX = std::min ({ screen[0], screen[3], screen[6] });
+    float highX = std::max ({ screen[0], screen[3], screen[6] });
+    float lowY = std::min ({ screen[1], screen[4], screen[7] });
+    float highY = std::max ({ screen[1], screen[4], screen[7] });
+    if (highX < 0.0f || highY < 0.0f || lowX >= m_width || lowY >= m_height)
+      continue;
+    m_triangles.insert (m_triangles.end (), screen, screen + 9);
+  }
+}
+
+void
+OcclusionBuffer::rasterize (JobSystem* jobs)
+{
+  if (jobs == nullptr)
+    rasterizeRows (0, m_height);
+  else
+    jobs->parallelFor (0, m_height, ROWS_PER_JOB,
+                       [this] (unsigned int first, unsigned int last)
+                       { rasterizeRows (first, last); });
+
+  // Each texel of the next level keeps the farthest of the (up to) four
+  //   texels beneath it.
+  unsigned int w = m_width;
+  unsigned int h = m_height;
+  for (unsigned int level = 1; level < m_levels.size (); ++level)
+  {
+    const std::vector<float>& below = m_levels[level - 1];
+    std::vector<float>& above = m_levels[level];
+    unsigned int aboveW = std::max (1u, w / 2);
+    unsigned int aboveH = std::max (1u, h / 2);
+    for (unsigned int y = 0; y < aboveH; ++y)
+    {
+      unsigned int y0 = std::min (2 * y, h - 1);
+      unsigned int y1 = std::min (2 * y + 1, h - 1);
+      for (unsigned int x = 0; x < aboveW; ++x)
+      {
+        unsigned int x0 = std::min (2 * x, w - 1);
+        unsigned int x1 = std::min (2 * x + 1, w - 1);
+        above[y * aboveW + x] = std::max (std::max (below[y0 * w + x0], below[y0 * w + x1]),
+                                          std::max (below[y1 * w + x0], below[y1 * w + x1]));
+      }
+    }
+    w = aboveW;
+    h = aboveH;
+  }
+}
+
+bool
+OcclusionBuffer::isVisible (const float world[16], const Vector3& center,
+                            float radius) const
+{
+  float worldCenter[4];
+  transformPoint (world, center.m_x, center.m_y, center.m_z, worldCenter);
+  float scaleSquared = 0.0f;
+  for (int col = 0; col < 3; ++col)
+  {
+    const float* c = world + 4 * col;
+    scaleSquared = std::max (scaleSquared, c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+  }
+  float r = radius * std::sqrt (scaleSquared);
+
+  const float INF = std::numeric_limits<float>::infinity ();
+  float lowX = INF, lowY = INF, nearest = INF;
+  float highX = -INF, highY = -INF;
+  for (int corner = 0; corner < 8; ++corner)
+  {
+    float clip[4];
+    transformPoint (m_viewProjection,
+                    worldCenter[0] + ((corner & 1) ? r : -r),
+                    worldCenter[1] + ((corner & 2) ? r : -r),
+                    worldCenter[2] + ((corner & 4) ? r : -r), clip);
+    if (clip[3] <= MIN_W || clip[2] < -clip[3])
+      return true;
+    float x = (clip[0] / clip[3] * 0.5f + 0.5f) * m_width;
+    float y = (clip[1] / clip[3] * 0.5f + 0.5f) * m_height;
+    lowX = std::min (lowX, x);
+    highX = std::max (highX, x);
+    lowY = std::min (lowY, y);
+    highY = std::max (highY, y);
+    nearest = std::min (nearest, clip[2] / clip[3] * 0.5f + 0.5f);
+  }
+  // Anything off-screen is the frustum test's job.
+  if (highX < 0.0f || highY < 0.0f || lowX >= m_width || lowY >= m_height)
+    return true;
+
+  unsigned int x0 = static_cast<unsigned int> (std::max (0.0f, lowX));
+  unsigned int y0 = static_cast<unsigned int> (std::max (0.0f, lowY));
+  unsigned int x1 = std::min (m_width - 1, static_cast<unsigned int> (highX));
+  unsigned int y1 = std::min (m_height - 1, static_cast<unsigned int> (highY));
+
+  // Climb until the box spans at most two texels in each direction.
+  unsigned int level = 0;
+  while (level + 1 < m_levels.size ()
+         && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1))
+    ++level;
+  unsigned int levelW = std::max (1u, m_width >> level);
+  unsigned int levelH = std::max (1u, m_height >> level);
+  const std::vector<float>& depths = m_levels[level];
+  float farthest = 0.0f;
+  for (unsigned int y = y0 >> level; y <= std::min (y1 >> level, levelH - 1); ++y)
+    for (unsigned int x = x0 >> level; x <= std::min (x1 >> level, levelW - 1); ++x)
+      farthest = std::max (farthest, depths[y * levelW + x]);
+  return nearest <= farthest;
+}
+
+unsigned int
+OcclusionBuffer::getTriangleCount () const
+{
+  return m_triangles.size () / 9;
+}
+
+float
+OcclusionBuffer::getDepth (unsigned int x, unsigned int y,
+                           unsigned int level) const
+{
+  return m_levels[level][y * std::max (1u, m_width >> level) + x];
+}
+
+void
+OcclusionBuffer::rasterizeRows (unsigned int firstRow, unsigned int lastRow)
+{
+  float* depths = m_levels[0].data ();
+  for (unsigned int t = 0; t < m_triangles.size (); t += 9)
+  {
+    const float* v = &m_triangles[t];
+    float x0 = v[0], y0 = v[1], z0 = v[2];
+    float x1 = v[3], y1 = v[4], z1 = v[5];
+    float x2 = v[6], y2 = v[7], z2 = v[8];
+
+    int lowY = std::max (static_cast<int> (firstRow),
+                         static_cast<int> (std::floor (std::min ({ y0, y1, y2 }))));
+    int highY = std::min (static_cast<int> (lastRow) - 1,
+                          static_cast<int> (std::ceil (std::max ({ y0, y1, y2 }))));
+    // Start on a multiple of 4 so that groups of 4 pixels never run past the
+    //   end of a row.
+    int lowX = std::max (0, static_cast<int> (std::floor (std::min ({ x0, x1, x2 })))) & ~3;
+    int highX = std::min (static_cast<int> (m_width) - 1,
+                          static_cast<int> (std::ceil (std::max ({ x0, x1, x2 }))));
+    if (lowY > highY || lowX > highX)
+      continue;
+
+    float invArea = 1.0f / ((x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0));
+    // Each edge function is positive on the side of its edge facing the
+    //   opposite vertex, and grows by its step for each pixel to the right.
+    float step0 = y1 - y2;
+    float step1 = y2 - y0;
+    float step2 = y0 - y1;
+    for (int y = lowY; y <= highY; ++y)
+    {
+      float px = lowX + 0.5f;
+      float py = y + 0.5f;
+      float e0 = (x2 - x1) * (py - y1) - (y2 - y1) * (px - x1);
+      float e1 = (x0 - x2) * (py - y2) - (y0 - y2) * (px - x2);
+      float e2 = (x1 - x0) * (py - y0) - (y1 - y0) * (px - x0);
+      float* row = depths + y * m_width;
+      int x = lowX;
+#ifdef __SSE__
+      const __m128 lanes = _mm_set_ps (3.0f, 2.0f, 1.0f, 0.0f);
+      const __m128 zero = _mm_setzero_ps ();
+      __m128 edge0 = _mm_add_ps (_mm_set1_ps (e0), _mm_mul_ps (lanes, _mm_set1_ps (step0)));
+      __m128 edge1 = _mm_add_ps (_mm_set1_ps (e1), _mm_mul_ps (lanes, _mm_set1_ps (step1)));
+      __m128 edge2 = _mm_add_ps (_mm_set1_ps (e2), _mm_mul_ps (lanes, _mm_set1_ps (step2)));
+      const __m128 step0x4 = _mm_set1_ps (4.0f * step0);
+      const __m128 step1x4 = _mm_set1_ps (4.0f * step1);
+      const __m128 step2x4 = _mm_set1_ps (4.0f * step2);
+      const __m128 depth0 = _mm_set1_ps (z0 * invArea);
+      const __m128 depth1 = _mm_set1_ps (z1 * invArea);
+      const __m128 depth2 = _mm_set1_ps (z2 * invArea);
+      for (; x <= highX; x += 4)
+      {
+        __m128 inside = _mm_and_ps (_mm_and_ps (_mm_cmpge_ps (edge0, zero),
+                                                _mm_cmpge_ps (edge1, zero)),
+                                    _mm_cmpge_ps (edge2, zero));
+        if (_mm_movemask_ps (inside) != 0)
+        {
+          __m128 z = _mm_add_ps (_mm_add_ps (_mm_mul_ps (edge0, depth0),
+                                             _mm_mul_ps (edge1, depth1)),
+                                 _mm_mul_ps (edge2, depth2));
+          __m128 old = _mm_loadu_ps (row + x);
+          __m128 nearer = _mm_min_ps (old, z);
+          _mm_storeu_ps (row + x, _mm_or_ps (_mm_and_ps (inside, nearer),
+                                             _mm_andnot_ps (inside, old)));
+        }
+        edge0 = _mm_add_ps (edge0, step0x4);
+        edge1 = _mm_add_ps (edge1, step1x4);
+        edge2 = _mm_add_ps (edge2, step2x4);
+      }
+#else
+      for (; x <= highX; ++x)
+      {
+        if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f)
+          row[x] = std::min (row[x], (e0 * z0 + e1 * z1 + e2 * z2) * invArea);
+        e0 += step0;
+        e1 += step1;
+        e2 += step2;
+      }
+#endif
+    }
+  }
+}
@@ -0,0 +1,130 @@
+/// \file OcclusionBuffer.hpp
+/// \brief Declaration of OcclusionBuffer class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef OCCLUSION_BUFFER_HPP
+#define OCCLUSION_BUFFER_HPP
+
+#include <vector>
+
+#include "Vector3.hpp"
+#include "Matrix4.hpp"
+
+class JobSystem;
+
+/// \brief A small software depth buffer, used to skip objects that are hidden
+///   behind large occluders (e.g., asteroids behind a planet) before they are
+///   ever sent to OpenGL.
+///
+/// Each frame: begin () clears the buffer, addOccluder () is called for each
+///   occluding mesh (or a simplified version of it), and rasterize () draws
+///   the occluders' triangles into the buffer (in horizontal bands, one job
+///   per band, four pixels at a time with SSE) and builds a hierarchical-Z
+///   pyramid in which each texel holds the farthest depth of the four below
+///   it.  isVisible () then projects an object's bounding box to the screen
+///   and compares its nearest depth with the farthest depth under it, read
+///   from the pyramid level where the box covers at most 2x2 texels, so each
+///   test costs the same however large the object appears.
+///
+/// Depths are window depths in [0, 1], where 0 is the near plane.  Every
+///   test errs towards visible: occluder triangles that cross the near plane
+///   are dropped, and objects that cross it are never culled.
+class OcclusionBuffer
+{
+public:
+
+  /// \brief Constructs an OcclusionBuffer.
+  /// \param[in] width The width of the depth buffer, in pixels.  Must be a
+  ///   power of two, and at least 4.
+  /// \param[in] height The height of the depth buffer, in pixels.  Must be a
+  ///   power of two.
+  OcclusionBuffer (unsigned int width = 256, unsigned int height = 128);
+
+  /// \brief Destructs an OcclusionBuffer.
+  ~OcclusionBuffer ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   OcclusionBuffers.
+  OcclusionBuffer (const OcclusionBuffer&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   OcclusionBuffers.
+  OcclusionBuffer&
+  operator= (const OcclusionBuffer&) = delete;
+
+  /// \brief Starts a new frame.
+  /// \param[in] viewProjection The camera's projection matrix times its view
+  ///   matrix.
+  /// \post There are no occluders, and every depth is 1 (the far plane).
+  void
+  begin (const Matrix4& viewProjection);
+
+  /// \brief Adds the triangles of an occluder.
+  /// \param[in] world The occluder's column-major 4x4 world matrix.
+  /// \param[in] vertices Interleaved vertices, each starting with a 3-D
+  ///   position.
+  /// \param[in] stride The number of floats from one vertex to the next.
+  /// \param[in] indices Three vertex numbers per triangle.
+  /// \param[in] indexCount The number of indices.
+  /// \post The triangles will be drawn by the next rasterize ().
+  void
+  addOccluder (const float world[16], const float* vertices,
+               unsigned int stride, const unsigned int* indices,
+               unsigned int indexCount);
+
+  /// \brief Draws every added occluder and builds the depth pyramid.
+  /// \param[in] jobs The JobSystem to split the work over, or nullptr.
+  /// \post isVisible () reflects every occluder added since begin ().
+  void
+  rasterize (JobSystem* jobs = nullptr);
+
+  /// \brief Tests whether or not an object might be visible past the
+  ///   occluders.
+  /// \param[in] world The object's column-major 4x4 world matrix.
+  /// \param[in] center The center of the object's bounding sphere, in its
+  ///   local coordinates.
+  /// \param[in] radius The radius of the object's bounding sphere, in its
+  ///   local coordinates.
+  /// \return False only if the whole bounding box of the sphere is behind
+  ///   the occluders.  Safe to call from many threads at once.
+  bool
+  isVisible (const float world[16], const Vector3& center, float radius) const;
+
+  /// \brief Gets the number of occluder triangles that will be (or were)
+  ///   drawn this frame.
+  /// \return The number of triangles that survived near-plane and screen
+  ///   rejection.
+  unsigned int
+  getTriangleCount () const;
+
+  /// \brief Gets a depth from the pyramid.
+  /// \param[in] x The column, less than the level's width.
+  /// \param[in] y The row, less than the level's height.
+  /// \param[in] level 0 for the full-resolution buffer, 1 for half, etc.
+  /// \return The farthest depth within that texel.
+  float
+  getDepth (unsigned int x, unsigned int y, unsigned int level = 0) const;
+
+private:
+
+  /// \brief Draws the triangles into some rows of the full-resolution buffer.
+  /// \param[in] firstRow The first row to draw.
+  /// \param[in] lastRow One past the last row to draw.
+  void
+  rasterizeRows (unsigned int firstRow, unsigned int lastRow);
+
+  /// The width of level 0.
+  unsigned int m_width;
+  /// The height of level 0.
+  unsigned int m_height;
+  /// The camera's projection matrix times its view matrix, column-major.
+  float m_viewProjection[16];
+  /// The screen-space triangles, as (x, y, depth) for each of 3 vertices.
+  std::vector<float> m_triangles;
+  /// The depth pyramid, with the full-resolution buffer first.
+  std::vector<std::vector<float>> m_levels;
+};
+
+#endif//OCCLUSION_BUFFER_HPP
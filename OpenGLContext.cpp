@@ -4,7 +4,39 @@
 /// \version A02
 
 #include "OpenGLContext.hpp"
+#include "GpuProfiler.hpp"
+
+OpenGLContext::OpenGLContext ()
+  : m_profiler (nullptr)
+{
+}
 
 OpenGLContext::~OpenGLContext ()
 {
 }
+
+void
+OpenGLContext::setProfiler (GpuProfiler* profiler)
+{
+  m_profiler = profiler;
+}
+
+GpuProfiler*
+OpenGLContext::getProfiler () const
+{
+  return m_profiler;
+}
+
+void
+OpenGLContext::beginScope (const char* name, bool detailed)
+{
+  if (m_profiler != nullptr)
+    m_profiler->beginScope (name, detailed);
+}
+
+void
+OpenGLContext::endScope (bool detailed)
+{
+  if (m_profiler != nullptr)
+    m_profiler->endScope (detailed);
+}
@@ -11,6 +11,8 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
 
+class GpuProfiler;
+
 /// \brief A class that works as a proxy between clients and the OpenGL
 ///   library.
 ///
@@ -24,10 +26,44 @@ class OpenGLContext
 {
 public:
 
+  /// Constructs an OpenGLContext with no GpuProfiler.
+  OpenGLContext ();
+
   /// Destructs an OpenGLContext.
   virtual
   ~OpenGLContext () = 0;
 
+  /// \brief Attaches the GpuProfiler that beginScope () and endScope () time
+  ///   scopes with.
+  /// \param[in] profiler The profiler, which should make its queries through
+  ///   this context (or the one it passes calls on to) and must outlive its
+  ///   use here, or nullptr to time nothing.
+  void
+  setProfiler (GpuProfiler* profiler);
+
+  /// \brief Gets the attached GpuProfiler.
+  /// \return The profiler, or nullptr if there is none.
+  GpuProfiler*
+  getProfiler () const;
+
+  /// \brief Starts timing a named scope of GPU work, if a GpuProfiler is
+  ///   attached (see GpuProfiler::beginScope).
+  /// \param[in] name The scope's name.
+  /// \param[in] detailed Whether or not the scope is only timed in the
+  ///   profiler's detailed mode.
+  void
+  beginScope (const char* name, bool detailed = false);
+
+  /// \brief Stops timing the scope begun most recently, if a GpuProfiler is
+  ///   attached.
+  /// \param[in] detailed The value passed to the matching beginScope ().
+  void
+  endScope (bool detailed = false);
+
+  /// See documentation of glActiveTexture.
+  virtual void
+  activeTexture (GLenum texture) = 0;
+
   /// See documentation of glAttachShader.
   virtual void
   attachShader (GLuint program, GLuint shader) = 0;
@@ -36,6 +72,18 @@ public:
   virtual void
   bindBuffer (GLenum target, GLuint buffer) = 0;
 
+  /// See documentation of glBindBufferBase.
+  virtual void
+  bindBufferBase (GLenum target, GLuint index, GLuint buffer) = 0;
+
+  /// See documentation of glBindFramebuffer.
+  virtual void
+  bindFramebuffer (GLenum target, GLuint framebuffer) = 0;
+
+  /// See documentation of glBindTexture.
+  virtual void
+  bindTexture (GLenum target, GLuint texture) = 0;
+
   /// See documentation of glBindVertexArray.
   virtual void
   bindVertexArray (GLuint array) = 0;
@@ -44,6 +92,14 @@ public:
   virtual void
   bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage) = 0;
 
+  /// See documentation of glBufferSubData.
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data) = 0;
+
+  /// See documentation of glCheckFramebufferStatus.
+  virtual GLenum
+  checkFramebufferStatus (GLenum target) = 0;
+
   /// See documentation of glClear.
   virtual void
   clear (GLbitfield mask) = 0;
@@ -52,10 +108,18 @@ public:
   virtual void
   clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) = 0;
 
+  /// See documentation of glClientWaitSync.
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout) = 0;
+
   /// See documentation of glCompileShader.
   virtual void
   compileShader (GLuint shader) = 0;
 
+  /// See documentation of glCreateBuffers.
+  virtual void
+  createBuffers (GLsizei n, GLuint* buffers) = 0;
+
   /// See documentation of glCreateProgram.
   virtual GLuint
   createProgram () = 0;
@@ -64,6 +128,10 @@ public:
   virtual GLuint
   createShader (GLenum shaderType) = 0;
 
+  /// See documentation of glCreateVertexArrays.
+  virtual void
+  createVertexArrays (GLsizei n, GLuint* arrays) = 0;
+
   /// See documentation of glCullFace.
   virtual void
   cullFace (GLenum mode) = 0;
@@ -72,26 +140,54 @@ public:
   virtual void
   deleteBuffers (GLsizei n, const GLuint* buffers) = 0;
 
+  /// See documentation of glDeleteFramebuffers.
+  virtual void
+  deleteFramebuffers (GLsizei n, const GLuint* framebuffers) = 0;
+
   /// See documentation of glDeleteProgram.
   virtual void
   deleteProgram (GLuint program) = 0;
 
+  /// See documentation of glDeleteQueries.
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids) = 0;
+
   /// See documentation of glDeleteShader.
   virtual void
   deleteShader (GLuint shader) = 0;
 
+  /// See documentation of glDeleteSync.
+  virtual void
+  deleteSync (GLsync sync) = 0;
+
+  /// See documentation of glDeleteTextures.
+  virtual void
+  deleteTextures (GLsizei n, const GLuint* textures) = 0;
+
   /// See documentation of glDeleteVertexArrays.
   virtual void
   deleteVertexArrays (GLsizei n, const GLuint* arrays) = 0;
 
+  /// See documentation of glDepthFunc.
+  virtual void
+  depthFunc (GLenum func) = 0;
+
   /// See documentation of glDetachShader.
   virtual void
   detachShader (GLuint program, GLuint shader) = 0;
 
+  /// See documentation of glDispatchCompute.
+  virtual void
+  dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z) = 0;
+
   /// See documentation of glDrawArrays.
   virtual void
   drawArrays (GLenum mode, GLint first, GLsizei count) = 0;
 
+  /// See documentation of glDrawBuffers.
+  virtual void
+  drawBuffers (GLsizei n, const GLenum* bufs) = 0;
+
   /// See documentation of glDrawElements.
   virtual void
   drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices) = 0;
@@ -100,10 +196,22 @@ public:
   virtual void
   enable (GLenum cap) = 0;
 
+  /// See documentation of glEnableVertexArrayAttrib.
+  virtual void
+  enableVertexArrayAttrib (GLuint vaobj, GLuint index) = 0;
+
   /// See documentation of glEnableVertexAttribArray.
   virtual void
   enableVertexAttribArray (GLuint index) = 0;
 
+  /// See documentation of glFenceSync.
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags) = 0;
+
+  /// See documentation of glFramebufferTexture2D.
+  virtual void
+  framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level) = 0;
+
   /// See documentation of glFrontFace.
   virtual void
   frontFace (GLenum mode) = 0;
@@ -112,14 +220,38 @@ public:
   virtual void
   genBuffers (GLsizei n, GLuint* buffers) = 0;
 
+  /// See documentation of glGenFramebuffers.
+  virtual void
+  genFramebuffers (GLsizei n, GLuint* framebuffers) = 0;
+
+  /// See documentation of glGenQueries.
+  virtual void
+  genQueries (GLsizei n, GLuint* ids) = 0;
+
+  /// See documentation of glGenTextures.
+  virtual void
+  genTextures (GLsizei n, GLuint* textures) = 0;
+
   /// See documentation of glGenVertexArrays.
   virtual void
   genVertexArrays (GLsizei n, GLuint* arrays) = 0;
 
+  /// See documentation of glGetActiveUniform.
+  virtual void
+  getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name) = 0;
+
   /// See documentation of glGetAttribLocation.
   virtual GLint
   getAttribLocation (GLuint program, const GLchar* name) = 0;
 
+  /// See documentation of glGetIntegerv.
+  virtual void
+  getIntegerv (GLenum pname, GLint* data) = 0;
+
+  /// See documentation of glGetProgramBinary.
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) = 0;
+
   /// See documentation of glGetProgramInfoLog.
   virtual void
   getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog) = 0;
@@ -128,6 +260,14 @@ public:
   virtual void
   getProgramiv (GLuint program, GLenum pname, GLint* params) = 0;
 
+  /// See documentation of glGetQueryObjectiv.
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params) = 0;
+
+  /// See documentation of glGetQueryObjectui64v.
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params) = 0;
+
   /// See documentation of glGetShaderInfoLog.
   virtual void
   getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog) = 0;
@@ -140,6 +280,10 @@ public:
   virtual const GLubyte*
   getString (GLenum name) = 0;
 
+  /// See documentation of glGetUniformBlockIndex.
+  virtual GLuint
+  getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName) = 0;
+
   /// See documentation of glGetUniformLocation.
   virtual GLint
   getUniformLocation (GLuint program, const GLchar* name) = 0;
@@ -148,18 +292,114 @@ public:
   virtual void
   linkProgram (GLuint program) = 0;
 
+  /// See documentation of glMapNamedBufferRange.
+  virtual void*
+  mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access) = 0;
+
+  /// See documentation of glMaxShaderCompilerThreadsKHR.
+  virtual void
+  maxShaderCompilerThreadsKHR (GLuint count) = 0;
+
+  /// See documentation of glMemoryBarrier.
+  virtual void
+  memoryBarrier (GLbitfield barriers) = 0;
+
+  /// See documentation of glMultiDrawElementsIndirect.
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride) = 0;
+
+  /// See documentation of glMultiDrawElementsIndirectCount.
+  virtual void
+  multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride) = 0;
+
+  /// See documentation of glNamedBufferData.
+  virtual void
+  namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage) = 0;
+
+  /// See documentation of glNamedBufferStorage.
+  virtual void
+  namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags) = 0;
+
+  /// See documentation of glNamedBufferSubData.
+  virtual void
+  namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data) = 0;
+
+  /// See documentation of glProgramBinary.
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) = 0;
+
+  /// See documentation of glProgramParameteri.
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value) = 0;
+
+  /// See documentation of glQueryCounter.
+  virtual void
+  queryCounter (GLuint id, GLenum target) = 0;
+
   /// See documentation of glShaderSource.
   virtual void
   shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length) = 0;
 
+  /// See documentation of glTexBuffer.
+  virtual void
+  texBuffer (GLenum target, GLenum internalformat, GLuint buffer) = 0;
+
+  /// See documentation of glTexImage2D.
+  virtual void
+  texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data) = 0;
+
+  /// See documentation of glTexParameteri.
+  virtual void
+  texParameteri (GLenum target, GLenum pname, GLint param) = 0;
+
+  /// See documentation of glUniform1f.
+  virtual void
+  uniform1f (GLint location, GLfloat v0) = 0;
+
+  /// See documentation of glUniform1i.
+  virtual void
+  uniform1i (GLint location, GLint v0) = 0;
+
+  /// See documentation of glUniform3f.
+  virtual void
+  uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2) = 0;
+
+  /// See documentation of glUniformBlockBinding.
+  virtual void
+  uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding) = 0;
+
+  /// See documentation of glUniformMatrix3fv.
+  virtual void
+  uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) = 0;
+
   /// See documentation of glUniformMatrix4fv.
   virtual void
   uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value) = 0;
 
+  /// See documentation of glUnmapNamedBuffer.
+  virtual GLboolean
+  unmapNamedBuffer (GLuint buffer) = 0;
+
   /// See documentation of glUseProgram.
   virtual void
   useProgram (GLuint program) = 0;
 
+  /// See documentation of glVertexArrayAttribBinding.
+  virtual void
+  vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex) = 0;
+
+  /// See documentation of glVertexArrayAttribFormat.
+  virtual void
+  vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset) = 0;
+
+  /// See documentation of glVertexArrayElementBuffer.
+  virtual void
+  vertexArrayElementBuffer (GLuint vaobj, GLuint buffer) = 0;
+
+  /// See documentation of glVertexArrayVertexBuffer.
+  virtual void
+  vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride) = 0;
+
   /// See documentation of glVertexAttribPointer.
   virtual void
   vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer) = 0;
@@ -168,6 +408,10 @@ public:
   virtual void
   viewport (GLint x, GLint y, GLsizei width, GLsizei height) = 0;
 
+private:
+
+  /// The profiler that scopes are timed with, or nullptr.
+  GpuProfiler* m_profiler;
 };
 
 #endif//OPENGL_CONTEXT_HPP
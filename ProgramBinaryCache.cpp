@@ -0,0 +1,198 @@
+/// \file ProgramBinaryCache.cpp
+/// \brief Definition of ProgramBinaryCache class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "ProgramBinaryCache.hpp"
+
+namespace
+{
+  /// The first four bytes of every cache file.
+  const uint32_t MAGIC = 0x43425053;
+
+  /// \brief The header at the start of every cache file.
+  struct FileHeader
+  {
+    /// Always MAGIC.
+    uint32_t magic;
+    /// The format the driver gave the binary.
+    uint32_t format;
+    /// The key the binary was stored under, to catch renamed files.
+    uint64_t key;
+    /// The size of the binary that follows, in bytes.
+    uint64_t length;
+  };
+
+  /// \brief Continues a 64-bit FNV-1a hash.
+  /// \param[in] hash The hash so far.
+  /// \param[in] text The bytes to add.
+  /// \return The new hash.
+  uint64_t
+  hashString (uint64_t hash, const std::string& text)
+  {
+    for (unsigned char c : text)
+    {
+      hash ^= c;
+      hash *= 1099511628211ull;
+    }
+    // Separate consecutive strings, so "ab" + "c" differs from "a" + "bc".
+    hash ^= 0xff;
+    hash *= 1099511628211ull;
+    return hash;
+  }
+
+  /// \brief Gets an OpenGL string, which may be null.
+  /// \param[in] context The context to ask.
+  /// \param[in] name Which string.
+  /// \return The string, or an empty string.
+  std::string
+  getGlString (OpenGLContext* context, GLenum name)
+  {
+    const GLubyte* text = context->getString (name);
+    return (text == nullptr) ? std::string () : reinterpret_cast<const char*> (text);
+  }
+}
+
+ProgramBinaryCache::ProgramBinaryCache (OpenGLContext* context,
+                                        const std::string& directory)
+  : m_context (context), m_directory (directory), m_enabled (false),
+    m_hits (0), m_misses (0)
+{
+  GLint formats = 0;
+  m_context->getIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+  m_enabled = formats > 0;
+  m_driver = getGlString (m_context, GL_VENDOR) + "\n"
+    + getGlString (m_context, GL_RENDERER) + "\n"
+    + getGlString (m_context, GL_VERSION);
+  if (m_enabled)
+    mkdir (m_directory.c_str (), 0755);
+}
+
+ProgramBinaryCache::~ProgramBinaryCache ()
+{
+}
+
+bool
+ProgramBinaryCache::isEnabled () const
+{
+  return m_enabled;
+}
+
+uint64_t
+ProgramBinaryCache::makeKey (const std::string& vertexSource,
+                             const std::string& fragmentSource) const
+{
+  uint64_t hash = 14695981039346656037ull;
+  hash = hashString (hash, m_driver);
+  hash = hashString (hash, vertexSource);
+  hash = hashString (hash, fragmentSource);
+  return hash;
+}
+
+bool
+ProgramBinaryCache::load (GLuint program, uint64_t key)
+{
+  if (!m_enabled)
+  {
+    ++m_misses;
+    return false;
+  }
+  std::string path = getPath (key);
+  std::ifstream file (path, std::ios::binary);
+  FileHeader header;
+  if (!file.read (reinterpret_cast<char*> (&header), sizeof (header))
+      || header.magic != MAGIC || header.key != key)
+  {
+    ++m_misses;
+    return false;
+  }
+  std::vector<char> binary (header.length);
+  if (!file.read (binary.data (), binary.size ()))
+  {
+    ++m_misses;
+    return false;
+  }
+  m_context->programBinary (program, header.format, binary.data (), binary.size ());
+  GLint isLinked = GL_FALSE;
+  m_context->getProgramiv (program, GL_LINK_STATUS, &isLinked);
+  if (isLinked == GL_FALSE)
+  {
+    // The driver no longer accepts this binary, so the next store () will
+    //   replace it.
+    fprintf (stderr, "Cached shader program %s was rejected; recompiling\n",
+             path.c_str ());
+    file.close ();
+    std::remove (path.c_str ());
+    ++m_misses;
+    return false;
+  }
+  ++m_hits;
+  return true;
+}
+
+void
+ProgramBinaryCache::prepare (GLuint program)
+{
+  if (m_enabled)
+    m_context->programParameteri (program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+void
+ProgramBinaryCache::store (GLuint program, uint64_t key)
+{
+  if (!m_enabled)
+    return;
+  GLint length = 0;
+  m_context->getProgramiv (program, GL_PROGRAM_BINARY_LENGTH, &length);
+  if (length <= 0)
+    return;
+  std::vector<char> binary (length);
+  GLenum format = 0;
+  m_context->getProgramBinary (program, length, &length, &format, binary.data ());
+
+  // Write to a temporary file and rename it, so that a crash (or another
+  //   instance of the program) never sees half a binary.
+  std::string path = getPath (key);
+  std::string temporary = path + ".tmp";
+  {
+    std::ofstream file (temporary, std::ios::binary | std::ios::trunc);
+    FileHeader header = { MAGIC, format, key, static_cast<uint64_t> (length) };
+    file.write (reinterpret_cast<const char*> (&header), sizeof (header));
+    file.write (binary.data (), length);
+    if (!file)
+    {
+      fprintf (stderr, "Failed to write %s\n", temporary.c_str ());
+      file.close ();
+      std::remove (temporary.c_str ());
+      return;
+    }
+  }
+  std::rename (temporary.c_str (), path.c_str ());
+}
+
+unsigned int
+ProgramBinaryCache::getHits () const
+{
+  return m_hits;
+}
+
+unsigned int
+ProgramBinaryCache::getMisses () const
+{
+  return m_misses;
+}
+
+std::string
+ProgramBinaryCache::getPath (uint64_t key) const
+{
+  char name[32];
+  snprintf (name, sizeof (name), "%016llx.bin", static_cast<unsigned long long> (key));
+  return m_directory + "/" + name;
+}
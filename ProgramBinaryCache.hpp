@@ -0,0 +1,112 @@
+/// \file ProgramBinaryCache.hpp
+/// \brief Declaration of ProgramBinaryCache class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef PROGRAM_BINARY_CACHE_HPP
+#define PROGRAM_BINARY_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+
+#include "OpenGLContext.hpp"
+
+/// \brief A directory of linked shader programs, saved with
+///   glGetProgramBinary so that later runs can skip compiling and linking.
+///
+/// Each program is stored under a 64-bit hash of its final shader sources
+///   (including any injected #defines) and the driver's vendor, renderer, and
+///   version strings, so editing a shader or updating the driver simply
+///   misses the cache.  If the driver does not support program binaries, the
+///   cache is disabled and every lookup misses.
+class ProgramBinaryCache
+{
+public:
+
+  /// \brief Constructs a ProgramBinaryCache.
+  /// \param[in] context The context to make OpenGL calls through.
+  /// \param[in] directory The directory to keep the binaries in, which is
+  ///   created if needed.
+  /// \pre The OpenGL context has been created.
+  ProgramBinaryCache (OpenGLContext* context, const std::string& directory);
+
+  /// \brief Destructs a ProgramBinaryCache.  The files are kept.
+  ~ProgramBinaryCache ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   ProgramBinaryCaches.
+  ProgramBinaryCache (const ProgramBinaryCache&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   ProgramBinaryCaches.
+  ProgramBinaryCache&
+  operator= (const ProgramBinaryCache&) = delete;
+
+  /// \brief Tests whether or not the driver can save program binaries.
+  /// \return Whether or not load () and store () do anything.
+  bool
+  isEnabled () const;
+
+  /// \brief Computes the key of a program.
+  /// \param[in] vertexSource The final vertex shader source.
+  /// \param[in] fragmentSource The final fragment shader source.
+  /// \return A hash of both sources and the driver's identity.
+  uint64_t
+  makeKey (const std::string& vertexSource,
+           const std::string& fragmentSource) const;
+
+  /// \brief Tries to load a program from the cache.
+  /// \param[in] program The OpenGL name of an empty program object.
+  /// \param[in] key The program's key, from makeKey ().
+  /// \return Whether or not the program was loaded and the driver accepted
+  ///   it.  If not, the program must be compiled and linked as usual.
+  bool
+  load (GLuint program, uint64_t key);
+
+  /// \brief Tells the driver that a program will be stored after linking.
+  /// \param[in] program The OpenGL name of the program.
+  /// \pre The program has not been linked yet.
+  void
+  prepare (GLuint program);
+
+  /// \brief Saves a linked program in the cache.
+  /// \param[in] program The OpenGL name of the program.
+  /// \param[in] key The program's key, from makeKey ().
+  /// \pre prepare () was called before the program was linked.
+  void
+  store (GLuint program, uint64_t key);
+
+  /// \brief Gets the number of successful load () calls.
+  /// \return The number of programs that did not need compiling.
+  unsigned int
+  getHits () const;
+
+  /// \brief Gets the number of unsuccessful load () calls.
+  /// \return The number of programs that had to be compiled.
+  unsigned int
+  getMisses () const;
+
+private:
+
+  /// \brief Gets the name of the file that holds a program.
+  /// \param[in] key The program's key.
+  /// \return The file's path.
+  std::string
+  getPath (uint64_t key) const;
+
+  /// The context to make OpenGL calls through.
+  OpenGLContext* m_context;
+  /// The directory the binaries are kept in.
+  std::string m_directory;
+  /// The driver's vendor, renderer, and version strings.
+  std::string m_driver;
+  /// Whether or not the driver supports program binaries.
+  bool m_enabled;
+  /// The number of programs loaded.
+  unsigned int m_hits;
+  /// The number of programs not found or rejected.
+  unsigned int m_misses;
+};
+
+#endif//PROGRAM_BINARY_CACHE_HPP
@@ -15,6 +15,12 @@ RealOpenGLContext::~RealOpenGLContext ()
 }
 
 
+void
+RealOpenGLContext::activeTexture (GLenum texture)
+{
+  glActiveTexture (texture);
+}
+
 void
 RealOpenGLContext::attachShader (GLuint program, GLuint shader)
 {
@@ -27,6 +33,24 @@ RealOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
   glBindBuffer (target, buffer);
 }
 
+void
+RealOpenGLContext::bindBufferBase (GLenum target, GLuint index, GLuint buffer)
+{
+  glBindBufferBase (target, index, buffer);
+}
+
+void
+RealOpenGLContext::bindFramebuffer (GLenum target, GLuint framebuffer)
+{
+  glBindFramebuffer (target, framebuffer);
+}
+
+void
+RealOpenGLContext::bindTexture (GLenum target, GLuint texture)
+{
+  glBindTexture (target, texture);
+}
+
 void
 RealOpenGLContext::bindVertexArray (GLuint array)
 {
@@ -39,6 +63,18 @@ RealOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* dat
   glBufferData (target, size, data, usage);
 }
 
+void
+RealOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  glBufferSubData (target, offset, size, data);
+}
+
+GLenum
+RealOpenGLContext::checkFramebufferStatus (GLenum target)
+{
+  return glCheckFramebufferStatus (target);
+}
+
 void
 RealOpenGLContext::clear (GLbitfield mask)
 {
@@ -51,12 +87,24 @@ RealOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat
   glClearColor (red, green, blue, alpha);
 }
 
+GLenum
+RealOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  return glClientWaitSync (sync, flags, timeout);
+}
+
 void
 RealOpenGLContext::compileShader (GLuint shader)
 {
   glCompileShader (shader);
 }
 
+void
+RealOpenGLContext::createBuffers (GLsizei n, GLuint* buffers)
+{
+  glCreateBuffers (n, buffers);
+}
+
 GLuint
 RealOpenGLContext::createProgram ()
 {
@@ -69,6 +117,12 @@ RealOpenGLContext::createShader (GLenum shaderType)
   return glCreateShader (shaderType);
 }
 
+void
+RealOpenGLContext::createVertexArrays (GLsizei n, GLuint* arrays)
+{
+  glCreateVertexArrays (n, arrays);
+}
+
 void
 RealOpenGLContext::cullFace (GLenum mode)
 {
@@ -81,36 +135,78 @@ RealOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
   glDeleteBuffers (n, buffers);
 }
 
+void
+RealOpenGLContext::deleteFramebuffers (GLsizei n, const GLuint* framebuffers)
+{
+  glDeleteFramebuffers (n, framebuffers);
+}
+
 void
 RealOpenGLContext::deleteProgram (GLuint program)
 {
   glDeleteProgram (program);
 }
 
+void
+RealOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+  glDeleteQueries (n, ids);
+}
+
 void
 RealOpenGLContext::deleteShader (GLuint shader)
 {
   glDeleteShader (shader);
 }
 
+void
+RealOpenGLContext::deleteSync (GLsync sync)
+{
+  glDeleteSync (sync);
+}
+
+void
+RealOpenGLContext::deleteTextures (GLsizei n, const GLuint* textures)
+{
+  glDeleteTextures (n, textures);
+}
+
 void
 RealOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
 {
   glDeleteVertexArrays (n, arrays);
 }
 
+void
+RealOpenGLContext::depthFunc (GLenum func)
+{
+  glDepthFunc (func);
+}
+
 void
 RealOpenGLContext::detachShader (GLuint program, GLuint shader)
 {
   glDetachShader (program, shader);
 }
 
+void
+RealOpenGLContext::dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+  glDispatchCompute (num_groups_x, num_groups_y, num_groups_z);
+}
+
 void
 RealOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
 {
   glDrawArrays (mode, first, count);
 }
 
+void
+RealOpenGLContext::drawBuffers (GLsizei n, const GLenum* bufs)
+{
+  glDrawBuffers (n, bufs);
+}
+
 void
 RealOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices)
 {
@@ -123,12 +219,30 @@ RealOpenGLContext::enable (GLenum cap)
   glEnable (cap);
 }
 
+void
+RealOpenGLContext::enableVertexArrayAttrib (GLuint vaobj, GLuint index)
+{
+  glEnableVertexArrayAttrib (vaobj, index);
+}
+
 void
 RealOpenGLContext::enableVertexAttribArray (GLuint index)
 {
   glEnableVertexAttribArray (index);
 }
 
+GLsync
+RealOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return glFenceSync (condition, flags);
+}
+
+void
+RealOpenGLContext::framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+  glFramebufferTexture2D (target, attachment, textarget, texture, level);
+}
+
 void
 RealOpenGLContext::frontFace (GLenum mode)
 {
@@ -141,18 +255,54 @@ RealOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
   glGenBuffers (n, buffers);
 }
 
+void
+RealOpenGLContext::genFramebuffers (GLsizei n, GLuint* framebuffers)
+{
+  glGenFramebuffers (n, framebuffers);
+}
+
+void
+RealOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  glGenQueries (n, ids);
+}
+
+void
+RealOpenGLContext::genTextures (GLsizei n, GLuint* textures)
+{
+  glGenTextures (n, textures);
+}
+
 void
 RealOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
 {
   glGenVertexArrays (n, arrays);
 }
 
+void
+RealOpenGLContext::getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+  glGetActiveUniform (program, index, bufSize, length, size, type, name);
+}
+
 GLint
 RealOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
 {
   return glGetAttribLocation (program, name);
 }
 
+void
+RealOpenGLContext::getIntegerv (GLenum pname, GLint* data)
+{
+  glGetIntegerv (pname, data);
+}
+
+void
+RealOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  glGetProgramBinary (program, bufSize, length, binaryFormat, binary);
+}
+
 void
 RealOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
 {
@@ -165,6 +315,18 @@ RealOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
   glGetProgramiv (program, pname, params);
 }
 
+void
+RealOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  glGetQueryObjectiv (id, pname, params);
+}
+
+void
+RealOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  glGetQueryObjectui64v (id, pname, params);
+}
+
 void
 RealOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
 {
@@ -183,6 +345,12 @@ RealOpenGLContext::getString (GLenum name)
   return glGetString (name);
 }
 
+GLuint
+RealOpenGLContext::getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName)
+{
+  return glGetUniformBlockIndex (program, uniformBlockName);
+}
+
 GLint
 RealOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
 {
@@ -195,24 +363,173 @@ RealOpenGLContext::linkProgram (GLuint program)
   glLinkProgram (program);
 }
 
+void*
+RealOpenGLContext::mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+  return glMapNamedBufferRange (buffer, offset, length, access);
+}
+
+void
+RealOpenGLContext::maxShaderCompilerThreadsKHR (GLuint count)
+{
+  glMaxShaderCompilerThreadsKHR (count);
+}
+
+void
+RealOpenGLContext::memoryBarrier (GLbitfield barriers)
+{
+  glMemoryBarrier (barriers);
+}
+
+void
+RealOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  glMultiDrawElementsIndirect (mode, type, indirect, drawcount, stride);
+}
+
+void
+RealOpenGLContext::multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+  // Before OpenGL 4.6 (e.g., on llvmpipe), only ARB_indirect_parameters'
+  //   name for it is loaded.
+  if (GLEW_VERSION_4_6)
+    glMultiDrawElementsIndirectCount (mode, type, indirect, drawcount, maxdrawcount, stride);
+  else
+    glMultiDrawElementsIndirectCountARB (mode, type, indirect, drawcount, maxdrawcount, stride);
+}
+
+void
+RealOpenGLContext::namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+  glNamedBufferData (buffer, size, data, usage);
+}
+
+void
+RealOpenGLContext::namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+  glNamedBufferStorage (buffer, size, data, flags);
+}
+
+void
+RealOpenGLContext::namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+  glNamedBufferSubData (buffer, offset, size, data);
+}
+
+void
+RealOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+  glProgramBinary (program, binaryFormat, binary, length);
+}
+
+void
+RealOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+  glProgramParameteri (program, pname, value);
+}
+
+void
+RealOpenGLContext::queryCounter (GLuint id, GLenum target)
+{
+  glQueryCounter (id, target);
+}
+
 void
 RealOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
 {
   glShaderSource (shader, count, string, length);
 }
 
+void
+RealOpenGLContext::texBuffer (GLenum target, GLenum internalformat, GLuint buffer)
+{
+  glTexBuffer (target, internalformat, buffer);
+}
+
+void
+RealOpenGLContext::texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data)
+{
+  glTexImage2D (target, level, internalformat, width, height, border, format, type, data);
+}
+
+void
+RealOpenGLContext::texParameteri (GLenum target, GLenum pname, GLint param)
+{
+  glTexParameteri (target, pname, param);
+}
+
+void
+RealOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  glUniform1f (location, v0);
+}
+
+void
+RealOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  glUniform1i (location, v0);
+}
+
+void
+RealOpenGLContext::uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+  glUniform3f (location, v0, v1, v2);
+}
+
+void
+RealOpenGLContext::uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+  glUniformBlockBinding (program, uniformBlockIndex, uniformBlockBinding);
+}
+
+void
+RealOpenGLContext::uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  glUniformMatrix3fv (location, count, transpose, value);
+}
+
 void
 RealOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
 {
   glUniformMatrix4fv (location, count, transpose, value);
 }
 
+GLboolean
+RealOpenGLContext::unmapNamedBuffer (GLuint buffer)
+{
+  return glUnmapNamedBuffer (buffer);
+}
+
 void
 RealOpenGLContext::useProgram (GLuint program)
 {
   glUseProgram (program);
 }
 
+void
+RealOpenGLContext::vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+  glVertexArrayAttribBinding (vaobj, attribindex, bindingindex);
+}
+
+void
+RealOpenGLContext::vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+  glVertexArrayAttribFormat (vaobj, attribindex, size, type, normalized, relativeoffset);
+}
+
+void
+RealOpenGLContext::vertexArrayElementBuffer (GLuint vaobj, GLuint buffer)
+{
+  glVertexArrayElementBuffer (vaobj, buffer);
+}
+
+void
+RealOpenGLContext::vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+{
+  glVertexArrayVertexBuffer (vaobj, bindingindex, buffer, offset, stride);
+}
+
 void
 RealOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
 {
@@ -0,0 +1,1151 @@
+/// \file RecordingOpenGLContext.cpp
+/// \brief Definitions of RecordingOpenGLContext member and associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstdio>
+#include <cstring>
+
+#include "RecordingOpenGLContext.hpp"
+
+namespace
+{
+  /// \brief Computes the size of a tightly packed image.
+  /// \param[in] width The width, in pixels.
+  /// \param[in] height The height, in pixels.
+  /// \param[in] format The format of the pixels (e.g., GL_RGBA).
+  /// \param[in] type The type of each component (e.g., GL_UNSIGNED_BYTE).
+  /// \return The size, in bytes.
+  std::size_t
+  getImageSize (GLsizei width, GLsizei height, GLenum format, GLenum type)
+  {
+    std::size_t components = 4;
+    switch (format)
+    {
+    case GL_RED:
+    case GL_DEPTH_COMPONENT:
+      components = 1;
+      break;
+    case GL_RG:
+      components = 2;
+      break;
+    case GL_RGB:
+      components = 3;
+      break;
+    }
+    std::size_t componentSize = 4;
+    switch (type)
+    {
+    case GL_UNSIGNED_BYTE:
+    case GL_BYTE:
+      componentSize = 1;
+      break;
+    case GL_UNSIGNED_SHORT:
+    case GL_SHORT:
+    case GL_HALF_FLOAT:
+      componentSize = 2;
+      break;
+    }
+    return static_cast<std::size_t> (width) * height * components * componentSize;
+  }
+
+  /// \brief Computes the 64-bit FNV-1a hash of some bytes.
+  /// \param[in] data The bytes.
+  /// \param[in] size The number of bytes.
+  /// \return The hash, which is never 0.
+  std::uint64_t
+  hashBytes (const void* data, std::size_t size)
+  {
+    const unsigned char* bytes = static_cast<const unsigned char*> (data);
+    std::uint64_t hash = 14695981039346656037ull;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+      hash ^= bytes[i];
+      hash *= 1099511628211ull;
+    }
+    // 0 stands for a null pointer.
+    return hash == 0 ? 1 : hash;
+  }
+}
+
+const char RecordingOpenGLContext::TRACE_MAGIC[8] = { 'G', 'L', 'T', 'R', 'A', 'C', 'E', '\0' };
+
+const std::uint32_t RecordingOpenGLContext::TRACE_VERSION;
+
+RecordingOpenGLContext::RecordingOpenGLContext (OpenGLContext* context)
+  : m_context (context), m_log (), m_callCount (0), m_frameCount (0),
+    m_recording (true), m_contents (), m_start (std::chrono::steady_clock::now ())
+{
+}
+
+RecordingOpenGLContext::~RecordingOpenGLContext ()
+{
+}
+
+const std::vector<unsigned char>&
+RecordingOpenGLContext::getLog () const
+{
+  return m_log;
+}
+
+std::size_t
+RecordingOpenGLContext::getCallCount () const
+{
+  return m_callCount;
+}
+
+std::size_t
+RecordingOpenGLContext::getFrameCount () const
+{
+  return m_frameCount;
+}
+
+void
+RecordingOpenGLContext::clear ()
+{
+  m_log.clear ();
+  m_callCount = 0;
+  m_frameCount = 0;
+  m_contents.clear ();
+}
+
+void
+RecordingOpenGLContext::setRecording (bool recording)
+{
+  m_recording = recording;
+}
+
+bool
+RecordingOpenGLContext::isRecording () const
+{
+  return m_recording;
+}
+
+void
+RecordingOpenGLContext::markFrame ()
+{
+  if (!m_recording)
+    return;
+  using namespace std::chrono;
+  m_log.push_back (static_cast<unsigned char> (FRAME));
+  put<std::uint64_t> (duration_cast<microseconds> (steady_clock::now () - m_start).count ());
+  ++m_frameCount;
+}
+
+bool
+RecordingOpenGLContext::save (const std::string& path) const
+{
+  FILE* file = fopen (path.c_str (), "wb");
+  if (file == nullptr)
+  {
+    fprintf (stderr, "Could not open %s for writing\n", path.c_str ());
+    return false;
+  }
+  bool written = fwrite (TRACE_MAGIC, sizeof (TRACE_MAGIC), 1, file) == 1
+    && fwrite (&TRACE_VERSION, sizeof (TRACE_VERSION), 1, file) == 1
+    && fwrite (m_log.data (), 1, m_log.size (), file) == m_log.size ();
+  written = fclose (file) == 0 && written;
+  if (!written)
+    fprintf (stderr, "Could not write %s\n", path.c_str ());
+  return written;
+}
+
+const char*
+RecordingOpenGLContext::getCallName (RecordedCall call)
+{
+  static const char* const NAMES[RECORDED_CALL_COUNT] = {
+    "glActiveTexture", "glAttachShader", "glBindBuffer",
+    "glBindBufferBase", "glBindFramebuffer", "glBindTexture",
+    "glBindVertexArray", "glBufferData", "glBufferSubData",
+    "glCheckFramebufferStatus", "glClear", "glClearColor",
+    "glCompileShader", "glCreateBuffers", "glCreateProgram",
+    "glCreateShader", "glCreateVertexArrays", "glCullFace",
+    "glDeleteBuffers", "glDeleteFramebuffers", "glDeleteProgram",
+    "glDeleteQueries", "glDeleteShader", "glDeleteTextures",
+    "glDeleteVertexArrays", "glDepthFunc", "glDetachShader",
+    "glDispatchCompute", "glDrawArrays", "glDrawBuffers",
+    "glDrawElements", "glEnable", "glEnableVertexArrayAttrib",
+    "glEnableVertexAttribArray", "glFramebufferTexture2D", "glFrontFace",
+    "glGenBuffers", "glGenFramebuffers", "glGenQueries",
+    "glGenTextures", "glGenVertexArrays", "glGetActiveUniform",
+    "glGetAttribLocation", "glGetIntegerv", "glGetProgramBinary",
+    "glGetProgramInfoLog", "glGetProgramiv", "glGetQueryObjectiv",
+    "glGetQueryObjectui64v", "glGetShaderInfoLog", "glGetShaderiv",
+    "glGetString", "glGetUniformBlockIndex", "glGetUniformLocation",
+    "glLinkProgram", "glMaxShaderCompilerThreadsKHR", "glMemoryBarrier",
+    "glMultiDrawElementsIndirect", "glMultiDrawElementsIndirectCount", "glNamedBufferData",
+    "glNamedBufferStorage", "glNamedBufferSubData", "glProgramBinary",
+    "glProgramParameteri", "glQueryCounter", "glShaderSource",
+    "glTexBuffer", "glTexImage2D", "glTexParameteri",
+    "glUniform1f", "glUniform1i", "glUniform3f",
+    "glUniformBlockBinding", "glUniformMatrix3fv", "glUniformMatrix4fv",
+    "glUseProgram", "glVertexArrayAttribBinding", "glVertexArrayAttribFormat",
+    "glVertexArrayElementBuffer", "glVertexArrayVertexBuffer", "glVertexAttribPointer",
+    "glViewport",
+    "(end of frame)", "(buffer contents)"
+  };
+  return NAMES[call];
+}
+
+void
+RecordingOpenGLContext::activeTexture (GLenum texture)
+{
+  if (begin (ACTIVE_TEXTURE))
+    put (texture);
+  m_context->activeTexture (texture);
+}
+
+void
+RecordingOpenGLContext::attachShader (GLuint program, GLuint shader)
+{
+  if (begin (ATTACH_SHADER))
+  {
+    put (program);
+    put (shader);
+  }
+  m_context->attachShader (program, shader);
+}
+
+void
+RecordingOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+  if (begin (BIND_BUFFER))
+  {
+    put (target);
+    put (buffer);
+  }
+  m_context->bindBuffer (target, buffer);
+}
+
+void
+RecordingOpenGLContext::bindBufferBase (GLenum target, GLuint index, GLuint buffer)
+{
+  if (begin (BIND_BUFFER_BASE))
+  {
+    put (target);
+    put (index);
+    put (buffer);
+  }
+  m_context->bindBufferBase (target, index, buffer);
+}
+
+void
+RecordingOpenGLContext::bindFramebuffer (GLenum target, GLuint framebuffer)
+{
+  if (begin (BIND_FRAMEBUFFER))
+  {
+    put (target);
+    put (framebuffer);
+  }
+  m_context->bindFramebuffer (target, framebuffer);
+}
+
+void
+RecordingOpenGLContext::bindTexture (GLenum target, GLuint texture)
+{
+  if (begin (BIND_TEXTURE))
+  {
+    put (target);
+    put (texture);
+  }
+  m_context->bindTexture (target, texture);
+}
+
+void
+RecordingOpenGLContext::bindVertexArray (GLuint array)
+{
+  if (begin (BIND_VERTEX_ARRAY))
+    put (array);
+  m_context->bindVertexArray (array);
+}
+
+void
+RecordingOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+  std::uint64_t contents = storeBufferContents (data, size);
+  if (begin (BUFFER_DATA))
+  {
+    put (target);
+    put<std::int64_t> (size);
+    put (contents);
+    put (usage);
+  }
+  m_context->bufferData (target, size, data, usage);
+}
+
+void
+RecordingOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  std::uint64_t contents = storeBufferContents (data, size);
+  if (begin (BUFFER_SUB_DATA))
+  {
+    put (target);
+    put<std::int64_t> (offset);
+    put<std::int64_t> (size);
+    put (contents);
+  }
+  m_context->bufferSubData (target, offset, size, data);
+}
+
+GLenum
+RecordingOpenGLContext::checkFramebufferStatus (GLenum target)
+{
+  if (begin (CHECK_FRAMEBUFFER_STATUS))
+    put (target);
+  return m_context->checkFramebufferStatus (target);
+}
+
+void
+RecordingOpenGLContext::clear (GLbitfield mask)
+{
+  if (begin (CLEAR))
+    put (mask);
+  m_context->clear (mask);
+}
+
+void
+RecordingOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  if (begin (CLEAR_COLOR))
+  {
+    put (red);
+    put (green);
+    put (blue);
+    put (alpha);
+  }
+  m_context->clearColor (red, green, blue, alpha);
+}
+
+GLenum
+RecordingOpenGLContext::clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+  return m_context->clientWaitSync (sync, flags, timeout);
+}
+
+void
+RecordingOpenGLContext::compileShader (GLuint shader)
+{
+  if (begin (COMPILE_SHADER))
+    put (shader);
+  m_context->compileShader (shader);
+}
+
+void
+RecordingOpenGLContext::createBuffers (GLsizei n, GLuint* buffers)
+{
+  m_context->createBuffers (n, buffers);
+  if (begin (CREATE_BUFFERS))
+    putArray (buffers, n);
+}
+
+GLuint
+RecordingOpenGLContext::createProgram ()
+{
+  GLuint result = m_context->createProgram ();
+  if (begin (CREATE_PROGRAM))
+    put (result);
+  return result;
+}
+
+GLuint
+RecordingOpenGLContext::createShader (GLenum shaderType)
+{
+  GLuint result = m_context->createShader (shaderType);
+  if (begin (CREATE_SHADER))
+  {
+    put (shaderType);
+    put (result);
+  }
+  return result;
+}
+
+void
+RecordingOpenGLContext::createVertexArrays (GLsizei n, GLuint* arrays)
+{
+  m_context->createVertexArrays (n, arrays);
+  if (begin (CREATE_VERTEX_ARRAYS))
+    putArray (arrays, n);
+}
+
+void
+RecordingOpenGLContext::cullFace (GLenum mode)
+{
+  if (begin (CULL_FACE))
+    put (mode);
+  m_context->cullFace (mode);
+}
+
+void
+RecordingOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+  if (begin (DELETE_BUFFERS))
+    putArray (buffers, n);
+  m_context->deleteBuffers (n, buffers);
+}
+
+void
+RecordingOpenGLContext::deleteFramebuffers (GLsizei n, const GLuint* framebuffers)
+{
+  if (begin (DELETE_FRAMEBUFFERS))
+    putArray (framebuffers, n);
+  m_context->deleteFramebuffers (n, framebuffers);
+}
+
+void
+RecordingOpenGLContext::deleteProgram (GLuint program)
+{
+  if (begin (DELETE_PROGRAM))
+    put (program);
+  m_context->deleteProgram (program);
+}
+
+void
+RecordingOpenGLContext::deleteQueries (GLsizei n, const GLuint* ids)
+{
+  if (begin (DELETE_QUERIES))
+    putArray (ids, n);
+  m_context->deleteQueries (n, ids);
+}
+
+void
+RecordingOpenGLContext::deleteShader (GLuint shader)
+{
+  if (begin (DELETE_SHADER))
+    put (shader);
+  m_context->deleteShader (shader);
+}
+
+void
+RecordingOpenGLContext::deleteSync (GLsync sync)
+{
+  m_context->deleteSync (sync);
+}
+
+void
+RecordingOpenGLContext::deleteTextures (GLsizei n, const GLuint* textures)
+{
+  if (begin (DELETE_TEXTURES))
+    putArray (textures, n);
+  m_context->deleteTextures (n, textures);
+}
+
+void
+RecordingOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+  if (begin (DELETE_VERTEX_ARRAYS))
+    putArray (arrays, n);
+  m_context->deleteVertexArrays (n, arrays);
+}
+
+void
+RecordingOpenGLContext::depthFunc (GLenum func)
+{
+  if (begin (DEPTH_FUNC))
+    put (func);
+  m_context->depthFunc (func);
+}
+
+void
+RecordingOpenGLContext::detachShader (GLuint program, GLuint shader)
+{
+  if (begin (DETACH_SHADER))
+  {
+    put (program);
+    put (shader);
+  }
+  m_context->detachShader (program, shader);
+}
+
+void
+RecordingOpenGLContext::dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+  if (begin (DISPATCH_COMPUTE))
+  {
+    put (num_groups_x);
+    put (num_groups_y);
+    put (num_groups_z);
+  }
+  m_context->dispatchCompute (num_groups_x, num_groups_y, num_groups_z);
+}
+
+void
+RecordingOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+  if (begin (DRAW_ARRAYS))
+  {
+    put (mode);
+    put (first);
+    put (count);
+  }
+  m_context->drawArrays (mode, first, count);
+}
+
+void
+RecordingOpenGLContext::drawBuffers (GLsizei n, const GLenum* bufs)
+{
+  if (begin (DRAW_BUFFERS))
+    putArray (bufs, n);
+  m_context->drawBuffers (n, bufs);
+}
+
+void
+RecordingOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+  if (begin (DRAW_ELEMENTS))
+  {
+    put (mode);
+    put (count);
+    put (type);
+    put<std::uint64_t> (reinterpret_cast<std::uintptr_t> (indices));
+  }
+  m_context->drawElements (mode, count, type, indices);
+}
+
+void
+RecordingOpenGLContext::enable (GLenum cap)
+{
+  if (begin (ENABLE))
+    put (cap);
+  m_context->enable (cap);
+}
+
+void
+RecordingOpenGLContext::enableVertexArrayAttrib (GLuint vaobj, GLuint index)
+{
+  if (begin (ENABLE_VERTEX_ARRAY_ATTRIB))
+  {
+    put (vaobj);
+    put (index);
+  }
+  m_context->enableVertexArrayAttrib (vaobj, index);
+}
+
+void
+RecordingOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+  if (begin (ENABLE_VERTEX_ATTRIB_ARRAY))
+    put (index);
+  m_context->enableVertexAttribArray (index);
+}
+
+GLsync
+RecordingOpenGLContext::fenceSync (GLenum condition, GLbitfield flags)
+{
+  return m_context->fenceSync (condition, flags);
+}
+
+void
+RecordingOpenGLContext::framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+  if (begin (FRAMEBUFFER_TEXTURE_2D))
+  {
+    put (target);
+    put (attachment);
+    put (textarget);
+    put (texture);
+    put (level);
+  }
+  m_context->framebufferTexture2D (target, attachment, textarget, texture, level);
+}
+
+void
+RecordingOpenGLContext::frontFace (GLenum mode)
+{
+  if (begin (FRONT_FACE))
+    put (mode);
+  m_context->frontFace (mode);
+}
+
+void
+RecordingOpenGLContext::genBuffers (GLsizei n, GLuint* buffers)
+{
+  m_context->genBuffers (n, buffers);
+  if (begin (GEN_BUFFERS))
+    putArray (buffers, n);
+}
+
+void
+RecordingOpenGLContext::genFramebuffers (GLsizei n, GLuint* framebuffers)
+{
+  m_context->genFramebuffers (n, framebuffers);
+  if (begin (GEN_FRAMEBUFFERS))
+    putArray (framebuffers, n);
+}
+
+void
+RecordingOpenGLContext::genQueries (GLsizei n, GLuint* ids)
+{
+  m_context->genQueries (n, ids);
+  if (begin (GEN_QUERIES))
+    putArray (ids, n);
+}
+
+void
+RecordingOpenGLContext::genTextures (GLsizei n, GLuint* textures)
+{
+  m_context->genTextures (n, textures);
+  if (begin (GEN_TEXTURES))
+    putArray (textures, n);
+}
+
+void
+RecordingOpenGLContext::genVertexArrays (GLsizei n, GLuint* arrays)
+{
+  m_context->genVertexArrays (n, arrays);
+  if (begin (GEN_VERTEX_ARRAYS))
+    putArray (arrays, n);
+}
+
+void
+RecordingOpenGLContext::getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+  if (begin (GET_ACTIVE_UNIFORM))
+  {
+    put (program);
+    put (index);
+  }
+  m_context->getActiveUniform (program, index, bufSize, length, size, type, name);
+}
+
+GLint
+RecordingOpenGLContext::getAttribLocation (GLuint program, const GLchar* name)
+{
+  GLint result = m_context->getAttribLocation (program, name);
+  if (begin (GET_ATTRIB_LOCATION))
+  {
+    put (program);
+    putString (name);
+    put (result);
+  }
+  return result;
+}
+
+void
+RecordingOpenGLContext::getIntegerv (GLenum pname, GLint* data)
+{
+  if (begin (GET_INTEGERV))
+    put (pname);
+  m_context->getIntegerv (pname, data);
+}
+
+void
+RecordingOpenGLContext::getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+  if (begin (GET_PROGRAM_BINARY))
+    put (program);
+  m_context->getProgramBinary (program, bufSize, length, binaryFormat, binary);
+}
+
+void
+RecordingOpenGLContext::getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  if (begin (GET_PROGRAM_INFO_LOG))
+    put (program);
+  m_context->getProgramInfoLog (program, maxLength, length, infoLog);
+}
+
+void
+RecordingOpenGLContext::getProgramiv (GLuint program, GLenum pname, GLint* params)
+{
+  if (begin (GET_PROGRAMIV))
+  {
+    put (program);
+    put (pname);
+  }
+  m_context->getProgramiv (program, pname, params);
+}
+
+void
+RecordingOpenGLContext::getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+{
+  if (begin (GET_QUERY_OBJECTIV))
+  {
+    put (id);
+    put (pname);
+  }
+  m_context->getQueryObjectiv (id, pname, params);
+}
+
+void
+RecordingOpenGLContext::getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+{
+  if (begin (GET_QUERY_OBJECTUI64V))
+  {
+    put (id);
+    put (pname);
+  }
+  m_context->getQueryObjectui64v (id, pname, params);
+}
+
+void
+RecordingOpenGLContext::getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog)
+{
+  if (begin (GET_SHADER_INFO_LOG))
+    put (shader);
+  m_context->getShaderInfoLog (shader, maxLength, length, infoLog);
+}
+
+void
+RecordingOpenGLContext::getShaderiv (GLuint shader, GLenum pname, GLint* params)
+{
+  if (begin (GET_SHADERIV))
+  {
+    put (shader);
+    put (pname);
+  }
+  m_context->getShaderiv (shader, pname, params);
+}
+
+const GLubyte*
+RecordingOpenGLContext::getString (GLenum name)
+{
+  if (begin (GET_STRING))
+    put (name);
+  return m_context->getString (name);
+}
+
+GLuint
+RecordingOpenGLContext::getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName)
+{
+  GLuint result = m_context->getUniformBlockIndex (program, uniformBlockName);
+  if (begin (GET_UNIFORM_BLOCK_INDEX))
+  {
+    put (program);
+    putString (uniformBlockName);
+    put (result);
+  }
+  return result;
+}
+
+GLint
+RecordingOpenGLContext::getUniformLocation (GLuint program, const GLchar* name)
+{
+  GLint result = m_context->getUniformLocation (program, name);
+  if (begin (GET_UNIFORM_LOCATION))
+  {
+    put (program);
+    putString (name);
+    put (result);
+  }
+  return result;
+}
+
+void
+RecordingOpenGLContext::linkProgram (GLuint program)
+{
+  if (begin (LINK_PROGRAM))
+    put (program);
+  m_context->linkProgram (program);
+}
+
+void*
+RecordingOpenGLContext::mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+  return nullptr;
+}
+
+void
+RecordingOpenGLContext::maxShaderCompilerThreadsKHR (GLuint count)
+{
+  if (begin (MAX_SHADER_COMPILER_THREADS_KHR))
+    put (count);
+  m_context->maxShaderCompilerThreadsKHR (count);
+}
+
+void
+RecordingOpenGLContext::memoryBarrier (GLbitfield barriers)
+{
+  if (begin (MEMORY_BARRIER))
+    put (barriers);
+  m_context->memoryBarrier (barriers);
+}
+
+void
+RecordingOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  if (begin (MULTI_DRAW_ELEMENTS_INDIRECT))
+  {
+    put (mode);
+    put (type);
+    put<std::uint64_t> (reinterpret_cast<std::uintptr_t> (indirect));
+    put (drawcount);
+    put (stride);
+  }
+  m_context->multiDrawElementsIndirect (mode, type, indirect, drawcount, stride);
+}
+
+void
+RecordingOpenGLContext::multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+  if (begin (MULTI_DRAW_ELEMENTS_INDIRECT_COUNT))
+  {
+    put (mode);
+    put (type);
+    put<std::uint64_t> (reinterpret_cast<std::uintptr_t> (indirect));
+    put<std::int64_t> (drawcount);
+    put (maxdrawcount);
+    put (stride);
+  }
+  m_context->multiDrawElementsIndirectCount (mode, type, indirect, drawcount, maxdrawcount, stride);
+}
+
+void
+RecordingOpenGLContext::namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+  std::uint64_t contents = storeBufferContents (data, size);
+  if (begin (NAMED_BUFFER_DATA))
+  {
+    put (buffer);
+    put<std::int64_t> (size);
+    put (contents);
+    put (usage);
+  }
+  m_context->namedBufferData (buffer, size, data, usage);
+}
+
+void
+RecordingOpenGLContext::namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+  std::uint64_t contents = storeBufferContents (data, size);
+  if (begin (NAMED_BUFFER_STORAGE))
+  {
+    put (buffer);
+    put<std::int64_t> (size);
+    put (contents);
+    put (flags);
+  }
+  m_context->namedBufferStorage (buffer, size, data, flags);
+}
+
+void
+RecordingOpenGLContext::namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+  std::uint64_t contents = storeBufferContents (data, size);
+  if (begin (NAMED_BUFFER_SUB_DATA))
+  {
+    put (buffer);
+    put<std::int64_t> (offset);
+    put<std::int64_t> (size);
+    put (contents);
+  }
+  m_context->namedBufferSubData (buffer, offset, size, data);
+}
+
+void
+RecordingOpenGLContext::programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+  if (begin (PROGRAM_BINARY))
+  {
+    put (program);
+    put (binaryFormat);
+    putBytes (binary, length);
+  }
+  m_context->programBinary (program, binaryFormat, binary, length);
+}
+
+void
+RecordingOpenGLContext::programParameteri (GLuint program, GLenum pname, GLint value)
+{
+  if (begin (PROGRAM_PARAMETERI))
+  {
+    put (program);
+    put (pname);
+    put (value);
+  }
+  m_context->programParameteri (program, pname, value);
+}
+
+void
+RecordingOpenGLContext::queryCounter (GLuint id, GLenum target)
+{
+  if (begin (QUERY_COUNTER))
+  {
+    put (id);
+    put (target);
+  }
+  m_context->queryCounter (id, target);
+}
+
+void
+RecordingOpenGLContext::shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+{
+  if (begin (SHADER_SOURCE))
+  {
+    put (shader);
+    put<std::uint32_t> (count);
+    for (GLsizei i = 0; i < count; ++i)
+    {
+      if (length == nullptr || length[i] < 0)
+        putString (string[i]);
+      else
+        putBytes (string[i], length[i]);
+    }
+  }
+  m_context->shaderSource (shader, count, string, length);
+}
+
+void
+RecordingOpenGLContext::texBuffer (GLenum target, GLenum internalformat, GLuint buffer)
+{
+  if (begin (TEX_BUFFER))
+  {
+    put (target);
+    put (internalformat);
+    put (buffer);
+  }
+  m_context->texBuffer (target, internalformat, buffer);
+}
+
+void
+RecordingOpenGLContext::texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data)
+{
+  if (begin (TEX_IMAGE_2D))
+  {
+    put (target);
+    put (level);
+    put (internalformat);
+    put (width);
+    put (height);
+    put (border);
+    put (format);
+    put (type);
+    putBytes (data, data == nullptr ? 0 : getImageSize (width, height, format, type));
+  }
+  m_context->texImage2D (target, level, internalformat, width, height, border, format, type, data);
+}
+
+void
+RecordingOpenGLContext::texParameteri (GLenum target, GLenum pname, GLint param)
+{
+  if (begin (TEX_PARAMETERI))
+  {
+    put (target);
+    put (pname);
+    put (param);
+  }
+  m_context->texParameteri (target, pname, param);
+}
+
+void
+RecordingOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  if (begin (UNIFORM_1F))
+  {
+    put (location);
+    put (v0);
+  }
+  m_context->uniform1f (location, v0);
+}
+
+void
+RecordingOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  if (begin (UNIFORM_1I))
+  {
+    put (location);
+    put (v0);
+  }
+  m_context->uniform1i (location, v0);
+}
+
+void
+RecordingOpenGLContext::uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+  if (begin (UNIFORM_3F))
+  {
+    put (location);
+    put (v0);
+    put (v1);
+    put (v2);
+  }
+  m_context->uniform3f (location, v0, v1, v2);
+}
+
+void
+RecordingOpenGLContext::uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+  if (begin (UNIFORM_BLOCK_BINDING))
+  {
+    put (program);
+    put (uniformBlockIndex);
+    put (uniformBlockBinding);
+  }
+  m_context->uniformBlockBinding (program, uniformBlockIndex, uniformBlockBinding);
+}
+
+void
+RecordingOpenGLContext::uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  if (begin (UNIFORM_MATRIX_3FV))
+  {
+    put (location);
+    put (transpose);
+    putArray (value, count * 9);
+  }
+  m_context->uniformMatrix3fv (location, count, transpose, value);
+}
+
+void
+RecordingOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  if (begin (UNIFORM_MATRIX_4FV))
+  {
+    put (location);
+    put (transpose);
+    putArray (value, count * 16);
+  }
+  m_context->uniformMatrix4fv (location, count, transpose, value);
+}
+
+GLboolean
+RecordingOpenGLContext::unmapNamedBuffer (GLuint buffer)
+{
+  return GL_FALSE;
+}
+
+void
+RecordingOpenGLContext::useProgram (GLuint program)
+{
+  if (begin (USE_PROGRAM))
+    put (program);
+  m_context->useProgram (program);
+}
+
+void
+RecordingOpenGLContext::vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+  if (begin (VERTEX_ARRAY_ATTRIB_BINDING))
+  {
+    put (vaobj);
+    put (attribindex);
+    put (bindingindex);
+  }
+  m_context->vertexArrayAttribBinding (vaobj, attribindex, bindingindex);
+}
+
+void
+RecordingOpenGLContext::vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+  if (begin (VERTEX_ARRAY_ATTRIB_FORMAT))
+  {
+    put (vaobj);
+    put (attribindex);
+    put (size);
+    put (type);
+    put (normalized);
+    put (relativeoffset);
+  }
+  m_context->vertexArrayAttribFormat (vaobj, attribindex, size, type, normalized, relativeoffset);
+}
+
+void
+RecordingOpenGLContext::vertexArrayElementBuffer (GLuint vaobj, GLuint buffer)
+{
+  if (begin (VERTEX_ARRAY_ELEMENT_BUFFER))
+  {
+    put (vaobj);
+    put (buffer);
+  }
+  m_context->vertexArrayElementBuffer (vaobj, buffer);
+}
+
+void
+RecordingOpenGLContext::vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+{
+  if (begin (VERTEX_ARRAY_VERTEX_BUFFER))
+  {
+    put (vaobj);
+    put (bindingindex);
+    put (buffer);
+    put<std::int64_t> (offset);
+    put (stride);
+  }
+  m_context->vertexArrayVertexBuffer (vaobj, bindingindex, buffer, offset, stride);
+}
+
+void
+RecordingOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+  if (begin (VERTEX_ATTRIB_POINTER))
+  {
+    put (index);
+    put (size);
+    put (type);
+    put (normalized);
+    put (stride);
+    put<std::uint64_t> (reinterpret_cast<std::uintptr_t> (pointer));
+  }
+  m_context->vertexAttribPointer (index, size, type, normalized, stride, pointer);
+}
+
+void
+RecordingOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  if (begin (VIEWPORT))
+  {
+    put (x);
+    put (y);
+    put (width);
+    put (height);
+  }
+  m_context->viewport (x, y, width, height);
+}
+
+bool
+RecordingOpenGLContext::begin (RecordedCall call)
+{
+  if (!m_recording)
+    return false;
+  m_log.push_back (static_cast<unsigned char> (call));
+  ++m_callCount;
+  return true;
+}
+
+template<typename T>
+void
+RecordingOpenGLContext::put (T value)
+{
+  std::size_t end = m_log.size ();
+  m_log.resize (end + sizeof (T));
+  std::memcpy (&m_log[end], &value, sizeof (T));
+}
+
+template<typename T>
+void
+RecordingOpenGLContext::putArray (const T* data, std::size_t count)
+{
+  put<std::uint32_t> (count);
+  if (count == 0)
+    return;
+  std::size_t end = m_log.size ();
+  m_log.resize (end + count * sizeof (T));
+  std::memcpy (&m_log[end], data, count * sizeof (T));
+}
+
+void
+RecordingOpenGLContext::putBytes (const void* data, std::size_t size)
+{
+  putArray (static_cast<const unsigned char*> (data), data == nullptr ? 0 : size);
+}
+
+std::uint64_t
+RecordingOpenGLContext::storeBufferContents (const void* data, std::size_t size)
+{
+  if (data == nullptr)
+    return 0;
+  std::uint64_t hash = hashBytes (data, size);
+  if (m_recording && m_contents.insert (hash).second)
+  {
+    m_log.push_back (static_cast<unsigned char> (BUFFER_CONTENTS));
+    put (hash);
+    putBytes (data, size);
+  }
+  return hash;
+}
+
+void
+RecordingOpenGLContext::putString (const GLchar* string)
+{
+  putBytes (string, std::strlen (string));
+}
@@ -0,0 +1,545 @@
+/// \file RecordingOpenGLContext.hpp
+/// \brief Declaration of RecordingOpenGLContext and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef RECORDING_OPENGL_CONTEXT_HPP
+#define RECORDING_OPENGL_CONTEXT_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+
+/// \brief A subclass of OpenGLContext that appends every call, with its
+///   arguments, to a compact binary log before passing it on to another
+///   OpenGLContext.
+///
+/// Each call is one byte, its RecordedCall, followed by its arguments in
+///   order, each stored as its own type in the machine's byte order (so a
+///   log is only meant to be read on the machine that wrote it).  Arguments
+///   that point at data are replaced by the data, as a uint32_t count
+///   followed by that many elements:
+///   - texture contents and program binaries, as bytes (none if the pointer
+///     was null; texture rows are taken to be tightly packed);
+///   - the names passed to delete* and drawBuffers;
+///   - shader sources, as that many strings, each a count of bytes followed
+///     by the bytes;
+///   - matrix uniforms, as floats;
+///   - uniform, attribute, and block names, as bytes.
+///   Offsets into buffers (drawElements, vertexAttribPointer) are stored as
+///   uint64_t.  Calls that return names also store what the wrapped context
+///   returned: gen*, createBuffers, and createVertexArrays a count and the
+///   names, the other create* and get*Location and getUniformBlockIndex the
+///   value, after their arguments.  Other queries store only their inputs,
+///   since what they return doesn't change what is drawn.
+///
+/// Buffer contents (bufferData, bufferSubData, and their namedBuffer*
+///   counterparts) are stored once per log, in a BUFFER_CONTENTS record made
+///   just before the first call that uploads them: the contents' 64-bit FNV-1a hash, then the bytes.  The calls
+///   themselves store the hash in their place (0 for a null pointer), so a
+///   scene that streams the same data every frame costs 8 bytes per upload.
+///
+/// Sync objects are passed on without being recorded, since they only make
+///   the CPU wait for the GPU, which changes nothing a replay draws.  Buffers
+///   are never mapped (mapNamedBufferRange () returns null without passing
+///   the call on), since what is written through a mapping couldn't be
+///   recorded; callers upload instead.
+///
+/// markFrame () ends a frame with a FRAME record holding the microseconds
+///   since construction, so a replay can keep the original pacing.  A log
+///   saved to a file is preceded by TRACE_MAGIC and TRACE_VERSION.
+class RecordingOpenGLContext : public OpenGLContext
+{
+public:
+
+  /// \brief The kinds of call, named after their OpenGL functions; also
+  ///   the first byte of each record.
+  enum RecordedCall
+  {
+    ACTIVE_TEXTURE,
+    ATTACH_SHADER,
+    BIND_BUFFER,
+    BIND_BUFFER_BASE,
+    BIND_FRAMEBUFFER,
+    BIND_TEXTURE,
+    BIND_VERTEX_ARRAY,
+    BUFFER_DATA,
+    BUFFER_SUB_DATA,
+    CHECK_FRAMEBUFFER_STATUS,
+    CLEAR,
+    CLEAR_COLOR,
+    COMPILE_SHADER,
+    CREATE_BUFFERS,
+    CREATE_PROGRAM,
+    CREATE_SHADER,
+    CREATE_VERTEX_ARRAYS,
+    CULL_FACE,
+    DELETE_BUFFERS,
+    DELETE_FRAMEBUFFERS,
+    DELETE_PROGRAM,
+    DELETE_QUERIES,
+    DELETE_SHADER,
+    DELETE_TEXTURES,
+    DELETE_VERTEX_ARRAYS,
+    DEPTH_FUNC,
+    DETACH_SHADER,
+    DISPATCH_COMPUTE,
+    DRAW_ARRAYS,
+    DRAW_BUFFERS,
+    DRAW_ELEMENTS,
+    ENABLE,
+    ENABLE_VERTEX_ARRAY_ATTRIB,
+    ENABLE_VERTEX_ATTRIB_ARRAY,
+    FRAMEBUFFER_TEXTURE_2D,
+    FRONT_FACE,
+    GEN_BUFFERS,
+    GEN_FRAMEBUFFERS,
+    GEN_QUERIES,
+    GEN_TEXTURES,
+    GEN_VERTEX_ARRAYS,
+    GET_ACTIVE_UNIFORM,
+    GET_ATTRIB_LOCATION,
+    GET_INTEGERV,
+    GET_PROGRAM_BINARY,
+    GET_PROGRAM_INFO_LOG,
+    GET_PROGRAMIV,
+    GET_QUERY_OBJECTIV,
+    GET_QUERY_OBJECTUI64V,
+    GET_SHADER_INFO_LOG,
+    GET_SHADERIV,
+    GET_STRING,
+    GET_UNIFORM_BLOCK_INDEX,
+    GET_UNIFORM_LOCATION,
+    LINK_PROGRAM,
+    MAX_SHADER_COMPILER_THREADS_KHR,
+    MEMORY_BARRIER,
+    MULTI_DRAW_ELEMENTS_INDIRECT,
+    MULTI_DRAW_ELEMENTS_INDIRECT_COUNT,
+    NAMED_BUFFER_DATA,
+    NAMED_BUFFER_STORAGE,
+    NAMED_BUFFER_SUB_DATA,
+    PROGRAM_BINARY,
+    PROGRAM_PARAMETERI,
+    QUERY_COUNTER,
+    SHADER_SOURCE,
+    TEX_BUFFER,
+    TEX_IMAGE_2D,
+    TEX_PARAMETERI,
+    UNIFORM_1F,
+    UNIFORM_1I,
+    UNIFORM_3F,
+    UNIFORM_BLOCK_BINDING,
+    UNIFORM_MATRIX_3FV,
+    UNIFORM_MATRIX_4FV,
+    USE_PROGRAM,
+    VERTEX_ARRAY_ATTRIB_BINDING,
+    VERTEX_ARRAY_ATTRIB_FORMAT,
+    VERTEX_ARRAY_ELEMENT_BUFFER,
+    VERTEX_ARRAY_VERTEX_BUFFER,
+    VERTEX_ATTRIB_POINTER,
+    VIEWPORT,
+    /// Not a call: the end of a frame.
+    FRAME,
+    /// Not a call: buffer contents for later calls to refer to by hash.
+    BUFFER_CONTENTS,
+    /// The number of kinds, not a kind.
+    RECORDED_CALL_COUNT
+  };
+
+  /// The first bytes of a saved log.
+  static const char TRACE_MAGIC[8];
+
+  /// The version of the format, which follows TRACE_MAGIC as a uint32_t.
+  static const std::uint32_t TRACE_VERSION = 5;
+
+  /// \brief Constructs a RecordingOpenGLContext with an empty log.
+  /// \param[in] context The context to pass calls on to, which must outlive
+  ///   this one.
+  explicit
+  RecordingOpenGLContext (OpenGLContext* context);
+
+  /// Destructs a RecordingOpenGLContext.
+  virtual
+  ~RecordingOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   RecordingOpenGLContexts.
+  RecordingOpenGLContext (const RecordingOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   RecordingOpenGLContexts.
+  RecordingOpenGLContext&
+  operator= (const RecordingOpenGLContext&) = delete;
+
+  /// \brief Gets the log.
+  /// \return Every call recorded since construction or the last clear ().
+  const std::vector<unsigned char>&
+  getLog () const;
+
+  /// \brief Gets the number of calls in the log.
+  /// \return The number of records, not counting FRAME and BUFFER_CONTENTS.
+  std::size_t
+  getCallCount () const;
+
+  /// \brief Gets the number of frames in the log.
+  /// \return The number of markFrame () calls recorded.
+  std::size_t
+  getFrameCount () const;
+
+  /// \brief Empties the log, keeping its memory for reuse.
+  /// \post The next upload of any buffer contents stores them again.
+  void
+  clear ();
+
+  /// \brief Starts or stops recording.  Calls are passed on either way.
+  /// \param[in] recording Whether or not calls should be recorded.
+  void
+  setRecording (bool recording);
+
+  /// \brief Gets whether or not calls are being recorded.
+  /// \return Whether or not they are; they are from construction on.
+  bool
+  isRecording () const;
+
+  /// \brief Ends a frame, e.g., when the window's buffers are swapped.
+  void
+  markFrame ();
+
+  /// \brief Writes the log to a file, after TRACE_MAGIC and TRACE_VERSION.
+  /// \param[in] path The file's path.
+  /// \return Whether or not the whole log was written.
+  bool
+  save (const std::string& path) const;
+
+  /// \brief Gets the name of a kind of call, for reports.
+  /// \param[in] call The kind of call.
+  /// \return The name of its OpenGL function (e.g., "glUseProgram").
+  static const char*
+  getCallName (RecordedCall call);
+
+  virtual void
+  activeTexture (GLenum texture);
+
+  virtual void
+  attachShader (GLuint program, GLuint shader);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindBufferBase (GLenum target, GLuint index, GLuint buffer);
+
+  virtual void
+  bindFramebuffer (GLenum target, GLuint framebuffer);
+
+  virtual void
+  bindTexture (GLenum target, GLuint texture);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual GLenum
+  checkFramebufferStatus (GLenum target);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual GLenum
+  clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout);
+
+  virtual void
+  compileShader (GLuint shader);
+
+  virtual void
+  createBuffers (GLsizei n, GLuint* buffers);
+
+  virtual GLuint
+  createProgram ();
+
+  virtual GLuint
+  createShader (GLenum shaderType);
+
+  virtual void
+  createVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteFramebuffers (GLsizei n, const GLuint* framebuffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteQueries (GLsizei n, const GLuint* ids);
+
+  virtual void
+  deleteShader (GLuint shader);
+
+  virtual void
+  deleteSync (GLsync sync);
+
+  virtual void
+  deleteTextures (GLsizei n, const GLuint* textures);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  depthFunc (GLenum func);
+
+  virtual void
+  detachShader (GLuint program, GLuint shader);
+
+  virtual void
+  dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawBuffers (GLsizei n, const GLenum* bufs);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexArrayAttrib (GLuint vaobj, GLuint index);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual GLsync
+  fenceSync (GLenum condition, GLbitfield flags);
+
+  virtual void
+  framebufferTexture2D (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level);
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual void
+  genBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  genFramebuffers (GLsizei n, GLuint* framebuffers);
+
+  virtual void
+  genQueries (GLsizei n, GLuint* ids);
+
+  virtual void
+  genTextures (GLsizei n, GLuint* textures);
+
+  virtual void
+  genVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  getActiveUniform (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name);
+
+  virtual GLint
+  getAttribLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  getIntegerv (GLenum pname, GLint* data);
+
+  virtual void
+  getProgramBinary (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary);
+
+  virtual void
+  getProgramInfoLog (GLuint program, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getProgramiv (GLuint program, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectiv (GLuint id, GLenum pname, GLint* params);
+
+  virtual void
+  getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params);
+
+  virtual void
+  getShaderInfoLog (GLuint shader, GLsizei maxLength, GLsizei* length, GLchar* infoLog);
+
+  virtual void
+  getShaderiv (GLuint shader, GLenum pname, GLint* params);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual GLuint
+  getUniformBlockIndex (GLuint program, const GLchar* uniformBlockName);
+
+  virtual GLint
+  getUniformLocation (GLuint program, const GLchar* name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void*
+  mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+  virtual void
+  maxShaderCompilerThreadsKHR (GLuint count);
+
+  virtual void
+  memoryBarrier (GLbitfield barriers);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+  virtual void
+  namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+
+  virtual void
+  namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+
+  virtual void
+  namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+  virtual void
+  programBinary (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length);
+
+  virtual void
+  programParameteri (GLuint program, GLenum pname, GLint value);
+
+  virtual void
+  queryCounter (GLuint id, GLenum target);
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length);
+
+  virtual void
+  texBuffer (GLenum target, GLenum internalformat, GLuint buffer);
+
+  virtual void
+  texImage2D (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const GLvoid* data);
+
+  virtual void
+  texParameteri (GLenum target, GLenum pname, GLint param);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+
+  virtual void
+  uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+
+  virtual void
+  uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual GLboolean
+  unmapNamedBuffer (GLuint buffer);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+
+  virtual void
+  vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+
+  virtual void
+  vertexArrayElementBuffer (GLuint vaobj, GLuint buffer);
+
+  virtual void
+  vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+private:
+
+  /// \brief Starts a record.
+  /// \param[in] call The kind of call.
+  /// \return Whether or not to record it; if not, nothing was appended.
+  bool
+  begin (RecordedCall call);
+
+  /// \brief Appends one argument.
+  /// \param[in] value The argument.
+  template<typename T>
+  void
+  put (T value);
+
+  /// \brief Appends a count followed by that many elements.
+  /// \param[in] data The elements, which may be null if count is 0.
+  /// \param[in] count The number of elements.
+  template<typename T>
+  void
+  putArray (const T* data, std::size_t count);
+
+  /// \brief Appends a count of bytes followed by the bytes.
+  /// \param[in] data The bytes, or null for none.
+  /// \param[in] size The number of bytes.
+  void
+  putBytes (const void* data, std::size_t size);
+
+  /// \brief Appends a BUFFER_CONTENTS record, if recording and the log
+  ///   doesn't have these contents yet.
+  /// \param[in] data The contents, or null for none.
+  /// \param[in] size The number of bytes.
+  /// \return The contents' hash, for the call to store; 0 if data is null.
+  std::uint64_t
+  storeBufferContents (const void* data, std::size_t size);
+
+  /// \brief Appends a null-terminated string as a count of bytes followed
+  ///   by the bytes.
+  /// \param[in] string The string.
+  void
+  putString (const GLchar* string);
+
+  /// The context calls are passed on to.
+  OpenGLContext* m_context;
+  /// The log.
+  std::vector<unsigned char> m_log;
+  /// The number of records in m_log, not counting FRAME and
+  ///   BUFFER_CONTENTS.
+  std::size_t m_callCount;
+  /// The number of FRAME records in m_log.
+  std::size_t m_frameCount;
+  /// Whether or not calls are being recorded.
+  bool m_recording;
+  /// The hashes of the buffer contents in m_log.
+  std::unordered_set<std::uint64_t> m_contents;
+  /// When this context was constructed, which FRAME times count from.
+  std::chrono::steady_clock::time_point m_start;
+};
+
+#endif//RECORDING_OPENGL_CONTEXT_HPP
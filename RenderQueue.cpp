@@ -0,0 +1,316 @@
+/// \file RenderQueue.cpp
+/// \brief Definition of DrawPacket, DrawData, DrawElementsIndirectCommand,
+///   RenderCommandBuffer, and RenderQueue classes and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+
+#include "RenderQueue.hpp"
+#include "GpuProfiler.hpp"
+
+namespace
+{
+  /// \brief Turns a column-major array into a Matrix4.
+  /// \param[in] m The 16 values.
+  /// \return The same matrix.
+  Matrix4
+  toMatrix (const float* m)
+  {
+    return Matrix4 (Vector4 (m[0], m[1], m[2], m[3]),
+                    Vector4 (m[4], m[5], m[6], m[7]),
+                    Vector4 (m[8], m[9], m[10], m[11]),
+                    Vector4 (m[12], m[13], m[14], m[15]));
+  }
+
+  /// \brief Turns a column-major array into a Matrix3.
+  /// \param[in] m The 9 values.
+  /// \return The same matrix.
+  Matrix3
+  toMatrix3 (const float* m)
+  {
+    return Matrix3 (m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7], m[8]);
+  }
+
+  /// The number of draws the stream buffer's regions start out with room
+  ///   for.  Three regions of them fit in the smallest buffer texture OpenGL
+  ///   guarantees (65,536 texels).
+  const GLsizeiptr INITIAL_DRAWS = 1024;
+
+  /// \brief Points a buffer texture at the whole of a buffer.
+  /// \param[in] context The context to make OpenGL calls through.
+  /// \param[in] texture The buffer texture.
+  /// \param[in] buffer The buffer.
+  void
+  attachBuffer (OpenGLContext* context, GLuint texture, GLuint buffer)
+  {
+    context->bindTexture (GL_TEXTURE_BUFFER, texture);
+    context->texBuffer (GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+    context->bindTexture (GL_TEXTURE_BUFFER, 0);
+  }
+}
+
+RenderCommandBuffer::RenderCommandBuffer ()
+{
+}
+
+RenderCommandBuffer::~RenderCommandBuffer ()
+{
+}
+
+void
+RenderCommandBuffer::record (const DrawPacket& packet)
+{
+  m_packets.push_back (packet);
+}
+
+void
+RenderCommandBuffer::clear ()
+{
+  m_packets.clear ();
+}
+
+unsigned int
+RenderCommandBuffer::size () const
+{
+  return m_packets.size ();
+}
+
+const DrawPacket*
+RenderCommandBuffer::data () const
+{
+  return m_packets.data ();
+}
+
+RenderQueue::RenderQueue (unsigned int bufferCount)
+  : m_buffers (std::max (1u, bufferCount)), m_merged (), m_context (nullptr),
+    m_stream (nullptr), m_drawDataTexture (0), m_uploaded (0), m_commandOffset (0),
+    m_drawDataOffset (0)
+{
+}
+
+RenderQueue::~RenderQueue ()
+{
+  setMultiDrawIndirect (nullptr);
+}
+
+void
+RenderQueue::setBufferCount (unsigned int bufferCount)
+{
+  m_buffers.resize (std::max (1u, bufferCount));
+  clear ();
+}
+
+unsigned int
+RenderQueue::getBufferCount () const
+{
+  return m_buffers.size ();
+}
+
+RenderCommandBuffer&
+RenderQueue::getBuffer (unsigned int index)
+{
+  return m_buffers[index];
+}
+
+void
+RenderQueue::clear ()
+{
+  for (RenderCommandBuffer& buffer : m_buffers)
+    buffer.clear ();
+  m_merged.clear ();
+  m_uploaded = 0;
+}
+
+void
+RenderQueue::merge ()
+{
+  m_merged.clear ();
+  m_uploaded = 0;
+  for (const RenderCommandBuffer& buffer : m_buffers)
+    for (unsigned int i = 0; i < buffer.size (); ++i)
+      m_merged.emplace_back (buffer.data ()[i].sortKey, &buffer.data ()[i]);
+  std::stable_sort (m_merged.begin (), m_merged.end (),
+                    [] (const std::pair<uint64_t, const DrawPacket*>& a,
+                        const std::pair<uint64_t, const DrawPacket*>& b)
+                    { return a.first < b.first; });
+}
+
+void
+RenderQueue::setMultiDrawIndirect (OpenGLContext* context)
+{
+  if (context == m_context)
+    return;
+  if (m_context != nullptr)
+  {
+    m_context->deleteTextures (1, &m_drawDataTexture);
+    delete m_stream;
+    m_stream = nullptr;
+  }
+  m_context = context;
+  m_uploaded = 0;
+  if (m_context == nullptr)
+    return;
+  m_stream = new StreamBuffer (m_context, INITIAL_DRAWS * (sizeof (DrawElementsIndirectCommand)
+                                                           + sizeof (DrawData)));
+  m_context->genTextures (1, &m_drawDataTexture);
+  attachBuffer (m_context, m_drawDataTexture, m_stream->getBuffer ());
+}
+
+bool
+RenderQueue::isMultiDrawIndirect () const
+{
+  return m_context != nullptr;
+}
+
+void
+RenderQueue::upload ()
+{
+  if (m_context == nullptr)
+    return;
+  m_stream->fence ();
+  if (m_merged.empty ())
+    return;
+  GLsizeiptr commandBytes = m_merged.size () * sizeof (DrawElementsIndirectCommand);
+  GLsizeiptr drawDataBytes = m_merged.size () * sizeof (DrawData);
+  // The per-draw data starts on a whole DrawData, which may take up to one
+  //   more.
+  GLsizeiptr needed = commandBytes + drawDataBytes + sizeof (DrawData);
+  if (needed > m_stream->getRegionSize ())
+  {
+    m_stream->reserve (std::max (needed, 2 * m_stream->getRegionSize ()));
+    attachBuffer (m_context, m_drawDataTexture, m_stream->getBuffer ());
+  }
+  DrawElementsIndirectCommand* commands = static_cast<DrawElementsIndirectCommand*> (
+    m_stream->allocate (commandBytes, sizeof (GLuint), m_commandOffset));
+  DrawData* drawData = static_cast<DrawData*> (
+    m_stream->allocate (drawDataBytes, sizeof (DrawData), m_drawDataOffset));
+  for (unsigned int i = 0; i < m_merged.size (); ++i)
+  {
+    const DrawPacket& packet = *m_merged[i].second;
+    commands[i] = DrawElementsIndirectCommand { static_cast<GLuint> (packet.indexCount),
+                                                1, packet.firstIndex, 0, 0 };
+    DrawData& data = drawData[i];
+    std::copy (packet.world, packet.world + 16, data.world);
+    std::copy (packet.modelView, packet.modelView + 16, data.modelView);
+    std::copy (packet.modelViewProjection, packet.modelViewProjection + 16,
+               data.modelViewProjection);
+    for (int column = 0; column < 3; ++column)
+    {
+      std::copy (packet.normalMatrix + 3 * column, packet.normalMatrix + 3 * column + 3,
+                 data.normalMatrix + 4 * column);
+      data.normalMatrix[4 * column + 3] = 0.0f;
+    }
+  }
+  m_stream->flush ();
+  m_uploaded = m_merged.size ();
+}
+
+const StreamBuffer*
+RenderQueue::getStreamBuffer () const
+{
+  return m_stream;
+}
+
+unsigned int
+RenderQueue::getPacketCount () const
+{
+  return m_merged.size ();
+}
+
+void
+RenderQueue::submit (OpenGLContext* context) const
+{
+  // No packet uses a null program.
+  submit (context, nullptr, false);
+}
+
+void
+RenderQueue::submit (OpenGLContext* context, const ShaderProgram* only,
+                     bool matching) const
+{
+  ShaderProgram* program = nullptr;
+  const Material* material = nullptr;
+  GLuint vao = 0;
+  UniformHandle modelView { -1, 0, 0 };
+  UniformHandle world { -1, 0, 0 };
+  UniformHandle modelViewProjection { -1, 0, 0 };
+  UniformHandle normalMatrix { -1, 0, 0 };
+  UniformHandle drawData { -1, 0, 0 };
+  UniformHandle drawBase { -1, 0, 0 };
+  // Timing each draw costs two queries, so it is only asked for in the
+  //   profiler's detailed mode.
+  bool timed = context->getProfiler () != nullptr && context->getProfiler ()->isDetailed ();
+  bool multiDraw = m_uploaded != 0 && m_uploaded == m_merged.size ();
+  if (multiDraw)
+  {
+    context->bindBuffer (GL_DRAW_INDIRECT_BUFFER, m_stream->getBuffer ());
+    context->activeTexture (GL_TEXTURE0 + DRAW_DATA_UNIT);
+    context->bindTexture (GL_TEXTURE_BUFFER, m_drawDataTexture);
+    context->activeTexture (GL_TEXTURE0);
+  }
+  for (unsigned int i = 0; i < m_merged.size (); ++i)
+  {
+    const DrawPacket& packet = *m_merged[i].second;
+    if ((packet.program == only) != matching)
+      continue;
+    if (packet.program != program)
+    {
+      program = packet.program;
+      material = nullptr;
+      program->enable ();
+      modelView = program->getUniformHandle ("uModelView");
+      world = program->getUniformHandle ("uWorld");
+      modelViewProjection = program->getUniformHandle ("uModelViewProjection");
+      normalMatrix = program->getUniformHandle ("uNormalMatrix");
+      drawData = program->getUniformHandle ("uDrawData");
+      drawBase = program->getUniformHandle ("uDrawBase");
+      if (multiDraw)
+        program->setUniformInt (drawData, DRAW_DATA_UNIT);
+    }
+    if (packet.material != material && packet.material != nullptr)
+    {
+      material = packet.material;
+      packet.material->setUniforms (program);
+    }
+    if (packet.vao != vao)
+    {
+      vao = packet.vao;
+      context->bindVertexArray (vao);
+    }
+    if (multiDraw && drawData.location >= 0)
+    {
+      // A multi-draw has no one Mesh to time it under, so it is left to the
+      //   pass's scope.
+      unsigned int end = i + 1;
+      while (end < m_merged.size () && m_merged[end].second->program == program
+             && m_merged[end].second->material == packet.material
+             && m_merged[end].second->vao == vao)
+        ++end;
+      program->setUniformInt (drawBase, m_drawDataOffset / sizeof (DrawData) + i);
+      GLintptr indirect = m_commandOffset + i * sizeof (DrawElementsIndirectCommand);
+      context->multiDrawElementsIndirect (GL_TRIANGLES, GL_UNSIGNED_INT,
+                                          reinterpret_cast<void*> (indirect), end - i, 0);
+      i = end - 1;
+      continue;
+    }
+    program->setUniformMatrix (modelView, toMatrix (packet.modelView));
+    program->setUniformMatrix (world, toMatrix (packet.world));
+    program->setUniformMatrix (modelViewProjection,
+                               toMatrix (packet.modelViewProjection));
+    program->setUniformMatrix (normalMatrix, toMatrix3 (packet.normalMatrix));
+    if (timed)
+      context->beginScope (packet.name, true);
+    context->drawElements (GL_TRIANGLES, packet.indexCount, GL_UNSIGNED_INT,
+                           reinterpret_cast<void*> (packet.firstIndex * sizeof (GLuint)));
+    if (timed)
+      context->endScope (true);
+  }
+  if (vao != 0)
+    context->bindVertexArray (0);
+  if (program != nullptr)
+    program->disable ();
+  if (multiDraw)
+    context->bindBuffer (GL_DRAW_INDIRECT_BUFFER, 0);
+}
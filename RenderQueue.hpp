@@ -0,0 +1,279 @@
+/// \file RenderQueue.hpp
+/// \brief Declaration of DrawPacket, DrawData, DrawElementsIndirectCommand,
+///   RenderCommandBuffer, and RenderQueue classes and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef RENDER_QUEUE_HPP
+#define RENDER_QUEUE_HPP
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+#include "StreamBuffer.hpp"
+#include "ShaderProgram.hpp"
+#include "Material.hpp"
+#include "Transform.hpp"
+#include "Matrix4.hpp"
+
+/// The texture unit of the per-draw data buffer texture ("uDrawData").
+const GLuint DRAW_DATA_UNIT = 7;
+
+/// \brief Everything needed to issue one draw call, recorded ahead of time so
+///   that it can be built on any thread and replayed on the OpenGL thread.
+///
+/// This is plain data: it can be copied with memcpy and holds no ownership.
+struct DrawPacket
+{
+  /// The order to draw in (see makeSortKey).
+  uint64_t sortKey;
+  /// The name of the Mesh drawn, for GPU timing.
+  const char* name;
+  /// The shader program to draw with.
+  ShaderProgram* program;
+  /// The material whose uniforms to set, or nullptr.
+  Material* material;
+  /// The vertex array object that holds the geometry.
+  GLuint vao;
+  /// The number of indices to draw.
+  GLsizei indexCount;
+  /// The position of the first index in the element buffer.
+  GLuint firstIndex;
+  /// The column-major world matrix ("uWorld").
+  float world[16];
+  /// The column-major model-view matrix ("uModelView").
+  float modelView[16];
+  /// The column-major model-view-projection matrix ("uModelViewProjection").
+  float modelViewProjection[16];
+  /// The column-major normal matrix ("uNormalMatrix"), which takes normals
+  ///   to eye space.
+  float normalMatrix[9];
+};
+
+/// \brief One draw's transformations, as the multi-draw shader variants read
+///   them from the "uDrawData" buffer texture (RGBA32F): the draw of
+///   gl_DrawID is at texel DRAW_DATA_TEXELS * (uDrawBase + gl_DrawID).
+struct DrawData
+{
+  /// The column-major world matrix.
+  float world[16];
+  /// The column-major model-view matrix.
+  float modelView[16];
+  /// The column-major model-view-projection matrix.
+  float modelViewProjection[16];
+  /// The columns of the normal matrix, each padded to a texel.
+  float normalMatrix[12];
+};
+
+/// The number of RGBA32F texels in one DrawData.
+const unsigned int DRAW_DATA_TEXELS = sizeof (DrawData) / (4 * sizeof (float));
+
+/// \brief One draw of glMultiDrawElementsIndirect, laid out as OpenGL reads
+///   it from GL_DRAW_INDIRECT_BUFFER.
+struct DrawElementsIndirectCommand
+{
+  /// The number of indices.
+  GLuint count;
+  /// The number of instances.
+  GLuint instanceCount;
+  /// The first index in the element buffer.
+  GLuint firstIndex;
+  /// Added to every index.
+  GLint baseVertex;
+  /// The first instance (for instanced attributes).
+  GLuint baseInstance;
+};
+
+static_assert (sizeof (DrawData) == 240 && sizeof (DrawElementsIndirectCommand) == 20,
+               "DrawData or DrawElementsIndirectCommand is padded");
+
+/// \brief A linear buffer of DrawPackets that a single thread records into.
+class RenderCommandBuffer
+{
+public:
+
+  /// \brief Constructs an empty RenderCommandBuffer.
+  RenderCommandBuffer ();
+
+  /// \brief Destructs a RenderCommandBuffer.
+  ~RenderCommandBuffer ();
+
+  /// \brief Appends a packet.
+  /// \param[in] packet The packet to copy into this buffer.
+  void
+  record (const DrawPacket& packet);
+
+  /// \brief Removes every packet, keeping the memory for the next frame.
+  /// \post This buffer is empty.
+  void
+  clear ();
+
+  /// \brief Gets the number of recorded packets.
+  /// \return The number of packets since the last clear ().
+  unsigned int
+  size () const;
+
+  /// \brief Gets the recorded packets.
+  /// \return A pointer to size () packets, in recording order.
+  const DrawPacket*
+  data () const;
+
+private:
+
+  /// The recorded packets.
+  std::vector<DrawPacket> m_packets;
+};
+
+/// \brief One RenderCommandBuffer per thread, merged into draw order and
+///   replayed through an OpenGLContext.
+///
+/// Each frame, worker i records only into getBuffer (i), so recording needs
+///   no locks.  Then, on the thread that owns the OpenGL context, merge ()
+///   sorts every packet by key and submit () issues the draw calls, only
+///   switching shader programs, materials, and vertex arrays when they
+///   change from one packet to the next.
+///
+/// With multi-draw on, upload () also writes a DrawElementsIndirectCommand
+///   and a DrawData for every merged packet, in merged order, straight into
+///   a StreamBuffer, whose whole storage "uDrawData" reads.  Then each run
+///   of packets that share a program, material, and vertex array (every
+///   Mesh of a GeometryArena format shares one) is drawn with a single
+///   glMultiDrawElementsIndirect call, as long as the program reads its
+///   transformations from "uDrawData"; other programs are drawn a packet at
+///   a time, as before.
+class RenderQueue
+{
+public:
+
+  /// \brief Constructs a RenderQueue.
+  /// \param[in] bufferCount The number of RenderCommandBuffers, normally one
+  ///   per worker thread.
+  explicit
+  RenderQueue (unsigned int bufferCount = 1);
+
+  /// \brief Destructs a RenderQueue.
+  ~RenderQueue ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   RenderQueues.
+  RenderQueue (const RenderQueue&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   RenderQueues.
+  RenderQueue&
+  operator= (const RenderQueue&) = delete;
+
+  /// \brief Changes the number of RenderCommandBuffers.
+  /// \param[in] bufferCount The new number of buffers.
+  /// \post Every buffer is empty.
+  void
+  setBufferCount (unsigned int bufferCount);
+
+  /// \brief Gets the number of RenderCommandBuffers.
+  /// \return The number of buffers.
+  unsigned int
+  getBufferCount () const;
+
+  /// \brief Gets the buffer that one thread records into.
+  /// \param[in] index The thread's worker index, less than getBufferCount ().
+  /// \return That thread's buffer.
+  RenderCommandBuffer&
+  getBuffer (unsigned int index);
+
+  /// \brief Empties every buffer and the merged order.
+  void
+  clear ();
+
+  /// \brief Puts every recorded packet into draw order.
+  /// \post getPacketCount () is the total number of recorded packets, and
+  ///   they are ordered by sort key.
+  void
+  merge ();
+
+  /// \brief Chooses whether or not submit () draws runs of packets with
+  ///   glMultiDrawElementsIndirect.
+  /// \param[in] context The context to make the command and per-draw data
+  ///   buffers through, which needs glMultiDrawElementsIndirect and
+  ///   gl_DrawID (OpenGL 4.6 or ARB_multi_draw_indirect and
+  ///   ARB_shader_draw_parameters), or nullptr to draw every packet on its
+  ///   own.
+  /// \pre This is the thread that owns the OpenGL context.
+  void
+  setMultiDrawIndirect (OpenGLContext* context);
+
+  /// \brief Tests whether or not submit () draws with multi-draws.
+  /// \return Whether a context was last passed to setMultiDrawIndirect ().
+  bool
+  isMultiDrawIndirect () const;
+
+  /// \brief Writes the merged packets' indirect commands and per-draw data
+  ///   into the next region of the stream buffer, if multi-draw is on.  The
+  ///   region written by the last upload is fenced first, so everything
+  ///   drawn from it since must have been submitted.
+  /// \pre This is the thread that owns the OpenGL context, and merge () has
+  ///   been called since the last packet was recorded.
+  void
+  upload ();
+
+  /// \brief Gets the buffer that the indirect commands and per-draw data
+  ///   are streamed through.
+  /// \return The buffer, or nullptr if multi-draw is off.
+  const StreamBuffer*
+  getStreamBuffer () const;
+
+  /// \brief Gets the number of packets in the merged order.
+  /// \return The number of packets that submit () will draw.
+  unsigned int
+  getPacketCount () const;
+
+  /// \brief Issues the merged packets' draw calls.
+  /// \param[in] context The context to make OpenGL calls through.
+  /// \pre This is the thread that owns the OpenGL context, and merge () has
+  ///   been called since the last packet was recorded.
+  /// \pre If multi-draw is on, upload () has been called since merge ().
+  /// \pre The camera and light uniform blocks hold this frame's data.
+  /// \post Every packet has been drawn, no vertex array is bound, and no
+  ///   program is in use.
+  void
+  submit (OpenGLContext* context) const;
+
+  /// \brief Issues the draw calls of the merged packets that do, or that do
+  ///   not, use one shader program, so that passes can be split by program.
+  /// \param[in] context The context to make OpenGL calls through.
+  /// \param[in] only The shader program.
+  /// \param[in] matching Whether to draw the packets that use it (true) or
+  ///   every other packet (false).
+  /// \pre The same as for submit (context).
+  /// \post Those packets have been drawn, no vertex array is bound, and no
+  ///   program is in use.
+  void
+  submit (OpenGLContext* context, const ShaderProgram* only,
+          bool matching) const;
+
+private:
+
+  /// One buffer per recording thread.
+  std::vector<RenderCommandBuffer> m_buffers;
+  /// Every recorded packet, by sort key.
+  std::vector<std::pair<uint64_t, const DrawPacket*>> m_merged;
+  /// The context the multi-draw buffers were made through, or nullptr if
+  ///   multi-draw is off.
+  OpenGLContext* m_context;
+  /// The buffer the commands and per-draw data are written to, or nullptr
+  ///   if multi-draw is off.
+  StreamBuffer* m_stream;
+  /// The buffer texture that reads all of m_stream ("uDrawData").
+  GLuint m_drawDataTexture;
+  /// The number of merged packets the last upload () wrote, or 0 if merge ()
+  ///   has been called since.
+  unsigned int m_uploaded;
+  /// Where the last upload () wrote its commands, in m_stream.
+  GLintptr m_commandOffset;
+  /// Where the last upload () wrote its per-draw data, in m_stream.
+  GLintptr m_drawDataOffset;
+};
+
+#endif//RENDER_QUEUE_HPP
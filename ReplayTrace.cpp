@@ -0,0 +1,212 @@
+/// \file ReplayTrace.cpp
+/// \brief A program that replays a trace of OpenGL calls, captured with
+///   "Main.out --trace", against this machine's driver, and reports how long
+///   each frame and each kind of call took.
+/// \author Ryan Ganzke
+/// \version A09
+///
+/// Usage: ReplayTrace.out trace-file [--paced] [--size WIDTHxHEIGHT]
+///
+/// By default the frames are replayed as fast as possible; with --paced each
+///   frame ends no sooner after the first than it did when it was recorded.
+///   Since the trace holds every call the engine made, replaying it costs no
+///   engine CPU time, so a change in these numbers between two builds or
+///   drivers comes from the driver or GPU, not the engine.
+///
+/// The first frame also makes everything the trace creates (shaders,
+///   buffers, textures), so it is reported on its own and left out of the
+///   rest.  Each frame's "submit" time is spent making its calls; its "frame"
+///   time also includes swapping buffers and waiting for the GPU to finish.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include "RealOpenGLContext.hpp"
+#include "RecordingOpenGLContext.hpp"
+#include "TraceReplayer.hpp"
+
+namespace
+{
+  /// The width of the longest bar in the call histogram.
+  const int BAR_WIDTH = 30;
+
+  /// \brief Gets the time since some fixed point, in milliseconds.
+  /// \return The current time.
+  double
+  now ()
+  {
+    using namespace std::chrono;
+    return duration<double, std::milli> (steady_clock::now ().time_since_epoch ()).count ();
+  }
+
+  /// \brief Prints the minimum, median, mean, 95th percentile, and maximum of
+  ///   some times.
+  /// \param[in] name What was timed.
+  /// \param[in] times The times, in milliseconds.
+  void
+  reportTimes (const char* name, std::vector<double> times)
+  {
+    if (times.empty ())
+      return;
+    std::sort (times.begin (), times.end ());
+    double total = 0.0;
+    for (double time : times)
+      total += time;
+    printf ("%-8s %10.3f %10.3f %10.3f %10.3f %10.3f\n", name, times.front (),
+            times[times.size () / 2], total / times.size (),
+            times[times.size () * 95 / 100], times.back ());
+  }
+
+  /// \brief Prints a table of every kind of call made, longest total time
+  ///   first, with a bar for each kind's share of the time.
+  /// \param[in] replayer The replayer.
+  /// \param[in] frames The number of frames the stats cover.
+  void
+  reportCalls (const TraceReplayer& replayer, std::size_t frames)
+  {
+    typedef RecordingOpenGLContext R;
+    std::vector<R::RecordedCall> calls;
+    double total = 0.0;
+    for (int call = 0; call < R::RECORDED_CALL_COUNT; ++call)
+    {
+      const TraceCallStats& stats = replayer.getCallStats (static_cast<R::RecordedCall> (call));
+      if (stats.count == 0)
+        continue;
+      calls.push_back (static_cast<R::RecordedCall> (call));
+      total += stats.totalMicros;
+    }
+    std::sort (calls.begin (), calls.end (),
+               [&replayer] (R::RecordedCall a, R::RecordedCall b)
+               {
+                 return replayer.getCallStats (a).totalMicros
+                   > replayer.getCallStats (b).totalMicros;
+               });
+
+    printf ("%-30s %10s %10s %10s %10s %10s\n", "call", "calls", "per frame",
+            "total ms", "mean us", "max us");
+    for (R::RecordedCall call : calls)
+    {
+      const TraceCallStats& stats = replayer.getCallStats (call);
+      int bar = total > 0.0 ? static_cast<int> (BAR_WIDTH * stats.totalMicros / total + 0.5) : 0;
+      printf ("%-30s %10lu %10.1f %10.3f %10.3f %10.1f %s\n", R::getCallName (call),
+              stats.count, static_cast<double> (stats.count) / std::max<std::size_t> (frames, 1),
+              stats.totalMicros / 1000.0, stats.totalMicros / stats.count, stats.maxMicros,
+              std::string (bar, '#').c_str ());
+    }
+  }
+}
+
+/// \brief Replays a trace and reports on it.
+/// \param[in] argc The number of command-line arguments.
+/// \param[in] argv The trace's path and the options.
+int
+main (int argc, char* argv[])
+{
+  const char* path = nullptr;
+  bool paced = false;
+  int width = 800;
+  int height = 600;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::strcmp (argv[i], "--paced") == 0)
+      paced = true;
+    else if (std::strcmp (argv[i], "--size") == 0 && i + 1 < argc)
+      std::sscanf (argv[++i], "%dx%d", &width, &height);
+    else
+      path = argv[i];
+  }
+  if (path == nullptr)
+  {
+    fprintf (stderr, "Usage: %s trace-file [--paced] [--size WIDTHxHEIGHT]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  if (!glfwInit ())
+  {
+    fprintf (stderr, "Failed to init GLFW -- exiting\n");
+    return EXIT_FAILURE;
+  }
+  glfwWindowHint (GLFW_CONTEXT_VERSION_MAJOR, 3);
+  glfwWindowHint (GLFW_CONTEXT_VERSION_MINOR, 3);
+#ifdef __APPLE__
+  glfwWindowHint (GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+  glfwWindowHint (GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#endif
+  GLFWwindow* window = glfwCreateWindow (width, height, "Trace Replay", nullptr, nullptr);
+  if (window == nullptr)
+  {
+    fprintf (stderr, "Failed to init the window -- exiting\n");
+    glfwTerminate ();
+    return EXIT_FAILURE;
+  }
+  glfwMakeContextCurrent (window);
+  // Pacing, if any, is ours, not the display's.
+  glfwSwapInterval (0);
+  if (glewInit () != GLEW_OK)
+  {
+    fprintf (stderr, "Failed to initialize GLEW -- exiting\n");
+    return EXIT_FAILURE;
+  }
+
+  RealOpenGLContext context;
+  TraceReplayer replayer (&context);
+  if (!replayer.load (path))
+    return EXIT_FAILURE;
+  printf ("Replaying %s on %s%s\n", path, context.getString (GL_RENDERER),
+          paced ? ", at the recorded pace" : "");
+
+  std::vector<double> submitTimes;
+  std::vector<double> frameTimes;
+  double firstFrame = 0.0;
+  double replayStart = 0.0;
+  std::uint64_t firstFrameTime = 0;
+  while (!glfwWindowShouldClose (window))
+  {
+    double start = now ();
+    if (!replayer.replayFrame ())
+      break;
+    double submitted = now ();
+    glfwSwapBuffers (window);
+    // Not part of the trace: waits for the GPU, so the frame time covers it.
+    glFinish ();
+    double finished = now ();
+    glfwPollEvents ();
+
+    if (replayer.getFrameCount () == 1)
+    {
+      firstFrame = finished - start;
+      replayStart = finished;
+      firstFrameTime = replayer.getFrameTime ();
+      replayer.resetCallStats ();
+      continue;
+    }
+    submitTimes.push_back (submitted - start);
+    frameTimes.push_back (finished - start);
+    if (paced)
+    {
+      double due = replayStart + (replayer.getFrameTime () - firstFrameTime) / 1000.0;
+      if (due > now ())
+        std::this_thread::sleep_for (std::chrono::duration<double, std::milli> (due - now ()));
+    }
+  }
+
+  printf ("First frame, with setup: %.3f ms\n", firstFrame);
+  printf ("%zu more frames\n", submitTimes.size ());
+  printf ("%-8s %10s %10s %10s %10s %10s\n", "ms", "min", "median", "mean", "95%", "max");
+  reportTimes ("submit", submitTimes);
+  reportTimes ("frame", frameTimes);
+  reportCalls (replayer, submitTimes.size ());
+
+  glfwDestroyWindow (window);
+  glfwTerminate ();
+  return EXIT_SUCCESS;
+}
@@ -3,10 +3,64 @@
 /// \author Ryan Ganzke
 /// \version A02
 
+#include <algorithm>
+#include <cstring>
+
 #include "Scene.hpp"
+#include "JobSystem.hpp"
+#include "Frustum.hpp"
+#include "SortKey.hpp"
+
+namespace
+{
+  /// The number of Meshes handed to each job by Scene::prepareFrame.
+  const unsigned int MESHES_PER_JOB = 256;
+
+  /// The intensity of the ambient light, in every color.
+  const float AMBIENT_INTENSITY = 0.5f;
+
+  /// \brief Transforms a point of a uniform block in place.
+  /// \param[in] matrix The transformation.
+  /// \param[in,out] point The block's three floats.
+  void
+  transformPoint (const Matrix4& matrix, float point[3])
+  {
+    Vector4 result = matrix * Vector4 (point[0], point[1], point[2], 1.0f);
+    point[0] = result.m_x;
+    point[1] = result.m_y;
+    point[2] = result.m_z;
+  }
+
+  /// \brief Transforms a direction of a uniform block in place and makes it
+  ///   unit length.
+  /// \param[in] matrix The transformation.
+  /// \param[in,out] direction The block's three floats.  A zero vector is
+  ///   left alone.
+  void
+  transformDirection (const Matrix4& matrix, float direction[3])
+  {
+    Vector4 result = matrix * Vector4 (direction[0], direction[1], direction[2], 0.0f);
+    Vector3 unit (result.m_x, result.m_y, result.m_z);
+    if (unit.length () > 0.0f)
+      unit.normalize ();
+    direction[0] = unit.m_x;
+    direction[1] = unit.m_y;
+    direction[2] = unit.m_z;
+  }
+}
 
-Scene::Scene (ShaderProgram* shader, Camera* camera)
-  : s_meshes (), s_activeMesh (s_meshes.begin ()), s_shader (shader), s_camera (camera)
+Scene::Scene (OpenGLContext* context, ShaderProgram* shader, Camera* camera)
+  : s_hierarchy (), s_meshes (), s_activeMesh (s_meshes.begin ()), s_shader (shader),
+    s_permutations (nullptr), s_litShader (shader), s_deferredLightingShader (nullptr),
+    s_lightCounts { 0, 0, 0 }, s_camera (camera),
+    s_context (context), s_jobs (nullptr), s_renderQueue (), s_occluders (),
+    s_occlusion (), s_materials (context), s_cameraData (),
+    s_cameraBuffer (context, sizeof (CameraBlock), CAMERA_BLOCK_BINDING),
+    s_lightData (), s_lightBuffer (context, sizeof (LightBlock), LIGHT_BLOCK_BINDING),
+    s_view (), s_lightEntries (), s_clustered (false), s_clusters (context),
+    s_shadingPath (FORWARD_SHADING), s_gBuffer (context), s_arena (context),
+    s_multiDraw (false), s_gpuCuller (nullptr), s_gpuDrawList (), s_drawListDirty (true),
+    s_gpuObjectsStale (false), s_gpuWorldsStale (false), s_arenaDefragments (0)
 {
 
 }
@@ -14,15 +68,28 @@ Scene::Scene (ShaderProgram* shader, Camera* camera)
 Scene::~Scene ()
 {
   clear();
+  delete s_gpuCuller;
 }
 
 void
 Scene::add (const std::string& meshName, Mesh* mesh)
 {
   s_meshes[meshName] = mesh;
+  mesh->setName (meshName);
+  mesh->attachToHierarchy (&s_hierarchy);
+  mesh->attachToMaterialTable (&s_materials);
+  if (!mesh->isPrepared ())
+    mesh->setArena (&s_arena);
 
   if(s_meshes.size () == 1)
     s_activeMesh = s_meshes.begin();
+  s_drawListDirty = true;
+}
+
+GeometryArena&
+Scene::getGeometryArena ()
+{
+  return s_arena;
 }
 
 void
@@ -30,8 +97,10 @@ Scene::remove (const std::string& meshName)
 {
   if (s_activeMesh->second == s_meshes[meshName])
     activateNextMesh ();
+  s_occluders.erase (s_meshes[meshName]);
   delete s_meshes[meshName];
   s_meshes.erase(meshName);
+  s_drawListDirty = true;
 }
 
 void
@@ -39,14 +108,289 @@ Scene::clear () {
   for (auto& mesh : s_meshes)
     delete mesh.second;
   s_meshes.clear();
+  s_occluders.clear ();
+  s_drawListDirty = true;
+}
+
+void
+Scene::setParent (const std::string& meshName, const std::string& parentName)
+{
+  s_hierarchy.setParent (s_meshes.at (meshName)->getNode (),
+                         s_meshes.at (parentName)->getNode ());
+}
+
+void
+Scene::clearParent (const std::string& meshName)
+{
+  s_hierarchy.setParent (s_meshes.at (meshName)->getNode (),
+                         TransformHierarchy::NO_PARENT);
+}
+
+void
+Scene::setOccluder (const std::string& meshName, bool isOccluder)
+{
+  if (isOccluder)
+    s_occluders.insert (s_meshes.at (meshName));
+  else
+    s_occluders.erase (s_meshes.at (meshName));
+}
+
+TransformHierarchy&
+Scene::getHierarchy ()
+{
+  return s_hierarchy;
+}
+
+void
+Scene::setLightingPermutations (ShaderPermutations* permutations)
+{
+  s_permutations = permutations;
+  s_litShader = s_shader;
+  s_drawListDirty = true;
+}
+
+void
+Scene::setClusteredLighting (bool enabled)
+{
+  s_clustered = enabled;
+}
+
+bool
+Scene::isClusteredLighting () const
+{
+  return s_clustered;
+}
+
+void
+Scene::setShadingPath (ShadingPath path)
+{
+  s_shadingPath = path;
+}
+
+Scene::ShadingPath
+Scene::getShadingPath () const
+{
+  return s_shadingPath;
+}
+
+void
+Scene::setMultiDrawIndirect (bool enabled)
+{
+  s_multiDraw = enabled;
+  s_renderQueue.setMultiDrawIndirect (enabled ? s_context : nullptr);
+  s_drawListDirty = true;
+}
+
+bool
+Scene::isMultiDrawIndirect () const
+{
+  return s_multiDraw;
+}
+
+void
+Scene::setGpuCulling (ShaderProgram* cullProgram)
+{
+  delete s_gpuCuller;
+  s_gpuCuller = (cullProgram == nullptr) ? nullptr : new GpuCuller (s_context, cullProgram);
+  s_drawListDirty = true;
+}
+
+bool
+Scene::isGpuCulling () const
+{
+  return s_gpuCuller != nullptr;
+}
+
+const StreamBuffer*
+Scene::getStreamBuffer () const
+{
+  return s_renderQueue.getStreamBuffer ();
+}
+
+void
+Scene::setJobSystem (JobSystem* jobs)
+{
+  s_jobs = jobs;
+  s_renderQueue.setBufferCount (jobs == nullptr ? 1 : jobs->getWorkerCount ());
+}
+
+void
+Scene::prepareFrame (const Transform& viewMatrix, const Matrix4& projectionMatrix)
+{
+  bool gpu = usesGpuCulling ();
+  if (s_hierarchy.update (s_jobs) > 0)
+    s_gpuWorldsStale = true;
+  if (s_arena.getDefragmentCount () != s_arenaDefragments)
+  {
+    // The culler holds copies of the Meshes' index ranges, which moved.
+    s_arenaDefragments = s_arena.getDefragmentCount ();
+    s_drawListDirty = true;
+  }
+
+  // On the GPU path the CPU's share can't grow with the Meshes, so the lists
+  //   are only rebuilt when they change.
+  if (!gpu || s_drawListDirty)
+  {
+    s_drawList.clear ();
+    s_gpuDrawList.clear ();
+    for (auto& mesh : s_meshes)
+    {
+      if (gpu && mesh.second->getShader () == s_shader && mesh.second->isPrepared ())
+        s_gpuDrawList.push_back (mesh.second);
+      else
+        s_drawList.push_back (mesh.second);
+    }
+    s_drawListDirty = false;
+    s_gpuObjectsStale = gpu;
+  }
+  s_renderQueue.clear ();
+
+  Matrix4 view = viewMatrix.getTransform ();
+  Matrix4 viewProjection = projectionMatrix * view;
+  Frustum frustum (viewProjection);
+  const float* v = view.data ();
+  const float* worlds = s_hierarchy.getWorldMatrices ();
+
+  bool occlusion = !s_occluders.empty ();
+  if (occlusion)
+  {
+    s_occlusion.begin (viewProjection);
+    for (const Mesh* occluder : s_occluders)
+    {
+      const float* world = worlds + 16 * occluder->getNode ();
+      if (!frustum.intersectsSphere (world, occluder->getBoundsCenter (),
+                                     occluder->getBoundsRadius ()))
+        continue;
+      s_occlusion.addOccluder (world, occluder->getOccluderVertices ().data (),
+                               occluder->getOccluderStride (),
+                               occluder->getOccluderIndices ().data (),
+                               occluder->getOccluderIndices ().size ());
+    }
+    s_occlusion.rasterize (s_jobs);
+  }
+  auto cullAndRecord = [&] (unsigned int first, unsigned int last)
+  {
+    RenderCommandBuffer& buffer =
+      s_renderQueue.getBuffer (s_jobs == nullptr ? 0 : s_jobs->getCurrentWorker ());
+    for (unsigned int i = first; i < last; ++i)
+    {
+      const Mesh* mesh = s_drawList[i];
+      const float* world = worlds + 16 * mesh->getNode ();
+      if (!frustum.intersectsSphere (world, mesh->getBoundsCenter (),
+                                     mesh->getBoundsRadius ()))
+        continue;
+      if (occlusion && !s_occlusion.isVisible (world, mesh->getBoundsCenter (),
+                                               mesh->getBoundsRadius ()))
+        continue;
+      // The camera looks down its -Z axis.
+      float depth = -(v[2] * world[12] + v[6] * world[13] + v[10] * world[14] + v[14]);
+      ShaderProgram* program = mesh->getShader ();
+      if (program == s_shader)
+        program = s_litShader;
+      const Material* material = mesh->getMaterial ();
+      uint64_t key = makeSortKey (program->getId (),
+                                  material == nullptr ? 0 : material->getTableIndex (),
+                                  depth);
+      mesh->record (view, projectionMatrix, program, key, buffer);
+    }
+  };
+  if (s_jobs == nullptr)
+    cullAndRecord (0, s_drawList.size ());
+  else
+    s_jobs->parallelFor (0, s_drawList.size (), MESHES_PER_JOB, cullAndRecord);
+
+  s_renderQueue.merge ();
 }
 
 void
 Scene::draw (const Transform &viewMatrix, const Matrix4& projectionMatrix)
 {
+  setCameraUniforms (viewMatrix, projectionMatrix);
   setUniforms ();
-  for (auto& mesh : s_meshes)
-    mesh.second->draw(viewMatrix, projectionMatrix);
+  // Something else may have used these binding points since the last frame.
+  s_cameraBuffer.bind ();
+  s_lightBuffer.bind ();
+  if (s_clustered && s_permutations != nullptr)
+  {
+    s_clusters.update (projectionMatrix, s_lightEntries);
+    s_clusters.bind ();
+  }
+  // The G-buffer is bound now, so a frame it can't be used for (an empty
+  //   viewport, or an incomplete framebuffer) is drawn forward instead.
+  bool deferred = s_shadingPath == DEFERRED_SHADING && s_permutations != nullptr
+    && s_gBuffer.begin ();
+  selectLitShader (deferred);
+  prepareFrame (viewMatrix, projectionMatrix);
+  s_materials.update ();
+  s_renderQueue.upload ();
+  if (usesGpuCulling ())
+  {
+    s_context->beginScope ("culling pass");
+    if (s_gpuObjectsStale)
+    {
+      s_gpuCuller->setObjects (s_gpuDrawList);
+      s_gpuObjectsStale = false;
+      s_gpuWorldsStale = true;
+    }
+    if (s_gpuWorldsStale)
+    {
+      s_gpuCuller->setWorldMatrices (s_hierarchy.getWorldMatrices (),
+                                     s_hierarchy.getNodeCapacity ());
+      s_gpuWorldsStale = false;
+    }
+    s_gpuCuller->cull ();
+    s_context->endScope ();
+  }
+  if (deferred)
+    drawDeferred ();
+  else
+  {
+    s_context->beginScope ("opaque pass");
+    s_renderQueue.submit (s_context);
+    if (usesGpuCulling ())
+      s_gpuCuller->submit (s_litShader);
+    s_context->endScope ();
+  }
+}
+
+bool
+Scene::usesGpuCulling () const
+{
+  return s_gpuCuller != nullptr && s_permutations != nullptr && s_multiDraw;
+}
+
+void
+Scene::drawDeferred ()
+{
+  // Geometry pass: only Meshes using the G-buffer variant can be lit later.
+  s_context->beginScope ("geometry pass");
+  s_renderQueue.submit (s_context, s_litShader, true);
+  if (usesGpuCulling ())
+    s_gpuCuller->submit (s_litShader);
+  s_gBuffer.end ();
+  s_context->endScope ();
+
+  // Lighting pass: every covered pixel once.  It copies the G-buffer's depth
+  //   out too, so it must always pass the depth test.
+  s_context->beginScope ("lighting pass");
+  s_deferredLightingShader->enable ();
+  s_gBuffer.bind ();
+  s_context->depthFunc (GL_ALWAYS);
+  s_gBuffer.drawScreen ();
+  s_context->depthFunc (GL_LESS);
+  s_deferredLightingShader->disable ();
+  s_context->endScope ();
+
+  // Everything else is unlit, and is drawn forward against that depth.
+  s_context->beginScope ("unlit pass");
+  s_renderQueue.submit (s_context, s_litShader, false);
+  s_context->endScope ();
+}
+
+unsigned int
+Scene::getVisibleCount () const
+{
+  return s_renderQueue.getPacketCount ();
 }
 
 bool
@@ -117,11 +461,82 @@ Scene::addSpotLightSource (const Vector3& diffuseIntensity, const Vector3& specu
 void
 Scene::setUniforms ()
 {
-  s_shader->enable ();
-  s_shader->setUniformVector ("uEyePosition", s_camera->getEyePosition ());
-  s_shader->setUniformInt ("uNumLights", s_lightSource.size());
-  for (int i = 0; i < s_lightSource.size(); i++)
+  // Clearing first keeps the unused entries and padding the same from frame
+  //   to frame, so an unchanged block is not uploaded again.
+  std::memset (&s_lightData, 0, sizeof (s_lightData));
+  s_lightEntries.resize (s_lightSource.size ());
+  for (unsigned int i = 0; i < s_lightSource.size (); ++i)
+  {
+    LightBlockEntry& entry = s_lightEntries[i];
+    std::memset (&entry, 0, sizeof (entry));
+    s_lightSource[i]->writeBlock (entry);
+    // The shaders light in eye space, so move the lights there once per
+    //   frame rather than once per vertex or fragment.
+    transformPoint (s_view, entry.position);
+    transformDirection (s_view, entry.direction);
+  }
+  // Group the lights by type, so a specialized shader can loop over each
+  //   type with a constant count.
+  std::stable_sort (s_lightEntries.begin (), s_lightEntries.end (),
+                    [] (const LightBlockEntry& a, const LightBlockEntry& b)
+                    { return a.type < b.type; });
+  unsigned int count = std::min<std::size_t> (s_lightEntries.size (), MAX_LIGHTS);
+  std::fill (s_lightCounts, s_lightCounts + 3, 0);
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    s_lightData.lights[i] = s_lightEntries[i];
+    ++s_lightCounts[s_lightEntries[i].type];
+  }
+  s_lightData.numLights = count;
+  s_lightBuffer.update (&s_lightData);
+}
+
+void
+Scene::selectLitShader (bool deferred)
+{
+  if (s_permutations == nullptr)
+    return;
+  std::string defines;
+  if (s_clustered)
+  {
+    // Point and spot lights come from the clusters instead.
+    defines = "#define CLUSTERED_LIGHTING\n"
+      "#define NUM_DIRECTIONAL_LIGHTS "
+      + std::to_string (s_lightCounts[DIRECTIONAL]) + "\n";
+  }
+  else
   {
-    s_lightSource[i]->setUniforms (s_shader, i);
+    defines = "#define NUM_DIRECTIONAL_LIGHTS "
+      + std::to_string (s_lightCounts[DIRECTIONAL]) + "\n"
+      + "#define NUM_POINT_LIGHTS " + std::to_string (s_lightCounts[POINT]) + "\n"
+      + "#define NUM_SPOT_LIGHTS " + std::to_string (s_lightCounts[SPOT]) + "\n";
   }
-}
\ No newline at end of file
+  // Only the variants Meshes are drawn with read gl_DrawID.
+  std::string multiDraw = s_multiDraw ? "#define MULTI_DRAW_INDIRECT\n" : "";
+  if (deferred)
+  {
+    // The G-buffer variant doesn't depend on the lights.
+    s_litShader = s_permutations->get (multiDraw + "#define GBUFFER_PASS\n");
+    s_deferredLightingShader = s_permutations->get ("#define DEFERRED_LIGHTING\n"
+                                                    + defines);
+    return;
+  }
+  s_litShader = s_permutations->get (multiDraw + defines);
+  s_deferredLightingShader = nullptr;
+}
+
+void
+Scene::setCameraUniforms (const Transform& viewMatrix, const Matrix4& projectionMatrix)
+{
+  s_view = viewMatrix.getTransform ();
+  std::copy (s_view.data (), s_view.data () + 16, s_cameraData.view);
+  std::copy (projectionMatrix.data (), projectionMatrix.data () + 16,
+             s_cameraData.projection);
+  Vector3 eye = s_camera->getEyePosition ();
+  s_cameraData.eyePosition[0] = eye.m_x;
+  s_cameraData.eyePosition[1] = eye.m_y;
+  s_cameraData.eyePosition[2] = eye.m_z;
+  std::fill (s_cameraData.ambientIntensity, s_cameraData.ambientIntensity + 3,
+             AMBIENT_INTENSITY);
+  s_cameraBuffer.update (&s_cameraData);
+}
@@ -6,23 +6,52 @@
 #ifndef SCENE_HPP
 #define SCENE_HPP
 
+#include <cstdint>
 #include <string>
 #include <map>
+#include <set>
+#include <vector>
 
 #include "Mesh.hpp"
 #include "ShaderProgram.hpp"
 #include "Transform.hpp"
+#include "TransformHierarchy.hpp"
 #include "Matrix4.hpp"
 #include "LightSource.hpp"
 #include "Camera.hpp"
+#include "RenderQueue.hpp"
+#include "OcclusionBuffer.hpp"
+#include "UniformBuffer.hpp"
+#include "MaterialTable.hpp"
+#include "ShaderPermutations.hpp"
+#include "LightClusters.hpp"
+#include "GBuffer.hpp"
+#include "GeometryArena.hpp"
+#include "GpuCuller.hpp"
+
+class JobSystem;
 
 /// \brief A collection of all the objects that exist in the world.
 class Scene
 {
 public:
+
+  /// \brief The ways draw () can light the Meshes drawn with the main (lit)
+  ///   shader program.
+  enum ShadingPath
+  {
+    /// Each Mesh is lit as it is drawn.
+    FORWARD_SHADING,
+    /// Each Mesh's normal, material, and depth are drawn into a G-buffer,
+    ///   then every pixel is lit once in a single screen-covering pass.
+    DEFERRED_SHADING
+  };
   
   /// \brief Constructs an empty Scene.
-  Scene (ShaderProgram* shader, Camera* s_camera);
+  /// \param[in] context The context that draw () makes OpenGL calls through.
+  /// \param[in] shader The Scene's main (lit) shader program.
+  /// \param[in] camera The camera the Scene is viewed through.
+  Scene (OpenGLContext* context, ShaderProgram* shader, Camera* camera);
 
   /// \brief Destructs a Scene, freeing the memory used by any Meshes in it.
   /// \post Any Meshes that were part of the Scene have been freed.
@@ -45,9 +74,56 @@ public:
   ///   and be responsible for de-allocating it.
   /// \pre The Scene does not contain any Mesh associated with meshName.
   /// \post The Scene contains the mesh, associated with the meshName.
+  /// \post The mesh's transform is a root of this Scene's hierarchy.
+  /// \post The mesh's material, and any it is given later, is in this
+  ///   Scene's MaterialTable until the mesh is removed.  A material must
+  ///   outlive every Mesh (in any Scene) that is drawn with it.
+  /// \post If the mesh had not been prepared, its geometry will go in this
+  ///   Scene's GeometryArena when it is.
   void
   add (const std::string& meshName, Mesh* mesh);
 
+  /// \brief Gets the GeometryArena that holds the geometry of this Scene's
+  ///   Meshes.
+  /// \return The arena, which should not be stored past the life of this
+  ///   Scene.
+  GeometryArena&
+  getGeometryArena ();
+
+  /// \brief Makes one Mesh's transform relative to another's, so that it
+  ///   follows that Mesh around (e.g., a moon around its planet).
+  /// \param[in] meshName The name of the Mesh that should become a child.
+  /// \param[in] parentName The name of the Mesh that should become its
+  ///   parent.
+  /// \pre This Scene contains Meshes associated with both names.
+  /// \post The child's world transform is its parent's world transform
+  ///   combined with the child's own transform.
+  void
+  setParent (const std::string& meshName, const std::string& parentName);
+
+  /// \brief Makes a Mesh's transform relative to the world again.
+  /// \param[in] meshName The name of the Mesh.
+  /// \pre This Scene contains a Mesh associated with meshName.
+  /// \post The Mesh's transform is a root of this Scene's hierarchy.
+  void
+  clearParent (const std::string& meshName);
+
+  /// \brief Chooses whether or not a Mesh hides the Meshes behind it.
+  /// \param[in] meshName The name of the Mesh.
+  /// \param[in] isOccluder Whether or not the Mesh should be drawn into the
+  ///   occlusion buffer each frame.  Large, solid Meshes (planets) make good
+  ///   occluders; while there are none, no occlusion culling is done.
+  /// \pre This Scene contains a Mesh associated with meshName.
+  void
+  setOccluder (const std::string& meshName, bool isOccluder);
+
+  /// \brief Gets the hierarchy that holds the transforms of this Scene's
+  ///   Meshes.
+  /// \return The hierarchy, which should not be stored past the life of this
+  ///   Scene.
+  TransformHierarchy&
+  getHierarchy ();
+
   /// \brief Removes a Mesh from this Scene.
   /// \param[in] meshName The name of the Mesh that should be removed.
   /// \pre This Scene contains a Mesh associated with meshName.
@@ -62,12 +138,146 @@ public:
   void
   clear ();
 
+  /// \brief Sets the variants of the main (lit) shader program that draw ()
+  ///   chooses from.
+  ///
+  /// Each variant is built with NUM_DIRECTIONAL_LIGHTS, NUM_POINT_LIGHTS,
+  ///   and NUM_SPOT_LIGHTS defined to this Scene's light counts, so it loops
+  ///   over each type a fixed number of times instead of branching on every
+  ///   light's type.  Meshes drawn with the main program are drawn with the
+  ///   variant that matches the current lights instead.
+  /// \param[in] permutations The variants, which must outlive this Scene and
+  ///   should be built from the same files as the main program, or nullptr
+  ///   to always use the main program.
+  void
+  setLightingPermutations (ShaderPermutations* permutations);
+
+  /// \brief Chooses whether point and spot lights are culled into clusters
+  ///   (see LightClusters) instead of going in the light uniform block.
+  ///
+  /// When clustering, every light is used, not just MAX_LIGHTS of them,
+  ///   and each fragment is only lit by the lights that reach its cluster.
+  ///   Only the variants set by setLightingPermutations can do this, so
+  ///   without them this has no effect.
+  /// \param[in] enabled Whether or not to cluster the lights.
+  void
+  setClusteredLighting (bool enabled);
+
+  /// \brief Tests whether or not lights are being clustered.
+  /// \return The value last passed to setClusteredLighting ().
+  bool
+  isClusteredLighting () const;
+
+  /// \brief Chooses how draw () lights the Meshes drawn with the main
+  ///   program.
+  ///
+  /// Deferred shading pays for a G-buffer's memory traffic, but lights each
+  ///   pixel once no matter how many Meshes overlap it.  Either path uses the
+  ///   same lights, Materials, and (if enabled) clusters, and Meshes drawn
+  ///   with other programs are always drawn forward, after the lighting.
+  ///   Only the variants set by setLightingPermutations can be deferred, so
+  ///   without them this has no effect.
+  /// \param[in] path The shading path.
+  void
+  setShadingPath (ShadingPath path);
+
+  /// \brief Gets the shading path.
+  /// \return The value last passed to setShadingPath ().
+  ShadingPath
+  getShadingPath () const;
+
+  /// \brief Chooses whether draw () draws the Meshes that use the main (lit)
+  ///   program with glMultiDrawElementsIndirect: one call per material (per
+  ///   vertex format) instead of one per Mesh.
+  ///
+  /// Their variants are built with MULTI_DRAW_INDIRECT defined, which makes
+  ///   them read each Mesh's transformations by gl_DrawID (see
+  ///   RenderQueue).  Only the variants set by setLightingPermutations can do
+  ///   this, so without them this has no effect.
+  /// \param[in] enabled Whether or not to use multi-draws, which need OpenGL
+  ///   4.6 or ARB_multi_draw_indirect and ARB_shader_draw_parameters.
+  void
+  setMultiDrawIndirect (bool enabled);
+
+  /// \brief Tests whether or not multi-draws are being used.
+  /// \return The value last passed to setMultiDrawIndirect ().
+  bool
+  isMultiDrawIndirect () const;
+
+  /// \brief Chooses whether draw () culls the Meshes that use the main (lit)
+  ///   program on the GPU, and draws them with one
+  ///   glMultiDrawElementsIndirectCount call per material (see GpuCuller).
+  ///
+  /// Their bounds and levels of detail are only uploaded again when Meshes
+  ///   are added or removed, or the GeometryArena is defragmented, and the
+  ///   world matrices only when a transform changes, so the CPU's share of
+  ///   a frame doesn't grow with the number of Meshes.  Only frustum culling
+  ///   is done on the GPU: the occluders don't hide these Meshes, and they
+  ///   aren't sorted front to back.  Culling needs multi-draws and the
+  ///   variants set by setLightingPermutations, so without them this has no
+  ///   effect, and Meshes drawn with other programs are culled on the CPU.
+  /// \param[in] cullProgram The program built from shaders/CullDraws.comp,
+  ///   which must outlive this Scene, or nullptr to cull on the CPU.
+  void
+  setGpuCulling (ShaderProgram* cullProgram);
+
+  /// \brief Tests whether or not Meshes are being culled on the GPU.
+  /// \return Whether a program was last passed to setGpuCulling ().
+  bool
+  isGpuCulling () const;
+
+  /// \brief Gets the buffer that the multi-draws' commands and per-draw
+  ///   data are streamed through, e.g. to report its fence waits.
+  /// \return The buffer, or nullptr if multi-draws aren't being used.
+  const StreamBuffer*
+  getStreamBuffer () const;
+
+  /// \brief Sets the JobSystem that prepareFrame spreads its work over.
+  /// \param[in] jobs The JobSystem, which must outlive this Scene, or
+  ///   nullptr to do all of the work on the calling thread.
+  void
+  setJobSystem (JobSystem* jobs);
+
+  /// \brief Does the CPU work of a frame: brings the world transforms up to
+  ///   date, culls Meshes whose bounding spheres are outside the view
+  ///   frustum or hidden behind the occluders, records a DrawPacket for each of the rest into the current
+  ///   worker's RenderCommandBuffer, and merges the packets by shader
+  ///   program, then material, then front to back.  No OpenGL calls are
+  ///   made, so each of those steps can run on the JobSystem's workers.
+  /// \param[in] viewMatrix The view matrix of the camera.
+  /// \param[in] projectionMatrix The projection matrix of the camera.
+  /// \post The world transforms of every Mesh whose transform (or whose
+  ///   ancestor's transform) changed since the last frame have been
+  ///   recomputed.
+  /// \post The render queue holds a packet for every Mesh that may be
+  ///   visible, in draw order, except the Meshes culled on the GPU (see
+  ///   setGpuCulling).
+  void
+  prepareFrame (const Transform& viewMatrix, const Matrix4& projectionMatrix);
+
   /// \brief Draws all of the elements in this Scene.
   /// \param[in] viewMatrix The view matrix that should be used when drawing
   ///   the Scene.
+  /// \param[in] projectionMatrix The projection matrix of the camera.
+  /// \pre This is the thread that owns the OpenGL context.
+  /// \post The camera and light uniform blocks (and, if clustering, the
+  ///   light clusters) have been written, prepareFrame has been run, the
+  ///   material uniform block (and, if multi-drawing, the render queue's
+  ///   commands) have been written, the GPU culling pass (if on) has been
+  ///   dispatched, and the render queue has been replayed, followed by the
+  ///   GPU-culled draws (in two passes, around the lighting pass, if
+  ///   deferred).  Each pass is a scope of the context's GpuProfiler, if it
+  ///   has one.
   void
   draw (const Transform& viewMatrix, const Matrix4& projectionMatrix);
 
+  /// \brief Gets the number of Meshes the last prepareFrame kept.
+  /// \return How many Meshes survived frustum culling on the CPU; Meshes
+  ///   culled on the GPU aren't counted, since that count is never read
+  ///   back.
+  unsigned int
+  getVisibleCount () const;
+
   /// \brief Tests whether or not this Scene contains a Mesh associated with a
   ///   name.
   /// \param[in] meshName The name of the requested Mesh.
@@ -126,15 +336,113 @@ public:
     const Vector3& position, const Vector3& attenuationCoefficients, const Vector3& direction,
     float cutoffCosAngle, float falloff);
 
+  /// \brief Copies every light into the light uniform block, which every
+  ///   shader program reads.  The lights are grouped by type: directional,
+  ///   then point, then spot, and only the first MAX_LIGHTS of them go in the
+  ///   block (the clusters get all of them).  Their positions and directions
+  ///   are transformed into the eye space of the camera last passed to
+  ///   draw () (world space before the first frame).
+  /// \post The block has been uploaded, if it changed.
   void
   setUniforms ();
 
 private:
+
+  /// \brief Chooses the variant of the main program that matches the lights
+  ///   last written by setUniforms (), building it if needed.
+  /// \param[in] deferred Whether or not this frame is deferred, in which
+  ///   case Meshes get the G-buffer variant and the lighting pass gets the
+  ///   variant that matches the lights.
+  /// \pre This is the thread that owns the OpenGL context.
+  void
+  selectLitShader (bool deferred);
+
+  /// \brief Tests whether or not this frame culls on the GPU.
+  /// \return Whether GPU culling is on, and its needs are met.
+  bool
+  usesGpuCulling () const;
+
+  /// \brief Replays the render queue with deferred shading.
+  /// \pre The G-buffer is bound, and the render queue and every uniform
+  ///   block hold this frame's data.
+  /// \post The lit Meshes have been drawn into the G-buffer and lit onto
+  ///   the default framebuffer, and then the rest have been drawn forward.
+  void
+  drawDeferred ();
+
+  /// \brief Copies the camera into the camera uniform block.
+  /// \param[in] viewMatrix The view matrix of the camera.
+  /// \param[in] projectionMatrix The projection matrix of the camera.
+  /// \post The block has been uploaded, if it changed.
+  void
+  setCameraUniforms (const Transform& viewMatrix, const Matrix4& projectionMatrix);
+
+  /// The transforms of every Mesh in s_meshes.
+  TransformHierarchy s_hierarchy;
   std::map<std::string, Mesh*> s_meshes;
   std::map<std::string, Mesh*>::iterator s_activeMesh;
   std::vector<LightSource*> s_lightSource;
   ShaderProgram* s_shader;
+  /// The variants of s_shader, or nullptr.
+  ShaderPermutations* s_permutations;
+  /// The program that Meshes using s_shader are drawn with this frame.
+  ShaderProgram* s_litShader;
+  /// The deferred lighting pass's program this frame, or nullptr.
+  ShaderProgram* s_deferredLightingShader;
+  /// The number of lights of each LightType in the light block.
+  unsigned int s_lightCounts[3];
   Camera* s_camera;
+  /// The context that draw () makes OpenGL calls through.
+  OpenGLContext* s_context;
+  /// The workers that prepareFrame uses, or nullptr.
+  JobSystem* s_jobs;
+  /// Every Mesh, in a form that can be split among jobs.
+  std::vector<Mesh*> s_drawList;
+  /// The draw calls recorded by prepareFrame, one buffer per worker.
+  RenderQueue s_renderQueue;
+  /// The Meshes that are drawn into s_occlusion.
+  std::set<Mesh*> s_occluders;
+  /// The software depth buffer that occluded Meshes are tested against.
+  OcclusionBuffer s_occlusion;
+  /// Every Material drawn so far, whose indexes also go in sort keys.
+  MaterialTable s_materials;
+  /// The CPU copy of the camera uniform block.
+  CameraBlock s_cameraData;
+  /// The camera uniform block, at CAMERA_BLOCK_BINDING.
+  UniformBuffer s_cameraBuffer;
+  /// The CPU copy of the light uniform block.
+  LightBlock s_lightData;
+  /// The light uniform block, at LIGHT_BLOCK_BINDING.
+  UniformBuffer s_lightBuffer;
+  /// The view matrix of the camera, which lights are transformed by.
+  Matrix4 s_view;
+  /// Every light in eye space, grouped by type.
+  std::vector<LightBlockEntry> s_lightEntries;
+  /// Whether or not point and spot lights are clustered.
+  bool s_clustered;
+  /// The clusters that point and spot lights are culled into.
+  LightClusters s_clusters;
+  /// How Meshes drawn with s_shader are lit.
+  ShadingPath s_shadingPath;
+  /// The G-buffer that deferred shading draws into.
+  GBuffer s_gBuffer;
+  /// The buffers that every Mesh added before it was prepared draws from.
+  GeometryArena s_arena;
+  /// Whether or not the lit variants are drawn with multi-draws.
+  bool s_multiDraw;
+  /// The culler of Meshes drawn with s_shader, or nullptr.
+  GpuCuller* s_gpuCuller;
+  /// The Meshes that s_gpuCuller culls.
+  std::vector<Mesh*> s_gpuDrawList;
+  /// Whether or not s_drawList and s_gpuDrawList must be rebuilt before
+  ///   culling on the GPU (they are rebuilt every frame otherwise).
+  bool s_drawListDirty;
+  /// Whether or not s_gpuDrawList has changed since it was uploaded.
+  bool s_gpuObjectsStale;
+  /// Whether or not a world matrix has changed since they were uploaded.
+  bool s_gpuWorldsStale;
+  /// The arena's defragment count when s_gpuDrawList was built.
+  unsigned int s_arenaDefragments;
 };
 
 #endif//SCENE_HPP
@@ -0,0 +1,42 @@
+/// \file ShaderPermutations.cpp
+/// \brief Definition of ShaderPermutations class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include "ShaderPermutations.hpp"
+
+ShaderPermutations::ShaderPermutations (OpenGLContext* context,
+                                        const std::string& vertexShaderFilename,
+                                        const std::string& fragmentShaderFilename,
+                                        ProgramBinaryCache* cache)
+  : m_context (context), m_vertexShaderFilename (vertexShaderFilename),
+    m_fragmentShaderFilename (fragmentShaderFilename), m_cache (cache),
+    m_variants ()
+{
+}
+
+ShaderPermutations::~ShaderPermutations ()
+{
+  for (auto& variant : m_variants)
+    delete variant.second;
+}
+
+ShaderProgram*
+ShaderPermutations::get (const std::string& defines)
+{
+  auto found = m_variants.find (defines);
+  if (found != m_variants.end ())
+    return found->second;
+  ShaderProgram* variant = new ShaderProgram (m_context);
+  variant->build (m_vertexShaderFilename, m_fragmentShaderFilename, m_cache,
+                  defines);
+  m_variants[defines] = variant;
+  return variant;
+}
+
+unsigned int
+ShaderPermutations::getCount () const
+{
+  return m_variants.size ();
+}
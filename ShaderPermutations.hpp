@@ -0,0 +1,78 @@
+/// \file ShaderPermutations.hpp
+/// \brief Declaration of ShaderPermutations class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef SHADER_PERMUTATIONS_HPP
+#define SHADER_PERMUTATIONS_HPP
+
+#include <map>
+#include <string>
+
+#include "OpenGLContext.hpp"
+#include "ProgramBinaryCache.hpp"
+#include "ShaderProgram.hpp"
+
+/// \brief The specialized variants of one pair of shader files, each built
+///   with a different set of "#define"s the first time it is asked for.
+///
+/// A shader can test the defines with #if to replace uniform-driven loops
+///   and branches with constants, so the compiler can unroll and strip them.
+///   Variants are kept by their exact define lines, and each one is also
+///   stored in the binary cache under its final sources.
+class ShaderPermutations
+{
+public:
+
+  /// \brief Constructs a ShaderPermutations with no variants built yet.
+  /// \param[in] context The context to make OpenGL calls through.
+  /// \param[in] vertexShaderFilename The vertex shader every variant uses.
+  /// \param[in] fragmentShaderFilename The fragment shader every variant
+  ///   uses.
+  /// \param[in] cache The cache to load variants from and store them into,
+  ///   or nullptr.  It must outlive this object.
+  ShaderPermutations (OpenGLContext* context,
+                      const std::string& vertexShaderFilename,
+                      const std::string& fragmentShaderFilename,
+                      ProgramBinaryCache* cache = nullptr);
+
+  /// \brief Destructs a ShaderPermutations, deleting every variant.
+  ~ShaderPermutations ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   ShaderPermutations.
+  ShaderPermutations (const ShaderPermutations&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   ShaderPermutations.
+  ShaderPermutations&
+  operator= (const ShaderPermutations&) = delete;
+
+  /// \brief Gets a variant, building it first if this is the first request.
+  /// \param[in] defines The "#define" lines that select the variant.
+  /// \return The linked variant, owned by this object.
+  /// \pre This is the thread that owns the OpenGL context.
+  ShaderProgram*
+  get (const std::string& defines);
+
+  /// \brief Gets the number of variants built so far.
+  /// \return How many distinct define sets have been requested.
+  unsigned int
+  getCount () const;
+
+private:
+
+  /// The context to make OpenGL calls through.
+  OpenGLContext* m_context;
+  /// The vertex shader every variant uses.
+  std::string m_vertexShaderFilename;
+  /// The fragment shader every variant uses.
+  std::string m_fragmentShaderFilename;
+  /// The cache variants are loaded from and stored into, or nullptr.
+  ProgramBinaryCache* m_cache;
+  /// The variants built so far, by their define lines.
+  std::map<std::string, ShaderProgram*> m_variants;
+};
+
+#endif//SHADER_PERMUTATIONS_HPP
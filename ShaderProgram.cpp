@@ -4,18 +4,27 @@
 /// \author Gary M. Zoppetti, Ph.D. & Chad Hogg
 /// \version A02
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 
 #include <glm/gtc/type_ptr.hpp>
 
 #include "ShaderProgram.hpp"
+#include "UniformBuffer.hpp"
+#include "LightClusters.hpp"
+#include "GBuffer.hpp"
+
+bool ShaderProgram::s_parallelCompile = false;
 
 ShaderProgram::ShaderProgram (OpenGLContext* context)
-  : m_context (context), m_programId (m_context->createProgram ()), m_vertexShaderId (0), m_fragmentShaderId (0)
+  : m_context (context), m_programId (m_context->createProgram ()), m_vertexShaderId (0), m_fragmentShaderId (0),
+    m_buildState (NOT_BUILDING), m_cache (nullptr), m_cacheKey (0),
+    m_uploadCounts { 0, 0 }
 {
 }
 
@@ -37,70 +46,263 @@ ShaderProgram::getAttributeLocation (const std::string& attributeName) const
 GLint
 ShaderProgram::getUniformLocation (const std::string& uniformName) const
 {
-  return m_context->getUniformLocation (m_programId, uniformName.c_str ());
+  return getUniformHandle (uniformName).location;
+}
+
+UniformHandle
+ShaderProgram::getUniformHandle (const std::string& uniformName) const
+{
+  auto entry = std::lower_bound (m_uniforms.begin (), m_uniforms.end (), uniformName,
+                                 [] (const UniformInfo& info, const std::string& name)
+                                 { return info.name < name; });
+  if (entry == m_uniforms.end () || entry->name != uniformName)
+    return UniformHandle { -1, 0, 0 };
+  return entry->handle;
+}
+
+unsigned int
+ShaderProgram::getUniformCount () const
+{
+  return m_uniforms.size ();
+}
+
+bool
+ShaderProgram::bindUniformBlock (const std::string& blockName, GLuint binding)
+{
+  GLuint index = m_context->getUniformBlockIndex (m_programId, blockName.c_str ());
+  if (index == GL_INVALID_INDEX)
+    return false;
+  m_context->uniformBlockBinding (m_programId, index, binding);
+  return true;
+}
+
+UniformUploadCounts
+ShaderProgram::getUploadCounts () const
+{
+  return m_uploadCounts;
+}
+
+void
+ShaderProgram::resetUploadCounts ()
+{
+  m_uploadCounts = UniformUploadCounts { 0, 0 };
 }
 
 void
 ShaderProgram::setUniformInt (const std::string& uniform, const int& value)
 {
-  GLint location = getUniformLocation (uniform);
-  glUniform1i (location, value);
+  setUniformInt (getUniformHandle (uniform), value);
+}
+
+void
+ShaderProgram::setUniformInt (const UniformHandle& uniform, int value)
+{
+  if (updateShadow (uniform, &value, sizeof (value)))
+    m_context->uniform1i (uniform.location, value);
 }
 
 void
 ShaderProgram::setUniformFloat (const std::string& uniform, const float& value)
 {
-  GLint location = getUniformLocation (uniform);
-  glUniform1f (location, value);
+  setUniformFloat (getUniformHandle (uniform), value);
+}
+
+void
+ShaderProgram::setUniformFloat (const UniformHandle& uniform, float value)
+{
+  if (updateShadow (uniform, &value, sizeof (value)))
+    m_context->uniform1f (uniform.location, value);
 }
 
 void
 ShaderProgram::setUniformVector (const std::string& uniform, const Vector3& value)
 {
-  GLint location = getUniformLocation (uniform);
-  glUniform3f (location, value.m_x, value.m_y, value.m_z);
+  setUniformVector (getUniformHandle (uniform), value);
+}
+
+void
+ShaderProgram::setUniformVector (const UniformHandle& uniform, const Vector3& value)
+{
+  const float components[3] = { value.m_x, value.m_y, value.m_z };
+  if (updateShadow (uniform, components, sizeof (components)))
+    m_context->uniform3f (uniform.location, value.m_x, value.m_y, value.m_z);
 }
 
 void
 ShaderProgram::setUniformMatrix (const std::string& uniform, const Matrix4& value)
 {
-  GLint location = getUniformLocation (uniform);
-  m_context->uniformMatrix4fv (location, 1, GL_FALSE, value.data ());
+  setUniformMatrix (getUniformHandle (uniform), value);
+}
+
+void
+ShaderProgram::setUniformMatrix (const UniformHandle& uniform, const Matrix4& value)
+{
+  if (updateShadow (uniform, value.data (), 16 * sizeof (float)))
+    m_context->uniformMatrix4fv (uniform.location, 1, GL_FALSE, value.data ());
+}
+
+void
+ShaderProgram::setUniformMatrix (const std::string& uniform, const Matrix3& value)
+{
+  setUniformMatrix (getUniformHandle (uniform), value);
+}
+
+void
+ShaderProgram::setUniformMatrix (const UniformHandle& uniform, const Matrix3& value)
+{
+  if (updateShadow (uniform, value.data (), 9 * sizeof (float)))
+    m_context->uniformMatrix3fv (uniform.location, 1, GL_FALSE, value.data ());
 }
 
 void
 ShaderProgram::createVertexShader (const std::string& vertexShaderFilename)
 {
-  m_vertexShaderId = m_context->createShader (GL_VERTEX_SHADER);
-  if (m_vertexShaderId == 0)
-  {
-    fprintf (stderr, "Failed to create vertex shader object; exiting\n");
-    exit (-1);
-  }
-  compileShader (vertexShaderFilename, m_vertexShaderId);
+  m_vertexShaderId = createShader (GL_VERTEX_SHADER,
+                                   readShaderSource (vertexShaderFilename));
+  checkShader (m_vertexShaderId, vertexShaderFilename);
 }
 
 void
 ShaderProgram::createFragmentShader (const std::string& fragmentShaderFilename)
 {
-  m_fragmentShaderId = m_context->createShader (GL_FRAGMENT_SHADER);
-  if (m_fragmentShaderId == 0)
+  m_fragmentShaderId = createShader (GL_FRAGMENT_SHADER,
+                                     readShaderSource (fragmentShaderFilename));
+  checkShader (m_fragmentShaderId, fragmentShaderFilename);
+}
+
+void
+ShaderProgram::build (const std::string& vertexShaderFilename,
+                      const std::string& fragmentShaderFilename,
+                      ProgramBinaryCache* cache, const std::string& defines)
+{
+  submit (vertexShaderFilename, fragmentShaderFilename, cache, defines);
+  finish ();
+}
+
+void
+ShaderProgram::buildCompute (const std::string& computeShaderFilename,
+                             const std::string& defines)
+{
+  // The one shader takes the vertex shader's place, so it is deleted along
+  //   with this program.
+  m_vertexShaderFilename = computeShaderFilename;
+  m_defines = defines;
+  m_vertexShaderId = createShader (GL_COMPUTE_SHADER,
+                                   injectDefines (readShaderSource (computeShaderFilename)));
+  m_context->linkProgram (m_programId);
+  checkShader (m_vertexShaderId, computeShaderFilename);
+  checkLink ();
+  m_context->detachShader (m_programId, m_vertexShaderId);
+  finishLink ();
+  m_buildState = LINKED;
+}
+
+void
+ShaderProgram::submit (const std::string& vertexShaderFilename,
+                       const std::string& fragmentShaderFilename,
+                       ProgramBinaryCache* cache, const std::string& defines)
+{
+  m_vertexShaderFilename = vertexShaderFilename;
+  m_fragmentShaderFilename = fragmentShaderFilename;
+  m_defines = defines;
+  m_cache = cache;
+  std::string vertexSource = injectDefines (readShaderSource (vertexShaderFilename));
+  std::string fragmentSource = injectDefines (readShaderSource (fragmentShaderFilename));
+  if (m_cache != nullptr)
   {
-    fprintf (stderr, "Failed to create fragment shader object; exiting\n");
-    exit (-1);
+    m_cacheKey = m_cache->makeKey (vertexSource, fragmentSource);
+    if (m_cache->load (m_programId, m_cacheKey))
+    {
+      finishLink ();
+      m_buildState = LINKED;
+      return;
+    }
+    m_cache->prepare (m_programId);
   }
-  compileShader (fragmentShaderFilename, m_fragmentShaderId);
+  // Issue everything without querying any status, so the driver is free to
+  //   keep compiling while we move on.
+  m_vertexShaderId = createShader (GL_VERTEX_SHADER, vertexSource);
+  m_fragmentShaderId = createShader (GL_FRAGMENT_SHADER, fragmentSource);
+  m_context->linkProgram (m_programId);
+  m_buildState = COMPILING;
+}
+
+void
+ShaderProgram::defer (const std::string& vertexShaderFilename,
+                      const std::string& fragmentShaderFilename,
+                      ProgramBinaryCache* cache, const std::string& defines)
+{
+  m_vertexShaderFilename = vertexShaderFilename;
+  m_fragmentShaderFilename = fragmentShaderFilename;
+  m_defines = defines;
+  m_cache = cache;
+  m_buildState = DEFERRED;
+}
+
+bool
+ShaderProgram::isReady () const
+{
+  if (m_buildState != COMPILING || !s_parallelCompile)
+    return true;
+  GLint isComplete = GL_TRUE;
+  m_context->getProgramiv (m_programId, GL_COMPLETION_STATUS_KHR, &isComplete);
+  return isComplete != GL_FALSE;
 }
 
 void
-ShaderProgram::compileShader (const std::string& shaderFilename,
-			      GLuint shaderId)
+ShaderProgram::finish ()
 {
-  std::string sourceCode = readShaderSource (shaderFilename);
-  const GLchar* sourceCodePtr = sourceCode.c_str ();
+  if (m_buildState == DEFERRED)
+    submit (m_vertexShaderFilename, m_fragmentShaderFilename, m_cache, m_defines);
+  if (m_buildState != COMPILING)
+    return;
+  // The first query blocks until the driver is done with that object.
+  checkShader (m_vertexShaderId, m_vertexShaderFilename);
+  checkShader (m_fragmentShaderId, m_fragmentShaderFilename);
+  checkLink ();
+  m_context->detachShader (m_programId, m_vertexShaderId);
+  m_context->detachShader (m_programId, m_fragmentShaderId);
+  finishLink ();
+  m_buildState = LINKED;
+  if (m_cache != nullptr)
+    m_cache->store (m_programId, m_cacheKey);
+}
+
+bool
+ShaderProgram::isLinked () const
+{
+  return m_buildState == LINKED;
+}
+
+void
+ShaderProgram::setParallelCompile (bool enabled)
+{
+  s_parallelCompile = enabled;
+}
+
+GLuint
+ShaderProgram::createShader (GLenum shaderType, const std::string& source)
+{
+  GLuint shaderId = m_context->createShader (shaderType);
+  if (shaderId == 0)
+  {
+    fprintf (stderr, "Failed to create %s shader object; exiting\n",
+             shaderType == GL_VERTEX_SHADER ? "vertex"
+             : shaderType == GL_FRAGMENT_SHADER ? "fragment" : "compute");
+    exit (-1);
+  }
+  const GLchar* sourceCodePtr = source.c_str ();
   // One array of char*. Do not need to specify length if null-terminated.
   m_context->shaderSource (shaderId, 1, &sourceCodePtr, nullptr);
   m_context->compileShader (shaderId);
+  m_context->attachShader (m_programId, shaderId);
+  return shaderId;
+}
+
+void
+ShaderProgram::checkShader (GLuint shaderId,
+                            const std::string& shaderFilename) const
+{
   GLint isCompiled;
   m_context->getShaderiv (shaderId, GL_COMPILE_STATUS, &isCompiled);
   if (isCompiled == GL_FALSE)
@@ -111,14 +313,11 @@ ShaderProgram::compileShader (const std::string& shaderFilename,
 	     shaderFilename.c_str ());
     exit (-1);
   }
-  m_context->attachShader (m_programId, shaderId);
 }
 
 void
-ShaderProgram::link () const
+ShaderProgram::checkLink () const
 {
-  fprintf (stdout, "Linking shader program %d\n", m_programId);
-  m_context->linkProgram (m_programId);
   GLint isLinked;
   m_context->getProgramiv (m_programId, GL_LINK_STATUS, &isLinked);
   if (isLinked == GL_FALSE)
@@ -127,18 +326,176 @@ ShaderProgram::link () const
     fprintf (stderr, "Link error -- see log\n");
     exit (-1);
   }
+}
+
+void
+ShaderProgram::link ()
+{
+  fprintf (stdout, "Linking shader program %d\n", m_programId);
+  m_context->linkProgram (m_programId);
+  checkLink ();
   // After linking, the shader objects no longer need to be attached.
   // A shader won't be deleted until it is detached.
   m_context->detachShader (m_programId, m_vertexShaderId);
   m_context->detachShader (m_programId, m_fragmentShaderId);
+  finishLink ();
+  m_buildState = LINKED;
+}
+
+void
+ShaderProgram::finishLink ()
+{
+  introspectUniforms ();
+  bindUniformBlock ("CameraBlock", CAMERA_BLOCK_BINDING);
+  bindUniformBlock ("LightBlock", LIGHT_BLOCK_BINDING);
+  bindUniformBlock ("MaterialBlock", MATERIAL_BLOCK_BINDING);
+  bindUniformBlock ("ClusterBlock", CLUSTER_BLOCK_BINDING);
+  bindSampler ("uClusterGrid", CLUSTER_GRID_UNIT);
+  bindSampler ("uClusterLightIndices", CLUSTER_INDEX_UNIT);
+  bindSampler ("uClusterLights", CLUSTER_LIGHT_UNIT);
+  bindSampler ("uGBufferColor", GBUFFER_COLOR_UNIT);
+  bindSampler ("uGBufferNormal", GBUFFER_NORMAL_UNIT);
+  bindSampler ("uGBufferDepth", GBUFFER_DEPTH_UNIT);
+}
+
+void
+ShaderProgram::bindSampler (const std::string& samplerName, GLint unit)
+{
+  UniformHandle sampler = getUniformHandle (samplerName);
+  if (sampler.location == -1)
+    return;
+  // Samplers keep their unit for the life of the program, so this is the
+  //   only time it needs to be enabled for them.  enable () would try to
+  //   finish the build that is finishing now.
+  m_context->useProgram (m_programId);
+  setUniformInt (sampler, unit);
+  m_context->useProgram (0);
+}
+
+void
+ShaderProgram::introspectUniforms ()
+{
+  m_uniforms.clear ();
+  m_shadowSlots.clear ();
+  m_shadow.clear ();
+  m_uploadCounts = UniformUploadCounts { 0, 0 };
+  GLint count = 0;
+  GLint maxLength = 0;
+  m_context->getProgramiv (m_programId, GL_ACTIVE_UNIFORMS, &count);
+  m_context->getProgramiv (m_programId, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+  std::unique_ptr<char[]> buffer (new char[maxLength + 1]);
+  for (GLint i = 0; i < count; ++i)
+  {
+    GLsizei length = 0;
+    GLint size = 0;
+    GLenum type = 0;
+    m_context->getActiveUniform (m_programId, i, maxLength + 1, &length, &size,
+                                 &type, buffer.get ());
+    std::string name (buffer.get (), length);
+    // Arrays of basic types are reported once, as "name[0]", with their
+    //   length; give each element its own entry, plus one for the bare name.
+    bool isArray = name.size () > 3 && name.compare (name.size () - 3, 3, "[0]") == 0;
+    if (!isArray && size <= 1)
+    {
+      GLint location = m_context->getUniformLocation (m_programId, name.c_str ());
+      // Members of uniform blocks have no location, and are set another way.
+      if (location != -1)
+        m_uniforms.push_back (UniformInfo { name, addShadowSlot (location, type) });
+      continue;
+    }
+    std::string base = isArray ? name.substr (0, name.size () - 3) : name;
+    for (GLint element = 0; element < size; ++element)
+    {
+      std::string elementName = base + "[" + std::to_string (element) + "]";
+      GLint location = m_context->getUniformLocation (m_programId, elementName.c_str ());
+      if (location == -1)
+        continue;
+      UniformHandle handle = addShadowSlot (location, type);
+      m_uniforms.push_back (UniformInfo { elementName, handle });
+      if (element == 0)
+        m_uniforms.push_back (UniformInfo { base, handle });
+    }
+  }
+  std::sort (m_uniforms.begin (), m_uniforms.end (),
+             [] (const UniformInfo& a, const UniformInfo& b)
+             { return a.name < b.name; });
+}
+
+UniformHandle
+ShaderProgram::addShadowSlot (GLint location, GLenum type)
+{
+  unsigned int size;
+  switch (type)
+  {
+  case GL_FLOAT_VEC2:
+  case GL_INT_VEC2:
+    size = 2 * sizeof (GLfloat);
+    break;
+  case GL_FLOAT_VEC3:
+  case GL_INT_VEC3:
+    size = 3 * sizeof (GLfloat);
+    break;
+  case GL_FLOAT_VEC4:
+  case GL_INT_VEC4:
+    size = 4 * sizeof (GLfloat);
+    break;
+  case GL_FLOAT_MAT3:
+    size = 9 * sizeof (GLfloat);
+    break;
+  case GL_FLOAT_MAT4:
+    size = 16 * sizeof (GLfloat);
+    break;
+  default:
+    // Scalars, bools, and samplers.
+    size = sizeof (GLfloat);
+    break;
+  }
+  m_shadowSlots.push_back (ShadowSlot { static_cast<unsigned int> (m_shadow.size ()), size, false });
+  m_shadow.resize (m_shadow.size () + size);
+  return UniformHandle { location, type, static_cast<unsigned int> (m_shadowSlots.size () - 1) };
+}
+
+bool
+ShaderProgram::updateShadow (const UniformHandle& uniform, const void* value,
+                             unsigned int size)
+{
+  if (uniform.location == -1)
+    return false;
+  ShadowSlot& slot = m_shadowSlots[uniform.slot];
+  // A value of the wrong size is a client error that OpenGL will report, so
+  //   just pass it on and forget what we had.
+  if (size != slot.size)
+  {
+    slot.valid = false;
+    ++m_uploadCounts.issued;
+    return true;
+  }
+  unsigned char* copy = &m_shadow[slot.offset];
+  if (slot.valid && std::memcmp (copy, value, size) == 0)
+  {
+    ++m_uploadCounts.skipped;
+    return false;
+  }
+  std::memcpy (copy, value, size);
+  slot.valid = true;
+  ++m_uploadCounts.issued;
+  return true;
 }
 
 void
 ShaderProgram::enable ()
 {
+  if (m_buildState == DEFERRED || m_buildState == COMPILING)
+    finish ();
   m_context->useProgram (m_programId);
 }
 
+GLuint
+ShaderProgram::getId () const
+{
+  return m_programId;
+}
+
 void
 ShaderProgram::disable ()
 {
@@ -160,6 +517,22 @@ ShaderProgram::readShaderSource (const std::string& filename) const
   return fileString;
 }
 
+std::string
+ShaderProgram::injectDefines (const std::string& source) const
+{
+  if (m_defines.empty ())
+    return source;
+  std::size_t start = 0;
+  if (source.compare (0, 8, "#version") == 0)
+  {
+    start = source.find ('\n');
+    start = (start == std::string::npos) ? source.size () : start + 1;
+  }
+  // Reset the line number so compile logs still match the file.
+  std::string line = "#line " + std::to_string (start == 0 ? 1 : 2) + "\n";
+  return source.substr (0, start) + m_defines + line + source.substr (start);
+}
+
 void
 ShaderProgram::writeInfoLog (GLuint shaderId, bool isShader,
 			     const std::string& logFilename) const
@@ -8,14 +8,53 @@
 #define SHADER_PROGRAM_HPP
 
 #include <string>
+#include <vector>
 
 #include <glm/mat4x4.hpp>
 
 #include "OpenGLContext.hpp"
+#include "ProgramBinaryCache.hpp"
 #include "Vector3.hpp"
+#include "Matrix3.hpp"
 #include "Matrix4.hpp"
 
+/// \brief A uniform variable of a linked ShaderProgram, looked up once so
+///   that setting it later needs no string handling or OpenGL query.
+struct UniformHandle
+{
+  /// The uniform's location, or -1 if the program has no such active
+  ///   uniform (in which case setting it does nothing).
+  GLint location;
+  /// The uniform's OpenGL type (e.g., GL_FLOAT_VEC3), or 0 if inactive.
+  GLenum type;
+  /// The index of the program's copy of the uniform's last value.
+  unsigned int slot;
+};
+
+/// \brief How many uniform uploads a ShaderProgram has sent to OpenGL and
+///   how many it skipped because the value had not changed.
+struct UniformUploadCounts
+{
+  /// The number of glUniform* calls made.
+  unsigned long issued;
+  /// The number of glUniform* calls avoided.
+  unsigned long skipped;
+};
+
 /// \brief A class that simplifies creation of and access to shaders.
+///
+/// When a ShaderProgram is linked it asks OpenGL for all of its active
+///   uniforms once and keeps them in a table sorted by name.  Clients that set
+///   a uniform often should get a UniformHandle for it after linking and set
+///   it through that; the name-based setters still work, but look the name up
+///   in the table each time.
+///
+/// Each active uniform also has a shadow copy of the last value sent to it,
+///   and setting a uniform to the value it already holds makes no OpenGL
+///   call.  This relies on every upload going through this ShaderProgram.
+///
+/// Data shared by every program, such as the camera and the lights, lives in
+///   uniform blocks instead (see UniformBuffer).
 class ShaderProgram
 {
 public:
@@ -48,29 +87,114 @@ public:
 
   /// \brief Gets the OpenGL location of the uniform with a certain name.
   /// \param[in] uniformName The name of the requested uniform.
-  /// \return The location of that uniform.
-  /// \pre This ShaderProgram is enabled.
-  /// \pre An attached shader has declared the uniform variable.
+  /// \return The location of that uniform, or -1 if it is not active.
+  /// \pre This ShaderProgram has been linked.
   GLint
   getUniformLocation (const std::string& uniformName) const;
 
+  /// \brief Looks up a uniform in the table built by link ().
+  /// \param[in] uniformName The name of the uniform.  Elements of arrays may
+  ///   be named with or without a subscript (e.g., "uLights[2].type" or
+  ///   "uValues" for "uValues[0]").
+  /// \return A handle for that uniform, whose location is -1 if it is not
+  ///   active.
+  /// \pre This ShaderProgram has been linked.
+  UniformHandle
+  getUniformHandle (const std::string& uniformName) const;
+
+  /// \brief Gets the number of active uniforms, counting each array element.
+  /// \return The size of the table built by link ().
+  unsigned int
+  getUniformCount () const;
+
+  /// \brief Attaches one of this program's uniform blocks to a binding point,
+  ///   so that it reads from the UniformBuffer bound there.
+  /// \param[in] blockName The name of the block.
+  /// \param[in] binding The binding point.
+  /// \return Whether or not the program has an active block by that name.
+  /// \pre This ShaderProgram has been linked.
+  bool
+  bindUniformBlock (const std::string& blockName, GLuint binding);
+
+  /// \brief Gets the number of uniform uploads issued and skipped.
+  /// \return The counts since linking or the last resetUploadCounts ().
+  UniformUploadCounts
+  getUploadCounts () const;
+
+  /// \brief Sets both upload counts back to zero, e.g., once per frame.
+  void
+  resetUploadCounts ();
+
+  /// \brief Sets the value of a uniform int (or bool or sampler).
+  /// \param[in] uniform The name of the uniform.
+  /// \param[in] value The value to use.
+  /// \pre This ShaderProgram is enabled.
   void
   setUniformInt (const std::string& uniform, const int& value);
 
+  /// \brief Sets the value of a uniform int (or bool or sampler).
+  /// \param[in] uniform A handle from getUniformHandle ().
+  /// \param[in] value The value to use.
+  /// \pre This ShaderProgram is enabled.
+  void
+  setUniformInt (const UniformHandle& uniform, int value);
+
+  /// \brief Sets the value of a uniform float.
+  /// \param[in] uniform The name of the uniform.
+  /// \param[in] value The value to use.
+  /// \pre This ShaderProgram is enabled.
   void
   setUniformFloat (const std::string& uniform, const float& value);
 
+  /// \brief Sets the value of a uniform float.
+  /// \param[in] uniform A handle from getUniformHandle ().
+  /// \param[in] value The value to use.
+  /// \pre This ShaderProgram is enabled.
+  void
+  setUniformFloat (const UniformHandle& uniform, float value);
+
+  /// \brief Sets the value of a uniform vector of 3 floats.
+  /// \param[in] uniform The name of the uniform.
+  /// \param[in] value The vector to use.
+  /// \pre This ShaderProgram is enabled.
   void
   setUniformVector (const std::string& uniform, const Vector3& value);
 
+  /// \brief Sets the value of a uniform vector of 3 floats.
+  /// \param[in] uniform A handle from getUniformHandle ().
+  /// \param[in] value The vector to use.
+  /// \pre This ShaderProgram is enabled.
+  void
+  setUniformVector (const UniformHandle& uniform, const Vector3& value);
+
   /// \brief Sets the value of a uniform 4x4 matrix of floats.
   /// \param[in] uniform The name of the uniform.
   /// \param[in] value The matrix to use.
   /// \pre This ShaderProgram is enabled.
-  /// \pre An attached shader has declared the uniform variable.
   void
   setUniformMatrix (const std::string& uniform, const Matrix4& value);
 
+  /// \brief Sets the value of a uniform 4x4 matrix of floats.
+  /// \param[in] uniform A handle from getUniformHandle ().
+  /// \param[in] value The matrix to use.
+  /// \pre This ShaderProgram is enabled.
+  void
+  setUniformMatrix (const UniformHandle& uniform, const Matrix4& value);
+
+  /// \brief Sets the value of a uniform 3x3 matrix of floats.
+  /// \param[in] uniform The name of the uniform.
+  /// \param[in] value The matrix to use.
+  /// \pre This ShaderProgram is enabled.
+  void
+  setUniformMatrix (const std::string& uniform, const Matrix3& value);
+
+  /// \brief Sets the value of a uniform 3x3 matrix of floats.
+  /// \param[in] uniform A handle from getUniformHandle ().
+  /// \param[in] value The matrix to use.
+  /// \pre This ShaderProgram is enabled.
+  void
+  setUniformMatrix (const UniformHandle& uniform, const Matrix3& value);
+
   /// \brief Creates and attaches a vertex shader.
   /// \param[in] vertexShaderFilename The name of a file that contains the
   ///   vertex shader's source code.
@@ -85,17 +209,130 @@ public:
   void
   createFragmentShader (const std::string& fragmentShaderFilename);
 
+  /// \brief Creates, compiles, and links both shaders, or loads the linked
+  ///   program from a binary cache instead, and waits for the result.
+  /// \param[in] vertexShaderFilename The name of a file that contains the
+  ///   vertex shader's source code.
+  /// \param[in] fragmentShaderFilename The name of a file that contains the
+  ///   fragment shader's source code.
+  /// \param[in] cache The cache to load from and store into, or nullptr to
+  ///   always compile.
+  /// \param[in] defines "#define" lines to insert after the "#version" line
+  ///   of both shaders, to build a specialized variant (see
+  ///   ShaderPermutations).
+  /// \pre No shaders were previously created, and this ShaderProgram had not
+  ///   already been linked.
+  /// \post This ShaderProgram is linked, as by link ().
+  void
+  build (const std::string& vertexShaderFilename,
+         const std::string& fragmentShaderFilename,
+         ProgramBinaryCache* cache = nullptr,
+         const std::string& defines = "");
+
+  /// \brief Creates, compiles, and links a compute shader as this
+  ///   ShaderProgram's only stage, and waits for the result.  Compute
+  ///   programs are few and small, so they are never cached.
+  /// \param[in] computeShaderFilename The name of a file that contains the
+  ///   compute shader's source code.
+  /// \param[in] defines "#define" lines to insert after the "#version" line.
+  /// \pre No shaders were previously created, and this ShaderProgram had not
+  ///   already been linked.
+  /// \post This ShaderProgram is linked, as by link ().  If it failed to
+  ///   compile or link, a log has been written and the program has exited.
+  void
+  buildCompute (const std::string& computeShaderFilename,
+                const std::string& defines = "");
+
+  /// \brief Starts building this ShaderProgram like build (), but returns as
+  ///   soon as the compile and link commands have been issued, without
+  ///   asking OpenGL whether they worked.
+  ///
+  /// Submitting every program before finishing any of them lets a driver
+  ///   with GL_KHR_parallel_shader_compile (see setParallelCompile) compile
+  ///   them all at once on its own threads, and lets other drivers at least
+  ///   overlap compiling with whatever the caller does next.
+  /// \param[in] vertexShaderFilename The name of a file that contains the
+  ///   vertex shader's source code.
+  /// \param[in] fragmentShaderFilename The name of a file that contains the
+  ///   fragment shader's source code.
+  /// \param[in] cache The cache to load from and store into, or nullptr.
+  ///   It must outlive the call to finish ().
+  /// \param[in] defines "#define" lines to insert into both shaders.
+  /// \pre No shaders were previously created, and this ShaderProgram had not
+  ///   already been linked.
+  /// \post finish () will complete the build.
+  void
+  submit (const std::string& vertexShaderFilename,
+          const std::string& fragmentShaderFilename,
+          ProgramBinaryCache* cache = nullptr,
+          const std::string& defines = "");
+
+  /// \brief Prepares to build this ShaderProgram like build (), but not until
+  ///   it is first enabled (or finish () is called), for programs that may
+  ///   never be used.
+  /// \param[in] vertexShaderFilename The name of a file that contains the
+  ///   vertex shader's source code.
+  /// \param[in] fragmentShaderFilename The name of a file that contains the
+  ///   fragment shader's source code.
+  /// \param[in] cache The cache to load from and store into, or nullptr.
+  ///   It must outlive the build.
+  /// \param[in] defines "#define" lines to insert into both shaders.
+  /// \pre No shaders were previously created, and this ShaderProgram had not
+  ///   already been linked.
+  void
+  defer (const std::string& vertexShaderFilename,
+         const std::string& fragmentShaderFilename,
+         ProgramBinaryCache* cache = nullptr,
+         const std::string& defines = "");
+
+  /// \brief Tests whether or not finish () can complete without waiting for
+  ///   the driver.
+  /// \return False only if a submitted build is known to still be compiling,
+  ///   which can only be known with GL_KHR_parallel_shader_compile.
+  bool
+  isReady () const;
+
+  /// \brief Completes a submitted or deferred build: checks that both shaders
+  ///   compiled and the program linked, and stores it in the cache.
+  /// \post This ShaderProgram is linked, as by link ().  If it failed to
+  ///   compile or link, a log has been written and the program has exited.
+  void
+  finish ();
+
+  /// \brief Tests whether or not this ShaderProgram has been linked.
+  /// \return Whether or not link () or finish () has completed.
+  bool
+  isLinked () const;
+
+  /// \brief Records whether or not the driver compiles shaders on its own
+  ///   threads (GL_KHR_parallel_shader_compile), so that isReady () can ask
+  ///   it for progress.
+  /// \param[in] enabled Whether or not the extension is supported and its
+  ///   thread count has been set.
+  static void
+  setParallelCompile (bool enabled);
+
   /// \brief Links the attached shaders into this ShaderProgram.
   /// \pre A vertex and fragment shader had been created.
   /// \pre This ShaderProgram had not already been linked.
+  /// \post The table of active uniforms has been built.
+  /// \post The CameraBlock, LightBlock, and MaterialBlock uniform blocks, if
+  ///   used, are attached to CAMERA_BLOCK_BINDING, LIGHT_BLOCK_BINDING, and
+  ///   MATERIAL_BLOCK_BINDING.
   void
-  link () const;
+  link ();
 
   /// \brief Makes this ShaderProgram the one that will be used by future
   ///   OpenGL calls.
+  /// \post A submitted or deferred build has been finished first.
   void
   enable ();
 
+  /// \brief Gets the OpenGL name of this ShaderProgram.
+  /// \return The program object's identifier.
+  GLuint
+  getId () const;
+
   /// \brief Ensures that future OpenGL calls will not affect this
   ///   ShaderProgram (until it is subsequently re-enabled).
   void
@@ -103,12 +340,92 @@ public:
 
 private:
 
-  /// \brief Compiles a shader.
-  /// \param[in] shaderFilename The name of a file that contains the shader's
-  ///   source code.
-  /// \param[in] shaderId The OpenGL identifier associated with the shader.
+  /// \brief An entry in the table of active uniforms.
+  struct UniformInfo
+  {
+    /// The uniform's full name, with a subscript for array elements.
+    std::string name;
+    /// The uniform's location and type.
+    UniformHandle handle;
+  };
+
+  /// \brief Where the shadow copy of one uniform's value lives.
+  struct ShadowSlot
+  {
+    /// The offset of the copy within m_shadow, in bytes.
+    unsigned int offset;
+    /// The size of the copy, in bytes.
+    unsigned int size;
+    /// Whether or not the copy holds a value we have sent.
+    bool valid;
+  };
+
+  /// \brief Does everything that follows a successful link: fills the
+  ///   uniform table and attaches the shared uniform blocks and the shared
+  ///   textures (light clusters and G-buffer).
+  void
+  finishLink ();
+
+  /// \brief Points a sampler uniform at a texture unit, if the program has
+  ///   it.
+  /// \param[in] samplerName The name of the sampler uniform.
+  /// \param[in] unit The texture unit, counting from 0.
+  void
+  bindSampler (const std::string& samplerName, GLint unit);
+
+  /// \brief Asks OpenGL for every active uniform and fills m_uniforms.
   void
-  compileShader (const std::string& shaderFilename, GLuint shaderId);
+  introspectUniforms ();
+
+  /// \brief Creates the shadow copy for a uniform.
+  /// \param[in] location The uniform's location.
+  /// \param[in] type The uniform's OpenGL type.
+  /// \return The uniform's handle.
+  UniformHandle
+  addShadowSlot (GLint location, GLenum type);
+
+  /// \brief Compares a value with a uniform's shadow copy, and updates the
+  ///   copy and the upload counts.
+  /// \param[in] uniform The uniform.
+  /// \param[in] value The new value.
+  /// \param[in] size The size of the new value, in bytes.
+  /// \return Whether or not the value must be sent to OpenGL.
+  bool
+  updateShadow (const UniformHandle& uniform, const void* value,
+                unsigned int size);
+
+  /// \brief The stages a ShaderProgram's build goes through.
+  enum BuildState
+  {
+    /// Shaders are created and linked one call at a time, or not at all.
+    NOT_BUILDING,
+    /// defer () has recorded the files, but nothing has been compiled.
+    DEFERRED,
+    /// submit () has issued the commands, but finish () has not checked them.
+    COMPILING,
+    /// The program has been linked.
+    LINKED
+  };
+
+  /// \brief Creates a shader, starts compiling it, and attaches it, without
+  ///   waiting to see whether it compiled.
+  /// \param[in] shaderType GL_VERTEX_SHADER, GL_FRAGMENT_SHADER, or
+  ///   GL_COMPUTE_SHADER.
+  /// \param[in] source The shader's source code.
+  /// \return The OpenGL identifier of the shader.
+  GLuint
+  createShader (GLenum shaderType, const std::string& source);
+
+  /// \brief Exits with a log if a shader failed to compile.
+  /// \param[in] shaderId The OpenGL identifier of the shader.
+  /// \param[in] shaderFilename The name of the file the source came from,
+  ///   used to name the log.
+  void
+  checkShader (GLuint shaderId, const std::string& shaderFilename) const;
+
+  /// \brief Exits with a log if this program failed to link.
+  void
+  checkLink () const;
 
   /// \brief Reads the source code for a shader from a file.
   /// \param[in] filename The name of a file that contains the shader's source
@@ -117,6 +434,13 @@ private:
   std::string
   readShaderSource (const std::string& filename) const;
 
+  /// \brief Inserts this program's defines into a shader's source code.
+  /// \param[in] source The source code, which may start with "#version".
+  /// \return The source with m_defines after the "#version" line (which must
+  ///   stay first), or at the start if there is none.
+  std::string
+  injectDefines (const std::string& source) const;
+
   /// \brief Writes an info log to a file.
   /// \param[in] shaderId The OpenGL identifier associated with the shader the
   ///   log should come from, if associated with a specific shader.
@@ -140,6 +464,29 @@ private:
   GLuint m_vertexShaderId;
   /// The OpenGL identifier given to the fragment shader.
   GLuint m_fragmentShaderId;
+  /// How far a submitted or deferred build has gotten.
+  BuildState m_buildState;
+  /// The file the vertex shader comes from, for a submitted or deferred build.
+  std::string m_vertexShaderFilename;
+  /// The file the fragment shader comes from, for a submitted or deferred
+  ///   build.
+  std::string m_fragmentShaderFilename;
+  /// The "#define" lines of a submitted or deferred build.
+  std::string m_defines;
+  /// The binary cache of a submitted or deferred build, or nullptr.
+  ProgramBinaryCache* m_cache;
+  /// The key of this program in m_cache.
+  uint64_t m_cacheKey;
+  /// Every active uniform, sorted by name.
+  std::vector<UniformInfo> m_uniforms;
+  /// One slot per active uniform location.
+  std::vector<ShadowSlot> m_shadowSlots;
+  /// The last values sent to the uniforms.
+  std::vector<unsigned char> m_shadow;
+  /// The uploads issued and skipped.
+  UniformUploadCounts m_uploadCounts;
+  /// Whether or not the driver compiles shaders on its own threads.
+  static bool s_parallelCompile;
 };
 
 #endif//SHADER_PROGRAM_HPP
@@ -0,0 +1,1602 @@
+/// \file SoftwareOpenGLContext.cpp
+/// \brief Definitions of SoftwareOpenGLContext member and associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "SoftwareOpenGLContext.hpp"
+#include "JobSystem.hpp"
+#include "RenderQueue.hpp"
+#include "GpuCuller.hpp"
+#include "Frustum.hpp"
+#include "Matrix4.hpp"
+#include "Vector3.hpp"
+
+namespace
+{
+  /// How far outside the viewport a triangle may reach before it is
+  ///   clipped, as a multiple of the viewport's half-size.  Clipping to this
+  ///   guard band instead of the viewport leaves most triangles whole, and
+  ///   keeps the rest small enough for exact-enough edge functions.
+  const float GUARD_BAND = 4.0f;
+
+  /// The planes a triangle is clipped to, as (a, b, c, d) keeping the clip
+  ///   space points where ax + by + cz + dw >= 0: near, far, and the guard
+  ///   band.
+  const float CLIP_PLANES[6][4] = {
+    { 0.0f, 0.0f, 1.0f, 1.0f },
+    { 0.0f, 0.0f, -1.0f, 1.0f },
+    { 1.0f, 0.0f, 0.0f, GUARD_BAND },
+    { -1.0f, 0.0f, 0.0f, GUARD_BAND },
+    { 0.0f, 1.0f, 0.0f, GUARD_BAND },
+    { 0.0f, -1.0f, 0.0f, GUARD_BAND }
+  };
+
+  /// The most vertices clipping a triangle can leave: one more per plane.
+  const int MAX_CLIPPED = 9;
+
+  /// The number of invocations in each work group of CullDraws.comp.
+  const GLuint CULL_GROUP_SIZE = 64;
+
+  /// \brief Turns a column-major array into a Matrix4.
+  /// \param[in] m The 16 values.
+  /// \return The same matrix.
+  Matrix4
+  toMatrix (const float m[16])
+  {
+    return Matrix4 (Vector4 (m[0], m[1], m[2], m[3]),
+                    Vector4 (m[4], m[5], m[6], m[7]),
+                    Vector4 (m[8], m[9], m[10], m[11]),
+                    Vector4 (m[12], m[13], m[14], m[15]));
+  }
+
+  /// \brief Converts a color channel to a byte, as the framebuffer stores
+  ///   it.
+  /// \param[in] value The channel, which is clamped to [0, 1].
+  /// \return The byte.
+  std::uint32_t
+  toByte (float value)
+  {
+    // Written so that NaN is 0.
+    float clamped = value > 0.0f ? std::min (value, 1.0f) : 0.0f;
+    return static_cast<std::uint32_t> (clamped * 255.0f + 0.5f);
+  }
+
+  /// \brief Packs a color as the color buffer stores it.
+  /// \return The color, as 0xAABBGGRR.
+  std::uint32_t
+  pack (float red, float green, float blue, float alpha)
+  {
+    return toByte (red) | toByte (green) << 8 | toByte (blue) << 16 | toByte (alpha) << 24;
+  }
+
+  /// \brief Multiplies a column-major 4x4 matrix by a point.
+  /// \param[in] matrix The matrix.
+  /// \param[in] point The point's x, y, and z; its w is 1.
+  /// \param[out] result The product.
+  void
+  transformPoint (const float matrix[16], const float point[3], float result[4])
+  {
+    for (int row = 0; row < 4; ++row)
+      result[row] = matrix[row] * point[0] + matrix[4 + row] * point[1]
+        + matrix[8 + row] * point[2] + matrix[12 + row];
+  }
+
+  /// \brief Multiplies a column-major 3x3 matrix by a vector.
+  /// \param[in] matrix The matrix.
+  /// \param[in] vector The vector.
+  /// \return The product.
+  Vector3
+  transformVector (const float matrix[9], const float vector[3])
+  {
+    return Vector3 (matrix[0] * vector[0] + matrix[3] * vector[1] + matrix[6] * vector[2],
+                    matrix[1] * vector[0] + matrix[4] * vector[1] + matrix[7] * vector[2],
+                    matrix[2] * vector[0] + matrix[5] * vector[1] + matrix[8] * vector[2]);
+  }
+
+  /// \brief Makes a Vector3 from a block's vec3.
+  Vector3
+  toVector (const float vector[3])
+  {
+    return Vector3 (vector[0], vector[1], vector[2]);
+  }
+
+  /// \brief Multiplies two vectors component by component, as GLSL's
+  ///   vec3 * vec3 does.
+  Vector3
+  multiply (const Vector3& a, const Vector3& b)
+  {
+    return Vector3 (a.m_x * b.m_x, a.m_y * b.m_y, a.m_z * b.m_z);
+  }
+
+  /// \brief GLSL's normalize.
+  Vector3
+  unit (const Vector3& v)
+  {
+    return v / v.length ();
+  }
+
+  /// \brief GLSL's reflect.
+  Vector3
+  reflect (const Vector3& incident, const Vector3& normal)
+  {
+    return incident - 2.0f * normal.dot (incident) * normal;
+  }
+
+  /// \brief Converts a float to an index in [0, count), as GLSL's
+  ///   clamp (int (value), 0, count - 1) does.
+  /// \return The index; 0 if value is NaN.
+  GLint
+  toIndex (float value, GLint count)
+  {
+    if (!(value >= 1.0f))
+      return 0;
+    return value >= count ? count - 1 : static_cast<GLint> (value);
+  }
+
+  // The rest of this namespace is a port of PhongShader.frag; see it for
+  //   the reasoning.
+
+  /// \brief Calculates the diffuse and specular light reflected toward the
+  ///   eye.
+  /// \param[in] light The light.
+  /// \param[in] material The surface's material.
+  /// \param[in] lightVector A unit vector toward the light.
+  /// \param[in] vertexPosition The surface's position, in eye space.
+  /// \param[in] vertexNormal The surface's normal, in eye space.
+  /// \return The light.
+  Vector3
+  calculateDiffuseAndSpecular (const LightBlockEntry& light,
+                               const MaterialBlockEntry& material,
+                               const Vector3& lightVector,
+                               const Vector3& vertexPosition,
+                               const Vector3& vertexNormal)
+  {
+    float lambertianCoef = std::max (lightVector.dot (vertexNormal), 0.0f);
+    if (lambertianCoef <= 0.0f)
+      return Vector3 (0.0f);
+    Vector3 diffuseColor = multiply (toVector (material.diffuseReflection),
+                                     toVector (light.diffuseIntensity));
+    diffuseColor *= lambertianCoef;
+
+    Vector3 specularColor = multiply (toVector (material.specularReflection),
+                                      toVector (light.specularIntensity));
+    Vector3 reflectionVector = reflect (-lightVector, vertexNormal);
+    Vector3 eyeVector = unit (-vertexPosition);
+    float specularCoef = std::max (eyeVector.dot (reflectionVector), 0.0f);
+    specularColor *= std::pow (specularCoef, material.specularPower);
+
+    return diffuseColor + specularColor;
+  }
+
+  /// \brief Calculates how much a point or spot light has faded.
+  /// \param[in] light The light.
+  /// \param[in] vertexPosition The surface's position, in eye space.
+  /// \return The factor.
+  float
+  calculateAttenuation (const LightBlockEntry& light, const Vector3& vertexPosition)
+  {
+    float distance = (toVector (light.position) - vertexPosition).length ();
+    return 1.0f / (light.attenuationCoefficients[0]
+                   + light.attenuationCoefficients[1] * distance
+                   + light.attenuationCoefficients[2] * distance * distance);
+  }
+
+  /// \brief Calculates the light from a directional light.
+  Vector3
+  calculateDirectional (const LightBlockEntry& light, const MaterialBlockEntry& material,
+                        const Vector3& vertexPosition, const Vector3& vertexNormal)
+  {
+    Vector3 lightVector = -toVector (light.direction);
+    return calculateDiffuseAndSpecular (light, material, lightVector, vertexPosition,
+                                        vertexNormal);
+  }
+
+  /// \brief Calculates the light from a point light.
+  Vector3
+  calculatePoint (const LightBlockEntry& light, const MaterialBlockEntry& material,
+                  const Vector3& vertexPosition, const Vector3& vertexNormal)
+  {
+    Vector3 lightVector = unit (toVector (light.position) - vertexPosition);
+    return calculateAttenuation (light, vertexPosition)
+      * calculateDiffuseAndSpecular (light, material, lightVector, vertexPosition,
+                                     vertexNormal);
+  }
+
+  /// \brief Calculates the light from a spot light.
+  Vector3
+  calculateSpot (const LightBlockEntry& light, const MaterialBlockEntry& material,
+                 const Vector3& vertexPosition, const Vector3& vertexNormal)
+  {
+    Vector3 lightVector = unit (toVector (light.position) - vertexPosition);
+    float cosTheta = std::max ((-lightVector).dot (toVector (light.direction)), 0.0f);
+    float spotFactor = (cosTheta >= light.cutoffCosAngle) ? cosTheta : 0.0f;
+    spotFactor = std::pow (spotFactor, light.falloff);
+    return spotFactor * calculateAttenuation (light, vertexPosition)
+      * calculateDiffuseAndSpecular (light, material, lightVector, vertexPosition,
+                                     vertexNormal);
+  }
+
+  /// \brief Calculates the light from a light of any type.
+  Vector3
+  calculateLighting (const LightBlockEntry& light, const MaterialBlockEntry& material,
+                     const Vector3& vertexPosition, const Vector3& vertexNormal)
+  {
+    if (light.type == 0)
+      return calculateDirectional (light, material, vertexPosition, vertexNormal);
+    else if (light.type == 1)
+      return calculatePoint (light, material, vertexPosition, vertexNormal);
+    else
+      return calculateSpot (light, material, vertexPosition, vertexNormal);
+  }
+
+  /// \brief Calculates the light from every point and spot light in a
+  ///   surface's cluster.
+  /// \param[in] camera The camera block, for its projection.
+  /// \param[in] cluster The cluster block.
+  /// \param[in] grid Each cluster's first index and light count.
+  /// \param[in] indices The clusters' light indices.
+  /// \param[in] lights The clustered lights.
+  /// \param[in] material The surface's material.
+  /// \param[in] vertexPosition The surface's position, in eye space.
+  /// \param[in] vertexNormal The surface's normal, in eye space.
+  /// \return The light.
+  Vector3
+  calculateClustered (const CameraBlock& camera, const ClusterBlock& cluster,
+                      const std::vector<GLuint>& grid, const std::vector<GLuint>& indices,
+                      const std::vector<LightBlockEntry>& lights,
+                      const MaterialBlockEntry& material,
+                      const Vector3& vertexPosition, const Vector3& vertexNormal)
+  {
+    const float position[3] = { vertexPosition.m_x, vertexPosition.m_y, vertexPosition.m_z };
+    float clip[4];
+    transformPoint (camera.projection, position, clip);
+    GLint size[3];
+    for (int axis = 0; axis < 3; ++axis)
+      size[axis] = std::max<GLint> (cluster.gridSize[axis], 1);
+    GLint tileX = toIndex ((clip[0] / clip[3] * 0.5f + 0.5f) * size[0], size[0]);
+    GLint tileY = toIndex ((clip[1] / clip[3] * 0.5f + 0.5f) * size[1], size[1]);
+    float depth = std::max (-vertexPosition.m_z, 1e-4f);
+    GLint slice = toIndex (std::log (depth) * cluster.sliceScale + cluster.sliceBias, size[2]);
+    std::size_t index = tileX + size[0] * (tileY + size[1] * slice);
+
+    Vector3 color (0.0f);
+    if (2 * index + 1 >= grid.size ())
+      return color;
+    GLuint first = grid[2 * index];
+    GLuint count = grid[2 * index + 1];
+    for (GLuint i = 0; i < count && first + i < indices.size (); ++i)
+    {
+      GLuint light = indices[first + i];
+      if (light >= lights.size ())
+        continue;
+      if (lights[light].type == 1)
+        color += calculatePoint (lights[light], material, vertexPosition, vertexNormal);
+      else
+        color += calculateSpot (lights[light], material, vertexPosition, vertexNormal);
+    }
+    return color;
+  }
+
+#ifndef __SSE2__
+  /// \brief Performs a depth test.
+  /// \param[in] func The depth function.
+  /// \param[in] depth The incoming depth.
+  /// \param[in] stored The depth in the depth buffer.
+  /// \return Whether or not it passes.
+  bool
+  passesDepth (GLenum func, float depth, float stored)
+  {
+    switch (func)
+    {
+    case GL_NEVER:
+      return false;
+    case GL_LESS:
+      return depth < stored;
+    case GL_EQUAL:
+      return depth == stored;
+    case GL_LEQUAL:
+      return depth <= stored;
+    case GL_GREATER:
+      return depth > stored;
+    case GL_NOTEQUAL:
+      return depth != stored;
+    case GL_GEQUAL:
+      return depth >= stored;
+    default:
+      return true;
+    }
+  }
+#endif
+}
+
+SoftwareOpenGLContext::SoftwareOpenGLContext (GLsizei width, GLsizei height, JobSystem* jobs)
+  : NullOpenGLContext (), m_width (width), m_height (height), m_jobs (jobs),
+    m_stride ((width + 3) & ~3), m_color (m_stride * height, pack (0, 0, 0, 0)),
+    m_depth (m_stride * height, 1.0f), m_tilesX ((width + TILE_SIZE - 1) / TILE_SIZE),
+    m_tilesY ((height + TILE_SIZE - 1) / TILE_SIZE), m_bins (m_tilesX * m_tilesY),
+    m_triangles (), m_draws (), m_indices (), m_shaded (), m_triangleCount (0),
+    m_buffers (), m_bufferBindings (), m_uniformBindings (), m_storageBindings (),
+    m_vertexArrays (),
+    m_vertexArray (0), m_textureBuffers (), m_bufferTextures (), m_activeTexture (0),
+    m_framebuffer (0), m_programs (), m_program (0), m_lighting (),
+    m_viewport { 0, 0, width, height }, m_clearColor (pack (0, 0, 0, 0)),
+    m_depthTest (false), m_depthFunc (GL_LESS), m_cullFace (false),
+    m_cullMode (GL_BACK), m_frontFace (GL_CCW)
+{
+  m_vertexArrays[0] = VertexArray ();
+  NullOpenGLContext::viewport (0, 0, width, height);
+}
+
+SoftwareOpenGLContext::~SoftwareOpenGLContext ()
+{
+}
+
+SoftwareOpenGLContext::VertexArray::VertexArray ()
+  : attribs (), bindings (), elementBuffer (0)
+{
+  for (GLuint index = 0; index < MAX_VERTEX_ATTRIBS; ++index)
+    attribs[index].binding = index;
+}
+
+void
+SoftwareOpenGLContext::flush ()
+{
+  if (m_triangles.empty ())
+    return;
+  unsigned int tiles = m_bins.size ();
+  if (m_jobs != nullptr)
+    m_jobs->parallelFor (0, tiles, 1, [this] (unsigned int first, unsigned int last)
+                         {
+                           for (unsigned int tile = first; tile < last; ++tile)
+                             rasterizeTile (tile);
+                         });
+  else
+    for (unsigned int tile = 0; tile < tiles; ++tile)
+      rasterizeTile (tile);
+
+  m_triangleCount += m_triangles.size ();
+  m_triangles.clear ();
+  m_draws.clear ();
+  for (std::vector<std::uint32_t>& bin : m_bins)
+    bin.clear ();
+}
+
+void
+SoftwareOpenGLContext::readPixel (GLint x, GLint y, GLubyte rgb[3])
+{
+  flush ();
+  std::uint32_t color = m_color[y * m_stride + x];
+  for (int channel = 0; channel < 3; ++channel)
+    rgb[channel] = (color >> (8 * channel)) & 0xFF;
+}
+
+GLfloat
+SoftwareOpenGLContext::readDepth (GLint x, GLint y)
+{
+  flush ();
+  return m_depth[y * m_stride + x];
+}
+
+bool
+SoftwareOpenGLContext::savePPM (const std::string& path)
+{
+  flush ();
+  FILE* file = fopen (path.c_str (), "wb");
+  if (file == nullptr)
+  {
+    fprintf (stderr, "Failed to open %s for writing\n", path.c_str ());
+    return false;
+  }
+  fprintf (file, "P6\n%d %d\n255\n", m_width, m_height);
+  std::vector<unsigned char> row (3 * m_width);
+  bool written = true;
+  for (GLint y = m_height - 1; y >= 0 && written; --y)
+  {
+    for (GLint x = 0; x < m_width; ++x)
+      readPixel (x, y, &row[3 * x]);
+    written = fwrite (row.data (), 1, row.size (), file) == row.size ();
+  }
+  if (fclose (file) != 0 || !written)
+  {
+    fprintf (stderr, "Failed to write %s\n", path.c_str ());
+    return false;
+  }
+  return true;
+}
+
+unsigned long
+SoftwareOpenGLContext::getTriangleCount () const
+{
+  return m_triangleCount;
+}
+
+void
+SoftwareOpenGLContext::activeTexture (GLenum texture)
+{
+  m_activeTexture = texture - GL_TEXTURE0;
+}
+
+void
+SoftwareOpenGLContext::bindBuffer (GLenum target, GLuint buffer)
+{
+  if (target == GL_ELEMENT_ARRAY_BUFFER)
+    m_vertexArrays[m_vertexArray].elementBuffer = buffer;
+  else
+    m_bufferBindings[target] = buffer;
+}
+
+void
+SoftwareOpenGLContext::bindBufferBase (GLenum target, GLuint index, GLuint buffer)
+{
+  m_bufferBindings[target] = buffer;
+  if (target == GL_UNIFORM_BUFFER)
+  {
+    m_uniformBindings[index] = buffer;
+    m_lighting.reset ();
+  }
+  else if (target == GL_SHADER_STORAGE_BUFFER)
+    m_storageBindings[index] = buffer;
+}
+
+void
+SoftwareOpenGLContext::bindFramebuffer (GLenum target, GLuint framebuffer)
+{
+  m_framebuffer = framebuffer;
+}
+
+void
+SoftwareOpenGLContext::bindTexture (GLenum target, GLuint texture)
+{
+  if (target == GL_TEXTURE_BUFFER)
+  {
+    m_bufferTextures[m_activeTexture] = texture;
+    m_lighting.reset ();
+  }
+}
+
+void
+SoftwareOpenGLContext::bindVertexArray (GLuint array)
+{
+  m_vertexArray = array;
+  // Makes it, if this is the first bind.
+  m_vertexArrays[array];
+}
+
+void
+SoftwareOpenGLContext::bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage)
+{
+  storeBuffer (getBoundBuffer (target), size, data);
+  // Vertices are shaded as they are drawn, so only a buffer read later (a
+  //   uniform block or texture buffer) can make the last copy stale.
+  if (target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER)
+    m_lighting.reset ();
+}
+
+void
+SoftwareOpenGLContext::bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+{
+  storeBufferPart (getBoundBuffer (target), offset, size, data);
+  if (target != GL_ARRAY_BUFFER && target != GL_ELEMENT_ARRAY_BUFFER)
+    m_lighting.reset ();
+}
+
+void
+SoftwareOpenGLContext::clear (GLbitfield mask)
+{
+  if (m_framebuffer != 0)
+    return;
+  const GLbitfield BOTH = GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT;
+  if ((mask & BOTH) == BOTH)
+  {
+    // Nothing waiting could show through, so it needn't be drawn at all.
+    m_triangles.clear ();
+    m_draws.clear ();
+    for (std::vector<std::uint32_t>& bin : m_bins)
+      bin.clear ();
+  }
+  else
+    flush ();
+  if (mask & GL_COLOR_BUFFER_BIT)
+    std::fill (m_color.begin (), m_color.end (), m_clearColor);
+  if (mask & GL_DEPTH_BUFFER_BIT)
+    std::fill (m_depth.begin (), m_depth.end (), 1.0f);
+}
+
+void
+SoftwareOpenGLContext::clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+  m_clearColor = pack (red, green, blue, alpha);
+}
+
+void
+SoftwareOpenGLContext::createBuffers (GLsizei n, GLuint* buffers)
+{
+  NullOpenGLContext::createBuffers (n, buffers);
+  for (GLsizei i = 0; i < n; ++i)
+    m_buffers[buffers[i]];
+}
+
+void
+SoftwareOpenGLContext::createVertexArrays (GLsizei n, GLuint* arrays)
+{
+  NullOpenGLContext::createVertexArrays (n, arrays);
+  for (GLsizei i = 0; i < n; ++i)
+    m_vertexArrays[arrays[i]];
+}
+
+void
+SoftwareOpenGLContext::cullFace (GLenum mode)
+{
+  m_cullMode = mode;
+}
+
+void
+SoftwareOpenGLContext::deleteBuffers (GLsizei n, const GLuint* buffers)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    m_buffers.erase (buffers[i]);
+}
+
+void
+SoftwareOpenGLContext::deleteProgram (GLuint program)
+{
+  NullOpenGLContext::deleteProgram (program);
+  m_programs.erase (program);
+}
+
+void
+SoftwareOpenGLContext::deleteTextures (GLsizei n, const GLuint* textures)
+{
+  for (GLsizei i = 0; i < n; ++i)
+    m_textureBuffers.erase (textures[i]);
+}
+
+void
+SoftwareOpenGLContext::deleteVertexArrays (GLsizei n, const GLuint* arrays)
+{
+  for (GLsizei i = 0; i < n; ++i)
+  {
+    if (arrays[i] == 0)
+      continue;
+    m_vertexArrays.erase (arrays[i]);
+    if (m_vertexArray == arrays[i])
+      m_vertexArray = 0;
+  }
+}
+
+void
+SoftwareOpenGLContext::depthFunc (GLenum func)
+{
+  m_depthFunc = func;
+}
+
+void
+SoftwareOpenGLContext::dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
+{
+  auto found = m_programs.find (m_program);
+  if (found != m_programs.end () && found->second.cullsDraws)
+    cullDraws (num_groups_x * num_groups_y * num_groups_z * CULL_GROUP_SIZE);
+}
+
+void
+SoftwareOpenGLContext::drawArrays (GLenum mode, GLint first, GLsizei count)
+{
+  if (mode == GL_TRIANGLES)
+    draw (count, first, 0, 0);
+}
+
+void
+SoftwareOpenGLContext::drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices)
+{
+  if (mode == GL_TRIANGLES)
+    draw (count, 0, type, reinterpret_cast<std::size_t> (indices));
+}
+
+void
+SoftwareOpenGLContext::enable (GLenum cap)
+{
+  if (cap == GL_DEPTH_TEST)
+    m_depthTest = true;
+  else if (cap == GL_CULL_FACE)
+    m_cullFace = true;
+}
+
+void
+SoftwareOpenGLContext::enableVertexArrayAttrib (GLuint vaobj, GLuint index)
+{
+  if (index < MAX_VERTEX_ATTRIBS)
+    m_vertexArrays[vaobj].attribs[index].enabled = true;
+}
+
+void
+SoftwareOpenGLContext::enableVertexAttribArray (GLuint index)
+{
+  if (index < MAX_VERTEX_ATTRIBS)
+    m_vertexArrays[m_vertexArray].attribs[index].enabled = true;
+}
+
+void
+SoftwareOpenGLContext::frontFace (GLenum mode)
+{
+  m_frontFace = mode;
+}
+
+const GLubyte*
+SoftwareOpenGLContext::getString (GLenum name)
+{
+  static const GLubyte NAME[] = "Software";
+  return NAME;
+}
+
+void
+SoftwareOpenGLContext::linkProgram (GLuint program)
+{
+  NullOpenGLContext::linkProgram (program);
+  recognizeProgram (program);
+}
+
+void*
+SoftwareOpenGLContext::mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+  auto found = m_buffers.find (buffer);
+  if (found == m_buffers.end () || offset < 0 || length <= 0
+      || static_cast<std::size_t> (offset + length) > found->second.size ())
+    return nullptr;
+  return found->second.data () + offset;
+}
+
+void
+SoftwareOpenGLContext::multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride)
+{
+  auto commands = m_buffers.find (getBoundBuffer (GL_DRAW_INDIRECT_BUFFER));
+  if (mode != GL_TRIANGLES || commands == m_buffers.end ())
+    return;
+  // A program that reads its transformations from uDrawData gets them as
+  //   the uniforms the C++ ports read, one draw at a time.
+  GLint unit;
+  GLuint drawData = getSamplerBuffer ("uDrawData", unit);
+  const std::vector<GLfloat>* base = getUniform ("uDrawBase");
+  GLint drawBase = (base != nullptr) ? static_cast<GLint> ((*base)[0]) : 0;
+  std::size_t indexSize = (type == GL_UNSIGNED_INT) ? 4 : (type == GL_UNSIGNED_SHORT) ? 2 : 1;
+  std::size_t step = (stride == 0) ? sizeof (DrawElementsIndirectCommand) : stride;
+  std::size_t offset = reinterpret_cast<std::size_t> (indirect);
+  for (GLsizei i = 0; i < drawcount; ++i, offset += step)
+  {
+    DrawElementsIndirectCommand command;
+    if (offset + sizeof (command) > commands->second.size ())
+      return;
+    std::memcpy (&command, commands->second.data () + offset, sizeof (command));
+    if (command.instanceCount == 0)
+      continue;
+    if (drawData != 0)
+    {
+      DrawData data;
+      std::size_t at = (drawBase + i) * sizeof (DrawData);
+      auto buffer = m_buffers.find (drawData);
+      if (buffer == m_buffers.end () || at + sizeof (data) > buffer->second.size ())
+        continue;
+      std::memcpy (&data, buffer->second.data () + at, sizeof (data));
+      GLfloat normalMatrix[9];
+      for (int column = 0; column < 3; ++column)
+        std::copy (data.normalMatrix + 4 * column, data.normalMatrix + 4 * column + 3,
+                   normalMatrix + 3 * column);
+      setUniform (getUniformLocation (m_program, "uWorld"), data.world, 16);
+      setUniform (getUniformLocation (m_program, "uModelView"), data.modelView, 16);
+      setUniform (getUniformLocation (m_program, "uModelViewProjection"),
+                  data.modelViewProjection, 16);
+      setUniform (getUniformLocation (m_program, "uNormalMatrix"), normalMatrix, 9);
+    }
+    draw (command.count, command.baseVertex, type, command.firstIndex * indexSize);
+  }
+}
+
+void
+SoftwareOpenGLContext::multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+{
+  auto parameters = m_buffers.find (getBoundBuffer (GL_PARAMETER_BUFFER));
+  if (parameters == m_buffers.end () || drawcount < 0
+      || static_cast<std::size_t> (drawcount) + sizeof (GLuint) > parameters->second.size ())
+    return;
+  GLuint count;
+  std::memcpy (&count, parameters->second.data () + drawcount, sizeof (count));
+  multiDrawElementsIndirect (mode, type, indirect,
+                            std::min (count, static_cast<GLuint> (maxdrawcount)), stride);
+}
+
+void
+SoftwareOpenGLContext::namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+{
+  storeBuffer (buffer, size, data);
+  // Which targets the buffer is read through isn't known here, so the
+  //   blocks are copied again at the next draw.
+  m_lighting.reset ();
+}
+
+void
+SoftwareOpenGLContext::namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+  storeBuffer (buffer, size, data);
+  m_lighting.reset ();
+}
+
+void
+SoftwareOpenGLContext::namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+  storeBufferPart (buffer, offset, size, data);
+  m_lighting.reset ();
+}
+
+void
+SoftwareOpenGLContext::texBuffer (GLenum target, GLenum internalformat, GLuint buffer)
+{
+  auto texture = m_bufferTextures.find (m_activeTexture);
+  if (target != GL_TEXTURE_BUFFER || texture == m_bufferTextures.end ())
+    return;
+  m_textureBuffers[texture->second] = buffer;
+  m_lighting.reset ();
+}
+
+void
+SoftwareOpenGLContext::uniform1f (GLint location, GLfloat v0)
+{
+  setUniform (location, &v0, 1);
+}
+
+void
+SoftwareOpenGLContext::uniform1i (GLint location, GLint v0)
+{
+  GLfloat value = v0;
+  setUniform (location, &value, 1);
+}
+
+void
+SoftwareOpenGLContext::uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+{
+  const GLfloat value[3] = { v0, v1, v2 };
+  setUniform (location, value, 3);
+}
+
+void
+SoftwareOpenGLContext::uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
+{
+  m_programs[program].blockBindings[uniformBlockIndex] = uniformBlockBinding;
+  m_lighting.reset ();
+}
+
+void
+SoftwareOpenGLContext::uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  GLfloat matrix[9];
+  for (int column = 0; column < 3; ++column)
+    for (int row = 0; row < 3; ++row)
+      matrix[3 * column + row] = transpose ? value[3 * row + column] : value[3 * column + row];
+  setUniform (location, matrix, 9);
+}
+
+void
+SoftwareOpenGLContext::uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+  GLfloat matrix[16];
+  for (int column = 0; column < 4; ++column)
+    for (int row = 0; row < 4; ++row)
+      matrix[4 * column + row] = transpose ? value[4 * row + column] : value[4 * column + row];
+  setUniform (location, matrix, 16);
+}
+
+GLboolean
+SoftwareOpenGLContext::unmapNamedBuffer (GLuint buffer)
+{
+  return m_buffers.count (buffer) != 0 ? GL_TRUE : GL_FALSE;
+}
+
+void
+SoftwareOpenGLContext::useProgram (GLuint program)
+{
+  m_program = program;
+}
+
+void
+SoftwareOpenGLContext::vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex)
+{
+  if (attribindex >= MAX_VERTEX_ATTRIBS || bindingindex >= MAX_VERTEX_ATTRIBS)
+    return;
+  VertexArray& array = m_vertexArrays[vaobj];
+  array.attribs[attribindex].binding = bindingindex;
+  updateAttrib (array, attribindex);
+}
+
+void
+SoftwareOpenGLContext::vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset)
+{
+  if (attribindex >= MAX_VERTEX_ATTRIBS)
+    return;
+  VertexArray& array = m_vertexArrays[vaobj];
+  VertexAttrib& attrib = array.attribs[attribindex];
+  attrib.size = std::min (std::max (size, 1), 4);
+  attrib.relativeOffset = relativeoffset;
+  updateAttrib (array, attribindex);
+}
+
+void
+SoftwareOpenGLContext::vertexArrayElementBuffer (GLuint vaobj, GLuint buffer)
+{
+  m_vertexArrays[vaobj].elementBuffer = buffer;
+}
+
+void
+SoftwareOpenGLContext::vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride)
+{
+  if (bindingindex >= MAX_VERTEX_ATTRIBS)
+    return;
+  VertexArray& array = m_vertexArrays[vaobj];
+  array.bindings[bindingindex] = VertexBinding { buffer, static_cast<std::size_t> (offset), stride };
+  for (GLuint index = 0; index < MAX_VERTEX_ATTRIBS; ++index)
+    if (array.attribs[index].binding == bindingindex)
+      updateAttrib (array, index);
+}
+
+void
+SoftwareOpenGLContext::vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer)
+{
+  if (index >= MAX_VERTEX_ATTRIBS)
+    return;
+  // This is a format, and a binding of the same index, set together.
+  VertexArray& array = m_vertexArrays[m_vertexArray];
+  VertexAttrib& attrib = array.attribs[index];
+  attrib.size = std::min (std::max (size, 1), 4);
+  attrib.relativeOffset = 0;
+  attrib.binding = index;
+  array.bindings[index] = VertexBinding {
+    getBoundBuffer (GL_ARRAY_BUFFER), reinterpret_cast<std::size_t> (pointer),
+    (stride != 0) ? stride : static_cast<GLsizei> (attrib.size * sizeof (GLfloat))
+  };
+  updateAttrib (array, index);
+}
+
+void
+SoftwareOpenGLContext::viewport (GLint x, GLint y, GLsizei width, GLsizei height)
+{
+  NullOpenGLContext::viewport (x, y, width, height);
+  m_viewport[0] = x;
+  m_viewport[1] = y;
+  m_viewport[2] = width;
+  m_viewport[3] = height;
+}
+
+void
+SoftwareOpenGLContext::recognizeProgram (GLuint program)
+{
+  const std::string source = getProgramSource (program);
+  auto has = [&source] (const char* text)
+  {
+    return source.find (text) != std::string::npos;
+  };
+
+  // Linking starts over, as it does in OpenGL.
+  ProgramState& state = m_programs[program];
+  state = ProgramState ();
+  // The deferred variants read and write a G-buffer, which isn't emulated.
+  if (has ("#define GBUFFER_PASS") || has ("#define DEFERRED_LIGHTING"))
+    state.shading = UNKNOWN_SHADING;
+  else if (has ("calculateDiffuseAndSpecular"))
+    state.shading = PHONG_SHADING;
+  else if (has ("uMaterials"))
+    state.shading = AMBIENT_SHADING;
+  else if (has ("uLightDirection"))
+    state.shading = NORMAL_SHADING;
+  else if (has ("aColor"))
+    state.shading = COLOR_SHADING;
+  else
+    state.shading = UNKNOWN_SHADING;
+  state.clustered = has ("#define CLUSTERED_LIGHTING");
+  state.cullsDraws = has ("uObjectCount");
+
+  const char* const DIRECTIONAL = "#define NUM_DIRECTIONAL_LIGHTS ";
+  std::size_t found = source.find (DIRECTIONAL);
+  state.directionalLights = (found == std::string::npos) ? -1
+    : std::atoi (source.c_str () + found + std::strlen (DIRECTIONAL));
+}
+
+GLuint
+SoftwareOpenGLContext::getBoundBuffer (GLenum target) const
+{
+  if (target == GL_ELEMENT_ARRAY_BUFFER)
+  {
+    auto array = m_vertexArrays.find (m_vertexArray);
+    return array == m_vertexArrays.end () ? 0 : array->second.elementBuffer;
+  }
+  auto found = m_bufferBindings.find (target);
+  return found == m_bufferBindings.end () ? 0 : found->second;
+}
+
+void
+SoftwareOpenGLContext::updateAttrib (VertexArray& array, GLuint index)
+{
+  VertexAttrib& attrib = array.attribs[index];
+  const VertexBinding& binding = array.bindings[attrib.binding];
+  attrib.buffer = binding.buffer;
+  attrib.offset = binding.offset + attrib.relativeOffset;
+  attrib.stride = binding.stride;
+}
+
+void
+SoftwareOpenGLContext::storeBuffer (GLuint buffer, GLsizeiptr size, const void* data)
+{
+  if (buffer == 0 || size < 0)
+    return;
+  std::vector<unsigned char>& contents = m_buffers[buffer];
+  const unsigned char* bytes = static_cast<const unsigned char*> (data);
+  if (bytes != nullptr)
+    contents.assign (bytes, bytes + size);
+  else
+    contents.assign (size, 0);
+}
+
+void
+SoftwareOpenGLContext::storeBufferPart (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+{
+  auto found = m_buffers.find (buffer);
+  if (found == m_buffers.end () || offset < 0 || size < 0
+      || static_cast<std::size_t> (offset + size) > found->second.size ())
+    return;
+  std::memcpy (found->second.data () + offset, data, size);
+}
+
+const std::vector<GLfloat>*
+SoftwareOpenGLContext::getUniform (const char* name)
+{
+  auto program = m_programs.find (m_program);
+  if (program == m_programs.end ())
+    return nullptr;
+  GLint location = getUniformLocation (m_program, name);
+  auto value = program->second.values.find (location);
+  return value == program->second.values.end () ? nullptr : &value->second;
+}
+
+void
+SoftwareOpenGLContext::setUniform (GLint location, const GLfloat* value, std::size_t count)
+{
+  if (m_program == 0 || location < 0)
+    return;
+  m_programs[m_program].values[location].assign (value, value + count);
+}
+
+void
+SoftwareOpenGLContext::readBuffer (GLuint buffer, void* block, std::size_t size) const
+{
+  std::memset (block, 0, size);
+  auto found = m_buffers.find (buffer);
+  if (found != m_buffers.end ())
+    std::memcpy (block, found->second.data (), std::min (size, found->second.size ()));
+}
+
+GLuint
+SoftwareOpenGLContext::getSamplerBuffer (const char* sampler, GLint& unit)
+{
+  // A sampler that was never set reads unit 0, as in OpenGL.
+  const std::vector<GLfloat>* value = getUniform (sampler);
+  unit = (value != nullptr) ? static_cast<GLint> ((*value)[0]) : 0;
+  auto texture = m_bufferTextures.find (unit);
+  if (texture == m_bufferTextures.end ())
+    return 0;
+  auto buffer = m_textureBuffers.find (texture->second);
+  return buffer == m_textureBuffers.end () ? 0 : buffer->second;
+}
+
+std::shared_ptr<const SoftwareOpenGLContext::Lighting>
+SoftwareOpenGLContext::getLighting ()
+{
+  const ProgramState& program = m_programs[m_program];
+  const char* const BLOCKS[4] = { "CameraBlock", "LightBlock", "MaterialBlock", "ClusterBlock" };
+  const char* const SAMPLERS[3] = { "uClusterGrid", "uClusterLightIndices", "uClusterLights" };
+  GLint sources[7];
+  for (int i = 0; i < 4; ++i)
+  {
+    // A block that was never bound reads binding point 0, as in OpenGL.
+    GLuint index = getUniformBlockIndex (m_program, BLOCKS[i]);
+    auto binding = program.blockBindings.find (index);
+    sources[i] = (index == GL_INVALID_INDEX) ? -1
+      : (binding == program.blockBindings.end ()) ? 0 : binding->second;
+  }
+  GLuint textureBuffers[3];
+  for (int i = 0; i < 3; ++i)
+    textureBuffers[i] = getSamplerBuffer (SAMPLERS[i], sources[4 + i]);
+  if (m_lighting != nullptr && std::equal (sources, sources + 7, m_lighting->sources))
+    return m_lighting;
+
+  std::shared_ptr<Lighting> lighting = std::make_shared<Lighting> ();
+  std::copy (sources, sources + 7, lighting->sources);
+  GLuint uniformBuffers[4];
+  for (int i = 0; i < 4; ++i)
+  {
+    auto buffer = m_uniformBindings.find (sources[i]);
+    uniformBuffers[i] = (sources[i] < 0 || buffer == m_uniformBindings.end ()) ? 0 : buffer->second;
+  }
+  readBuffer (uniformBuffers[0], &lighting->camera, sizeof (CameraBlock));
+  readBuffer (uniformBuffers[1], &lighting->lights, sizeof (LightBlock));
+  readBuffer (uniformBuffers[2], &lighting->materials, sizeof (MaterialBlock));
+  readBuffer (uniformBuffers[3], &lighting->clusterBlock, sizeof (ClusterBlock));
+
+  auto size = [this] (GLuint buffer)
+  {
+    auto found = m_buffers.find (buffer);
+    return found == m_buffers.end () ? 0 : found->second.size ();
+  };
+  lighting->clusterGrid.resize (size (textureBuffers[0]) / sizeof (GLuint));
+  readBuffer (textureBuffers[0], lighting->clusterGrid.data (),
+              lighting->clusterGrid.size () * sizeof (GLuint));
+  lighting->clusterIndices.resize (size (textureBuffers[1]) / sizeof (GLuint));
+  readBuffer (textureBuffers[1], lighting->clusterIndices.data (),
+              lighting->clusterIndices.size () * sizeof (GLuint));
+  lighting->clusterLights.resize (size (textureBuffers[2]) / sizeof (LightBlockEntry));
+  readBuffer (textureBuffers[2], lighting->clusterLights.data (),
+              lighting->clusterLights.size () * sizeof (LightBlockEntry));
+
+  m_lighting = lighting;
+  return m_lighting;
+}
+
+std::vector<unsigned char>*
+SoftwareOpenGLContext::getStorageBuffer (GLuint index)
+{
+  auto binding = m_storageBindings.find (index);
+  if (binding == m_storageBindings.end ())
+    return nullptr;
+  auto buffer = m_buffers.find (binding->second);
+  return buffer == m_buffers.end () ? nullptr : &buffer->second;
+}
+
+void
+SoftwareOpenGLContext::cullDraws (GLuint invocations)
+{
+  std::vector<unsigned char>* objects = getStorageBuffer (0);
+  std::vector<unsigned char>* worlds = getStorageBuffer (1);
+  std::vector<unsigned char>* counts = getStorageBuffer (2);
+  std::vector<unsigned char>* commands = getStorageBuffer (3);
+  std::vector<unsigned char>* drawData = getStorageBuffer (4);
+  if (objects == nullptr || worlds == nullptr || counts == nullptr || commands == nullptr
+      || drawData == nullptr)
+    return;
+  const std::vector<GLfloat>* value = getUniform ("uObjectCount");
+  GLuint objectCount = (value != nullptr) ? static_cast<GLuint> ((*value)[0]) : 0;
+  objectCount = std::min (objectCount, invocations);
+  const CameraBlock& camera = getLighting ()->camera;
+  Matrix4 view = toMatrix (camera.view);
+  Matrix4 projection = toMatrix (camera.projection);
+  Frustum frustum (projection * view);
+
+  // Each invocation in turn, as if every atomicAdd was made in order.
+  for (GLuint id = 0; id < objectCount; ++id)
+  {
+    GpuCullObject object;
+    float world[16];
+    GLuint count;
+    if ((id + 1) * sizeof (object) > objects->size ())
+      return;
+    std::memcpy (&object, objects->data () + id * sizeof (object), sizeof (object));
+    if ((object.node + 1) * sizeof (world) > worlds->size ()
+        || (object.batch + 1) * sizeof (count) > counts->size ())
+      continue;
+    std::memcpy (world, worlds->data () + object.node * sizeof (world), sizeof (world));
+    Vector3 center (object.sphere[0], object.sphere[1], object.sphere[2]);
+    if (!frustum.intersectsSphere (world, center, object.sphere[3]))
+      continue;
+
+    Matrix4 modelView = view * toMatrix (world);
+    GLuint level = 0;
+    if (object.levelCount > 1)
+    {
+      float scaleSquared = 0.0f;
+      for (int column = 0; column < 3; ++column)
+      {
+        const float* c = world + 4 * column;
+        scaleSquared = std::max (scaleSquared, c[0] * c[0] + c[1] * c[1] + c[2] * c[2]);
+      }
+      Vector4 eye = modelView * Vector4 (center.m_x, center.m_y, center.m_z, 1.0f);
+      float distance = Vector3 (eye.m_x, eye.m_y, eye.m_z).length ()
+        / std::max (object.sphere[3] * std::sqrt (scaleSquared), 1e-6f);
+      for (GLuint i = 1; i < std::min (object.levelCount, GPU_CULL_MAX_LEVELS); ++i)
+        if (distance >= object.distance[i])
+          level = i;
+    }
+
+    std::memcpy (&count, counts->data () + object.batch * sizeof (count), sizeof (count));
+    GLuint draw = object.batchBase + count;
+    ++count;
+    std::memcpy (counts->data () + object.batch * sizeof (count), &count, sizeof (count));
+    DrawElementsIndirectCommand command { object.indexCount[level], 1,
+                                          object.firstIndex[level], 0, 0 };
+    if ((draw + 1) * sizeof (command) <= commands->size ())
+      std::memcpy (commands->data () + draw * sizeof (command), &command, sizeof (command));
+    DrawData data;
+    Matrix4 modelViewProjection = projection * modelView;
+    Matrix3 normalMatrix = getNormalMatrix (modelView);
+    std::copy (world, world + 16, data.world);
+    std::copy (modelView.data (), modelView.data () + 16, data.modelView);
+    std::copy (modelViewProjection.data (), modelViewProjection.data () + 16,
+               data.modelViewProjection);
+    for (int column = 0; column < 3; ++column)
+    {
+      std::copy (normalMatrix.data () + 3 * column, normalMatrix.data () + 3 * column + 3,
+                 data.normalMatrix + 4 * column);
+      data.normalMatrix[4 * column + 3] = 0.0f;
+    }
+    if ((draw + 1) * sizeof (data) <= drawData->size ())
+      std::memcpy (drawData->data () + draw * sizeof (data), &data, sizeof (data));
+  }
+}
+
+void
+SoftwareOpenGLContext::draw (GLsizei count, GLint first, GLenum type, std::size_t offset)
+{
+  auto found = m_programs.find (m_program);
+  if (count < 3 || m_framebuffer != 0 || found == m_programs.end ()
+      || found->second.shading == UNKNOWN_SHADING)
+    return;
+  const ProgramState& program = found->second;
+
+  DrawState state;
+  state.shading = program.shading;
+  state.clustered = program.clustered;
+  state.directionalLights = program.directionalLights;
+  const std::vector<GLfloat>* materialIndex = getUniform ("uMaterialIndex");
+  state.materialIndex = (materialIndex != nullptr)
+    ? toIndex ((*materialIndex)[0], MAX_MATERIALS) : 0;
+  if (state.shading == AMBIENT_SHADING || state.shading == PHONG_SHADING)
+    state.lighting = getLighting ();
+  state.depthTest = m_depthTest;
+  state.depthFunc = m_depthFunc;
+
+  // Gather the indices.
+  const VertexArray& array = m_vertexArrays[m_vertexArray];
+  m_indices.resize (count);
+  if (type == 0)
+  {
+    for (GLsizei i = 0; i < count; ++i)
+      m_indices[i] = first + i;
+  }
+  else
+  {
+    std::size_t indexSize = (type == GL_UNSIGNED_INT) ? 4 : (type == GL_UNSIGNED_SHORT) ? 2 : 1;
+    auto elements = m_buffers.find (array.elementBuffer);
+    if (elements == m_buffers.end () || offset + count * indexSize > elements->second.size ())
+      return;
+    const unsigned char* bytes = elements->second.data () + offset;
+    for (GLsizei i = 0; i < count; ++i)
+    {
+      if (type == GL_UNSIGNED_INT)
+        std::memcpy (&m_indices[i], bytes + 4 * i, 4);
+      else if (type == GL_UNSIGNED_SHORT)
+      {
+        GLushort index;
+        std::memcpy (&index, bytes + 2 * i, 2);
+        m_indices[i] = index;
+      }
+      else
+        m_indices[i] = bytes[i];
+      m_indices[i] += first;
+    }
+  }
+  GLuint low = *std::min_element (m_indices.begin (), m_indices.end ());
+  GLuint high = *std::max_element (m_indices.begin (), m_indices.end ());
+
+  // The uniforms the vertex shaders read.  Unset ones are zero, as in
+  //   OpenGL, except the two Vec3Norm.vert gives defaults.
+  static const GLfloat ZERO[16] = { };
+  static const GLfloat LIGHT_DIRECTION[3] = { 0.0f, 0.0f, 1.0f };
+  static const GLfloat LIGHT_INTENSITY[3] = { 0.5f, 0.2f, 0.1f };
+  auto uniform = [this] (const char* name, std::size_t size, const GLfloat* fallback)
+  {
+    const std::vector<GLfloat>* value = getUniform (name);
+    return (value != nullptr && value->size () >= size) ? value->data () : fallback;
+  };
+  const GLfloat* modelViewProjection = uniform ("uModelViewProjection", 16, ZERO);
+  const GLfloat* modelView = uniform ("uModelView", 16, ZERO);
+  const GLfloat* normalMatrix = uniform ("uNormalMatrix", 9, ZERO);
+  Vector3 lightDirection = unit (toVector (uniform ("uLightDirection", 3, LIGHT_DIRECTION)));
+  Vector3 lightIntensity = toVector (uniform ("uLightIntensity", 3, LIGHT_INTENSITY));
+  Vector3 ambient (0.0f);
+  if (state.lighting != nullptr)
+  {
+    // Per vertex, but the same for every vertex.
+    const MaterialBlockEntry& material = state.lighting->materials.materials[state.materialIndex];
+    ambient = multiply (toVector (material.ambientReflection),
+                        toVector (state.lighting->camera.ambientIntensity))
+      + toVector (material.emissiveIntensity);
+  }
+
+  // Where each attribute (position, color, normal) is read from.
+  const GLuint POSITION = 0, COLOR = 1, NORMAL = 2;
+  const unsigned char* attribData[3] = { nullptr, nullptr, nullptr };
+  std::size_t attribSize[3] = { 0, 0, 0 };
+  for (GLuint a = 0; a < 3; ++a)
+  {
+    auto buffer = m_buffers.find (array.attribs[a].buffer);
+    if (!array.attribs[a].enabled || buffer == m_buffers.end ())
+      continue;
+    attribData[a] = buffer->second.data ();
+    attribSize[a] = buffer->second.size ();
+  }
+
+  // Shade each vertex the indices use once.
+  m_shaded.resize (high - low + 1);
+  for (GLuint index = low; index <= high; ++index)
+  {
+    float attribs[3][4] = { { 0, 0, 0, 1 }, { 0, 0, 0, 1 }, { 0, 0, 0, 1 } };
+    for (GLuint a = 0; a < 3; ++a)
+    {
+      const VertexAttrib& attrib = array.attribs[a];
+      std::size_t start = attrib.offset + static_cast<std::size_t> (attrib.stride) * index;
+      if (attribData[a] != nullptr && start + attrib.size * sizeof (float) <= attribSize[a])
+        std::memcpy (attribs[a], attribData[a] + start, attrib.size * sizeof (float));
+    }
+
+    ShadedVertex& vertex = m_shaded[index - low];
+    transformPoint (modelViewProjection, attribs[POSITION], vertex.clip);
+    std::fill (vertex.varyings, vertex.varyings + VARYING_COUNT, 0.0f);
+    switch (state.shading)
+    {
+    case COLOR_SHADING:
+      std::copy (attribs[COLOR], attribs[COLOR] + 3, vertex.varyings);
+      break;
+    case NORMAL_SHADING:
+    {
+      Vector3 normalEye = unit (transformVector (normalMatrix, attribs[NORMAL]));
+      float brightness = std::min (std::max (normalEye.dot (lightDirection), 0.0f), 1.0f);
+      Vector3 color = brightness * lightIntensity;
+      vertex.varyings[0] = color.m_x;
+      vertex.varyings[1] = color.m_y;
+      vertex.varyings[2] = color.m_z;
+      break;
+    }
+    default:
+    {
+      float positionEye[4];
+      transformPoint (modelView, attribs[POSITION], positionEye);
+      Vector3 normalEye = unit (transformVector (normalMatrix, attribs[NORMAL]));
+      const float varyings[VARYING_COUNT] = {
+        std::min (std::max (ambient.m_x, 0.0f), 1.0f),
+        std::min (std::max (ambient.m_y, 0.0f), 1.0f),
+        std::min (std::max (ambient.m_z, 0.0f), 1.0f),
+        positionEye[0], positionEye[1], positionEye[2],
+        normalEye.m_x, normalEye.m_y, normalEye.m_z
+      };
+      std::copy (varyings, varyings + VARYING_COUNT, vertex.varyings);
+      break;
+    }
+    }
+  }
+
+  m_draws.push_back (state);
+  for (GLsizei i = 0; i + 2 < count; i += 3)
+    clipTriangle (m_shaded[m_indices[i] - low], m_shaded[m_indices[i + 1] - low],
+                  m_shaded[m_indices[i + 2] - low]);
+}
+
+void
+SoftwareOpenGLContext::clipTriangle (const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c)
+{
+  const ShadedVertex* corners[3] = { &a, &b, &c };
+  auto distance = [] (const ShadedVertex& vertex, int plane)
+  {
+    return CLIP_PLANES[plane][0] * vertex.clip[0] + CLIP_PLANES[plane][1] * vertex.clip[1]
+      + CLIP_PLANES[plane][2] * vertex.clip[2] + CLIP_PLANES[plane][3] * vertex.clip[3];
+  };
+  int outside[3] = { 0, 0, 0 };
+  for (int corner = 0; corner < 3; ++corner)
+    for (int plane = 0; plane < 6; ++plane)
+      if (distance (*corners[corner], plane) < 0.0f)
+        outside[corner] |= 1 << plane;
+  if ((outside[0] | outside[1] | outside[2]) == 0)
+  {
+    binTriangle (a, b, c);
+    return;
+  }
+  if ((outside[0] & outside[1] & outside[2]) != 0)
+    return;
+
+  // Sutherland-Hodgman, against only the planes some corner is outside of.
+  ShadedVertex polygons[2][MAX_CLIPPED];
+  int current = 0;
+  int count = 3;
+  for (int corner = 0; corner < 3; ++corner)
+    polygons[current][corner] = *corners[corner];
+  for (int plane = 0; plane < 6 && count >= 3; ++plane)
+  {
+    if (((outside[0] | outside[1] | outside[2]) & (1 << plane)) == 0)
+      continue;
+    const ShadedVertex* in = polygons[current];
+    ShadedVertex* out = polygons[1 - current];
+    int kept = 0;
+    for (int i = 0; i < count; ++i)
+    {
+      const ShadedVertex& start = in[i];
+      const ShadedVertex& end = in[(i + 1) % count];
+      float startDistance = distance (start, plane);
+      float endDistance = distance (end, plane);
+      if (startDistance >= 0.0f)
+        out[kept++] = start;
+      if ((startDistance >= 0.0f) != (endDistance >= 0.0f))
+      {
+        float t = startDistance / (startDistance - endDistance);
+        ShadedVertex& crossing = out[kept++];
+        for (int n = 0; n < 4; ++n)
+          crossing.clip[n] = start.clip[n] + t * (end.clip[n] - start.clip[n]);
+        for (int n = 0; n < VARYING_COUNT; ++n)
+          crossing.varyings[n] = start.varyings[n] + t * (end.varyings[n] - start.varyings[n]);
+      }
+    }
+    count = kept;
+    current = 1 - current;
+  }
+  for (int i = 1; i + 1 < count; ++i)
+    binTriangle (polygons[current][0], polygons[current][i], polygons[current][i + 1]);
+}
+
+void
+SoftwareOpenGLContext::binTriangle (const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c)
+{
+  // To window coordinates.
+  const ShadedVertex* corners[3] = { &a, &b, &c };
+  float x[3], y[3], z[3], inverseW[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    inverseW[i] = 1.0f / corners[i]->clip[3];
+    x[i] = m_viewport[0] + (corners[i]->clip[0] * inverseW[i] + 1.0f) * 0.5f * m_viewport[2];
+    y[i] = m_viewport[1] + (corners[i]->clip[1] * inverseW[i] + 1.0f) * 0.5f * m_viewport[3];
+    z[i] = (corners[i]->clip[2] * inverseW[i] + 1.0f) * 0.5f;
+  }
+
+  // Twice the signed area, positive if counterclockwise.
+  float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+  if (!(area != 0.0f))
+    return;
+  if (m_cullFace)
+  {
+    bool front = (area > 0.0f) == (m_frontFace == GL_CCW);
+    if (m_cullMode == GL_FRONT_AND_BACK || (m_cullMode == GL_BACK) != front)
+      return;
+  }
+  // Rasterize every triangle counterclockwise, so its inside is where all
+  //   three edge functions are positive.
+  int order[3] = { 0, 1, 2 };
+  if (area < 0.0f)
+  {
+    std::swap (order[1], order[2]);
+    area = -area;
+  }
+
+  Triangle triangle;
+  triangle.depth[0] = triangle.depth[1] = triangle.depth[2] = 0.0f;
+  for (int i = 0; i < 3; ++i)
+  {
+    int from = order[(i + 1) % 3];
+    int to = order[(i + 2) % 3];
+    float dx = x[to] - x[from];
+    float dy = y[to] - y[from];
+    triangle.edgeX[i] = -dy;
+    triangle.edgeY[i] = dx;
+    triangle.edgeC[i] = dy * x[from] - dx * y[from];
+    // With y up and the inside on the left, top edges point left and left
+    //   edges point down.
+    triangle.topLeft[i] = dy < 0.0f || (dy == 0.0f && dx < 0.0f);
+
+    // Edge i's function is the area opposite vertex i, so it weights that
+    //   vertex.
+    const int corner = order[i];
+    triangle.depth[0] += z[corner] * triangle.edgeC[i] / area;
+    triangle.depth[1] += z[corner] * triangle.edgeX[i] / area;
+    triangle.depth[2] += z[corner] * triangle.edgeY[i] / area;
+    triangle.inverseW[i] = inverseW[corner];
+    for (int n = 0; n < VARYING_COUNT; ++n)
+      triangle.varyings[i][n] = corners[corner]->varyings[n] * inverseW[corner];
+  }
+
+  // The pixels whose centers could be inside, within the viewport.
+  GLint lowX = std::max (m_viewport[0], 0);
+  GLint lowY = std::max (m_viewport[1], 0);
+  GLint highX = std::min (m_viewport[0] + m_viewport[2], m_width) - 1;
+  GLint highY = std::min (m_viewport[1] + m_viewport[3], m_height) - 1;
+  triangle.minX = std::max (lowX, static_cast<GLint> (std::ceil (*std::min_element (x, x + 3) - 0.5f)));
+  triangle.minY = std::max (lowY, static_cast<GLint> (std::ceil (*std::min_element (y, y + 3) - 0.5f)));
+  triangle.maxX = std::min (highX, static_cast<GLint> (std::floor (*std::max_element (x, x + 3) - 0.5f)));
+  triangle.maxY = std::min (highY, static_cast<GLint> (std::floor (*std::max_element (y, y + 3) - 0.5f)));
+  if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+    return;
+  triangle.draw = m_draws.size () - 1;
+
+  std::uint32_t index = m_triangles.size ();
+  m_triangles.push_back (triangle);
+  for (GLint tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; ++tileY)
+    for (GLint tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; ++tileX)
+    {
+      // Skip a tile that is wholly outside an edge, which is so if the edge
+      //   is negative even at the tile's pixel center where it is largest.
+      float left = tileX * TILE_SIZE + 0.5f;
+      float bottom = tileY * TILE_SIZE + 0.5f;
+      bool outside = false;
+      for (int i = 0; i < 3 && !outside; ++i)
+        outside = triangle.edgeX[i] * (triangle.edgeX[i] > 0.0f ? left + TILE_SIZE - 1 : left)
+          + triangle.edgeY[i] * (triangle.edgeY[i] > 0.0f ? bottom + TILE_SIZE - 1 : bottom)
+          + triangle.edgeC[i] < 0.0f;
+      if (!outside)
+        m_bins[tileY * m_tilesX + tileX].push_back (index);
+    }
+}
+
+void
+SoftwareOpenGLContext::rasterizeTile (unsigned int tile)
+{
+  GLint tileX = (tile % m_tilesX) * TILE_SIZE;
+  GLint tileY = (tile / m_tilesX) * TILE_SIZE;
+  for (std::uint32_t index : m_bins[tile])
+  {
+    const Triangle& triangle = m_triangles[index];
+    const bool writeDepth = m_draws[triangle.draw].depthTest;
+    GLint minX = std::max (triangle.minX, tileX);
+    GLint maxX = std::min (triangle.maxX, tileX + TILE_SIZE - 1);
+    GLint minY = std::max (triangle.minY, tileY);
+    GLint maxY = std::min (triangle.maxY, tileY + TILE_SIZE - 1);
+    for (GLint y = minY; y <= maxY; ++y)
+    {
+      std::uint32_t* colorRow = &m_color[y * m_stride];
+      float* depthRow = &m_depth[y * m_stride];
+      // Tiles start on a block, so no block is shared by two tiles.
+      for (GLint x = minX & ~3; x <= maxX; x += 4)
+      {
+        float depth[4];
+        int mask = coverBlock (triangle, x, y, depth);
+        // Only the pixels in the triangle's box, within this tile.
+        int first = std::max (minX - x, 0);
+        int last = std::min (maxX - x, 3);
+        mask &= ((2 << last) - 1) & ~((1 << first) - 1);
+        for (int k = 0; mask != 0; ++k, mask >>= 1)
+        {
+          if ((mask & 1) == 0)
+            continue;
+          colorRow[x + k] = shadeFragment (triangle, x + k, y);
+          if (writeDepth)
+            depthRow[x + k] = depth[k];
+        }
+      }
+    }
+  }
+}
+
+int
+SoftwareOpenGLContext::coverBlock (const Triangle& triangle, GLint x, GLint y, float depth[4]) const
+{
+  const DrawState& draw = m_draws[triangle.draw];
+  const float* stored = &m_depth[y * m_stride + x];
+  const float py = y + 0.5f;
+#ifdef __SSE2__
+  // The four pixel centers' x, then each edge function at all four at once.
+  const __m128 px = _mm_add_ps (_mm_set1_ps (static_cast<float> (x)),
+                                _mm_set_ps (3.5f, 2.5f, 1.5f, 0.5f));
+  const __m128 zero = _mm_setzero_ps ();
+  __m128 inside = _mm_cmpeq_ps (zero, zero);
+  for (int i = 0; i < 3; ++i)
+  {
+    __m128 edge = _mm_add_ps (_mm_mul_ps (_mm_set1_ps (triangle.edgeX[i]), px),
+                              _mm_set1_ps (triangle.edgeY[i] * py + triangle.edgeC[i]));
+    inside = _mm_and_ps (inside, triangle.topLeft[i] ? _mm_cmpge_ps (edge, zero)
+                                                     : _mm_cmpgt_ps (edge, zero));
+  }
+  __m128 z = _mm_add_ps (_mm_mul_ps (_mm_set1_ps (triangle.depth[1]), px),
+                         _mm_set1_ps (triangle.depth[2] * py + triangle.depth[0]));
+  _mm_storeu_ps (depth, z);
+  int mask = _mm_movemask_ps (inside);
+  if (mask == 0 || !draw.depthTest)
+    return mask;
+
+  __m128 old = _mm_loadu_ps (stored);
+  __m128 pass;
+  switch (draw.depthFunc)
+  {
+  case GL_NEVER:
+    return 0;
+  case GL_LESS:
+    pass = _mm_cmplt_ps (z, old);
+    break;
+  case GL_EQUAL:
+    pass = _mm_cmpeq_ps (z, old);
+    break;
+  case GL_LEQUAL:
+    pass = _mm_cmple_ps (z, old);
+    break;
+  case GL_GREATER:
+    pass = _mm_cmpgt_ps (z, old);
+    break;
+  case GL_NOTEQUAL:
+    pass = _mm_cmpneq_ps (z, old);
+    break;
+  case GL_GEQUAL:
+    pass = _mm_cmpge_ps (z, old);
+    break;
+  default:
+    return mask;
+  }
+  return mask & _mm_movemask_ps (pass);
+#else
+  int mask = 0;
+  for (int k = 0; k < 4; ++k)
+  {
+    float px = x + k + 0.5f;
+    bool inside = true;
+    for (int i = 0; i < 3; ++i)
+    {
+      float edge = triangle.edgeX[i] * px + (triangle.edgeY[i] * py + triangle.edgeC[i]);
+      inside = inside && (triangle.topLeft[i] ? edge >= 0.0f : edge > 0.0f);
+    }
+    depth[k] = triangle.depth[1] * px + (triangle.depth[2] * py + triangle.depth[0]);
+    if (inside && (!draw.depthTest || passesDepth (draw.depthFunc, depth[k], stored[k])))
+      mask |= 1 << k;
+  }
+  return mask;
+#endif
+}
+
+std::uint32_t
+SoftwareOpenGLContext::shadeFragment (const Triangle& triangle, GLint x, GLint y) const
+{
+  // Perspective-correct interpolation: the outputs were divided by w, so
+  //   weighting them by the edge functions and dividing by the same
+  //   weighting of 1 / w undoes it.
+  const float px = x + 0.5f;
+  const float py = y + 0.5f;
+  float weights[3];
+  float total = 0.0f;
+  for (int i = 0; i < 3; ++i)
+  {
+    weights[i] = std::max (triangle.edgeX[i] * px + triangle.edgeY[i] * py + triangle.edgeC[i], 0.0f);
+    total += weights[i] * triangle.inverseW[i];
+  }
+  float in[VARYING_COUNT];
+  for (int n = 0; n < VARYING_COUNT; ++n)
+    in[n] = (weights[0] * triangle.varyings[0][n] + weights[1] * triangle.varyings[1][n]
+             + weights[2] * triangle.varyings[2][n]) / total;
+
+  const DrawState& draw = m_draws[triangle.draw];
+  if (draw.shading != PHONG_SHADING)
+    return pack (in[0], in[1], in[2], 1.0f);
+
+  // PhongShader.frag.
+  const Lighting& lighting = *draw.lighting;
+  const MaterialBlockEntry& material = lighting.materials.materials[draw.materialIndex];
+  Vector3 color (in[0], in[1], in[2]);
+  Vector3 position (in[3], in[4], in[5]);
+  Vector3 normal (in[6], in[7], in[8]);
+  const LightBlock& block = lighting.lights;
+  GLint lights = std::min<GLint> (std::max (block.numLights, 0), MAX_LIGHTS);
+  if (draw.clustered)
+  {
+    // Directional lights reach everything, so they stay in the light block.
+    GLint directional = (draw.directionalLights >= 0)
+      ? std::min<GLint> (draw.directionalLights, MAX_LIGHTS) : lights;
+    for (GLint i = 0; i < directional; ++i)
+      if (draw.directionalLights >= 0 || block.lights[i].type == 0)
+        color += calculateDirectional (block.lights[i], material, position, normal);
+    color += calculateClustered (lighting.camera, lighting.clusterBlock, lighting.clusterGrid,
+                                 lighting.clusterIndices, lighting.clusterLights, material,
+                                 position, normal);
+  }
+  else
+  {
+    // The variants specialized on the Scene's light counts loop over the
+    //   same lights, in the same order.
+    for (GLint i = 0; i < lights; ++i)
+      color += calculateLighting (block.lights[i], material, position, normal);
+  }
+  return pack (color.m_x, color.m_y, color.m_z, 1.0f);
+}
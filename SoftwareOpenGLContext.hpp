@@ -0,0 +1,621 @@
+/// \file SoftwareOpenGLContext.hpp
+/// \brief Declaration of SoftwareOpenGLContext and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef SOFTWARE_OPENGL_CONTEXT_HPP
+#define SOFTWARE_OPENGL_CONTEXT_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NullOpenGLContext.hpp"
+#include "UniformBuffer.hpp"
+
+class JobSystem;
+
+/// \brief A subclass of OpenGLContext that renders on the CPU, into a color
+///   and depth buffer in memory, so that frames can be checked (or saved as
+///   images) on a machine without a GPU or a window.
+///
+/// It implements the part of OpenGL this engine draws with: buffers (which
+///   can be mapped, persistently and coherently, since nothing is drawn
+///   after the draw call returns but the triangles it binned), vertex
+///   arrays of float attributes (set up through the bindings or by direct
+///   state access), indexed and non-indexed triangles (including
+///   glMultiDrawElementsIndirect, with the per-draw data of "uDrawData"),
+///   the viewport, the depth test, and back-face culling.  Shaders aren't
+///   compiled; instead each program is recognized by its sources as one of
+///   the engine's own (Vec3, Vec3Norm, GeneralShader, or PhongShader), and
+///   drawn with a C++ port of it, reading its uniforms and uniform blocks
+///   and, for clustered lighting, its texture buffers.  Likewise, the one
+///   compute shader, CullDraws.comp, is dispatched as a C++ port that reads
+///   and writes its shader storage buffers, and
+///   glMultiDrawElementsIndirectCount reads its count from
+///   GL_PARAMETER_BUFFER; since every call finishes before it returns,
+///   memory barriers are not needed.  Draws into a
+///   framebuffer other than the default one, and with the deferred lighting
+///   variant, are skipped, so only forward shading renders.  Everything else
+///   behaves as in NullOpenGLContext.
+///
+/// Drawing only transforms the vertices and bins the triangles into square
+///   tiles of the screen.  The tiles are rasterized by flush () (which
+///   clear (), readPixel (), and savePPM () call first), in parallel across
+///   a JobSystem, each tile's triangles in the order they were drawn.
+class SoftwareOpenGLContext : public NullOpenGLContext
+{
+public:
+
+  /// \brief Constructs a SoftwareOpenGLContext.
+  /// \param[in] width The width of the framebuffer, in pixels.
+  /// \param[in] height The height of the framebuffer, in pixels.
+  /// \param[in] jobs The workers to rasterize tiles on, or nullptr to
+  ///   rasterize them on the calling thread.
+  /// \post The viewport covers the framebuffer, which is black, and every
+  ///   depth is 1.
+  SoftwareOpenGLContext (GLsizei width, GLsizei height, JobSystem* jobs = nullptr);
+
+  /// Destructs a SoftwareOpenGLContext.
+  virtual
+  ~SoftwareOpenGLContext ();
+
+  /// Copy constructor deleted because you should not be copying
+  ///   SoftwareOpenGLContexts.
+  SoftwareOpenGLContext (const SoftwareOpenGLContext&) = delete;
+
+  /// Assignment operator deleted because you should not be assigning
+  ///   SoftwareOpenGLContexts.
+  SoftwareOpenGLContext&
+  operator= (const SoftwareOpenGLContext&) = delete;
+
+  /// \brief Rasterizes every triangle drawn since the last flush.
+  /// \post The framebuffer holds everything drawn, and no tile has any
+  ///   triangles waiting.
+  void
+  flush ();
+
+  /// \brief Gets the color of one pixel.
+  /// \param[in] x The pixel's column, from the left.
+  /// \param[in] y The pixel's row, from the bottom (as in OpenGL).
+  /// \param[out] rgb Where to write its red, green, and blue.
+  /// \pre The pixel is inside the framebuffer.
+  void
+  readPixel (GLint x, GLint y, GLubyte rgb[3]);
+
+  /// \brief Gets the depth of one pixel.
+  /// \param[in] x The pixel's column, from the left.
+  /// \param[in] y The pixel's row, from the bottom.
+  /// \return Its depth, from 0 (near) to 1 (far, or nothing drawn).
+  /// \pre The pixel is inside the framebuffer.
+  GLfloat
+  readDepth (GLint x, GLint y);
+
+  /// \brief Writes the color buffer to a binary PPM image, top row first.
+  /// \param[in] path The file's path.
+  /// \return Whether or not it was written.
+  bool
+  savePPM (const std::string& path);
+
+  /// \brief Gets the number of triangles rasterized, after culling and
+  ///   clipping.
+  /// \return The count since construction.
+  unsigned long
+  getTriangleCount () const;
+
+  virtual void
+  activeTexture (GLenum texture);
+
+  virtual void
+  bindBuffer (GLenum target, GLuint buffer);
+
+  virtual void
+  bindBufferBase (GLenum target, GLuint index, GLuint buffer);
+
+  virtual void
+  bindFramebuffer (GLenum target, GLuint framebuffer);
+
+  virtual void
+  bindTexture (GLenum target, GLuint texture);
+
+  virtual void
+  bindVertexArray (GLuint array);
+
+  virtual void
+  bufferData (GLenum target, GLsizeiptr size, const GLvoid* data, GLenum usage);
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data);
+
+  virtual void
+  clear (GLbitfield mask);
+
+  virtual void
+  clearColor (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+
+  virtual void
+  createBuffers (GLsizei n, GLuint* buffers);
+
+  virtual void
+  createVertexArrays (GLsizei n, GLuint* arrays);
+
+  virtual void
+  cullFace (GLenum mode);
+
+  virtual void
+  deleteBuffers (GLsizei n, const GLuint* buffers);
+
+  virtual void
+  deleteProgram (GLuint program);
+
+  virtual void
+  deleteTextures (GLsizei n, const GLuint* textures);
+
+  virtual void
+  deleteVertexArrays (GLsizei n, const GLuint* arrays);
+
+  virtual void
+  depthFunc (GLenum func);
+
+  virtual void
+  dispatchCompute (GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count);
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices);
+
+  virtual void
+  enable (GLenum cap);
+
+  virtual void
+  enableVertexArrayAttrib (GLuint vaobj, GLuint index);
+
+  virtual void
+  enableVertexAttribArray (GLuint index);
+
+  virtual void
+  frontFace (GLenum mode);
+
+  virtual const GLubyte*
+  getString (GLenum name);
+
+  virtual void
+  linkProgram (GLuint program);
+
+  virtual void*
+  mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access);
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride);
+
+  virtual void
+  multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect, GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride);
+
+  virtual void
+  namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage);
+
+  virtual void
+  namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags);
+
+  virtual void
+  namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+  virtual void
+  texBuffer (GLenum target, GLenum internalformat, GLuint buffer);
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0);
+
+  virtual void
+  uniform1i (GLint location, GLint v0);
+
+  virtual void
+  uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2);
+
+  virtual void
+  uniformBlockBinding (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding);
+
+  virtual void
+  uniformMatrix3fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value);
+
+  virtual GLboolean
+  unmapNamedBuffer (GLuint buffer);
+
+  virtual void
+  useProgram (GLuint program);
+
+  virtual void
+  vertexArrayAttribBinding (GLuint vaobj, GLuint attribindex, GLuint bindingindex);
+
+  virtual void
+  vertexArrayAttribFormat (GLuint vaobj, GLuint attribindex, GLint size, GLenum type, GLboolean normalized, GLuint relativeoffset);
+
+  virtual void
+  vertexArrayElementBuffer (GLuint vaobj, GLuint buffer);
+
+  virtual void
+  vertexArrayVertexBuffer (GLuint vaobj, GLuint bindingindex, GLuint buffer, GLintptr offset, GLsizei stride);
+
+  virtual void
+  vertexAttribPointer (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const GLvoid* pointer);
+
+  virtual void
+  viewport (GLint x, GLint y, GLsizei width, GLsizei height);
+
+  /// The number of vertex attributes a vertex array has.
+  static const GLuint MAX_VERTEX_ATTRIBS = 8;
+
+  /// The width and height of a tile, in pixels.  A multiple of 4, so each
+  ///   row of a tile is made of whole blocks of pixels.
+  static const GLint TILE_SIZE = 64;
+
+  /// The number of floats a vertex passes to the fragment shader: a color,
+  ///   and an eye-space position and normal.
+  static const int VARYING_COUNT = 9;
+
+private:
+
+  /// \brief Which of the engine's shaders a program is.
+  enum Shading
+  {
+    /// Not one this context can draw; its draws are skipped.
+    UNKNOWN_SHADING,
+    /// Vec3.vert: the color attribute, unlit.
+    COLOR_SHADING,
+    /// Vec3Norm.vert: lit by one directional light, per vertex.
+    NORMAL_SHADING,
+    /// GeneralShader: the material's ambient and emissive light only.
+    AMBIENT_SHADING,
+    /// PhongShader: lit by the light block (or clusters), per pixel.
+    PHONG_SHADING
+  };
+
+  /// \brief One vertex attribute of a vertex array.
+  struct VertexAttrib
+  {
+    /// Whether or not it is read from a buffer.
+    bool enabled;
+    /// The number of components, 1 to 4.
+    GLint size;
+    /// Its offset within a vertex of its binding, in bytes.
+    std::size_t relativeOffset;
+    /// The buffer binding it is read through.
+    GLuint binding;
+    /// The bytes from one vertex to the next, from its binding.
+    GLsizei stride;
+    /// The offset of the first vertex's, in bytes: its binding's offset
+    ///   plus relativeOffset.
+    std::size_t offset;
+    /// The buffer it is read from, from its binding.
+    GLuint buffer;
+  };
+
+  /// \brief One buffer binding of a vertex array, which attributes read
+  ///   through.
+  struct VertexBinding
+  {
+    /// The buffer.
+    GLuint buffer;
+    /// The offset of the first vertex, in bytes.
+    std::size_t offset;
+    /// The bytes from one vertex to the next.
+    GLsizei stride;
+  };
+
+  /// \brief A vertex array object.
+  struct VertexArray
+  {
+    /// \brief Constructs a VertexArray with every attribute disabled and
+    ///   read through the binding of the same index, and no buffers.
+    VertexArray ();
+
+    /// Its attributes, by index.
+    VertexAttrib attribs[MAX_VERTEX_ATTRIBS];
+    /// Its buffer bindings, by index.
+    VertexBinding bindings[MAX_VERTEX_ATTRIBS];
+    /// The buffer its indices are read from.
+    GLuint elementBuffer;
+  };
+
+  /// \brief What a program needs in order to be drawn.
+  struct ProgramState
+  {
+    /// Which shader it is.
+    Shading shading;
+    /// Whether or not its fragment shader reads the lights from clusters.
+    bool clustered;
+    /// The number of directional lights it was specialized for, or -1 if it
+    ///   loops over the light block.
+    GLint directionalLights;
+    /// The value of each uniform set on it, by location (up to a mat4).
+    std::map<GLint, std::vector<GLfloat>> values;
+    /// The binding point of each of its uniform blocks, by index.
+    std::map<GLuint, GLuint> blockBindings;
+    /// Whether or not it is the culling compute shader.
+    bool cullsDraws;
+  };
+
+  /// \brief Everything a lit draw reads from uniform blocks and texture
+  ///   buffers, copied when it is drawn (and shared by the draws after it,
+  ///   until something it was copied from changes).
+  struct Lighting
+  {
+    /// The camera block.
+    CameraBlock camera;
+    /// The light block.
+    LightBlock lights;
+    /// The material block.
+    MaterialBlock materials;
+    /// The cluster block.
+    ClusterBlock clusterBlock;
+    /// Each cluster's first index and light count.
+    std::vector<GLuint> clusterGrid;
+    /// The clusters' light indices.
+    std::vector<GLuint> clusterIndices;
+    /// The clustered lights.
+    std::vector<LightBlockEntry> clusterLights;
+    /// Where each of those was copied from: the four blocks' binding points
+    ///   and the three texture buffers' units.
+    GLint sources[7];
+  };
+
+  /// \brief The state one draw's fragments are shaded with.
+  struct DrawState
+  {
+    /// Which shader.
+    Shading shading;
+    /// Whether or not the lights come from clusters.
+    bool clustered;
+    /// The number of directional lights, or -1 for every light.
+    GLint directionalLights;
+    /// The material's index.
+    GLint materialIndex;
+    /// The blocks and buffers, if lit.
+    std::shared_ptr<const Lighting> lighting;
+    /// Whether or not the depth test is on.
+    bool depthTest;
+    /// The depth function.
+    GLenum depthFunc;
+  };
+
+  /// \brief A vertex after the vertex shader.
+  struct ShadedVertex
+  {
+    /// Its clip-space position.
+    float clip[4];
+    /// Its outputs.
+    float varyings[VARYING_COUNT];
+  };
+
+  /// \brief A triangle set up for rasterization, in window coordinates.
+  struct Triangle
+  {
+    /// The edge functions' x coefficients; edge i is opposite vertex i.
+    float edgeX[3];
+    /// The edge functions' y coefficients.
+    float edgeY[3];
+    /// The edge functions' constants, at the window origin.
+    float edgeC[3];
+    /// Whether each edge is a top or left edge, which owns the pixel
+    ///   centers exactly on it.
+    bool topLeft[3];
+    /// The window depth at the origin and its change per pixel in x and y.
+    float depth[3];
+    /// Each vertex's 1 / w.
+    float inverseW[3];
+    /// Each vertex's outputs, divided by its w.
+    float varyings[3][VARYING_COUNT];
+    /// The bounding box of its pixels, inclusive.
+    GLint minX, minY, maxX, maxY;
+    /// The index of its DrawState.
+    std::uint32_t draw;
+  };
+
+  /// \brief Records a program's shader and variant from its sources.
+  /// \param[in] program The program, just linked.
+  void
+  recognizeProgram (GLuint program);
+
+  /// \brief Gets the buffer bound to a target.
+  /// \param[in] target The target.
+  /// \return Its name, or 0.
+  GLuint
+  getBoundBuffer (GLenum target) const;
+
+  /// \brief Copies an attribute's binding into the attribute, for drawing.
+  /// \param[in,out] array The vertex array.
+  /// \param[in] index The attribute's index.
+  static void
+  updateAttrib (VertexArray& array, GLuint index);
+
+  /// \brief Sets the contents of a buffer.
+  /// \param[in] buffer The buffer.
+  /// \param[in] size The new size, in bytes.
+  /// \param[in] data The contents, or nullptr for zeros.
+  void
+  storeBuffer (GLuint buffer, GLsizeiptr size, const void* data);
+
+  /// \brief Replaces part of the contents of a buffer.
+  /// \param[in] buffer The buffer.
+  /// \param[in] offset The offset of the part, in bytes.
+  /// \param[in] size The size of the part, in bytes.
+  /// \param[in] data The new contents of the part.
+  void
+  storeBufferPart (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data);
+
+  /// \brief Gets a uniform of the program in use.
+  /// \param[in] name Its name.
+  /// \return Its value, or nullptr if it was never set (or isn't declared).
+  const std::vector<GLfloat>*
+  getUniform (const char* name);
+
+  /// \brief Stores a uniform of the program in use.
+  /// \param[in] location Its location.
+  /// \param[in] value Its components.
+  /// \param[in] count The number of components.
+  void
+  setUniform (GLint location, const GLfloat* value, std::size_t count);
+
+  /// \brief Copies the contents of a buffer into a block, padding with
+  ///   zeros.
+  /// \param[in] buffer The buffer.
+  /// \param[out] block The block.
+  /// \param[in] size The size of the block.
+  void
+  readBuffer (GLuint buffer, void* block, std::size_t size) const;
+
+  /// \brief Gets the buffer behind the texture buffer a sampler reads.
+  /// \param[in] sampler The sampler uniform's name.
+  /// \param[out] unit The unit it reads, or -1.
+  /// \return The buffer's name, or 0.
+  GLuint
+  getSamplerBuffer (const char* sampler, GLint& unit);
+
+  /// \brief Gets the blocks and buffers the program in use reads, copying
+  ///   them if they changed.
+  /// \return The copy.
+  std::shared_ptr<const Lighting>
+  getLighting ();
+
+  /// \brief Gets the buffer bound to a shader storage binding point.
+  /// \param[in] index The binding point.
+  /// \return The buffer's contents, or nullptr if none is bound.
+  std::vector<unsigned char>*
+  getStorageBuffer (GLuint index);
+
+  /// \brief Runs the culling compute shader (CullDraws.comp) over its
+  ///   objects.
+  /// \param[in] invocations The number of invocations dispatched.
+  void
+  cullDraws (GLuint invocations);
+
+  /// \brief Draws triangles: shades their vertices, then clips, culls,
+  ///   and bins them.
+  /// \param[in] count The number of vertices.
+  /// \param[in] first The first vertex, if not indexed, or the base vertex
+  ///   added to every index, if indexed.
+  /// \param[in] type The type of the indices, or 0 if not indexed.
+  /// \param[in] offset The offset of the first index in the element buffer.
+  void
+  draw (GLsizei count, GLint first, GLenum type, std::size_t offset);
+
+  /// \brief Clips a triangle in clip space and sets up and bins what is left.
+  /// \param[in] a The first vertex.
+  /// \param[in] b The second vertex.
+  /// \param[in] c The third vertex.
+  void
+  clipTriangle (const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c);
+
+  /// \brief Culls a clipped triangle, sets it up, and adds it to every tile
+  ///   it might cover.
+  /// \param[in] a The first vertex.
+  /// \param[in] b The second vertex.
+  /// \param[in] c The third vertex.
+  void
+  binTriangle (const ShadedVertex& a, const ShadedVertex& b, const ShadedVertex& c);
+
+  /// \brief Rasterizes the triangles binned into one tile.
+  /// \param[in] tile The tile's index.
+  void
+  rasterizeTile (unsigned int tile);
+
+  /// \brief Finds which pixels of a block of four, in one row, a triangle
+  ///   covers and passes the depth test at.
+  /// \param[in] triangle The triangle.
+  /// \param[in] x The block's first column, a multiple of 4.
+  /// \param[in] y The row.
+  /// \param[out] depth The triangle's depth at each pixel.
+  /// \return A bit for each pixel that passes, the first pixel lowest.
+  int
+  coverBlock (const Triangle& triangle, GLint x, GLint y, float depth[4]) const;
+
+  /// \brief Shades one pixel of a triangle.
+  /// \param[in] triangle The triangle.
+  /// \param[in] x The pixel's column.
+  /// \param[in] y The pixel's row.
+  /// \return The color, packed as in the color buffer.
+  std::uint32_t
+  shadeFragment (const Triangle& triangle, GLint x, GLint y) const;
+
+  /// The width of the framebuffer.
+  GLsizei m_width;
+  /// The height of the framebuffer.
+  GLsizei m_height;
+  /// The workers to rasterize on, or nullptr.
+  JobSystem* m_jobs;
+  /// The pixels from one row of the buffers to the next: the width, rounded
+  ///   up to whole blocks of 4, so no block spans two rows.
+  GLsizei m_stride;
+  /// The color buffer, bottom row first, one 0xAABBGGRR per pixel.
+  std::vector<std::uint32_t> m_color;
+  /// The depth buffer, laid out like m_color.
+  std::vector<GLfloat> m_depth;
+  /// The number of tiles across.
+  GLint m_tilesX;
+  /// The number of tiles down.
+  GLint m_tilesY;
+  /// The triangles binned into each tile, in order, by index.
+  std::vector<std::vector<std::uint32_t>> m_bins;
+  /// The triangles waiting to be rasterized.
+  std::vector<Triangle> m_triangles;
+  /// The state of every draw waiting to be rasterized.
+  std::vector<DrawState> m_draws;
+  /// The indices of the draw being made.
+  std::vector<GLuint> m_indices;
+  /// The vertices of the draw being made, after the vertex shader.
+  std::vector<ShadedVertex> m_shaded;
+  /// The number of triangles rasterized.
+  unsigned long m_triangleCount;
+
+  /// The contents of every buffer, by name.
+  std::map<GLuint, std::vector<unsigned char>> m_buffers;
+  /// The buffer bound to each target (but the element array buffer).
+  std::map<GLenum, GLuint> m_bufferBindings;
+  /// The buffer bound to each uniform block binding point.
+  std::map<GLuint, GLuint> m_uniformBindings;
+  /// The buffer bound to each shader storage binding point.
+  std::map<GLuint, GLuint> m_storageBindings;
+  /// Every vertex array, by name, including the default one, 0.
+  std::map<GLuint, VertexArray> m_vertexArrays;
+  /// The vertex array bound.
+  GLuint m_vertexArray;
+  /// The buffer behind every texture buffer, by texture name.
+  std::map<GLuint, GLuint> m_textureBuffers;
+  /// The texture bound to GL_TEXTURE_BUFFER on each unit.
+  std::map<GLuint, GLuint> m_bufferTextures;
+  /// The active texture unit.
+  GLuint m_activeTexture;
+  /// The framebuffer bound.
+  GLuint m_framebuffer;
+  /// Every program, by name.
+  std::map<GLuint, ProgramState> m_programs;
+  /// The program in use.
+  GLuint m_program;
+  /// The blocks and buffers last copied, or null if they may have changed.
+  std::shared_ptr<const Lighting> m_lighting;
+
+  /// The viewport: x, y, width, height.
+  GLint m_viewport[4];
+  /// The clear color, packed.
+  std::uint32_t m_clearColor;
+  /// Whether or not the depth test is on.
+  bool m_depthTest;
+  /// The depth function.
+  GLenum m_depthFunc;
+  /// Whether or not faces are culled.
+  bool m_cullFace;
+  /// Which faces are culled.
+  GLenum m_cullMode;
+  /// Which winding is front facing.
+  GLenum m_frontFace;
+};
+
+#endif//SOFTWARE_OPENGL_CONTEXT_HPP
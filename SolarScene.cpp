@@ -6,9 +6,10 @@
 #include "SolarScene.hpp"
 #include "ColorsMesh.hpp"
 #include "NormalsMesh.hpp"
+#include "Geometry.hpp"
 
 SolarScene::SolarScene (OpenGLContext* context, ShaderProgram* colorInfo, ShaderProgram* normInfo, ShaderProgram* genInfo, Camera* camera)
-  : Scene::Scene (genInfo, camera)
+  : Scene::Scene (context, genInfo, camera)
 {
   // LIGHT SOURCES
   this->addPointLightSource (Vector3 (0.6f, 0.3f, 0.0f), Vector3 (0.9f, 0.8f, 0.5f), Vector3 (0.0f, 1.0f, 0.0f), Vector3 (0.9f, 0.9f, 0.9f));
@@ -66,6 +67,16 @@ SolarScene::SolarScene (OpenGLContext* context, ShaderProgram* colorInfo, Shader
   this->getMesh ("earth")->scaleLocal (0.4f);
   this->getMesh ("earth")->prepareVao();
 
+  // The moon's transform is relative to the earth's, so it is carried along
+  //   (and swung around) as the earth moves and spins.
+  NormalsMesh* moon = new NormalsMesh (context, genInfo, "models/sol.obj", 0, cyanPlas);
+
+  this->add ("moon", moon);
+  this->setParent ("moon", "earth");
+  this->getMesh ("moon")->moveRight (150.0f);
+  this->getMesh ("moon")->scaleLocal (0.27f);
+  this->getMesh ("moon")->prepareVao();
+
    NormalsMesh* mars = new NormalsMesh (context, genInfo, "models/sol.obj", 0, redRubber);
 
   this->add ("mars", mars);
@@ -140,6 +151,20 @@ NormalsMesh* asteroid3 = new NormalsMesh (context, genInfo, "models/asteroid.obj
   this->getMesh ("asteroid6")->scaleLocal (0.7f);
   this->getMesh ("asteroid6")->prepareVao();
 
+  // The planets are big and solid enough to hide asteroids and moons that
+  //   pass behind them.  A coarse sphere just inside each one stands in for
+  //   its 5000 triangles in the occlusion buffer.
+  const std::vector<Triangle> unitSphere = buildSphere (6, 8);
+  for (const char* planet : { "mercury", "venus", "earth", "mars", "jupiter" })
+  {
+    Mesh* mesh = this->getMesh (planet);
+    std::vector<Triangle> shape = unitSphere;
+    for (Triangle& triangle : shape)
+      for (Vector3& corner : triangle)
+        corner = mesh->getBoundsCenter () + corner * (0.95f * mesh->getBoundsRadius ());
+    mesh->setOccluderShape (shape);
+    this->setOccluder (planet, true);
+  }
 
 }
 
@@ -0,0 +1,44 @@
+/// \file SortKey.cpp
+/// \brief Definition of functions that build and read draw-order sort keys.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <cstring>
+
+#include "SortKey.hpp"
+
+namespace
+{
+  /// Bits given to the depth.
+  const unsigned int DEPTH_BITS = 24;
+  /// Bits given to each of the program and material identifiers.
+  const unsigned int ID_BITS = 20;
+  /// Masks an identifier down to ID_BITS.
+  const uint64_t ID_MASK = (uint64_t (1) << ID_BITS) - 1;
+}
+
+uint64_t
+makeSortKey (unsigned int programId, unsigned int materialId, float viewDepth)
+{
+  // Non-negative floats compare the same way as their bit patterns, so the
+  //   exponent and the top of the mantissa make a cheap, scale-free depth.
+  viewDepth = std::max (viewDepth, 0.0f);
+  uint32_t bits;
+  std::memcpy (&bits, &viewDepth, sizeof (bits));
+  uint64_t depth = bits >> (31 - DEPTH_BITS);
+  return ((programId & ID_MASK) << (ID_BITS + DEPTH_BITS))
+    | ((materialId & ID_MASK) << DEPTH_BITS) | depth;
+}
+
+unsigned int
+getSortKeyProgram (uint64_t key)
+{
+  return static_cast<unsigned int> ((key >> (ID_BITS + DEPTH_BITS)) & ID_MASK);
+}
+
+unsigned int
+getSortKeyMaterial (uint64_t key)
+{
+  return static_cast<unsigned int> ((key >> DEPTH_BITS) & ID_MASK);
+}
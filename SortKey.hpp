@@ -0,0 +1,38 @@
+/// \file SortKey.hpp
+/// \brief Declaration of functions that build and read draw-order sort keys.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef SORT_KEY_HPP
+#define SORT_KEY_HPP
+
+#include <cstdint>
+
+/// \brief Packs the state a draw needs into one integer, so that sorting the
+///   integers groups draws that share a shader program, then draws that share
+///   a material, and orders each group front to back.
+/// \param[in] programId The shader program's identifier.  Only the low 20
+///   bits are used.
+/// \param[in] materialId A small integer that identifies the material.  Only
+///   the low 20 bits are used.
+/// \param[in] viewDepth The distance of the object in front of the camera.
+///   Depths behind the camera are treated as 0.
+/// \return The key: program in the top 20 bits, material in the next 20, and
+///   the top 24 bits of the depth's floating-point representation (which
+///   order the same way as the depths) in the low 24.
+uint64_t
+makeSortKey (unsigned int programId, unsigned int materialId, float viewDepth);
+
+/// \brief Gets the shader program identifier out of a sort key.
+/// \param[in] key A key built by makeSortKey.
+/// \return The low 20 bits of the program identifier it was built with.
+unsigned int
+getSortKeyProgram (uint64_t key);
+
+/// \brief Gets the material identifier out of a sort key.
+/// \param[in] key A key built by makeSortKey.
+/// \return The low 20 bits of the material identifier it was built with.
+unsigned int
+getSortKeyMaterial (uint64_t key);
+
+#endif//SORT_KEY_HPP
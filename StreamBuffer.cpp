@@ -0,0 +1,166 @@
+/// \file StreamBuffer.cpp
+/// \brief Definition of StreamWaitStats and StreamBuffer classes and any
+///   associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "StreamBuffer.hpp"
+
+namespace
+{
+  /// How long one glClientWaitSync may block, in nanoseconds, before the
+  ///   wait is tried again.
+  const GLuint64 WAIT_TIMEOUT = 1000000000;
+
+  /// The flags the storage is made with: written through a persistent,
+  ///   coherent mapping, or with glBufferSubData if it can't be mapped.
+  const GLbitfield STORAGE_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT
+    | GL_MAP_COHERENT_BIT | GL_DYNAMIC_STORAGE_BIT;
+
+  /// The flags the storage is mapped with.
+  const GLbitfield MAP_FLAGS = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+}
+
+const unsigned int StreamBuffer::REGION_COUNT;
+
+StreamBuffer::StreamBuffer (OpenGLContext* context, GLsizeiptr regionSize)
+  : m_context (context), m_buffer (0), m_regionSize (0), m_memory (nullptr),
+    m_copy (), m_fences (), m_region (0), m_used (0), m_flushed (0),
+    m_stats { 0, 0, 0.0, 0.0 }
+{
+  create (regionSize);
+}
+
+StreamBuffer::~StreamBuffer ()
+{
+  destroy ();
+}
+
+void*
+StreamBuffer::allocate (GLsizeiptr size, GLsizeiptr alignment, GLintptr& offset)
+{
+  GLintptr start = m_region * m_regionSize;
+  GLintptr aligned = (start + m_used + alignment - 1) / alignment * alignment;
+  if (size < 0 || aligned + size > start + m_regionSize)
+    return nullptr;
+  if (m_used == 0 && m_fences[m_region] != nullptr)
+    wait (m_region);
+  offset = aligned;
+  m_used = aligned + size - start;
+  if (m_memory != nullptr)
+    return m_memory + aligned;
+  return m_copy.data () + (aligned - start);
+}
+
+void
+StreamBuffer::flush ()
+{
+  if (m_memory == nullptr && m_used > m_flushed)
+    m_context->namedBufferSubData (m_buffer, m_region * m_regionSize + m_flushed,
+                                   m_used - m_flushed, m_copy.data () + m_flushed);
+  m_flushed = m_used;
+}
+
+void
+StreamBuffer::fence ()
+{
+  if (m_used == 0)
+    return;
+  m_fences[m_region] = m_context->fenceSync (GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  m_region = (m_region + 1) % REGION_COUNT;
+  m_used = 0;
+  m_flushed = 0;
+}
+
+void
+StreamBuffer::reserve (GLsizeiptr regionSize)
+{
+  if (regionSize <= m_regionSize)
+    return;
+  destroy ();
+  create (regionSize);
+}
+
+GLuint
+StreamBuffer::getBuffer () const
+{
+  return m_buffer;
+}
+
+GLsizeiptr
+StreamBuffer::getRegionSize () const
+{
+  return m_regionSize;
+}
+
+bool
+StreamBuffer::isMapped () const
+{
+  return m_memory != nullptr;
+}
+
+StreamWaitStats
+StreamBuffer::getWaitStats () const
+{
+  return m_stats;
+}
+
+void
+StreamBuffer::create (GLsizeiptr regionSize)
+{
+  m_regionSize = regionSize;
+  m_context->createBuffers (1, &m_buffer);
+  m_context->namedBufferStorage (m_buffer, REGION_COUNT * m_regionSize, nullptr, STORAGE_FLAGS);
+  m_memory = static_cast<unsigned char*> (
+    m_context->mapNamedBufferRange (m_buffer, 0, REGION_COUNT * m_regionSize, MAP_FLAGS));
+  if (m_memory == nullptr)
+    m_copy.resize (m_regionSize);
+}
+
+void
+StreamBuffer::destroy ()
+{
+  for (unsigned int region = 0; region < REGION_COUNT; ++region)
+  {
+    if (m_fences[region] != nullptr)
+      m_context->deleteSync (m_fences[region]);
+    m_fences[region] = nullptr;
+  }
+  if (m_memory != nullptr)
+    m_context->unmapNamedBuffer (m_buffer);
+  m_context->deleteBuffers (1, &m_buffer);
+  m_memory = nullptr;
+  m_copy.clear ();
+  m_region = 0;
+  m_used = 0;
+  m_flushed = 0;
+}
+
+void
+StreamBuffer::wait (unsigned int region)
+{
+  ++m_stats.fences;
+  // Polling first keeps the common case, a fence long since signaled, from
+  //   being timed or flushing the command queue.
+  GLenum status = m_context->clientWaitSync (m_fences[region], 0, 0);
+  if (status == GL_TIMEOUT_EXPIRED)
+  {
+    using namespace std::chrono;
+    steady_clock::time_point start = steady_clock::now ();
+    while (status == GL_TIMEOUT_EXPIRED)
+      status = m_context->clientWaitSync (m_fences[region], GL_SYNC_FLUSH_COMMANDS_BIT,
+                                          WAIT_TIMEOUT);
+    double millis = duration<double, std::milli> (steady_clock::now () - start).count ();
+    ++m_stats.stalls;
+    m_stats.totalMillis += millis;
+    m_stats.maxMillis = std::max (m_stats.maxMillis, millis);
+  }
+  if (status == GL_WAIT_FAILED)
+    fprintf (stderr, "Waiting on a stream buffer fence failed\n");
+  m_context->deleteSync (m_fences[region]);
+  m_fences[region] = nullptr;
+}
@@ -0,0 +1,168 @@
+/// \file StreamBuffer.hpp
+/// \brief Declaration of StreamWaitStats and StreamBuffer classes and any
+///   associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef STREAM_BUFFER_HPP
+#define STREAM_BUFFER_HPP
+
+#include <vector>
+
+#include "OpenGLContext.hpp"
+
+/// \brief How long a StreamBuffer has waited for the GPU to finish with its
+///   regions.
+struct StreamWaitStats
+{
+  /// The number of fences waited on.
+  unsigned long fences;
+  /// The number of those that weren't signaled yet, so the CPU stalled.
+  unsigned long stalls;
+  /// The time spent stalled, in milliseconds.
+  double totalMillis;
+  /// The longest stall, in milliseconds.
+  double maxMillis;
+};
+
+/// \brief A buffer for data written anew every frame (per-draw matrices,
+///   indirect commands, debug lines, ...), written in place by the CPU
+///   instead of respecified with glBufferData.
+///
+/// Its storage is made once, with glBufferStorage, and mapped once,
+///   persistently and coherently, so allocate () hands out pointers that
+///   the GPU reads from directly: no copies by the driver, and no implicit
+///   synchronization.  The storage is split into REGION_COUNT regions, used
+///   one after the other.  fence () ends the current region with a
+///   glFenceSync and moves on to the next; the first allocate () in a region
+///   waits on the fence that ended it the last time around, so the CPU never
+///   overwrites what the GPU may still be reading.  With three regions, that
+///   wait only stalls when the GPU is more than two frames behind, and every
+///   stall is timed (see getWaitStats).
+///
+/// A context that can't map the buffer (mapNamedBufferRange returns null,
+///   as NullOpenGLContext, RecordingOpenGLContext, and emulated direct state
+///   access do) gets the same interface through a copy of the region in
+///   memory, which flush () uploads with glBufferSubData.
+class StreamBuffer
+{
+public:
+
+  /// The number of regions the storage is split into.
+  static const unsigned int REGION_COUNT = 3;
+
+  /// \brief Constructs a StreamBuffer.
+  /// \param[in] context The context to make OpenGL calls through, which must
+  ///   outlive this.
+  /// \param[in] regionSize The number of bytes in each region.
+  /// \post The storage has been made and, if the context can, mapped.
+  StreamBuffer (OpenGLContext* context, GLsizeiptr regionSize);
+
+  /// \brief Destructs a StreamBuffer, unmapping and deleting its buffer and
+  ///   deleting its fences.
+  ~StreamBuffer ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   StreamBuffers.
+  StreamBuffer (const StreamBuffer&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   StreamBuffers.
+  StreamBuffer&
+  operator= (const StreamBuffer&) = delete;
+
+  /// \brief Reserves bytes in the current region, waiting first for the GPU
+  ///   to finish with the region if this is its first allocation.
+  /// \param[in] size The number of bytes.
+  /// \param[in] alignment What the offset must be a multiple of (it needn't
+  ///   be a power of two).
+  /// \param[out] offset Where the bytes are, from the start of the buffer.
+  /// \return Where to write the bytes, or nullptr if they don't fit in what
+  ///   is left of the region.  Only write there; reads may be slow.
+  void*
+  allocate (GLsizeiptr size, GLsizeiptr alignment, GLintptr& offset);
+
+  /// \brief Makes what was written since the last flush visible to the GPU.
+  ///   With a coherent mapping, there is nothing to do; otherwise it is
+  ///   uploaded.
+  /// \post Draws issued from now on read what was written.
+  void
+  flush ();
+
+  /// \brief Ends the current region, if anything was allocated in it, with
+  ///   a fence after every command issued so far, and moves on to the next.
+  /// \pre Everything allocated in the region has been flushed, and every
+  ///   command that reads it has been issued.
+  void
+  fence ();
+
+  /// \brief Makes every region at least so big, replacing the storage if it
+  ///   is smaller.
+  /// \param[in] regionSize The number of bytes each region needs.
+  /// \post If the storage was replaced, getBuffer () is a new buffer, which
+  ///   is empty, and the old one is deleted (OpenGL keeps it until the GPU
+  ///   is done with it).
+  void
+  reserve (GLsizeiptr regionSize);
+
+  /// \brief Gets the buffer.
+  /// \return Its name.
+  GLuint
+  getBuffer () const;
+
+  /// \brief Gets the size of each region.
+  /// \return The number of bytes.
+  GLsizeiptr
+  getRegionSize () const;
+
+  /// \brief Tests whether or not the buffer is mapped, so that nothing is
+  ///   copied.
+  /// \return Whether or not the context could map it.
+  bool
+  isMapped () const;
+
+  /// \brief Gets how long this has waited on its fences.
+  /// \return The counts and times since construction.
+  StreamWaitStats
+  getWaitStats () const;
+
+private:
+
+  /// \brief Makes and maps the storage.
+  /// \param[in] regionSize The number of bytes in each region.
+  void
+  create (GLsizeiptr regionSize);
+
+  /// \brief Deletes the fences and unmaps and deletes the storage.
+  void
+  destroy ();
+
+  /// \brief Waits on the fence that last ended a region, then deletes it.
+  /// \param[in] region The region.
+  void
+  wait (unsigned int region);
+
+  /// The context to make OpenGL calls through.
+  OpenGLContext* m_context;
+  /// The buffer.
+  GLuint m_buffer;
+  /// The number of bytes in each region.
+  GLsizeiptr m_regionSize;
+  /// The whole buffer, mapped, or nullptr if the context couldn't map it.
+  unsigned char* m_memory;
+  /// The current region's contents, if the buffer isn't mapped.
+  std::vector<unsigned char> m_copy;
+  /// The fence that last ended each region, or nullptr if there is none
+  ///   to wait on.
+  GLsync m_fences[REGION_COUNT];
+  /// The region being allocated from.
+  unsigned int m_region;
+  /// The number of bytes allocated from the current region.
+  GLsizeiptr m_used;
+  /// The number of bytes of the current region flushed.
+  GLsizeiptr m_flushed;
+  /// The waits so far.
+  StreamWaitStats m_stats;
+};
+
+#endif//STREAM_BUFFER_HPP
@@ -0,0 +1,151 @@
+/// \file TestBudgetOpenGLContext.cpp
+/// \brief A collection of Catch2 unit tests for the BudgetOpenGLContext
+///   class, which check that buffers and textures are counted by what they
+///   hold, and that going over the budget is noticed.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include "BudgetOpenGLContext.hpp"
+#include "GeometryArena.hpp"
+#include "NullOpenGLContext.hpp"
+#include "UniformBuffer.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("BudgetOpenGLContext counts buffers by what they hold.", "[BudgetOpenGLContext][A09]") {
+  GIVEN ("A budget context with a geometry arena and a uniform buffer.") {
+    NullOpenGLContext null;
+    BudgetOpenGLContext context (&null);
+    GeometryArena* arena = new GeometryArena (&context);
+    bool created;
+    arena->getVertexArray ("position", 12, created);
+    arena->allocate ("position", std::vector<float> (30), std::vector<unsigned int> (12));
+    UniformBuffer uniforms (&context, 64, 0);
+
+    THEN ("Vertex, index, and uniform bytes are each counted.") {
+      REQUIRE (context.getLiveBytes (BudgetOpenGLContext::VERTEX_MEMORY) == 10 * 12);
+      REQUIRE (context.getLiveBytes (BudgetOpenGLContext::INDEX_MEMORY) == 12 * 4);
+      REQUIRE (context.getLiveBytes (BudgetOpenGLContext::UNIFORM_MEMORY) == 64);
+      REQUIRE (context.getLiveBytes (BudgetOpenGLContext::OTHER_MEMORY) == 0);
+      REQUIRE (context.getTotalBytes () == 120 + 48 + 64);
+      REQUIRE (context.getBufferCount () == 3);
+      REQUIRE (context.getVertexArrayCount () == 1);
+    }
+
+    WHEN ("The arena grows its buffers.") {
+      arena->allocate ("position", std::vector<float> (3), std::vector<unsigned int> (3));
+      THEN ("The buffers are counted at their new sizes.") {
+	REQUIRE (context.getLiveBytes (BudgetOpenGLContext::VERTEX_MEMORY) == 20 * 12);
+	REQUIRE (context.getLiveBytes (BudgetOpenGLContext::INDEX_MEMORY) == 24 * 4);
+      }
+    }
+
+    WHEN ("I delete the arena.") {
+      delete arena;
+      arena = nullptr;
+      THEN ("Its memory is no longer counted, but the peak is kept.") {
+	REQUIRE (context.getLiveBytes (BudgetOpenGLContext::VERTEX_MEMORY) == 0);
+	REQUIRE (context.getLiveBytes (BudgetOpenGLContext::INDEX_MEMORY) == 0);
+	REQUIRE (context.getTotalBytes () == 64);
+	REQUIRE (context.getPeakBytes () == 120 + 48 + 64);
+	REQUIRE (context.getBufferCount () == 1);
+	REQUIRE (context.getVertexArrayCount () == 0);
+      }
+    }
+
+    WHEN ("A buffer is sized before it is given a role.") {
+      GLuint buffer;
+      context.genBuffers (1, &buffer);
+      context.bindBuffer (GL_COPY_WRITE_BUFFER, buffer);
+      context.bufferData (GL_COPY_WRITE_BUFFER, 100, nullptr, GL_STATIC_DRAW);
+      std::size_t other = context.getLiveBytes (BudgetOpenGLContext::OTHER_MEMORY);
+      context.texBuffer (GL_TEXTURE_BUFFER, GL_RGBA32F, buffer);
+      THEN ("It is other memory until its role says what it holds.") {
+	REQUIRE (other == 100);
+	REQUIRE (context.getLiveBytes (BudgetOpenGLContext::OTHER_MEMORY) == 0);
+	REQUIRE (context.getLiveBytes (BudgetOpenGLContext::TEXTURE_MEMORY) == 100);
+      }
+    }
+    delete arena;
+  }
+}
+
+SCENARIO ("BudgetOpenGLContext counts texture images.", "[BudgetOpenGLContext][A09]") {
+  GIVEN ("A budget context with a texture bound on unit 1.") {
+    NullOpenGLContext null;
+    BudgetOpenGLContext context (&null);
+    GLuint texture;
+    context.genTextures (1, &texture);
+    context.activeTexture (GL_TEXTURE1);
+    context.bindTexture (GL_TEXTURE_2D, texture);
+    context.activeTexture (GL_TEXTURE0);
+
+    WHEN ("I give it an image on another unit.") {
+      context.texImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, 8, 8, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                          nullptr);
+      THEN ("Nothing is counted, since nothing is bound there.") {
+	REQUIRE (context.getTotalBytes () == 0);
+      }
+    }
+
+    WHEN ("I give it two levels, and then replace the first.") {
+      context.activeTexture (GL_TEXTURE1);
+      context.texImage2D (GL_TEXTURE_2D, 0, GL_RGBA8, 8, 8, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                          nullptr);
+      context.texImage2D (GL_TEXTURE_2D, 1, GL_RGBA8, 4, 4, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                          nullptr);
+      context.texImage2D (GL_TEXTURE_2D, 0, GL_RGBA16F, 8, 8, 0, GL_RGBA, GL_FLOAT,
+                          nullptr);
+      THEN ("Each level is counted once, at its latest size.") {
+	REQUIRE (context.getLiveBytes (BudgetOpenGLContext::TEXTURE_MEMORY) == 8 * 8 * 8 + 4 * 4 * 4);
+	REQUIRE (context.getTextureCount () == 1);
+      }
+      context.deleteTextures (1, &texture);
+      THEN ("Deleting it frees every level.") {
+	REQUIRE (context.getTotalBytes () == 0);
+	REQUIRE (context.getTextureCount () == 0);
+      }
+    }
+  }
+}
+
+SCENARIO ("BudgetOpenGLContext warns when the budget is gone over.", "[BudgetOpenGLContext][A09]") {
+  GIVEN ("A budget context with a budget of 1000 bytes.") {
+    NullOpenGLContext null;
+    BudgetOpenGLContext context (&null);
+    context.setBudget (1000);
+    GLuint buffers[2];
+    context.createBuffers (2, buffers);
+    context.namedBufferData (buffers[0], 600, nullptr, GL_STATIC_DRAW);
+
+    THEN ("Staying under it doesn't warn.") {
+      REQUIRE (context.getBudget () == 1000);
+      REQUIRE (context.getWarningCount () == 0);
+    }
+
+    WHEN ("I go over it, and stay over.") {
+      context.namedBufferData (buffers[1], 600, nullptr, GL_STATIC_DRAW);
+      context.namedBufferData (buffers[1], 700, nullptr, GL_STATIC_DRAW);
+      THEN ("It warns once.") {
+	REQUIRE (context.getWarningCount () == 1);
+      }
+    }
+
+    WHEN ("I go over it, come back under, and go over again.") {
+      context.namedBufferData (buffers[1], 600, nullptr, GL_STATIC_DRAW);
+      context.deleteBuffers (1, &buffers[1]);
+      context.namedBufferData (buffers[0], 1200, nullptr, GL_STATIC_DRAW);
+      THEN ("It warns each time.") {
+	REQUIRE (context.getWarningCount () == 2);
+      }
+    }
+
+    WHEN ("I lower the budget below what is allocated.") {
+      context.setBudget (500);
+      THEN ("It warns right away.") {
+	REQUIRE (context.getWarningCount () == 1);
+      }
+    }
+  }
+}
@@ -0,0 +1,136 @@
+/// \file TestBufferAllocator.cpp
+/// \brief A collection of Catch2 unit tests for the BufferAllocator class,
+///   which check that ranges are handed out without overlapping, merged when
+///   released, and reused.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <vector>
+
+#include "BufferAllocator.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("BufferAllocator hands out ranges one after the other.", "[BufferAllocator][A09]") {
+  GIVEN ("An allocator of 100 units with three ranges taken.") {
+    BufferAllocator allocator (100);
+    std::size_t first = allocator.allocate (10);
+    std::size_t second = allocator.allocate (20);
+    std::size_t third = allocator.allocate (30);
+
+    THEN ("The ranges are packed from the start.") {
+      REQUIRE (first == 0);
+      REQUIRE (second == 10);
+      REQUIRE (third == 30);
+      REQUIRE (allocator.getUsed () == 60);
+      REQUIRE (allocator.getFreeRangeCount () == 1);
+      REQUIRE (allocator.getLargestFree () == 40);
+    }
+
+    THEN ("A range bigger than what is left isn't allocated.") {
+      REQUIRE (allocator.allocate (41) == BufferAllocator::NONE);
+      REQUIRE (allocator.allocate (40) == 60);
+      REQUIRE (allocator.getLargestFree () == 0);
+    }
+
+    WHEN ("I release the first range.") {
+      allocator.release (first);
+      THEN ("It is a hole that a smaller range reuses.") {
+	REQUIRE (allocator.getFreeRangeCount () == 2);
+	REQUIRE (allocator.allocate (8) == 0);
+	REQUIRE (allocator.getUsed () == 58);
+      }
+    }
+
+    WHEN ("I release the first two ranges.") {
+      allocator.release (second);
+      allocator.release (first);
+      THEN ("They are merged into one free range.") {
+	REQUIRE (allocator.getFreeRangeCount () == 2);
+	REQUIRE (allocator.allocate (30) == 0);
+      }
+    }
+
+    WHEN ("I release every range.") {
+      allocator.release (first);
+      allocator.release (third);
+      allocator.release (second);
+      THEN ("The whole buffer is one free range again.") {
+	REQUIRE (allocator.getUsed () == 0);
+	REQUIRE (allocator.getFreeRangeCount () == 1);
+	REQUIRE (allocator.getLargestFree () == 100);
+      }
+    }
+
+    WHEN ("I release a range twice, or an offset that was never allocated.") {
+      allocator.release (second);
+      allocator.release (second);
+      allocator.release (5);
+      THEN ("Only the first release counts.") {
+	REQUIRE (allocator.getUsed () == 40);
+      }
+    }
+  }
+}
+
+SCENARIO ("BufferAllocator grows and clears.", "[BufferAllocator][A09]") {
+  GIVEN ("A full allocator.") {
+    BufferAllocator allocator (16);
+    allocator.allocate (16);
+
+    WHEN ("I grow it.") {
+      allocator.grow (1000);
+      THEN ("The new space follows the old, in one free range.") {
+	REQUIRE (allocator.getCapacity () == 1000);
+	REQUIRE (allocator.getLargestFree () == 984);
+	REQUIRE (allocator.allocate (500) == 16);
+      }
+    }
+
+    WHEN ("I clear it.") {
+      allocator.clear ();
+      THEN ("Everything is free.") {
+	REQUIRE (allocator.getUsed () == 0);
+	REQUIRE (allocator.allocate (16) == 0);
+      }
+    }
+  }
+
+  GIVEN ("An empty allocator of no capacity.") {
+    BufferAllocator allocator;
+
+    THEN ("Nothing can be allocated, not even an empty range.") {
+      REQUIRE (allocator.allocate (0) == BufferAllocator::NONE);
+      REQUIRE (allocator.getFreeRangeCount () == 0);
+    }
+  }
+}
+
+SCENARIO ("BufferAllocator finds a free range of any size.", "[BufferAllocator][A09]") {
+  GIVEN ("An allocator with free ranges of many sizes between used ones.") {
+    BufferAllocator allocator (1 << 20);
+    std::vector<std::size_t> offsets;
+    for (std::size_t size = 1; size <= 4096; size = size * 3 / 2 + 1)
+    {
+      offsets.push_back (allocator.allocate (size));
+      allocator.allocate (1);
+    }
+    std::size_t used = allocator.getUsed ();
+    for (std::size_t offset : offsets)
+      allocator.release (offset);
+
+    THEN ("Each size is allocated from the hole that fits it, or one bigger.") {
+      REQUIRE (allocator.getFreeRangeCount () == offsets.size () + 1);
+      std::size_t hole = 0;
+      for (std::size_t size = 1; size <= 4096; size = size * 3 / 2 + 1)
+      {
+	std::size_t offset = allocator.allocate (size);
+	REQUIRE (offset != BufferAllocator::NONE);
+	REQUIRE (offset >= offsets[hole]);
+	++hole;
+      }
+      REQUIRE (allocator.getUsed () == used);
+    }
+  }
+}
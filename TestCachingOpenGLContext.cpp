@@ -0,0 +1,95 @@
+/// \file TestCachingOpenGLContext.cpp
+/// \brief A collection of Catch2 unit tests for the CachingOpenGLContext
+///   class, which count the calls it lets through to a NullOpenGLContext.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include "CachingOpenGLContext.hpp"
+#include "NullOpenGLContext.hpp"
+#include "TestContexts.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("CachingOpenGLContext drops calls that change nothing.", "[CachingOpenGLContext][A09]") {
+  GIVEN ("A CachingOpenGLContext in front of a counting one.") {
+    CountingContext<NullOpenGLContext> counting;
+    CachingOpenGLContext caching (&counting);
+
+    WHEN ("I enable the depth test and bind a texture twice each.") {
+      for (int i = 0; i < 2; ++i) {
+	caching.enable (GL_DEPTH_TEST);
+	caching.activeTexture (GL_TEXTURE1);
+	caching.bindTexture (GL_TEXTURE_2D, 7);
+      }
+      THEN ("Only the first of each is passed on.") {
+	REQUIRE (counting.calls["enable"] == 1);
+	REQUIRE (counting.calls["activeTexture"] == 1);
+	REQUIRE (counting.calls["bindTexture"] == 1);
+	REQUIRE (caching.getCallCounts (CachingOpenGLContext::ENABLE).passed == 1);
+	REQUIRE (caching.getCallCounts (CachingOpenGLContext::ENABLE).elided == 1);
+	REQUIRE (caching.getCallCounts (CachingOpenGLContext::BIND_TEXTURE).elided == 1);
+      }
+      THEN ("Binding the same texture to another unit is passed on.") {
+	caching.activeTexture (GL_TEXTURE2);
+	caching.bindTexture (GL_TEXTURE_2D, 7);
+	REQUIRE (counting.calls["activeTexture"] == 2);
+	REQUIRE (counting.calls["bindTexture"] == 2);
+      }
+      THEN ("Everything is passed on again after invalidate ().") {
+	caching.invalidate ();
+	caching.enable (GL_DEPTH_TEST);
+	REQUIRE (counting.calls["enable"] == 2);
+      }
+    }
+
+    WHEN ("I bind two uniform buffers to their binding points, and then both again.") {
+      for (int i = 0; i < 2; ++i) {
+	caching.bindBufferBase (GL_UNIFORM_BUFFER, 0, 5);
+	caching.bindBufferBase (GL_UNIFORM_BUFFER, 1, 6);
+      }
+      THEN ("Only the first binding of each point is passed on.") {
+	REQUIRE (counting.calls["bindBufferBase"] == 2);
+	REQUIRE (caching.getCallCounts (CachingOpenGLContext::BIND_BUFFER_BASE).elided == 2);
+      }
+      THEN ("Binding a point again after its buffer is deleted is passed on.") {
+	GLuint buffer = 5;
+	caching.deleteBuffers (1, &buffer);
+	caching.bindBufferBase (GL_UNIFORM_BUFFER, 0, 5);
+	REQUIRE (counting.calls["bindBufferBase"] == 3);
+      }
+    }
+  }
+}
+
+SCENARIO ("CachingOpenGLContext puts off unbinding.", "[CachingOpenGLContext][A09]") {
+  GIVEN ("A CachingOpenGLContext in front of a counting one.") {
+    CountingContext<NullOpenGLContext> counting;
+    CachingOpenGLContext caching (&counting);
+
+    WHEN ("I draw with the same program and vertex array 10 times, unbinding both after each draw.") {
+      for (int i = 0; i < 10; ++i) {
+	caching.useProgram (3);
+	caching.bindVertexArray (4);
+	caching.drawArrays (GL_TRIANGLES, 0, 3);
+	caching.bindVertexArray (0);
+	caching.useProgram (0);
+      }
+      THEN ("Each is bound once, and neither has been unbound.") {
+	REQUIRE (counting.calls["useProgram"] == 1);
+	REQUIRE (counting.calls["bindVertexArray"] == 1);
+	REQUIRE (counting.calls["drawArrays"] == 10);
+	REQUIRE (caching.getCallCounts (CachingOpenGLContext::USE_PROGRAM).passed == 1);
+	REQUIRE (caching.getCallCounts (CachingOpenGLContext::BIND_VERTEX_ARRAY).passed == 1);
+      }
+      THEN ("Drawing with neither bound makes both put-off unbinds first.") {
+	caching.drawArrays (GL_POINTS, 0, 1);
+	REQUIRE (counting.calls["useProgram"] == 2);
+	REQUIRE (counting.calls["bindVertexArray"] == 2);
+	REQUIRE (counting.calls["drawArrays"] == 11);
+	REQUIRE (caching.getCallCounts (CachingOpenGLContext::USE_PROGRAM).passed == 2);
+	REQUIRE (caching.getCallCounts (CachingOpenGLContext::BIND_VERTEX_ARRAY).passed == 2);
+      }
+    }
+  }
+}
@@ -0,0 +1,275 @@
+/// \file TestContexts.hpp
+/// \brief Fakes shared by the Catch2 unit tests: a decorator that counts
+///   (and keeps some of) the calls made through a context, and files written
+///   to a temporary directory instead of the one the tests run in.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef TEST_CONTEXTS_HPP
+#define TEST_CONTEXTS_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+#include "OpenGLContext.hpp"
+
+/// \brief A context that passes every call on to Base, counting the calls
+///   of each kind that the tests care about, and keeping the range of each
+///   buffer upload, each shader source, and what each buffer was given.
+template <typename Base>
+class CountingContext : public Base
+{
+public:
+
+  /// \brief Constructs the Base with whatever arguments it takes.
+  template <typename... Arguments>
+  explicit CountingContext (Arguments&&... arguments)
+    : Base (std::forward<Arguments> (arguments)...)
+  {
+  }
+
+  /// \brief Where a buffer upload wrote to.
+  struct Upload
+  {
+    /// The first byte written.
+    std::size_t offset;
+    /// The number of bytes written.
+    std::size_t size;
+  };
+
+  virtual void
+  activeTexture (GLenum texture)
+  {
+    ++calls["activeTexture"];
+    Base::activeTexture (texture);
+  }
+
+  virtual void
+  bindBufferBase (GLenum target, GLuint index, GLuint buffer)
+  {
+    ++calls["bindBufferBase"];
+    Base::bindBufferBase (target, index, buffer);
+  }
+
+  virtual void
+  bindTexture (GLenum target, GLuint texture)
+  {
+    ++calls["bindTexture"];
+    Base::bindTexture (target, texture);
+  }
+
+  virtual void
+  bindVertexArray (GLuint array)
+  {
+    ++calls["bindVertexArray"];
+    Base::bindVertexArray (array);
+  }
+
+  virtual void
+  bufferSubData (GLenum target, GLintptr offset, GLsizeiptr size, const GLvoid* data)
+  {
+    ++calls["bufferSubData"];
+    uploads.push_back (Upload { std::size_t (offset), std::size_t (size) });
+    Base::bufferSubData (target, offset, size, data);
+  }
+
+  virtual void
+  drawArrays (GLenum mode, GLint first, GLsizei count)
+  {
+    ++calls["drawArrays"];
+    Base::drawArrays (mode, first, count);
+  }
+
+  virtual void
+  drawElements (GLenum mode, GLsizei count, GLenum type, const void* indices)
+  {
+    ++calls["drawElements"];
+    Base::drawElements (mode, count, type, indices);
+  }
+
+  virtual void
+  enable (GLenum cap)
+  {
+    ++calls["enable"];
+    Base::enable (cap);
+  }
+
+  virtual void
+  linkProgram (GLuint program)
+  {
+    ++calls["linkProgram"];
+    Base::linkProgram (program);
+  }
+
+  virtual void
+  multiDrawElementsIndirect (GLenum mode, GLenum type, const void* indirect,
+                             GLsizei drawcount, GLsizei stride)
+  {
+    ++calls["multiDrawElementsIndirect"];
+    Base::multiDrawElementsIndirect (mode, type, indirect, drawcount, stride);
+  }
+
+  virtual void
+  multiDrawElementsIndirectCount (GLenum mode, GLenum type, const void* indirect,
+                                  GLintptr drawcount, GLsizei maxdrawcount, GLsizei stride)
+  {
+    ++calls["multiDrawElementsIndirectCount"];
+    Base::multiDrawElementsIndirectCount (mode, type, indirect, drawcount, maxdrawcount,
+                                          stride);
+  }
+
+  virtual void
+  namedBufferData (GLuint buffer, GLsizeiptr size, const void* data, GLenum usage)
+  {
+    ++calls["namedBufferData"];
+    const unsigned char* bytes = static_cast<const unsigned char*> (data);
+    if (bytes != nullptr)
+      contents[buffer].assign (bytes, bytes + size);
+    else
+      contents[buffer].assign (size, 0);
+    Base::namedBufferData (buffer, size, data, usage);
+  }
+
+  virtual void
+  namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+  {
+    ++calls["namedBufferSubData"];
+    uploads.push_back (Upload { std::size_t (offset), std::size_t (size) });
+    Base::namedBufferSubData (buffer, offset, size, data);
+  }
+
+  virtual void
+  shaderSource (GLuint shader, GLsizei count, const GLchar** string, const GLint* length)
+  {
+    ++calls["shaderSource"];
+    std::string source;
+    for (GLsizei i = 0; i < count; ++i)
+      source += (length == nullptr || length[i] < 0) ? std::string (string[i])
+                                                       : std::string (string[i], length[i]);
+    sources.push_back (source);
+    Base::shaderSource (shader, count, string, length);
+  }
+
+  virtual void
+  texBuffer (GLenum target, GLenum internalformat, GLuint buffer)
+  {
+    ++calls["texBuffer"];
+    textureBuffers[internalformat] = buffer;
+    Base::texBuffer (target, internalformat, buffer);
+  }
+
+  virtual void
+  uniform1f (GLint location, GLfloat v0)
+  {
+    ++calls["uniform1f"];
+    Base::uniform1f (location, v0);
+  }
+
+  virtual void
+  uniform1i (GLint location, GLint v0)
+  {
+    ++calls["uniform1i"];
+    Base::uniform1i (location, v0);
+  }
+
+  virtual void
+  uniform3f (GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
+  {
+    ++calls["uniform3f"];
+    Base::uniform3f (location, v0, v1, v2);
+  }
+
+  virtual void
+  uniformMatrix4fv (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+  {
+    ++calls["uniformMatrix4fv"];
+    Base::uniformMatrix4fv (location, count, transpose, value);
+  }
+
+  virtual void
+  useProgram (GLuint program)
+  {
+    ++calls["useProgram"];
+    Base::useProgram (program);
+  }
+
+  /// \brief Gets the number of glUniform* calls made.
+  unsigned int
+  getUniformCount ()
+  {
+    return calls["uniform1f"] + calls["uniform1i"] + calls["uniform3f"]
+      + calls["uniformMatrix4fv"];
+  }
+
+  /// The number of calls made to each counted function, by name.
+  std::map<std::string, unsigned int> calls;
+  /// Every buffer upload, in order.
+  std::vector<Upload> uploads;
+  /// Every shader source, in the order given.
+  std::vector<std::string> sources;
+  /// What was last given to namedBufferData for each buffer.
+  std::map<GLuint, std::vector<unsigned char>> contents;
+  /// The buffer behind the buffer texture of each format.
+  std::map<GLenum, GLuint> textureBuffers;
+};
+
+/// \brief Gets a path in the temporary directory ($TMPDIR, or /tmp) for a
+///   file that no other process running a test will use.
+/// \param[in] name The name of the file.
+inline std::string
+getTemporaryPath (const std::string& name)
+{
+  const char* directory = std::getenv ("TMPDIR");
+  return std::string (directory != nullptr ? directory : "/tmp") + "/"
+    + std::to_string (getpid ()) + "-" + name;
+}
+
+/// \brief A file of shader source, in the temporary directory, that is
+///   removed when the ShaderFile is destroyed.  ShaderProgram reads its
+///   shaders from files, so tests write them with this.
+class ShaderFile
+{
+public:
+
+  /// \brief Writes a shader file.
+  /// \param[in] name The file's name, which is made unique to this process.
+  /// \param[in] source What it contains.
+  ShaderFile (const std::string& name, const std::string& source)
+    : m_path (getTemporaryPath (name))
+  {
+    std::ofstream (m_path) << source;
+  }
+
+  /// \brief Removes the file.
+  ~ShaderFile ()
+  {
+    std::remove (m_path.c_str ());
+  }
+
+  ShaderFile (const ShaderFile&) = delete;
+
+  ShaderFile&
+  operator= (const ShaderFile&) = delete;
+
+  /// \brief Gets the file's path.
+  const char*
+  getPath () const
+  {
+    return m_path.c_str ();
+  }
+
+private:
+
+  /// Where the file is.
+  std::string m_path;
+};
+
+#endif//TEST_CONTEXTS_HPP
@@ -0,0 +1,183 @@
+/// \file TestDirectStateOpenGLContext.cpp
+/// \brief A collection of Catch2 unit tests for the DirectStateOpenGLContext
+///   class, which set up vertex arrays by direct state access, both passed
+///   on and emulated, and check what is drawn and what is left bound.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <vector>
+
+#include "DirectStateOpenGLContext.hpp"
+#include "SoftwareOpenGLContext.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// \brief A context that remembers what is bound and counts the binds.
+  class BindingContext : public NullOpenGLContext
+  {
+  public:
+
+    virtual void
+    bindBuffer (GLenum target, GLuint buffer)
+    {
+      ++binds;
+      if (target == GL_ARRAY_BUFFER)
+        arrayBuffer = buffer;
+    }
+
+    virtual void
+    bindVertexArray (GLuint array)
+    {
+      ++binds;
+      vertexArray = array;
+    }
+
+    /// The vertex array bound.
+    GLuint vertexArray = 0;
+    /// The buffer bound to GL_ARRAY_BUFFER.
+    GLuint arrayBuffer = 0;
+    /// The number of bindBuffer and bindVertexArray calls.
+    unsigned int binds = 0;
+  };
+
+  /// \brief Makes a program that is drawn like Vec3.vert, with the identity
+  ///   as its transformation, and an indexed vertex array for it, the way
+  ///   Mesh::prepareVao does.
+  /// \param[in] context The context.
+  /// \param[in] vertices Each vertex's position (in clip space) and color.
+  /// \param[in] indices The vertices of each triangle.
+  /// \return The vertex array.
+  GLuint
+  prepare (OpenGLContext& context, const std::vector<float>& vertices,
+           const std::vector<GLuint>& indices)
+  {
+    const GLchar* source = "layout (location = 0) in vec3 aPosition;\n"
+      "layout (location = 1) in vec3 aColor;\n"
+      "uniform mat4 uModelViewProjection;\n";
+    GLuint shader = context.createShader (GL_VERTEX_SHADER);
+    context.shaderSource (shader, 1, &source, nullptr);
+    GLuint program = context.createProgram ();
+    context.attachShader (program, shader);
+    context.linkProgram (program);
+    context.useProgram (program);
+    const GLfloat identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    context.uniformMatrix4fv (context.getUniformLocation (program, "uModelViewProjection"),
+                              1, GL_FALSE, identity);
+
+    GLuint array, buffers[2];
+    context.createVertexArrays (1, &array);
+    context.createBuffers (2, buffers);
+    context.namedBufferStorage (buffers[0], vertices.size () * sizeof (float),
+                                vertices.data (), 0);
+    context.namedBufferStorage (buffers[1], indices.size () * sizeof (GLuint),
+                                indices.data (), 0);
+    // The format before the buffer for one attribute and after it for the
+    //   other, since either order has to work.
+    context.enableVertexArrayAttrib (array, 0);
+    context.vertexArrayAttribFormat (array, 0, 3, GL_FLOAT, GL_FALSE, 0);
+    context.vertexArrayAttribBinding (array, 0, 0);
+    context.vertexArrayVertexBuffer (array, 0, buffers[0], 0, 6 * sizeof (float));
+    context.vertexArrayElementBuffer (array, buffers[1]);
+    context.enableVertexArrayAttrib (array, 1);
+    context.vertexArrayAttribFormat (array, 1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof (float));
+    context.vertexArrayAttribBinding (array, 1, 0);
+    return array;
+  }
+
+  /// \brief Reads one channel of a pixel.
+  /// \param[in] channel 0 for red, 1 for green, or 2 for blue.
+  int
+  read (SoftwareOpenGLContext& context, GLint x, GLint y, int channel)
+  {
+    GLubyte rgb[3];
+    context.readPixel (x, y, rgb);
+    return rgb[channel];
+  }
+
+  /// A red quad over the whole screen, with a green vertex in one corner.
+  const std::vector<float> QUAD = { -1, -1, 0, 1, 0, 0,
+                                    1, -1, 0, 1, 0, 0,
+                                    1, 1, 0, 0, 1, 0,
+                                    -1, 1, 0, 1, 0, 0 };
+
+  /// The two triangles of QUAD.
+  const std::vector<GLuint> QUAD_INDICES = { 0, 1, 2, 0, 2, 3 };
+}
+
+SCENARIO ("DirectStateOpenGLContext draws the same whether it emulates or not.", "[DirectStateOpenGLContext][A09]") {
+  GIVEN ("A software framebuffer cleared to blue.") {
+    SoftwareOpenGLContext software (40, 40);
+    software.clearColor (0, 0, 1, 1);
+    software.clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    WHEN ("I set up and draw a quad with direct state access emulated.") {
+      DirectStateOpenGLContext context (&software, false);
+      GLuint array = prepare (context, QUAD, QUAD_INDICES);
+      context.bindVertexArray (array);
+      context.drawElements (GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+      THEN ("The quad covers the screen, green only in its green corner.") {
+	REQUIRE (!context.isNative ());
+	REQUIRE (read (software, 1, 1, 0) >= 240);
+	REQUIRE (read (software, 38, 38, 1) >= 240);
+	REQUIRE (read (software, 38, 38, 0) <= 15);
+	REQUIRE (read (software, 20, 1, 2) == 0);
+	REQUIRE (software.getTriangleCount () == 2);
+      }
+    }
+
+    WHEN ("I set up and draw the same quad with it passed on.") {
+      DirectStateOpenGLContext context (&software, true);
+      GLuint array = prepare (context, QUAD, QUAD_INDICES);
+      context.bindVertexArray (array);
+      context.drawElements (GL_TRIANGLES, 6, GL_UNSIGNED_INT, nullptr);
+      THEN ("The quad covers the screen, green only in its green corner.") {
+	REQUIRE (context.isNative ());
+	REQUIRE (read (software, 1, 1, 0) >= 240);
+	REQUIRE (read (software, 38, 38, 1) >= 240);
+	REQUIRE (software.getTriangleCount () == 2);
+      }
+    }
+  }
+}
+
+SCENARIO ("DirectStateOpenGLContext leaves the bindings as they were.", "[DirectStateOpenGLContext][A09]") {
+  GIVEN ("A vertex array and buffer bound through the context.") {
+    BindingContext bindings;
+    GLuint bound[2];
+    bindings.genVertexArrays (1, &bound[0]);
+    bindings.genBuffers (1, &bound[1]);
+
+    WHEN ("I set up another vertex array while emulating.") {
+      DirectStateOpenGLContext context (&bindings, false);
+      context.bindVertexArray (bound[0]);
+      context.bindBuffer (GL_ARRAY_BUFFER, bound[1]);
+      GLuint array = prepare (context, QUAD, QUAD_INDICES);
+      THEN ("The same ones are bound after, though it bound others to edit.") {
+	REQUIRE (array != bound[0]);
+	REQUIRE (bindings.vertexArray == bound[0]);
+	REQUIRE (bindings.arrayBuffer == bound[1]);
+	REQUIRE (bindings.binds > 2);
+      }
+      THEN ("Deleting the bound array makes 0 the one bound back to.") {
+	context.deleteVertexArrays (1, &bound[0]);
+	context.vertexArrayElementBuffer (array, 0);
+	REQUIRE (bindings.vertexArray == 0);
+      }
+    }
+
+    WHEN ("I set up another vertex array with direct state access passed on.") {
+      DirectStateOpenGLContext context (&bindings, true);
+      context.bindVertexArray (bound[0]);
+      context.bindBuffer (GL_ARRAY_BUFFER, bound[1]);
+      prepare (context, QUAD, QUAD_INDICES);
+      THEN ("Nothing else is bound at all.") {
+	REQUIRE (bindings.vertexArray == bound[0]);
+	REQUIRE (bindings.arrayBuffer == bound[1]);
+	REQUIRE (bindings.binds == 2);
+      }
+    }
+  }
+}
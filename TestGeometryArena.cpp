@@ -0,0 +1,205 @@
+/// \file TestGeometryArena.cpp
+/// \brief A collection of Catch2 unit tests for the GeometryArena class and
+///   the multi-draws of the RenderQueue class, which pack Meshes into shared
+///   buffers and draw them (on a software framebuffer) a run at a time.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <vector>
+
+#include "GeometryArena.hpp"
+#include "Mesh.hpp"
+#include "RenderQueue.hpp"
+#include "SoftwareOpenGLContext.hpp"
+#include "TestContexts.hpp"
+#include "TestQuads.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("GeometryArena packs geometry into one buffer per format.", "[GeometryArena][A09]") {
+  GIVEN ("An arena with two vertex formats.") {
+    NullOpenGLContext context;
+    GeometryArena arena (&context);
+    bool created[3];
+    GLuint colors = arena.getVertexArray ("position color", 24, created[0]);
+    GLuint normals = arena.getVertexArray ("position color normal", 24, created[1]);
+    GLuint again = arena.getVertexArray ("position color", 24, created[2]);
+
+    THEN ("Each format has its own vertex array, made only once.") {
+      REQUIRE (created[0]);
+      REQUIRE (created[1]);
+      REQUIRE (!created[2]);
+      REQUIRE (again == colors);
+      REQUIRE (normals != colors);
+      REQUIRE (arena.getFormatCount () == 2);
+    }
+
+    WHEN ("I allocate two quads of one format and one of the other.") {
+      const GeometryRange* first = arena.allocate ("position color", makeQuad (-1, 0, 1, 0),
+                                                   QUAD_INDICES);
+      const GeometryRange* second = arena.allocate ("position color", makeQuad (0, 1, 0, 1),
+                                                    QUAD_INDICES);
+      const GeometryRange* third = arena.allocate ("position color normal",
+                                                   makeQuad (0, 1, 0, 1), QUAD_INDICES);
+      THEN ("Vertices follow each other per format, and indices in one buffer.") {
+	REQUIRE (first->vao == colors);
+	REQUIRE (second->vao == colors);
+	REQUIRE (third->vao == normals);
+	REQUIRE (first->firstVertex == 0);
+	REQUIRE (second->firstVertex == 4);
+	REQUIRE (third->firstVertex == 0);
+	REQUIRE (second->vertexCount == 4);
+	REQUIRE (first->firstIndex == 0);
+	REQUIRE (second->firstIndex == 6);
+	REQUIRE (third->firstIndex == 12);
+	REQUIRE (third->indexCount == 6);
+	REQUIRE (arena.getSize () == 3 * (4 * 24 + 6 * sizeof (GLuint)));
+	REQUIRE (arena.getCapacity () >= arena.getSize ());
+      }
+      THEN ("Releasing any range gives its space back.") {
+	arena.release (first);
+	REQUIRE (arena.getSize () == 2 * (4 * 24 + 6 * sizeof (GLuint)));
+	arena.release (third);
+	arena.release (second);
+	REQUIRE (arena.getSize () == 0);
+      }
+      THEN ("A released range's space is reused by a range that fits in it.") {
+	arena.release (first);
+	const GeometryRange* fourth = arena.allocate ("position color", makeQuad (0, 1, 1, 1),
+	                                              QUAD_INDICES);
+	REQUIRE (fourth->firstVertex == 0);
+	REQUIRE (fourth->firstIndex == 0);
+      }
+      THEN ("Defragmenting moves the ranges left over down, into one piece.") {
+	std::size_t capacity = arena.getCapacity ();
+	arena.release (first);
+	REQUIRE (arena.getFreeRangeCount () == 3);
+	arena.defragment ();
+	REQUIRE (second->firstVertex == 0);
+	REQUIRE (second->firstIndex == 0);
+	REQUIRE (third->firstVertex == 0);
+	REQUIRE (third->firstIndex == 6);
+	REQUIRE (arena.getFreeRangeCount () == 2);
+	REQUIRE (arena.getCapacity () == capacity);
+      }
+    }
+  }
+}
+
+SCENARIO ("RenderQueue draws a run of Meshes with one multi-draw.", "[GeometryArena][RenderQueue][A09]") {
+  GIVEN ("A red Mesh on the left and a green one on the right, in one arena.") {
+    ShaderFile vertexShader ("TestGeometryArena.vert", QUAD_VERTEX_SOURCE);
+    ShaderFile fragmentShader ("TestGeometryArena.frag", QUAD_FRAGMENT_SOURCE);
+    CountingContext<SoftwareOpenGLContext> context (40, 40);
+    context.clearColor (0, 0, 1, 1);
+    context.clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    ShaderProgram program (&context);
+    program.build (vertexShader.getPath (), fragmentShader.getPath ());
+    GeometryArena arena (&context);
+    Mesh* spacer = new Mesh (&context, &program);
+    spacer->addGeometry (makeQuad (-1, 1, 1, 1));
+    spacer->addIndices (QUAD_INDICES);
+    spacer->setArena (&arena);
+    spacer->prepareVao ();
+    Mesh left (&context, &program);
+    Mesh right (&context, &program);
+    left.addGeometry (makeQuad (-1, 0, 1, 0));
+    right.addGeometry (makeQuad (0, 1, 0, 1));
+    for (Mesh* mesh : { &left, &right })
+    {
+      mesh->addIndices (QUAD_INDICES);
+      mesh->setArena (&arena);
+      mesh->prepareVao ();
+    }
+    RenderQueue queue;
+    left.record (Matrix4 (), Matrix4 (), &program, 0, queue.getBuffer (0));
+    right.record (Matrix4 (), Matrix4 (), &program, 1, queue.getBuffer (0));
+    queue.merge ();
+
+    WHEN ("I submit them with multi-draw on.") {
+      queue.setMultiDrawIndirect (&context);
+      queue.upload ();
+      queue.submit (&context);
+      THEN ("One call draws both, each with its own geometry.") {
+	REQUIRE (queue.isMultiDrawIndirect ());
+	REQUIRE (context.calls["multiDrawElementsIndirect"] == 1);
+	REQUIRE (context.calls["drawElements"] == 0);
+	REQUIRE (read (context, 5, 20, 0) >= 240);
+	REQUIRE (read (context, 5, 20, 1) == 0);
+	REQUIRE (read (context, 35, 20, 1) >= 240);
+	REQUIRE (read (context, 35, 20, 0) == 0);
+	REQUIRE (context.getTriangleCount () == 4);
+      }
+    }
+
+    WHEN ("I submit them again, a frame later, with multi-draw on.") {
+      queue.setMultiDrawIndirect (&context);
+      queue.upload ();
+      queue.submit (&context);
+      context.clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+      queue.upload ();
+      queue.submit (&context);
+      THEN ("They are drawn the same from the next region of the stream buffer.") {
+	REQUIRE (queue.getStreamBuffer ()->isMapped ());
+	REQUIRE (context.calls["multiDrawElementsIndirect"] == 2);
+	REQUIRE (read (context, 5, 20, 0) >= 240);
+	REQUIRE (read (context, 35, 20, 1) >= 240);
+	REQUIRE (read (context, 35, 20, 0) == 0);
+      }
+    }
+
+    WHEN ("I remove a Mesh before them, defragment the arena, and submit them.") {
+      delete spacer;
+      spacer = nullptr;
+      arena.defragment ();
+      queue.clear ();
+      left.record (Matrix4 (), Matrix4 (), &program, 0, queue.getBuffer (0));
+      right.record (Matrix4 (), Matrix4 (), &program, 1, queue.getBuffer (0));
+      queue.merge ();
+      queue.setMultiDrawIndirect (&context);
+      queue.upload ();
+      queue.submit (&context);
+      THEN ("They are drawn from where they moved to.") {
+	REQUIRE (arena.getFreeRangeCount () == 2);
+	REQUIRE (read (context, 5, 20, 0) >= 240);
+	REQUIRE (read (context, 5, 20, 1) == 0);
+	REQUIRE (read (context, 35, 20, 1) >= 240);
+	REQUIRE (read (context, 35, 20, 0) == 0);
+      }
+    }
+
+    WHEN ("I submit them with multi-draw off.") {
+      queue.submit (&context);
+      THEN ("Each is drawn on its own, from the same vertex array.") {
+	REQUIRE (left.getArena () == &arena);
+	REQUIRE (context.calls["multiDrawElementsIndirect"] == 0);
+	REQUIRE (context.calls["drawElements"] == 2);
+	REQUIRE (read (context, 5, 20, 0) >= 240);
+	REQUIRE (read (context, 35, 20, 1) >= 240);
+      }
+    }
+
+    WHEN ("I give the Meshes different materials.") {
+      Material red (Vector3 (1, 0, 0), Vector3 (1, 0, 0), Vector3 (0, 0, 0),
+                    Vector3 (0, 0, 0), 1.0f);
+      Material green (Vector3 (0, 1, 0), Vector3 (0, 1, 0), Vector3 (0, 0, 0),
+                      Vector3 (0, 0, 0), 1.0f);
+      left.setMaterial (&red);
+      right.setMaterial (&green);
+      queue.clear ();
+      left.record (Matrix4 (), Matrix4 (), &program, 0, queue.getBuffer (0));
+      right.record (Matrix4 (), Matrix4 (), &program, 1, queue.getBuffer (0));
+      queue.merge ();
+      queue.setMultiDrawIndirect (&context);
+      queue.upload ();
+      queue.submit (&context);
+      THEN ("Each material gets a multi-draw of its own.") {
+	REQUIRE (context.calls["multiDrawElementsIndirect"] == 2);
+	REQUIRE (read (context, 35, 20, 1) >= 240);
+	REQUIRE (context.getTriangleCount () == 4);
+      }
+    }
+    delete spacer;
+  }
+}
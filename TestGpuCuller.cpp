@@ -0,0 +1,270 @@
+/// \file TestGpuCuller.cpp
+/// \brief A collection of Catch2 unit tests for the GpuCuller class and the
+///   levels of detail of the Mesh class, which check (on a software
+///   framebuffer, whose compute dispatches run a C++ port of the culling
+///   shader) that only visible Meshes are drawn, each at its level.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "GeometryArena.hpp"
+#include "GpuCuller.hpp"
+#include "MaterialTable.hpp"
+#include "Mesh.hpp"
+#include "RenderQueue.hpp"
+#include "SoftwareOpenGLContext.hpp"
+#include "TestContexts.hpp"
+#include "TestQuads.hpp"
+#include "TransformHierarchy.hpp"
+#include "UniformBuffer.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// The compute shader the tests cull with, which declares what
+  ///   shaders/CullDraws.comp does.
+  const std::string COMPUTE_SOURCE = "#version 430\n"
+    "layout (local_size_x = 64) in;\n"
+    "layout (std140) uniform CameraBlock\n"
+    "{\n"
+    "  mat4 uView;\n"
+    "  mat4 uProjection;\n"
+    "  vec3 uEyePosition;\n"
+    "  vec3 uAmbientIntensity;\n"
+    "};\n"
+    "uniform int uObjectCount;\n";
+
+  /// \brief Reads one GLuint of a buffer.
+  /// \param[in] index Which GLuint.
+  GLuint
+  readUint (SoftwareOpenGLContext& context, GLuint buffer, GLuint index)
+  {
+    GLuint value;
+    std::memcpy (&value, context.mapNamedBufferRange (buffer, index * sizeof (GLuint),
+                                                      sizeof (GLuint), GL_MAP_READ_BIT),
+                 sizeof (value));
+    return value;
+  }
+
+  /// \brief Uploads an identity view and projection, so clip space is world
+  ///   space.
+  void
+  setCamera (UniformBuffer& buffer)
+  {
+    CameraBlock camera = {};
+    for (int i = 0; i < 4; ++i)
+    {
+      camera.view[5 * i] = 1.0f;
+      camera.projection[5 * i] = 1.0f;
+    }
+    buffer.update (&camera);
+  }
+}
+
+SCENARIO ("GpuCuller only draws the Meshes in the view frustum.", "[GpuCuller][A09]") {
+  GIVEN ("Three quads in one batch, one of them far to the right.") {
+    ShaderFile vertexShader ("TestGpuCuller.vert", QUAD_VERTEX_SOURCE);
+    ShaderFile fragmentShader ("TestGpuCuller.frag", QUAD_FRAGMENT_SOURCE);
+    ShaderFile computeShader ("TestGpuCuller.comp", COMPUTE_SOURCE);
+    CountingContext<SoftwareOpenGLContext> context (40, 40);
+    ShaderProgram program (&context);
+    program.build (vertexShader.getPath (), fragmentShader.getPath ());
+    ShaderProgram cullProgram (&context);
+    cullProgram.buildCompute (computeShader.getPath ());
+    UniformBuffer camera (&context, sizeof (CameraBlock), CAMERA_BLOCK_BINDING);
+    setCamera (camera);
+    GeometryArena arena (&context);
+    TransformHierarchy hierarchy;
+    Mesh left (&context, &program);
+    Mesh right (&context, &program);
+    Mesh far (&context, &program);
+    left.addGeometry (makeQuad (-1, 0, 1, 0));
+    right.addGeometry (makeQuad (0, 1, 0, 1));
+    far.addGeometry (makeQuad (0, 1, 0, 1));
+    for (Mesh* mesh : { &left, &right, &far })
+    {
+      mesh->addIndices (QUAD_INDICES);
+      mesh->setArena (&arena);
+      mesh->prepareVao ();
+      mesh->attachToHierarchy (&hierarchy);
+    }
+    far.moveWorld (10.0f, Vector3 (1, 0, 0));
+    hierarchy.update ();
+    GpuCuller culler (&context, &cullProgram);
+    culler.setObjects ({ &left, &right, &far });
+    culler.setWorldMatrices (hierarchy.getWorldMatrices (), hierarchy.getNodeCapacity ());
+
+    WHEN ("I cull and submit them.") {
+      culler.cull ();
+      culler.submit (&program);
+      THEN ("One call draws the two in view, each with its own geometry.") {
+	REQUIRE (culler.getObjectCount () == 3);
+	REQUIRE (culler.getBatchCount () == 1);
+	REQUIRE (readUint (context, culler.getCountBuffer (), 0) == 2);
+	REQUIRE (context.calls["multiDrawElementsIndirectCount"] == 1);
+	REQUIRE (read (context, 5, 20, 0) >= 240);
+	REQUIRE (read (context, 5, 20, 1) == 0);
+	REQUIRE (read (context, 35, 20, 1) >= 240);
+	REQUIRE (read (context, 35, 20, 0) == 0);
+	REQUIRE (context.getTriangleCount () == 4);
+      }
+    }
+
+    WHEN ("I move the far quad into view, upload the matrices, and cull again.") {
+      culler.cull ();
+      far.moveWorld (-10.0f, Vector3 (1, 0, 0));
+      hierarchy.update ();
+      culler.setWorldMatrices (hierarchy.getWorldMatrices (), hierarchy.getNodeCapacity ());
+      culler.cull ();
+      culler.submit (&program);
+      context.flush ();
+      THEN ("The count starts over from zero, and all three are drawn.") {
+	REQUIRE (readUint (context, culler.getCountBuffer (), 0) == 3);
+	REQUIRE (context.getTriangleCount () == 6);
+      }
+    }
+  }
+}
+
+SCENARIO ("GpuCuller draws one batch per Material.", "[GpuCuller][A09]") {
+  GIVEN ("Two quads with different Materials.") {
+    ShaderFile vertexShader ("TestGpuCuller.vert", QUAD_VERTEX_SOURCE);
+    ShaderFile fragmentShader ("TestGpuCuller.frag", QUAD_FRAGMENT_SOURCE);
+    ShaderFile computeShader ("TestGpuCuller.comp", COMPUTE_SOURCE);
+    CountingContext<SoftwareOpenGLContext> context (40, 40);
+    ShaderProgram program (&context);
+    program.build (vertexShader.getPath (), fragmentShader.getPath ());
+    ShaderProgram cullProgram (&context);
+    cullProgram.buildCompute (computeShader.getPath ());
+    UniformBuffer camera (&context, sizeof (CameraBlock), CAMERA_BLOCK_BINDING);
+    setCamera (camera);
+    Material first (Vector3 (1, 0, 0), Vector3 (1, 0, 0), Vector3 (0, 0, 0), Vector3 (0, 0, 0), 1);
+    Material second (Vector3 (0, 1, 0), Vector3 (0, 1, 0), Vector3 (0, 0, 0), Vector3 (0, 0, 0), 1);
+    MaterialTable materials (&context);
+    materials.add (&first);
+    materials.add (&second);
+    GeometryArena arena (&context);
+    TransformHierarchy hierarchy;
+    Mesh left (&context, &program, &second);
+    Mesh right (&context, &program, &first);
+    left.addGeometry (makeQuad (-1, 0, 1, 0));
+    right.addGeometry (makeQuad (0, 1, 0, 1));
+    for (Mesh* mesh : { &left, &right })
+    {
+      mesh->addIndices (QUAD_INDICES);
+      mesh->setArena (&arena);
+      mesh->prepareVao ();
+      mesh->attachToHierarchy (&hierarchy);
+    }
+    hierarchy.update ();
+    GpuCuller culler (&context, &cullProgram);
+    culler.setObjects ({ &left, &right });
+    culler.setWorldMatrices (hierarchy.getWorldMatrices (), hierarchy.getNodeCapacity ());
+
+    WHEN ("I cull and submit them.") {
+      culler.cull ();
+      culler.submit (&program);
+      THEN ("Each batch counts and draws its own quad, in Material order.") {
+	REQUIRE (culler.getBatchCount () == 2);
+	REQUIRE (readUint (context, culler.getCountBuffer (), 0) == 1);
+	REQUIRE (readUint (context, culler.getCountBuffer (), 1) == 1);
+	REQUIRE (readUint (context, culler.getCommandBuffer (), 2)
+		 == right.getRange ()->firstIndex);
+	REQUIRE (readUint (context, culler.getCommandBuffer (), 5 + 2)
+		 == left.getRange ()->firstIndex);
+	REQUIRE (context.calls["multiDrawElementsIndirectCount"] == 2);
+	REQUIRE (read (context, 5, 20, 0) >= 240);
+	REQUIRE (read (context, 35, 20, 1) >= 240);
+      }
+    }
+  }
+}
+
+SCENARIO ("Meshes and GpuCuller pick the same level of detail.", "[GpuCuller][Mesh][A09]") {
+  GIVEN ("A quad whose second level is one triangle, from 0.3 radii away.") {
+    ShaderFile vertexShader ("TestGpuCuller.vert", QUAD_VERTEX_SOURCE);
+    ShaderFile fragmentShader ("TestGpuCuller.frag", QUAD_FRAGMENT_SOURCE);
+    ShaderFile computeShader ("TestGpuCuller.comp", COMPUTE_SOURCE);
+    CountingContext<SoftwareOpenGLContext> context (40, 40);
+    ShaderProgram program (&context);
+    program.build (vertexShader.getPath (), fragmentShader.getPath ());
+    ShaderProgram cullProgram (&context);
+    cullProgram.buildCompute (computeShader.getPath ());
+    UniformBuffer camera (&context, sizeof (CameraBlock), CAMERA_BLOCK_BINDING);
+    setCamera (camera);
+    GeometryArena arena (&context);
+    TransformHierarchy hierarchy;
+    Mesh quad (&context, &program);
+    quad.addGeometry (makeQuad (-0.5f, 0.5f, 1, 1));
+    quad.addIndices (QUAD_INDICES);
+    quad.addLevelOfDetail ({ 0, 1, 2 }, 0.3f);
+    quad.setArena (&arena);
+    quad.prepareVao ();
+    quad.attachToHierarchy (&hierarchy);
+    hierarchy.update ();
+    GpuCuller culler (&context, &cullProgram);
+    culler.setObjects ({ &quad });
+
+    THEN ("Both levels share one range, the full one first.") {
+      REQUIRE (quad.getLevelOfDetailCount () == 2);
+      REQUIRE (quad.getRange ()->indexCount == 9);
+      REQUIRE (quad.getLevelOfDetail (0).indexCount == 6);
+      REQUIRE (quad.getLevelOfDetail (1).firstIndex == 6);
+      REQUIRE (quad.getLevelOfDetail (1).indexCount == 3);
+    }
+
+    WHEN ("It is at the eye.") {
+      culler.setWorldMatrices (hierarchy.getWorldMatrices (), hierarchy.getNodeCapacity ());
+      culler.cull ();
+      culler.submit (&program);
+      context.flush ();
+      THEN ("The full level is drawn.") {
+	REQUIRE (quad.selectLevelOfDetail (hierarchy.getWorldMatrix (quad.getNode ())) == 0);
+	REQUIRE (readUint (context, culler.getCommandBuffer (), 0) == 6);
+	REQUIRE (context.getTriangleCount () == 2);
+      }
+    }
+
+    WHEN ("It is moved 0.45 radii away.") {
+      quad.moveWorld (-0.5f, Vector3 (0, 0, 1));
+      hierarchy.update ();
+      culler.setWorldMatrices (hierarchy.getWorldMatrices (), hierarchy.getNodeCapacity ());
+      culler.cull ();
+      culler.submit (&program);
+      context.flush ();
+      THEN ("The coarse level is drawn instead.") {
+	REQUIRE (quad.selectLevelOfDetail (hierarchy.getWorldMatrix (quad.getNode ())) == 1);
+	REQUIRE (readUint (context, culler.getCommandBuffer (), 0) == 3);
+	REQUIRE (readUint (context, culler.getCommandBuffer (), 2)
+		 == quad.getRange ()->firstIndex + 6);
+	REQUIRE (context.getTriangleCount () == 1);
+      }
+    }
+  }
+}
+
+SCENARIO ("simplifyIndices merges the vertices in each grid cell.", "[Geometry][A09]") {
+  GIVEN ("A quad of two triangles, one unit on a side.") {
+    std::vector<float> data = { 0, 0, 0,  1, 0, 0,  1, 1, 0,  0, 1, 0 };
+
+    WHEN ("I simplify it with cells smaller than its vertices' spacing.") {
+      std::vector<unsigned int> indices = simplifyIndices (data, 3, QUAD_INDICES, 0.5f);
+      THEN ("It is unchanged.") {
+	REQUIRE (indices == QUAD_INDICES);
+      }
+    }
+
+    WHEN ("I simplify it with one cell around all of it.") {
+      std::vector<unsigned int> indices = simplifyIndices (data, 3, QUAD_INDICES, 4.0f);
+      THEN ("Every triangle collapses, and is dropped.") {
+	REQUIRE (indices.empty ());
+      }
+    }
+  }
+}
@@ -0,0 +1,169 @@
+/// \file TestGpuProfiler.cpp
+/// \brief A collection of Catch2 unit tests for the GpuProfiler class, which
+///   time scopes through a context whose clock the tests move by hand.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <map>
+
+#include "GpuProfiler.hpp"
+#include "NullOpenGLContext.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// The number of nanoseconds in a millisecond.
+  const GLuint64 MILLI = 1000000;
+
+  /// \brief A context whose timestamps are read from a clock that only moves
+  ///   when a test moves it.
+  class ClockContext : public NullOpenGLContext
+  {
+  public:
+
+    virtual void
+    getQueryObjectiv (GLuint id, GLenum pname, GLint* params)
+    {
+      *params = ready ? GL_TRUE : GL_FALSE;
+    }
+
+    virtual void
+    getQueryObjectui64v (GLuint id, GLenum pname, GLuint64* params)
+    {
+      ++reads;
+      *params = stamps[id];
+    }
+
+    virtual void
+    queryCounter (GLuint id, GLenum target)
+    {
+      stamps[id] = clock;
+    }
+
+    /// The current time, in nanoseconds.
+    GLuint64 clock = 0;
+    /// Whether or not queries report their results as available.
+    bool ready = true;
+    /// The number of results read.
+    unsigned int reads = 0;
+    /// The time written into each query.
+    std::map<GLuint, GLuint64> stamps;
+  };
+
+  /// \brief Finds a scope's statistics.
+  /// \param[in] profiler The profiler.
+  /// \param[in] name The scope's name.
+  /// \return Its statistics, or ones for no frames if it has none.
+  GpuScopeStats
+  find (const GpuProfiler& profiler, const std::string& name)
+  {
+    for (const GpuScopeStats& stats : profiler.getStats ())
+      if (stats.name == name)
+        return stats;
+    return GpuScopeStats { name, 0, 0.0, 0.0, 0.0, 0.0 };
+  }
+}
+
+SCENARIO ("GpuProfiler reads each frame back FRAME_LATENCY frames later.", "[GpuProfiler][A09]") {
+  GIVEN ("A profiler attached to a context.") {
+    ClockContext context;
+    GpuProfiler profiler (&context);
+    context.setProfiler (&profiler);
+
+    WHEN ("I time 100 frames whose pass takes 1 ms longer each frame.") {
+      for (GLuint64 frame = 1; frame <= 100; ++frame) {
+	profiler.beginFrame ();
+	context.beginScope ("clear");
+	context.clock += MILLI;
+	context.endScope ();
+	context.beginScope ("opaque pass");
+	context.clock += frame * MILLI;
+	context.endScope ();
+	profiler.endFrame ();
+      }
+
+      THEN ("Only the frames before the last FRAME_LATENCY have times.") {
+	REQUIRE (profiler.getResolvedFrameCount () == 100 - GpuProfiler::FRAME_LATENCY);
+	REQUIRE (find (profiler, "opaque pass").frames == 100 - GpuProfiler::FRAME_LATENCY);
+      }
+      THEN ("Once the rest are read back, each scope's statistics are right.") {
+	for (unsigned int i = 0; i < GpuProfiler::FRAME_LATENCY; ++i)
+	  profiler.beginFrame ();
+	GpuScopeStats pass = find (profiler, "opaque pass");
+	REQUIRE (pass.frames == 100);
+	REQUIRE (pass.minMillis == Approx (1.0));
+	REQUIRE (pass.averageMillis == Approx (50.5));
+	REQUIRE (pass.p99Millis == Approx (99.0));
+	REQUIRE (pass.maxMillis == Approx (100.0));
+	GpuScopeStats clear = find (profiler, "clear");
+	REQUIRE (clear.minMillis == Approx (1.0));
+	REQUIRE (clear.maxMillis == Approx (1.0));
+	REQUIRE (find (profiler, "frame").maxMillis == Approx (101.0));
+	REQUIRE (profiler.getStats ()[0].name == "frame");
+      }
+    }
+
+    WHEN ("I enter the same scope twice in a frame.") {
+      profiler.beginFrame ();
+      for (int i = 0; i < 2; ++i) {
+	context.beginScope ("draw");
+	context.clock += 3 * MILLI;
+	context.endScope ();
+      }
+      profiler.endFrame ();
+      for (unsigned int i = 0; i < GpuProfiler::FRAME_LATENCY; ++i)
+	profiler.beginFrame ();
+      THEN ("Its time for the frame is the sum.") {
+	REQUIRE (find (profiler, "draw").frames == 1);
+	REQUIRE (find (profiler, "draw").averageMillis == Approx (6.0));
+      }
+    }
+
+    WHEN ("The GPU hasn't finished a frame by the time it is read back.") {
+      context.ready = false;
+      for (unsigned int i = 0; i <= GpuProfiler::FRAME_LATENCY; ++i) {
+	profiler.beginFrame ();
+	context.beginScope ("clear");
+	context.endScope ();
+	profiler.endFrame ();
+      }
+      THEN ("Its times are dropped without being waited for.") {
+	REQUIRE (context.reads == 0);
+	REQUIRE (profiler.getDroppedFrameCount () == 1);
+	REQUIRE (profiler.getResolvedFrameCount () == 0);
+	REQUIRE (profiler.getStats ().empty ());
+      }
+    }
+
+    WHEN ("I time detailed scopes before and after turning on detailed mode.") {
+      profiler.beginFrame ();
+      profiler.setDetailed (true);
+      context.beginScope ("mesh", true);
+      context.clock += MILLI;
+      context.endScope (true);
+      profiler.endFrame ();
+      profiler.beginFrame ();
+      context.beginScope ("mesh", true);
+      context.clock += 2 * MILLI;
+      context.endScope (true);
+      profiler.endFrame ();
+      for (unsigned int i = 0; i < GpuProfiler::FRAME_LATENCY; ++i)
+	profiler.beginFrame ();
+      THEN ("Only the frame begun after it was turned on times them.") {
+	REQUIRE (profiler.isDetailed ());
+	REQUIRE (find (profiler, "mesh").frames == 1);
+	REQUIRE (find (profiler, "mesh").averageMillis == Approx (2.0));
+      }
+    }
+
+    WHEN ("I time a scope outside of any frame.") {
+      context.beginScope ("clear");
+      context.endScope ();
+      THEN ("No query is made.") {
+	REQUIRE (context.stamps.empty ());
+      }
+    }
+  }
+}
@@ -0,0 +1,69 @@
+/// \file TestJobSystem.cpp
+/// \brief A collection of Catch2 unit tests for the JobSystem class.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "JobSystem.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("JobSystem parallel loops.", "[JobSystem][A09]") {
+  for (unsigned int workers : { 1u, 4u }) {
+    GIVEN ("A JobSystem with " + std::to_string (workers) + " workers.") {
+      JobSystem jobs (workers);
+      REQUIRE (jobs.getWorkerCount () == workers);
+      REQUIRE (jobs.getCurrentWorker () == 0);
+
+      WHEN ("I run a parallel loop over 10000 indexes in grains of 100.") {
+	std::vector<int> hits (10000, 0);
+	jobs.parallelFor (0, 10000, 100,
+			  [&hits] (unsigned int first, unsigned int last)
+			  {
+			    for (unsigned int i = first; i < last; ++i)
+			      ++hits[i];
+			  });
+	THEN ("Every index was handled exactly once.") {
+	  for (int h : hits)
+	    REQUIRE (h == 1);
+	}
+      }
+    }
+  }
+}
+
+SCENARIO ("JobSystem dependencies.", "[JobSystem][A09]") {
+  GIVEN ("A JobSystem with 4 workers.") {
+    JobSystem jobs (4);
+
+    WHEN ("I start 100 jobs, and one more that depends on all of them.") {
+      std::atomic<int> done (0);
+      int seenByLast = -1;
+      JobCounter first;
+      JobCounter last;
+      for (int i = 0; i < 100; ++i)
+	jobs.run ([&done] () { ++done; }, &first);
+      jobs.runAfter (first, [&done, &seenByLast] () { seenByLast = done; }, &last);
+      jobs.wait (last);
+      THEN ("The last job ran after all of the others.") {
+	REQUIRE (first.isDone ());
+	REQUIRE (seenByLast == 100);
+      }
+    }
+
+    WHEN ("I make a job depend on a counter that is already done.") {
+      JobCounter nothing;
+      JobCounter after;
+      bool ran = false;
+      jobs.runAfter (nothing, [&ran] () { ran = true; }, &after);
+      jobs.wait (after);
+      THEN ("It still runs.") {
+	REQUIRE (ran);
+      }
+    }
+  }
+}
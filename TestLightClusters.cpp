@@ -0,0 +1,313 @@
+/// \file TestLightClusters.cpp
+/// \brief A collection of Catch2 unit tests for the LightClusters class,
+///   which check the lights it assigns to each cluster by brute force: every
+///   cluster that a point of a light's sphere falls in lists the light, and
+///   no cluster whose box the sphere misses does.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "LightClusters.hpp"
+#include "LightSource.hpp"
+#include "NullOpenGLContext.hpp"
+#include "TestContexts.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// \brief Makes a point light that reaches a given distance.
+  /// \param[in] x The x of its eye-space position.
+  /// \param[in] y The y of its eye-space position.
+  /// \param[in] z The z of its eye-space position.
+  /// \param[in] range How far it reaches.
+  LightBlockEntry
+  makeLight (float x, float y, float z, float range)
+  {
+    LightBlockEntry light = {};
+    light.type = POINT;
+    for (int i = 0; i < 3; ++i)
+      light.diffuseIntensity[i] = 1.0f;
+    light.position[0] = x;
+    light.position[1] = y;
+    light.position[2] = z;
+    // 1 / (1 + q d^2) reaches LIGHT_CUTOFF at d = range.
+    light.attenuationCoefficients[0] = 1.0f;
+    light.attenuationCoefficients[2] = (1.0f / LIGHT_CUTOFF - 1.0f) / (range * range);
+    return light;
+  }
+
+  /// \brief Makes lights scattered around and beyond a view.
+  /// \param[in] count The number of lights.
+  /// \param[in] nearest The largest eye-space z of a light's position.
+  /// \param[in] farthest The smallest eye-space z of a light's position.
+  std::vector<LightBlockEntry>
+  makeLights (unsigned int count, float nearest, float farthest)
+  {
+    std::mt19937 random (375);
+    std::uniform_real_distribution<float> across (-40.0f, 40.0f);
+    std::uniform_real_distribution<float> depth (farthest, nearest);
+    std::uniform_real_distribution<float> range (0.5f, 20.0f);
+    std::vector<LightBlockEntry> lights;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      float x = across (random);
+      float y = across (random);
+      float z = depth (random);
+      lights.push_back (makeLight (x, y, z, range (random)));
+    }
+    return lights;
+  }
+
+  /// \brief Gets what was last uploaded behind a buffer texture.
+  /// \param[in] context The context a LightClusters uploaded through.
+  /// \param[in] internalformat The buffer texture's format.
+  std::vector<GLuint>
+  getContents (CountingContext<NullOpenGLContext>& context, GLenum internalformat)
+  {
+    const std::vector<unsigned char>& bytes
+      = context.contents[context.textureBuffers[internalformat]];
+    std::vector<GLuint> words (bytes.size () / sizeof (GLuint));
+    std::memcpy (words.data (), bytes.data (), words.size () * sizeof (GLuint));
+    return words;
+  }
+
+  /// \brief Reads back every cluster's list of lights.
+  /// \param[in] context The context a LightClusters uploaded through.
+  /// \return Each cluster's light indices, sorted.
+  std::vector<std::vector<GLuint>>
+  readLists (CountingContext<NullOpenGLContext>& context)
+  {
+    const std::vector<GLuint> grid = getContents (context, GL_RG32UI);
+    const std::vector<GLuint> indices = getContents (context, GL_R32UI);
+    std::vector<std::vector<GLuint>> lists;
+    for (unsigned int cluster = 0; 2 * cluster < grid.size (); ++cluster)
+    {
+      std::vector<GLuint>::const_iterator first = indices.begin () + grid[2 * cluster];
+      lists.emplace_back (first, first + grid[2 * cluster + 1]);
+      std::sort (lists.back ().begin (), lists.back ().end ());
+    }
+    return lists;
+  }
+
+  /// \brief Gets the eye-space depth at which a slice begins, the way the
+  ///   grid is sliced.
+  double
+  getSliceDepth (double near, double far, unsigned int slice)
+  {
+    return near * std::pow (far / near, double (slice) / CLUSTER_GRID_Z);
+  }
+
+  /// \brief Counts the (light, cluster) pairs where a point inside the
+  ///   light's sphere falls in the cluster, but the cluster does not list
+  ///   the light.  Each sphere is sampled on a 16x16x16 grid, and each point
+  ///   is projected to find its cluster.
+  /// \param[in] lists Each cluster's lights.
+  /// \param[in] projection The projection the lists were made for.
+  /// \param[in] near The near plane's distance.
+  /// \param[in] far The far plane's distance.
+  /// \param[in] lights The lights the lists were made from.
+  /// \return The number of lights missing from clusters.
+  unsigned int
+  countMissed (const std::vector<std::vector<GLuint>>& lists, const Matrix4& projection,
+               double near, double far, const std::vector<LightBlockEntry>& lights)
+  {
+    const int SAMPLES = 16;
+    const float* p = projection.data ();
+    unsigned int missed = 0;
+    for (GLuint light = 0; light < lights.size (); ++light)
+    {
+      const float* center = lights[light].position;
+      // Stay just inside the sphere, so rounding cannot matter.
+      double radius = 0.999 * LightClusters::getRange (lights[light]);
+      std::vector<bool> reached (lists.size (), false);
+      for (int i = 0; i < SAMPLES; ++i)
+        for (int j = 0; j < SAMPLES; ++j)
+          for (int k = 0; k < SAMPLES; ++k)
+          {
+            double offset[3] = { 2.0 * i / (SAMPLES - 1) - 1.0,
+                                 2.0 * j / (SAMPLES - 1) - 1.0,
+                                 2.0 * k / (SAMPLES - 1) - 1.0 };
+            if (offset[0] * offset[0] + offset[1] * offset[1] + offset[2] * offset[2] > 1.0)
+              continue;
+            double eye[4] = { center[0] + radius * offset[0], center[1] + radius * offset[1],
+                              center[2] + radius * offset[2], 1.0 };
+            double depth = -eye[2];
+            if (depth < near || depth >= far)
+              continue;
+            double clip[4] = { 0.0, 0.0, 0.0, 0.0 };
+            for (int row = 0; row < 4; ++row)
+              for (int column = 0; column < 4; ++column)
+                clip[row] += p[4 * column + row] * eye[column];
+            double ndc[2] = { clip[0] / clip[3], clip[1] / clip[3] };
+            if (std::abs (ndc[0]) >= 1.0 || std::abs (ndc[1]) >= 1.0)
+              continue;
+            unsigned int x = (ndc[0] + 1.0) / 2.0 * CLUSTER_GRID_X;
+            unsigned int y = (ndc[1] + 1.0) / 2.0 * CLUSTER_GRID_Y;
+            unsigned int z = std::log (depth / near) / std::log (far / near) * CLUSTER_GRID_Z;
+            reached[x + CLUSTER_GRID_X * (y + CLUSTER_GRID_Y * z)] = true;
+          }
+      for (unsigned int cluster = 0; cluster < lists.size (); ++cluster)
+        if (reached[cluster] && !std::binary_search (lists[cluster].begin (),
+                                                     lists[cluster].end (), light))
+          ++missed;
+    }
+    return missed;
+  }
+
+  /// \brief Counts the (light, cluster) pairs where the cluster lists the
+  ///   light, but the light's sphere does not touch the cluster's eye-space
+  ///   bounding box.  Every box is worked out from the projection, by
+  ///   solving clip = P eye for eye x and y at each corner's depth.
+  /// \param[in] lists Each cluster's lights.
+  /// \param[in] projection The projection the lists were made for.
+  /// \param[in] near The near plane's distance.
+  /// \param[in] far The far plane's distance.
+  /// \param[in] lights The lights the lists were made from.
+  /// \return The number of lights in clusters they cannot reach.
+  unsigned int
+  countUnreached (const std::vector<std::vector<GLuint>>& lists, const Matrix4& projection,
+                  double near, double far, const std::vector<LightBlockEntry>& lights)
+  {
+    const float* p = projection.data ();
+    unsigned int unreached = 0;
+    for (unsigned int z = 0; z < CLUSTER_GRID_Z; ++z)
+      for (unsigned int y = 0; y < CLUSTER_GRID_Y; ++y)
+        for (unsigned int x = 0; x < CLUSTER_GRID_X; ++x)
+        {
+          double min[3] = { 1e30, 1e30, -getSliceDepth (near, far, z + 1) };
+          double max[3] = { -1e30, -1e30, -getSliceDepth (near, far, z) };
+          for (double eyeZ : { min[2], max[2] })
+          {
+            double w = p[11] * eyeZ + p[15];
+            for (unsigned int j = y; j <= y + 1; ++j)
+              for (unsigned int i = x; i <= x + 1; ++i)
+              {
+                double ndc[2] = { -1.0 + 2.0 * i / CLUSTER_GRID_X,
+                                  -1.0 + 2.0 * j / CLUSTER_GRID_Y };
+                for (int axis = 0; axis < 2; ++axis)
+                {
+                  double eye = (ndc[axis] * w - p[8 + axis] * eyeZ - p[12 + axis])
+                    / p[5 * axis];
+                  min[axis] = std::min (min[axis], eye);
+                  max[axis] = std::max (max[axis], eye);
+                }
+              }
+          }
+
+          for (GLuint light : lists[x + CLUSTER_GRID_X * (y + CLUSTER_GRID_Y * z)])
+          {
+            double distanceSquared = 0.0;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+              double center = lights[light].position[axis];
+              double offset = center - std::max (min[axis], std::min (center, max[axis]));
+              distanceSquared += offset * offset;
+            }
+            // Allow for the rounding of LightClusters' own boxes.
+            double range = 1.001 * LightClusters::getRange (lights[light]);
+            if (distanceSquared > range * range)
+              ++unreached;
+          }
+        }
+    return unreached;
+  }
+}
+
+SCENARIO ("LightClusters assigns each light to the clusters it reaches.", "[LightClusters][A09]") {
+  GIVEN ("300 point lights around and beyond a view from 0.1 to 100.") {
+    CountingContext<NullOpenGLContext> context;
+    LightClusters clusters (&context);
+    std::vector<LightBlockEntry> lights = makeLights (300, 5.0f, -110.0f);
+
+    WHEN ("I cluster them for a symmetric perspective projection.") {
+      Matrix4 projection;
+      projection.setToPerspectiveProjection (60.0, 16.0 / 9.0, 0.1, 100.0);
+      clusters.update (projection, lights);
+      THEN ("Each cluster lists the lights that reach it, and no others.") {
+	std::vector<std::vector<GLuint>> lists = readLists (context);
+	REQUIRE (countMissed (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (countUnreached (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (clusters.getIndexCount () > 0);
+      }
+    }
+
+    WHEN ("I cluster them for an off-centre perspective projection.") {
+      Matrix4 projection;
+      projection.setToPerspectiveProjection (-0.02, 0.1, -0.07, 0.03, 0.1, 100.0);
+      clusters.update (projection, lights);
+      THEN ("Each cluster lists the lights that reach it, and no others.") {
+	std::vector<std::vector<GLuint>> lists = readLists (context);
+	REQUIRE (countMissed (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (countUnreached (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (clusters.getIndexCount () > 0);
+      }
+    }
+
+    WHEN ("I cluster them for an off-centre orthographic projection.") {
+      Matrix4 projection;
+      projection.setToOrthographicProjection (-10.0, 30.0, -25.0, 5.0, 0.1, 100.0);
+      clusters.update (projection, lights);
+      THEN ("Each cluster lists the lights that reach it, and no others.") {
+	std::vector<std::vector<GLuint>> lists = readLists (context);
+	REQUIRE (countMissed (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (countUnreached (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (clusters.getIndexCount () > 0);
+      }
+    }
+  }
+
+  GIVEN ("300 point lights around the camera, many of them crossing the near plane.") {
+    CountingContext<NullOpenGLContext> context;
+    LightClusters clusters (&context);
+    std::vector<LightBlockEntry> lights = makeLights (300, 2.0f, -3.0f);
+
+    WHEN ("I cluster them for a symmetric perspective projection.") {
+      Matrix4 projection;
+      projection.setToPerspectiveProjection (60.0, 16.0 / 9.0, 0.1, 100.0);
+      clusters.update (projection, lights);
+      THEN ("Each cluster lists the lights that reach it, and no others.") {
+	std::vector<std::vector<GLuint>> lists = readLists (context);
+	REQUIRE (countMissed (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (countUnreached (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (clusters.getIndexCount () > 0);
+      }
+    }
+
+    WHEN ("I cluster them for an off-centre perspective projection.") {
+      Matrix4 projection;
+      projection.setToPerspectiveProjection (-0.02, 0.1, -0.07, 0.03, 0.1, 100.0);
+      clusters.update (projection, lights);
+      THEN ("Each cluster lists the lights that reach it, and no others.") {
+	std::vector<std::vector<GLuint>> lists = readLists (context);
+	REQUIRE (countMissed (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (countUnreached (lists, projection, 0.1, 100.0, lights) == 0);
+	REQUIRE (clusters.getIndexCount () > 0);
+      }
+    }
+  }
+
+  GIVEN ("A point light just in front of the camera that reaches behind it.") {
+    CountingContext<NullOpenGLContext> context;
+    LightClusters clusters (&context);
+    std::vector<LightBlockEntry> lights = { makeLight (0.0f, 0.0f, -0.05f, 0.5f) };
+    Matrix4 projection;
+    projection.setToPerspectiveProjection (60.0, 16.0 / 9.0, 0.1, 100.0);
+
+    WHEN ("I cluster it.") {
+      clusters.update (projection, lights);
+      THEN ("Every tile of the nearest slice lists it.") {
+	std::vector<std::vector<GLuint>> lists = readLists (context);
+	for (unsigned int cluster = 0; cluster < CLUSTER_GRID_X * CLUSTER_GRID_Y; ++cluster)
+	  REQUIRE (lists[cluster].size () == 1);
+	REQUIRE (countUnreached (lists, projection, 0.1, 100.0, lights) == 0);
+      }
+    }
+  }
+}
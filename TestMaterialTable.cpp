@@ -0,0 +1,142 @@
+/// \file TestMaterialTable.cpp
+/// \brief A collection of Catch2 unit tests for the MaterialTable class and
+///   the UniformBuffer behind it, which check that only the bytes of a
+///   Material that changed are uploaded.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstddef>
+#include <vector>
+
+#include "Material.hpp"
+#include "MaterialTable.hpp"
+#include "NullOpenGLContext.hpp"
+#include "TestContexts.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// A shininess whose every byte differs from those of 1.0f, so changing
+  ///   one to the other changes all four.
+  const float NEW_SHININESS = 3.14159274f;
+}
+
+SCENARIO ("MaterialTable only uploads the Materials that changed.", "[MaterialTable][UniformBuffer][A09]") {
+  GIVEN ("A table of two Materials, updated once.") {
+    CountingContext<NullOpenGLContext> context;
+    MaterialTable table (&context);
+    Material first (Vector3 (0.1f, 0.1f, 0.1f), Vector3 (1, 0, 0), Vector3 (1, 1, 1),
+                    Vector3 (0, 0, 0), 1.0f);
+    Material second (Vector3 (0.1f, 0.1f, 0.1f), Vector3 (0, 1, 0), Vector3 (1, 1, 1),
+                     Vector3 (0, 0, 0), 1.0f);
+    table.add (&first);
+    table.add (&second);
+    table.update ();
+
+    THEN ("The first update uploads the whole block.") {
+      REQUIRE (context.uploads.size () == 1);
+      REQUIRE (context.uploads[0].offset == 0);
+      REQUIRE (context.uploads[0].size == sizeof (MaterialBlock));
+    }
+
+    WHEN ("I update it again with nothing changed.") {
+      context.uploads.clear ();
+      table.update ();
+      THEN ("Nothing is uploaded, but the block is bound again.") {
+	REQUIRE (context.uploads.empty ());
+	REQUIRE (context.calls["bindBufferBase"] == 3);
+      }
+    }
+
+    WHEN ("I change the second Material's shininess and update it.") {
+      context.uploads.clear ();
+      second.m_shininess = NEW_SHININESS;
+      table.update ();
+      THEN ("Exactly that float is uploaded.") {
+	REQUIRE (context.uploads.size () == 1);
+	REQUIRE (context.uploads[0].offset == sizeof (MaterialBlockEntry)
+		 + offsetof (MaterialBlockEntry, specularPower));
+	REQUIRE (context.uploads[0].size == sizeof (float));
+      }
+    }
+
+    WHEN ("I change the first and last properties of the first Material and update it.") {
+      context.uploads.clear ();
+      first.m_ambient = Vector3 (0.5f, 0.1f, 0.1f);
+      first.m_emissive = Vector3 (0.0f, 0.0f, 0.5f);
+      table.update ();
+      THEN ("One upload covers both, without reaching the second Material.") {
+	REQUIRE (context.uploads.size () == 1);
+	REQUIRE (context.uploads[0].offset < sizeof (float));
+	REQUIRE (context.uploads[0].offset + context.uploads[0].size
+		 > offsetof (MaterialBlockEntry, emissiveIntensity) + 2 * sizeof (float));
+	REQUIRE (context.uploads[0].offset + context.uploads[0].size
+		 <= sizeof (MaterialBlockEntry));
+      }
+    }
+  }
+}
+
+SCENARIO ("MaterialTable lets go of a Material once its last user removes it.", "[MaterialTable][A09]") {
+  GIVEN ("A table with one Material added twice, as by two Meshes.") {
+    CountingContext<NullOpenGLContext> context;
+    MaterialTable table (&context);
+    Material first (Vector3 (0.1f, 0.1f, 0.1f), Vector3 (1, 0, 0), Vector3 (1, 1, 1),
+                    Vector3 (0, 0, 0), 1.0f);
+    Material second (Vector3 (0.1f, 0.1f, 0.1f), Vector3 (0, 1, 0), Vector3 (1, 1, 1),
+                     Vector3 (0, 0, 0), 1.0f);
+    table.add (&first);
+    table.add (&first);
+
+    WHEN ("I remove it once.") {
+      table.remove (&first);
+      THEN ("It keeps its index.") {
+	REQUIRE (first.getTableIndex () == 0);
+	REQUIRE (table.size () == 1);
+      }
+    }
+
+    WHEN ("I remove it twice, and add another Material.") {
+      table.remove (&first);
+      table.remove (&first);
+      table.add (&second);
+      THEN ("It has no index, and the other Material reuses its index.") {
+	REQUIRE (first.getTableIndex () == -1);
+	REQUIRE (second.getTableIndex () == 0);
+	REQUIRE (table.size () == 1);
+      }
+    }
+
+    WHEN ("I remove a Material that was never added.") {
+      table.remove (&second);
+      THEN ("Nothing changes.") {
+	REQUIRE (first.getTableIndex () == 0);
+	REQUIRE (second.getTableIndex () == -1);
+	REQUIRE (table.size () == 1);
+      }
+    }
+  }
+
+  GIVEN ("A full table.") {
+    CountingContext<NullOpenGLContext> context;
+    MaterialTable table (&context);
+    std::vector<Material> materials (MAX_MATERIALS + 1,
+                                     Material (Vector3 (), Vector3 (), Vector3 (), Vector3 (), 1.0f));
+    for (unsigned int i = 0; i < MAX_MATERIALS; ++i)
+      table.add (&materials[i]);
+
+    WHEN ("I add one more Material, and remove it.") {
+      unsigned int index = table.add (&materials[MAX_MATERIALS]);
+      int drawn = materials[MAX_MATERIALS].getTableIndex ();
+      table.remove (&materials[MAX_MATERIALS]);
+      THEN ("It is drawn with material 0, which is still registered.") {
+	REQUIRE (index == 0);
+	REQUIRE (drawn == 0);
+	REQUIRE (table.size () == MAX_MATERIALS);
+	REQUIRE (materials[0].getTableIndex () == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,49 @@
+/// \file TestNullOpenGLContext.cpp
+/// \brief A collection of Catch2 unit tests for the NullOpenGLContext class,
+///   which check the uniform introspection it does for ShaderProgram.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <string>
+
+#include "NullOpenGLContext.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("NullOpenGLContext introspects the uniforms of its programs.", "[NullOpenGLContext][A09]") {
+  GIVEN ("A program linked from a shader that declares two uniforms and a block.") {
+    NullOpenGLContext null;
+    const GLchar* source = "uniform mat4 uWorld;\n"
+      "uniform vec3 uColors[4]; // tinted\n"
+      "layout(std140) uniform LightBlock\n{\n  vec4 position;\n};\n";
+    GLuint shader = null.createShader (GL_VERTEX_SHADER);
+    null.shaderSource (shader, 1, &source, nullptr);
+    GLuint program = null.createProgram ();
+    null.attachShader (program, shader);
+    null.linkProgram (program);
+
+    THEN ("Both uniforms are active, with an array reported by its first element.") {
+      GLint count = 0;
+      null.getProgramiv (program, GL_ACTIVE_UNIFORMS, &count);
+      REQUIRE (count == 2);
+      GLchar name[32];
+      GLint size = 0;
+      GLenum type = 0;
+      null.getActiveUniform (program, 1, sizeof (name), nullptr, &size, &type, name);
+      REQUIRE (std::string (name) == "uColors[0]");
+      REQUIRE (size == 4);
+      REQUIRE (type == GL_FLOAT_VEC3);
+    }
+    THEN ("Every element of the array has its own location.") {
+      REQUIRE (null.getUniformLocation (program, "uWorld") == 0);
+      REQUIRE (null.getUniformLocation (program, "uColors") == 1);
+      REQUIRE (null.getUniformLocation (program, "uColors[3]") == 4);
+      REQUIRE (null.getUniformLocation (program, "uMissing") == -1);
+    }
+    THEN ("The block is found, and only the block.") {
+      REQUIRE (null.getUniformBlockIndex (program, "LightBlock") == 0);
+      REQUIRE (null.getUniformBlockIndex (program, "position") == GL_INVALID_INDEX);
+    }
+  }
+}
@@ -0,0 +1,52 @@
+/// \file TestOcclusionBuffer.cpp
+/// \brief A collection of Catch2 unit tests for the OcclusionBuffer class.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <vector>
+
+#include "OcclusionBuffer.hpp"
+#include "JobSystem.hpp"
+#include "Matrix4.hpp"
+#include "Vector3.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("OcclusionBuffer hides objects behind occluders.", "[OcclusionBuffer][A09]") {
+  GIVEN ("A camera at the origin and a 10x10 wall 10 units in front of it.") {
+    Matrix4 projection;
+    projection.setToPerspectiveProjection (60.0, 2.0, 1.0, 100.0);
+    const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    // Positions interleaved with unused colors, as in a Mesh.
+    std::vector<float> wall = { -5, -5, -10, 0, 0, 0,   5, -5, -10, 0, 0, 0,
+                                 5,  5, -10, 0, 0, 0,  -5,  5, -10, 0, 0, 0 };
+    std::vector<unsigned int> indices = { 0, 1, 2, 0, 2, 3 };
+    JobSystem jobs (2);
+    OcclusionBuffer buffer (64, 32);
+    buffer.begin (projection);
+    buffer.addOccluder (identity, wall.data (), 6, indices.data (), indices.size ());
+
+    WHEN ("I rasterize it.") {
+      buffer.rasterize (&jobs);
+      THEN ("The center of the screen holds the wall's depth and the corners are empty.") {
+	REQUIRE (buffer.getTriangleCount () == 2);
+	REQUIRE (buffer.getDepth (32, 16) < 1.0f);
+	REQUIRE (buffer.getDepth (0, 0) == 1.0f);
+	REQUIRE (buffer.getDepth (0, 0, 5) == 1.0f);
+      }
+      THEN ("A small object behind the wall is hidden.") {
+	float world[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, -20, 1 };
+	REQUIRE_FALSE (buffer.isVisible (world, Vector3 (), 1.0f));
+      }
+      THEN ("A small object in front of the wall is visible.") {
+	float world[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, -5, 1 };
+	REQUIRE (buffer.isVisible (world, Vector3 (), 1.0f));
+      }
+      THEN ("An object behind the wall but sticking out past its edge is visible.") {
+	float world[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 9, 0, -20, 1 };
+	REQUIRE (buffer.isVisible (world, Vector3 (), 2.0f));
+      }
+    }
+  }
+}
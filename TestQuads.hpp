@@ -0,0 +1,56 @@
+/// \file TestQuads.hpp
+/// \brief Helpers shared by the Catch2 unit tests that draw quads on a
+///   SoftwareOpenGLContext: the quads, the shaders they are drawn with, and
+///   reading back what was drawn.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef TEST_QUADS_HPP
+#define TEST_QUADS_HPP
+
+#include <string>
+#include <vector>
+
+#include "SoftwareOpenGLContext.hpp"
+
+/// The vertex shader a test draws quads with: drawn like Vec3.vert, but able
+///   to read its transformation from "uDrawData".
+const std::string QUAD_VERTEX_SOURCE = "#version 330\n"
+  "layout (location = 0) in vec3 aPosition;\n"
+  "layout (location = 1) in vec3 aColor;\n"
+  "uniform samplerBuffer uDrawData;\n"
+  "uniform int uDrawBase;\n"
+  "uniform mat4 uModelViewProjection;\n";
+
+/// The fragment shader a test draws quads with.
+const std::string QUAD_FRAGMENT_SOURCE = "#version 330\n";
+
+/// \brief Makes a quad, in clip space, of one color.
+/// \param[in] left The x of its left side.
+/// \param[in] right The x of its right side.
+/// \param[in] red The red of its color.
+/// \param[in] green The green of its color.
+/// \return Four vertices: position, then color.
+inline std::vector<float>
+makeQuad (float left, float right, float red, float green)
+{
+  return { left, -1, 0, red, green, 0,
+           right, -1, 0, red, green, 0,
+           right, 1, 0, red, green, 0,
+           left, 1, 0, red, green, 0 };
+}
+
+/// The two triangles of a quad from makeQuad.
+const std::vector<unsigned int> QUAD_INDICES = { 0, 1, 2, 0, 2, 3 };
+
+/// \brief Reads one channel of a pixel.
+/// \param[in] channel 0 for red, 1 for green, or 2 for blue.
+inline int
+read (SoftwareOpenGLContext& context, GLint x, GLint y, int channel)
+{
+  GLubyte rgb[3];
+  context.readPixel (x, y, rgb);
+  return rgb[channel];
+}
+
+#endif//TEST_QUADS_HPP
@@ -0,0 +1,80 @@
+/// \file TestShaderPermutations.cpp
+/// \brief A collection of Catch2 unit tests for the ShaderPermutations class,
+///   which check that each define set is built once, and what source each
+///   variant's shaders are given.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <string>
+
+#include "NullOpenGLContext.hpp"
+#include "ShaderPermutations.hpp"
+#include "TestContexts.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// The body of the vertex shader, after its "#version" line.
+  const std::string VERTEX_BODY = "uniform mat4 uWorld;\n";
+
+  /// The fragment shader, which has no "#version" line.
+  const std::string FRAGMENT_SOURCE = "uniform int uMode;\n";
+}
+
+SCENARIO ("ShaderPermutations builds each define set once.", "[ShaderPermutations][ShaderProgram][A09]") {
+  GIVEN ("The permutations of a pair of shaders.") {
+    ShaderFile vertexShader ("TestShaderPermutations.vert", "#version 330\n" + VERTEX_BODY);
+    ShaderFile fragmentShader ("TestShaderPermutations.frag", FRAGMENT_SOURCE);
+    CountingContext<NullOpenGLContext> context;
+    ShaderPermutations permutations (&context, vertexShader.getPath (),
+                                     fragmentShader.getPath ());
+    const std::string lights = "#define NUM_LIGHTS 2\n";
+
+    WHEN ("I get the same variant twice.") {
+      ShaderProgram* first = permutations.get (lights);
+      ShaderProgram* second = permutations.get (lights);
+      THEN ("The same program is returned, and it was built only once.") {
+	REQUIRE (first == second);
+	REQUIRE (permutations.getCount () == 1);
+	REQUIRE (context.calls["linkProgram"] == 1);
+	REQUIRE (context.sources.size () == 2);
+      }
+    }
+
+    WHEN ("I get variants with different defines.") {
+      ShaderProgram* two = permutations.get (lights);
+      ShaderProgram* three = permutations.get ("#define NUM_LIGHTS 3\n");
+      ShaderProgram* none = permutations.get ("");
+      THEN ("Each is a program of its own.") {
+	REQUIRE (two != three);
+	REQUIRE (none != two);
+	REQUIRE (none != three);
+	REQUIRE (two->getId () != three->getId ());
+	REQUIRE (permutations.getCount () == 3);
+	REQUIRE (context.calls["linkProgram"] == 3);
+	REQUIRE (permutations.get ("#define NUM_LIGHTS 3\n") == three);
+	REQUIRE (context.calls["linkProgram"] == 3);
+      }
+    }
+
+    WHEN ("I get a variant with defines.") {
+      permutations.get (lights);
+      THEN ("They follow the \"#version\" line, and \"#line 2\" follows them.") {
+	REQUIRE (context.sources[0] == "#version 330\n" + lights + "#line 2\n" + VERTEX_BODY);
+      }
+      THEN ("They start a shader with no \"#version\", and \"#line 1\" follows them.") {
+	REQUIRE (context.sources[1] == lights + "#line 1\n" + FRAGMENT_SOURCE);
+      }
+    }
+
+    WHEN ("I get the variant with no defines.") {
+      permutations.get ("");
+      THEN ("The shaders' sources are passed on unchanged.") {
+	REQUIRE (context.sources[0] == "#version 330\n" + VERTEX_BODY);
+	REQUIRE (context.sources[1] == FRAGMENT_SOURCE);
+      }
+    }
+  }
+}
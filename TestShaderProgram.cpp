@@ -0,0 +1,112 @@
+/// \file TestShaderProgram.cpp
+/// \brief A collection of Catch2 unit tests for the ShaderProgram class,
+///   which link a program through a NullOpenGLContext and check which uniform
+///   uploads reach the context and how they are counted.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <string>
+
+#include "Matrix4.hpp"
+#include "NullOpenGLContext.hpp"
+#include "ShaderProgram.hpp"
+#include "TestContexts.hpp"
+#include "Vector3.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// The vertex shader the tests link, with one uniform of each kind.
+  const std::string VERTEX_SOURCE = "#version 330\n"
+    "layout (location = 0) in vec3 aPosition;\n"
+    "uniform int uCount;\n"
+    "uniform float uScale;\n"
+    "uniform vec3 uColor;\n"
+    "uniform mat4 uWorld;\n";
+}
+
+SCENARIO ("ShaderProgram only uploads uniforms whose values change.", "[ShaderProgram][A09]") {
+  GIVEN ("A linked program with an int, a float, a vec3 and a mat4 uniform.") {
+    ShaderFile vertexShader ("TestShaderProgram.vert", VERTEX_SOURCE);
+    ShaderFile fragmentShader ("TestShaderProgram.frag", "#version 330\n");
+    CountingContext<NullOpenGLContext> context;
+    ShaderProgram program (&context);
+    program.createVertexShader (vertexShader.getPath ());
+    program.createFragmentShader (fragmentShader.getPath ());
+    program.link ();
+    program.enable ();
+    UniformHandle count = program.getUniformHandle ("uCount");
+    UniformHandle scale = program.getUniformHandle ("uScale");
+    UniformHandle color = program.getUniformHandle ("uColor");
+    UniformHandle world = program.getUniformHandle ("uWorld");
+    Matrix4 matrix;
+    matrix.setToPerspectiveProjection (60.0, 1.0, 1.0, 10.0);
+
+    THEN ("Nothing has been counted yet.") {
+      REQUIRE (program.getUploadCounts ().issued == 0);
+      REQUIRE (program.getUploadCounts ().skipped == 0);
+    }
+
+    WHEN ("I set each uniform once.") {
+      program.setUniformInt (count, 3);
+      program.setUniformFloat (scale, 0.5f);
+      program.setUniformVector (color, Vector3 (1, 0, 0));
+      program.setUniformMatrix (world, matrix);
+      THEN ("Every upload is issued.") {
+	REQUIRE (context.getUniformCount () == 4);
+	REQUIRE (program.getUploadCounts ().issued == 4);
+	REQUIRE (program.getUploadCounts ().skipped == 0);
+      }
+
+      WHEN ("I set each one to the same value again, by handle or by name.") {
+	program.setUniformInt (count, 3);
+	program.setUniformFloat ("uScale", 0.5f);
+	program.setUniformVector (color, Vector3 (1, 0, 0));
+	program.setUniformMatrix ("uWorld", matrix);
+	THEN ("Every upload is skipped.") {
+	  REQUIRE (context.getUniformCount () == 4);
+	  REQUIRE (program.getUploadCounts ().issued == 4);
+	  REQUIRE (program.getUploadCounts ().skipped == 4);
+	}
+      }
+
+      WHEN ("I change one component of the vec3 and one element of the mat4.") {
+	matrix.setToPerspectiveProjection (60.0, 2.0, 1.0, 10.0);
+	program.setUniformInt (count, 3);
+	program.setUniformFloat (scale, 0.5f);
+	program.setUniformVector (color, Vector3 (1, 0, 1));
+	program.setUniformMatrix (world, matrix);
+	THEN ("Only those two are issued.") {
+	  REQUIRE (context.getUniformCount () == 6);
+	  REQUIRE (program.getUploadCounts ().issued == 6);
+	  REQUIRE (program.getUploadCounts ().skipped == 2);
+	}
+      }
+
+      WHEN ("I reset the counts and set the same values again.") {
+	program.resetUploadCounts ();
+	program.setUniformInt (count, 3);
+	program.setUniformFloat (scale, 0.5f);
+	THEN ("The shadow copies survive the reset, so both are skipped.") {
+	  REQUIRE (context.getUniformCount () == 4);
+	  REQUIRE (program.getUploadCounts ().issued == 0);
+	  REQUIRE (program.getUploadCounts ().skipped == 2);
+	}
+      }
+    }
+
+    WHEN ("I set a uniform the program does not have, twice.") {
+      UniformHandle missing = program.getUniformHandle ("uMissing");
+      program.setUniformInt (missing, 1);
+      program.setUniformInt ("uMissing", 2);
+      THEN ("Nothing is uploaded, issued, or skipped.") {
+	REQUIRE (missing.location == -1);
+	REQUIRE (context.getUniformCount () == 0);
+	REQUIRE (program.getUploadCounts ().issued == 0);
+	REQUIRE (program.getUploadCounts ().skipped == 0);
+      }
+    }
+  }
+}
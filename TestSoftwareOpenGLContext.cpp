@@ -0,0 +1,210 @@
+/// \file TestSoftwareOpenGLContext.cpp
+/// \brief A collection of Catch2 unit tests for the SoftwareOpenGLContext
+///   class, which draw triangles with a program that looks like Vec3.vert and
+///   read back the pixels.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "SoftwareOpenGLContext.hpp"
+#include "JobSystem.hpp"
+#include "TestContexts.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// \brief Makes a program that is drawn like Vec3.vert, with the identity
+  ///   as its transformation, and a vertex array for it.
+  /// \param[in] context The context.
+  /// \param[in] vertices Each vertex's position (in clip space) and color.
+  void
+  prepare (SoftwareOpenGLContext& context, const std::vector<float>& vertices)
+  {
+    const GLchar* source = "layout (location = 0) in vec3 aPosition;\n"
+      "layout (location = 1) in vec3 aColor;\n"
+      "uniform mat4 uModelViewProjection;\n";
+    GLuint shader = context.createShader (GL_VERTEX_SHADER);
+    context.shaderSource (shader, 1, &source, nullptr);
+    GLuint program = context.createProgram ();
+    context.attachShader (program, shader);
+    context.linkProgram (program);
+    context.useProgram (program);
+    const GLfloat identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    context.uniformMatrix4fv (context.getUniformLocation (program, "uModelViewProjection"),
+                              1, GL_FALSE, identity);
+
+    GLuint array, buffer;
+    context.genVertexArrays (1, &array);
+    context.genBuffers (1, &buffer);
+    context.bindVertexArray (array);
+    context.bindBuffer (GL_ARRAY_BUFFER, buffer);
+    context.bufferData (GL_ARRAY_BUFFER, vertices.size () * sizeof (float),
+                        vertices.data (), GL_STATIC_DRAW);
+    for (GLuint attrib = 0; attrib < 2; ++attrib) {
+      context.enableVertexAttribArray (attrib);
+      context.vertexAttribPointer (attrib, 3, GL_FLOAT, GL_FALSE, 6 * sizeof (float),
+                                   reinterpret_cast<void*> (3 * attrib * sizeof (float)));
+    }
+  }
+
+  /// \brief Reads the red channel of a pixel.
+  int
+  red (SoftwareOpenGLContext& context, GLint x, GLint y)
+  {
+    GLubyte rgb[3];
+    context.readPixel (x, y, rgb);
+    return rgb[0];
+  }
+}
+
+SCENARIO ("SoftwareOpenGLContext rasterizes triangles.", "[SoftwareOpenGLContext][A09]") {
+  GIVEN ("A framebuffer two tiles wide, cleared to blue.") {
+    SoftwareOpenGLContext context (100, 40);
+    context.clearColor (0, 0, 1, 1);
+    context.clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+    WHEN ("I draw a red triangle over the lower-left half of the screen.") {
+      prepare (context, { -1, -1, 0, 1, 0, 0,
+                          1, -1, 0, 1, 0, 0,
+                          -1, 1, 0, 1, 0, 0 });
+      context.drawArrays (GL_TRIANGLES, 0, 3);
+      THEN ("Only the pixels under it are red.") {
+	REQUIRE (red (context, 2, 2) == 255);
+	REQUIRE (red (context, 90, 2) == 255);
+	REQUIRE (red (context, 97, 37) == 0);
+	GLubyte rgb[3];
+	context.readPixel (97, 37, rgb);
+	REQUIRE (rgb[2] == 255);
+	REQUIRE (context.getTriangleCount () == 1);
+      }
+      THEN ("Its depth is written only once the depth test is on.") {
+	REQUIRE (context.readDepth (2, 2) == 1.0f);
+	context.enable (GL_DEPTH_TEST);
+	context.drawArrays (GL_TRIANGLES, 0, 3);
+	REQUIRE (context.readDepth (2, 2) == Approx (0.5f));
+      }
+      THEN ("Clearing the color and depth drops it unrasterized.") {
+	context.clear (GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	REQUIRE (red (context, 2, 2) == 0);
+	REQUIRE (context.getTriangleCount () == 0);
+      }
+    }
+
+    WHEN ("I draw a triangle whose vertices have different w.") {
+      prepare (context, { -1, -1, 1, 1, 0, 0,
+                          3, -3, 3, 0, 0, 0,
+                          -1, 1, 1, 1, 0, 0 });
+      // Makes each clip-space position (x, y, 0, z), so the second vertex is
+      // at the lower right corner.
+      const GLfloat perspective[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0 };
+      context.uniformMatrix4fv (0, 1, GL_FALSE, perspective);
+      context.drawArrays (GL_TRIANGLES, 0, 3);
+      THEN ("Its color is interpolated in perspective, not across the screen.") {
+	// 0.746 of the way to red, where interpolating linearly would give 0.495.
+	REQUIRE (red (context, 50, 1) >= 188);
+	REQUIRE (red (context, 50, 1) <= 192);
+      }
+    }
+
+    WHEN ("I draw a quad of two triangles with culling on, one of them clockwise.") {
+      prepare (context, { -1, -1, 0, 1, 0, 0,
+                          1, -1, 0, 1, 0, 0,
+                          1, 1, 0, 1, 0, 0,
+                          -1, -1, 0, 1, 0, 0,
+                          -1, 1, 0, 1, 0, 0,
+                          1, 1, 0, 1, 0, 0 });
+      context.enable (GL_CULL_FACE);
+      context.drawArrays (GL_TRIANGLES, 0, 6);
+      THEN ("The clockwise one is culled.") {
+	REQUIRE (red (context, 97, 2) == 255);
+	REQUIRE (red (context, 2, 37) == 0);
+	REQUIRE (context.getTriangleCount () == 1);
+      }
+    }
+
+    WHEN ("I draw the quad without culling.") {
+      prepare (context, { -1, -1, 0, 1, 0, 0,
+                          1, -1, 0, 1, 0, 0,
+                          1, 1, 0, 1, 0, 0,
+                          -1, -1, 0, 1, 0, 0,
+                          -1, 1, 0, 1, 0, 0,
+                          1, 1, 0, 1, 0, 0 });
+      context.drawArrays (GL_TRIANGLES, 0, 6);
+      THEN ("Every pixel is covered, along the shared edge too.") {
+	int covered = 0;
+	for (GLint y = 0; y < 40; ++y)
+	  for (GLint x = 0; x < 100; ++x)
+	    covered += red (context, x, y) == 255;
+	REQUIRE (covered == 100 * 40);
+      }
+    }
+  }
+}
+
+SCENARIO ("SoftwareOpenGLContext tests depth.", "[SoftwareOpenGLContext][A09]") {
+  GIVEN ("A near green triangle and a far red one, over the same pixels.") {
+    const std::vector<float> vertices = { -1, -1, -0.5f, 0, 1, 0,
+                                          1, -1, -0.5f, 0, 1, 0,
+                                          0, 1, -0.5f, 0, 1, 0,
+                                          -1, -1, 0.5f, 1, 0, 0,
+                                          1, -1, 0.5f, 1, 0, 0,
+                                          0, 1, 0.5f, 1, 0, 0 };
+    JobSystem jobs (3);
+
+    WHEN ("I draw the near one first, with the depth test on, across workers.") {
+      SoftwareOpenGLContext context (130, 70, &jobs);
+      context.enable (GL_DEPTH_TEST);
+      prepare (context, vertices);
+      context.drawArrays (GL_TRIANGLES, 0, 6);
+      THEN ("The near one is still in front.") {
+	GLubyte rgb[3];
+	context.readPixel (65, 20, rgb);
+	REQUIRE (rgb[0] == 0);
+	REQUIRE (rgb[1] == 255);
+	REQUIRE (context.readDepth (65, 20) == Approx (0.25f));
+      }
+    }
+    WHEN ("I draw them the same way with the depth function GL_ALWAYS.") {
+      SoftwareOpenGLContext context (130, 70, &jobs);
+      context.enable (GL_DEPTH_TEST);
+      context.depthFunc (GL_ALWAYS);
+      prepare (context, vertices);
+      context.drawArrays (GL_TRIANGLES, 0, 6);
+      THEN ("The far one, drawn last, is in front.") {
+	REQUIRE (red (context, 65, 20) == 255);
+      }
+    }
+  }
+}
+
+SCENARIO ("SoftwareOpenGLContext saves its framebuffer.", "[SoftwareOpenGLContext][A09]") {
+  GIVEN ("A cleared 3x2 framebuffer.") {
+    SoftwareOpenGLContext context (3, 2);
+    context.clearColor (1, 0, 0, 1);
+    context.clear (GL_COLOR_BUFFER_BIT);
+    WHEN ("I save it.") {
+      const std::string path = getTemporaryPath ("TestSoftwareOpenGLContext.ppm");
+      REQUIRE (context.savePPM (path));
+      THEN ("It is a PPM of the right size and color.") {
+	FILE* file = std::fopen (path.c_str (), "rb");
+	REQUIRE (file != nullptr);
+	int width = 0, height = 0, maximum = 0;
+	REQUIRE (std::fscanf (file, "P6 %d %d %d", &width, &height, &maximum) == 3);
+	std::fgetc (file);
+	unsigned char pixel[3];
+	REQUIRE (std::fread (pixel, 1, 3, file) == 3);
+	std::fclose (file);
+	std::remove (path.c_str ());
+	REQUIRE (width == 3);
+	REQUIRE (height == 2);
+	REQUIRE (pixel[0] == 255);
+	REQUIRE (pixel[2] == 0);
+      }
+    }
+  }
+}
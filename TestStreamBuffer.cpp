@@ -0,0 +1,207 @@
+/// \file TestStreamBuffer.cpp
+/// \brief A collection of Catch2 unit tests for the StreamBuffer class,
+///   which check where allocations go, that a region is only reused once
+///   its fence is signaled, and that unmappable contexts get uploads.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <vector>
+
+#include "NullOpenGLContext.hpp"
+#include "StreamBuffer.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+namespace
+{
+  /// \brief A context whose buffers can be mapped and whose fences are
+  ///   signaled only after being polled a given number of times.
+  class FenceContext : public NullOpenGLContext
+  {
+  public:
+
+    virtual void
+    namedBufferStorage (GLuint buffer, GLsizeiptr size, const void* data, GLbitfield flags)
+    {
+      memory.assign (size, 0);
+    }
+
+    virtual void*
+    mapNamedBufferRange (GLuint buffer, GLintptr offset, GLsizeiptr length, GLbitfield access)
+    {
+      return mappable ? memory.data () + offset : nullptr;
+    }
+
+    virtual void
+    namedBufferSubData (GLuint buffer, GLintptr offset, GLsizeiptr size, const void* data)
+    {
+      uploads.emplace_back (offset, size);
+      std::memcpy (memory.data () + offset, data, size);
+    }
+
+    virtual GLsync
+    fenceSync (GLenum condition, GLbitfield flags)
+    {
+      ++fences;
+      pending[fences] = busyPolls;
+      return reinterpret_cast<GLsync> (static_cast<std::uintptr_t> (fences));
+    }
+
+    virtual GLenum
+    clientWaitSync (GLsync sync, GLbitfield flags, GLuint64 timeout)
+    {
+      unsigned int& polls = pending[reinterpret_cast<std::uintptr_t> (sync)];
+      if (polls == 0)
+        return GL_ALREADY_SIGNALED;
+      --polls;
+      return GL_TIMEOUT_EXPIRED;
+    }
+
+    virtual void
+    deleteSync (GLsync sync)
+    {
+      pending.erase (reinterpret_cast<std::uintptr_t> (sync));
+    }
+
+    /// Whether or not mapNamedBufferRange succeeds.
+    bool mappable = true;
+    /// The buffer's contents.
+    std::vector<unsigned char> memory;
+    /// The offset and size of every namedBufferSubData.
+    std::vector<std::pair<GLintptr, GLsizeiptr>> uploads;
+    /// The number of fences made.
+    std::uintptr_t fences = 0;
+    /// How many times each fence not yet deleted will still time out.
+    std::map<std::uintptr_t, unsigned int> pending;
+    /// How many times new fences time out.
+    unsigned int busyPolls = 0;
+  };
+}
+
+SCENARIO ("StreamBuffer hands out aligned ranges of one region at a time.", "[StreamBuffer][A09]") {
+  GIVEN ("A mapped stream buffer with 100-byte regions.") {
+    FenceContext context;
+    StreamBuffer stream (&context, 100);
+    GLintptr offsets[3];
+    unsigned char* first = static_cast<unsigned char*> (stream.allocate (10, 4, offsets[0]));
+    unsigned char* second = static_cast<unsigned char*> (stream.allocate (30, 24, offsets[1]));
+
+    THEN ("The storage holds every region, and the ranges are in the mapping.") {
+      REQUIRE (stream.isMapped ());
+      REQUIRE (context.memory.size () == 300);
+      REQUIRE (offsets[0] == 0);
+      REQUIRE (offsets[1] == 24);
+      REQUIRE (first == context.memory.data ());
+      REQUIRE (second == context.memory.data () + 24);
+    }
+
+    THEN ("What doesn't fit in the rest of the region isn't allocated.") {
+      REQUIRE (stream.allocate (47, 1, offsets[2]) == nullptr);
+      REQUIRE (stream.allocate (46, 1, offsets[2]) != nullptr);
+      REQUIRE (offsets[2] == 54);
+    }
+
+    WHEN ("I fence the region and allocate again.") {
+      stream.flush ();
+      stream.fence ();
+      stream.allocate (10, 24, offsets[2]);
+      THEN ("The next region is used, and nothing was uploaded.") {
+	REQUIRE (offsets[2] == 120);
+	REQUIRE (context.fences == 1);
+	REQUIRE (context.uploads.empty ());
+      }
+    }
+
+    WHEN ("I fence without allocating anything after.") {
+      stream.fence ();
+      stream.fence ();
+      THEN ("The empty region isn't fenced.") {
+	REQUIRE (context.fences == 1);
+      }
+    }
+  }
+}
+
+SCENARIO ("StreamBuffer waits for a region's fence before reusing it.", "[StreamBuffer][A09]") {
+  GIVEN ("A stream buffer whose fences take two polls to signal.") {
+    FenceContext context;
+    context.busyPolls = 2;
+    StreamBuffer stream (&context, 64);
+    GLintptr offset;
+    for (unsigned int region = 0; region < StreamBuffer::REGION_COUNT; ++region)
+    {
+      stream.allocate (16, 16, offset);
+      stream.fence ();
+    }
+
+    THEN ("Using each region once waits on nothing.") {
+      REQUIRE (context.fences == StreamBuffer::REGION_COUNT);
+      REQUIRE (stream.getWaitStats ().fences == 0);
+    }
+
+    WHEN ("I allocate twice from the first region again.") {
+      stream.allocate (16, 16, offset);
+      stream.allocate (16, 16, offset);
+      StreamWaitStats waits = stream.getWaitStats ();
+      THEN ("Its fence was waited on once, as a stall, and deleted.") {
+	REQUIRE (offset == 16);
+	REQUIRE (waits.fences == 1);
+	REQUIRE (waits.stalls == 1);
+	REQUIRE (waits.totalMillis >= 0.0);
+	REQUIRE (waits.maxMillis <= waits.totalMillis);
+	REQUIRE (context.pending.count (1) == 0);
+	REQUIRE (context.pending.size () == 2);
+      }
+    }
+
+    WHEN ("The fences were signaled before I come back around.") {
+      for (std::pair<const std::uintptr_t, unsigned int>& fence : context.pending)
+        fence.second = 0;
+      stream.allocate (16, 16, offset);
+      THEN ("The wait is counted, but not as a stall.") {
+	REQUIRE (stream.getWaitStats ().fences == 1);
+	REQUIRE (stream.getWaitStats ().stalls == 0);
+      }
+    }
+  }
+}
+
+SCENARIO ("StreamBuffer uploads when the context can't map it.", "[StreamBuffer][A09]") {
+  GIVEN ("A stream buffer on a context that can't map.") {
+    FenceContext context;
+    context.mappable = false;
+    StreamBuffer stream (&context, 32);
+    GLintptr offset;
+    stream.fence ();
+    std::memset (stream.allocate (8, 4, offset), 7, 8);
+    stream.flush ();
+    stream.fence ();
+    std::memset (stream.allocate (4, 4, offset), 9, 4);
+    std::memset (stream.allocate (4, 4, offset), 9, 4);
+    stream.flush ();
+    stream.flush ();
+
+    THEN ("Each flush uploads what was written since the last, in its region.") {
+      REQUIRE (!stream.isMapped ());
+      REQUIRE (context.uploads.size () == 2);
+      REQUIRE (context.uploads[0] == std::make_pair<GLintptr, GLsizeiptr> (0, 8));
+      REQUIRE (context.uploads[1] == std::make_pair<GLintptr, GLsizeiptr> (32, 8));
+      REQUIRE (context.memory[7] == 7);
+      REQUIRE (context.memory[39] == 9);
+    }
+
+    WHEN ("I reserve bigger regions.") {
+      stream.reserve (64);
+      stream.allocate (4, 4, offset);
+      THEN ("The storage is replaced, starting from the first region.") {
+	REQUIRE (stream.getRegionSize () == 64);
+	REQUIRE (context.memory.size () == 192);
+	REQUIRE (offset == 0);
+      }
+    }
+  }
+}
@@ -0,0 +1,91 @@
+/// \file TestTraceReplayer.cpp
+/// \brief A collection of Catch2 unit tests for the TraceReplayer class,
+///   which replay logs made by a RecordingOpenGLContext.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <vector>
+
+#include "TraceReplayer.hpp"
+#include "RecordingOpenGLContext.hpp"
+#include "NullOpenGLContext.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("TraceReplayer replays a recorded trace frame by frame.", "[TraceReplayer][A09]") {
+  GIVEN ("Two frames that upload the same buffer contents and draw with a program.") {
+    NullOpenGLContext null;
+    RecordingOpenGLContext recording (&null);
+    const GLchar* source = "uniform mat4 uWorld;\n";
+    GLuint shader = recording.createShader (GL_VERTEX_SHADER);
+    recording.shaderSource (shader, 1, &source, nullptr);
+    GLuint program = recording.createProgram ();
+    recording.attachShader (program, shader);
+    recording.linkProgram (program);
+    GLint location = recording.getUniformLocation (program, "uWorld");
+    GLuint buffer;
+    recording.genBuffers (1, &buffer);
+    const std::vector<float> vertices (300, 1.0f);
+    const float identity[16] = { 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1 };
+    for (int frame = 0; frame < 2; ++frame) {
+      recording.bindBuffer (GL_ARRAY_BUFFER, buffer);
+      recording.bufferData (GL_ARRAY_BUFFER, vertices.size () * sizeof (float),
+			    vertices.data (), GL_STREAM_DRAW);
+      recording.useProgram (program);
+      recording.uniformMatrix4fv (location, 1, GL_FALSE, identity);
+      recording.drawArrays (GL_TRIANGLES, 0, 100);
+      recording.markFrame ();
+    }
+
+    THEN ("The buffer contents are stored only once.") {
+      REQUIRE (recording.getFrameCount () == 2);
+      REQUIRE (recording.getLog ().size () < 2 * vertices.size () * sizeof (float));
+    }
+
+    WHEN ("I replay it through another recording context.") {
+      NullOpenGLContext target;
+      // Used up names, so that the replayed objects get different ones.
+      GLuint taken[5];
+      target.genBuffers (5, taken);
+      RecordingOpenGLContext replayed (&target);
+      TraceReplayer replayer (&replayed);
+      replayer.setTrace (recording.getLog ());
+
+      THEN ("Each frame is made in turn, and then the trace ends.") {
+	REQUIRE (replayer.replayFrame ());
+	REQUIRE (replayer.getFrameCount () == 1);
+	REQUIRE (replayer.getCallStats (RecordingOpenGLContext::CREATE_PROGRAM).count == 1);
+	REQUIRE (replayer.getCallStats (RecordingOpenGLContext::DRAW_ARRAYS).count == 1);
+	REQUIRE (replayer.replayFrame ());
+	REQUIRE (replayer.getCallStats (RecordingOpenGLContext::BUFFER_DATA).count == 2);
+	REQUIRE (replayer.getCallStats (RecordingOpenGLContext::DRAW_ARRAYS).count == 2);
+	REQUIRE_FALSE (replayer.replayFrame ());
+      }
+      THEN ("Every call is made again, with the same buffer contents.") {
+	while (replayer.replayFrame ())
+	  ;
+	REQUIRE (replayed.getCallCount () == recording.getCallCount ());
+	// Everything but the two FRAME records, each an opcode and a time.
+	REQUIRE (replayed.getLog ().size () == recording.getLog ().size () - 2 * 9);
+      }
+      THEN ("The replayed program was linked under its new name.") {
+	replayer.replayFrame ();
+	REQUIRE (target.getUniformLocation (program, "uWorld") == -1);
+	REQUIRE (target.getUniformLocation (program + 5, "uWorld") == 0);
+      }
+    }
+
+    WHEN ("I replay a copy cut off in the middle of a record.") {
+      std::vector<unsigned char> damaged (recording.getLog ().begin (),
+					  recording.getLog ().end () - 3);
+      TraceReplayer replayer (&null);
+      replayer.setTrace (damaged);
+      THEN ("The whole first frame is made, but not the second.") {
+	REQUIRE (replayer.replayFrame ());
+	REQUIRE_FALSE (replayer.replayFrame ());
+	REQUIRE (replayer.getFrameCount () == 1);
+      }
+    }
+  }
+}
@@ -0,0 +1,165 @@
+/// \file TestTransformHierarchy.cpp
+/// \brief A collection of Catch2 unit tests for the TransformHierarchy class.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include "TransformHierarchy.hpp"
+#include "JobSystem.hpp"
+#include "Transform.hpp"
+#include "Vector3.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+SCENARIO ("TransformHierarchy world transforms.", "[TransformHierarchy][A09]") {
+  GIVEN ("A planet at (10, 0, 0) with a moon 2 units to its right.") {
+    TransformHierarchy h;
+    Transform planetLocal;
+    planetLocal.moveRight (10.0f);
+    unsigned int planet = h.add (planetLocal);
+    Transform moonLocal;
+    moonLocal.moveRight (2.0f);
+    unsigned int moon = h.add (moonLocal, planet);
+
+    WHEN ("I update the hierarchy.") {
+      unsigned int recomputed = h.update ();
+      THEN ("Both world transforms were computed, and the moon is at (12, 0, 0).") {
+	REQUIRE (recomputed == 2);
+	REQUIRE (h.getWorld (planet).getPosition () == Vector3 (10.0f, 0.0f, 0.0f));
+	REQUIRE (h.getWorld (moon).getPosition () == Vector3 (12.0f, 0.0f, 0.0f));
+	REQUIRE (h.getWorldMatrices ()[16 * moon + 12] == Approx (12.0f));
+      }
+    }
+
+    WHEN ("I update, then move only the planet up 3 units and update again.") {
+      h.update ();
+      h.getLocals ().moveUp (planet, 3.0f);
+      unsigned int recomputed = h.update ();
+      THEN ("The planet's whole subtree was recomputed and the moon followed it.") {
+	REQUIRE (recomputed == 2);
+	REQUIRE (h.getWorld (moon).getPosition () == Vector3 (12.0f, 3.0f, 0.0f));
+      }
+    }
+
+    WHEN ("I update, then move only the moon and update again.") {
+      h.update ();
+      h.getLocals ().moveRight (moon, 1.0f);
+      unsigned int recomputed = h.update ();
+      THEN ("Only the moon was recomputed.") {
+	REQUIRE (recomputed == 1);
+	REQUIRE (h.getWorld (moon).getPosition () == Vector3 (13.0f, 0.0f, 0.0f));
+      }
+    }
+
+    WHEN ("I update twice without changing anything.") {
+      h.update ();
+      unsigned int recomputed = h.update ();
+      THEN ("Nothing was recomputed.") {
+	REQUIRE (recomputed == 0);
+      }
+    }
+
+    WHEN ("I yaw the planet 90 degrees.") {
+      h.getLocals ().yaw (planet, 90.0f);
+      h.update ();
+      THEN ("The moon swings around to the planet's new right, (10, 0, -2).") {
+	Vector3 p = h.getWorld (moon).getPosition ();
+	REQUIRE (p.m_x == Approx (10.0f));
+	REQUIRE (p.m_y == Approx (0.0f).margin (0.0001f));
+	REQUIRE (p.m_z == Approx (-2.0f));
+      }
+    }
+  }
+}
+
+SCENARIO ("TransformHierarchy re-parenting.", "[TransformHierarchy][A09]") {
+  GIVEN ("A child that was added before its parent.") {
+    TransformHierarchy h;
+    Transform childLocal;
+    childLocal.moveUp (1.0f);
+    unsigned int child = h.add (childLocal);
+    Transform parentLocal;
+    parentLocal.moveUp (5.0f);
+    unsigned int parent = h.add (parentLocal);
+
+    WHEN ("I attach the child to the parent and update.") {
+      h.setParent (child, parent);
+      h.update ();
+      THEN ("The parent is still visited first.") {
+	REQUIRE (h.getParent (child) == parent);
+	REQUIRE (h.getWorld (child).getPosition () == Vector3 (0.0f, 6.0f, 0.0f));
+      }
+    }
+
+    WHEN ("I try to attach the parent beneath its own child.") {
+      h.setParent (child, parent);
+      h.setParent (parent, child);
+      THEN ("Nothing changes.") {
+	REQUIRE (h.getParent (parent) == TransformHierarchy::NO_PARENT);
+      }
+    }
+
+    WHEN ("I remove the parent and update.") {
+      h.setParent (child, parent);
+      h.remove (parent);
+      h.update ();
+      THEN ("The child becomes a root again, and stays where it was.") {
+	REQUIRE (h.getParent (child) == TransformHierarchy::NO_PARENT);
+	REQUIRE (h.getWorld (child).getPosition () == Vector3 (0.0f, 6.0f, 0.0f));
+      }
+    }
+
+    WHEN ("I put a yawed node between them, update, remove it and update again.") {
+      Transform middleLocal;
+      middleLocal.moveRight (2.0f);
+      middleLocal.yaw (90.0f);
+      unsigned int middle = h.add (middleLocal, parent);
+      h.setParent (child, middle);
+      h.getLocals ().moveRight (child, 1.0f);
+      h.update ();
+      Vector3 before = h.getWorld (child).getPosition ();
+      h.remove (middle);
+      h.update ();
+      Vector3 after = h.getWorld (child).getPosition ();
+      THEN ("The child moves up to the parent, and its world transform does not jump.") {
+	REQUIRE (h.getParent (child) == parent);
+	REQUIRE (after.m_x == Approx (before.m_x));
+	REQUIRE (after.m_y == Approx (before.m_y));
+	REQUIRE (after.m_z == Approx (before.m_z));
+	REQUIRE (before.m_z == Approx (-1.0f));
+      }
+    }
+  }
+}
+
+SCENARIO ("TransformHierarchy updates on a JobSystem.", "[TransformHierarchy][A09]") {
+  GIVEN ("Two identical hierarchies of 500 planets with 10 moons each.") {
+    TransformHierarchy serial;
+    TransformHierarchy parallel;
+    for (TransformHierarchy* h : { &serial, &parallel }) {
+      for (int p = 0; p < 500; ++p) {
+	Transform planetLocal;
+	planetLocal.moveRight (float (p));
+	unsigned int planet = h->add (planetLocal);
+	for (int m = 0; m < 10; ++m) {
+	  Transform moonLocal;
+	  moonLocal.yaw (36.0f * m);
+	  moonLocal.moveRight (1.0f);
+	  h->add (moonLocal, planet);
+	}
+      }
+    }
+
+    WHEN ("I update one alone and the other with 4 workers.") {
+      JobSystem jobs (4);
+      unsigned int serialCount = serial.update ();
+      unsigned int parallelCount = parallel.update (&jobs);
+      THEN ("They computed the same world matrices.") {
+	REQUIRE (serialCount == 5500);
+	REQUIRE (parallelCount == 5500);
+	for (unsigned int i = 0; i < 16 * serial.getNodeCapacity (); ++i)
+	  REQUIRE (parallel.getWorldMatrices ()[i] == serial.getWorldMatrices ()[i]);
+      }
+    }
+  }
+}
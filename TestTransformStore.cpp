@@ -0,0 +1,113 @@
+/// \file TestTransformStore.cpp
+/// \brief A collection of Catch2 unit tests for the TransformStore class.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <vector>
+
+#include "TransformStore.hpp"
+#include "Transform.hpp"
+#include "Vector3.hpp"
+
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+/// \brief Checks that a slot of a store holds (nearly) the same transform as
+///   a Transform that was changed the slow way.
+void
+requireSame (const TransformStore& store, unsigned int index, const Transform& t)
+{
+  float expected[16];
+  float actual[16];
+  t.getTransform (expected);
+  store.writeMatrix (index, actual);
+  for (int i = 0; i < 16; ++i)
+    REQUIRE (actual[i] == Approx (expected[i]).margin (0.0001f));
+}
+
+SCENARIO ("TransformStore single-slot operations.", "[TransformStore][A09]") {
+  GIVEN ("A store holding one scaled, moved transform.") {
+    Transform t;
+    t.scaleWorld (0.5f);
+    t.moveRight (3.0f);
+    TransformStore store;
+    unsigned int i = store.add (t);
+
+    WHEN ("I move and rotate it the same way as a Transform.") {
+      store.moveRight (i, 2.0f);
+      store.yaw (i, 30.0f);
+      store.pitch (i, -45.0f);
+      store.roll (i, 10.0f);
+      store.moveBack (i, 1.5f);
+      store.moveUp (i, -1.0f);
+      store.scaleLocal (i, 2.0f);
+      t.moveRight (2.0f);
+      t.yaw (30.0f);
+      t.pitch (-45.0f);
+      t.roll (10.0f);
+      t.moveBack (1.5f);
+      t.moveUp (-1.0f);
+      t.scaleLocal (2.0f);
+      THEN ("Both produce the same matrix, and the slot is dirty.") {
+	requireSame (store, i, t);
+	REQUIRE (store.isDirty (i));
+      }
+    }
+  }
+}
+
+SCENARIO ("TransformStore bulk operations.", "[TransformStore][A09]") {
+  GIVEN ("A store of 11 transforms, so that the SSE loops have a tail.") {
+    const unsigned int COUNT = 11;
+    TransformStore store;
+    std::vector<Transform> expected (COUNT);
+    std::vector<float> distances (COUNT);
+    std::vector<float> angles (COUNT);
+    for (unsigned int i = 0; i < COUNT; ++i)
+    {
+      expected[i].moveUp (float (i));
+      expected[i].roll (7.0f * i);
+      store.add (expected[i]);
+      distances[i] = 0.25f * i;
+      angles[i] = (i % 3 == 0) ? 0.0f : 11.0f * i;
+    }
+    store.clearDirty ();
+
+    WHEN ("I yaw, roll, and move every slot by its own amount.") {
+      store.yawAll (angles.data ());
+      store.rollAll (angles.data ());
+      store.moveRightAll (distances.data ());
+      for (unsigned int i = 0; i < COUNT; ++i)
+      {
+	expected[i].yaw (angles[i]);
+	expected[i].roll (angles[i]);
+	expected[i].moveRight (distances[i]);
+      }
+      THEN ("Every slot matches, and only slots that changed are dirty.") {
+	std::vector<float> matrices (16 * COUNT);
+	store.writeMatrices (0, COUNT, matrices.data ());
+	for (unsigned int i = 0; i < COUNT; ++i)
+	{
+	  requireSame (store, i, expected[i]);
+	  float single[16];
+	  store.writeMatrix (i, single);
+	  for (int j = 0; j < 16; ++j)
+	    REQUIRE (matrices[16 * i + j] == single[j]);
+	}
+	REQUIRE (!store.isDirty (0));
+	REQUIRE (store.isDirty (1));
+      }
+    }
+
+    WHEN ("I move two slots and forget that one of them changed.") {
+      store.moveUp (3, 1.0f);
+      store.moveUp (4, 1.0f);
+      store.clearDirty (3);
+      THEN ("Only the other one is dirty.") {
+	REQUIRE (!store.isDirty (3));
+	REQUIRE (store.isDirty (4));
+	REQUIRE (!store.isDirty (5));
+      }
+    }
+  }
+}
@@ -0,0 +1,821 @@
+/// \file TraceReplayer.cpp
+/// \brief Definition of TraceReplayer class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+
+#include "TraceReplayer.hpp"
+
+namespace
+{
+  /// The size of the buffer that replayed queries write their answers to.
+  const GLsizei QUERY_BUFFER_SIZE = 4096;
+
+  /// \brief Gets the time since some fixed point, in microseconds.
+  /// \return The current time.
+  double
+  now ()
+  {
+    using namespace std::chrono;
+    return duration<double, std::micro> (steady_clock::now ().time_since_epoch ()).count ();
+  }
+}
+
+TraceReplayer::TraceReplayer (OpenGLContext* context)
+  : m_context (context), m_trace (), m_position (0), m_damaged (false),
+    m_frameTime (0), m_frameCount (0), m_contents (), m_buffers (),
+    m_framebuffers (), m_programs (), m_queries (), m_textures (), m_vertexArrays (),
+    m_locations (), m_blockIndices (), m_program (0)
+{
+  resetCallStats ();
+}
+
+bool
+TraceReplayer::load (const std::string& path)
+{
+  std::ifstream file (path, std::ios::binary);
+  if (!file)
+  {
+    fprintf (stderr, "Could not open trace %s\n", path.c_str ());
+    return false;
+  }
+  std::vector<unsigned char> trace ((std::istreambuf_iterator<char> (file)),
+                                    std::istreambuf_iterator<char> ());
+  const std::size_t HEADER_SIZE = sizeof (RecordingOpenGLContext::TRACE_MAGIC)
+    + sizeof (RecordingOpenGLContext::TRACE_VERSION);
+  std::uint32_t version = 0;
+  if (trace.size () >= HEADER_SIZE)
+    std::memcpy (&version, &trace[sizeof (RecordingOpenGLContext::TRACE_MAGIC)],
+                 sizeof (version));
+  if (trace.size () < HEADER_SIZE
+      || std::memcmp (trace.data (), RecordingOpenGLContext::TRACE_MAGIC,
+                      sizeof (RecordingOpenGLContext::TRACE_MAGIC)) != 0
+      || version != RecordingOpenGLContext::TRACE_VERSION)
+  {
+    fprintf (stderr, "%s is not a version %u trace\n", path.c_str (),
+             RecordingOpenGLContext::TRACE_VERSION);
+    return false;
+  }
+  trace.erase (trace.begin (), trace.begin () + HEADER_SIZE);
+  setTrace (trace);
+  return true;
+}
+
+void
+TraceReplayer::setTrace (const std::vector<unsigned char>& log)
+{
+  m_trace = log;
+  m_position = 0;
+  m_damaged = false;
+  m_frameTime = 0;
+  m_frameCount = 0;
+  m_contents.clear ();
+  m_buffers.clear ();
+  m_framebuffers.clear ();
+  m_programs.clear ();
+  m_queries.clear ();
+  m_textures.clear ();
+  m_vertexArrays.clear ();
+  m_locations.clear ();
+  m_blockIndices.clear ();
+  m_program = 0;
+  resetCallStats ();
+}
+
+bool
+TraceReplayer::replayFrame ()
+{
+  while (!m_damaged && m_position < m_trace.size ())
+  {
+    auto call = static_cast<RecordingOpenGLContext::RecordedCall> (m_trace[m_position++]);
+    if (call == RecordingOpenGLContext::FRAME)
+    {
+      m_frameTime = get<std::uint64_t> ();
+      if (m_damaged)
+        break;
+      ++m_frameCount;
+      return true;
+    }
+    if (call >= RecordingOpenGLContext::RECORDED_CALL_COUNT)
+    {
+      fprintf (stderr, "Unknown record %u at byte %zu of the trace\n", call,
+               m_position - 1);
+      m_damaged = true;
+      break;
+    }
+    // The time includes reading the record, which is small next to most
+    //   calls, but not all.
+    double start = now ();
+    replayCall (call);
+    double elapsed = now () - start;
+    TraceCallStats& stats = m_stats[call];
+    ++stats.count;
+    stats.totalMicros += elapsed;
+    stats.maxMicros = std::max (stats.maxMicros, elapsed);
+  }
+  if (m_damaged)
+    fprintf (stderr, "The trace is damaged after frame %zu\n", m_frameCount);
+  return false;
+}
+
+std::uint64_t
+TraceReplayer::getFrameTime () const
+{
+  return m_frameTime;
+}
+
+std::size_t
+TraceReplayer::getFrameCount () const
+{
+  return m_frameCount;
+}
+
+const TraceCallStats&
+TraceReplayer::getCallStats (RecordingOpenGLContext::RecordedCall call) const
+{
+  return m_stats[call];
+}
+
+void
+TraceReplayer::resetCallStats ()
+{
+  std::fill (m_stats, m_stats + RecordingOpenGLContext::RECORDED_CALL_COUNT,
+             TraceCallStats { 0, 0.0, 0.0 });
+}
+
+void
+TraceReplayer::replayCall (RecordingOpenGLContext::RecordedCall call)
+{
+  typedef RecordingOpenGLContext R;
+  // Answers to queries, which are thrown away.
+  static GLint integers[QUERY_BUFFER_SIZE];
+  static GLchar text[QUERY_BUFFER_SIZE];
+  GLsizei length;
+  GLint size;
+  GLenum type;
+
+  switch (call)
+  {
+  case R::ACTIVE_TEXTURE:
+    m_context->activeTexture (get<GLenum> ());
+    break;
+  case R::ATTACH_SHADER:
+  {
+    GLuint program = translate (m_programs, get<GLuint> ());
+    m_context->attachShader (program, translate (m_programs, get<GLuint> ()));
+    break;
+  }
+  case R::BIND_BUFFER:
+  {
+    GLenum target = get<GLenum> ();
+    m_context->bindBuffer (target, translate (m_buffers, get<GLuint> ()));
+    break;
+  }
+  case R::BIND_BUFFER_BASE:
+  {
+    GLenum target = get<GLenum> ();
+    GLuint index = get<GLuint> ();
+    m_context->bindBufferBase (target, index, translate (m_buffers, get<GLuint> ()));
+    break;
+  }
+  case R::BIND_FRAMEBUFFER:
+  {
+    GLenum target = get<GLenum> ();
+    m_context->bindFramebuffer (target, translate (m_framebuffers, get<GLuint> ()));
+    break;
+  }
+  case R::BIND_TEXTURE:
+  {
+    GLenum target = get<GLenum> ();
+    m_context->bindTexture (target, translate (m_textures, get<GLuint> ()));
+    break;
+  }
+  case R::BIND_VERTEX_ARRAY:
+    m_context->bindVertexArray (translate (m_vertexArrays, get<GLuint> ()));
+    break;
+  case R::BUFFER_DATA:
+  case R::BUFFER_SUB_DATA:
+  {
+    GLenum target = get<GLenum> ();
+    std::int64_t offset = call == R::BUFFER_SUB_DATA ? get<std::int64_t> () : 0;
+    std::int64_t bytes = get<std::int64_t> ();
+    const void* data;
+    if (!getContents (bytes, data))
+      break;
+    if (call == R::BUFFER_DATA)
+      m_context->bufferData (target, bytes, data, get<GLenum> ());
+    else
+      m_context->bufferSubData (target, offset, bytes, data);
+    break;
+  }
+  case R::CHECK_FRAMEBUFFER_STATUS:
+    m_context->checkFramebufferStatus (get<GLenum> ());
+    break;
+  case R::CLEAR:
+    m_context->clear (get<GLbitfield> ());
+    break;
+  case R::CLEAR_COLOR:
+  {
+    GLfloat red = get<GLfloat> ();
+    GLfloat green = get<GLfloat> ();
+    GLfloat blue = get<GLfloat> ();
+    m_context->clearColor (red, green, blue, get<GLfloat> ());
+    break;
+  }
+  case R::COMPILE_SHADER:
+    m_context->compileShader (translate (m_programs, get<GLuint> ()));
+    break;
+  case R::CREATE_PROGRAM:
+  {
+    GLuint recorded = get<GLuint> ();
+    GLuint program = m_context->createProgram ();
+    addNames (m_programs, { recorded }, &program);
+    break;
+  }
+  case R::CREATE_SHADER:
+  {
+    GLenum shaderType = get<GLenum> ();
+    GLuint recorded = get<GLuint> ();
+    GLuint shader = m_context->createShader (shaderType);
+    addNames (m_programs, { recorded }, &shader);
+    break;
+  }
+  case R::CREATE_BUFFERS:
+  case R::CREATE_VERTEX_ARRAYS:
+  {
+    std::vector<GLuint> recorded = getArray<GLuint> ();
+    std::vector<GLuint> names (recorded.size ());
+    if (call == R::CREATE_BUFFERS)
+    {
+      m_context->createBuffers (names.size (), names.data ());
+      addNames (m_buffers, recorded, names.data ());
+    }
+    else
+    {
+      m_context->createVertexArrays (names.size (), names.data ());
+      addNames (m_vertexArrays, recorded, names.data ());
+    }
+    break;
+  }
+  case R::CULL_FACE:
+    m_context->cullFace (get<GLenum> ());
+    break;
+  case R::DELETE_BUFFERS:
+  {
+    std::vector<GLuint> names = removeNames (m_buffers, getArray<GLuint> ());
+    m_context->deleteBuffers (names.size (), names.data ());
+    break;
+  }
+  case R::DELETE_FRAMEBUFFERS:
+  {
+    std::vector<GLuint> names = removeNames (m_framebuffers, getArray<GLuint> ());
+    m_context->deleteFramebuffers (names.size (), names.data ());
+    break;
+  }
+  case R::DELETE_PROGRAM:
+    m_context->deleteProgram (removeNames (m_programs, { get<GLuint> () })[0]);
+    break;
+  case R::DELETE_QUERIES:
+  {
+    std::vector<GLuint> names = removeNames (m_queries, getArray<GLuint> ());
+    m_context->deleteQueries (names.size (), names.data ());
+    break;
+  }
+  case R::DELETE_SHADER:
+    m_context->deleteShader (removeNames (m_programs, { get<GLuint> () })[0]);
+    break;
+  case R::DELETE_TEXTURES:
+  {
+    std::vector<GLuint> names = removeNames (m_textures, getArray<GLuint> ());
+    m_context->deleteTextures (names.size (), names.data ());
+    break;
+  }
+  case R::DELETE_VERTEX_ARRAYS:
+  {
+    std::vector<GLuint> names = removeNames (m_vertexArrays, getArray<GLuint> ());
+    m_context->deleteVertexArrays (names.size (), names.data ());
+    break;
+  }
+  case R::DEPTH_FUNC:
+    m_context->depthFunc (get<GLenum> ());
+    break;
+  case R::DETACH_SHADER:
+  {
+    GLuint program = translate (m_programs, get<GLuint> ());
+    m_context->detachShader (program, translate (m_programs, get<GLuint> ()));
+    break;
+  }
+  case R::DISPATCH_COMPUTE:
+  {
+    GLuint groupsX = get<GLuint> ();
+    GLuint groupsY = get<GLuint> ();
+    m_context->dispatchCompute (groupsX, groupsY, get<GLuint> ());
+    break;
+  }
+  case R::DRAW_ARRAYS:
+  {
+    GLenum mode = get<GLenum> ();
+    GLint first = get<GLint> ();
+    m_context->drawArrays (mode, first, get<GLsizei> ());
+    break;
+  }
+  case R::DRAW_BUFFERS:
+  {
+    std::vector<GLenum> buffers = getArray<GLenum> ();
+    m_context->drawBuffers (buffers.size (), buffers.data ());
+    break;
+  }
+  case R::DRAW_ELEMENTS:
+  {
+    GLenum mode = get<GLenum> ();
+    GLsizei count = get<GLsizei> ();
+    GLenum indexType = get<GLenum> ();
+    std::uintptr_t offset = get<std::uint64_t> ();
+    m_context->drawElements (mode, count, indexType, reinterpret_cast<const void*> (offset));
+    break;
+  }
+  case R::ENABLE:
+    m_context->enable (get<GLenum> ());
+    break;
+  case R::ENABLE_VERTEX_ARRAY_ATTRIB:
+  {
+    GLuint array = translate (m_vertexArrays, get<GLuint> ());
+    m_context->enableVertexArrayAttrib (array, get<GLuint> ());
+    break;
+  }
+  case R::ENABLE_VERTEX_ATTRIB_ARRAY:
+    m_context->enableVertexAttribArray (get<GLuint> ());
+    break;
+  case R::FRAMEBUFFER_TEXTURE_2D:
+  {
+    GLenum target = get<GLenum> ();
+    GLenum attachment = get<GLenum> ();
+    GLenum textarget = get<GLenum> ();
+    GLuint texture = translate (m_textures, get<GLuint> ());
+    m_context->framebufferTexture2D (target, attachment, textarget, texture, get<GLint> ());
+    break;
+  }
+  case R::FRONT_FACE:
+    m_context->frontFace (get<GLenum> ());
+    break;
+  case R::GEN_BUFFERS:
+  case R::GEN_FRAMEBUFFERS:
+  case R::GEN_QUERIES:
+  case R::GEN_TEXTURES:
+  case R::GEN_VERTEX_ARRAYS:
+  {
+    std::vector<GLuint> recorded = getArray<GLuint> ();
+    std::vector<GLuint> names (recorded.size ());
+    if (call == R::GEN_BUFFERS)
+    {
+      m_context->genBuffers (names.size (), names.data ());
+      addNames (m_buffers, recorded, names.data ());
+    }
+    else if (call == R::GEN_FRAMEBUFFERS)
+    {
+      m_context->genFramebuffers (names.size (), names.data ());
+      addNames (m_framebuffers, recorded, names.data ());
+    }
+    else if (call == R::GEN_QUERIES)
+    {
+      m_context->genQueries (names.size (), names.data ());
+      addNames (m_queries, recorded, names.data ());
+    }
+    else if (call == R::GEN_TEXTURES)
+    {
+      m_context->genTextures (names.size (), names.data ());
+      addNames (m_textures, recorded, names.data ());
+    }
+    else
+    {
+      m_context->genVertexArrays (names.size (), names.data ());
+      addNames (m_vertexArrays, recorded, names.data ());
+    }
+    break;
+  }
+  case R::GET_ACTIVE_UNIFORM:
+  {
+    GLuint program = translate (m_programs, get<GLuint> ());
+    m_context->getActiveUniform (program, get<GLuint> (), QUERY_BUFFER_SIZE, &length,
+                                 &size, &type, text);
+    break;
+  }
+  case R::GET_ATTRIB_LOCATION:
+  {
+    GLuint program = translate (m_programs, get<GLuint> ());
+    std::string name = getString ();
+    get<GLint> ();
+    m_context->getAttribLocation (program, name.c_str ());
+    break;
+  }
+  case R::GET_INTEGERV:
+    m_context->getIntegerv (get<GLenum> (), integers);
+    break;
+  case R::GET_PROGRAM_BINARY:
+  {
+    GLuint program = translate (m_programs, get<GLuint> ());
+    // The size the recording asked for isn't known, so it is asked again.
+    GLint binarySize = 0;
+    m_context->getProgramiv (program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+    std::vector<unsigned char> binary (std::max (binarySize, 1));
+    m_context->getProgramBinary (program, binary.size (), &length, &type, binary.data ());
+    break;
+  }
+  case R::GET_PROGRAM_INFO_LOG:
+    m_context->getProgramInfoLog (translate (m_programs, get<GLuint> ()),
+                                  QUERY_BUFFER_SIZE, &length, text);
+    break;
+  case R::GET_PROGRAMIV:
+  {
+    GLuint program = translate (m_programs, get<GLuint> ());
+    m_context->getProgramiv (program, get<GLenum> (), integers);
+    break;
+  }
+  case R::GET_QUERY_OBJECTIV:
+  {
+    GLuint query = translate (m_queries, get<GLuint> ());
+    m_context->getQueryObjectiv (query, get<GLenum> (), integers);
+    break;
+  }
+  case R::GET_QUERY_OBJECTUI64V:
+  {
+    GLuint query = translate (m_queries, get<GLuint> ());
+    GLuint64 result;
+    m_context->getQueryObjectui64v (query, get<GLenum> (), &result);
+    break;
+  }
+  case R::GET_SHADER_INFO_LOG:
+    m_context->getShaderInfoLog (translate (m_programs, get<GLuint> ()),
+                                 QUERY_BUFFER_SIZE, &length, text);
+    break;
+  case R::GET_SHADERIV:
+  {
+    GLuint shader = translate (m_programs, get<GLuint> ());
+    m_context->getShaderiv (shader, get<GLenum> (), integers);
+    break;
+  }
+  case R::GET_STRING:
+    m_context->getString (get<GLenum> ());
+    break;
+  case R::GET_UNIFORM_BLOCK_INDEX:
+  {
+    GLuint recordedProgram = get<GLuint> ();
+    std::string name = getString ();
+    GLuint recorded = get<GLuint> ();
+    GLuint index = m_context->getUniformBlockIndex (translate (m_programs, recordedProgram),
+                                                    name.c_str ());
+    m_blockIndices[std::make_pair (recordedProgram, recorded)] = index;
+    break;
+  }
+  case R::GET_UNIFORM_LOCATION:
+  {
+    GLuint recordedProgram = get<GLuint> ();
+    std::string name = getString ();
+    GLint recorded = get<GLint> ();
+    GLint location = m_context->getUniformLocation (translate (m_programs, recordedProgram),
+                                                    name.c_str ());
+    if (recorded != -1)
+      m_locations[std::make_pair (recordedProgram, recorded)] = location;
+    break;
+  }
+  case R::LINK_PROGRAM:
+    m_context->linkProgram (translate (m_programs, get<GLuint> ()));
+    break;
+  case R::MAX_SHADER_COMPILER_THREADS_KHR:
+    m_context->maxShaderCompilerThreadsKHR (get<GLuint> ());
+    break;
+  case R::MEMORY_BARRIER:
+    m_context->memoryBarrier (get<GLbitfield> ());
+    break;
+  case R::MULTI_DRAW_ELEMENTS_INDIRECT:
+  {
+    GLenum mode = get<GLenum> ();
+    GLenum indexType = get<GLenum> ();
+    std::uintptr_t offset = get<std::uint64_t> ();
+    GLsizei drawCount = get<GLsizei> ();
+    GLsizei stride = get<GLsizei> ();
+    m_context->multiDrawElementsIndirect (mode, indexType, reinterpret_cast<const void*> (offset),
+                                          drawCount, stride);
+    break;
+  }
+  case R::MULTI_DRAW_ELEMENTS_INDIRECT_COUNT:
+  {
+    GLenum mode = get<GLenum> ();
+    GLenum indexType = get<GLenum> ();
+    std::uintptr_t offset = get<std::uint64_t> ();
+    std::int64_t drawCount = get<std::int64_t> ();
+    GLsizei maxDrawCount = get<GLsizei> ();
+    GLsizei stride = get<GLsizei> ();
+    m_context->multiDrawElementsIndirectCount (mode, indexType,
+                                               reinterpret_cast<const void*> (offset),
+                                               drawCount, maxDrawCount, stride);
+    break;
+  }
+  case R::NAMED_BUFFER_DATA:
+  case R::NAMED_BUFFER_STORAGE:
+  case R::NAMED_BUFFER_SUB_DATA:
+  {
+    GLuint buffer = translate (m_buffers, get<GLuint> ());
+    std::int64_t offset = call == R::NAMED_BUFFER_SUB_DATA ? get<std::int64_t> () : 0;
+    std::int64_t bytes = get<std::int64_t> ();
+    const void* data;
+    if (!getContents (bytes, data))
+      break;
+    if (call == R::NAMED_BUFFER_DATA)
+      m_context->namedBufferData (buffer, bytes, data, get<GLenum> ());
+    else if (call == R::NAMED_BUFFER_STORAGE)
+      m_context->namedBufferStorage (buffer, bytes, data, get<GLbitfield> ());
+    else
+      m_context->namedBufferSubData (buffer, offset, bytes, data);
+    break;
+  }
+  case R::PROGRAM_BINARY:
+  {
+    GLuint program = translate (m_programs, get<GLuint> ());
+    GLenum format = get<GLenum> ();
+    std::vector<unsigned char> binary = getArray<unsigned char> ();
+    m_context->programBinary (program, format, binary.data (), binary.size ());
+    break;
+  }
+  case R::PROGRAM_PARAMETERI:
+  {
+    GLuint program = translate (m_programs, get<GLuint> ());
+    GLenum pname = get<GLenum> ();
+    m_context->programParameteri (program, pname, get<GLint> ());
+    break;
+  }
+  case R::QUERY_COUNTER:
+  {
+    GLuint query = translate (m_queries, get<GLuint> ());
+    m_context->queryCounter (query, get<GLenum> ());
+    break;
+  }
+  case R::SHADER_SOURCE:
+  {
+    GLuint shader = translate (m_programs, get<GLuint> ());
+    std::uint32_t count = get<std::uint32_t> ();
+    std::vector<std::string> strings;
+    for (std::uint32_t i = 0; i < count && !m_damaged; ++i)
+      strings.push_back (getString ());
+    std::vector<const GLchar*> pointers;
+    std::vector<GLint> lengths;
+    for (const std::string& string : strings)
+    {
+      pointers.push_back (string.data ());
+      lengths.push_back (string.size ());
+    }
+    m_context->shaderSource (shader, pointers.size (), pointers.data (), lengths.data ());
+    break;
+  }
+  case R::TEX_BUFFER:
+  {
+    GLenum target = get<GLenum> ();
+    GLenum internalformat = get<GLenum> ();
+    m_context->texBuffer (target, internalformat, translate (m_buffers, get<GLuint> ()));
+    break;
+  }
+  case R::TEX_IMAGE_2D:
+  {
+    GLenum target = get<GLenum> ();
+    GLint level = get<GLint> ();
+    GLint internalformat = get<GLint> ();
+    GLsizei width = get<GLsizei> ();
+    GLsizei height = get<GLsizei> ();
+    GLint border = get<GLint> ();
+    GLenum format = get<GLenum> ();
+    GLenum pixelType = get<GLenum> ();
+    std::vector<unsigned char> pixels = getArray<unsigned char> ();
+    m_context->texImage2D (target, level, internalformat, width, height, border, format,
+                           pixelType, pixels.empty () ? nullptr : pixels.data ());
+    break;
+  }
+  case R::TEX_PARAMETERI:
+  {
+    GLenum target = get<GLenum> ();
+    GLenum pname = get<GLenum> ();
+    m_context->texParameteri (target, pname, get<GLint> ());
+    break;
+  }
+  case R::UNIFORM_1F:
+  {
+    GLint location = translateLocation (get<GLint> ());
+    m_context->uniform1f (location, get<GLfloat> ());
+    break;
+  }
+  case R::UNIFORM_1I:
+  {
+    GLint location = translateLocation (get<GLint> ());
+    m_context->uniform1i (location, get<GLint> ());
+    break;
+  }
+  case R::UNIFORM_3F:
+  {
+    GLint location = translateLocation (get<GLint> ());
+    GLfloat v0 = get<GLfloat> ();
+    GLfloat v1 = get<GLfloat> ();
+    m_context->uniform3f (location, v0, v1, get<GLfloat> ());
+    break;
+  }
+  case R::UNIFORM_BLOCK_BINDING:
+  {
+    GLuint recordedProgram = get<GLuint> ();
+    GLuint recordedIndex = get<GLuint> ();
+    auto index = m_blockIndices.find (std::make_pair (recordedProgram, recordedIndex));
+    m_context->uniformBlockBinding (translate (m_programs, recordedProgram),
+                                    index == m_blockIndices.end () ? recordedIndex
+                                                                   : index->second,
+                                    get<GLuint> ());
+    break;
+  }
+  case R::UNIFORM_MATRIX_3FV:
+  case R::UNIFORM_MATRIX_4FV:
+  {
+    GLint location = translateLocation (get<GLint> ());
+    GLboolean transpose = get<GLboolean> ();
+    std::vector<GLfloat> values = getArray<GLfloat> ();
+    if (call == R::UNIFORM_MATRIX_3FV)
+      m_context->uniformMatrix3fv (location, values.size () / 9, transpose, values.data ());
+    else
+      m_context->uniformMatrix4fv (location, values.size () / 16, transpose, values.data ());
+    break;
+  }
+  case R::USE_PROGRAM:
+    m_program = get<GLuint> ();
+    m_context->useProgram (translate (m_programs, m_program));
+    break;
+  case R::VERTEX_ARRAY_ATTRIB_BINDING:
+  {
+    GLuint array = translate (m_vertexArrays, get<GLuint> ());
+    GLuint index = get<GLuint> ();
+    m_context->vertexArrayAttribBinding (array, index, get<GLuint> ());
+    break;
+  }
+  case R::VERTEX_ARRAY_ATTRIB_FORMAT:
+  {
+    GLuint array = translate (m_vertexArrays, get<GLuint> ());
+    GLuint index = get<GLuint> ();
+    GLint components = get<GLint> ();
+    GLenum componentType = get<GLenum> ();
+    GLboolean normalized = get<GLboolean> ();
+    m_context->vertexArrayAttribFormat (array, index, components, componentType, normalized,
+                                        get<GLuint> ());
+    break;
+  }
+  case R::VERTEX_ARRAY_ELEMENT_BUFFER:
+  {
+    GLuint array = translate (m_vertexArrays, get<GLuint> ());
+    m_context->vertexArrayElementBuffer (array, translate (m_buffers, get<GLuint> ()));
+    break;
+  }
+  case R::VERTEX_ARRAY_VERTEX_BUFFER:
+  {
+    GLuint array = translate (m_vertexArrays, get<GLuint> ());
+    GLuint binding = get<GLuint> ();
+    GLuint buffer = translate (m_buffers, get<GLuint> ());
+    std::int64_t offset = get<std::int64_t> ();
+    m_context->vertexArrayVertexBuffer (array, binding, buffer, offset, get<GLsizei> ());
+    break;
+  }
+  case R::VERTEX_ATTRIB_POINTER:
+  {
+    GLuint index = get<GLuint> ();
+    GLint components = get<GLint> ();
+    GLenum componentType = get<GLenum> ();
+    GLboolean normalized = get<GLboolean> ();
+    GLsizei stride = get<GLsizei> ();
+    std::uintptr_t offset = get<std::uint64_t> ();
+    m_context->vertexAttribPointer (index, components, componentType, normalized, stride,
+                                    reinterpret_cast<const GLvoid*> (offset));
+    break;
+  }
+  case R::VIEWPORT:
+  {
+    GLint x = get<GLint> ();
+    GLint y = get<GLint> ();
+    GLsizei width = get<GLsizei> ();
+    m_context->viewport (x, y, width, get<GLsizei> ());
+    break;
+  }
+  case R::BUFFER_CONTENTS:
+  {
+    std::uint64_t hash = get<std::uint64_t> ();
+    m_contents[hash] = getArray<unsigned char> ();
+    break;
+  }
+  case R::FRAME:
+  case R::RECORDED_CALL_COUNT:
+    break;
+  }
+}
+
+template<typename T>
+T
+TraceReplayer::get ()
+{
+  T value = T ();
+  if (m_position + sizeof (T) > m_trace.size ())
+  {
+    m_damaged = true;
+    m_position = m_trace.size ();
+    return value;
+  }
+  std::memcpy (&value, &m_trace[m_position], sizeof (T));
+  m_position += sizeof (T);
+  return value;
+}
+
+template<typename T>
+std::vector<T>
+TraceReplayer::getArray ()
+{
+  std::size_t count = get<std::uint32_t> ();
+  std::vector<T> values;
+  if (m_position + count * sizeof (T) > m_trace.size ())
+  {
+    m_damaged = true;
+    m_position = m_trace.size ();
+    return values;
+  }
+  values.resize (count);
+  if (count > 0)
+    std::memcpy (values.data (), &m_trace[m_position], count * sizeof (T));
+  m_position += count * sizeof (T);
+  return values;
+}
+
+std::string
+TraceReplayer::getString ()
+{
+  std::vector<char> bytes = getArray<char> ();
+  return std::string (bytes.begin (), bytes.end ());
+}
+
+bool
+TraceReplayer::getContents (std::int64_t size, const void*& data)
+{
+  std::uint64_t hash = get<std::uint64_t> ();
+  data = nullptr;
+  if (hash == 0)
+    return true;
+  auto contents = m_contents.find (hash);
+  if (contents == m_contents.end ()
+      || contents->second.size () != static_cast<std::size_t> (size))
+  {
+    fprintf (stderr, "Buffer contents %016llx are missing from the trace\n",
+             static_cast<unsigned long long> (hash));
+    m_damaged = true;
+    return false;
+  }
+  data = contents->second.data ();
+  return true;
+}
+
+GLuint
+TraceReplayer::translate (const std::map<GLuint, GLuint>& names, GLuint name)
+{
+  auto found = names.find (name);
+  return found == names.end () ? name : found->second;
+}
+
+void
+TraceReplayer::addNames (std::map<GLuint, GLuint>& names, const std::vector<GLuint>& recorded,
+                         const GLuint* replayed)
+{
+  for (std::size_t i = 0; i < recorded.size (); ++i)
+    names[recorded[i]] = replayed[i];
+}
+
+std::vector<GLuint>
+TraceReplayer::removeNames (std::map<GLuint, GLuint>& names, const std::vector<GLuint>& recorded)
+{
+  std::vector<GLuint> replayed;
+  for (GLuint name : recorded)
+  {
+    replayed.push_back (translate (names, name));
+    if (name != 0)
+      names.erase (name);
+  }
+  return replayed;
+}
+
+GLint
+TraceReplayer::translateLocation (GLint location) const
+{
+  if (location < 0)
+    return location;
+  // Only the first element of an array is looked up; the rest follow it.
+  auto after = m_locations.upper_bound (std::make_pair (m_program, location));
+  if (after == m_locations.begin ())
+    return location;
+  auto found = std::prev (after);
+  if (found->first.first != m_program || found->second < 0)
+    return location;
+  return found->second + (location - found->first.second);
+}
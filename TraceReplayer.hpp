@@ -0,0 +1,201 @@
+/// \file TraceReplayer.hpp
+/// \brief Declaration of TraceReplayer class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef TRACE_REPLAYER_HPP
+#define TRACE_REPLAYER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+#include "RecordingOpenGLContext.hpp"
+
+/// \brief How many calls of one kind a TraceReplayer has made, and how
+///   long they took.
+struct TraceCallStats
+{
+  /// The number of calls.
+  unsigned long count;
+  /// The total time spent in them, in microseconds.
+  double totalMicros;
+  /// The longest of them, in microseconds.
+  double maxMicros;
+};
+
+/// \brief Makes the calls in a log written by a RecordingOpenGLContext
+///   again, through another OpenGLContext, one frame at a time.
+///
+/// The objects the trace creates get new names from the context they are
+///   replayed through, and the calls that use them are given the new names;
+///   uniform locations and block indices are translated the same way, by
+///   the program they were looked up in.  Queries are made again (since they
+///   can stall the driver, which is part of what is being measured), but
+///   their answers are thrown away.  A trace must be replayed from the
+///   start, since its first frame creates what the rest use.
+class TraceReplayer
+{
+public:
+
+  /// \brief Constructs a TraceReplayer with no trace.
+  /// \param[in] context The context to make the calls through.
+  explicit
+  TraceReplayer (OpenGLContext* context);
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   TraceReplayers.
+  TraceReplayer (const TraceReplayer&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   TraceReplayers.
+  TraceReplayer&
+  operator= (const TraceReplayer&) = delete;
+
+  /// \brief Reads a trace saved by RecordingOpenGLContext::save ().
+  /// \param[in] path The file's path.
+  /// \return Whether or not it was read and is a trace of this version.
+  /// \post The next replayFrame () starts from its beginning.
+  bool
+  load (const std::string& path);
+
+  /// \brief Uses a log straight from RecordingOpenGLContext::getLog ().
+  /// \param[in] log The log.
+  /// \post The next replayFrame () starts from its beginning.
+  void
+  setTrace (const std::vector<unsigned char>& log);
+
+  /// \brief Makes the calls of the next frame.
+  /// \return Whether or not a whole frame was made; false at the end of
+  ///   the trace, or if it is damaged (which is reported on stderr).
+  bool
+  replayFrame ();
+
+  /// \brief Gets when the last frame replayed was recorded.
+  /// \return The microseconds from the start of the recording to the end of
+  ///   that frame.
+  std::uint64_t
+  getFrameTime () const;
+
+  /// \brief Gets the number of frames replayed.
+  /// \return The number of whole frames.
+  std::size_t
+  getFrameCount () const;
+
+  /// \brief Gets how many calls of one kind have been made and how long
+  ///   they took.
+  /// \param[in] call The kind of call.
+  /// \return The stats since the trace was loaded or the last
+  ///   resetCallStats ().
+  const TraceCallStats&
+  getCallStats (RecordingOpenGLContext::RecordedCall call) const;
+
+  /// \brief Sets every stat back to zero, e.g., after the first frame.
+  void
+  resetCallStats ();
+
+private:
+
+  /// \brief Makes the call in one record.
+  /// \param[in] call The kind of call, already read.
+  void
+  replayCall (RecordingOpenGLContext::RecordedCall call);
+
+  /// \brief Reads one value from the trace.
+  /// \return The value, or 0 if the trace ended (which marks it damaged).
+  template<typename T>
+  T
+  get ();
+
+  /// \brief Reads a count followed by that many elements.
+  /// \return The elements; none if the trace ended.
+  template<typename T>
+  std::vector<T>
+  getArray ();
+
+  /// \brief Reads a count of bytes followed by the bytes, as a string.
+  /// \return The string; empty if the trace ended.
+  std::string
+  getString ();
+
+  /// \brief Reads the hash of some buffer contents and looks them up.
+  /// \param[in] size The number of bytes the call that uploads them says
+  ///   there are.
+  /// \param[out] data The contents, or null if a null pointer was recorded.
+  /// \return Whether or not the contents were found with that size (if not,
+  ///   the trace is marked damaged).
+  bool
+  getContents (std::int64_t size, const void*& data);
+
+  /// \brief Translates a recorded name into a replayed one.
+  /// \param[in] names The names of one kind of object.
+  /// \param[in] name The recorded name.
+  /// \return The replayed name; 0 stays 0, and a name never created is
+  ///   passed through unchanged.
+  static GLuint
+  translate (const std::map<GLuint, GLuint>& names, GLuint name);
+
+  /// \brief Records the names that a gen* or create* call made.
+  /// \param[in,out] names The names of that kind of object.
+  /// \param[in] recorded The recorded names.
+  /// \param[in] replayed The new names, in the same order.
+  static void
+  addNames (std::map<GLuint, GLuint>& names, const std::vector<GLuint>& recorded,
+            const GLuint* replayed);
+
+  /// \brief Translates and forgets the names passed to a delete* call.
+  /// \param[in,out] names The names of that kind of object.
+  /// \param[in] recorded The recorded names.
+  /// \return The replayed names.
+  static std::vector<GLuint>
+  removeNames (std::map<GLuint, GLuint>& names, const std::vector<GLuint>& recorded);
+
+  /// \brief Translates a recorded uniform location.
+  /// \param[in] location The location recorded for the program in use.
+  /// \return The location in the replayed program.
+  GLint
+  translateLocation (GLint location) const;
+
+  /// The context to make the calls through.
+  OpenGLContext* m_context;
+  /// The trace.
+  std::vector<unsigned char> m_trace;
+  /// The offset of the next record.
+  std::size_t m_position;
+  /// Whether or not the trace ended in the middle of a record or held a
+  ///   record of no known kind.
+  bool m_damaged;
+  /// The time recorded at the end of the last frame.
+  std::uint64_t m_frameTime;
+  /// The number of frames replayed.
+  std::size_t m_frameCount;
+  /// The buffer contents seen so far, by hash.
+  std::map<std::uint64_t, std::vector<unsigned char>> m_contents;
+  /// Replayed names of buffers, by recorded name.
+  std::map<GLuint, GLuint> m_buffers;
+  /// Replayed names of framebuffers, by recorded name.
+  std::map<GLuint, GLuint> m_framebuffers;
+  /// Replayed names of programs and shaders, by recorded name.
+  std::map<GLuint, GLuint> m_programs;
+  /// Replayed names of queries, by recorded name.
+  std::map<GLuint, GLuint> m_queries;
+  /// Replayed names of textures, by recorded name.
+  std::map<GLuint, GLuint> m_textures;
+  /// Replayed names of vertex arrays, by recorded name.
+  std::map<GLuint, GLuint> m_vertexArrays;
+  /// Replayed uniform locations, by recorded program and location.
+  std::map<std::pair<GLuint, GLint>, GLint> m_locations;
+  /// Replayed uniform block indices, by recorded program and index.
+  std::map<std::pair<GLuint, GLuint>, GLuint> m_blockIndices;
+  /// The recorded name of the program in use.
+  GLuint m_program;
+  /// The stats of each kind of call.
+  TraceCallStats m_stats[RecordingOpenGLContext::RECORDED_CALL_COUNT];
+};
+
+#endif//TRACE_REPLAYER_HPP
@@ -0,0 +1,294 @@
+/// \file TransformHierarchy.cpp
+/// \brief Definition of TransformHierarchy class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstdio>
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "TransformHierarchy.hpp"
+#include "JobSystem.hpp"
+
+const unsigned int TransformHierarchy::NO_PARENT = ~0u;
+
+namespace
+{
+  /// \brief Multiplies two column-major 4x4 matrices.
+  /// \param[in] a The matrix on the left.
+  /// \param[in] b The matrix on the right.
+  /// \param[out] out The product a * b, which must not overlap a or b.
+  void
+  multiply (const float* a, const float* b, float* out)
+  {
+#ifdef __SSE__
+    __m128 a0 = _mm_loadu_ps (a);
+    __m128 a1 = _mm_loadu_ps (a + 4);
+    __m128 a2 = _mm_loadu_ps (a + 8);
+    __m128 a3 = _mm_loadu_ps (a + 12);
+    for (int col = 0; col < 4; ++col)
+    {
+      const float* bc = b + 4 * col;
+      __m128 sum = _mm_mul_ps (a0, _mm_set1_ps (bc[0]));
+      sum = _mm_add_ps (sum, _mm_mul_ps (a1, _mm_set1_ps (bc[1])));
+      sum = _mm_add_ps (sum, _mm_mul_ps (a2, _mm_set1_ps (bc[2])));
+      sum = _mm_add_ps (sum, _mm_mul_ps (a3, _mm_set1_ps (bc[3])));
+      _mm_storeu_ps (out + 4 * col, sum);
+    }
+#else
+    for (int col = 0; col < 4; ++col)
+      for (int row = 0; row < 4; ++row)
+        out[4 * col + row] = a[row] * b[4 * col]
+          + a[4 + row] * b[4 * col + 1]
+          + a[8 + row] * b[4 * col + 2]
+          + a[12 + row] * b[4 * col + 3];
+#endif
+  }
+
+  /// The number of nodes handed to each job by TransformHierarchy::update.
+  const unsigned int NODES_PER_JOB = 1024;
+
+  /// \brief Runs a loop body over [begin, end), on a JobSystem if there is
+  ///   one.
+  /// \param[in] jobs The JobSystem, or nullptr to run on the calling thread.
+  /// \param[in] begin The first index.
+  /// \param[in] end One past the last index.
+  /// \param[in] body The loop body, called on disjoint ranges.
+  void
+  forRange (JobSystem* jobs, unsigned int begin, unsigned int end,
+            const JobSystem::RangeJob& body)
+  {
+    if (jobs == nullptr)
+      body (begin, end);
+    else
+      jobs->parallelFor (begin, end, NODES_PER_JOB, body);
+  }
+}
+
+TransformHierarchy::TransformHierarchy ()
+  : m_orderDirty (false)
+{
+}
+
+TransformHierarchy::~TransformHierarchy ()
+{
+}
+
+unsigned int
+TransformHierarchy::add (const Transform& local, unsigned int parent)
+{
+  unsigned int node = m_locals.add (local);
+  if (node == m_parents.size ())
+  {
+    m_parents.push_back (parent);
+    m_children.emplace_back ();
+    m_worldMatrices.resize (16 * m_parents.size ());
+  }
+  else
+  {
+    m_parents[node] = parent;
+  }
+  if (parent != NO_PARENT)
+    m_children[parent].push_back (node);
+  m_orderDirty = true;
+  return node;
+}
+
+void
+TransformHierarchy::remove (unsigned int node)
+{
+  // Each child takes on the removed node's local transform, so that its
+  //   world transform stays where it was.
+  unsigned int parent = m_parents[node];
+  Transform local = m_locals.get (node);
+  for (unsigned int child : m_children[node])
+  {
+    Transform rebased = local;
+    rebased.combine (m_locals.get (child));
+    m_locals.set (child, rebased);
+    m_parents[child] = parent;
+    if (parent != NO_PARENT)
+      m_children[parent].push_back (child);
+  }
+  m_children[node].clear ();
+  unlinkChild (node);
+  m_locals.remove (node);
+  m_parents[node] = NO_PARENT;
+  m_orderDirty = true;
+}
+
+void
+TransformHierarchy::setParent (unsigned int node, unsigned int parent)
+{
+  if (parent != NO_PARENT && isWithin (parent, node))
+  {
+    fprintf (stderr, "Cannot attach transform node %u beneath node %u, its descendant\n",
+	     node, parent);
+    return;
+  }
+  unlinkChild (node);
+  m_parents[node] = parent;
+  if (parent != NO_PARENT)
+    m_children[parent].push_back (node);
+  m_locals.markDirty (node);
+  m_orderDirty = true;
+}
+
+unsigned int
+TransformHierarchy::getParent (unsigned int node) const
+{
+  return m_parents[node];
+}
+
+Transform
+TransformHierarchy::getLocal (unsigned int node) const
+{
+  return m_locals.get (node);
+}
+
+TransformStore&
+TransformHierarchy::getLocals ()
+{
+  return m_locals;
+}
+
+void
+TransformHierarchy::setLocal (unsigned int node, const Transform& local)
+{
+  m_locals.set (node, local);
+}
+
+Transform
+TransformHierarchy::getWorld (unsigned int node) const
+{
+  const float* m = &m_worldMatrices[16 * node];
+  return Transform (Matrix3 (m[0], m[1], m[2], m[4], m[5], m[6], m[8], m[9], m[10]),
+                    Vector3 (m[12], m[13], m[14]));
+}
+
+Matrix4
+TransformHierarchy::getWorldMatrix (unsigned int node) const
+{
+  const float* m = &m_worldMatrices[16 * node];
+  return Matrix4 (Vector4 (m[0], m[1], m[2], m[3]),
+                  Vector4 (m[4], m[5], m[6], m[7]),
+                  Vector4 (m[8], m[9], m[10], m[11]),
+                  Vector4 (m[12], m[13], m[14], m[15]));
+}
+
+const float*
+TransformHierarchy::getWorldMatrices () const
+{
+  return m_worldMatrices.empty () ? nullptr : m_worldMatrices.data ();
+}
+
+unsigned int
+TransformHierarchy::getNodeCapacity () const
+{
+  return m_parents.size ();
+}
+
+unsigned int
+TransformHierarchy::update (JobSystem* jobs)
+{
+  if (m_orderDirty)
+    rebuildOrder ();
+
+  // Levels are visited in order, so a dirty parent has already pushed its
+  //   flag down by the time we reach the child.  Within a level every node
+  //   writes only its own slots, and each worker notes the nodes it
+  //   recomputed in a list of its own.
+  m_recomputed.resize (jobs == nullptr ? 1 : jobs->getWorkerCount ());
+  for (unsigned int level = 0; level + 1 < m_levelStarts.size (); ++level)
+  {
+    forRange (jobs, m_levelStarts[level], m_levelStarts[level + 1],
+              [this, jobs] (unsigned int first, unsigned int last)
+              {
+                std::vector<unsigned int>& recomputed
+                  = m_recomputed[jobs == nullptr ? 0 : jobs->getCurrentWorker ()];
+                for (unsigned int i = first; i < last; ++i)
+                {
+                  unsigned int node = m_order[i];
+                  unsigned int parent = m_parents[node];
+                  if (parent != NO_PARENT && m_locals.isDirty (parent))
+                    m_locals.markDirty (node);
+                  if (!m_locals.isDirty (node))
+                    continue;
+
+                  float* world = &m_worldMatrices[16 * node];
+                  if (parent == NO_PARENT)
+                  {
+                    m_locals.writeMatrix (node, world);
+                  }
+                  else
+                  {
+                    float local[16];
+                    m_locals.writeMatrix (node, local);
+                    multiply (&m_worldMatrices[16 * parent], local, world);
+                  }
+                  recomputed.push_back (node);
+                }
+              });
+  }
+
+  // Only the nodes that were recomputed can still be dirty.
+  unsigned int count = 0;
+  for (std::vector<unsigned int>& recomputed : m_recomputed)
+  {
+    for (unsigned int node : recomputed)
+      m_locals.clearDirty (node);
+    count += recomputed.size ();
+    recomputed.clear ();
+  }
+  return count;
+}
+
+void
+TransformHierarchy::rebuildOrder ()
+{
+  // Sort live nodes by depth; every parent is exactly one level shallower
+  //   than its children.
+  std::vector<unsigned int> depth (m_parents.size (), 0);
+  m_order.clear ();
+  for (unsigned int node = 0; node < m_parents.size (); ++node)
+  {
+    if (!m_locals.isAlive (node))
+      continue;
+    for (unsigned int p = m_parents[node]; p != NO_PARENT; p = m_parents[p])
+      ++depth[node];
+    m_order.push_back (node);
+  }
+  std::stable_sort (m_order.begin (), m_order.end (),
+                    [&depth] (unsigned int a, unsigned int b)
+                    { return depth[a] < depth[b]; });
+  m_levelStarts.clear ();
+  for (unsigned int i = 0; i < m_order.size (); ++i)
+    if (i == 0 || depth[m_order[i]] != depth[m_order[i - 1]])
+      m_levelStarts.push_back (i);
+  m_levelStarts.push_back (m_order.size ());
+  m_orderDirty = false;
+}
+
+void
+TransformHierarchy::unlinkChild (unsigned int node)
+{
+  if (m_parents[node] == NO_PARENT)
+    return;
+  std::vector<unsigned int>& siblings = m_children[m_parents[node]];
+  std::vector<unsigned int>::iterator found = std::find (siblings.begin (), siblings.end (), node);
+  *found = siblings.back ();
+  siblings.pop_back ();
+}
+
+bool
+TransformHierarchy::isWithin (unsigned int node, unsigned int ancestor) const
+{
+  for (unsigned int p = node; p != NO_PARENT; p = m_parents[p])
+    if (p == ancestor)
+      return true;
+  return false;
+}
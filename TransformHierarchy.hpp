@@ -0,0 +1,188 @@
+/// \file TransformHierarchy.hpp
+/// \brief Declaration of TransformHierarchy class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef TRANSFORM_HIERARCHY_HPP
+#define TRANSFORM_HIERARCHY_HPP
+
+#include <vector>
+
+#include "Transform.hpp"
+#include "TransformStore.hpp"
+#include "Matrix4.hpp"
+
+class JobSystem;
+
+/// \brief A parent/child tree of transforms (a scene graph), in which each
+///   node's world transform is its parent's world transform combined with its
+///   own local transform.
+///
+/// Nodes are identified by small integers, which are also their slots in a
+///   TransformStore that holds every local transform.  Changing a local
+///   transform (one at a time or with the store's bulk operations) only marks
+///   that node dirty; the world transforms of it and all of its descendants
+///   are brought up to date by the next call to update (), which visits the
+///   nodes once in an order where every parent comes before its children,
+///   turning local transforms into matrices and recomputing world matrices
+///   only in the subtrees that changed.  The resulting world matrices are stored in a contiguous array,
+///   indexed by node, that can be handed straight to OpenGL.
+class TransformHierarchy
+{
+public:
+
+  /// \brief The parent of a node that sits at the root of the tree.
+  static const unsigned int NO_PARENT;
+
+  /// \brief Constructs an empty TransformHierarchy.
+  TransformHierarchy ();
+
+  /// \brief Destructs a TransformHierarchy.
+  ~TransformHierarchy ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   TransformHierarchies.
+  TransformHierarchy (const TransformHierarchy&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   TransformHierarchies.
+  TransformHierarchy&
+  operator= (const TransformHierarchy&) = delete;
+
+  /// \brief Adds a new node to the tree.
+  /// \param[in] local The transform of the new node relative to its parent.
+  /// \param[in] parent The node that the new node should be attached to, or
+  ///   NO_PARENT for a root.
+  /// \return The identifier of the new node.
+  /// \pre parent is NO_PARENT or a node in this hierarchy.
+  /// \post The new node is dirty.
+  unsigned int
+  add (const Transform& local, unsigned int parent = NO_PARENT);
+
+  /// \brief Removes a node from the tree.
+  /// \param[in] node The node to remove.
+  /// \pre node is in this hierarchy.
+  /// \post Any children of node have been attached to node's parent, with
+  ///   node's local transform folded into theirs, so that their world
+  ///   transforms are unchanged.
+  /// \post node's identifier may be handed out again by a future add ().
+  void
+  remove (unsigned int node);
+
+  /// \brief Attaches a node to a new parent.
+  /// \param[in] node The node that should move.
+  /// \param[in] parent The node's new parent, or NO_PARENT to make it a root.
+  /// \pre node and parent (unless NO_PARENT) are in this hierarchy.
+  /// \post If parent is not node or one of its descendants, node is now a
+  ///   child of parent and is dirty.  Otherwise an error has been printed and
+  ///   nothing has changed.
+  void
+  setParent (unsigned int node, unsigned int parent);
+
+  /// \brief Gets the parent of a node.
+  /// \param[in] node A node in this hierarchy.
+  /// \return The node's parent, or NO_PARENT if it is a root.
+  unsigned int
+  getParent (unsigned int node) const;
+
+  /// \brief Gets the local transform of a node.
+  /// \param[in] node A node in this hierarchy.
+  /// \return A copy of the node's transform relative to its parent.
+  Transform
+  getLocal (unsigned int node) const;
+
+  /// \brief Gets the store that holds every node's local transform, so that
+  ///   they can be changed one at a time or in bulk.
+  /// \return The store, whose slot for each node is the node's identifier.
+  ///   Its slots must not be added or removed except through this hierarchy.
+  TransformStore&
+  getLocals ();
+
+  /// \brief Replaces the local transform of a node.
+  /// \param[in] node A node in this hierarchy.
+  /// \param[in] local The node's new transform relative to its parent.
+  /// \post node is dirty.
+  void
+  setLocal (unsigned int node, const Transform& local);
+
+  /// \brief Gets the world transform of a node as of the last update ().
+  /// \param[in] node A node in this hierarchy.
+  /// \return The cached world transform of the node.
+  Transform
+  getWorld (unsigned int node) const;
+
+  /// \brief Gets the world matrix of a node as of the last update ().
+  /// \param[in] node A node in this hierarchy.
+  /// \return The cached world matrix of the node.
+  Matrix4
+  getWorldMatrix (unsigned int node) const;
+
+  /// \brief Gets all of the cached world matrices.
+  /// \return A pointer to getNodeCapacity () column-major 4x4 matrices, one
+  ///   per node identifier.  Slots of removed nodes hold stale data.
+  const float*
+  getWorldMatrices () const;
+
+  /// \brief Gets the number of node identifiers in use or available for
+  ///   reuse.
+  /// \return One more than the largest identifier handed out so far.
+  unsigned int
+  getNodeCapacity () const;
+
+  /// \brief Brings every world transform up to date.
+  /// \param[in] jobs The JobSystem to spread the work over, or nullptr to do
+  ///   it all on the calling thread.  Nodes at the same depth do not depend
+  ///   on each other, so each level of the tree is split into jobs, and the
+  ///   levels are finished one after another.
+  /// \return The number of nodes whose world transforms were recomputed.
+  /// \post Every node's world transform is its parent's world transform
+  ///   combined with its local transform, and no node is dirty.
+  unsigned int
+  update (JobSystem* jobs = nullptr);
+
+private:
+
+  /// \brief Recomputes m_order so that every parent appears before its
+  ///   children, and m_levelStarts to match.
+  void
+  rebuildOrder ();
+
+  /// \brief Takes a node out of its parent's list of children.
+  /// \param[in] node A node in this hierarchy.
+  /// \post node is not among the children of m_parents[node], which is
+  ///   otherwise unchanged (but for the order of the children).
+  void
+  unlinkChild (unsigned int node);
+
+  /// \brief Tests whether or not one node is another or one of its
+  ///   descendants.
+  /// \param[in] node The possible descendant.
+  /// \param[in] ancestor The possible ancestor.
+  /// \return Whether or not ancestor appears on the path from node to its
+  ///   root.
+  bool
+  isWithin (unsigned int node, unsigned int ancestor) const;
+
+  /// The transform of each node relative to its parent, along with which
+  ///   nodes are alive and which are dirty.
+  TransformStore m_locals;
+  /// The cached world matrix of each node, 16 floats per node.
+  std::vector<float> m_worldMatrices;
+  /// The parent of each node.
+  std::vector<unsigned int> m_parents;
+  /// The children of each node, in no particular order.
+  std::vector<std::vector<unsigned int>> m_children;
+  /// Every live node, sorted by depth so parents come before their children.
+  std::vector<unsigned int> m_order;
+  /// The position in m_order of the first node at each depth, followed by
+  ///   m_order.size ().
+  std::vector<unsigned int> m_levelStarts;
+  /// The nodes recomputed by each worker during update (), whose dirty flags
+  ///   are cleared once every level is done.
+  std::vector<std::vector<unsigned int>> m_recomputed;
+  /// Whether or not m_order must be rebuilt before it is used.
+  bool m_orderDirty;
+};
+
+#endif//TRANSFORM_HIERARCHY_HPP
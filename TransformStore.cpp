@@ -0,0 +1,413 @@
+/// \file TransformStore.cpp
+/// \brief Definition of TransformStore class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cmath>
+#include <algorithm>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#include "TransformStore.hpp"
+
+namespace
+{
+  /// Multiply by this to convert degrees into radians.
+  const float DEGREES_TO_RADIANS = 3.14159265358979f / 180.0f;
+}
+
+TransformStore::TransformStore ()
+{
+}
+
+TransformStore::~TransformStore ()
+{
+}
+
+unsigned int
+TransformStore::add (const Transform& t)
+{
+  unsigned int index;
+  if (m_free.empty ())
+  {
+    index = m_dirty.size ();
+    for (int c = 0; c < 3; ++c)
+    {
+      m_position[c].push_back (0.0f);
+      m_right[c].push_back (0.0f);
+      m_up[c].push_back (0.0f);
+      m_back[c].push_back (0.0f);
+    }
+    m_dirty.push_back (1);
+    m_alive.push_back (1);
+  }
+  else
+  {
+    index = m_free.back ();
+    m_free.pop_back ();
+    m_alive[index] = 1;
+  }
+  set (index, t);
+  return index;
+}
+
+void
+TransformStore::remove (unsigned int index)
+{
+  set (index, Transform ());
+  m_alive[index] = 0;
+  m_free.push_back (index);
+}
+
+bool
+TransformStore::isAlive (unsigned int index) const
+{
+  return m_alive[index] != 0;
+}
+
+unsigned int
+TransformStore::getCapacity () const
+{
+  return m_dirty.size ();
+}
+
+Transform
+TransformStore::get (unsigned int index) const
+{
+  return Transform (Matrix3 (Vector3 (m_right[0][index], m_right[1][index], m_right[2][index]),
+                             Vector3 (m_up[0][index], m_up[1][index], m_up[2][index]),
+                             Vector3 (m_back[0][index], m_back[1][index], m_back[2][index])),
+                    getPosition (index));
+}
+
+void
+TransformStore::set (unsigned int index, const Transform& t)
+{
+  Vector3 p = t.getPosition ();
+  Vector3 r = t.getRight ();
+  Vector3 u = t.getUp ();
+  Vector3 b = t.getBack ();
+  const Vector3* from[4] = { &p, &r, &u, &b };
+  std::vector<float>* to[4] = { m_position, m_right, m_up, m_back };
+  for (int v = 0; v < 4; ++v)
+  {
+    to[v][0][index] = from[v]->m_x;
+    to[v][1][index] = from[v]->m_y;
+    to[v][2][index] = from[v]->m_z;
+  }
+  m_dirty[index] = 1;
+}
+
+Vector3
+TransformStore::getPosition (unsigned int index) const
+{
+  return Vector3 (m_position[0][index], m_position[1][index],
+                  m_position[2][index]);
+}
+
+void
+TransformStore::moveRight (unsigned int index, float distance)
+{
+  for (int c = 0; c < 3; ++c)
+    m_position[c][index] += distance * m_right[c][index];
+  m_dirty[index] = 1;
+}
+
+void
+TransformStore::moveUp (unsigned int index, float distance)
+{
+  for (int c = 0; c < 3; ++c)
+    m_position[c][index] += distance * m_up[c][index];
+  m_dirty[index] = 1;
+}
+
+void
+TransformStore::moveBack (unsigned int index, float distance)
+{
+  for (int c = 0; c < 3; ++c)
+    m_position[c][index] += distance * m_back[c][index];
+  m_dirty[index] = 1;
+}
+
+void
+TransformStore::pitch (unsigned int index, float angleDegrees)
+{
+  // Rotating about local X mixes the up and back columns.
+  float cosA = std::cos (angleDegrees * DEGREES_TO_RADIANS);
+  float sinA = std::sin (angleDegrees * DEGREES_TO_RADIANS);
+  for (int c = 0; c < 3; ++c)
+  {
+    float u = m_up[c][index];
+    float b = m_back[c][index];
+    m_up[c][index] = cosA * u + sinA * b;
+    m_back[c][index] = cosA * b - sinA * u;
+  }
+  m_dirty[index] = 1;
+}
+
+void
+TransformStore::yaw (unsigned int index, float angleDegrees)
+{
+  // Rotating about local Y mixes the back and right columns.
+  float cosA = std::cos (angleDegrees * DEGREES_TO_RADIANS);
+  float sinA = std::sin (angleDegrees * DEGREES_TO_RADIANS);
+  for (int c = 0; c < 3; ++c)
+  {
+    float b = m_back[c][index];
+    float r = m_right[c][index];
+    m_back[c][index] = cosA * b + sinA * r;
+    m_right[c][index] = cosA * r - sinA * b;
+  }
+  m_dirty[index] = 1;
+}
+
+void
+TransformStore::roll (unsigned int index, float angleDegrees)
+{
+  // Rotating about local Z mixes the right and up columns.
+  float cosA = std::cos (angleDegrees * DEGREES_TO_RADIANS);
+  float sinA = std::sin (angleDegrees * DEGREES_TO_RADIANS);
+  for (int c = 0; c < 3; ++c)
+  {
+    float r = m_right[c][index];
+    float u = m_up[c][index];
+    m_right[c][index] = cosA * r + sinA * u;
+    m_up[c][index] = cosA * u - sinA * r;
+  }
+  m_dirty[index] = 1;
+}
+
+void
+TransformStore::scaleLocal (unsigned int index, float scale)
+{
+  for (int c = 0; c < 3; ++c)
+  {
+    m_right[c][index] *= scale;
+    m_up[c][index] *= scale;
+    m_back[c][index] *= scale;
+  }
+  m_dirty[index] = 1;
+}
+
+void
+TransformStore::moveRightAll (const float* distances, unsigned int first,
+                              unsigned int end)
+{
+  moveAlong (distances, first, std::min (end, getCapacity ()), m_right);
+}
+
+void
+TransformStore::moveUpAll (const float* distances, unsigned int first,
+                           unsigned int end)
+{
+  moveAlong (distances, first, std::min (end, getCapacity ()), m_up);
+}
+
+void
+TransformStore::moveBackAll (const float* distances, unsigned int first,
+                             unsigned int end)
+{
+  moveAlong (distances, first, std::min (end, getCapacity ()), m_back);
+}
+
+void
+TransformStore::pitchAll (const float* anglesDegrees, unsigned int first,
+                          unsigned int end)
+{
+  rotatePairs (anglesDegrees, first, std::min (end, getCapacity ()),
+               m_up, m_back);
+}
+
+void
+TransformStore::yawAll (const float* anglesDegrees, unsigned int first,
+                        unsigned int end)
+{
+  rotatePairs (anglesDegrees, first, std::min (end, getCapacity ()),
+               m_back, m_right);
+}
+
+void
+TransformStore::rollAll (const float* anglesDegrees, unsigned int first,
+                         unsigned int end)
+{
+  rotatePairs (anglesDegrees, first, std::min (end, getCapacity ()),
+               m_right, m_up);
+}
+
+void
+TransformStore::scaleLocalAll (const float* scales, unsigned int first,
+                               unsigned int end)
+{
+  end = std::min (end, getCapacity ());
+  std::vector<float>* columns[3] = { m_right, m_up, m_back };
+  for (std::vector<float>* column : columns)
+  {
+    for (int c = 0; c < 3; ++c)
+    {
+      float* v = column[c].data ();
+      unsigned int i = first;
+#ifdef __SSE__
+      for (; i + 4 <= end; i += 4)
+        _mm_storeu_ps (v + i, _mm_mul_ps (_mm_loadu_ps (v + i),
+                                          _mm_loadu_ps (scales + i)));
+#endif
+      for (; i < end; ++i)
+        v[i] *= scales[i];
+    }
+  }
+  markChanged (scales, first, end, 1.0f);
+}
+
+void
+TransformStore::writeMatrix (unsigned int index, float out[16]) const
+{
+  const std::vector<float>* columns[4] = { m_right, m_up, m_back, m_position };
+  for (int col = 0; col < 4; ++col)
+  {
+    out[4 * col + 0] = columns[col][0][index];
+    out[4 * col + 1] = columns[col][1][index];
+    out[4 * col + 2] = columns[col][2][index];
+    out[4 * col + 3] = (col == 3) ? 1.0f : 0.0f;
+  }
+}
+
+void
+TransformStore::writeMatrices (unsigned int first, unsigned int count,
+                               float* out) const
+{
+  unsigned int end = first + count;
+  unsigned int i = first;
+#ifdef __SSE__
+  // Load one component of four slots at a time, then transpose so that each
+  //   register holds one column of one slot.
+  const std::vector<float>* columns[4] = { m_right, m_up, m_back, m_position };
+  const __m128 zero = _mm_setzero_ps ();
+  const __m128 one = _mm_set1_ps (1.0f);
+  for (; i + 4 <= end; i += 4)
+  {
+    float* dest = out + 16 * (i - first);
+    for (int col = 0; col < 4; ++col)
+    {
+      __m128 x = _mm_loadu_ps (columns[col][0].data () + i);
+      __m128 y = _mm_loadu_ps (columns[col][1].data () + i);
+      __m128 z = _mm_loadu_ps (columns[col][2].data () + i);
+      __m128 w = (col == 3) ? one : zero;
+      _MM_TRANSPOSE4_PS (x, y, z, w);
+      _mm_storeu_ps (dest + 4 * col, x);
+      _mm_storeu_ps (dest + 16 + 4 * col, y);
+      _mm_storeu_ps (dest + 32 + 4 * col, z);
+      _mm_storeu_ps (dest + 48 + 4 * col, w);
+    }
+  }
+#endif
+  for (; i < end; ++i)
+    writeMatrix (i, out + 16 * (i - first));
+}
+
+bool
+TransformStore::isDirty (unsigned int index) const
+{
+  return m_dirty[index] != 0;
+}
+
+void
+TransformStore::markDirty (unsigned int index)
+{
+  m_dirty[index] = 1;
+}
+
+void
+TransformStore::clearDirty ()
+{
+  std::fill (m_dirty.begin (), m_dirty.end (), 0);
+}
+
+void
+TransformStore::clearDirty (unsigned int index)
+{
+  m_dirty[index] = 0;
+}
+
+void
+TransformStore::rotatePairs (const float* anglesDegrees, unsigned int first,
+                             unsigned int end, std::vector<float>* a,
+                             std::vector<float>* b)
+{
+  // Work in blocks small enough for the sines and cosines to live on the
+  //   stack, which keeps this safe to call on disjoint ranges concurrently.
+  const unsigned int BLOCK = 64;
+  float cosines[BLOCK];
+  float sines[BLOCK];
+  for (unsigned int block = first; block < end; block += BLOCK)
+  {
+    unsigned int blockEnd = std::min (end, block + BLOCK);
+    unsigned int n = blockEnd - block;
+    for (unsigned int i = 0; i < n; ++i)
+    {
+      float radians = anglesDegrees[block + i] * DEGREES_TO_RADIANS;
+      cosines[i] = std::cos (radians);
+      sines[i] = std::sin (radians);
+    }
+    for (int c = 0; c < 3; ++c)
+    {
+      float* av = a[c].data () + block;
+      float* bv = b[c].data () + block;
+      unsigned int i = 0;
+#ifdef __SSE__
+      for (; i + 4 <= n; i += 4)
+      {
+        __m128 cosA = _mm_loadu_ps (cosines + i);
+        __m128 sinA = _mm_loadu_ps (sines + i);
+        __m128 x = _mm_loadu_ps (av + i);
+        __m128 y = _mm_loadu_ps (bv + i);
+        _mm_storeu_ps (av + i, _mm_add_ps (_mm_mul_ps (cosA, x),
+                                           _mm_mul_ps (sinA, y)));
+        _mm_storeu_ps (bv + i, _mm_sub_ps (_mm_mul_ps (cosA, y),
+                                           _mm_mul_ps (sinA, x)));
+      }
+#endif
+      for (; i < n; ++i)
+      {
+        float x = av[i];
+        float y = bv[i];
+        av[i] = cosines[i] * x + sines[i] * y;
+        bv[i] = cosines[i] * y - sines[i] * x;
+      }
+    }
+  }
+  markChanged (anglesDegrees, first, end, 0.0f);
+}
+
+void
+TransformStore::moveAlong (const float* distances, unsigned int first,
+                           unsigned int end, const std::vector<float>* axis)
+{
+  for (int c = 0; c < 3; ++c)
+  {
+    float* p = m_position[c].data ();
+    const float* d = axis[c].data ();
+    unsigned int i = first;
+#ifdef __SSE__
+    for (; i + 4 <= end; i += 4)
+    {
+      __m128 step = _mm_mul_ps (_mm_loadu_ps (distances + i),
+                                _mm_loadu_ps (d + i));
+      _mm_storeu_ps (p + i, _mm_add_ps (_mm_loadu_ps (p + i), step));
+    }
+#endif
+    for (; i < end; ++i)
+      p[i] += distances[i] * d[i];
+  }
+  markChanged (distances, first, end, 0.0f);
+}
+
+void
+TransformStore::markChanged (const float* amounts, unsigned int first,
+                             unsigned int end, float identity)
+{
+  for (unsigned int i = first; i < end; ++i)
+    m_dirty[i] |= (amounts[i] != identity);
+}
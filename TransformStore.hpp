@@ -0,0 +1,305 @@
+/// \file TransformStore.hpp
+/// \brief Declaration of TransformStore class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef TRANSFORM_STORE_HPP
+#define TRANSFORM_STORE_HPP
+
+#include <vector>
+
+#include "Transform.hpp"
+#include "Vector3.hpp"
+
+/// \brief The transforms of many objects, kept in parallel arrays (one array
+///   per component) instead of one Transform object per object.
+///
+/// Each slot holds exactly what a Transform holds: a position and a 3x3
+///   orientation/scale matrix whose columns are the right, up, and back
+///   vectors (so scales are folded into the lengths of those columns, and
+///   every Transform operation has the same meaning here).  Keeping each
+///   component in its own array lets the bulk operations, which apply a
+///   different amount to every slot at once, run four slots at a time with
+///   SSE, and lets writeMatrices () stream out every 4x4 matrix in one pass.
+///   The bulk operations and writeMatrices () also take a range of slots, so
+///   that disjoint ranges can be handled by different threads at once.
+///
+/// Every change marks the slots it touched dirty, so that a
+///   TransformHierarchy can tell which world matrices need recomputing.
+class TransformStore
+{
+public:
+
+  /// \brief Constructs an empty TransformStore.
+  TransformStore ();
+
+  /// \brief Destructs a TransformStore.
+  ~TransformStore ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   TransformStores.
+  TransformStore (const TransformStore&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   TransformStores.
+  TransformStore&
+  operator= (const TransformStore&) = delete;
+
+  /// \brief Adds a transform to the store.
+  /// \param[in] t The initial value of the new slot.
+  /// \return The index of the new slot.
+  /// \post The new slot is alive and dirty.
+  unsigned int
+  add (const Transform& t);
+
+  /// \brief Frees a slot so that its index may be handed out again.
+  /// \param[in] index A live slot.
+  /// \post The slot is no longer alive and has been reset to the identity.
+  void
+  remove (unsigned int index);
+
+  /// \brief Tests whether or not a slot is in use.
+  /// \param[in] index A slot index less than getCapacity ().
+  /// \return Whether or not the slot has been added and not removed.
+  bool
+  isAlive (unsigned int index) const;
+
+  /// \brief Gets the number of slots, alive or not.
+  /// \return One more than the largest index handed out so far.  The bulk
+  ///   operations expect arrays of this many amounts.
+  unsigned int
+  getCapacity () const;
+
+  /// \brief Gets the transform in a slot.
+  /// \param[in] index A live slot.
+  /// \return A copy of that slot as a Transform.
+  Transform
+  get (unsigned int index) const;
+
+  /// \brief Replaces the transform in a slot.
+  /// \param[in] index A live slot.
+  /// \param[in] t The new value of the slot.
+  /// \post The slot is dirty.
+  void
+  set (unsigned int index, const Transform& t);
+
+  /// \brief Gets the position in a slot.
+  /// \param[in] index A live slot.
+  /// \return The position of that slot.
+  Vector3
+  getPosition (unsigned int index) const;
+
+  /// \brief Moves one slot along its own right vector.
+  /// \param[in] index A live slot.
+  /// \param[in] distance How far to move.
+  /// \post As Transform::moveRight, and the slot is dirty.
+  void
+  moveRight (unsigned int index, float distance);
+
+  /// \brief Moves one slot along its own up vector.
+  /// \param[in] index A live slot.
+  /// \param[in] distance How far to move.
+  /// \post As Transform::moveUp, and the slot is dirty.
+  void
+  moveUp (unsigned int index, float distance);
+
+  /// \brief Moves one slot along its own back vector.
+  /// \param[in] index A live slot.
+  /// \param[in] distance How far to move.
+  /// \post As Transform::moveBack, and the slot is dirty.
+  void
+  moveBack (unsigned int index, float distance);
+
+  /// \brief Rotates one slot about its local X axis.
+  /// \param[in] index A live slot.
+  /// \param[in] angleDegrees How much to rotate.
+  /// \post As Transform::pitch, and the slot is dirty.
+  void
+  pitch (unsigned int index, float angleDegrees);
+
+  /// \brief Rotates one slot about its local Y axis.
+  /// \param[in] index A live slot.
+  /// \param[in] angleDegrees How much to rotate.
+  /// \post As Transform::yaw, and the slot is dirty.
+  void
+  yaw (unsigned int index, float angleDegrees);
+
+  /// \brief Rotates one slot about its local Z axis.
+  /// \param[in] index A live slot.
+  /// \param[in] angleDegrees How much to rotate.
+  /// \post As Transform::roll, and the slot is dirty.
+  void
+  roll (unsigned int index, float angleDegrees);
+
+  /// \brief Scales one slot locally using a uniform scale.
+  /// \param[in] index A live slot.
+  /// \param[in] scale The scaling factor.
+  /// \post As Transform::scaleLocal, and the slot is dirty.
+  void
+  scaleLocal (unsigned int index, float scale);
+
+  /// \brief Moves every slot along its own right vector.
+  /// \param[in] distances getCapacity () distances, one per slot.
+  /// \param[in] first The first slot to change.
+  /// \param[in] end One past the last slot to change, clamped to
+  ///   getCapacity ().
+  /// \post Each slot has moved by its distance.  Slots with a nonzero
+  ///   distance are dirty.
+  void
+  moveRightAll (const float* distances, unsigned int first = 0,
+                unsigned int end = ~0u);
+
+  /// \brief Moves every slot along its own up vector.
+  /// \param[in] distances getCapacity () distances, one per slot.
+  /// \param[in] first The first slot to change.
+  /// \param[in] end One past the last slot to change, clamped to
+  ///   getCapacity ().
+  /// \post Each slot has moved by its distance.  Slots with a nonzero
+  ///   distance are dirty.
+  void
+  moveUpAll (const float* distances, unsigned int first = 0,
+             unsigned int end = ~0u);
+
+  /// \brief Moves every slot along its own back vector.
+  /// \param[in] distances getCapacity () distances, one per slot.
+  /// \param[in] first The first slot to change.
+  /// \param[in] end One past the last slot to change, clamped to
+  ///   getCapacity ().
+  /// \post Each slot has moved by its distance.  Slots with a nonzero
+  ///   distance are dirty.
+  void
+  moveBackAll (const float* distances, unsigned int first = 0,
+               unsigned int end = ~0u);
+
+  /// \brief Rotates every slot about its own local X axis.
+  /// \param[in] anglesDegrees getCapacity () angles, one per slot.
+  /// \param[in] first The first slot to change.
+  /// \param[in] end One past the last slot to change, clamped to
+  ///   getCapacity ().
+  /// \post Each slot has rotated by its angle.  Slots with a nonzero angle
+  ///   are dirty.
+  void
+  pitchAll (const float* anglesDegrees, unsigned int first = 0,
+            unsigned int end = ~0u);
+
+  /// \brief Rotates every slot about its own local Y axis.
+  /// \param[in] anglesDegrees getCapacity () angles, one per slot.
+  /// \param[in] first The first slot to change.
+  /// \param[in] end One past the last slot to change, clamped to
+  ///   getCapacity ().
+  /// \post Each slot has rotated by its angle.  Slots with a nonzero angle
+  ///   are dirty.
+  void
+  yawAll (const float* anglesDegrees, unsigned int first = 0,
+          unsigned int end = ~0u);
+
+  /// \brief Rotates every slot about its own local Z axis.
+  /// \param[in] anglesDegrees getCapacity () angles, one per slot.
+  /// \param[in] first The first slot to change.
+  /// \param[in] end One past the last slot to change, clamped to
+  ///   getCapacity ().
+  /// \post Each slot has rotated by its angle.  Slots with a nonzero angle
+  ///   are dirty.
+  void
+  rollAll (const float* anglesDegrees, unsigned int first = 0,
+           unsigned int end = ~0u);
+
+  /// \brief Scales every slot locally by a uniform scale.
+  /// \param[in] scales getCapacity () scaling factors, one per slot.
+  /// \param[in] first The first slot to change.
+  /// \param[in] end One past the last slot to change, clamped to
+  ///   getCapacity ().
+  /// \post Each slot has been scaled by its factor.  Slots with a factor
+  ///   other than 1 are dirty.
+  void
+  scaleLocalAll (const float* scales, unsigned int first = 0,
+                 unsigned int end = ~0u);
+
+  /// \brief Writes the matrix of one slot.
+  /// \param[in] index A live slot.
+  /// \param[out] out The column-major 4x4 matrix of that slot.
+  void
+  writeMatrix (unsigned int index, float out[16]) const;
+
+  /// \brief Writes the matrices of a range of slots in one pass.
+  /// \param[in] first The first slot to write.
+  /// \param[in] count How many slots to write.
+  /// \param[out] out Room for count column-major 4x4 matrices, the first of
+  ///   which belongs to slot first.
+  /// \pre first + count <= getCapacity ().
+  void
+  writeMatrices (unsigned int first, unsigned int count, float* out) const;
+
+  /// \brief Tests whether or not a slot has changed since the last
+  ///   clearDirty ().
+  /// \param[in] index A slot index less than getCapacity ().
+  /// \return Whether or not the slot is dirty.
+  bool
+  isDirty (unsigned int index) const;
+
+  /// \brief Marks a slot as changed.
+  /// \param[in] index A slot index less than getCapacity ().
+  /// \post The slot is dirty.
+  void
+  markDirty (unsigned int index);
+
+  /// \brief Forgets which slots have changed.
+  /// \post No slot is dirty.
+  void
+  clearDirty ();
+
+  /// \brief Forgets that one slot has changed.
+  /// \param[in] index A slot index less than getCapacity ().
+  /// \post The slot is not dirty.
+  void
+  clearDirty (unsigned int index);
+
+private:
+
+  /// \brief Rotates a pair of basis columns of every slot by per-slot angles,
+  ///   so that a' = cos * a + sin * b and b' = cos * b - sin * a.
+  /// \param[in] anglesDegrees getCapacity () angles, one per slot.
+  /// \param[in] first The first slot to change.
+  /// \param[in] end One past the last slot to change.
+  /// \param[inout] a The three component arrays of the first column.
+  /// \param[inout] b The three component arrays of the second column.
+  void
+  rotatePairs (const float* anglesDegrees, unsigned int first,
+               unsigned int end, std::vector<float>* a, std::vector<float>* b);
+
+  /// \brief Moves every slot along one of its basis columns.
+  /// \param[in] distances getCapacity () distances, one per slot.
+  /// \param[in] first The first slot to move.
+  /// \param[in] end One past the last slot to move.
+  /// \param[in] axis The three component arrays of that column.
+  void
+  moveAlong (const float* distances, unsigned int first, unsigned int end,
+             const std::vector<float>* axis);
+
+  /// \brief Marks every slot whose amount differs from a no-op value dirty.
+  /// \param[in] amounts getCapacity () amounts, one per slot.
+  /// \param[in] first The first slot to check.
+  /// \param[in] end One past the last slot to check.
+  /// \param[in] identity The amount that does not change a slot.
+  void
+  markChanged (const float* amounts, unsigned int first, unsigned int end,
+               float identity);
+
+  /// The x, y, and z components of each slot's position.
+  std::vector<float> m_position[3];
+  /// The x, y, and z components of each slot's right vector.
+  std::vector<float> m_right[3];
+  /// The x, y, and z components of each slot's up vector.
+  std::vector<float> m_up[3];
+  /// The x, y, and z components of each slot's back vector.
+  std::vector<float> m_back[3];
+  /// Whether or not each slot has changed since the last clearDirty ().
+  std::vector<unsigned char> m_dirty;
+  /// Whether or not each slot is in use.
+  std::vector<unsigned char> m_alive;
+  /// Indices of removed slots, which can be handed out again.
+  std::vector<unsigned int> m_free;
+};
+
+#endif//TRANSFORM_STORE_HPP
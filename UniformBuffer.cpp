@@ -0,0 +1,64 @@
+/// \file UniformBuffer.cpp
+/// \brief Definition of UniformBuffer class and any associated global
+///   functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#include <cstring>
+
+#include "UniformBuffer.hpp"
+
+UniformBuffer::UniformBuffer (OpenGLContext* context, std::size_t size,
+                              GLuint binding)
+  : m_context (context), m_buffer (0), m_binding (binding),
+    m_contents (size), m_uploaded (false)
+{
+  m_context->createBuffers (1, &m_buffer);
+  m_context->namedBufferStorage (m_buffer, size, nullptr, GL_DYNAMIC_STORAGE_BIT);
+  bind ();
+}
+
+UniformBuffer::~UniformBuffer ()
+{
+  m_context->deleteBuffers (1, &m_buffer);
+}
+
+bool
+UniformBuffer::update (const void* data)
+{
+  const unsigned char* bytes = static_cast<const unsigned char*> (data);
+  std::size_t first = 0;
+  std::size_t last = m_contents.size ();
+  if (m_uploaded)
+  {
+    // Only send the range that changed.
+    while (first < last && m_contents[first] == bytes[first])
+      ++first;
+    while (last > first && m_contents[last - 1] == bytes[last - 1])
+      --last;
+    if (first == last)
+      return false;
+  }
+  std::memcpy (m_contents.data () + first, bytes + first, last - first);
+  m_uploaded = true;
+  m_context->namedBufferSubData (m_buffer, first, last - first, bytes + first);
+  return true;
+}
+
+void
+UniformBuffer::bind () const
+{
+  m_context->bindBufferBase (GL_UNIFORM_BUFFER, m_binding, m_buffer);
+}
+
+GLuint
+UniformBuffer::getId () const
+{
+  return m_buffer;
+}
+
+GLuint
+UniformBuffer::getBinding () const
+{
+  return m_binding;
+}
@@ -0,0 +1,221 @@
+/// \file UniformBuffer.hpp
+/// \brief Declaration of UniformBuffer class, the std140 uniform blocks that
+///   every shader program shares, and any associated global functions.
+/// \author Ryan Ganzke
+/// \version A09
+
+#ifndef UNIFORM_BUFFER_HPP
+#define UNIFORM_BUFFER_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "OpenGLContext.hpp"
+
+/// The largest number of lights the shaders support.
+const unsigned int MAX_LIGHTS = 8;
+
+/// The binding point of the CameraBlock uniform block in every program.
+const GLuint CAMERA_BLOCK_BINDING = 0;
+
+/// The binding point of the LightBlock uniform block in every program.
+const GLuint LIGHT_BLOCK_BINDING = 1;
+
+/// The largest number of materials in a MaterialTable.  256 entries of 64
+///   bytes is the smallest uniform block size OpenGL guarantees.
+const unsigned int MAX_MATERIALS = 256;
+
+/// The binding point of the MaterialBlock uniform block in every program.
+const GLuint MATERIAL_BLOCK_BINDING = 2;
+
+/// The binding point of the ClusterBlock uniform block in every program.
+const GLuint CLUSTER_BLOCK_BINDING = 3;
+
+/// \brief A CPU copy of the shaders' CameraBlock, laid out by the std140
+///   rules (each vec3 starts on a 16-byte boundary).
+struct CameraBlock
+{
+  /// The view matrix, column-major (uView).
+  float view[16];
+  /// The projection matrix, column-major (uProjection).
+  float projection[16];
+  /// The camera's position, in world space (uEyePosition).
+  float eyePosition[3];
+  /// Unused.
+  float pad0;
+  /// The intensity of the scene's ambient light (uAmbientIntensity).
+  float ambientIntensity[3];
+  /// Unused.
+  float pad1;
+};
+
+/// \brief A CPU copy of one element of the shaders' uLights array, laid out
+///   by the std140 rules.  Not every type of light uses every member.
+struct LightBlockEntry
+{
+  /// The diffuse intensity of the light.
+  float diffuseIntensity[3];
+  /// 0 if directional, 1 if point, 2 if spot (see LightType).
+  GLint type;
+  /// The specular intensity of the light.
+  float specularIntensity[3];
+  /// The cosine of a spot light's cutoff angle.
+  float cutoffCosAngle;
+  /// The position of a point or spot light, in eye space.
+  float position[3];
+  /// A spot light's falloff exponent.
+  float falloff;
+  /// The constant, linear, and quadratic attenuation of a point or spot
+  ///   light.
+  float attenuationCoefficients[3];
+  /// Unused.
+  float pad0;
+  /// The unit direction of a directional or spot light, in eye space.
+  float direction[3];
+  /// Unused.
+  float pad1;
+};
+
+/// \brief A CPU copy of the shaders' LightBlock.
+struct LightBlock
+{
+  /// The lights (uLights).
+  LightBlockEntry lights[MAX_LIGHTS];
+  /// The number of lights in use (uNumLights).
+  GLint numLights;
+  /// Unused.
+  GLint pad[3];
+};
+
+/// \brief A CPU copy of one element of the shaders' uMaterials array, laid
+///   out by the std140 rules.
+struct MaterialBlockEntry
+{
+  /// The ambient reflection of the material.
+  float ambientReflection[3];
+  /// The specular power (shininess) of the material.
+  float specularPower;
+  /// The diffuse reflection of the material.
+  float diffuseReflection[3];
+  /// Unused.
+  float pad0;
+  /// The specular reflection of the material.
+  float specularReflection[3];
+  /// Unused.
+  float pad1;
+  /// The light emitted by the material.
+  float emissiveIntensity[3];
+  /// Unused.
+  float pad2;
+};
+
+/// \brief A CPU copy of the shaders' MaterialBlock.
+struct MaterialBlock
+{
+  /// The materials (uMaterials), indexed by uMaterialIndex.
+  MaterialBlockEntry materials[MAX_MATERIALS];
+};
+
+/// \brief A CPU copy of the shaders' ClusterBlock, which describes the grid
+///   that LightClusters divides the view frustum into.
+struct ClusterBlock
+{
+  /// The number of clusters across, down, and deep (uClusterGridSize).
+  GLuint gridSize[3];
+  /// Multiplies the log of an eye-space depth to get its slice
+  ///   (uClusterSliceScale).
+  float sliceScale;
+  /// Added to the scaled log depth to get its slice (uClusterSliceBias).
+  float sliceBias;
+  /// Unused.
+  float pad[3];
+};
+
+static_assert (offsetof (CameraBlock, eyePosition) == 128
+               && offsetof (CameraBlock, ambientIntensity) == 144
+               && sizeof (CameraBlock) == 160,
+               "CameraBlock does not match the std140 layout");
+static_assert (offsetof (LightBlockEntry, specularIntensity) == 16
+               && offsetof (LightBlockEntry, position) == 32
+               && offsetof (LightBlockEntry, attenuationCoefficients) == 48
+               && offsetof (LightBlockEntry, direction) == 64
+               && sizeof (LightBlockEntry) == 80,
+               "LightBlockEntry does not match the std140 layout");
+static_assert (offsetof (LightBlock, numLights) == 80 * MAX_LIGHTS,
+               "LightBlock does not match the std140 layout");
+static_assert (offsetof (MaterialBlockEntry, diffuseReflection) == 16
+               && offsetof (MaterialBlockEntry, specularReflection) == 32
+               && offsetof (MaterialBlockEntry, emissiveIntensity) == 48
+               && sizeof (MaterialBlockEntry) == 64,
+               "MaterialBlockEntry does not match the std140 layout");
+static_assert (offsetof (ClusterBlock, sliceScale) == 12
+               && offsetof (ClusterBlock, sliceBias) == 16
+               && sizeof (ClusterBlock) == 32,
+               "ClusterBlock does not match the std140 layout");
+
+/// \brief An OpenGL uniform buffer that belongs to one binding point, so
+///   that every program whose uniform block is bound to that point (see
+///   ShaderProgram::bindUniformBlock) reads from it once bind () is called.
+///
+/// The buffer keeps a copy of what it last uploaded, and update () sends only
+///   the range of bytes that changed, or nothing at all.
+class UniformBuffer
+{
+public:
+
+  /// \brief Constructs a UniformBuffer and binds it.
+  /// \param[in] context The context to make OpenGL calls through.
+  /// \param[in] size The size of the block, in bytes.
+  /// \param[in] binding The binding point to attach the buffer to.
+  /// \post The buffer's contents are undefined until the first update ().
+  UniformBuffer (OpenGLContext* context, std::size_t size, GLuint binding);
+
+  /// \brief Destructs a UniformBuffer, deleting its OpenGL buffer.
+  ~UniformBuffer ();
+
+  /// \brief Copy constructor removed because you shouldn't be copying
+  ///   UniformBuffers.
+  UniformBuffer (const UniformBuffer&) = delete;
+
+  /// \brief Assignment operator removed because you shouldn't be assigning
+  ///   UniformBuffers.
+  UniformBuffer&
+  operator= (const UniformBuffer&) = delete;
+
+  /// \brief Replaces the contents of the buffer.
+  /// \param[in] data The new contents, which must be the size given to the
+  ///   constructor.
+  /// \return Whether or not anything was uploaded.
+  bool
+  update (const void* data);
+
+  /// \brief Binds the buffer to its binding point, in case something else
+  ///   was bound there since the last call.
+  void
+  bind () const;
+
+  /// \brief Gets the OpenGL name of the buffer.
+  /// \return The buffer object's identifier.
+  GLuint
+  getId () const;
+
+  /// \brief Gets the binding point the buffer is attached to.
+  /// \return The binding point.
+  GLuint
+  getBinding () const;
+
+private:
+
+  /// The context to make OpenGL calls through.
+  OpenGLContext* m_context;
+  /// The OpenGL identifier of the buffer.
+  GLuint m_buffer;
+  /// The binding point the buffer is attached to.
+  GLuint m_binding;
+  /// The contents last uploaded.
+  std::vector<unsigned char> m_contents;
+  /// Whether or not m_contents has been uploaded yet.
+  bool m_uploaded;
+};
+
+#endif//UNIFORM_BUFFER_HPP
@@ -12,46 +12,60 @@
 // By default, all float variables will use high precision.
 precision highp float;
 
-// The C++ code will tell us how many light sources there are (maximum 8).
-uniform int uNumLights;
-
 // Information about one light source.
 // Because different light sources store different information, not every type
 //   will use every data member.
+// Members are ordered so that the std140 layout matches LightBlockEntry in
+//   UniformBuffer.hpp.
 struct Light
 {
-  // 0 if directional, 1 if point, 2 if spot -- other values illegal.
-  int type;
-
   // All lights have these parameters.
   vec3 diffuseIntensity;
+  // 0 if directional, 1 if point, 2 if spot -- other values illegal.
+  int type;
   vec3 specularIntensity;
 
-  // Point and spot light parameters.
+  // Spot light parameter.
+  float cutoffCosAngle;
+
+  // Point and spot light parameters, in eye space.
   vec3 position;
+  // Spot light parameter.
+  float falloff;
   vec3 attenuationCoefficients;
 
-  // Directional and spot light parameter.
+  // Directional and spot light parameter, a unit vector in eye space.
   vec3 direction;
-
-  // Spot light parameters.
-  float cutoffCosAngle;
-  float falloff;
 };
 
-// An array of lights that will be filled by the C++ code.
+// The lights, written once per frame by the C++ code and shared by every
+//   program (see LightBlock in UniformBuffer.hpp).
 const int MAX_LIGHTS = 8;
-uniform Light uLights[MAX_LIGHTS];
-
-// Single ambient light, provided by the C++ code.
-uniform vec3  uAmbientIntensity;
+layout (std140) uniform LightBlock
+{
+  Light uLights[MAX_LIGHTS];
+  // How many of uLights are in use.
+  int uNumLights;
+};
 
-// Material properties, provided by the C++ code.
-uniform vec3  uAmbientReflection;
-uniform vec3  uDiffuseReflection;
-uniform vec3  uSpecularReflection;
-uniform float uSpecularPower;
-uniform vec3  uEmissiveIntensity;
+// Material properties, shared by every program (see MaterialBlock in
+//   UniformBuffer.hpp).  Members are ordered to match the std140 layout of
+//   MaterialBlockEntry.
+struct Material
+{
+  vec3 ambientReflection;
+  float specularPower;
+  vec3 diffuseReflection;
+  vec3 specularReflection;
+  vec3 emissiveIntensity;
+};
+const int MAX_MATERIALS = 256;
+layout (std140) uniform MaterialBlock
+{
+  Material uMaterials[MAX_MATERIALS];
+};
+// Which of uMaterials to draw with, provided by the C++ code.
+uniform int uMaterialIndex;
 
 // Inputs from the VBO.
 in vec3 aPosition;
@@ -60,13 +74,26 @@ layout(location = 2) in vec3 aNormal;
 // Output to the fragment shader.
 out vec3 vColor;
 
-// Transformation matrices, provided by C++ code.
-uniform mat4 uView;
-uniform mat4 uProjection;
-uniform mat4 uWorld;
+// The camera, written once per frame by the C++ code and shared by every
+//   program (see CameraBlock in UniformBuffer.hpp).
+layout (std140) uniform CameraBlock
+{
+  // Transformation from world space to eye space.
+  mat4 uView;
+  // Transformation from eye space to clip space.
+  mat4 uProjection;
+  // Eye position, in world space.
+  vec3 uEyePosition;
+  // Single ambient light.
+  vec3 uAmbientIntensity;
+};
 
-// Eye position, in world space, provided by C++ code.
-uniform vec3 uEyePosition;
+// Transformations computed once per draw by the C++ code: local space to
+//   eye space, local space to clip space, and the inverse transpose of the
+//   first (for normals).
+uniform mat4 uModelView;
+uniform mat4 uModelViewProjection;
+uniform mat3 uNormalMatrix;
 
 // **
 
@@ -79,22 +106,16 @@ calculateLighting (Light light, vec3 vertexPosition, vec3 vertexNormal);
 void
 main (void)
 {
-  mat4 worldViewProjection = uProjection * uView * uWorld;
   // Transform vertex into clip space
-  gl_Position = worldViewProjection * vec4 (aPosition, 1);
+  gl_Position = uModelViewProjection * vec4 (aPosition, 1);
   // Transform vertex into eye space for lighting
-  vec3 positionEye = vec3 (uView * uWorld * vec4 (aPosition, 1));
-
-  // Do calculation in eye space.
-  mat3 normalTransform = mat3 (uView * uWorld);
-  normalTransform = transpose (inverse (normalTransform));
-  // Normal matrix is eye inverse transpose
-  vec3 normalEye = normalize (normalTransform * aNormal);
+  vec3 positionEye = vec3 (uModelView * vec4 (aPosition, 1));
+  vec3 normalEye = normalize (uNormalMatrix * aNormal);
 
   // Handle ambient and emissive light
   //   It's independent of any particular light
-  vColor = uAmbientReflection * uAmbientIntensity
-      + uEmissiveIntensity;
+  vColor = uMaterials[uMaterialIndex].ambientReflection * uAmbientIntensity
+      + uMaterials[uMaterialIndex].emissiveIntensity;
   // Iterate over all lights and calculate diffuse and specular contributions
   for (int i = 0; i < uNumLights; ++i)
   {
@@ -111,8 +132,6 @@ main (void)
 vec3
 calculateLighting (Light light, vec3 vertexPosition, vec3 vertexNormal)
 {
-  light.direction = vec3(transpose (inverse (uView)) * vec4(light.direction, 1));
-  light.position = vec3(uView * vec4( light.position, 1));
   // Light vector points toward the light
   vec3 lightVector;
   if (light.type == 0)
@@ -130,19 +149,19 @@ calculateLighting (Light light, vec3 vertexPosition, vec3 vertexNormal)
   if (lambertianCoef > 0.0)
   {
     // Light is incident on vertex, not shining on its edge or back
-    vec3 diffuseColor = uDiffuseReflection * light.diffuseIntensity;
+    vec3 diffuseColor = uMaterials[uMaterialIndex].diffuseReflection * light.diffuseIntensity;
     diffuseColor *= lambertianCoef;
 
-    vec3 specularColor = uSpecularReflection * light.specularIntensity;
+    vec3 specularColor = uMaterials[uMaterialIndex].specularReflection * light.specularIntensity;
     // See how light reflects off of vertex
     vec3 reflectionVector = reflect (-lightVector, vertexNormal);
     // Compute view vector, which points toward the eye
-    vec3 eyeVector = normalize (uEyePosition - vertexPosition);
+    vec3 eyeVector = normalize (-vertexPosition);
     // Light intensity is proportional to angle between reflection vector
     //   and eye vector
     float specularCoef = max (dot (eyeVector, reflectionVector), 0.0);
     // Material's specular power determines size of bright spots
-    specularColor *= pow (specularCoef, uSpecularPower);
+    specularColor *= pow (specularCoef, uMaterials[uMaterialIndex].specularPower);
 
     float attenuation = 1.0;
     if (light.type != 0)
@@ -8,62 +8,117 @@
     space coordinates.
 */
 
-// The C++ code will tell us how many light sources there are (maximum 8).
-uniform int uNumLights;
-
 // Information about one light source.
 // Because different light sources store different information, not every type
 //   will use every data member.
+// Members are ordered so that the std140 layout matches LightBlockEntry in
+//   UniformBuffer.hpp.
 struct Light
 {
-  // 0 if directional, 1 if point, 2 if spot -- other values illegal.
-  int type;
-
   // All lights have these parameters.
   vec3 diffuseIntensity;
+  // 0 if directional, 1 if point, 2 if spot -- other values illegal.
+  int type;
   vec3 specularIntensity;
 
-  // Point and spot light parameters.
+  // Spot light parameter.
+  float cutoffCosAngle;
+
+  // Point and spot light parameters, in eye space.
   vec3 position;
+  // Spot light parameter.
+  float falloff;
   vec3 attenuationCoefficients;
 
-  // Directional and spot light parameter.
+  // Directional and spot light parameter, a unit vector in eye space.
   vec3 direction;
-
-  // Spot light parameters.
-  float cutoffCosAngle;
-  float falloff;
 };
 
-// An array of lights that will be filled by the C++ code.
+// The lights, written once per frame by the C++ code and shared by every
+//   program (see LightBlock in UniformBuffer.hpp).
 const int MAX_LIGHTS = 8;
-uniform Light uLights[MAX_LIGHTS];
+layout (std140) uniform LightBlock
+{
+  Light uLights[MAX_LIGHTS];
+  // How many of uLights are in use.
+  int uNumLights;
+};
 
-// Single ambient light, provided by the C++ code.
-uniform vec3  uAmbientIntensity;
+// Material properties, shared by every program (see MaterialBlock in
+//   UniformBuffer.hpp).  Members are ordered to match the std140 layout of
+//   MaterialBlockEntry.
+struct Material
+{
+  vec3 ambientReflection;
+  float specularPower;
+  vec3 diffuseReflection;
+  vec3 specularReflection;
+  vec3 emissiveIntensity;
+};
+const int MAX_MATERIALS = 256;
+layout (std140) uniform MaterialBlock
+{
+  Material uMaterials[MAX_MATERIALS];
+};
+// Which of uMaterials to draw with, provided by the C++ code.
+uniform int uMaterialIndex;
+// Which of uMaterials this fragment is lit with: uMaterialIndex, or the one
+//   the G-buffer holds for this pixel.
+int materialIndex;
 
-// Material properties, provided by the C++ code.
-uniform vec3  uAmbientReflection;
-uniform vec3  uDiffuseReflection;
-uniform vec3  uSpecularReflection;
-uniform float uSpecularPower;
-uniform vec3  uEmissiveIntensity;
+// The camera, written once per frame by the C++ code and shared by every
+//   program (see CameraBlock in UniformBuffer.hpp).
+layout (std140) uniform CameraBlock
+{
+  // Transformation from world space to eye space.
+  mat4 uView;
+  // Transformation from eye space to clip space.
+  mat4 uProjection;
+  // Eye position, in world space.
+  vec3 uEyePosition;
+  // Single ambient light.
+  vec3 uAmbientIntensity;
+};
 
-// Transformation matrices, provided by C++ code.
-uniform mat4 uView;
-uniform mat4 uProjection;
-uniform mat4 uWorld;
+#ifdef CLUSTERED_LIGHTING
+// The grid that the point and spot lights were culled into on the CPU (see
+//   LightClusters.hpp).
+layout (std140) uniform ClusterBlock
+{
+  // The number of clusters across, down, and deep.
+  uvec3 uClusterGridSize;
+  // Turn the log of an eye-space depth into a slice.
+  float uClusterSliceScale;
+  float uClusterSliceBias;
+};
+// The first index and light count of each cluster.
+uniform usamplerBuffer uClusterGrid;
+// Every cluster's list of indices into uClusterLights.
+uniform usamplerBuffer uClusterLightIndices;
+// The point and spot lights, five texels each, laid out like Light.
+uniform samplerBuffer uClusterLights;
+#endif
 
-// Eye posiiton, in world space, provided by C++ code.
-uniform vec3 uEyePosition;
+#ifdef DEFERRED_LIGHTING
+// The G-buffer written by the GBUFFER_PASS variant (see GBuffer.hpp): ambient
+//   and emissive color; eye-space normal and material index; and depth.
+uniform sampler2D uGBufferColor;
+uniform sampler2D uGBufferNormal;
+uniform sampler2D uGBufferDepth;
+#endif
 
 in vec3 vColor;
+// The fragment's position and normal, in eye space.
 in vec3 vPosition;
 in vec3 vNormal;
 
 // Second, the outputs the shader produces
 // We output a color with an alpha channel (R, G, B, A)
-out vec4 fColor;
+layout (location = 0) out vec4 fColor;
+#ifdef GBUFFER_PASS
+// The eye-space normal, and the material index in w.
+layout (location = 1) out vec4 fNormal;
+#endif
 
 /*********************************************************/
 
@@ -71,20 +126,89 @@ out vec4 fColor;
 vec3
 calculateLighting (Light light, vec3 vertexPosition, vec3 vertexNormal);
 
+// Calculate lighting for a directional light.
+vec3
+calculateDirectional (Light light, vec3 vertexPosition, vec3 vertexNormal);
+
+// Calculate lighting for a point light.
+vec3
+calculatePoint (Light light, vec3 vertexPosition, vec3 vertexNormal);
+
+// Calculate lighting for a spot light.
+vec3
+calculateSpot (Light light, vec3 vertexPosition, vec3 vertexNormal);
+
+#ifdef CLUSTERED_LIGHTING
+// Calculate lighting for every point and spot light in this fragment's
+//   cluster.
+vec3
+calculateClustered (vec3 vertexPosition, vec3 vertexNormal);
+#endif
+
+#ifdef DEFERRED_LIGHTING
+// Recover an eye-space position from its window coordinates and depth.
+vec3
+reconstructPosition (vec2 windowPosition, float depth);
+#endif
+
 // **
 
 void
 main ()
 {
+#ifdef GBUFFER_PASS
+  // The geometry pass of deferred shading only stores what the lighting
+  //   pass needs.
   fColor = vec4 (vColor, 1);
-  for (int i = 0; i < uNumLights; ++i)
+  fNormal = vec4 (vNormal, float (uMaterialIndex));
+  return;
+#endif
+
+#ifdef DEFERRED_LIGHTING
+  ivec2 pixel = ivec2 (gl_FragCoord.xy);
+  float depth = texelFetch (uGBufferDepth, pixel, 0).r;
+  if (depth == 1.0)
   {
-    fColor
-        += vec4 (calculateLighting (uLights[i], vPosition, vNormal), 1);
+    // Nothing was drawn here.
+    discard;
   }
+  // Keep the depth, so forward-drawn Meshes are hidden behind this one.
+  gl_FragDepth = depth;
+  vec4 stored = texelFetch (uGBufferNormal, pixel, 0);
+  vec3 normal = stored.xyz;
+  materialIndex = int (stored.w + 0.5);
+  vec3 position = reconstructPosition (gl_FragCoord.xy, depth);
+  vec3 color = texelFetch (uGBufferColor, pixel, 0).rgb;
+#else
+  vec3 normal = vNormal;
+  materialIndex = uMaterialIndex;
+  vec3 position = vPosition;
+  vec3 color = vColor;
+#endif
+
+#if defined (CLUSTERED_LIGHTING)
+  // Directional lights reach everything, so they stay in the light block.
+  for (int i = 0; i < NUM_DIRECTIONAL_LIGHTS; ++i)
+    color += calculateDirectional (uLights[i], position, normal);
+  color += calculateClustered (position, normal);
+#elif defined (NUM_DIRECTIONAL_LIGHTS) && defined (NUM_POINT_LIGHTS) && defined (NUM_SPOT_LIGHTS)
+  // Specialized for the Scene's lights, which it groups by type, so each
+  //   loop has a constant count and no light's type is tested.
+  for (int i = 0; i < NUM_DIRECTIONAL_LIGHTS; ++i)
+    color += calculateDirectional (uLights[i], position, normal);
+  for (int i = 0; i < NUM_POINT_LIGHTS; ++i)
+    color += calculatePoint (uLights[NUM_DIRECTIONAL_LIGHTS + i], position,
+        normal);
+  for (int i = 0; i < NUM_SPOT_LIGHTS; ++i)
+    color += calculateSpot (uLights[NUM_DIRECTIONAL_LIGHTS + NUM_POINT_LIGHTS + i],
+        position, normal);
+#else
+  for (int i = 0; i < uNumLights; ++i)
+    color += calculateLighting (uLights[i], position, normal);
+#endif
 
   // Stay in bounds [0, 1]
-  fColor = clamp (fColor, 0.0, 1.0);
+  fColor = clamp (vec4 (color, 1), 0.0, 1.0);
 }
 
 // **
@@ -92,57 +216,159 @@ main ()
 vec3
 calculateLighting (Light light, vec3 vertexPosition, vec3 vertexNormal)
 {
-  // Light vector points toward the light
-  vec3 lightVector;
   if (light.type == 0)
-  { // Directional
-    lightVector = vec3 (normalize (transpose (inverse (uView)) * vec4 (-light.direction, 1)));
-  }
+    return calculateDirectional (light, vertexPosition, vertexNormal);
+  else if (light.type == 1)
+    return calculatePoint (light, vertexPosition, vertexNormal);
   else
-  { // Point or spot
-    lightVector = vec3 (normalize (transpose (inverse (uView)) * vec4 (light.position - vertexPosition, 1)));
-  }
+    return calculateSpot (light, vertexPosition, vertexNormal);
+}
+
+// **
+
+// Calculate the diffuse and specular light reflected toward the eye.
+// lightVector points toward the light.
+vec3
+calculateDiffuseAndSpecular (Light light, vec3 lightVector, vec3 vertexPosition,
+    vec3 vertexNormal)
+{
   // Light intensity is proportional to angle between light vector
   //   and vertex normal
   float lambertianCoef = max (dot (lightVector, vertexNormal), 0.0);
-  vec3 diffuseAndSpecular = vec3 (0.0);
+  if (lambertianCoef <= 0.0)
+  {
+    // Light is shining on the vertex's edge or back
+    return vec3 (0.0);
+  }
+  vec3 diffuseColor = uMaterials[materialIndex].diffuseReflection * light.diffuseIntensity;
+  diffuseColor *= lambertianCoef;
+
+  vec3 specularColor = uMaterials[materialIndex].specularReflection * light.specularIntensity;
+  // See how light reflects off of vertex
+  vec3 reflectionVector = reflect (-lightVector, vertexNormal);
+  // Compute view vector, which points toward the eye (the origin of eye
+  //   space)
+  vec3 eyeVector = normalize (-vertexPosition);
+  // Light intensity is proportional to angle between reflection vector
+  //   and eye vector
+  float specularCoef = max (dot (eyeVector, reflectionVector), 0.0);
+  // Material's specular power determines size of bright spots
+  specularColor *= pow (specularCoef, uMaterials[materialIndex].specularPower);
 
-  if (lambertianCoef > 0.0)
+  return diffuseColor + specularColor;
+}
+
+// **
+
+// Calculate how much a point or spot light has faded at a vertex.
+float
+calculateAttenuation (Light light, vec3 vertexPosition)
+{
+  float distance = length (light.position - vertexPosition);
+  return 1.0 / (light.attenuationCoefficients.x
+      + light.attenuationCoefficients.y * distance
+      + light.attenuationCoefficients.z * distance * distance);
+}
+
+// **
+
+vec3
+calculateDirectional (Light light, vec3 vertexPosition, vec3 vertexNormal)
+{
+  vec3 lightVector = -light.direction;
+  return calculateDiffuseAndSpecular (light, lightVector, vertexPosition,
+      vertexNormal);
+}
+
+// **
+
+vec3
+calculatePoint (Light light, vec3 vertexPosition, vec3 vertexNormal)
+{
+  vec3 lightVector = normalize (light.position - vertexPosition);
+  return calculateAttenuation (light, vertexPosition)
+      * calculateDiffuseAndSpecular (light, lightVector, vertexPosition,
+          vertexNormal);
+}
+
+// **
+
+vec3
+calculateSpot (Light light, vec3 vertexPosition, vec3 vertexNormal)
+{
+  vec3 lightVector = normalize (light.position - vertexPosition);
+  float cosTheta = dot (-lightVector, light.direction);
+  cosTheta = max (cosTheta, 0.0f);
+  float spotFactor = (cosTheta >= light.cutoffCosAngle) ? cosTheta : 0.0f;
+  spotFactor = pow (spotFactor, light.falloff);
+  return spotFactor * calculateAttenuation (light, vertexPosition)
+      * calculateDiffuseAndSpecular (light, lightVector, vertexPosition,
+          vertexNormal);
+}
+
+// **
+
+#ifdef CLUSTERED_LIGHTING
+vec3
+calculateClustered (vec3 vertexPosition, vec3 vertexNormal)
+{
+  // Find the cluster from the fragment's normalized device coordinates and
+  //   its depth, the same way LightClusters divided the frustum.
+  vec4 clip = uProjection * vec4 (vertexPosition, 1);
+  vec2 ndc = clip.xy / clip.w;
+  ivec3 size = ivec3 (uClusterGridSize);
+  ivec2 tile = clamp (ivec2 ((ndc * 0.5 + 0.5) * vec2 (size.xy)), ivec2 (0),
+      size.xy - 1);
+  float depth = max (-vertexPosition.z, 1e-4);
+  int slice = clamp (int (log (depth) * uClusterSliceScale + uClusterSliceBias),
+      0, size.z - 1);
+  int cluster = tile.x + size.x * (tile.y + size.y * slice);
+
+  uvec2 range = texelFetch (uClusterGrid, cluster).xy;
+  vec3 color = vec3 (0.0);
+  for (uint i = 0u; i < range.y; ++i)
   {
-    // Light is incident on vertex, not shining on its edge or back
-    vec3 diffuseColor = uDiffuseReflection * light.diffuseIntensity;
-    diffuseColor *= lambertianCoef;
-
-    vec3 specularColor = uSpecularReflection * light.specularIntensity;
-    // See how light reflects off of vertex
-    vec3 reflectionVector = reflect (-lightVector, vertexNormal);
-    // Compute view vector, which points toward the eye
-    vec3 eyeVector = normalize (uEyePosition - vertexPosition);
-    // Light intensity is proportional to angle between reflection vector
-    //   and eye vector
-    float specularCoef = max (dot (eyeVector, reflectionVector), 0.0);
-    // Material's specular power determines size of bright spots
-    specularColor *= pow (specularCoef, uSpecularPower);
-
-    float attenuation = 1.0;
-    if (light.type != 0)
-    { // Non-directional, so light attenuates
-      float distance = length (vec3 (vec4 (vertexPosition, 1) - transpose (inverse (uView)) * vec4 (light.position, 1)));
-      attenuation = 1.0 / (light.attenuationCoefficients.x
-          + light.attenuationCoefficients.y * distance
-          + light.attenuationCoefficients.z * distance * distance);
-    }
-    float spotFactor = 1.0f;
-    if (light.type == 2)
-    { // Spot light
-      float cosTheta = dot (-lightVector, vec3 (transpose (inverse (uView)) * vec4 (light.direction, 1)));
-      cosTheta = max (cosTheta, 0.0f);
-      spotFactor = (cosTheta >= light.cutoffCosAngle) ? cosTheta : 0.0f;
-      spotFactor = pow (spotFactor, light.falloff);
-    }
-    diffuseAndSpecular = spotFactor * attenuation * (diffuseColor
-        + specularColor);
+    int base = 5 * int (texelFetch (uClusterLightIndices, int (range.x + i)).x);
+    vec4 texel0 = texelFetch (uClusterLights, base);
+    vec4 texel1 = texelFetch (uClusterLights, base + 1);
+    vec4 texel2 = texelFetch (uClusterLights, base + 2);
+    vec4 texel3 = texelFetch (uClusterLights, base + 3);
+    vec4 texel4 = texelFetch (uClusterLights, base + 4);
+    Light light;
+    light.diffuseIntensity = texel0.xyz;
+    light.type = floatBitsToInt (texel0.w);
+    light.specularIntensity = texel1.xyz;
+    light.cutoffCosAngle = texel1.w;
+    light.position = texel2.xyz;
+    light.falloff = texel2.w;
+    light.attenuationCoefficients = texel3.xyz;
+    light.direction = texel4.xyz;
+    if (light.type == 1)
+      color += calculatePoint (light, vertexPosition, vertexNormal);
+    else
+      color += calculateSpot (light, vertexPosition, vertexNormal);
   }
+  return color;
+}
+#endif
 
-  return diffuseAndSpecular;
-}
\ No newline at end of file
+// **
+
+#ifdef DEFERRED_LIGHTING
+vec3
+reconstructPosition (vec2 windowPosition, float depth)
+{
+  // Undo the viewport and depth range transformations...
+  vec2 ndcXY = windowPosition / vec2 (textureSize (uGBufferDepth, 0)) * 2.0 - 1.0;
+  float ndcZ = depth * 2.0 - 1.0;
+  // ...then the projection, which (perspective or orthographic) has no
+  //   terms mixing x and y, so z can be solved for first.
+  float z = (uProjection[3][2] - ndcZ * uProjection[3][3])
+      / (ndcZ * uProjection[2][3] - uProjection[2][2]);
+  float w = uProjection[2][3] * z + uProjection[3][3];
+  vec2 xy = (ndcXY * w - vec2 (uProjection[2][0], uProjection[2][1]) * z
+      - vec2 (uProjection[3][0], uProjection[3][1]))
+      / vec2 (uProjection[0][0], uProjection[1][1]);
+  return vec3 (xy, z);
+}
+#endif
@@ -9,15 +9,33 @@
     variety of types could be provided.
 */
 
+#ifdef MULTI_DRAW_INDIRECT
+// Each draw of a glMultiDrawElementsIndirect call is told which it is by
+//   gl_DrawIDARB.
+#extension GL_ARB_shader_draw_parameters : require
+#endif
+
 // By default, all float variables will use high precision.
 precision highp float;
 
-// Single ambient light, provided by the C++ code.
-uniform vec3  uAmbientIntensity;
-
-// Material properties, provided by the C++ code.
-uniform vec3  uAmbientReflection;
-uniform vec3  uEmissiveIntensity;
+// Material properties, shared by every program (see MaterialBlock in
+//   UniformBuffer.hpp).  Members are ordered to match the std140 layout of
+//   MaterialBlockEntry.
+struct Material
+{
+  vec3 ambientReflection;
+  float specularPower;
+  vec3 diffuseReflection;
+  vec3 specularReflection;
+  vec3 emissiveIntensity;
+};
+const int MAX_MATERIALS = 256;
+layout (std140) uniform MaterialBlock
+{
+  Material uMaterials[MAX_MATERIALS];
+};
+// Which of uMaterials to draw with, provided by the C++ code.
+uniform int uMaterialIndex;
 
 // Inputs from the VBO.
 in vec3 aPosition;
@@ -28,35 +46,81 @@ out vec3 vColor;
 out vec3 vPosition;
 out vec3 vNormal;
 
-// Transformation matrices, provided by C++ code.
-uniform mat4 uView;
-uniform mat4 uProjection;
-uniform mat4 uWorld;
+// The camera, written once per frame by the C++ code and shared by every
+//   program (see CameraBlock in UniformBuffer.hpp).
+layout (std140) uniform CameraBlock
+{
+  // Transformation from world space to eye space.
+  mat4 uView;
+  // Transformation from eye space to clip space.
+  mat4 uProjection;
+  // Eye position, in world space.
+  vec3 uEyePosition;
+  // Single ambient light.
+  vec3 uAmbientIntensity;
+};
 
-// Eye posiiton, in world space, provided by C++ code.
-uniform vec3 uEyePosition;
+// Transformations computed once per draw by the C++ code: local space to
+//   eye space, local space to clip space, and the inverse transpose of the
+//   first (for normals).
+#ifdef MULTI_DRAW_INDIRECT
+// Every draw's transformations, 15 texels apart (see DrawData in
+//   RenderQueue.hpp); this call's first draw is uDrawBase.
+uniform samplerBuffer uDrawData;
+uniform int uDrawBase;
+mat4 uModelView;
+mat4 uModelViewProjection;
+mat3 uNormalMatrix;
+
+// Reads the matrix whose first column is at one texel of uDrawData.
+mat4
+fetchMatrix (int texel)
+{
+  return mat4 (texelFetch (uDrawData, texel), texelFetch (uDrawData, texel + 1),
+               texelFetch (uDrawData, texel + 2), texelFetch (uDrawData, texel + 3));
+}
+#else
+uniform mat4 uModelView;
+uniform mat4 uModelViewProjection;
+uniform mat3 uNormalMatrix;
+#endif
 
 // **
 
 void
 main (void)
 {
-  mat4 worldViewProjection = uProjection * uView * uWorld;
-  // Transform vertex into clip space
-  gl_Position = worldViewProjection * vec4 (aPosition, 1);
-  // Transform vertex into world space for lighting
-  vec3 positionEye = vec3 (uView * uWorld * vec4 (aPosition, 1));
+#ifdef DEFERRED_LIGHTING
+  // The lighting pass of deferred shading draws one triangle over the whole
+  //   screen (with no vertex attributes) and reads everything else from the
+  //   G-buffer.
+  vec2 corner = vec2 ((gl_VertexID & 1) * 4 - 1, (gl_VertexID & 2) * 2 - 1);
+  gl_Position = vec4 (corner, 0, 1);
+  vColor = vec3 (0.0);
+  vPosition = vec3 (0.0);
+  vNormal = vec3 (0.0);
+  return;
+#endif
 
-  // We're doing lighting in world space for this example!
-  mat3 normalTransform = mat3 (uView * uWorld);
-  normalTransform = transpose (inverse (normalTransform));
-  // Normal matrix is world inverse transpose
-  vec3 normalEye = normalize (normalTransform * aNormal);
+#ifdef MULTI_DRAW_INDIRECT
+  int texel = 15 * (uDrawBase + gl_DrawIDARB);
+  uModelView = fetchMatrix (texel + 4);
+  uModelViewProjection = fetchMatrix (texel + 8);
+  uNormalMatrix = mat3 (texelFetch (uDrawData, texel + 12).xyz,
+                        texelFetch (uDrawData, texel + 13).xyz,
+                        texelFetch (uDrawData, texel + 14).xyz);
+#endif
+
+  // Transform vertex into clip space
+  gl_Position = uModelViewProjection * vec4 (aPosition, 1);
+  // Transform vertex into eye space for lighting
+  vec3 positionEye = vec3 (uModelView * vec4 (aPosition, 1));
+  vec3 normalEye = normalize (uNormalMatrix * aNormal);
 
   // Handle ambient and emissive light
   //   It's independent of any particular light
-  vColor = uAmbientReflection * uAmbientIntensity
-      + uEmissiveIntensity;
+  vColor = uMaterials[uMaterialIndex].ambientReflection * uAmbientIntensity
+      + uMaterials[uMaterialIndex].emissiveIntensity;
 
   // Stay in bounds [0, 1]
   vColor = clamp (vColor, 0.0, 1.0);
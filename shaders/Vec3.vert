@@ -17,10 +17,23 @@ layout (location = 1) in vec3 aColor;
 
 // Second, we specify uniform inputs that are the same for all vertices in a
 //   single draw command
-// Matrix to transform world space to eye space
-uniform mat4 uModelView;
-// Matrix to transform eye space to clip space
-uniform mat4 uProjection;
+// Matrix to transform local space to clip space, computed once per draw by
+//   the C++ code
+uniform mat4 uModelViewProjection;
+
+// The camera, written once per frame by the C++ code and shared by every
+//   program (see CameraBlock in UniformBuffer.hpp).
+layout (std140) uniform CameraBlock
+{
+  // Transformation from world space to eye space.
+  mat4 uView;
+  // Transformation from eye space to clip space.
+  mat4 uProjection;
+  // Eye position, in world space.
+  vec3 uEyePosition;
+  // Single ambient light.
+  vec3 uAmbientIntensity;
+};
 
 // Finally, we specify any additional outputs our shader produces
 // We want to output a color, which is a 3-D vector (R, G, B)
@@ -34,7 +47,7 @@ main ()
   // Every vertex shader must write gl_Position
   // It is a 4-D vector (X, Y, Z, W)
   // Transform the vertex from world space to clip space
-  gl_Position = uProjection * uModelView * vec4 (aPosition, 1.0);
+  gl_Position = uModelViewProjection * vec4 (aPosition, 1.0);
   // Just pass along the color unchanged to the next stage
   vColor = aColor;
 }
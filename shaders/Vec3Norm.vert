@@ -21,8 +21,25 @@ layout (location = 2) in vec3 aNormal;
 // Specify world and view transform for object.
 //   This matrix should contain View * World. 
 uniform mat4 uModelView;
-// Specify projection
-uniform mat4 uProjection;
+// Projection * View * World, computed once per draw by the C++ code.
+uniform mat4 uModelViewProjection;
+// The inverse transpose of the upper 3x3 of uModelView, which transforms
+//   local/model normals to eye space, also computed by the C++ code.
+uniform mat3 uNormalMatrix;
+
+// The camera, written once per frame by the C++ code and shared by every
+//   program (see CameraBlock in UniformBuffer.hpp).
+layout (std140) uniform CameraBlock
+{
+  // Transformation from world space to eye space.
+  mat4 uView;
+  // Transformation from eye space to clip space.
+  mat4 uProjection;
+  // Eye position, in world space.
+  vec3 uEyePosition;
+  // Single ambient light.
+  vec3 uAmbientIntensity;
+};
 
 // We are using a single directional light to illuminate our scene. 
 // You can modify these parameters for your model.
@@ -43,16 +60,10 @@ void
 main ()
 {
   // Transform the vertex from world space to clip space
-  gl_Position = uProjection * uModelView * vec4 (aPosition, 1.0);
-
-  // The upper 3x3 portion of the model-view matrix is used for
-  //   transforming normals. 
-  mat3 normalMatrix = mat3 (uModelView);
-  // We need the inverse transpose of the upper 3x3 matrix
-  //   to transform normals to eye space. 
-  normalMatrix = transpose (inverse (normalMatrix));
+  gl_Position = uModelViewProjection * vec4 (aPosition, 1.0);
+
   // Transform local/model normal to eye space. 
-  vec3 normalEye = normalize (normalMatrix * aNormal);
+  vec3 normalEye = normalize (uNormalMatrix * aNormal);
   // How directly is the light shining on the surface?
   float brightness = dot (normalEye, normalize (uLightDirection));
   // Ensure brightness is between 0 and 1